@@ -0,0 +1,63 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+ *
+ * zdc-replay
+ *
+ * Replays workload traces (recorded via ZDCWorkloadRecorder),
+ * and prints per-operation latency histograms.
+ * Exits with a non-zero status if any trace doesn't replay identically.
+ *
+ * Build (from the repository root):
+ *
+ *   clang -fobjc-arc -O2 -framework Foundation \
+ *     -IZDCSyncable -IZDCSyncable/Internal -IZDCSyncable/Utilities \
+ *     ZDCSyncable/*.m ZDCSyncable/Internal/*.m ZDCSyncable/Utilities/*.m \
+ *     Tools/ZDCReplay/main.m -o zdc-replay
+ *
+ * Usage:
+ *
+ *   zdc-replay <trace> [<trace> ...]
+**/
+
+#import <Foundation/Foundation.h>
+
+#import "ZDCSyncableObjC.h"
+
+int main(int argc, const char * argv[])
+{
+	@autoreleasepool {
+		
+		if (argc < 2)
+		{
+			fprintf(stderr, "usage: %s <trace> [<trace> ...]\n", argv[0]);
+			return 2;
+		}
+		
+		int status = 0;
+		
+		for (int i = 1; i < argc; i++)
+		{
+			NSURL *url = [NSURL fileURLWithPath:[NSString stringWithUTF8String:argv[i]]];
+			ZDCWorkloadReplayer *replayer = [[ZDCWorkloadReplayer alloc] initWithURL:url];
+			
+			NSError *error = nil;
+			ZDCWorkloadReplayResult *result = [replayer replay:&error];
+			
+			if (result == nil)
+			{
+				fprintf(stderr, "%s: %s\n", argv[i], error.localizedDescription.UTF8String);
+				status = 1;
+				continue;
+			}
+			
+			printf("%s\n%s\n", argv[i], result.report.UTF8String);
+			
+			if (!result.succeeded) {
+				status = 1;
+			}
+		}
+		
+		return status;
+	}
+}
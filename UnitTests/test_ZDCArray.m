@@ -2589,6 +2589,398 @@
 	}}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Undo: Snapshot-and-Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_undo_snapshot_shuffle
+{
+	ZDCArray *array_a = nil;
+	ZDCArray *array_b = nil;
+	
+	// A full shuffle generates tracking info for (nearly) every item,
+	// which should trigger the switch to snapshot-and-diff.
+	
+	ZDCArray *array = [[ZDCArray alloc] init];
+	
+	for (NSUInteger i = 0; i < 200; i++)
+	{
+		[array addObject:[self randomLetters:8]];
+	}
+	
+	[array clearChangeTracking];
+	array_a = [array immutableCopy];
+	
+	for (NSUInteger i = array.count - 1; i > 0; i--)
+	{
+		NSUInteger j = (NSUInteger)arc4random_uniform((uint32_t)(i + 1));
+		if (i != j) {
+			[array moveObjectAtIndex:i toIndex:j];
+		}
+	}
+	
+	NSDictionary *changeset_undo = [array changeset];
+	array_b = [array immutableCopy];
+	
+	NSDictionary *moved = changeset_undo[@"moved"];
+	XCTAssert(moved.count < array.count);
+	
+	NSDictionary *changeset_redo = [array undo:changeset_undo error:nil]; // a <- b
+	XCTAssert([array isEqualToArray:array_a]);
+	
+	[array undo:changeset_redo error:nil]; // a -> b
+	XCTAssert([array isEqualToArray:array_b]);
+}
+
+- (void)test_undo_snapshot_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCArray *array_a = nil;
+		ZDCArray *array_b = nil;
+		
+		ZDCArray *array = [[ZDCArray alloc] init];
+		
+		// Start with an object that has a random number of objects [100 - 150)
+		
+		NSUInteger startCount = 100 + (NSUInteger)arc4random_uniform((uint32_t)50);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[array addObject:[self randomLetters:8]];
+		}
+		
+		[array clearChangeTracking];
+		array_a = [array immutableCopy];
+		
+		// Now make enough changes to (most likely) trigger snapshot-and-diff: [50 - 250)
+		
+		NSUInteger changeCount = 50 + (NSUInteger)arc4random_uniform((uint32_t)200);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)5);
+			
+			if (random == 0)
+			{
+				[array addObject:[self randomLetters:8]];
+			}
+			else if (random == 1)
+			{
+				if (array.count > 0) {
+					[array removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)array.count)];
+				}
+			}
+			else if (random == 2)
+			{
+				if (array.count > 0) {
+					array[(NSUInteger)arc4random_uniform((uint32_t)array.count)] = [self randomLetters:4];
+				}
+			}
+			else if (random == 3)
+			{
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+				[array insertObject:[self randomLetters:8] atIndex:idx];
+			}
+			else
+			{
+				NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+				NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+				
+				if (array.count > 0) {
+					[array moveObjectAtIndex:oldIdx toIndex:newIdx];
+				}
+			}
+		}
+		
+		NSDictionary *changeset_undo = [array changeset];
+		array_b = [array immutableCopy];
+		
+		NSDictionary *changeset_redo = [array undo:changeset_undo error:nil]; // a <- b
+		XCTAssert([array isEqualToArray:array_a]);
+		
+		[array undo:changeset_redo error:nil]; // a -> b
+		XCTAssert([array isEqualToArray:array_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_diff_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCArray *array_src = [[ZDCArray alloc] init];
+		
+		// Start with an object that has a random number of objects [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[array_src addObject:[self randomLetters:8]];
+		}
+		
+		[array_src clearChangeTracking];
+		ZDCArray *array_dst = [array_src copy];
+		
+		// Make a random number of changes to the copy: [0 - 30)
+		
+		NSUInteger changeCount = (NSUInteger)arc4random_uniform((uint32_t)30);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)4);
+			
+			if (random == 0)
+			{
+				[array_dst addObject:[self randomLetters:8]];
+			}
+			else if (random == 1)
+			{
+				if (array_dst.count > 0) {
+					[array_dst removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)array_dst.count)];
+				}
+			}
+			else if (random == 2)
+			{
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)(array_dst.count + 1));
+				[array_dst insertObject:[self randomLetters:8] atIndex:idx];
+			}
+			else
+			{
+				if (array_dst.count > 0)
+				{
+					NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)array_dst.count);
+					NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)array_dst.count);
+					[array_dst moveObjectAtIndex:oldIdx toIndex:newIdx];
+				}
+			}
+		}
+		
+		NSDictionary *changeset = [ZDCArray changesetFrom:array_src to:array_dst];
+		
+		if ([array_src isEqualToArray:array_dst]) {
+			XCTAssert(changeset == nil);
+			continue;
+		}
+		
+		// Applying the diff (as an undo) to the dst should produce the src.
+		
+		ZDCArray *array = [array_dst copy];
+		[array clearChangeTracking];
+		
+		NSError *error = nil;
+		[array undo:changeset error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([array isEqualToArray:array_src]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Untracked Changes
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_untracked_init
+{
+	NSArray *raw = @[ @"alice", @"bob", @"carol" ];
+	
+	ZDCArray *array = [[ZDCArray alloc] initWithArray:raw copyItems:NO trackChanges:NO];
+	
+	XCTAssert(array.count == raw.count);
+	XCTAssert(array.hasChanges == NO);
+	XCTAssert([array peakChangeset] == nil);
+}
+
+- (void)test_performWithoutChangeTracking
+{
+	ZDCArray *array_a = nil;
+	ZDCArray *array_b = nil;
+	
+	ZDCArray *array = [[ZDCArray alloc] init];
+	[array addObject:@"alice"];
+	[array clearChangeTracking];
+	
+	[array performWithoutChangeTracking:^{
+		
+		[array addObject:@"bob"];
+		[array addObject:@"carol"];
+		[array moveObjectAtIndex:2 toIndex:0];
+		[array removeObjectAtIndex:1];
+	}];
+	
+	XCTAssert(array.count == 2);
+	XCTAssert(array.hasChanges == NO);
+	
+	array_a = [array immutableCopy];
+	
+	// Change tracking resumes after the block
+	
+	[array addObject:@"dave"];
+	XCTAssert(array.hasChanges);
+	
+	NSDictionary *changeset_undo = [array changeset];
+	array_b = [array immutableCopy];
+	
+	NSDictionary *changeset_redo = [array undo:changeset_undo error:nil];
+	XCTAssert([array isEqualToArray:array_a]);
+	
+	[array undo:changeset_redo error:nil];
+	XCTAssert([array isEqualToArray:array_b]);
+}
+
+- (void)test_performWithoutChangeTracking_pendingChanges
+{
+	ZDCArray *array = [[ZDCArray alloc] initWithArray:@[ @"alice", @"bob", @"carol" ] copyItems:NO trackChanges:NO];
+	
+	// Changes made prior to the block are still tracked afterwards
+	
+	[array addObject:@"dave"];
+	[array moveObjectAtIndex:0 toIndex:2]; // bob, carol, alice, dave
+	
+	[array performWithoutChangeTracking:^{
+		
+		[array insertObject:@"emily" atIndex:0]; // emily, bob, carol, alice, dave
+		[array removeObjectAtIndex:2];           // emily, bob, alice, dave
+	}];
+	
+	XCTAssert(array.hasChanges);
+	
+	ZDCArray *array_b = [array immutableCopy];
+	NSDictionary *changeset_undo = [array changeset];
+	
+	// Undo only reverts the tracked changes (the untracked changes are part of the original state)
+	
+	NSError *error = nil;
+	NSDictionary *changeset_redo = [array undo:changeset_undo error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssertEqualObjects(array.rawArray, (@[ @"emily", @"alice", @"bob" ]));
+	
+	[array undo:changeset_redo error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([array isEqualToArray:array_b]);
+}
+
+- (void)test_performWithoutChangeTracking_immutable
+{
+	ZDCArray *array = [[ZDCArray alloc] init];
+	[array makeImmutable];
+	
+	XCTAssertThrows([array performWithoutChangeTracking:^{
+		[array addObject:@"alice"];
+	}]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Statistics
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_trackingStatistics
+{
+	ZDCArray *array = [[ZDCArray alloc] initWithArray:@[ @"alice", @"bob", @"carol" ] copyItems:NO trackChanges:NO];
+	
+	ZDCTrackingStatistics stats = [array trackingStatistics];
+	XCTAssert(stats.elementCount == 3);
+	XCTAssert(stats.mutationCount == 0);
+	XCTAssert(stats.trackingBytes == 0);
+	
+	[array addObject:@"dave"];            // [alice, bob, carol, dave]
+	[array moveObjectAtIndex:0 toIndex:2]; // [bob, carol, alice, dave]
+	[array removeObjectAtIndex:0];         // [carol, alice, dave]
+	
+	stats = [array trackingStatistics];
+	XCTAssert(stats.elementCount == 3);
+	XCTAssert(stats.addedCount == 1);
+	XCTAssert(stats.movedCount == 1);
+	XCTAssert(stats.deletedCount == 1);
+	XCTAssert(stats.originalCount == 1);
+	XCTAssert(stats.mutationCount == 3);
+	XCTAssert(stats.trackingBytes > 0);
+	
+	NSDictionary *changeset_undo = [array changeset];
+	
+	stats = [array trackingStatistics];
+	XCTAssert(stats.addedCount == 0);
+	XCTAssert(stats.movedCount == 0);
+	XCTAssert(stats.deletedCount == 0);
+	XCTAssert(stats.mutationCount == 0);
+	XCTAssert(stats.changesetTime > 0);
+	XCTAssert(stats.undoTime == 0);
+	
+	[array undo:changeset_undo error:nil];
+	
+	stats = [array trackingStatistics];
+	XCTAssert(stats.undoTime > 0);
+	
+	// Timers aren't carried over to copies
+	
+	ZDCArray *copy = [array copy];
+	XCTAssert([copy trackingStatistics].changesetTime == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Concurrency
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_concurrentChildPasses
+{
+	NSUInteger const oldThreshold = [ZDCObject concurrentChildThreshold];
+	[ZDCObject setConcurrentChildThreshold:16];
+	
+	ZDCArray *parent = [[ZDCArray alloc] init];
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		ZDCArray *child = [[ZDCArray alloc] init];
+		[child addObject:@(i)];
+		[parent addObject:child];
+	}
+	
+	XCTAssert(parent.hasChanges);
+	[parent clearChangeTracking];
+	XCTAssert(!parent.hasChanges);
+	
+	for (ZDCArray *child in parent) {
+		XCTAssert(!child.hasChanges);
+	}
+	
+	// A single modified child (at the very end) must be found
+	
+	[(ZDCArray *)parent.lastObject addObject:@"changed"];
+	XCTAssert(parent.hasChanges);
+	
+	[parent makeImmutable];
+	for (ZDCArray *child in parent) {
+		XCTAssert(child.isImmutable);
+	}
+	
+	[ZDCObject setConcurrentChildThreshold:oldThreshold];
+}
+
+- (void)test_enumerateObjectsWithOptions
+{
+	ZDCArray *array = [[ZDCArray alloc] init];
+	for (NSUInteger i = 0; i < 1000; i++) {
+		[array addObject:@(i)];
+	}
+	
+	__block NSUInteger sum = 0;
+	[array enumerateObjectsWithOptions:NSEnumerationConcurrent usingBlock:^(NSNumber *num, NSUInteger idx, BOOL *stop) {
+		
+		XCTAssert(num.unsignedIntegerValue == idx);
+		__atomic_fetch_add(&sum, num.unsignedIntegerValue, __ATOMIC_RELAXED);
+	}];
+	
+	XCTAssert(sum == (999 * 1000 / 2));
+	
+	__block NSUInteger expectedIdx = 999;
+	[array enumerateObjectsWithOptions:NSEnumerationReverse usingBlock:^(NSNumber *num, NSUInteger idx, BOOL *stop) {
+		
+		XCTAssert(idx == expectedIdx);
+		expectedIdx--;
+	}];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark - Import: Basic
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3867,4 +4259,700 @@
 	XCTAssert(localArray.count == 2);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Merge - Memoized
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_mergeMemoized_fuzz
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		NSMutableArray<NSDictionary *> *changesets = [NSMutableArray array];
+		
+		// Single letters, so the array will contain duplicates.
+		
+		ZDCArray *localArray = [[ZDCArray alloc] init];
+		for (NSUInteger i = 0; i < 10; i++)
+		{
+			[localArray addObject:[self randomLetters:1]];
+		}
+		
+		[localArray clearChangeTracking];
+		ZDCArray *cloudArray = [localArray immutableCopy];
+		
+		for (NSUInteger pass = 0; pass < 4; pass++)
+		{
+			{ // local changes
+				
+				for (NSUInteger i = 0; i < 3; i++)
+				{
+					uint32_t random = arc4random_uniform((uint32_t)3);
+					
+					if (random == 0 || localArray.count == 0)
+					{
+						[localArray addObject:[self randomLetters:1]];
+					}
+					else if (random == 1)
+					{
+						NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)localArray.count);
+						[localArray removeObjectAtIndex:idx];
+					}
+					else
+					{
+						NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)localArray.count);
+						NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)localArray.count);
+						[localArray moveObjectAtIndex:oldIdx toIndex:newIdx];
+					}
+				}
+				
+				[changesets addObject:([localArray changeset] ?: @{})];
+			}
+			{ // cloud changes
+				
+				ZDCArray *nextCloudArray = [cloudArray copy];
+				[nextCloudArray addObject:[self randomLetters:1]];
+				if (nextCloudArray.count > 1) {
+					[nextCloudArray removeObjectAtIndex:0];
+				}
+				
+				cloudArray = [nextCloudArray immutableCopy];
+			}
+			
+			// A copy doesn't share the memoized original order,
+			// so it performs the full calculation.
+			
+			ZDCArray *coldArray = [localArray copy];
+			
+			NSError *coldError = nil;
+			[coldArray mergeCloudVersion: cloudArray
+			       withPendingChangesets: changesets
+			                       error: &coldError];
+			
+			NSError *error = nil;
+			NSDictionary *mergeChangeset =
+			  [localArray mergeCloudVersion: cloudArray
+			          withPendingChangesets: changesets
+			                          error: &error];
+			
+			XCTAssert((error == nil) == (coldError == nil));
+			XCTAssertEqualObjects(localArray, coldArray);
+			
+			if (error) break;
+			
+			// The next merge extends the previous list of pending changesets.
+			[changesets addObject:mergeChangeset];
+		}
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Checkpoints
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)randomlyMutate:(ZDCArray *)array changeCount:(NSUInteger)changeCount
+{
+	for (NSUInteger i = 0; i < changeCount; i++)
+	{
+		uint32_t random = arc4random_uniform((uint32_t)3);
+		
+		if (random == 0 || array.count == 0)
+		{
+			NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)(array.count + 1));
+			[array insertObject:[self randomLetters:4] atIndex:idx];
+		}
+		else if (random == 1)
+		{
+			NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+			[array removeObjectAtIndex:idx];
+		}
+		else
+		{
+			NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+			NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+			[array moveObjectAtIndex:oldIdx toIndex:newIdx];
+		}
+	}
+}
+
+- (void)test_checkpoint_basic
+{
+	ZDCArray *array = [[ZDCArray alloc] initWithArray:@[ @"cow", @"duck" ]];
+	[array clearChangeTracking];
+	
+	[array addObject:@"dog"];
+	
+	NSArray *raw_a = array.rawArray;
+	NSDictionary *changeset_a = [array peakChangeset];
+	
+	id checkpoint = [array checkpoint];
+	
+	[array removeObjectAtIndex:0];
+	[array moveObjectAtIndex:0 toIndex:1];
+	
+	[array restoreCheckpoint:checkpoint];
+	
+	XCTAssertEqualObjects(array.rawArray, raw_a);
+	XCTAssertEqualObjects([array peakChangeset], changeset_a);
+	
+	// A checkpoint can be restored multiple times
+	
+	[array removeAllObjects];
+	[array clearChangeTracking];
+	
+	[array restoreCheckpoint:checkpoint];
+	
+	XCTAssertEqualObjects(array.rawArray, raw_a);
+	XCTAssertEqualObjects([array peakChangeset], changeset_a);
+	
+	// Only the object the checkpoint was taken from can restore it
+	
+	ZDCArray *another = [array copy];
+	XCTAssertThrows([another restoreCheckpoint:checkpoint]);
+}
+
+- (void)test_checkpoint_copyOnWrite
+{
+	ZDCArray *array = [[ZDCArray alloc] initWithArray:@[ @"cow", @"duck", @"dog" ]];
+	[array clearChangeTracking];
+	
+	ZDCArray *copy = [array copy];
+	
+	[array addObject:@"cat"];
+	[copy removeObjectAtIndex:0];
+	
+	XCTAssertEqualObjects(array.rawArray, (@[ @"cow", @"duck", @"dog", @"cat" ]));
+	XCTAssertEqualObjects(copy.rawArray, (@[ @"duck", @"dog" ]));
+	
+	XCTAssert([[array peakChangeset][@"added"] count] == 1);
+	XCTAssert([[copy peakChangeset][@"deleted"] count] == 1);
+	
+	// Clearing the change tracking of a copy must not affect the original
+	
+	ZDCArray *copy2 = [array copy];
+	[copy2 clearChangeTracking];
+	
+	XCTAssert(array.hasChanges);
+	XCTAssert(!copy2.hasChanges);
+}
+
+- (void)test_checkpoint_fuzz
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCArray *array = [[ZDCArray alloc] init];
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			[array addObject:[self randomLetters:4]];
+		}
+		[array clearChangeTracking];
+		
+		// Nested checkpoints, along with the state we expect each to restore
+		
+		NSMutableArray *checkpoints = [NSMutableArray array];
+		NSMutableArray<NSArray*> *raws = [NSMutableArray array];
+		NSMutableArray *changesets = [NSMutableArray array];
+		
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)4);
+			
+			if (random == 0 || checkpoints.count == 0)
+			{
+				[checkpoints addObject:[array checkpoint]];
+				[raws addObject:array.rawArray];
+				[changesets addObject:([array peakChangeset] ?: [NSNull null])];
+			}
+			else if (random == 1)
+			{
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)checkpoints.count);
+				[array restoreCheckpoint:checkpoints[idx]];
+				
+				XCTAssertEqualObjects(array.rawArray, raws[idx]);
+				XCTAssertEqualObjects(([array peakChangeset] ?: [NSNull null]), changesets[idx]);
+				
+				// Restoring an outer checkpoint discards the inner ones (like an aborted nested edit session)
+				
+				NSRange range = NSMakeRange(idx + 1, checkpoints.count - idx - 1);
+				[checkpoints removeObjectsInRange:range];
+				[raws removeObjectsInRange:range];
+				[changesets removeObjectsInRange:range];
+			}
+			else if (random == 2)
+			{
+				// The changeset must still undo all the way back to the baseline
+				
+				ZDCArray *temp = [array copy];
+				NSDictionary *changeset = [temp changeset];
+				if (changeset) {
+					XCTAssert([temp undo:changeset error:nil] != nil);
+				}
+			}
+			else
+			{
+				[self randomlyMutate:array changeCount:(1 + (NSUInteger)arc4random_uniform((uint32_t)10))];
+			}
+		}
+		
+		// Every checkpoint is still intact
+		
+		for (NSUInteger idx = 0; idx < checkpoints.count; idx++)
+		{
+			[array restoreCheckpoint:checkpoints[idx]];
+			
+			XCTAssertEqualObjects(array.rawArray, raws[idx]);
+			XCTAssertEqualObjects(([array peakChangeset] ?: [NSNull null]), changesets[idx]);
+		}
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Notifications
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Applies the notification to the old array (the way a table view would),
+ * and ensures the result matches the new array.
+ */
+- (void)verifyNotification:(ZDCChangeNotification *)notification from:(NSArray *)oldArray to:(NSArray *)newArray
+{
+	if (notification == nil) {
+		XCTAssertEqualObjects(oldArray, newArray);
+		return;
+	}
+	XCTAssert(!notification.requiresReload);
+	
+	NSMutableIndexSet *movedOrigins = [NSMutableIndexSet indexSet];
+	for (NSNumber *origin in [notification.movedIndexes objectEnumerator]) {
+		[movedOrigins addIndex:origin.unsignedIntegerValue];
+	}
+	
+	XCTAssert(![notification.removedIndexes intersectsIndexSet:movedOrigins]);
+	
+	NSMutableArray<NSNumber*> *untouched = [NSMutableArray arrayWithCapacity:oldArray.count];
+	for (NSUInteger i = 0; i < oldArray.count; i++)
+	{
+		if (![notification.removedIndexes containsIndex:i] && ![movedOrigins containsIndex:i]) {
+			[untouched addObject:@(i)];
+		}
+	}
+	
+	NSUInteger untouchedIdx = 0;
+	for (NSUInteger i = 0; i < newArray.count; i++)
+	{
+		if ([notification.insertedIndexes containsIndex:i]) {
+			continue;
+		}
+		
+		NSNumber *origin = notification.movedIndexes[@(i)];
+		if (origin == nil)
+		{
+			XCTAssert(untouchedIdx < untouched.count);
+			if (untouchedIdx >= untouched.count) return;
+			
+			origin = untouched[untouchedIdx++];
+		}
+		
+		if (![notification.updatedIndexes containsIndex:origin.unsignedIntegerValue]) {
+			XCTAssertEqualObjects(newArray[i], oldArray[origin.unsignedIntegerValue]);
+		}
+	}
+	
+	XCTAssert(untouchedIdx == untouched.count);
+}
+
+- (void)test_changeNotifications_basic
+{
+	ZDCArray *array = [[ZDCArray alloc] init];
+	[array addObject:@"a"];
+	[array addObject:@"b"];
+	[array addObject:@"c"];
+	[array addObject:@"d"];
+	
+	__block NSUInteger notificationCount = 0;
+	__block ZDCChangeNotification *lastNotification = nil;
+	
+	id observer = [array addChangeObserver:^(ZDCChangeNotification *notification) {
+		
+		notificationCount++;
+		lastNotification = notification;
+	}];
+	
+	[array performChangeBatch:^{
+		
+		[array removeObjectAtIndex:0];          // [b, c, d]
+		[array insertObject:@"e" atIndex:1];    // [b, e, c, d]
+		[array moveObjectAtIndex:3 toIndex:0];  // [d, b, e, c]
+		array[3] = @"C";                        // [d, b, e, C]
+	}];
+	
+	XCTAssert(notificationCount == 1);
+	XCTAssert(lastNotification.object == array);
+	XCTAssertEqualObjects(lastNotification.removedIndexes, [NSIndexSet indexSetWithIndex:0]);
+	XCTAssertEqualObjects(lastNotification.insertedIndexes, [NSIndexSet indexSetWithIndex:2]);
+	XCTAssertEqualObjects(lastNotification.movedIndexes, @{ @(0): @(3) });
+	XCTAssertEqualObjects(lastNotification.updatedIndexes, [NSIndexSet indexSetWithIndex:2]);
+	
+	// Changes that cancel out aren't delivered
+	
+	[array performChangeBatch:^{
+		
+		[array addObject:@"f"];
+		[array removeObjectAtIndex:(array.count - 1)];
+	}];
+	
+	XCTAssert(notificationCount == 1);
+	
+	// Restoring a checkpoint is delivered as a reload
+	
+	id checkpoint = [array checkpoint];
+	[array removeAllObjects];
+	[array restoreCheckpoint:checkpoint];
+	[array flushChangeNotifications];
+	
+	XCTAssert(notificationCount == 2);
+	XCTAssert(lastNotification.requiresReload);
+	
+	// No more notifications once the observer is removed
+	
+	[array removeChangeObserver:observer];
+	[array performChangeBatch:^{
+		
+		[array addObject:@"g"];
+	}];
+	
+	XCTAssert(notificationCount == 2);
+}
+
+- (void)test_changeNotifications_runLoop
+{
+	ZDCArray *array = [[ZDCArray alloc] init];
+	
+	XCTestExpectation *expectation = [self expectationWithDescription:@"notification"];
+	
+	__block NSUInteger notificationCount = 0;
+	[array addChangeObserver:^(ZDCChangeNotification *notification) {
+		
+		notificationCount++;
+		XCTAssert(notification.insertedIndexes.count == 3);
+		[expectation fulfill];
+	}];
+	
+	[array addObject:@"a"];
+	[array addObject:@"b"];
+	[array addObject:@"c"];
+	
+	// Nothing is delivered until the next turn of the run loop
+	XCTAssert(notificationCount == 0);
+	
+	[self waitForExpectationsWithTimeout:5.0 handler:nil];
+	XCTAssert(notificationCount == 1);
+}
+
+- (void)test_changeNotifications_fuzz
+{
+	for (NSUInteger round = 0; round < 1000; round++) { @autoreleasepool
+	{
+		ZDCArray *array = [[ZDCArray alloc] init];
+		
+		NSUInteger startCount = (NSUInteger)arc4random_uniform((uint32_t)20);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[array addObject:[self randomLetters:8]];
+		}
+		[array clearChangeTracking];
+		
+		__block ZDCChangeNotification *lastNotification = nil;
+		[array addChangeObserver:^(ZDCChangeNotification *notification) {
+			
+			lastNotification = notification;
+		}];
+		
+		// Regular mutations
+		
+		NSArray *oldArray = [array.rawArray copy];
+		[array performChangeBatch:^{
+			
+			[self randomlyMutate:array changeCount:(1 + (NSUInteger)arc4random_uniform((uint32_t)10))];
+		}];
+		
+		[self verifyNotification:lastNotification from:oldArray to:array.rawArray];
+		
+		// Undo (which performs bulk moves)
+		
+		lastNotification = nil;
+		oldArray = [array.rawArray copy];
+		
+		NSDictionary *changeset = [array changeset];
+		if (changeset == nil) continue;
+		
+		[array performChangeBatch:^{
+			
+			[array performUndo:changeset];
+		}];
+		
+		[self verifyNotification:lastNotification from:oldArray to:array.rawArray];
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Block Moves
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (BOOL)changesetContainsBlockMove:(NSDictionary *)changeset
+{
+	for (id value in [changeset[@"moved"] allValues])
+	{
+		if ([value isKindOfClass:[NSArray class]]) {
+			return YES;
+		}
+	}
+	return NO;
+}
+
+- (void)dragBlockInArray:(ZDCArray *)array
+{
+	// Drag rows [500, 1000) to the front, one row at a time (as a table view would report it).
+	
+	for (NSUInteger i = 0; i < 500; i++)
+	{
+		[array moveObjectAtIndex:(500 + i) toIndex:i];
+	}
+}
+
+- (void)test_blockMove_tracked
+{
+	ZDCArray *array = [[ZDCArray alloc] init];
+	array.snapshotThreshold = 0; // operation-by-operation tracking
+	array.compressesMoves = YES;
+	
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		[array addObject:@(i)];
+	}
+	[array clearChangeTracking];
+	
+	ZDCArray *array_a = [array immutableCopy];
+	[self dragBlockInArray:array];
+	ZDCArray *array_b = [array immutableCopy];
+	
+	NSDictionary *changeset_undo = [array changeset];
+	
+	XCTAssert([changeset_undo[@"moved"] count] < 500);
+	XCTAssert([self changesetContainsBlockMove:changeset_undo]);
+	
+	NSError *error = nil;
+	NSDictionary *changeset_redo = [array undo:changeset_undo error:&error]; // a <- b
+	XCTAssert(error == nil);
+	XCTAssert([array isEqualToArray:array_a]);
+	XCTAssert([self changesetContainsBlockMove:changeset_redo]);
+	
+	[array undo:changeset_redo error:&error]; // a -> b
+	XCTAssert(error == nil);
+	XCTAssert([array isEqualToArray:array_b]);
+}
+
+- (void)test_blockMove_snapshot
+{
+	ZDCArray *array = [[ZDCArray alloc] init];
+	array.compressesMoves = YES;
+	
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		[array addObject:@(i)];
+	}
+	[array clearChangeTracking];
+	
+	ZDCArray *array_a = [array immutableCopy];
+	[self dragBlockInArray:array];
+	ZDCArray *array_b = [array immutableCopy];
+	
+	NSDictionary *changeset_undo = [array changeset];
+	
+	// Either half of the array is a minimal set of moves, and both are a single contiguous run.
+	XCTAssert([changeset_undo[@"moved"] count] == 1);
+	XCTAssert([self changesetContainsBlockMove:changeset_undo]);
+	
+	NSDictionary *changeset_redo = [array undo:changeset_undo error:nil]; // a <- b
+	XCTAssert([array isEqualToArray:array_a]);
+	
+	[array undo:changeset_redo error:nil]; // a -> b
+	XCTAssert([array isEqualToArray:array_b]);
+}
+
+- (void)test_blockMove_optIn
+{
+	// Block-move entries are opt-in, since older readers reject them.
+	
+	for (NSUInteger mode = 0; mode < 2; mode++)
+	{
+		ZDCArray *array = [[ZDCArray alloc] init];
+		if (mode == 0) {
+			array.snapshotThreshold = 0;
+		}
+		
+		for (NSUInteger i = 0; i < 1000; i++)
+		{
+			[array addObject:@(i)];
+		}
+		[array clearChangeTracking];
+		
+		ZDCArray *array_a = [array immutableCopy];
+		[self dragBlockInArray:array];
+		
+		NSDictionary *changeset_undo = [array changeset];
+		XCTAssert(![self changesetContainsBlockMove:changeset_undo]);
+		XCTAssert(![self changesetContainsBlockMove:[ZDCArray changesetFrom:array_a to:array]]);
+		
+		[array undo:changeset_undo error:nil];
+		XCTAssert([array isEqualToArray:array_a]);
+	}
+}
+
+- (void)test_blockMove_matchesPerItemFormat
+{
+	NSMutableArray *raw = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 20; i++)
+	{
+		[raw addObject:[self randomLetters:8]];
+	}
+	
+	// Items [10, 20) were moved to the front.
+	
+	NSMutableArray *moved_raw = [[raw subarrayWithRange:NSMakeRange(10, 10)] mutableCopy];
+	[moved_raw addObjectsFromArray:[raw subarrayWithRange:NSMakeRange(0, 10)]];
+	
+	NSMutableDictionary *moved_perItem = [NSMutableDictionary dictionary];
+	for (NSUInteger i = 0; i < 10; i++)
+	{
+		moved_perItem[@(i)] = @(10 + i);
+	}
+	
+	NSDictionary *changeset_perItem = @{ @"moved": moved_perItem };
+	NSDictionary *changeset_block = @{ @"moved": @{ @(0): @[ @(1), @(10), @(10) ] } };
+	
+	ZDCArray *array_perItem = [[ZDCArray alloc] initWithArray:moved_raw copyItems:NO trackChanges:NO];
+	ZDCArray *array_block = [[ZDCArray alloc] initWithArray:moved_raw copyItems:NO trackChanges:NO];
+	
+	NSError *error = nil;
+	[array_perItem undo:changeset_perItem error:&error];
+	XCTAssert(error == nil);
+	
+	[array_block undo:changeset_block error:&error];
+	XCTAssert(error == nil);
+	
+	XCTAssertEqualObjects(array_perItem.rawArray, raw);
+	XCTAssertEqualObjects(array_block.rawArray, raw);
+}
+
+- (void)test_blockMove_malformed
+{
+	NSArray *raw = @[ @"a", @"b", @"c", @"d", @"e", @"f", @"g", @"h", @"i", @"j" ];
+	
+	NSArray<NSDictionary*> *changesets = @[
+		@{ @"moved": @{ @(0): @[ @(2), @(5), @(5) ] } },             // unknown version
+		@{ @"moved": @{ @(0): @[ @(1), @(5) ] } },                   // missing length
+		@{ @"moved": @{ @(0): @[ @(1), @(5), @(0) ] } },             // empty block
+		@{ @"moved": @{ @(0): @[ @(1), @"5", @(5) ] } },             // not a number
+	];
+	
+	for (NSDictionary *changeset in changesets)
+	{
+		ZDCArray *array = [[ZDCArray alloc] initWithArray:raw copyItems:NO trackChanges:NO];
+		
+		NSError *error = nil;
+		NSDictionary *redo = [array undo:changeset error:&error];
+		
+		XCTAssert(redo == nil);
+		XCTAssert(error != nil);
+		XCTAssertEqualObjects(array.rawArray, raw);
+	}
+	
+	// Well-formed, but doesn't match the array
+	
+	NSArray<NSDictionary*> *mismatched = @[
+		@{ @"moved": @{ @(5): @[ @(1), @(0), @(10) ] } },            // past the end of the array
+		@{ @"moved": @{ @(0): @[ @(1), @(5), @(5) ], @(2): @(9) } }, // overlapping entries
+	];
+	
+	for (NSDictionary *changeset in mismatched)
+	{
+		ZDCArray *array = [[ZDCArray alloc] initWithArray:raw copyItems:NO trackChanges:NO];
+		
+		NSError *error = nil;
+		[array undo:changeset error:&error];
+		
+		XCTAssert(error != nil);
+	}
+}
+
+- (void)test_blockMove_fuzz
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCArray *array = [[ZDCArray alloc] init];
+		array.compressesMoves = YES;
+		if (arc4random_uniform(2) == 0) {
+			array.snapshotThreshold = 0;
+		}
+		
+		NSUInteger startCount = 40 + (NSUInteger)arc4random_uniform((uint32_t)40);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[array addObject:[self randomLetters:8]];
+		}
+		[array clearChangeTracking];
+		
+		ZDCArray *array_a = [array immutableCopy];
+		
+		NSUInteger changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)4);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)4);
+			
+			if (random == 0)
+			{
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)(array.count + 1));
+				[array insertObject:[self randomLetters:8] atIndex:idx];
+			}
+			else if (random == 1 && array.count > 0)
+			{
+				[array removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)array.count)];
+			}
+			else if (array.count > 20)
+			{
+				// Drag a block of rows, one row at a time.
+				
+				NSUInteger length = 8 + (NSUInteger)arc4random_uniform((uint32_t)12);
+				NSUInteger location = (NSUInteger)arc4random_uniform((uint32_t)(array.count - length + 1));
+				NSUInteger toIdx = (NSUInteger)arc4random_uniform((uint32_t)(array.count - length + 1));
+				
+				if (toIdx <= location)
+				{
+					for (NSUInteger j = 0; j < length; j++) {
+						[array moveObjectAtIndex:(location + j) toIndex:(toIdx + j)];
+					}
+				}
+				else
+				{
+					for (NSUInteger j = 0; j < length; j++) {
+						[array moveObjectAtIndex:location toIndex:(toIdx + length - 1)];
+					}
+				}
+			}
+		}
+		
+		NSDictionary *changeset_undo = [array changeset];
+		ZDCArray *array_b = [array immutableCopy];
+		
+		NSError *error = nil;
+		NSDictionary *changeset_redo = [array undo:changeset_undo error:&error]; // a <- b
+		XCTAssert(error == nil);
+		XCTAssert([array isEqualToArray:array_a]);
+		
+		[array undo:changeset_redo error:&error]; // a -> b
+		XCTAssert(error == nil);
+		XCTAssert([array isEqualToArray:array_b]);
+	}}
+}
+
 @end
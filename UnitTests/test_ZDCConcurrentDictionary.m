@@ -0,0 +1,405 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <XCTest/XCTest.h>
+#import "ZDCConcurrentDictionary.h"
+#import "ZDCDictionary.h"
+
+@interface test_ZDCConcurrentDictionary : XCTestCase
+@end
+
+@implementation test_ZDCConcurrentDictionary
+
+- (NSString *)randomLetters:(NSUInteger)length
+{
+	NSString *alphabet = @"abcdefghijklmnopqrstuvwxyz";
+	NSUInteger alphabetLength = [alphabet length];
+	
+	NSMutableString *result = [NSMutableString stringWithCapacity:length];
+	
+	NSUInteger i;
+	for (i = 0; i < length; i++)
+	{
+		unichar c = [alphabet characterAtIndex:(NSUInteger)arc4random_uniform((uint32_t)alphabetLength)];
+		
+		[result appendFormat:@"%C", c];
+	}
+	
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Basic
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_basic
+{
+	ZDCConcurrentDictionary *dict = [[ZDCConcurrentDictionary alloc] initWithStripeCount:5];
+	XCTAssert(dict.stripeCount == 8);
+	
+	dict[@"cow"] = @"moo";
+	dict[@"duck"] = @"quack";
+	dict[@(42)] = @"answer";
+	
+	XCTAssert(dict.count == 3);
+	XCTAssert([dict containsKey:@"cow"]);
+	XCTAssertEqualObjects(dict[@(42)], @"answer");
+	
+	dict[@"cow"] = nil;
+	
+	XCTAssert(dict.count == 2);
+	XCTAssert(![dict containsKey:@"cow"]);
+	XCTAssertEqualObjects([NSSet setWithArray:[dict allKeys]], ([NSSet setWithObjects:@"duck", @(42), nil]));
+	
+	[dict removeAllObjects];
+	XCTAssert(dict.count == 0);
+}
+
+- (void)test_changesetFormat
+{
+	// The changesets should be identical to those of a ZDCDictionary with the same history
+	
+	ZDCConcurrentDictionary *cDict = [[ZDCConcurrentDictionary alloc] init];
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		NSString *key = [self randomLetters:2];
+		NSString *value = [self randomLetters:4];
+		
+		cDict[key] = value;
+		dict[key] = value;
+	}
+	
+	XCTAssertEqualObjects([cDict changeset], [dict changeset]);
+	
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		NSString *key = [self randomLetters:2];
+		
+		if (arc4random_uniform((uint32_t)2) == 0)
+		{
+			cDict[key] = nil;
+			dict[key] = nil;
+		}
+		else
+		{
+			NSString *value = [self randomLetters:4];
+			
+			cDict[key] = value;
+			dict[key] = value;
+		}
+	}
+	
+	NSDictionary *changeset = [cDict changeset];
+	XCTAssertEqualObjects(changeset, [dict changeset]);
+	
+	// And they're interchangeable
+	
+	[dict undo:changeset error:nil];
+	[cDict undo:changeset error:nil];
+	
+	XCTAssertEqualObjects(cDict.rawDictionary, dict.rawDictionary);
+	XCTAssert(!cDict.hasChanges);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Undo
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_undo
+{
+	ZDCConcurrentDictionary *dict = [[ZDCConcurrentDictionary alloc] init];
+	dict[@"cow"] = @"moo";
+	dict[@"duck"] = @"quack";
+	[dict clearChangeTracking];
+	
+	ZDCConcurrentDictionary *dict_a = [dict immutableCopy];
+	
+	dict[@"cow"] = @"mooo";
+	dict[@"duck"] = nil;
+	dict[@"dog"] = @"woof";
+	
+	ZDCConcurrentDictionary *dict_b = [dict immutableCopy];
+	
+	NSDictionary *changeset_undo = [dict changeset];
+	XCTAssert(changeset_undo != nil);
+	
+	NSError *error = nil;
+	NSDictionary *changeset_redo = [dict undo:changeset_undo error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+	
+	[dict undo:changeset_redo error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToDictionary:dict_b]);
+	
+	// Cannot undo with pending changes
+	
+	dict[@"cat"] = @"meow";
+	XCTAssert([dict performUndo:changeset_undo] != nil);
+	
+	[dict rollback];
+	XCTAssert([dict isEqualToDictionary:dict_b]);
+}
+
+- (void)test_checkpoint
+{
+	ZDCConcurrentDictionary *dict = [[ZDCConcurrentDictionary alloc] init];
+	dict[@"cow"] = @"moo";
+	
+	ZDCConcurrentDictionary *dict_a = [dict immutableCopy];
+	NSDictionary *changeset_a = [dict peakChangeset];
+	
+	id checkpoint = [dict checkpoint];
+	
+	dict[@"cow"] = nil;
+	dict[@"duck"] = @"quack";
+	
+	[dict restoreCheckpoint:checkpoint];
+	
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+	XCTAssertEqualObjects([dict peakChangeset], changeset_a);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Merge
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_merge
+{
+	NSError *error = nil;
+	NSMutableArray<NSDictionary *> *changesets = [NSMutableArray array];
+	
+	ZDCConcurrentDictionary *localDict = [[ZDCConcurrentDictionary alloc] init];
+	localDict[@"string"] = @"abc123";
+	localDict[@"integer"] = @(42);
+	localDict[@"removed"] = @"bye";
+	
+	[localDict clearChangeTracking];
+	ZDCConcurrentDictionary *cloudDict = [localDict copy];
+	
+	{ // local changes
+		
+		localDict[@"string"] = @"def456";
+		[changesets addObject:[localDict changeset]];
+	}
+	{ // cloud changes
+		
+		cloudDict[@"integer"] = @(43);
+		cloudDict[@"removed"] = nil;
+		[cloudDict makeImmutable];
+	}
+	
+	[localDict mergeCloudVersion: cloudDict
+	       withPendingChangesets: changesets
+	                       error: &error];
+	
+	XCTAssert(error == nil);
+	XCTAssertEqualObjects(localDict[@"string"], @"def456");
+	XCTAssertEqualObjects(localDict[@"integer"], @(43));
+	XCTAssert(localDict[@"removed"] == nil);
+	XCTAssert(!localDict.hasChanges);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Concurrency
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_concurrentWriters
+{
+	ZDCConcurrentDictionary *dict = [[ZDCConcurrentDictionary alloc] init];
+	
+	NSUInteger const threadCount = 8;
+	NSUInteger const keysPerThread = 2000;
+	
+	__block NSDictionary *changeset_mid = nil;
+	
+	dispatch_apply(threadCount + 1, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t thread) {
+		
+		if (thread == threadCount)
+		{
+			// Meanwhile, snapshot the changeset (a consistent cut)
+			changeset_mid = [dict peakChangeset];
+			return;
+		}
+		
+		for (NSUInteger i = 0; i < keysPerThread; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%lu-%lu", (unsigned long)thread, (unsigned long)i];
+			
+			dict[key] = @(i);
+			XCTAssertEqualObjects(dict[key], @(i));
+		}
+	});
+	
+	XCTAssert(dict.count == (threadCount * keysPerThread));
+	XCTAssert([changeset_mid[@"values"] count] <= (threadCount * keysPerThread));
+	
+	NSDictionary *changeset = [dict changeset];
+	NSDictionary *values = changeset[@"values"];
+	
+	XCTAssert(values.count == (threadCount * keysPerThread));
+	XCTAssert(!dict.hasChanges);
+	
+	// Undoing the changeset removes everything that was added
+	
+	[dict undo:changeset error:nil];
+	XCTAssert(dict.count == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Dirty Stripes
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_dirtyStripes_largeKeySpace
+{
+	NSUInteger const oldThreshold = [ZDCObject concurrentChildThreshold];
+	[ZDCObject setConcurrentChildThreshold:16];
+	
+	// The changesets should be identical to those of a ZDCDictionary with the same history,
+	// whether a few stripes are modified, or all of them.
+	
+	ZDCConcurrentDictionary *cDict = [[ZDCConcurrentDictionary alloc] initWithStripeCount:256];
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	
+	for (NSUInteger i = 0; i < 20000; i++)
+	{
+		cDict[@(i)] = @(i);
+		dict[@(i)] = @(i);
+	}
+	
+	XCTAssertEqualObjects([cDict changeset], [dict changeset]);
+	XCTAssert(!cDict.hasChanges);
+	XCTAssert([cDict peakChangeset] == nil);
+	
+	for (NSUInteger round = 0; round < 10; round++)
+	{
+		NSUInteger const modifyCount = (round % 2 == 0) ? 3 : 5000;
+		
+		for (NSUInteger i = 0; i < modifyCount; i++)
+		{
+			NSNumber *key = @(arc4random_uniform((uint32_t)25000));
+			
+			if (arc4random_uniform((uint32_t)3) == 0)
+			{
+				cDict[key] = nil;
+				dict[key] = nil;
+			}
+			else
+			{
+				NSString *value = [self randomLetters:4];
+				
+				cDict[key] = value;
+				dict[key] = value;
+			}
+		}
+		
+		XCTAssert(cDict.hasChanges);
+		
+		NSDictionary *changeset = [cDict changeset];
+		XCTAssertEqualObjects(changeset, [dict changeset]);
+		XCTAssert(!cDict.hasChanges);
+		
+		// Undo the round, and then redo it
+		
+		NSDictionary *redo = [cDict undo:changeset error:nil];
+		XCTAssert(!cDict.hasChanges);
+		
+		[cDict undo:redo error:nil];
+		XCTAssertEqualObjects(cDict.rawDictionary, dict.rawDictionary);
+	}
+	
+	[ZDCObject setConcurrentChildThreshold:oldThreshold];
+}
+
+- (void)test_dirtyStripes_childObjects
+{
+	ZDCConcurrentDictionary *cDict = [[ZDCConcurrentDictionary alloc] initWithStripeCount:64];
+	
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		cDict[@(i)] = @(i);
+	}
+	
+	ZDCDictionary *child = [[ZDCDictionary alloc] init];
+	child[@"cow"] = @"moo";
+	cDict[@"child"] = child;
+	
+	[cDict clearChangeTracking];
+	XCTAssert(!child.hasChanges);
+	
+	// The child's stripe wasn't touched, but the child itself was modified
+	
+	child[@"cow"] = @"mooo";
+	XCTAssert(cDict.hasChanges);
+	
+	NSDictionary *changeset = [cDict changeset];
+	XCTAssertEqualObjects(changeset[@"refs"][@"child"], (@{ @"values": @{ @"cow": @"moo" } }));
+	XCTAssert(!child.hasChanges);
+	
+	// Rollback reaches the child too
+	
+	child[@"duck"] = @"quack";
+	[cDict rollback];
+	
+	XCTAssert(child[@"duck"] == nil);
+	XCTAssert(!cDict.hasChanges);
+}
+
+- (void)test_dirtyStripes_checkpoint
+{
+	ZDCConcurrentDictionary *cDict = [[ZDCConcurrentDictionary alloc] initWithStripeCount:64];
+	
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		cDict[@(i)] = @(i);
+	}
+	[cDict clearChangeTracking];
+	
+	cDict[@(1)] = @"one";
+	
+	NSDictionary *changeset_a = [cDict peakChangeset];
+	id checkpoint = [cDict checkpoint];
+	
+	cDict[@(2)] = @"two";
+	[cDict restoreCheckpoint:checkpoint];
+	
+	XCTAssertEqualObjects([cDict peakChangeset], changeset_a);
+	
+	// Copies track the same stripes
+	
+	ZDCConcurrentDictionary *copy = [cDict copy];
+	XCTAssertEqualObjects([copy changeset], changeset_a);
+	XCTAssert(!copy.hasChanges);
+}
+
+- (void)test_dirtyStripes_performance
+{
+	ZDCConcurrentDictionary *cDict = [[ZDCConcurrentDictionary alloc] initWithStripeCount:512];
+	
+	for (NSUInteger i = 0; i < 200000; i++)
+	{
+		cDict[@(i)] = @(i);
+	}
+	[cDict clearChangeTracking];
+	
+	[self measureBlock:^{
+		
+		// A handful of modified keys: only their stripes are visited
+		
+		for (NSUInteger i = 0; i < 10; i++)
+		{
+			cDict[@(arc4random_uniform((uint32_t)200000))] = @"changed";
+		}
+		
+		NSDictionary *changeset = [cDict changeset];
+		XCTAssert(changeset != nil);
+	}];
+}
+
+@end
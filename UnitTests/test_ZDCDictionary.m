@@ -121,6 +121,45 @@
 	XCTAssert([dict isEqualToDictionary:dict_b]);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Undo - Originals
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_undo_frozenOriginals
+{
+	NSMutableString *mutableString = [NSMutableString stringWithString:@"alice"];
+	
+	ZDCDictionary *child = [[ZDCDictionary alloc] init];
+	child[@"name"] = @"bob";
+	[child makeImmutable];
+	
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict[@"string"] = mutableString;
+	dict[@"child"] = child;
+	[dict clearChangeTracking];
+	
+	dict[@"string"] = @"carol";
+	dict[@"child"] = [[ZDCDictionary alloc] init];
+	
+	// The original was frozen when captured, so later mutations don't leak into the changeset
+	[mutableString appendString:@"-modified"];
+	
+	NSDictionary *changeset = [dict changeset];
+	NSDictionary *values = changeset[@"values"];
+	
+	XCTAssert([values[@"string"] isEqual:@"alice"]);
+	
+	// Immutable originals are shared (not copied)
+	XCTAssert(values[@"child"] == child);
+	
+	NSError *error = nil;
+	[dict undo:changeset error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([dict[@"string"] isEqual:@"alice"]);
+	XCTAssert([dict[@"child"] isEqual:child]);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Undo - Fuzz
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -398,6 +437,72 @@
 	}}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_diff_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCDictionary *dict_src = [[ZDCDictionary alloc] init];
+		
+		// Start with an object that has a random number of objects [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			dict_src[[self randomLetters:8]] = [self randomLetters:4];
+		}
+		
+		[dict_src clearChangeTracking];
+		ZDCDictionary *dict_dst = [dict_src copy];
+		
+		// Make a random number of changes to the copy: [0 - 30)
+		
+		NSUInteger changeCount = (NSUInteger)arc4random_uniform((uint32_t)30);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)3);
+			
+			if (random == 0)
+			{
+				dict_dst[[self randomLetters:8]] = [self randomLetters:4];
+			}
+			else if (random == 1)
+			{
+				if (dict_dst.count > 0) {
+					[dict_dst removeObjectForKey:[[dict_dst allKeys] firstObject]];
+				}
+			}
+			else
+			{
+				if (dict_dst.count > 0) {
+					dict_dst[[[dict_dst allKeys] lastObject]] = [self randomLetters:4];
+				}
+			}
+		}
+		
+		NSDictionary *changeset = [ZDCDictionary changesetFrom:dict_src to:dict_dst];
+		
+		if ([dict_src isEqualToDictionary:dict_dst]) {
+			XCTAssert(changeset == nil);
+			continue;
+		}
+		
+		// Applying the diff (as an undo) to the dst should produce the src.
+		
+		ZDCDictionary *dict = [dict_dst copy];
+		[dict clearChangeTracking];
+		
+		NSError *error = nil;
+		[dict undo:changeset error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([dict isEqualToDictionary:dict_src]);
+	}}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Merge - Simple
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -602,4 +707,191 @@
 	XCTAssert([localDict[@"dict"][@"duck"] isEqualToString:@"quack"]);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Checkpoints
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_checkpoint
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict[@"cow"] = @"moo";
+	[dict clearChangeTracking];
+	
+	dict[@"duck"] = @"quack";
+	
+	ZDCDictionary *dict_a = [dict immutableCopy];
+	NSDictionary *changeset_a = [dict peakChangeset];
+	
+	id checkpoint_a = [dict checkpoint];
+	
+	dict[@"cow"] = @"mooo";
+	
+	ZDCDictionary *dict_b = [dict immutableCopy];
+	NSDictionary *changeset_b = [dict peakChangeset];
+	
+	id checkpoint_b = [dict checkpoint];
+	
+	[dict removeAllObjects];
+	[dict changeset];
+	
+	[dict restoreCheckpoint:checkpoint_b];
+	XCTAssert([dict isEqualToDictionary:dict_b]);
+	XCTAssertEqualObjects([dict peakChangeset], changeset_b);
+	
+	[dict restoreCheckpoint:checkpoint_a];
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+	XCTAssertEqualObjects([dict peakChangeset], changeset_a);
+	
+	// Restoring the outer checkpoint doesn't invalidate the inner one
+	
+	[dict restoreCheckpoint:checkpoint_b];
+	XCTAssert([dict isEqualToDictionary:dict_b]);
+	
+	// The restored changeset undoes all the way back to the baseline
+	
+	NSDictionary *changeset = [dict changeset];
+	[dict undo:changeset error:nil];
+	
+	XCTAssert(dict.count == 1);
+	XCTAssertEqualObjects(dict[@"cow"], @"moo");
+}
+
+- (void)test_copyOnWrite
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict[@"cow"] = @"moo";
+	
+	ZDCDictionary *copy = [dict copy];
+	
+	dict[@"duck"] = @"quack";
+	copy[@"cow"] = nil;
+	
+	XCTAssert(dict.count == 2);
+	XCTAssert(copy.count == 0);
+	
+	[copy clearChangeTracking];
+	
+	XCTAssert(dict.hasChanges);
+	XCTAssert(!copy.hasChanges);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Snapshots
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_snapshot_basic
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	XCTAssert([dict latestSnapshot] == nil);
+	
+	dict[@"cow"] = @"moo";
+	
+	ZDCDictionary *snapshot_a = [dict publishSnapshot];
+	XCTAssert(snapshot_a.isImmutable);
+	XCTAssert(!dict.isImmutable);
+	XCTAssert([dict latestSnapshot] == snapshot_a);
+	
+	// The writer can continue mutating (and tracking changes)
+	
+	dict[@"duck"] = @"quack";
+	
+	XCTAssert(snapshot_a.count == 1);
+	XCTAssert([dict latestSnapshot] == snapshot_a);
+	
+	ZDCDictionary *snapshot_b = [dict publishSnapshot];
+	XCTAssert([dict latestSnapshot] == snapshot_b);
+	
+	// Previously fetched snapshots remain valid
+	
+	XCTAssert(snapshot_a.count == 1);
+	XCTAssert(snapshot_b.count == 2);
+	
+	NSDictionary *changeset = [dict changeset];
+	XCTAssert(changeset != nil);
+	
+	[dict undo:changeset error:nil];
+	XCTAssert(dict.count == 0);
+	XCTAssert(snapshot_b.count == 2);
+}
+
+- (void)test_snapshot_nested
+{
+	ZDCDictionary *child = [[ZDCDictionary alloc] init];
+	child[@"cow"] = @"moo";
+	
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict[@"child"] = child;
+	
+	ZDCDictionary *snapshot = [dict publishSnapshot];
+	XCTAssert(snapshot.isImmutable);
+	
+	// The writer's child isn't made immutable. The snapshot has its own (immutable) copy.
+	
+	ZDCDictionary *snapshotChild = snapshot[@"child"];
+	XCTAssert(snapshotChild != child);
+	XCTAssert(snapshotChild.isImmutable);
+	XCTAssert(!child.isImmutable);
+	XCTAssert(dict[@"child"] == child);
+	
+	child[@"cow"] = @"mooooo";
+	child[@"duck"] = @"quack";
+	
+	XCTAssertEqualObjects(snapshotChild[@"cow"], @"moo");
+	XCTAssert(snapshotChild.count == 1);
+	
+	// The writer's change tracking covers the nested mutations
+	
+	NSDictionary *changeset = [dict changeset];
+	XCTAssert(changeset != nil);
+	
+	[dict undo:changeset error:nil];
+	XCTAssertEqualObjects(child[@"cow"], @"moo");
+	XCTAssert(child.count == 1);
+}
+
+- (void)test_snapshot_concurrentReaders
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict[@"x"] = @(0);
+	dict[@"y"] = @(0);
+	[dict publishSnapshot];
+	
+	__block BOOL done = NO;
+	__block NSUInteger inconsistentCount = 0;
+	
+	dispatch_group_t group = dispatch_group_create();
+	dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0);
+	
+	for (NSUInteger i = 0; i < 4; i++)
+	{
+		dispatch_group_async(group, queue, ^{
+			
+			while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) { @autoreleasepool
+			{
+				ZDCDictionary *snapshot = [dict latestSnapshot];
+				
+				// The writer only publishes consistent states (x == y)
+				
+				if (!snapshot.isImmutable || ![snapshot[@"x"] isEqual:snapshot[@"y"]]) {
+					__atomic_add_fetch(&inconsistentCount, 1, __ATOMIC_RELAXED);
+				}
+			}}
+		});
+	}
+	
+	for (NSUInteger version = 1; version <= 5000; version++) { @autoreleasepool
+	{
+		dict[@"x"] = @(version);
+		dict[@"y"] = @(version);
+		
+		[dict publishSnapshot];
+	}}
+	
+	__atomic_store_n(&done, YES, __ATOMIC_RELEASE);
+	dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+	
+	XCTAssert(inconsistentCount == 0);
+	XCTAssertEqualObjects([dict latestSnapshot][@"x"], @(5000));
+}
+
 @end
@@ -0,0 +1,409 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <XCTest/XCTest.h>
+#import "ZDCInt64Array.h"
+#import "ZDCArray.h"
+
+@interface test_ZDCInt64Array : XCTestCase
+@end
+
+@implementation test_ZDCInt64Array
+
+/**
+ * Small range, so the array will contain duplicates.
+ */
+- (int64_t)randomValue
+{
+	return (int64_t)arc4random_uniform((uint32_t)20) - 10;
+}
+
+- (void)randomlyMutate:(ZDCInt64Array *)array changeCount:(NSUInteger)changeCount
+{
+	for (NSUInteger i = 0; i < changeCount; i++)
+	{
+		uint32_t random = arc4random_uniform((uint32_t)5);
+		
+		if (random == 0 || array.count == 0)
+		{
+			[array addValue:[self randomValue]];
+		}
+		else if (random == 1)
+		{
+			NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+			[array removeValueAtIndex:idx];
+		}
+		else if (random == 2)
+		{
+			NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+			[array replaceValueAtIndex:idx withValue:[self randomValue]];
+		}
+		else if (random == 3)
+		{
+			NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)(array.count + 1));
+			[array insertValue:[self randomValue] atIndex:idx];
+		}
+		else
+		{
+			NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+			NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+			[array moveValueAtIndex:oldIdx toIndex:newIdx];
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Basic
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_basic
+{
+	int64_t const values[] = { 1, 2, 3, 2, INT64_MAX, INT64_MIN };
+	
+	ZDCInt64Array *array = [[ZDCInt64Array alloc] initWithValues:values count:6];
+	
+	XCTAssert(array.count == 6);
+	XCTAssert([array valueAtIndex:4] == INT64_MAX);
+	XCTAssert([array indexOfValue:2] == 1);
+	XCTAssert([array indexOfValue:42] == NSNotFound);
+	XCTAssert([array containsValue:INT64_MIN]);
+	
+	[array removeValue:2];
+	XCTAssert(array.count == 4);
+	XCTAssert(![array containsValue:2]);
+	
+	[array moveValueAtIndex:0 toIndex:3];
+	XCTAssertEqualObjects(array.rawArray, (@[ @(3), @(INT64_MAX), @(INT64_MIN), @(1) ]));
+	
+	XCTAssert(array.hasChanges);
+	[array clearChangeTracking];
+	XCTAssert(!array.hasChanges);
+	
+	// A change that's reverted by hand is not a change
+	
+	[array addValue:7];
+	[array removeValueAtIndex:4];
+	XCTAssert(!array.hasChanges);
+	XCTAssert([array changeset] == nil);
+}
+
+- (void)test_trackChanges
+{
+	int64_t const values[] = { 1, 2, 3 };
+	
+	ZDCInt64Array *tracked = [[ZDCInt64Array alloc] initWithValues:values count:3];
+	ZDCInt64Array *untracked = [[ZDCInt64Array alloc] initWithValues:values count:3 trackChanges:NO];
+	
+	XCTAssert(tracked.hasChanges);
+	XCTAssert(!untracked.hasChanges);
+	XCTAssert([untracked changeset] == nil);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Undo: Fuzz
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_undo_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 5000; round++) { @autoreleasepool
+	{
+		ZDCInt64Array *array = [[ZDCInt64Array alloc] init];
+		
+		// Start with an object that has a random number of values [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[array addValue:[self randomValue]];
+		}
+		
+		[array clearChangeTracking];
+		ZDCInt64Array *array_a = [array immutableCopy];
+		
+		// Now make a random number of changes: [1 - 30)
+		
+		[self randomlyMutate:array changeCount:(1 + (NSUInteger)arc4random_uniform((uint32_t)29))];
+		
+		NSDictionary *changeset_undo = [array changeset];
+		ZDCInt64Array *array_b = [array immutableCopy];
+		
+		NSDictionary *changeset_redo = [array undo:changeset_undo error:nil]; // a <- b
+		XCTAssert([array isEqualToInt64Array:array_a]);
+		
+		[array undo:changeset_redo error:nil]; // a -> b
+		XCTAssert([array isEqualToInt64Array:array_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Interop
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_interop_fuzz
+{
+	for (NSUInteger round = 0; round < 1000; round++) { @autoreleasepool
+	{
+		ZDCInt64Array *array = [[ZDCInt64Array alloc] init];
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			[array addValue:[self randomValue]];
+		}
+		
+		[array clearChangeTracking];
+		ZDCInt64Array *array_a = [array immutableCopy];
+		
+		[self randomlyMutate:array changeCount:(1 + (NSUInteger)arc4random_uniform((uint32_t)29))];
+		
+		ZDCInt64Array *array_b = [array immutableCopy];
+		NSDictionary *changeset = [array changeset];
+		
+		// A changeset from the unboxed array can be applied to a boxed array (and vice versa).
+		
+		ZDCArray<NSNumber*> *boxed =
+		  [[ZDCArray alloc] initWithArray:array_b.rawArray copyItems:NO trackChanges:NO];
+		
+		NSError *error = nil;
+		NSDictionary *redo = [boxed undo:(changeset ?: @{}) error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssertEqualObjects(boxed.rawArray, array_a.rawArray);
+		
+		[array undo:redo error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([array isEqualToInt64Array:array_b]);
+	}}
+}
+
+- (void)test_interop_blockMove
+{
+	int64_t raw[100];
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		raw[i] = (int64_t)i;
+	}
+	
+	ZDCArray<NSNumber*> *boxed = [[ZDCArray alloc] init];
+	boxed.compressesMoves = YES;
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		[boxed addObject:@(raw[i])];
+	}
+	[boxed clearChangeTracking];
+	
+	// Drag rows [50, 80) to the front
+	for (NSUInteger i = 0; i < 30; i++)
+	{
+		[boxed moveObjectAtIndex:(50 + i) toIndex:i];
+	}
+	
+	NSDictionary *changeset = [boxed changeset];
+	
+	BOOL containsBlockMove = NO;
+	for (id value in [changeset[@"moved"] allValues])
+	{
+		if ([value isKindOfClass:[NSArray class]]) containsBlockMove = YES;
+	}
+	XCTAssert(containsBlockMove);
+	
+	// Undo
+	
+	ZDCInt64Array *array = [[ZDCInt64Array alloc] initWithArray:boxed.rawArray];
+	[array clearChangeTracking];
+	
+	NSError *error = nil;
+	[array undo:changeset error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([array isEqualToInt64Array:[[ZDCInt64Array alloc] initWithValues:raw count:100]]);
+	
+	// Merge (with the block-move changeset pending)
+	
+	ZDCInt64Array *localArray = [[ZDCInt64Array alloc] initWithArray:boxed.rawArray];
+	[localArray clearChangeTracking];
+	
+	ZDCInt64Array *cloudArray = [[ZDCInt64Array alloc] initWithValues:raw count:100];
+	[cloudArray addValue:100];
+	[cloudArray makeImmutable];
+	
+	ZDCArray<NSNumber*> *boxedLocal =
+	  [[ZDCArray alloc] initWithArray:localArray.rawArray copyItems:NO trackChanges:NO];
+	ZDCArray<NSNumber*> *boxedCloud =
+	  [[ZDCArray alloc] initWithArray:cloudArray.rawArray copyItems:NO trackChanges:NO];
+	
+	NSDictionary *mergeChangeset = [localArray mergeCloudVersion: cloudArray
+	                                       withPendingChangesets: @[ changeset ]
+	                                                       error: &error];
+	[boxedLocal mergeCloudVersion:boxedCloud withPendingChangesets:@[ changeset ] error:nil];
+	
+	XCTAssert(error == nil);
+	XCTAssertEqualObjects(localArray.rawArray, boxedLocal.rawArray);
+	
+	// The merge changeset is accepted by undo
+	
+	if (mergeChangeset.count > 0)
+	{
+		[localArray undo:mergeChangeset error:&error];
+		XCTAssert(error == nil);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_diff_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCInt64Array *array_src = [[ZDCInt64Array alloc] init];
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[array_src addValue:[self randomValue]];
+		}
+		
+		[array_src clearChangeTracking];
+		ZDCInt64Array *array_dst = [array_src copy];
+		
+		[self randomlyMutate:array_dst changeCount:(NSUInteger)arc4random_uniform((uint32_t)30)];
+		
+		NSDictionary *changeset = [ZDCInt64Array changesetFrom:array_src to:array_dst];
+		
+		if ([array_src isEqualToInt64Array:array_dst]) {
+			XCTAssert(changeset == nil);
+			continue;
+		}
+		
+		// Applying the diff (as an undo) to the dst should produce the src.
+		
+		ZDCInt64Array *array = [array_dst copy];
+		[array clearChangeTracking];
+		
+		NSError *error = nil;
+		[array undo:changeset error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([array isEqualToInt64Array:array_src]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Import: Fuzz
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_import_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 1000; round++) { @autoreleasepool
+	{
+		NSMutableArray<NSDictionary *> *changesets = [NSMutableArray array];
+		
+		ZDCInt64Array *array = [[ZDCInt64Array alloc] init];
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			[array addValue:[self randomValue]];
+		}
+		
+		[array clearChangeTracking];
+		ZDCInt64Array *array_a = [array immutableCopy];
+		
+		// Make a random number of changesets: [1 - 10)
+		
+		NSUInteger changesetCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)9);
+		for (NSUInteger i = 0; i < changesetCount; i++)
+		{
+			[self randomlyMutate:array changeCount:(1 + (NSUInteger)arc4random_uniform((uint32_t)5))];
+			
+			[changesets addObject:([array changeset] ?: @{})];
+		}
+		
+		ZDCInt64Array *array_b = [array immutableCopy];
+		
+		NSError *error = nil;
+		NSDictionary *changeset_merged = [array mergeChangesets:changesets error:&error];
+		XCTAssert(error == nil);
+		
+		NSDictionary *changeset_redo = [array undo:changeset_merged error:&error];
+		XCTAssert(error == nil);
+		XCTAssert([array isEqualToInt64Array:array_a]);
+		
+		[array undo:changeset_redo error:&error];
+		XCTAssert(error == nil);
+		XCTAssert([array isEqualToInt64Array:array_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Merge
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_merge_matchesBoxed
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		NSMutableArray<NSDictionary *> *changesets = [NSMutableArray array];
+		
+		ZDCInt64Array *localArray = [[ZDCInt64Array alloc] init];
+		for (NSUInteger i = 0; i < 10; i++)
+		{
+			[localArray addValue:[self randomValue]];
+		}
+		
+		[localArray clearChangeTracking];
+		ZDCInt64Array *cloudArray = [localArray copy];
+		
+		{ // local changes
+			
+			[self randomlyMutate:localArray changeCount:3];
+			[changesets addObject:([localArray changeset] ?: @{})];
+		}
+		{ // cloud changes
+			
+			[self randomlyMutate:cloudArray changeCount:3];
+			[cloudArray makeImmutable];
+		}
+		
+		// The merge must produce the same result as the boxed equivalent
+		
+		ZDCArray<NSNumber*> *boxedLocal =
+		  [[ZDCArray alloc] initWithArray:localArray.rawArray copyItems:NO trackChanges:NO];
+		ZDCArray<NSNumber*> *boxedCloud =
+		  [[ZDCArray alloc] initWithArray:cloudArray.rawArray copyItems:NO trackChanges:NO];
+		
+		NSError *boxedError = nil;
+		[boxedLocal mergeCloudVersion: boxedCloud
+		        withPendingChangesets: changesets
+		                        error: &boxedError];
+		
+		NSError *error = nil;
+		[localArray mergeCloudVersion: cloudArray
+		        withPendingChangesets: changesets
+		                        error: &error];
+		
+		XCTAssert((error == nil) == (boxedError == nil));
+		XCTAssertEqualObjects(localArray.rawArray, boxedLocal.rawArray);
+		XCTAssert(!localArray.hasChanges);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Coding
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_coding
+{
+	int64_t const values[] = { 0, -1, 1, INT64_MAX, INT64_MIN, 1 };
+	
+	ZDCInt64Array *array = [[ZDCInt64Array alloc] initWithValues:values count:6];
+	
+	NSData *data = [NSKeyedArchiver archivedDataWithRootObject:array];
+	ZDCInt64Array *decoded = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+	
+	XCTAssert([decoded isEqualToInt64Array:array]);
+	XCTAssert(!decoded.hasChanges);
+}
+
+@end
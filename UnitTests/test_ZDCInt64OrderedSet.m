@@ -0,0 +1,314 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <XCTest/XCTest.h>
+#import "ZDCInt64OrderedSet.h"
+#import "ZDCOrderedSet.h"
+
+@interface test_ZDCInt64OrderedSet : XCTestCase
+@end
+
+@implementation test_ZDCInt64OrderedSet
+
+- (int64_t)randomValue
+{
+	return (int64_t)arc4random_uniform((uint32_t)1000) - 500;
+}
+
+- (void)randomlyMutate:(ZDCInt64OrderedSet *)orderedSet changeCount:(NSUInteger)changeCount
+{
+	for (NSUInteger i = 0; i < changeCount; i++)
+	{
+		uint32_t random = arc4random_uniform((uint32_t)4);
+		
+		if (random == 0 || orderedSet.count == 0)
+		{
+			[orderedSet addValue:[self randomValue]];
+		}
+		else if (random == 1)
+		{
+			NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet.count);
+			[orderedSet removeValueAtIndex:idx];
+		}
+		else if (random == 2)
+		{
+			NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)(orderedSet.count + 1));
+			[orderedSet insertValue:[self randomValue] atIndex:idx];
+		}
+		else
+		{
+			NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet.count);
+			NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet.count);
+			[orderedSet moveValueAtIndex:oldIdx toIndex:newIdx];
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Basic
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_basic
+{
+	int64_t const values[] = { 5, 3, 5, 1, INT64_MIN };
+	
+	ZDCInt64OrderedSet *orderedSet = [[ZDCInt64OrderedSet alloc] initWithValues:values count:5];
+	
+	// Duplicates are dropped (first occurrence wins)
+	
+	XCTAssert(orderedSet.count == 4);
+	XCTAssertEqualObjects(orderedSet.rawOrderedSet.array, (@[ @(5), @(3), @(1), @(INT64_MIN) ]));
+	
+	[orderedSet addValue:3];
+	XCTAssert(orderedSet.count == 4);
+	
+	[orderedSet insertValue:9 atIndex:0];
+	XCTAssert([orderedSet indexOfValue:9] == 0);
+	XCTAssert([orderedSet indexOfValue:INT64_MIN] == 4);
+	
+	[orderedSet moveValueAtIndex:4 toIndex:0];
+	XCTAssert([orderedSet indexOfValue:INT64_MIN] == 0);
+	XCTAssert([orderedSet indexOfValue:9] == 1);
+	
+	[orderedSet removeValue:5];
+	XCTAssert(![orderedSet containsValue:5]);
+	XCTAssert([orderedSet indexOfValue:5] == NSNotFound);
+	XCTAssert([orderedSet indexOfValue:1] == 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Undo: Fuzz
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_undo_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 5000; round++) { @autoreleasepool
+	{
+		ZDCInt64OrderedSet *orderedSet = [[ZDCInt64OrderedSet alloc] init];
+		
+		// Start with an object that has a random number of values [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[orderedSet addValue:[self randomValue]];
+		}
+		
+		[orderedSet clearChangeTracking];
+		ZDCInt64OrderedSet *orderedSet_a = [orderedSet immutableCopy];
+		
+		// Now make a random number of changes: [1 - 30)
+		
+		[self randomlyMutate:orderedSet changeCount:(1 + (NSUInteger)arc4random_uniform((uint32_t)29))];
+		
+		NSDictionary *changeset_undo = [orderedSet changeset];
+		ZDCInt64OrderedSet *orderedSet_b = [orderedSet immutableCopy];
+		
+		NSDictionary *changeset_redo = [orderedSet undo:changeset_undo error:nil]; // a <- b
+		XCTAssert([orderedSet isEqualToInt64OrderedSet:orderedSet_a]);
+		
+		[orderedSet undo:changeset_redo error:nil]; // a -> b
+		XCTAssert([orderedSet isEqualToInt64OrderedSet:orderedSet_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Interop
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_interop_fuzz
+{
+	for (NSUInteger round = 0; round < 1000; round++) { @autoreleasepool
+	{
+		ZDCInt64OrderedSet *orderedSet = [[ZDCInt64OrderedSet alloc] init];
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			[orderedSet addValue:[self randomValue]];
+		}
+		
+		[orderedSet clearChangeTracking];
+		ZDCInt64OrderedSet *orderedSet_a = [orderedSet immutableCopy];
+		
+		[self randomlyMutate:orderedSet changeCount:(1 + (NSUInteger)arc4random_uniform((uint32_t)29))];
+		
+		ZDCInt64OrderedSet *orderedSet_b = [orderedSet immutableCopy];
+		NSDictionary *changeset = [orderedSet changeset];
+		
+		// A changeset from the unboxed set can be applied to a boxed set (and vice versa).
+		
+		ZDCOrderedSet<NSNumber*> *boxed =
+		  [[ZDCOrderedSet alloc] initWithOrderedSet:orderedSet_b.rawOrderedSet copyItems:NO trackChanges:NO];
+		
+		NSError *error = nil;
+		NSDictionary *redo = [boxed undo:(changeset ?: @{}) error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssertEqualObjects(boxed.rawOrderedSet, orderedSet_a.rawOrderedSet);
+		
+		[orderedSet undo:redo error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([orderedSet isEqualToInt64OrderedSet:orderedSet_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_diff_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCInt64OrderedSet *orderedSet_src = [[ZDCInt64OrderedSet alloc] init];
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[orderedSet_src addValue:[self randomValue]];
+		}
+		
+		[orderedSet_src clearChangeTracking];
+		ZDCInt64OrderedSet *orderedSet_dst = [orderedSet_src copy];
+		
+		[self randomlyMutate:orderedSet_dst changeCount:(NSUInteger)arc4random_uniform((uint32_t)30)];
+		
+		NSDictionary *changeset = [ZDCInt64OrderedSet changesetFrom:orderedSet_src to:orderedSet_dst];
+		
+		if ([orderedSet_src isEqualToInt64OrderedSet:orderedSet_dst]) {
+			XCTAssert(changeset == nil);
+			continue;
+		}
+		
+		// Applying the diff (as an undo) to the dst should produce the src.
+		
+		ZDCInt64OrderedSet *orderedSet = [orderedSet_dst copy];
+		[orderedSet clearChangeTracking];
+		
+		NSError *error = nil;
+		[orderedSet undo:changeset error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([orderedSet isEqualToInt64OrderedSet:orderedSet_src]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Import: Fuzz
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_import_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 1000; round++) { @autoreleasepool
+	{
+		NSMutableArray<NSDictionary *> *changesets = [NSMutableArray array];
+		
+		ZDCInt64OrderedSet *orderedSet = [[ZDCInt64OrderedSet alloc] init];
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			[orderedSet addValue:[self randomValue]];
+		}
+		
+		[orderedSet clearChangeTracking];
+		ZDCInt64OrderedSet *orderedSet_a = [orderedSet immutableCopy];
+		
+		// Make a random number of changesets: [1 - 10)
+		
+		NSUInteger changesetCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)9);
+		for (NSUInteger i = 0; i < changesetCount; i++)
+		{
+			[self randomlyMutate:orderedSet changeCount:(1 + (NSUInteger)arc4random_uniform((uint32_t)5))];
+			
+			[changesets addObject:([orderedSet changeset] ?: @{})];
+		}
+		
+		ZDCInt64OrderedSet *orderedSet_b = [orderedSet immutableCopy];
+		
+		NSError *error = nil;
+		NSDictionary *changeset_merged = [orderedSet mergeChangesets:changesets error:&error];
+		XCTAssert(error == nil);
+		
+		NSDictionary *changeset_redo = [orderedSet undo:changeset_merged error:&error];
+		XCTAssert(error == nil);
+		XCTAssert([orderedSet isEqualToInt64OrderedSet:orderedSet_a]);
+		
+		[orderedSet undo:changeset_redo error:&error];
+		XCTAssert(error == nil);
+		XCTAssert([orderedSet isEqualToInt64OrderedSet:orderedSet_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Merge
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_merge_matchesBoxed
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		NSMutableArray<NSDictionary *> *changesets = [NSMutableArray array];
+		
+		ZDCInt64OrderedSet *localSet = [[ZDCInt64OrderedSet alloc] init];
+		for (NSUInteger i = 0; i < 10; i++)
+		{
+			[localSet addValue:[self randomValue]];
+		}
+		
+		[localSet clearChangeTracking];
+		ZDCInt64OrderedSet *cloudSet = [localSet copy];
+		
+		{ // local changes
+			
+			[self randomlyMutate:localSet changeCount:3];
+			[changesets addObject:([localSet changeset] ?: @{})];
+		}
+		{ // cloud changes
+			
+			[self randomlyMutate:cloudSet changeCount:3];
+			[cloudSet makeImmutable];
+		}
+		
+		// The merge must produce the same result as the boxed equivalent
+		
+		ZDCOrderedSet<NSNumber*> *boxedLocal =
+		  [[ZDCOrderedSet alloc] initWithOrderedSet:localSet.rawOrderedSet copyItems:NO trackChanges:NO];
+		ZDCOrderedSet<NSNumber*> *boxedCloud =
+		  [[ZDCOrderedSet alloc] initWithOrderedSet:cloudSet.rawOrderedSet copyItems:NO trackChanges:NO];
+		
+		NSError *boxedError = nil;
+		[boxedLocal mergeCloudVersion: boxedCloud
+		        withPendingChangesets: changesets
+		                        error: &boxedError];
+		
+		NSError *error = nil;
+		[localSet mergeCloudVersion: cloudSet
+		      withPendingChangesets: changesets
+		                      error: &error];
+		
+		XCTAssert((error == nil) == (boxedError == nil));
+		XCTAssertEqualObjects(localSet.rawOrderedSet, boxedLocal.rawOrderedSet);
+		XCTAssert(!localSet.hasChanges);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Coding
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_coding
+{
+	int64_t const values[] = { 0, -1, 1, INT64_MAX, INT64_MIN };
+	
+	ZDCInt64OrderedSet *orderedSet = [[ZDCInt64OrderedSet alloc] initWithValues:values count:5];
+	
+	NSData *data = [NSKeyedArchiver archivedDataWithRootObject:orderedSet];
+	ZDCInt64OrderedSet *decoded = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+	
+	XCTAssert([decoded isEqualToInt64OrderedSet:orderedSet]);
+	XCTAssert([decoded indexOfValue:INT64_MAX] == 3);
+	XCTAssert(!decoded.hasChanges);
+}
+
+@end
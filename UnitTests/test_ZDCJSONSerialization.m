@@ -0,0 +1,611 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <XCTest/XCTest.h>
+
+#import "ZDCJSONSerialization.h"
+#import "ZDCArray.h"
+#import "ZDCConcurrentDictionary.h"
+#import "ZDCDictionary.h"
+#import "ZDCInt64Array.h"
+#import "ZDCInt64OrderedSet.h"
+#import "ZDCNull.h"
+#import "ZDCOrderedDictionary.h"
+#import "ZDCOrderedSet.h"
+#import "ZDCRef.h"
+#import "ZDCSet.h"
+
+#import "ComplexRecord.h"
+#import "SimpleRecord.h"
+
+/**
+ * A record that's never registered with ZDCJSONSerialization.
+ */
+@interface UnregisteredRecord : ZDCRecord
+@property (nonatomic, copy, readwrite, nullable) NSString *name;
+@end
+
+@implementation UnregisteredRecord
+@end
+
+@interface test_ZDCJSONSerialization : XCTestCase
+@end
+
+@implementation test_ZDCJSONSerialization
+
++ (void)setUp
+{
+	[super setUp];
+	
+	[ZDCJSONSerialization registerRecordClass:[ComplexRecord class] name:@"ComplexRecord"];
+	[ZDCJSONSerialization registerRecordClass:[SimpleRecord class] name:@"SimpleRecord"];
+}
+
+- (NSString *)randomLetters:(NSUInteger)length
+{
+	NSString *alphabet = @"abcdefghijklmnopqrstuvwxyz";
+	NSUInteger alphabetLength = [alphabet length];
+	
+	NSMutableString *result = [NSMutableString stringWithCapacity:length];
+	
+	NSUInteger i;
+	for (i = 0; i < length; i++)
+	{
+		unichar c = [alphabet characterAtIndex:(NSUInteger)arc4random_uniform((uint32_t)alphabetLength)];
+		
+		[result appendFormat:@"%C", c];
+	}
+	
+	return result;
+}
+
+- (id)roundTrip:(id)object
+{
+	NSError *error = nil;
+	NSData *data = [ZDCJSONSerialization dataWithObject:object error:&error];
+	
+	XCTAssert(data != nil);
+	XCTAssert(error == nil);
+	
+	id result = [ZDCJSONSerialization objectWithData:data error:&error];
+	
+	XCTAssert(result != nil);
+	XCTAssert(error == nil);
+	
+	return result;
+}
+
+- (NSDictionary *)roundTripChangeset:(NSDictionary *)changeset
+{
+	NSError *error = nil;
+	NSData *data = [ZDCJSONSerialization dataWithObject:changeset error:&error];
+	
+	XCTAssert(data != nil);
+	
+	NSDictionary *result = [ZDCJSONSerialization changesetWithData:data error:&error];
+	
+	XCTAssert(result != nil);
+	XCTAssert(error == nil);
+	XCTAssertEqualObjects(result, changeset);
+	
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Values
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_values
+{
+	NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+	[indexes addIndexesInRange:NSMakeRange(2, 5)];
+	[indexes addIndex:42];
+	
+	NSArray *values = @[
+		@"plain",
+		@"quote\" backslash\\ newline\n tab\t bell\a",
+		@"unicode: caf\u00e9 \u4e2d\u6587 \U0001F600",
+		@"$notATag",
+		@"",
+		@(0), @(-1), @(42), @(INT64_MIN), @(INT64_MAX), @(UINT64_MAX),
+		@(3.14159), @(-0.1), @(1e300),
+		@YES, @NO,
+		[NSNull null],
+		[ZDCNull null],
+		[ZDCRef ref],
+		indexes,
+		[NSIndexSet indexSet],
+		[NSSet setWithObjects:@"a", @(1), nil],
+		[@"data" dataUsingEncoding:NSUTF8StringEncoding],
+		[NSDate dateWithTimeIntervalSinceReferenceDate:123456.789],
+		@[ @"nested", @[ @(1), @(2) ] ],
+		@{ @"string": @"keys" },
+		@{ @(0): @"number", @(1): @"keys" },
+		@{ @"$reserved": @"key" },
+		@{}
+	];
+	
+	for (id value in values)
+	{
+		XCTAssertEqualObjects([self roundTrip:value], value);
+	}
+	
+	XCTAssertEqualObjects([self roundTrip:values], values);
+}
+
+- (void)test_booleansStayBooleans
+{
+	NSArray *decoded = [self roundTrip:@[ @YES, @(1) ]];
+	
+	XCTAssert(decoded[0] == (__bridge id)kCFBooleanTrue);
+	XCTAssert(decoded[1] != (__bridge id)kCFBooleanTrue);
+}
+
+- (void)test_containers
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict[@"cow"] = @"moo";
+	dict[@(42)] = @"answer";
+	
+	ZDCOrderedDictionary *orderedDict = [[ZDCOrderedDictionary alloc] init];
+	orderedDict[@"z"] = @(26);
+	orderedDict[@"a"] = @(1);
+	orderedDict[@"m"] = dict;
+	
+	ZDCArray *array = [[ZDCArray alloc] initWithArray:@[ @"b", @"a", @"b" ]];
+	ZDCSet *set = [[ZDCSet alloc] initWithArray:@[ @"x", @"y" ]];
+	ZDCOrderedSet *orderedSet = [[ZDCOrderedSet alloc] initWithArray:@[ @"y", @"x" ]];
+	
+	int64_t raw[] = { 5, -3, INT64_MAX, INT64_MIN, 5 };
+	ZDCInt64Array *int64Array = [[ZDCInt64Array alloc] initWithValues:raw count:5];
+	ZDCInt64OrderedSet *int64Set = [[ZDCInt64OrderedSet alloc] initWithValues:raw count:4];
+	
+	NSArray *decoded = [self roundTrip:@[ orderedDict, array, set, orderedSet, int64Array, int64Set ]];
+	
+	ZDCOrderedDictionary *decodedOrderedDict = decoded[0];
+	XCTAssertEqualObjects(decodedOrderedDict.rawOrder, orderedDict.rawOrder);
+	XCTAssertEqualObjects([decodedOrderedDict[@"m"] rawDictionary], dict.rawDictionary);
+	XCTAssert(!decodedOrderedDict.hasChanges);
+	
+	XCTAssertEqualObjects([decoded[1] rawArray], array.rawArray);
+	XCTAssertEqualObjects([decoded[2] rawSet], set.rawSet);
+	XCTAssertEqualObjects([decoded[3] rawOrderedSet], orderedSet.rawOrderedSet);
+	XCTAssertEqualObjects([decoded[4] rawArray], int64Array.rawArray);
+	XCTAssertEqualObjects([decoded[5] rawOrderedSet], int64Set.rawOrderedSet);
+	
+	for (ZDCObject *obj in decoded)
+	{
+		XCTAssert(![obj hasChanges]);
+	}
+}
+
+- (void)test_unsupported
+{
+	NSError *error = nil;
+	
+	XCTAssert([ZDCJSONSerialization dataWithObject:@[ [[NSObject alloc] init] ] error:&error] == nil);
+	XCTAssert(error.code == ZDCJSONSerializationError_UnsupportedValue);
+	
+	XCTAssert([ZDCJSONSerialization dataWithObject:@(NAN) error:&error] == nil);
+	XCTAssert(error.code == ZDCJSONSerializationError_UnsupportedValue);
+	
+	// Unregistered classes can't be re-created, so they're rejected
+	XCTAssert([ZDCJSONSerialization dataWithObject:[[UnregisteredRecord alloc] init] error:&error] == nil);
+	XCTAssert(error.code == ZDCJSONSerializationError_UnsupportedValue);
+}
+
+- (void)test_records
+{
+	ComplexRecord *cr = [[ComplexRecord alloc] init];
+	cr.someString = @"abc123";
+	cr.someInteger = 42;
+	cr.dict[@"dog"] = @"woof";
+	[cr.set addObject:@"duck"];
+	
+	SimpleRecord *sr = [[SimpleRecord alloc] init];
+	sr.someInteger = 7; // someString is nil
+	
+	NSArray *decoded = [self roundTrip:@[ cr, sr ]];
+	
+	XCTAssert([decoded[0] isKindOfClass:[ComplexRecord class]]);
+	XCTAssert([decoded[0] isEqualToComplexRecord:cr]);
+	XCTAssert(![decoded[0] hasChanges]);
+	
+	XCTAssert([decoded[1] isKindOfClass:[SimpleRecord class]]);
+	XCTAssert([decoded[1] someString] == nil);
+	XCTAssert([decoded[1] someInteger] == 7);
+	XCTAssert(![decoded[1] hasChanges]);
+}
+
+- (void)test_concurrentDictionary
+{
+	ZDCConcurrentDictionary *dict = [[ZDCConcurrentDictionary alloc] init];
+	dict[@"cow"] = @"moo";
+	dict[@(42)] = @"answer";
+	
+	ZDCConcurrentDictionary *decoded = [self roundTrip:dict];
+	
+	XCTAssert([decoded isKindOfClass:[ZDCConcurrentDictionary class]]);
+	XCTAssert([decoded isEqualToDictionary:dict]);
+	XCTAssert(![decoded hasChanges]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Changesets
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_changeset_array
+{
+	ZDCArray *array = [[ZDCArray alloc] init];
+	for (NSUInteger i = 0; i < 20; i++)
+	{
+		[array addObject:[self randomLetters:6]];
+	}
+	[array clearChangeTracking];
+	ZDCArray *array_a = [array immutableCopy];
+	
+	[array removeObjectAtIndex:3];
+	[array insertObject:@"inserted" atIndex:0];
+	[array moveObjectAtIndex:10 toIndex:2];
+	
+	NSDictionary *changeset = [self roundTripChangeset:[array changeset]];
+	
+	XCTAssert([array undo:changeset error:nil] != nil);
+	XCTAssert([array isEqualToArray:array_a]);
+}
+
+- (void)test_changeset_orderedDictionary
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	for (NSUInteger i = 0; i < 20; i++)
+	{
+		dict[[self randomLetters:6]] = @(i);
+	}
+	[dict clearChangeTracking];
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	
+	dict[[dict keyAtIndex:0]] = @"changed";
+	[dict removeObjectAtIndex:5];
+	[dict moveObjectAtIndex:7 toIndex:1];
+	dict[@"$added"] = @"reserved prefix";
+	
+	NSDictionary *changeset = [self roundTripChangeset:[dict changeset]];
+	
+	XCTAssert([dict undo:changeset error:nil] != nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+}
+
+- (void)test_changeset_sets
+{
+	ZDCSet *set = [[ZDCSet alloc] initWithArray:@[ @"a", @"b", @"c" ]];
+	[set clearChangeTracking];
+	
+	[set removeObject:@"b"];
+	[set addObject:@"d"];
+	
+	[self roundTripChangeset:[set changeset]];
+	
+	ZDCOrderedSet *orderedSet = [[ZDCOrderedSet alloc] initWithArray:@[ @"a", @"b", @"c" ]];
+	[orderedSet clearChangeTracking];
+	
+	[orderedSet removeObject:@"b"];
+	[orderedSet addObject:@"d"];
+	[orderedSet moveObjectAtIndex:2 toIndex:0];
+	
+	[self roundTripChangeset:[orderedSet changeset]];
+}
+
+- (void)test_changeset_int64
+{
+	int64_t raw[] = { 1, 2, 3, 4, 5 };
+	
+	ZDCInt64Array *array = [[ZDCInt64Array alloc] initWithValues:raw count:5];
+	[array clearChangeTracking];
+	
+	[array removeValueAtIndex:1];
+	[array addValue:-7];
+	[array moveValueAtIndex:0 toIndex:3];
+	
+	[self roundTripChangeset:[array changeset]];
+	
+	ZDCInt64OrderedSet *set = [[ZDCInt64OrderedSet alloc] initWithValues:raw count:5];
+	[set clearChangeTracking];
+	
+	[set removeValue:2];
+	[set addValue:9];
+	
+	[self roundTripChangeset:[set changeset]];
+}
+
+- (void)test_changeset_record
+{
+	ComplexRecord *cr = [[ComplexRecord alloc] init];
+	cr.someString = @"abc123";
+	cr.dict[@"dog"] = @"woof";
+	[cr.set addObject:@"duck"];
+	[cr clearChangeTracking];
+	
+	ComplexRecord *cr_a = [cr immutableCopy];
+	
+	cr.someString = @"def456";
+	cr.someInteger = 43;
+	cr.dict[@"dog"] = @"bark";
+	cr.dict[@"cat"] = @"meow";
+	[cr.set removeObject:@"duck"];
+	
+	// Includes nested changesets (refs)
+	NSDictionary *changeset = [self roundTripChangeset:[cr changeset]];
+	
+	XCTAssert([cr undo:changeset error:nil] != nil);
+	XCTAssert([cr isEqualToComplexRecord:cr_a]);
+}
+
+- (void)test_changeset_recordValues
+{
+	SimpleRecord *sr_a = [[SimpleRecord alloc] init];
+	sr_a.someString = @"original";
+	sr_a.someInteger = 1;
+	
+	SimpleRecord *sr_b = [[SimpleRecord alloc] init];
+	sr_b.someString = @"replacement";
+	sr_b.someInteger = 2;
+	
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict[@"record"] = sr_a;
+	[dict clearChangeTracking];
+	
+	dict[@"record"] = sr_b;
+	
+	// The changeset stores the original record as a value
+	NSError *error = nil;
+	NSData *data = [ZDCJSONSerialization dataWithObject:[dict changeset] error:&error];
+	XCTAssert(data != nil);
+	
+	NSDictionary *changeset = [ZDCJSONSerialization changesetWithData:data error:&error];
+	XCTAssert(changeset != nil);
+	XCTAssert(error == nil);
+	
+	XCTAssert([dict undo:changeset error:nil] != nil);
+	
+	SimpleRecord *restored = dict[@"record"];
+	XCTAssert([restored isKindOfClass:[SimpleRecord class]]);
+	XCTAssert([restored isEqualToSimpleRecord:sr_a]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Streams
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_stream
+{
+	// Large enough to require multiple flushes
+	
+	NSMutableDictionary *values = [NSMutableDictionary dictionary];
+	for (NSUInteger i = 0; i < 20000; i++)
+	{
+		values[@(i)] = [self randomLetters:8];
+	}
+	NSDictionary *changeset = @{ @"values": values };
+	
+	NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+	[stream open];
+	
+	NSError *error = nil;
+	BOOL result = [ZDCJSONSerialization writeObject:changeset toStream:stream error:&error];
+	
+	NSData *data = [stream propertyForKey:NSStreamDataWrittenToMemoryStreamKey];
+	[stream close];
+	
+	XCTAssert(result);
+	XCTAssert(error == nil);
+	XCTAssertEqualObjects(data, [ZDCJSONSerialization dataWithObject:changeset error:nil]);
+	XCTAssertEqualObjects([ZDCJSONSerialization changesetWithData:data error:nil], changeset);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Malformed
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_malformed
+{
+	NSArray<NSString *> *inputs = @[
+		@"",
+		@"{",
+		@"[1,]",
+		@"{\"a\":1,}",
+		@"01",
+		@"1.",
+		@"\"unterminated",
+		@"\"bad escape \\x\"",
+		@"\"\\ud800\"",
+		@"{\"a\":1} trailing",
+		@"{\"$unknown\":1}",
+		@"{\"a\":1,\"$b\":2}",
+		@"{\"$null\":true,\"extra\":1}",
+		@"{\"$indexes\":[[-1,2]]}",
+		@"{\"$indexes\":[[1,0]]}",
+		@"{\"$map\":[1]}",
+		@"{\"$ZDCInt64Array\":[1.5]}",
+		@"{\"$ZDCInt64Array\":[9223372036854775808]}",
+		@"{\"$ZDCConcurrentDictionary\":[]}",
+		@"{\"$class\":[\"Unregistered\",{}]}",
+		@"{\"$class\":[1,{}]}",
+		@"{\"$class\":[\"SimpleRecord\",[]]}",
+		@"{\"$class\":[\"SimpleRecord\",{\"notAProperty\":1}]}",
+	];
+	
+	for (NSString *input in inputs)
+	{
+		NSError *error = nil;
+		id result = [ZDCJSONSerialization objectWithData:[input dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		
+		XCTAssert(result == nil, @"Accepted malformed input: %@", input);
+		XCTAssert(error.code == ZDCJSONSerializationError_MalformedJSON, @"Input: %@", input);
+	}
+	
+	// Deeply nested input fails gracefully
+	
+	NSMutableString *deep = [NSMutableString string];
+	for (NSUInteger i = 0; i < 100000; i++) {
+		[deep appendString:@"["];
+	}
+	XCTAssert([ZDCJSONSerialization objectWithData:[deep dataUsingEncoding:NSUTF8StringEncoding] error:nil] == nil);
+}
+
+- (void)test_notAChangeset
+{
+	NSArray<NSString *> *inputs = @[
+		@"[]",
+		@"{\"unknown\":{}}",
+		@"{\"added\":\"string\"}",
+		@"{\"moved\":[]}",
+		@"{\"refs\":{\"child\":{\"values\":[]}}}",
+	];
+	
+	for (NSString *input in inputs)
+	{
+		NSError *error = nil;
+		id result = [ZDCJSONSerialization changesetWithData:[input dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+		
+		XCTAssert(result == nil, @"Accepted invalid changeset: %@", input);
+		XCTAssert(error.code == ZDCJSONSerializationError_NotAChangeset, @"Input: %@", input);
+	}
+	
+	NSData *valid = [@"{\"refs\":{\"child\":{\"values\":{}}},\"added\":{\"$indexes\":[]}}" dataUsingEncoding:NSUTF8StringEncoding];
+	XCTAssert([ZDCJSONSerialization changesetWithData:valid error:nil] != nil);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Performance
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The "convert, then NSJSONSerialization" approach we're comparing against:
+ * an intermediate (JSON compatible) copy of the graph, using the same tags.
+ */
+- (id)foundationJSONObject:(id)value
+{
+	if ([value isKindOfClass:[NSString class]] || [value isKindOfClass:[NSNumber class]]) {
+		return value;
+	}
+	if ([value isKindOfClass:[NSDictionary class]])
+	{
+		NSMutableArray *pairs = [NSMutableArray array];
+		[(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+			[pairs addObject:[self foundationJSONObject:key]];
+			[pairs addObject:[self foundationJSONObject:obj]];
+		}];
+		return @{ @"$map": pairs };
+	}
+	if ([value isKindOfClass:[NSIndexSet class]])
+	{
+		NSMutableArray *ranges = [NSMutableArray array];
+		[(NSIndexSet *)value enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+			[ranges addObject:@[ @(range.location), @(range.length) ]];
+		}];
+		return @{ @"$indexes": ranges };
+	}
+	if ([value isKindOfClass:[ZDCNull class]]) {
+		return @{ @"$null": @YES };
+	}
+	
+	XCTFail(@"Unexpected value in benchmark: %@", value);
+	return [NSNull null];
+}
+
+- (id)objectFromFoundationJSONObject:(id)value
+{
+	if (![value isKindOfClass:[NSDictionary class]]) {
+		return value;
+	}
+	
+	NSDictionary *dict = (NSDictionary *)value;
+	
+	NSArray *pairs = dict[@"$map"];
+	if (pairs)
+	{
+		NSMutableDictionary *result = [NSMutableDictionary dictionaryWithCapacity:(pairs.count / 2)];
+		for (NSUInteger i = 0; i + 1 < pairs.count; i += 2)
+		{
+			result[[self objectFromFoundationJSONObject:pairs[i]]] = [self objectFromFoundationJSONObject:pairs[i+1]];
+		}
+		return result;
+	}
+	
+	NSArray *ranges = dict[@"$indexes"];
+	if (ranges)
+	{
+		NSMutableIndexSet *result = [NSMutableIndexSet indexSet];
+		for (NSArray *range in ranges)
+		{
+			[result addIndexesInRange:NSMakeRange([range[0] unsignedIntegerValue], [range[1] unsignedIntegerValue])];
+		}
+		return result;
+	}
+	
+	return [ZDCNull null];
+}
+
+- (NSDictionary *)benchmarkChangeset
+{
+	ZDCArray *array = [[ZDCArray alloc] init];
+	for (NSUInteger i = 0; i < 20000; i++)
+	{
+		[array addObject:[self randomLetters:12]];
+	}
+	[array clearChangeTracking];
+	
+	for (NSUInteger i = 0; i < 5000; i++)
+	{
+		NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)array.count);
+		
+		switch (i % 3)
+		{
+			case 0  : [array removeObjectAtIndex:idx]; break;
+			case 1  : [array insertObject:[self randomLetters:12] atIndex:idx]; break;
+			default : [array moveObjectAtIndex:idx toIndex:(NSUInteger)arc4random_uniform((uint32_t)array.count)];
+		}
+	}
+	
+	return [array changeset];
+}
+
+- (void)test_performance_streaming
+{
+	NSDictionary *changeset = [self benchmarkChangeset];
+	
+	[self measureBlock:^{
+		
+		NSData *data = [ZDCJSONSerialization dataWithObject:changeset error:nil];
+		NSDictionary *decoded = [ZDCJSONSerialization changesetWithData:data error:nil];
+		
+		XCTAssert(decoded.count == changeset.count);
+	}];
+}
+
+- (void)test_performance_foundation
+{
+	NSDictionary *changeset = [self benchmarkChangeset];
+	
+	[self measureBlock:^{
+		
+		NSMutableDictionary *converted = [NSMutableDictionary dictionary];
+		[changeset enumerateKeysAndObjectsUsingBlock:^(NSString *key, id obj, BOOL *stop) {
+			converted[key] = [self foundationJSONObject:obj];
+		}];
+		
+		NSData *data = [NSJSONSerialization dataWithJSONObject:converted options:0 error:nil];
+		NSDictionary *json = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+		
+		NSMutableDictionary *decoded = [NSMutableDictionary dictionary];
+		[json enumerateKeysAndObjectsUsingBlock:^(NSString *key, id obj, BOOL *stop) {
+			decoded[key] = [self objectFromFoundationJSONObject:obj];
+		}];
+		
+		XCTAssert(decoded.count == changeset.count);
+	}];
+}
+
+@end
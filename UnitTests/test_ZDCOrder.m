@@ -5,6 +5,7 @@
 
 #import <XCTest/XCTest.h>
 #import "ZDCOrder.h"
+#import "ZDCInternTable.h"
 
 @interface test_ZDCOrder : XCTestCase
 @end
@@ -99,4 +100,187 @@
 	}}
 }
 
+- (void)test_estimate_interned
+{
+	// With interned keys, the estimator compares by pointer only.
+	// The result must match the estimate calculated via isEqual:.
+	
+	ZDCInternTable *table = [ZDCInternTable sharedTable];
+	
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		NSUInteger arrayCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)30);
+		
+		NSMutableArray<NSString*> *src = [NSMutableArray arrayWithCapacity:arrayCount];
+		for (NSUInteger i = 0; i < arrayCount; i++)
+		{
+			[src addObject:[NSString stringWithFormat:@"%@-%llu", [self randomLetters:4], (unsigned long long)i]];
+		}
+		
+		// Use distinct (but equal) instances within dst, as would be the case for a cloud version
+		NSMutableArray<NSString*> *dst = [NSMutableArray arrayWithCapacity:arrayCount];
+		for (NSString *key in src)
+		{
+			[dst addObject:[key mutableCopy]];
+		}
+		
+		NSUInteger changeCount = (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)dst.count);
+			NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)dst.count);
+			
+			NSString *key = dst[oldIdx];
+			[dst removeObjectAtIndex:oldIdx];
+			[dst insertObject:key atIndex:newIdx];
+		}
+		
+		NSArray *expected = [ZDCOrder estimateChangesetFrom:src to:dst hints:nil];
+		NSArray *changes = [ZDCOrder estimateChangesetFrom: [table internKeys:src]
+		                                                to: [table internKeys:dst]
+		                                             hints: nil
+		                                          interned: YES];
+		
+		XCTAssertEqualObjects(changes, expected);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Reconcile
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The original implementation of the order reconciliation (found in the merge methods),
+ * which searches & shuffles both arrays on every mismatch.
+ */
+- (NSArray<NSArray*> *)naiveReconcileLocalOrder:(NSArray *)localOrder
+                                     cloudOrder:(NSArray *)cloudOrder
+                                    movedRemote:(NSSet *)movedRemote
+{
+	NSMutableArray *order_localVersion = [localOrder mutableCopy];
+	NSMutableArray *order_cloudVersion = [cloudOrder mutableCopy];
+	
+	NSMutableArray<NSArray*> *moves = [NSMutableArray array];
+	
+	for (NSUInteger i = 0; i < order_cloudVersion.count; i++)
+	{
+		id key_remote = order_cloudVersion[i];
+		id key_local = order_localVersion[i];
+		
+		if (![key_remote isEqual:key_local])
+		{
+			if ([movedRemote containsObject:key_remote])
+			{
+				NSRange searchRange = NSMakeRange(i+1, order_localVersion.count-i-1);
+				NSUInteger idx = [order_localVersion indexOfObject:key_remote inRange:searchRange];
+				
+				[order_localVersion removeObjectAtIndex:idx];
+				[order_localVersion insertObject:key_remote atIndex:i];
+				
+				[moves addObject:@[ key_remote, ((i > 0) ? order_localVersion[i-1] : [NSNull null]) ]];
+			}
+			else
+			{
+				NSRange searchRange = NSMakeRange(i+1, order_cloudVersion.count-i-1);
+				NSUInteger idx = [order_cloudVersion indexOfObject:key_local inRange:searchRange];
+				
+				[order_cloudVersion removeObjectAtIndex:idx];
+				[order_cloudVersion insertObject:key_local atIndex:i];
+			}
+		}
+	}
+	
+	return moves;
+}
+
+- (void)test_reconcile_fuzz
+{
+	for (NSUInteger round = 0; round < 5000; round++) { @autoreleasepool
+	{
+		NSUInteger arrayCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)30);
+		
+		NSMutableArray<NSString*> *localOrder = [NSMutableArray arrayWithCapacity:arrayCount];
+		for (NSUInteger i = 0; i < arrayCount; i++)
+		{
+			[localOrder addObject:[NSString stringWithFormat:@"%@-%llu", [self randomLetters:4], (unsigned long long)i]];
+		}
+		
+		NSMutableArray<NSString*> *cloudOrder = [localOrder mutableCopy];
+		NSMutableSet<NSString*> *movedRemote = [NSMutableSet set];
+		
+		NSUInteger changeCount = (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)cloudOrder.count);
+			NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)cloudOrder.count);
+			
+			NSString *key = cloudOrder[oldIdx];
+			[cloudOrder removeObjectAtIndex:oldIdx];
+			[cloudOrder insertObject:key atIndex:newIdx];
+			
+			// Sometimes the hints are wrong (i.e. local wins)
+			if (arc4random_uniform((uint32_t)2) == 0) {
+				[movedRemote addObject:key];
+			}
+		}
+		
+		NSArray *expected =
+		  [self naiveReconcileLocalOrder:localOrder cloudOrder:cloudOrder movedRemote:movedRemote];
+		
+		NSMutableArray<NSArray*> *moves = [NSMutableArray array];
+		
+		[ZDCOrder reconcileLocalOrder: localOrder
+		                   cloudOrder: cloudOrder
+		                  movedRemote: movedRemote
+		                identityFirst: NO
+		                   usingBlock:^(id key, id prvKey)
+		{
+			[moves addObject:@[ key, (prvKey ?: [NSNull null]) ]];
+		}];
+		
+		XCTAssertEqualObjects(moves, expected);
+	}}
+}
+
+- (void)test_filterOrder
+{
+	NSArray *order = @[ @"a", @"b", @"c", @"d", @"e" ];
+	NSSet *keys = [NSSet setWithObjects:@"e", @"b", @"z", @"c", nil];
+	
+	XCTAssertEqualObjects([ZDCOrder filterOrder:order keys:keys], (@[ @"b", @"c", @"e" ]));
+}
+
+- (void)test_rebaseOrder
+{
+	// Added & removed (the tracked changes added "d" & moved "a")
+	{
+		NSArray *result = [ZDCOrder rebaseOrder: @[ @"a", @"b", @"c" ]
+		                              fromOrder: @[ @"b", @"c", @"a", @"d" ]
+		                                toOrder: @[ @"e", @"b", @"a", @"d" ]
+		                         matchIdentical: NO];
+		
+		XCTAssertEqualObjects(result, (@[ @"e", @"a", @"b" ]));
+	}
+	
+	// Moved
+	{
+		NSArray *result = [ZDCOrder rebaseOrder: @[ @"a", @"b", @"c", @"d" ]
+		                              fromOrder: @[ @"a", @"b", @"c" ]
+		                                toOrder: @[ @"b", @"c", @"a" ]
+		                         matchIdentical: NO];
+		
+		XCTAssertEqualObjects(result, (@[ @"b", @"c", @"a", @"d" ]));
+	}
+	
+	// Duplicates
+	{
+		NSArray *result = [ZDCOrder rebaseOrder: @[ @1, @2, @1 ]
+		                              fromOrder: @[ @1, @2, @1, @3 ]
+		                                toOrder: @[ @1, @2, @3, @1 ]
+		                         matchIdentical: NO];
+		
+		XCTAssertEqualObjects(result, (@[ @1, @2, @1 ]));
+	}
+}
+
 @end
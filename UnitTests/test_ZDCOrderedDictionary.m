@@ -5,6 +5,7 @@
 
 #import <XCTest/XCTest.h>
 #import "ZDCOrderedDictionary.h"
+#import "ZDCInternTable.h"
 
 @interface test_ZDCOrderedDictionary : XCTestCase
 @end
@@ -2480,6 +2481,398 @@
 	}}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Undo: Snapshot-and-Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_undo_snapshot_shuffle
+{
+	ZDCOrderedDictionary *dict_a = nil;
+	ZDCOrderedDictionary *dict_b = nil;
+	
+	// A full shuffle generates tracked indexes for (nearly) every key,
+	// which should trigger the switch to snapshot-and-diff.
+	
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	
+	for (NSUInteger i = 0; i < 200; i++)
+	{
+		dict[[self randomLetters:8]] = [self randomLetters:4];
+	}
+	
+	[dict clearChangeTracking];
+	dict_a = [dict immutableCopy];
+	
+	for (NSUInteger i = dict.count - 1; i > 0; i--)
+	{
+		NSUInteger j = (NSUInteger)arc4random_uniform((uint32_t)(i + 1));
+		if (i != j) {
+			[dict moveObjectAtIndex:i toIndex:j];
+		}
+	}
+	
+	NSDictionary *changeset_undo = [dict changeset];
+	dict_b = [dict immutableCopy];
+	
+	NSDictionary *indexes = changeset_undo[@"indexes"];
+	XCTAssert(indexes.count < dict.count);
+	
+	NSDictionary *changeset_redo = [dict undo:changeset_undo error:nil]; // a <- b
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+	
+	[dict undo:changeset_redo error:nil]; // a -> b
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+}
+
+- (void)test_undo_snapshot_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCOrderedDictionary *dict_a = nil;
+		ZDCOrderedDictionary *dict_b = nil;
+		
+		ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+		
+		// Start with an object that has a random number of objects [100 - 150)
+		
+		NSUInteger startCount = 100 + (NSUInteger)arc4random_uniform((uint32_t)50);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			dict[[self randomLetters:8]] = [self randomLetters:4];
+		}
+		
+		[dict clearChangeTracking];
+		dict_a = [dict immutableCopy];
+		
+		// Now make enough changes to (most likely) trigger snapshot-and-diff: [50 - 250)
+		
+		NSUInteger changeCount = 50 + (NSUInteger)arc4random_uniform((uint32_t)200);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)5);
+			
+			if (random == 0)
+			{
+				dict[[self randomLetters:8]] = @"";
+			}
+			else if (random == 1)
+			{
+				[dict removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)dict.count)];
+			}
+			else if (random == 2)
+			{
+				if (dict.count > 0)
+				{
+					NSString *key = [dict keyAtIndex:(NSUInteger)arc4random_uniform((uint32_t)dict.count)];
+					dict[key] = [self randomLetters:4];
+				}
+			}
+			else if (random == 3)
+			{
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				[dict insertObject:@"" forKey:[self randomLetters:8] atIndex:idx];
+			}
+			else
+			{
+				NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				
+				[dict moveObjectAtIndex:oldIdx toIndex:newIdx];
+			}
+		}
+		
+		NSDictionary *changeset_undo = [dict changeset];
+		dict_b = [dict immutableCopy];
+		
+		NSDictionary *changeset_redo = [dict undo:changeset_undo error:nil]; // a <- b
+		XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+		
+		[dict undo:changeset_redo error:nil]; // a -> b
+		XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Ordered Values
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_orderedValues_fuzz
+{
+	for (NSUInteger round = 0; round < 200; round++) { @autoreleasepool
+	{
+		ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			dict[[self randomLetters:8]] = [self randomLetters:4];
+		}
+		
+		// Updates (of existing keys) are mixed with structural changes,
+		// to exercise both the stale values & the refresh.
+		
+		NSUInteger changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)100);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)5);
+			
+			if (random == 0)
+			{
+				dict[[self randomLetters:8]] = [self randomLetters:4];
+			}
+			else if (random == 1 && dict.count > 1)
+			{
+				[dict removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)dict.count)];
+			}
+			else if (random == 2)
+			{
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				[dict insertObject:[self randomLetters:4] forKey:[self randomLetters:8] atIndex:idx];
+			}
+			else if (random == 3)
+			{
+				NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				
+				[dict moveObjectAtIndex:oldIdx toIndex:newIdx];
+			}
+			else
+			{
+				NSString *key = [dict keyAtIndex:(NSUInteger)arc4random_uniform((uint32_t)dict.count)];
+				dict[key] = [self randomLetters:4];
+			}
+		}
+		
+		NSDictionary *raw = dict.rawDictionary;
+		
+		for (NSUInteger idx = 0; idx < dict.count; idx++)
+		{
+			XCTAssert([[dict objectAtIndex:idx] isEqual:raw[[dict keyAtIndex:idx]]]);
+		}
+		
+		__block NSUInteger enumerated = 0;
+		[dict enumerateKeysAndObjectsUsingBlock:^(id key, id obj, NSUInteger idx, BOOL *stop) {
+			
+			XCTAssert([key isEqual:[dict keyAtIndex:idx]]);
+			XCTAssert([obj isEqual:raw[key]]);
+			enumerated++;
+		}];
+		XCTAssert(enumerated == dict.count);
+		
+		__block NSUInteger concurrentlyEnumerated = 0;
+		[dict enumerateKeysAndObjectsWithOptions: NSEnumerationConcurrent
+		                              usingBlock:^(id key, id obj, NSUInteger idx, BOOL *stop)
+		{
+			XCTAssert([obj isEqual:raw[key]]);
+			__atomic_fetch_add(&concurrentlyEnumerated, 1, __ATOMIC_RELAXED);
+		}];
+		XCTAssert(concurrentlyEnumerated == dict.count);
+		
+		// Undo also moves values around
+		
+		NSDictionary *changeset = [dict changeset];
+		[dict undo:changeset error:nil];
+		
+		ZDCOrderedDictionary *immutable = [dict immutableCopy];
+		raw = immutable.rawDictionary;
+		
+		for (NSUInteger idx = 0; idx < immutable.count; idx++)
+		{
+			XCTAssert([[immutable objectAtIndex:idx] isEqual:raw[[immutable keyAtIndex:idx]]]);
+		}
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Undo: Key Interning
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_internTable
+{
+	ZDCInternTable *table = [ZDCInternTable sharedTable];
+	
+	NSMutableString *key1 = [NSMutableString stringWithString:@"interned"];
+	NSMutableString *key2 = [NSMutableString stringWithString:@"interned"];
+	
+	id interned1 = [table internKey:key1];
+	id interned2 = [table internKey:key2];
+	
+	XCTAssert(interned1 == interned2);
+	XCTAssert(interned1 != key1); // mutable string protection
+	XCTAssert([interned1 isEqual:key1]);
+	
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict[key1] = @"a";
+	dict.internsKeys = YES;
+	
+	XCTAssert([dict keyAtIndex:0] == interned1);
+	XCTAssert([dict indexForKey:key2] == 0);
+	XCTAssert([dict[key2] isEqual:@"a"]);
+}
+
+- (void)test_undo_interning_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCOrderedDictionary *dict_a = nil;
+		ZDCOrderedDictionary *dict_b = nil;
+		
+		// Apply the same changes to an interning dict & a normal dict.
+		// The changesets should be identical.
+		
+		ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+		ZDCOrderedDictionary *control = [[ZDCOrderedDictionary alloc] init];
+		
+		dict.internsKeys = YES;
+		
+		// Start with an object that has a random number of objects [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			NSString *key = [self randomLetters:8];
+			
+			dict[[key mutableCopy]] = @"";
+			control[[key mutableCopy]] = @"";
+		}
+		
+		[dict clearChangeTracking];
+		[control clearChangeTracking];
+		dict_a = [dict immutableCopy];
+		
+		// Now make a random number of changes: [1 - 30)
+		
+		NSUInteger changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)29);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)4);
+			
+			if (random == 0)
+			{
+				NSString *key = [self randomLetters:8];
+				
+				dict[[key mutableCopy]] = @"";
+				control[[key mutableCopy]] = @"";
+			}
+			else if (random == 1)
+			{
+				if (dict.count > 0)
+				{
+					// Remove via a different (but equal) key instance
+					NSString *key = [[dict keyAtIndex:(NSUInteger)arc4random_uniform((uint32_t)dict.count)] mutableCopy];
+					
+					[dict removeObjectForKey:key];
+					[control removeObjectForKey:key];
+				}
+			}
+			else if (random == 2)
+			{
+				NSString *key = [self randomLetters:8];
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				
+				[dict insertObject:@"" forKey:[key mutableCopy] atIndex:idx];
+				[control insertObject:@"" forKey:[key mutableCopy] atIndex:idx];
+			}
+			else
+			{
+				NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+				
+				[dict moveObjectAtIndex:oldIdx toIndex:newIdx];
+				[control moveObjectAtIndex:oldIdx toIndex:newIdx];
+			}
+		}
+		
+		NSDictionary *changeset_undo = [dict changeset];
+		XCTAssert([changeset_undo isEqual:[control changeset]]);
+		
+		dict_b = [dict immutableCopy];
+		
+		NSDictionary *changeset_redo = [dict undo:changeset_undo error:nil]; // a <- b
+		XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+		
+		[dict undo:changeset_redo error:nil]; // a -> b
+		XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_diff_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCOrderedDictionary *dict_src = [[ZDCOrderedDictionary alloc] init];
+		
+		// Start with an object that has a random number of objects [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			dict_src[[self randomLetters:8]] = [self randomLetters:4];
+		}
+		
+		[dict_src clearChangeTracking];
+		ZDCOrderedDictionary *dict_dst = [dict_src copy];
+		
+		// Make a random number of changes to the copy: [0 - 30)
+		
+		NSUInteger changeCount = (NSUInteger)arc4random_uniform((uint32_t)30);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)4);
+			
+			if (random == 0)
+			{
+				dict_dst[[self randomLetters:8]] = [self randomLetters:4];
+			}
+			else if (random == 1)
+			{
+				if (dict_dst.count > 0) {
+					[dict_dst removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)dict_dst.count)];
+				}
+			}
+			else if (random == 2)
+			{
+				if (dict_dst.count > 0)
+				{
+					NSString *key = [dict_dst keyAtIndex:(NSUInteger)arc4random_uniform((uint32_t)dict_dst.count)];
+					dict_dst[key] = [self randomLetters:4];
+				}
+			}
+			else
+			{
+				if (dict_dst.count > 0)
+				{
+					NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)dict_dst.count);
+					NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)dict_dst.count);
+					[dict_dst moveObjectAtIndex:oldIdx toIndex:newIdx];
+				}
+			}
+		}
+		
+		NSDictionary *changeset = [ZDCOrderedDictionary changesetFrom:dict_src to:dict_dst];
+		
+		if ([dict_src isEqualToOrderedDictionary:dict_dst]) {
+			XCTAssert(changeset == nil);
+			continue;
+		}
+		
+		// Applying the diff (as an undo) to the dst should produce the src.
+		
+		ZDCOrderedDictionary *dict = [dict_dst copy];
+		[dict clearChangeTracking];
+		
+		NSError *error = nil;
+		[dict undo:changeset error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([dict isEqualToOrderedDictionary:dict_src]);
+	}}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark - Import: Basic
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3761,4 +4154,858 @@
 	XCTAssert([localDict[@"dict"][@"duck"] isEqualToString:@"quack"]);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Merge - Memoized
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_mergeMemoized_fuzz
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		NSMutableArray<NSDictionary *> *changesets = [NSMutableArray array];
+		
+		ZDCOrderedDictionary *localDict = [[ZDCOrderedDictionary alloc] init];
+		for (NSUInteger i = 0; i < 10; i++)
+		{
+			localDict[[self randomLetters:2]] = @(i);
+		}
+		
+		[localDict clearChangeTracking];
+		ZDCOrderedDictionary *cloudDict = [localDict immutableCopy];
+		
+		for (NSUInteger pass = 0; pass < 4; pass++)
+		{
+			{ // local changes
+				
+				for (NSUInteger i = 0; i < 3; i++)
+				{
+					uint32_t random = arc4random_uniform((uint32_t)3);
+					
+					if (random == 0 || localDict.count == 0)
+					{
+						localDict[[self randomLetters:2]] = @(pass);
+					}
+					else if (random == 1)
+					{
+						NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)localDict.count);
+						[localDict removeObjectAtIndex:idx];
+					}
+					else
+					{
+						NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)localDict.count);
+						NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)localDict.count);
+						[localDict moveObjectAtIndex:oldIdx toIndex:newIdx];
+					}
+				}
+				
+				[changesets addObject:([localDict changeset] ?: @{})];
+			}
+			{ // cloud changes
+				
+				ZDCOrderedDictionary *nextCloudDict = [cloudDict copy];
+				nextCloudDict[[self randomLetters:2]] = @(pass);
+				if (nextCloudDict.count > 1) {
+					[nextCloudDict moveObjectAtIndex:0 toIndex:(nextCloudDict.count - 1)];
+				}
+				
+				cloudDict = [nextCloudDict immutableCopy];
+			}
+			
+			// A copy doesn't share the memoized original order,
+			// so it performs the full calculation.
+			
+			ZDCOrderedDictionary *coldDict = [localDict copy];
+			
+			NSError *coldError = nil;
+			[coldDict mergeCloudVersion: cloudDict
+			      withPendingChangesets: changesets
+			                      error: &coldError];
+			
+			NSError *error = nil;
+			NSDictionary *mergeChangeset =
+			  [localDict mergeCloudVersion: cloudDict
+			         withPendingChangesets: changesets
+			                         error: &error];
+			
+			XCTAssert((error == nil) == (coldError == nil));
+			XCTAssertEqualObjects(localDict, coldDict);
+			XCTAssertEqualObjects(localDict.rawOrder, coldDict.rawOrder);
+			
+			if (error) break;
+			
+			// The next merge extends the previous list of pending changesets.
+			[changesets addObject:mergeChangeset];
+		}
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Merge - Large
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_merge_largeWithRemoteMoves
+{
+	// A large dictionary, where a remote device moved a few hundred keys.
+	// Without any pending changes, remote wins, so the merged order must match the cloud order.
+	
+	NSUInteger const keyCount = 20000;
+	
+	ZDCOrderedDictionary *localDict = [[ZDCOrderedDictionary alloc] init];
+	for (NSUInteger i = 0; i < keyCount; i++)
+	{
+		localDict[[NSString stringWithFormat:@"key-%llu", (unsigned long long)i]] = @(i);
+	}
+	
+	[localDict clearChangeTracking];
+	ZDCOrderedDictionary *cloudDict = [localDict copy];
+	
+	for (NSUInteger i = 0; i < 300; i++)
+	{
+		NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)keyCount);
+		NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)keyCount);
+		
+		[cloudDict moveObjectAtIndex:oldIdx toIndex:newIdx];
+	}
+	[cloudDict makeImmutable];
+	
+	NSError *error = nil;
+	[localDict mergeCloudVersion: cloudDict
+	       withPendingChangesets: @[]
+	                       error: &error];
+	
+	XCTAssert(error == nil);
+	XCTAssertEqualObjects(localDict.rawOrder, cloudDict.rawOrder);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Without Change Tracking
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_performWithoutChangeTracking_pendingChanges
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict[@"a"] = @"alice";
+	dict[@"b"] = @"bob";
+	dict[@"c"] = @"carol";
+	[dict clearChangeTracking];
+	
+	// Changes made prior to the block are still tracked afterwards
+	
+	dict[@"d"] = @"dave";
+	dict[@"a"] = @"ALICE";
+	[dict moveObjectAtIndex:0 toIndex:2]; // b, c, a, d
+	
+	[dict performWithoutChangeTracking:^{
+		
+		dict[@"b"] = @"BOB";
+		[dict removeObjectForKey:@"c"]; // b, a, d
+		dict[@"e"] = @"emily";          // b, a, d, e
+	}];
+	
+	XCTAssert(dict.hasChanges);
+	
+	ZDCOrderedDictionary *dict_b = [dict immutableCopy];
+	NSDictionary *changeset_undo = [dict changeset];
+	
+	// Undo only reverts the tracked changes (the untracked changes are part of the original state).
+	// The added key is placed after the key that precedes it (skipping over keys that weren't in the original).
+	
+	NSError *error = nil;
+	NSDictionary *changeset_redo = [dict undo:changeset_undo error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssertEqualObjects(dict.rawOrder, (@[ @"a", @"e", @"b" ]));
+	XCTAssertEqualObjects(dict[@"a"], @"alice");
+	XCTAssertEqualObjects(dict[@"b"], @"BOB");
+	XCTAssertEqualObjects(dict[@"e"], @"emily");
+	
+	[dict undo:changeset_redo error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Notifications
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Applies the notification to the old order (the way a table view would),
+ * and ensures the result matches the new order.
+ */
+- (void)verifyNotification:(ZDCChangeNotification *)notification from:(NSArray *)oldOrder to:(NSArray *)newOrder
+{
+	if (notification == nil) {
+		XCTAssertEqualObjects(oldOrder, newOrder);
+		return;
+	}
+	XCTAssert(!notification.requiresReload);
+	
+	NSMutableIndexSet *movedOrigins = [NSMutableIndexSet indexSet];
+	for (NSNumber *origin in [notification.movedIndexes objectEnumerator]) {
+		[movedOrigins addIndex:origin.unsignedIntegerValue];
+	}
+	
+	NSMutableArray<NSNumber*> *untouched = [NSMutableArray arrayWithCapacity:oldOrder.count];
+	for (NSUInteger i = 0; i < oldOrder.count; i++)
+	{
+		if (![notification.removedIndexes containsIndex:i] && ![movedOrigins containsIndex:i]) {
+			[untouched addObject:@(i)];
+		}
+	}
+	
+	NSUInteger untouchedIdx = 0;
+	for (NSUInteger i = 0; i < newOrder.count; i++)
+	{
+		if ([notification.insertedIndexes containsIndex:i]) {
+			XCTAssert(![oldOrder containsObject:newOrder[i]] || [notification.removedIndexes containsIndex:[oldOrder indexOfObject:newOrder[i]]]);
+			continue;
+		}
+		
+		NSNumber *origin = notification.movedIndexes[@(i)];
+		if (origin == nil)
+		{
+			XCTAssert(untouchedIdx < untouched.count);
+			if (untouchedIdx >= untouched.count) return;
+			
+			origin = untouched[untouchedIdx++];
+		}
+		
+		XCTAssertEqualObjects(newOrder[i], oldOrder[origin.unsignedIntegerValue]);
+	}
+	
+	XCTAssert(untouchedIdx == untouched.count);
+}
+
+- (void)test_changeNotifications_basic
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict[@"alice"] = @"a";
+	dict[@"bob"] = @"b";
+	dict[@"carol"] = @"c";
+	
+	__block NSUInteger notificationCount = 0;
+	__block ZDCChangeNotification *lastNotification = nil;
+	
+	[dict addChangeObserver:^(ZDCChangeNotification *notification) {
+		
+		notificationCount++;
+		lastNotification = notification;
+	}];
+	
+	[dict performChangeBatch:^{
+		
+		dict[@"bob"] = @"B";                   // [alice, bob, carol]
+		dict[@"alice"] = nil;                  // [bob, carol]
+		dict[@"dave"] = @"d";                  // [bob, carol, dave]
+		[dict moveObjectAtIndex:1 toIndex:0];  // [carol, bob, dave]
+	}];
+	
+	XCTAssert(notificationCount == 1);
+	XCTAssertEqualObjects(lastNotification.removedIndexes, [NSIndexSet indexSetWithIndex:0]);
+	XCTAssertEqualObjects(lastNotification.insertedIndexes, [NSIndexSet indexSetWithIndex:2]);
+	XCTAssertEqualObjects(lastNotification.movedIndexes, @{ @(0): @(2) });
+	XCTAssertEqualObjects(lastNotification.updatedIndexes, [NSIndexSet indexSetWithIndex:1]);
+	XCTAssertEqualObjects(lastNotification.updatedKeys, [NSSet setWithObject:@"bob"]);
+}
+
+- (void)test_changeNotifications_updatesThenMoves
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		dict[[NSString stringWithFormat:@"%lu", (unsigned long)i]] = @(i);
+	}
+	
+	__block ZDCChangeNotification *lastNotification = nil;
+	[dict addChangeObserver:^(ZDCChangeNotification *notification) {
+		
+		lastNotification = notification;
+	}];
+	
+	NSArray *oldOrder = [dict.rawOrder copy];
+	
+	// The index of updated keys is resolved when the notification is delivered.
+	// So it must still refer to the original position, even though the keys move (or disappear) afterwards.
+	
+	[dict performChangeBatch:^{
+		
+		for (NSUInteger i = 0; i < 100; i += 10)
+		{
+			dict[[NSString stringWithFormat:@"%lu", (unsigned long)i]] = @(-1);
+		}
+		
+		[dict moveObjectAtIndex:0 toIndex:99];                                     // "0" updated & moved
+		[dict removeObjectForKey:@"50"];                                           // "50" updated & removed
+		[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(5, 20)] toIndex:60];
+	}];
+	
+	NSMutableIndexSet *expectedUpdated = [NSMutableIndexSet indexSet];
+	NSMutableSet *expectedKeys = [NSMutableSet set];
+	for (NSUInteger i = 0; i < 100; i += 10)
+	{
+		if (i == 50) continue;
+		
+		[expectedUpdated addIndex:i];
+		[expectedKeys addObject:[NSString stringWithFormat:@"%lu", (unsigned long)i]];
+	}
+	
+	XCTAssertEqualObjects(lastNotification.updatedIndexes, expectedUpdated);
+	XCTAssertEqualObjects(lastNotification.updatedKeys, expectedKeys);
+	XCTAssertEqualObjects(lastNotification.removedIndexes, [NSIndexSet indexSetWithIndex:50]);
+	[self verifyNotification:lastNotification from:oldOrder to:dict.rawOrder];
+}
+
+- (void)test_changeNotifications_fuzz
+{
+	for (NSUInteger round = 0; round < 1000; round++) { @autoreleasepool
+	{
+		ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+		
+		NSUInteger startCount = (NSUInteger)arc4random_uniform((uint32_t)20);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			dict[[self randomLetters:8]] = [self randomLetters:4];
+		}
+		[dict clearChangeTracking];
+		
+		__block ZDCChangeNotification *lastNotification = nil;
+		[dict addChangeObserver:^(ZDCChangeNotification *notification) {
+			
+			lastNotification = notification;
+		}];
+		
+		// Regular mutations
+		
+		NSArray *oldOrder = [dict.rawOrder copy];
+		[dict performChangeBatch:^{
+			
+			NSUInteger changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)10);
+			for (NSUInteger i = 0; i < changeCount; i++)
+			{
+				uint32_t random = arc4random_uniform((uint32_t)4);
+				
+				if (random == 0 || dict.count == 0)
+				{
+					dict[[self randomLetters:8]] = [self randomLetters:4];
+				}
+				else if (random == 1)
+				{
+					NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+					[dict removeObjectAtIndex:idx];
+				}
+				else if (random == 2)
+				{
+					NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+					dict[[dict keyAtIndex:idx]] = [self randomLetters:4];
+				}
+				else
+				{
+					NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+					NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+					[dict moveObjectAtIndex:oldIdx toIndex:newIdx];
+				}
+			}
+		}];
+		
+		[self verifyNotification:lastNotification from:oldOrder to:dict.rawOrder];
+		
+		// Undo (which performs bulk moves)
+		
+		lastNotification = nil;
+		oldOrder = [dict.rawOrder copy];
+		
+		NSDictionary *changeset = [dict changeset];
+		if (changeset == nil) continue;
+		
+		[dict performChangeBatch:^{
+			
+			[dict performUndo:changeset];
+		}];
+		
+		[self verifyNotification:lastNotification from:oldOrder to:dict.rawOrder];
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Batch Moves
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_sortKeys_minimalMoves
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	
+	NSArray *keys = @[ @"a", @"b", @"c", @"x", @"d", @"e", @"f", @"g" ];
+	for (NSString *key in keys) {
+		dict[key] = [key uppercaseString];
+	}
+	[dict clearChangeTracking];
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	
+	[dict sortKeysUsingComparator:^NSComparisonResult(NSString *key1, NSString *key2) {
+		return [key1 compare:key2];
+	}];
+	
+	XCTAssertEqualObjects(dict.rawOrder, (@[ @"a", @"b", @"c", @"d", @"e", @"f", @"g", @"x" ]));
+	
+	// Only the out-of-place key is marked as moved
+	
+	NSDictionary *changeset = [dict changeset];
+	XCTAssertEqualObjects(changeset[@"indexes"], @{ @"x": @(3) });
+	
+	ZDCOrderedDictionary *dict_b = [dict immutableCopy];
+	
+	NSDictionary *redo = [dict undo:changeset error:nil];
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+	
+	[dict undo:redo error:nil];
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+	
+	// Sorting an already sorted dictionary is a no-op
+	
+	[dict sortKeysUsingComparator:^NSComparisonResult(NSString *key1, NSString *key2) {
+		return [key1 compare:key2];
+	}];
+	XCTAssert(!dict.hasChanges);
+}
+
+- (void)test_sortUsingComparator
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict[@"alice"] = @(3);
+	dict[@"bob"] = @(1);
+	dict[@"carol"] = @(2);
+	[dict clearChangeTracking];
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	
+	dict[@"alice"] = @(0); // stale ordered value
+	[dict sortUsingComparator:^NSComparisonResult(NSNumber *num1, NSNumber *num2) {
+		return [num1 compare:num2];
+	}];
+	
+	XCTAssertEqualObjects(dict.rawOrder, (@[ @"alice", @"bob", @"carol" ]));
+	XCTAssertEqualObjects(dict[0], @(0));
+	
+	NSDictionary *changeset = [dict changeset];
+	XCTAssert(changeset[@"indexes"] == nil); // back in its original place
+	
+	[dict undo:changeset error:nil];
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+}
+
+- (void)test_moveObjectsAtIndexes
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	NSMutableOrderedSet *expected = [NSMutableOrderedSet orderedSet];
+	
+	for (NSUInteger i = 0; i < 10; i++)
+	{
+		NSString *key = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+		
+		dict[key] = @(i);
+		[expected addObject:key];
+	}
+	[dict clearChangeTracking];
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	
+	__block ZDCChangeNotification *lastNotification = nil;
+	[dict addChangeObserver:^(ZDCChangeNotification *notification) {
+		
+		lastNotification = notification;
+	}];
+	
+	NSIndexSet *indexes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(6, 3)];
+	NSArray *oldOrder = [dict.rawOrder copy];
+	
+	[dict moveObjectsAtIndexes:indexes toIndex:1];
+	[expected moveObjectsAtIndexes:indexes toIndex:1];
+	
+	XCTAssertEqualObjects(dict.rawOrder, expected.array);
+	XCTAssertEqualObjects(dict[@"7"], @(7));
+	
+	[dict flushChangeNotifications];
+	XCTAssert(lastNotification.movedIndexes.count == 3);
+	[self verifyNotification:lastNotification from:oldOrder to:dict.rawOrder];
+	
+	NSDictionary *changeset = [dict changeset];
+	XCTAssert([changeset[@"indexes"] count] == 3);
+	
+	[dict undo:changeset error:nil];
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+	
+	// Out-of-bounds indexes are ignored, and toIndex is clamped
+	
+	[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 100)] toIndex:5];
+	[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndex:0] toIndex:100];
+	
+	XCTAssert(dict.count == 10);
+	XCTAssertEqualObjects(dict.rawOrder.lastObject, @"0");
+}
+
+- (void)test_batchMoves_fuzz
+{
+	for (NSUInteger round = 0; round < 1000; round++) { @autoreleasepool
+	{
+		ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			dict[[self randomLetters:8]] = [self randomLetters:4];
+		}
+		[dict clearChangeTracking];
+		
+		ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+		
+		__block ZDCChangeNotification *lastNotification = nil;
+		[dict addChangeObserver:^(ZDCChangeNotification *notification) {
+			
+			lastNotification = notification;
+		}];
+		
+		NSArray *oldOrder = [dict.rawOrder copy];
+		[dict performChangeBatch:^{
+			
+			NSUInteger changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)10);
+			for (NSUInteger i = 0; i < changeCount; i++)
+			{
+				uint32_t random = arc4random_uniform((uint32_t)6);
+				
+				if (random == 0 || dict.count == 0)
+				{
+					dict[[self randomLetters:8]] = [self randomLetters:4];
+				}
+				else if (random == 1)
+				{
+					[dict removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)dict.count)];
+				}
+				else if (random == 2)
+				{
+					NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+					NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+					[dict moveObjectAtIndex:oldIdx toIndex:newIdx];
+				}
+				else if (random == 3)
+				{
+					NSUInteger location = (NSUInteger)arc4random_uniform((uint32_t)dict.count);
+					NSUInteger length = 1 + (NSUInteger)arc4random_uniform((uint32_t)(dict.count - location));
+					NSUInteger toIdx = (NSUInteger)arc4random_uniform((uint32_t)(dict.count - length + 1));
+					
+					NSMutableArray *expected = [dict.rawOrder mutableCopy];
+					NSArray *moved = [expected subarrayWithRange:NSMakeRange(location, length)];
+					[expected removeObjectsInRange:NSMakeRange(location, length)];
+					[expected insertObjects:moved atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(toIdx, length)]];
+					
+					[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(location, length)]
+					                   toIndex:toIdx];
+					XCTAssertEqualObjects(dict.rawOrder, expected);
+				}
+				else if (random == 4)
+				{
+					[dict sortKeysUsingComparator:^NSComparisonResult(NSString *key1, NSString *key2) {
+						return [key1 compare:key2];
+					}];
+				}
+				else
+				{
+					[dict sortUsingComparator:^NSComparisonResult(NSString *value1, NSString *value2) {
+						return [value2 compare:value1];
+					}];
+				}
+			}
+		}];
+		
+		[self verifyNotification:lastNotification from:oldOrder to:dict.rawOrder];
+		
+		NSDictionary *changeset_undo = [dict changeset];
+		ZDCOrderedDictionary *dict_b = [dict immutableCopy];
+		
+		NSDictionary *changeset_redo = [dict undo:changeset_undo error:nil]; // a <- b
+		XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+		
+		[dict undo:changeset_redo error:nil]; // a -> b
+		XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Block Moves
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (BOOL)changesetContainsBlockMove:(NSDictionary *)changeset
+{
+	for (id value in [changeset[@"indexes"] allValues])
+	{
+		if ([value isKindOfClass:[NSArray class]]) {
+			return YES;
+		}
+	}
+	return NO;
+}
+
+- (void)test_blockMove_optIn
+{
+	// Block-move entries are opt-in, since older readers reject them.
+	
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		dict[[NSString stringWithFormat:@"%lu", (unsigned long)i]] = @(i);
+	}
+	[dict clearChangeTracking];
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	
+	[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(500, 500)] toIndex:0];
+	
+	NSDictionary *changeset_undo = [dict changeset];
+	XCTAssert(![self changesetContainsBlockMove:changeset_undo]);
+	XCTAssert(![self changesetContainsBlockMove:[ZDCOrderedDictionary changesetFrom:dict_a to:dict]]);
+	
+	[dict undo:changeset_undo error:nil];
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+}
+
+- (void)test_blockMove_basic
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict.compressesMoves = YES;
+	
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		dict[[NSString stringWithFormat:@"%lu", (unsigned long)i]] = @(i);
+	}
+	[dict clearChangeTracking];
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	
+	// Drag rows [500, 1000) to the front
+	[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(500, 500)] toIndex:0];
+	
+	ZDCOrderedDictionary *dict_b = [dict immutableCopy];
+	
+	NSDictionary *changeset_undo = [dict changeset];
+	
+	XCTAssert([changeset_undo[@"indexes"] count] == 1);
+	XCTAssert([self changesetContainsBlockMove:changeset_undo]);
+	
+	NSError *error = nil;
+	NSDictionary *changeset_redo = [dict undo:changeset_undo error:&error]; // a <- b
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+	XCTAssert([self changesetContainsBlockMove:changeset_redo]);
+	
+	[dict undo:changeset_redo error:&error]; // a -> b
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+}
+
+- (void)test_blockMove_withAddedKeys
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict.compressesMoves = YES;
+	dict.snapshotThreshold = 0; // operation-by-operation tracking
+	
+	for (NSUInteger i = 0; i < 40; i++)
+	{
+		dict[[NSString stringWithFormat:@"%lu", (unsigned long)i]] = @(i);
+	}
+	[dict clearChangeTracking];
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	
+	// Drag a block to the front, then add keys within the block.
+	// The run is measured within the order that remains after undoing the added keys.
+	
+	[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(20, 20)] toIndex:0];
+	[dict insertObject:@(-1) forKey:@"new1" atIndex:5];
+	[dict insertObject:@(-2) forKey:@"new2" atIndex:12];
+	
+	ZDCOrderedDictionary *dict_b = [dict immutableCopy];
+	
+	NSDictionary *changeset_undo = [dict changeset];
+	XCTAssert([self changesetContainsBlockMove:changeset_undo]);
+	
+	NSError *error = nil;
+	NSDictionary *changeset_redo = [dict undo:changeset_undo error:&error]; // a <- b
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+	
+	[dict undo:changeset_redo error:&error]; // a -> b
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+}
+
+- (void)test_blockMove_import
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict.compressesMoves = YES;
+	
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		dict[[NSString stringWithFormat:@"%lu", (unsigned long)i]] = @(i);
+	}
+	[dict clearChangeTracking];
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	NSMutableArray<NSDictionary*> *changesets = [NSMutableArray array];
+	
+	{ // changeset: A
+		
+		[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(50, 30)] toIndex:10];
+		[changesets addObject:([dict changeset] ?: @{})];
+	}
+	{ // changeset: B
+		
+		[dict moveObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 20)] toIndex:70];
+		[changesets addObject:([dict changeset] ?: @{})];
+	}
+	
+	XCTAssert([self changesetContainsBlockMove:changesets[0]]);
+	XCTAssert([self changesetContainsBlockMove:changesets[1]]);
+	
+	ZDCOrderedDictionary *dict_b = [dict immutableCopy];
+	
+	NSError *error = [dict importChangesets:changesets];
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+	
+	NSDictionary *changeset_merged = [dict changeset];
+	
+	NSDictionary *changeset_redo = [dict undo:changeset_merged error:&error];
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+	
+	[dict undo:changeset_redo error:&error];
+	XCTAssert(error == nil);
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+}
+
+- (void)test_blockMove_malformed
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	for (NSString *key in @[ @"a", @"b", @"c", @"d", @"e", @"f", @"g", @"h" ])
+	{
+		dict[key] = [key uppercaseString];
+	}
+	[dict clearChangeTracking];
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	
+	NSArray<NSDictionary*> *changesets = @[
+		@{ @"indexes": @{ @"a": @[ @(2), @(4), @(4) ] } },           // unknown version
+		@{ @"indexes": @{ @"a": @[ @(1), @(4) ] } },                 // missing length
+		@{ @"indexes": @{ @"a": @[ @(1), @(4), @(0) ] } },           // empty block
+	];
+	
+	for (NSDictionary *changeset in changesets)
+	{
+		NSError *error = nil;
+		NSDictionary *redo = [dict undo:changeset error:&error];
+		
+		XCTAssert(redo == nil);
+		XCTAssert(error != nil);
+		XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+	}
+	
+	// Well-formed, but doesn't match the order
+	
+	NSArray<NSDictionary*> *mismatched = @[
+		@{ @"indexes": @{ @"f": @[ @(1), @(0), @(4) ] } },                // past the end of the order
+		@{ @"indexes": @{ @"a": @[ @(1), @(4), @(4) ], @"b": @(0) } },    // overlapping entries
+		@{ @"indexes": @{ @"zzz": @[ @(1), @(0), @(2) ] } },              // unknown key
+	];
+	
+	for (NSDictionary *changeset in mismatched)
+	{
+		ZDCOrderedDictionary *other =
+		  [[ZDCOrderedDictionary alloc] initWithOrderedDictionary:dict_a copyItems:NO trackChanges:NO];
+		
+		NSError *error = nil;
+		[other undo:changeset error:&error];
+		
+		XCTAssert(error != nil);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Checkpoints
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_checkpoint
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict[@"a"] = @"alice";
+	dict[@"b"] = @"bob";
+	[dict clearChangeTracking];
+	
+	dict[@"c"] = @"carol";
+	
+	ZDCOrderedDictionary *dict_a = [dict immutableCopy];
+	NSDictionary *changeset_a = [dict peakChangeset];
+	
+	id checkpoint_a = [dict checkpoint];
+	
+	dict[@"a"] = @"ALICE";
+	[dict moveObjectAtIndex:2 toIndex:0];
+	
+	ZDCOrderedDictionary *dict_b = [dict immutableCopy];
+	NSDictionary *changeset_b = [dict peakChangeset];
+	
+	id checkpoint_b = [dict checkpoint];
+	
+	[dict removeObjectForKey:@"b"];
+	[dict changeset];
+	
+	[dict restoreCheckpoint:checkpoint_b];
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+	XCTAssertEqualObjects([dict peakChangeset], changeset_b);
+	
+	[dict restoreCheckpoint:checkpoint_a];
+	XCTAssert([dict isEqualToOrderedDictionary:dict_a]);
+	XCTAssertEqualObjects([dict peakChangeset], changeset_a);
+	
+	// Restoring the outer checkpoint doesn't invalidate the inner one
+	
+	[dict restoreCheckpoint:checkpoint_b];
+	XCTAssert([dict isEqualToOrderedDictionary:dict_b]);
+	
+	// The restored changeset undoes all the way back to the baseline
+	
+	NSDictionary *changeset = [dict changeset];
+	[dict undo:changeset error:nil];
+	
+	XCTAssertEqualObjects(dict.rawOrder, (@[ @"a", @"b" ]));
+	XCTAssertEqualObjects(dict[@"a"], @"alice");
+}
+
+- (void)test_copyOnWrite
+{
+	ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+	dict[@"a"] = @"alice";
+	dict[@"b"] = @"bob";
+	
+	ZDCOrderedDictionary *copy = [dict copy];
+	
+	dict[@"c"] = @"carol";
+	[copy moveObjectAtIndex:1 toIndex:0];
+	copy[@"a"] = @"ALICE";
+	
+	XCTAssertEqualObjects(dict.rawOrder, (@[ @"a", @"b", @"c" ]));
+	XCTAssertEqualObjects(dict[@"a"], @"alice");
+	XCTAssertEqualObjects([dict objectAtIndex:0], @"alice");
+	
+	XCTAssertEqualObjects(copy.rawOrder, (@[ @"b", @"a" ]));
+	XCTAssertEqualObjects([copy objectAtIndex:1], @"ALICE");
+	
+	[copy clearChangeTracking];
+	
+	XCTAssert(dict.hasChanges);
+	XCTAssert(!copy.hasChanges);
+}
+
 @end
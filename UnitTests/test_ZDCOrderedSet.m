@@ -552,6 +552,245 @@
 	}}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_diff_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCOrderedSet *orderedSet_src = [[ZDCOrderedSet alloc] init];
+		
+		// Start with an object that has a random number of objects [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[orderedSet_src addObject:[self randomLetters:8]];
+		}
+		
+		[orderedSet_src clearChangeTracking];
+		ZDCOrderedSet *orderedSet_dst = [orderedSet_src copy];
+		
+		// Make a random number of changes to the copy: [0 - 30)
+		
+		NSUInteger changeCount = (NSUInteger)arc4random_uniform((uint32_t)30);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)3);
+			
+			if (random == 0)
+			{
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)(orderedSet_dst.count + 1));
+				[orderedSet_dst insertObject:[self randomLetters:8] atIndex:idx];
+			}
+			else if (random == 1)
+			{
+				if (orderedSet_dst.count > 0) {
+					[orderedSet_dst removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)orderedSet_dst.count)];
+				}
+			}
+			else
+			{
+				if (orderedSet_dst.count > 0)
+				{
+					NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet_dst.count);
+					NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet_dst.count);
+					[orderedSet_dst moveObjectAtIndex:oldIdx toIndex:newIdx];
+				}
+			}
+		}
+		
+		NSDictionary *changeset = [ZDCOrderedSet changesetFrom:orderedSet_src to:orderedSet_dst];
+		
+		if ([orderedSet_src isEqualToOrderedSet:orderedSet_dst]) {
+			XCTAssert(changeset == nil);
+			continue;
+		}
+		
+		// Applying the diff (as an undo) to the dst should produce the src.
+		
+		ZDCOrderedSet *orderedSet = [orderedSet_dst copy];
+		[orderedSet clearChangeTracking];
+		
+		NSError *error = nil;
+		[orderedSet undo:changeset error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_src]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Set Algebra
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_setAlgebra_fuzz
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCOrderedSet *orderedSet = [[ZDCOrderedSet alloc] init];
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[orderedSet addObject:[self randomLetters:8]];
+		}
+		[orderedSet clearChangeTracking];
+		
+		// Random tracked changes beforehand: [0 - 20)
+		// The batched tracking has to account for prior adds, moves & deletes.
+		
+		NSUInteger changeCount = (NSUInteger)arc4random_uniform((uint32_t)20);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)3);
+			
+			if (random == 0)
+			{
+				NSUInteger idx = (NSUInteger)arc4random_uniform((uint32_t)(orderedSet.count + 1));
+				[orderedSet insertObject:[self randomLetters:8] atIndex:idx];
+			}
+			else if (random == 1 && orderedSet.count > 0)
+			{
+				[orderedSet removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)orderedSet.count)];
+			}
+			else if (orderedSet.count > 0)
+			{
+				NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet.count);
+				NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet.count);
+				[orderedSet moveObjectAtIndex:oldIdx toIndex:newIdx];
+			}
+		}
+		
+		NSMutableOrderedSet *other = [NSMutableOrderedSet orderedSet];
+		for (id obj in orderedSet)
+		{
+			if (arc4random_uniform(2) == 0) {
+				[other addObject:obj];
+			}
+		}
+		for (NSUInteger i = 0; i < 10; i++)
+		{
+			[other addObject:[self randomLetters:8]];
+		}
+		
+		ZDCOrderedSet *control = [orderedSet copy];
+		
+		uint32_t const random = arc4random_uniform(3);
+		if (random == 0)
+		{
+			[orderedSet unionOrderedSet:other];
+			for (id obj in other) {
+				[control addObject:obj];
+			}
+		}
+		else if (random == 1)
+		{
+			[orderedSet minusSet:other.set];
+			for (id obj in control.rawOrderedSet) {
+				if ([other containsObject:obj]) [control removeObject:obj];
+			}
+		}
+		else
+		{
+			[orderedSet intersectSet:other.set];
+			for (id obj in control.rawOrderedSet) {
+				if (![other containsObject:obj]) [control removeObject:obj];
+			}
+		}
+		
+		XCTAssert([orderedSet isEqualToOrderedSet:control]);
+		
+		NSDictionary *changeset = [orderedSet changeset];
+		XCTAssert([changeset isEqual:[control changeset]]);
+		
+		// And the changeset must still undo correctly
+		
+		NSError *error = nil;
+		[orderedSet undo:changeset error:&error];
+		XCTAssert(error == nil);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Interning
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_merge_interning_fuzz
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		// Apply the same changes to an interning set & a normal set.
+		// The merge results should be identical.
+		
+		ZDCOrderedSet *localSet = [[ZDCOrderedSet alloc] init];
+		
+		// Start with an object that has a random number of objects [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[localSet addObject:[self randomLetters:8]];
+		}
+		
+		[localSet clearChangeTracking];
+		
+		ZDCOrderedSet *cloudSet = [localSet copy];
+		ZDCOrderedSet *controlSet = [localSet copy];
+		
+		localSet.internsObjects = YES;
+		
+		// Make a random number of local moves & removals: [1 - 15)
+		
+		NSUInteger changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)14);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)localSet.count);
+			NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)localSet.count);
+			
+			if (arc4random_uniform(4) == 0)
+			{
+				// Remove via a different (but equal) instance
+				id obj = [[localSet objectAtIndex:oldIdx] mutableCopy];
+				
+				[localSet removeObject:obj];
+				[controlSet removeObject:obj];
+			}
+			else
+			{
+				[localSet moveObjectAtIndex:oldIdx toIndex:newIdx];
+				[controlSet moveObjectAtIndex:oldIdx toIndex:newIdx];
+			}
+		}
+		
+		NSArray *changesets = @[ [localSet changeset] ];
+		XCTAssert([changesets[0] isEqual:[controlSet changeset]]);
+		
+		// Make a random number of cloud moves: [1 - 15)
+		
+		changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)14);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)cloudSet.count);
+			NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)cloudSet.count);
+			
+			[cloudSet moveObjectAtIndex:oldIdx toIndex:newIdx];
+		}
+		[cloudSet makeImmutable];
+		
+		NSError *error = nil;
+		[localSet mergeCloudVersion:cloudSet withPendingChangesets:changesets error:&error];
+		XCTAssert(error == nil);
+		
+		[controlSet mergeCloudVersion:cloudSet withPendingChangesets:changesets error:&error];
+		XCTAssert(error == nil);
+		
+		XCTAssert([localSet isEqualToOrderedSet:controlSet]);
+	}}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Merge - Simple
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -733,4 +972,200 @@
 	XCTAssert([localSet containsObject:@(43)]);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Batch Moves
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_sortUsingComparator_minimalMoves
+{
+	ZDCOrderedSet *orderedSet = [[ZDCOrderedSet alloc] initWithArray:@[ @(1), @(2), @(9), @(3), @(4), @(5), @(0) ]];
+	[orderedSet clearChangeTracking];
+	
+	ZDCOrderedSet *orderedSet_a = [orderedSet immutableCopy];
+	
+	[orderedSet sortUsingComparator:^NSComparisonResult(NSNumber *num1, NSNumber *num2) {
+		return [num1 compare:num2];
+	}];
+	
+	XCTAssertEqualObjects(orderedSet.rawOrderedSet.array, (@[ @(0), @(1), @(2), @(3), @(4), @(5), @(9) ]));
+	
+	// Only the 2 out-of-place objects are marked as moved
+	
+	NSDictionary *changeset = [orderedSet changeset];
+	XCTAssertEqualObjects(changeset[@"indexes"], (@{ @(0): @(6), @(9): @(2) }));
+	
+	ZDCOrderedSet *orderedSet_b = [orderedSet immutableCopy];
+	
+	NSDictionary *redo = [orderedSet undo:changeset error:nil];
+	XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_a]);
+	
+	[orderedSet undo:redo error:nil];
+	XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_b]);
+}
+
+- (void)test_moveObjectsAtIndexes
+{
+	NSMutableOrderedSet *expected = [NSMutableOrderedSet orderedSet];
+	for (NSUInteger i = 0; i < 10; i++) {
+		[expected addObject:@(i)];
+	}
+	
+	ZDCOrderedSet *orderedSet = [[ZDCOrderedSet alloc] initWithOrderedSet:expected];
+	[orderedSet clearChangeTracking];
+	
+	ZDCOrderedSet *orderedSet_a = [orderedSet immutableCopy];
+	
+	NSMutableIndexSet *indexes = [NSMutableIndexSet indexSetWithIndex:1];
+	[indexes addIndex:4];
+	
+	[orderedSet moveObjectsAtIndexes:indexes toIndex:6];
+	[expected moveObjectsAtIndexes:indexes toIndex:6];
+	
+	XCTAssertEqualObjects(orderedSet.rawOrderedSet, expected);
+	
+	NSDictionary *changeset = [orderedSet changeset];
+	XCTAssert([changeset[@"indexes"] count] == 2);
+	
+	[orderedSet undo:changeset error:nil];
+	XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_a]);
+}
+
+- (void)test_batchMoves_fuzz
+{
+	for (NSUInteger round = 0; round < 1000; round++) { @autoreleasepool
+	{
+		ZDCOrderedSet *orderedSet = [[ZDCOrderedSet alloc] init];
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[orderedSet addObject:[self randomLetters:8]];
+		}
+		[orderedSet clearChangeTracking];
+		
+		ZDCOrderedSet *orderedSet_a = [orderedSet immutableCopy];
+		
+		NSUInteger changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)5);
+			
+			if (random == 0 || orderedSet.count == 0)
+			{
+				[orderedSet addObject:[self randomLetters:8]];
+			}
+			else if (random == 1)
+			{
+				[orderedSet removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)orderedSet.count)];
+			}
+			else if (random == 2)
+			{
+				NSUInteger oldIdx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet.count);
+				NSUInteger newIdx = (NSUInteger)arc4random_uniform((uint32_t)orderedSet.count);
+				[orderedSet moveObjectAtIndex:oldIdx toIndex:newIdx];
+			}
+			else if (random == 3)
+			{
+				NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+				NSUInteger moveCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)orderedSet.count);
+				for (NSUInteger j = 0; j < moveCount; j++) {
+					[indexes addIndex:(NSUInteger)arc4random_uniform((uint32_t)orderedSet.count)];
+				}
+				NSUInteger toIdx = (NSUInteger)arc4random_uniform((uint32_t)(orderedSet.count - indexes.count + 1));
+				
+				NSMutableOrderedSet *expected = [orderedSet.rawOrderedSet mutableCopy];
+				[expected moveObjectsAtIndexes:indexes toIndex:toIdx];
+				
+				[orderedSet moveObjectsAtIndexes:indexes toIndex:toIdx];
+				XCTAssertEqualObjects(orderedSet.rawOrderedSet, expected);
+			}
+			else
+			{
+				[orderedSet sortUsingComparator:^NSComparisonResult(NSString *str1, NSString *str2) {
+					return [str1 compare:str2];
+				}];
+			}
+		}
+		
+		NSDictionary *changeset_undo = [orderedSet changeset];
+		ZDCOrderedSet *orderedSet_b = [orderedSet immutableCopy];
+		
+		NSDictionary *changeset_redo = [orderedSet undo:changeset_undo error:nil]; // a <- b
+		XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_a]);
+		
+		[orderedSet undo:changeset_redo error:nil]; // a -> b
+		XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_b]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Checkpoints
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_checkpoint
+{
+	ZDCOrderedSet *orderedSet = [[ZDCOrderedSet alloc] init];
+	[orderedSet addObject:@"alice"];
+	[orderedSet addObject:@"bob"];
+	[orderedSet clearChangeTracking];
+	
+	[orderedSet addObject:@"carol"];
+	
+	ZDCOrderedSet *orderedSet_a = [orderedSet immutableCopy];
+	NSDictionary *changeset_a = [orderedSet peakChangeset];
+	
+	id checkpoint_a = [orderedSet checkpoint];
+	
+	[orderedSet moveObjectAtIndex:2 toIndex:0];
+	[orderedSet removeObject:@"alice"];
+	
+	ZDCOrderedSet *orderedSet_b = [orderedSet immutableCopy];
+	NSDictionary *changeset_b = [orderedSet peakChangeset];
+	
+	id checkpoint_b = [orderedSet checkpoint];
+	
+	[orderedSet removeAllObjects];
+	[orderedSet changeset];
+	
+	[orderedSet restoreCheckpoint:checkpoint_b];
+	XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_b]);
+	XCTAssertEqualObjects([orderedSet peakChangeset], changeset_b);
+	
+	[orderedSet restoreCheckpoint:checkpoint_a];
+	XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_a]);
+	XCTAssertEqualObjects([orderedSet peakChangeset], changeset_a);
+	
+	// Restoring the outer checkpoint doesn't invalidate the inner one
+	
+	[orderedSet restoreCheckpoint:checkpoint_b];
+	XCTAssert([orderedSet isEqualToOrderedSet:orderedSet_b]);
+	
+	// The restored changeset undoes all the way back to the baseline
+	
+	NSDictionary *changeset = [orderedSet changeset];
+	[orderedSet undo:changeset error:nil];
+	
+	XCTAssertEqualObjects([orderedSet.rawOrderedSet array], (@[ @"alice", @"bob" ]));
+}
+
+- (void)test_copyOnWrite
+{
+	ZDCOrderedSet *orderedSet = [[ZDCOrderedSet alloc] init];
+	[orderedSet addObject:@"alice"];
+	[orderedSet addObject:@"bob"];
+	
+	ZDCOrderedSet *copy = [orderedSet copy];
+	
+	[orderedSet addObject:@"carol"];
+	[copy moveObjectAtIndex:1 toIndex:0];
+	
+	XCTAssertEqualObjects([orderedSet.rawOrderedSet array], (@[ @"alice", @"bob", @"carol" ]));
+	XCTAssertEqualObjects([copy.rawOrderedSet array], (@[ @"bob", @"alice" ]));
+	
+	[copy clearChangeTracking];
+	
+	XCTAssert(orderedSet.hasChanges);
+	XCTAssert(!copy.hasChanges);
+}
+
 @end
@@ -13,7 +13,10 @@
 @interface test_ZDCRecord : XCTestCase
 @end
 
-@implementation test_ZDCRecord
+@implementation test_ZDCRecord {
+	
+	NSUInteger kvoCount;
+}
 
 - (void)test_undo
 {
@@ -46,6 +49,195 @@
 	XCTAssert([sr isEqualToSimpleRecord:sr_b]);
 }
 
+- (void)test_diff
+{
+	SimpleRecord *sr_src = [[SimpleRecord alloc] init];
+	sr_src.someString = @"abc123";
+	sr_src.someInteger = 42;
+	
+	[sr_src clearChangeTracking];
+	SimpleRecord *sr_dst = [sr_src copy];
+	
+	XCTAssert([SimpleRecord changesetFrom:sr_src to:sr_dst] == nil);
+	
+	sr_dst.someString = nil;
+	sr_dst.someInteger = 23;
+	
+	NSDictionary *changeset = [SimpleRecord changesetFrom:sr_src to:sr_dst];
+	
+	SimpleRecord *sr = [sr_dst copy];
+	[sr clearChangeTracking];
+	
+	NSError *error = nil;
+	[sr undo:changeset error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([sr isEqualToSimpleRecord:sr_src]);
+}
+
+- (void)test_performWithoutChangeTracking
+{
+	SimpleRecord *sr = [[SimpleRecord alloc] init];
+	
+	[sr performWithoutChangeTracking:^{
+		
+		sr.someString = @"abc123";
+		sr.someInteger = 42;
+	}];
+	
+	XCTAssert([sr.someString isEqualToString:@"abc123"]);
+	XCTAssert(sr.someInteger == 42);
+	XCTAssert(sr.hasChanges == NO);
+	XCTAssert([sr peakChangeset] == nil);
+	
+	sr.someInteger = 43;
+	
+	XCTAssert(sr.hasChanges);
+}
+
+- (void)test_performWithoutChangeTracking_pendingChanges
+{
+	ComplexRecord *cr = [[ComplexRecord alloc] init];
+	cr.someString = @"abc123";
+	cr.someInteger = 42;
+	cr.dict[@"dog"] = @"bark";
+	[cr clearChangeTracking];
+	
+	// Changes made prior to the block are still tracked afterwards (including changes to nested objects)
+	
+	cr.someString = @"def456";
+	cr.dict[@"dog"] = @"woof";
+	
+	[cr performWithoutChangeTracking:^{
+		
+		cr.someInteger = 43;
+	}];
+	
+	XCTAssert(cr.hasChanges);
+	XCTAssert(cr.dict.hasChanges);
+	
+	NSDictionary *changeset = [cr changeset];
+	
+	NSError *error = nil;
+	[cr undo:changeset error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([cr.someString isEqualToString:@"abc123"]);
+	XCTAssert([cr.dict[@"dog"] isEqualToString:@"bark"]);
+	XCTAssert(cr.someInteger == 43);
+}
+
+- (void)test_originalValues_keyInstances
+{
+	SimpleRecord *sr = [[SimpleRecord alloc] init];
+	sr.someString = @"abc123";
+	sr.someInteger = 42;
+	[sr clearChangeTracking];
+	
+	SimpleRecord *sr_a = [sr immutableCopy];
+	
+	// The slot of each key is cached by pointer.
+	// So pass the keys via different string instances (including a mutable string that gets reused).
+	
+	NSMutableString *key = [NSMutableString stringWithString:@"someString"];
+	[sr setValue:@"def456" forKey:key];
+	
+	[key setString:@"someInteger"];
+	[sr setValue:@(43) forKey:key];
+	
+	[sr setValue:@"ghi789" forKey:[NSString stringWithFormat:@"some%@", @"String"]];
+	
+	NSDictionary *changeset = [sr changeset];
+	
+	NSError *error = nil;
+	[sr undo:changeset error:&error];
+	
+	XCTAssert(error == nil);
+	XCTAssert([sr isEqualToSimpleRecord:sr_a]);
+}
+
+- (void)test_aggregateTrackingStatistics
+{
+	ComplexRecord *cr = [[ComplexRecord alloc] init];
+	
+	cr.someString = @"abc123";
+	cr.dict[@"dog"] = @"bark";
+	cr.dict[@"cat"] = @"meow";
+	[cr.set addObject:@"duck"];
+	
+	[cr clearChangeTracking];
+	
+	cr.someString = @"def456";
+	cr.dict[@"dog"] = @"woof";
+	[cr.dict removeObjectForKey:@"cat"];
+	[cr.set addObject:@"goose"];
+	
+	ZDCTrackingStatistics stats = [cr trackingStatistics];
+	XCTAssert(stats.mutationCount == 1);
+	XCTAssert(stats.originalCount == 1);
+	
+	ZDCTrackingStatistics aggregate = [cr aggregateTrackingStatistics];
+	XCTAssert(aggregate.elementCount == (stats.elementCount + 1 + 2));
+	XCTAssert(aggregate.addedCount == 1);    // goose
+	XCTAssert(aggregate.deletedCount == 1);  // cat
+	XCTAssert(aggregate.originalCount == 3); // abc123, bark, meow
+	XCTAssert(aggregate.mutationCount == 4);
+	XCTAssert(aggregate.trackingBytes > stats.trackingBytes);
+	
+	[cr changeset];
+	
+	aggregate = [cr aggregateTrackingStatistics];
+	XCTAssert(aggregate.originalCount == 0);
+	XCTAssert(aggregate.mutationCount == 0);
+	XCTAssert(aggregate.trackingBytes == 0);
+}
+
+- (void)test_originalValues
+{
+	SimpleRecord *sr = [[SimpleRecord alloc] init];
+	sr.someString = @"abc123";
+	sr.someInteger = 42;
+	
+	[sr clearChangeTracking];
+	XCTAssert(sr.hasChanges == NO);
+	
+	// Only the first change to a property captures the original
+	
+	sr.someString = @"def456";
+	sr.someString = @"ghi789";
+	
+	XCTAssert(sr.hasChanges);
+	XCTAssert([sr trackingStatistics].originalCount == 1);
+	
+	// Copies carry the originals along
+	
+	SimpleRecord *copy = [sr copy];
+	sr.someInteger = 23;
+	
+	NSDictionary *changeset = [sr peakChangeset];
+	NSDictionary *values = changeset[@"values"];
+	
+	XCTAssert(values.count == 2);
+	XCTAssert([values[@"someString"] isEqual:@"abc123"]);
+	XCTAssert([values[@"someInteger"] isEqual:@(42)]);
+	
+	values = [copy peakChangeset][@"values"];
+	XCTAssert(values.count == 1);
+	XCTAssert([values[@"someString"] isEqual:@"abc123"]);
+	
+	[sr clearChangeTracking];
+	XCTAssert(sr.hasChanges == NO);
+	XCTAssert([sr trackingStatistics].originalCount == 0);
+	XCTAssert([sr trackingStatistics].trackingBytes == 0);
+	
+	// And the (reused) slots work after being cleared
+	
+	sr.someInteger = 24;
+	values = [sr peakChangeset][@"values"];
+	XCTAssert(values.count == 1);
+	XCTAssert([values[@"someInteger"] isEqual:@(23)]);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Merge: Simple
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -247,4 +439,79 @@
 	XCTAssert([localRecord.dict[@"duck"] isEqualToString:@"quack"]);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Checkpoints
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_checkpoint
+{
+	SimpleRecord *sr = [[SimpleRecord alloc] init];
+	
+	sr.someString = @"abc123";
+	sr.someInteger = 42;
+	
+	[sr clearChangeTracking];
+	sr.someInteger = 43;
+	
+	SimpleRecord *sr_a = [sr immutableCopy];
+	NSDictionary *changeset_a = [sr peakChangeset];
+	
+	id checkpoint = [sr checkpoint];
+	
+	sr.someString = @"def456";
+	sr.someInteger = 44;
+	
+	[sr restoreCheckpoint:checkpoint];
+	
+	XCTAssert([sr isEqualToSimpleRecord:sr_a]);
+	XCTAssertEqualObjects([sr peakChangeset], changeset_a);
+	
+	// The restored changeset undoes all the way back to the baseline
+	
+	[sr undo:[sr changeset] error:nil];
+	XCTAssert(sr.someInteger == 42);
+}
+
+- (void)test_checkpoint_notTracked
+{
+	SimpleRecord *sr = [[SimpleRecord alloc] init];
+	
+	sr.someString = @"abc123";
+	sr.someInteger = 42;
+	
+	[sr clearChangeTracking];
+	
+	id checkpoint = [sr checkpoint];
+	
+	sr.someString = @"def456";
+	sr.someInteger = 43;
+	
+	// Restoring isn't a change, so KVO doesn't fire
+	
+	kvoCount = 0;
+	[sr addObserver:self forKeyPath:@"someString" options:0 context:NULL];
+	[sr addObserver:self forKeyPath:@"someInteger" options:0 context:NULL];
+	
+	[sr restoreCheckpoint:checkpoint];
+	
+	[sr removeObserver:self forKeyPath:@"someString"];
+	[sr removeObserver:self forKeyPath:@"someInteger"];
+	
+	XCTAssert(kvoCount == 0);
+	
+	XCTAssertEqualObjects(sr.someString, @"abc123");
+	XCTAssert(sr.someInteger == 42);
+	
+	XCTAssert(!sr.hasChanges);
+	XCTAssert([sr peakChangeset] == nil);
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath
+                      ofObject:(id)object
+                        change:(NSDictionary<NSKeyValueChangeKey, id> *)change
+                       context:(void *)context
+{
+	kvoCount++;
+}
+
 @end
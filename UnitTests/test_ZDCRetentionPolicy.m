@@ -0,0 +1,271 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <XCTest/XCTest.h>
+
+#import "ZDCRetentionPolicy.h"
+#import "ZDCArray.h"
+#import "ZDCDictionary.h"
+#import "ZDCOrderedDictionary.h"
+
+#import "SimpleRecord.h"
+
+@interface test_ZDCRetentionPolicy : XCTestCase
+@end
+
+@implementation test_ZDCRetentionPolicy {
+	
+	NSURL *spillDirectory;
+}
+
+- (void)setUp
+{
+	[super setUp];
+	
+	NSString *dirName = [NSString stringWithFormat:@"test_ZDCRetentionPolicy-%@", [[NSUUID UUID] UUIDString]];
+	spillDirectory = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:dirName]];
+}
+
+- (void)tearDown
+{
+	[[NSFileManager defaultManager] removeItemAtURL:spillDirectory error:NULL];
+	
+	[super tearDown];
+}
+
+- (NSData *)randomData:(NSUInteger)length
+{
+	NSMutableData *data = [NSMutableData dataWithLength:length];
+	arc4random_buf(data.mutableBytes, length);
+	
+	return data;
+}
+
+- (NSUInteger)spilledFileCount
+{
+	NSArray *contents = [[NSFileManager defaultManager] contentsOfDirectoryAtURL: spillDirectory
+	                                                  includingPropertiesForKeys: nil
+	                                                                     options: 0
+	                                                                       error: NULL];
+	return contents.count;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Spilling
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_spilling_dictionary
+{
+	ZDCSpillingRetentionPolicy *policy =
+	  [[ZDCSpillingRetentionPolicy alloc] initWithByteBudget:(1024 * 4) directory:spillDirectory];
+	
+	ZDCDictionary<NSString*, NSData*> *dict = [[ZDCDictionary alloc] init];
+	dict.retentionPolicy = policy;
+	
+	for (NSUInteger i = 0; i < 10; i++)
+	{
+		dict[[NSString stringWithFormat:@"%lu", (unsigned long)i]] = [self randomData:1024];
+	}
+	
+	[dict clearChangeTracking];
+	ZDCDictionary *dict_a = [dict immutableCopy];
+	
+	[dict removeAllObjects];
+	
+	XCTAssert(policy.memoryUsage <= policy.byteBudget);
+	XCTAssert([self spilledFileCount] > 0);
+	
+	NSDictionary *changeset_undo = [dict changeset];
+	ZDCDictionary *dict_b = [dict immutableCopy];
+	
+	NSDictionary *changeset_redo = [dict undo:changeset_undo error:nil];
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+	
+	[dict undo:changeset_redo error:nil];
+	XCTAssert([dict isEqualToDictionary:dict_b]);
+}
+
+- (void)test_spilling_array
+{
+	ZDCSpillingRetentionPolicy *policy =
+	  [[ZDCSpillingRetentionPolicy alloc] initWithByteBudget:0 directory:spillDirectory];
+	
+	ZDCArray<NSData*> *array = [[ZDCArray alloc] init];
+	array.retentionPolicy = policy;
+	
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		[array addObject:[self randomData:64]];
+	}
+	
+	[array clearChangeTracking];
+	ZDCArray *array_a = [array immutableCopy];
+	
+	// Enough churn to trigger snapshot-and-diff (which is disabled when a retention policy is configured)
+	
+	for (NSUInteger i = 0; i < 80; i++)
+	{
+		[array removeObjectAtIndex:(NSUInteger)arc4random_uniform((uint32_t)array.count)];
+	}
+	
+	XCTAssert(policy.memoryUsage == 0);
+	
+	NSDictionary *changeset_undo = [array changeset];
+	ZDCArray *array_b = [array immutableCopy];
+	
+	NSDictionary *changeset_redo = [array undo:changeset_undo error:nil];
+	XCTAssert([array isEqualToArray:array_a]);
+	
+	[array undo:changeset_redo error:nil];
+	XCTAssert([array isEqualToArray:array_b]);
+}
+
+- (void)test_spilling_cleanup
+{
+	ZDCSpillingRetentionPolicy *policy =
+	  [[ZDCSpillingRetentionPolicy alloc] initWithByteBudget:0 directory:spillDirectory];
+	
+	@autoreleasepool
+	{
+		ZDCOrderedDictionary *dict = [[ZDCOrderedDictionary alloc] init];
+		dict.retentionPolicy = policy;
+		
+		dict[@"a"] = [self randomData:64];
+		dict[@"b"] = [self randomData:64];
+		[dict clearChangeTracking];
+		
+		dict[@"a"] = [self randomData:64];
+		[dict removeObjectForKey:@"b"];
+		
+		XCTAssert([self spilledFileCount] == 2);
+		
+		[dict clearChangeTracking];
+	}
+	
+	// Once the originals are no longer referenced, the spilled files are deleted.
+	
+	XCTAssert([self spilledFileCount] == 0);
+}
+
+- (void)test_spilling_failedRead
+{
+	ZDCSpillingRetentionPolicy *policy =
+	  [[ZDCSpillingRetentionPolicy alloc] initWithByteBudget:0 directory:spillDirectory];
+	
+	ZDCDictionary *child = [[ZDCDictionary alloc] init];
+	child.retentionPolicy = policy;
+	
+	ZDCDictionary *parent = [[ZDCDictionary alloc] init];
+	parent[@"child"] = child;
+	
+	child[@"a"] = [self randomData:64];
+	child[@"b"] = [self randomData:64];
+	[parent clearChangeTracking];
+	
+	child[@"a"] = [self randomData:64];
+	[child removeObjectForKey:@"b"];
+	
+	XCTAssert([self spilledFileCount] == 2);
+	
+	// Simulate a spilled value that can no longer be read back
+	
+	[[NSFileManager defaultManager] removeItemAtURL:spillDirectory error:NULL];
+	
+	NSError *error = nil;
+	NSDictionary *changeset = [child changesetWithError:&error];
+	
+	XCTAssert(changeset == nil);
+	XCTAssert(error != nil);
+	XCTAssert(child.hasChanges); // the changes must not be lost
+	
+	// The failure is reported by the parent too
+	
+	error = nil;
+	changeset = [parent changesetWithError:&error];
+	
+	XCTAssert(changeset == nil);
+	XCTAssert(error != nil);
+	XCTAssert(parent.hasChanges);
+	XCTAssert(child.hasChanges);
+	
+	XCTAssert([child changeset] == nil);
+	XCTAssert(child.hasChanges);
+}
+
+- (void)test_spilling_nonCodable
+{
+	ZDCSpillingRetentionPolicy *policy =
+	  [[ZDCSpillingRetentionPolicy alloc] initWithByteBudget:0 directory:spillDirectory];
+	
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict.retentionPolicy = policy;
+	
+	dict[@"a"] = [[NSObject alloc] init];
+	dict[@"b"] = [[NSObject alloc] init];
+	[dict clearChangeTracking];
+	
+	dict[@"a"] = [[NSObject alloc] init];
+	[dict removeObjectForKey:@"b"];
+	
+	// Values that can't be spilled stay in memory, and aren't counted against the budget
+	
+	XCTAssert(policy.memoryUsage == 0);
+	XCTAssert([self spilledFileCount] == 0);
+	
+	NSError *error = nil;
+	NSDictionary *changeset = [dict changesetWithError:&error];
+	
+	XCTAssert(changeset != nil);
+	XCTAssert(error == nil);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Resolver
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_resolver_record
+{
+	NSMutableDictionary<NSString*, NSString*> *store = [NSMutableDictionary dictionary];
+	__block NSUInteger tokenCount = 0;
+	
+	ZDCResolverRetentionPolicy *policy =
+	  [[ZDCResolverRetentionPolicy alloc] initWithTokenizer:^id _Nullable (id value) {
+		
+		if (![value isKindOfClass:[NSString class]]) return nil;
+		
+		NSString *token = [NSString stringWithFormat:@"%lu", (unsigned long)tokenCount++];
+		store[token] = value;
+		return token;
+		
+	} resolver:^id _Nullable (id token) {
+		
+		return store[token];
+	}];
+	
+	SimpleRecord *sr = [[SimpleRecord alloc] init];
+	sr.retentionPolicy = policy;
+	
+	sr.someString = @"abc123";
+	sr.someInteger = 42;
+	
+	[sr clearChangeTracking];
+	SimpleRecord *sr_a = [sr immutableCopy];
+	
+	sr.someString = @"def456";
+	sr.someInteger = 43;
+	
+	XCTAssert(store.count == 1); // someInteger is an NSNumber, which stays in memory
+	
+	NSDictionary *changeset_undo = [sr changeset];
+	SimpleRecord *sr_b = [sr immutableCopy];
+	
+	NSDictionary *changeset_redo = [sr undo:changeset_undo error:nil];
+	XCTAssert([sr isEqualToSimpleRecord:sr_a]);
+	
+	[sr undo:changeset_redo error:nil];
+	XCTAssert([sr isEqualToSimpleRecord:sr_b]);
+}
+
+@end
@@ -432,6 +432,148 @@
 	}}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_diff_fuzz_everything
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCSet *set_src = [[ZDCSet alloc] init];
+		
+		// Start with an object that has a random number of objects [20 - 30)
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[set_src addObject:[self randomLetters:8]];
+		}
+		
+		[set_src clearChangeTracking];
+		ZDCSet *set_dst = [set_src copy];
+		
+		// Make a random number of changes to the copy: [0 - 30)
+		
+		NSUInteger changeCount = (NSUInteger)arc4random_uniform((uint32_t)30);
+		for (NSUInteger i = 0; i < changeCount; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)2);
+			
+			if (random == 0)
+			{
+				[set_dst addObject:[self randomLetters:8]];
+			}
+			else
+			{
+				if (set_dst.count > 0) {
+					[set_dst removeObject:[[set_dst.rawSet allObjects] firstObject]];
+				}
+			}
+		}
+		
+		NSDictionary *changeset = [ZDCSet changesetFrom:set_src to:set_dst];
+		
+		if ([set_src isEqualToSet:set_dst]) {
+			XCTAssert(changeset == nil);
+			continue;
+		}
+		
+		// Applying the diff (as an undo) to the dst should produce the src.
+		
+		ZDCSet *set = [set_dst copy];
+		[set clearChangeTracking];
+		
+		NSError *error = nil;
+		[set undo:changeset error:&error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([set isEqualToSet:set_src]);
+	}}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Set Algebra
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_setAlgebra_fuzz
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCSet *set = [[ZDCSet alloc] init];
+		
+		NSUInteger startCount = 20 + (NSUInteger)arc4random_uniform((uint32_t)10);
+		for (NSUInteger i = 0; i < startCount; i++)
+		{
+			[set addObject:[self randomLetters:8]];
+		}
+		[set clearChangeTracking];
+		
+		// Some tracked changes beforehand, so the bulk operations have to cancel out prior adds & deletes
+		
+		for (NSUInteger i = 0; i < 5; i++)
+		{
+			[set addObject:[self randomLetters:8]];
+			[set removeObject:[[set.rawSet allObjects] firstObject]];
+		}
+		
+		// The other set: a mixture of members & non-members
+		
+		NSMutableSet *other = [NSMutableSet set];
+		for (id obj in set)
+		{
+			if (arc4random_uniform(2) == 0) {
+				[other addObject:obj];
+			}
+		}
+		for (NSUInteger i = 0; i < 10; i++)
+		{
+			[other addObject:[self randomLetters:8]];
+		}
+		
+		ZDCSet *control = [set copy];
+		
+		uint32_t const random = arc4random_uniform(4);
+		if (random == 0)
+		{
+			[set unionSet:other];
+			for (id obj in other) {
+				[control addObject:obj];
+			}
+		}
+		else if (random == 1)
+		{
+			[set minusSet:other];
+			for (id obj in other) {
+				[control removeObject:obj];
+			}
+		}
+		else if (random == 2)
+		{
+			[set intersectSet:other];
+			for (id obj in control.rawSet) {
+				if (![other containsObject:obj]) [control removeObject:obj];
+			}
+		}
+		else
+		{
+			[set setSet:other];
+			for (id obj in control.rawSet) {
+				if (![other containsObject:obj]) [control removeObject:obj];
+			}
+			for (id obj in other) {
+				[control addObject:obj];
+			}
+		}
+		
+		XCTAssert([set isEqualToSet:control]);
+		XCTAssert([set trackingStatistics].mutationCount == [control trackingStatistics].mutationCount);
+		
+		NSDictionary *changeset = [set changeset];
+		XCTAssert([changeset isEqual:[control changeset]]);
+	}}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Merge - Simple
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -613,4 +755,51 @@
 	XCTAssert([localSet containsObject:@(43)]);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Checkpoints
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_checkpoint
+{
+	ZDCSet *set = [[ZDCSet alloc] initWithArray:@[ @"cow", @"duck" ]];
+	[set clearChangeTracking];
+	
+	[set addObject:@"dog"];
+	
+	ZDCSet *set_a = [set immutableCopy];
+	NSDictionary *changeset_a = [set peakChangeset];
+	
+	id checkpoint = [set checkpoint];
+	
+	[set removeObject:@"cow"];
+	[set unionSet:[NSSet setWithObjects:@"cat", @"horse", nil]];
+	
+	[set restoreCheckpoint:checkpoint];
+	
+	XCTAssert([set isEqualToSet:set_a]);
+	XCTAssertEqualObjects([set peakChangeset], changeset_a);
+	
+	// The checkpoint wasn't modified by the restored set
+	
+	[set removeAllObjects];
+	[set restoreCheckpoint:checkpoint];
+	
+	XCTAssert([set isEqualToSet:set_a]);
+}
+
+- (void)test_copyOnWrite
+{
+	ZDCSet *set = [[ZDCSet alloc] initWithArray:@[ @"cow", @"duck" ]];
+	ZDCSet *copy = [set copy];
+	
+	[set addObject:@"dog"];
+	[copy removeObject:@"cow"];
+	
+	XCTAssert(set.count == 3);
+	XCTAssert(copy.count == 1);
+	
+	XCTAssert([[set peakChangeset][@"added"] count] == 3);
+	XCTAssert([[copy peakChangeset][@"added"] count] == 1);
+}
+
 @end
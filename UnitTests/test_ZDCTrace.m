@@ -0,0 +1,131 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <XCTest/XCTest.h>
+
+#import "ZDCTrace.h"
+#import "ZDCArray.h"
+#import "ZDCDictionary.h"
+
+typedef struct {
+	NSUInteger beginCount;
+	NSUInteger endCount;
+	NSUInteger counterCount;
+	NSUInteger mergeStepCount;
+} TestTraceCounts;
+
+static void TestTraceSink(const ZDCTraceEvent *event, void *context)
+{
+	TestTraceCounts *counts = (TestTraceCounts *)context;
+	
+	switch (event->type)
+	{
+		case ZDCTraceEventType_Begin:
+		{
+			counts->beginCount++;
+			if (strncmp(event->name, "mergeCloudVersion: step", 23) == 0) {
+				counts->mergeStepCount++;
+			}
+			break;
+		}
+		case ZDCTraceEventType_End     : counts->endCount++;     break;
+		case ZDCTraceEventType_Counter : counts->counterCount++; break;
+	}
+}
+
+@interface test_ZDCTrace : XCTestCase
+@end
+
+@implementation test_ZDCTrace
+
+- (void)tearDown
+{
+	ZDCTraceSetSink(NULL, NULL);
+	
+	[super tearDown];
+}
+
+- (void)test_sink
+{
+#if ZDC_TRACE_ENABLED
+	TestTraceCounts counts = {0};
+	ZDCTraceSetSink(TestTraceSink, &counts);
+	
+	NSError *error = nil;
+	NSMutableArray<NSDictionary *> *changesets = [NSMutableArray array];
+	
+	ZDCDictionary *localDict = [[ZDCDictionary alloc] init];
+	localDict[@"string"] = @"abc123";
+	localDict[@"integer"] = @(42);
+	
+	[localDict clearChangeTracking];
+	ZDCDictionary *cloudDict = [localDict copy];
+	
+	localDict[@"string"] = @"def456";
+	[changesets addObject:[localDict changeset]];
+	
+	cloudDict[@"integer"] = @(43);
+	[cloudDict makeImmutable];
+	
+	[localDict mergeCloudVersion: cloudDict
+	       withPendingChangesets: changesets
+	                       error: &error];
+	
+	ZDCTraceSetSink(NULL, NULL);
+	
+	XCTAssert(counts.beginCount > 0);
+	XCTAssert(counts.beginCount == counts.endCount);
+	XCTAssert(counts.counterCount > 0);
+	XCTAssert(counts.mergeStepCount == 4);
+	
+	// Nothing is delivered once the sink is removed
+	
+	NSUInteger const beginCount = counts.beginCount;
+	[localDict removeAllObjects];
+	[localDict undo:[localDict changeset] error:nil];
+	
+	XCTAssert(counts.beginCount == beginCount);
+#endif
+}
+
+- (void)test_chromeTrace
+{
+#if ZDC_TRACE_ENABLED
+	NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:
+	  [NSString stringWithFormat:@"test_ZDCTrace-%@.json", [[NSUUID UUID] UUIDString]]];
+	
+	XCTAssert(ZDCTraceStartChromeTrace(path.fileSystemRepresentation));
+	
+	ZDCArray *array = [[ZDCArray alloc] init];
+	[array addObject:@"alice"];
+	[array addObject:@"bob"];
+	[array clearChangeTracking];
+	
+	[array removeObjectAtIndex:0];
+	[array undo:[array changeset] error:nil];
+	
+	ZDCTraceStopChromeTrace();
+	
+	NSData *data = [NSData dataWithContentsOfFile:path];
+	[[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+	
+	NSDictionary *json = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+	NSArray<NSDictionary *> *events = json[@"traceEvents"];
+	
+	XCTAssert([events isKindOfClass:[NSArray class]]);
+	XCTAssert(events.count > 0);
+	
+	BOOL foundUndo = NO;
+	for (NSDictionary *event in events)
+	{
+		if ([event[@"name"] isEqual:@"_undo"] && [event[@"ph"] isEqual:@"B"]) {
+			foundUndo = YES;
+		}
+	}
+	XCTAssert(foundUndo);
+#endif
+}
+
+@end
@@ -0,0 +1,363 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <XCTest/XCTest.h>
+#import "ZDCUndoHistory.h"
+#import "ZDCDictionary.h"
+
+@interface test_ZDCUndoHistory : XCTestCase
+@end
+
+@implementation test_ZDCUndoHistory
+
+- (NSString *)randomLetters:(NSUInteger)length
+{
+	NSString *alphabet = @"abcdefghijklmnopqrstuvwxyz";
+	NSUInteger alphabetLength = [alphabet length];
+	
+	NSMutableString *result = [NSMutableString stringWithCapacity:length];
+	
+	NSUInteger i;
+	for (i = 0; i < length; i++)
+	{
+		unichar c = [alphabet characterAtIndex:(NSUInteger)arc4random_uniform((uint32_t)alphabetLength)];
+		
+		[result appendFormat:@"%C", c];
+	}
+	
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Basic
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_basic
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+	
+	ZDCDictionary *dict_a = [dict immutableCopy];
+	
+	dict[@"cow"] = @"moo";
+	XCTAssert([history recordChanges] != nil);
+	
+	ZDCDictionary *dict_b = [dict immutableCopy];
+	
+	dict[@"duck"] = @"quack";
+	XCTAssert([history recordChanges] != nil);
+	
+	ZDCDictionary *dict_c = [dict immutableCopy];
+	
+	XCTAssert(history.undoCount == 2);
+	XCTAssert(history.redoCount == 0);
+	
+	NSError *error = nil;
+	
+	XCTAssert([history undo:&error].count > 0);
+	XCTAssert([dict isEqualToDictionary:dict_b]);
+	
+	XCTAssert([history undo:&error].count > 0);
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+	
+	XCTAssert(!history.canUndo);
+	XCTAssert([history undo:&error].count == 0);
+	
+	XCTAssert([history redo:&error].count > 0);
+	XCTAssert([dict isEqualToDictionary:dict_b]);
+	
+	XCTAssert([history redo:&error].count > 0);
+	XCTAssert([dict isEqualToDictionary:dict_c]);
+	
+	XCTAssert(error == nil);
+	XCTAssert(!history.canRedo);
+}
+
+- (void)test_recordClearsRedo
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+	
+	dict[@"cow"] = @"moo";
+	[history recordChanges];
+	
+	[history undo:nil];
+	XCTAssert(history.canRedo);
+	
+	dict[@"duck"] = @"quack";
+	[history recordChanges];
+	
+	XCTAssert(!history.canRedo);
+	XCTAssert(history.undoCount == 1);
+}
+
+- (void)test_undoRecordsPendingChanges
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+	
+	ZDCDictionary *dict_a = [dict immutableCopy];
+	
+	// Changes that haven't been recorded yet are recorded (and then undone)
+	
+	dict[@"cow"] = @"moo";
+	
+	NSArray<NSDictionary*> *changesets = [history undo:nil];
+	
+	XCTAssert(changesets.count == 2); // recorded + undo
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+	XCTAssert(history.canRedo);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Coalescing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_grouping
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	dict[@"text"] = @"";
+	[dict clearChangeTracking];
+	
+	ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+	ZDCDictionary *dict_a = [dict immutableCopy];
+	
+	// 200 keystroke-level changes, coalesced into a single step
+	
+	[history beginGrouping];
+	for (NSUInteger i = 0; i < 200; i++)
+	{
+		dict[@"text"] = [dict[@"text"] stringByAppendingString:[self randomLetters:1]];
+		[history recordChanges];
+	}
+	[history endGrouping];
+	
+	ZDCDictionary *dict_b = [dict immutableCopy];
+	
+	XCTAssert(history.undoCount == 1);
+	
+	// The step holds a single (merged) changeset
+	XCTAssert([history undo:nil].count == 1);
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+	
+	XCTAssert([history redo:nil].count == 1);
+	XCTAssert([dict isEqualToDictionary:dict_b]);
+	
+	// The next change is a separate step
+	
+	dict[@"text"] = @"";
+	[history recordChanges];
+	
+	XCTAssert(history.undoCount == 2);
+}
+
+- (void)test_coalescingInterval
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+	
+	history.coalescingInterval = 60;
+	
+	ZDCDictionary *dict_a = [dict immutableCopy];
+	
+	for (NSUInteger i = 0; i < 10; i++)
+	{
+		dict[[self randomLetters:8]] = @(i);
+		[history recordChanges];
+	}
+	
+	XCTAssert(history.undoCount == 1);
+	
+	[history closeCurrentStep];
+	
+	dict[[self randomLetters:8]] = @(42);
+	[history recordChanges];
+	
+	XCTAssert(history.undoCount == 2);
+	
+	[history undo:nil];
+	
+	// The coalesced step holds a single (merged) changeset
+	XCTAssert([history undo:nil].count == 1);
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Budget
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_stepLimit
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+	
+	history.stepLimit = 3;
+	
+	NSMutableArray<ZDCDictionary*> *states = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 10; i++)
+	{
+		[states addObject:[dict immutableCopy]];
+		
+		dict[@"value"] = @(i);
+		[history recordChanges];
+	}
+	
+	XCTAssert(history.undoCount == 3);
+	
+	[history undo:nil];
+	XCTAssert([dict isEqualToDictionary:states[9]]);
+	
+	[history undo:nil];
+	XCTAssert([dict isEqualToDictionary:states[8]]);
+	
+	// The oldest steps were squashed together, so the original state is still reachable
+	XCTAssert([history undo:nil].count == 1);
+	XCTAssert([dict isEqualToDictionary:states[0]]);
+	XCTAssert(!history.canUndo);
+}
+
+- (void)test_costLimit
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+	
+	history.stepLimit = 0;
+	history.costLimit = 50;
+	
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		dict[[self randomLetters:8]] = @(i);
+		[history recordChanges];
+		
+		XCTAssert(history.totalCost <= 50);
+	}
+	
+	XCTAssert(history.undoCount > 0);
+	XCTAssert(history.undoCount < 100);
+	
+	// A single step is always kept, even if it exceeds the limit on its own
+	
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		dict[[self randomLetters:8]] = @(i);
+	}
+	[history recordChanges];
+	
+	XCTAssert(history.undoCount == 1);
+}
+
+- (void)test_costLimit_squash
+{
+	ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+	ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+	
+	history.stepLimit = 0;
+	history.costLimit = 10;
+	
+	ZDCDictionary *dict_a = [dict immutableCopy];
+	
+	// Repeated edits to the same value collapse when squashed,
+	// so the history stays within its limit without discarding the original state.
+	
+	for (NSUInteger i = 0; i < 100; i++)
+	{
+		dict[@"value"] = @(i);
+		[history recordChanges];
+		
+		XCTAssert(history.totalCost <= 10);
+	}
+	
+	while (history.canUndo)
+	{
+		NSError *error = nil;
+		[history undo:&error];
+		XCTAssert(error == nil);
+	}
+	
+	XCTAssert([dict isEqualToDictionary:dict_a]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Fuzz
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_fuzz
+{
+	for (NSUInteger round = 0; round < 500; round++) { @autoreleasepool
+	{
+		ZDCDictionary *dict = [[ZDCDictionary alloc] init];
+		for (NSUInteger i = 0; i < 10; i++)
+		{
+			dict[[self randomLetters:1]] = [self randomLetters:4];
+		}
+		[dict clearChangeTracking];
+		
+		ZDCUndoHistory *history = [[ZDCUndoHistory alloc] initWithRoot:dict];
+		
+		// states[undoCount] is the current state
+		NSMutableArray<ZDCDictionary*> *states = [NSMutableArray arrayWithObject:[dict immutableCopy]];
+		NSUInteger current = 0;
+		
+		for (NSUInteger i = 0; i < 50; i++)
+		{
+			uint32_t random = arc4random_uniform((uint32_t)4);
+			
+			if (random == 0 && history.canUndo)
+			{
+				NSError *error = nil;
+				[history undo:&error];
+				XCTAssert(error == nil);
+				
+				current--;
+			}
+			else if (random == 1 && history.canRedo)
+			{
+				NSError *error = nil;
+				[history redo:&error];
+				XCTAssert(error == nil);
+				
+				current++;
+			}
+			else
+			{
+				// Make a few changes (possibly across multiple records), as a single step
+				
+				[history beginGrouping];
+				
+				NSUInteger changeCount = 1 + (NSUInteger)arc4random_uniform((uint32_t)5);
+				for (NSUInteger j = 0; j < changeCount; j++)
+				{
+					NSString *key = [self randomLetters:1];
+					
+					if (arc4random_uniform((uint32_t)3) == 0)
+						[dict removeObjectForKey:key];
+					else
+						dict[key] = [self randomLetters:4];
+					
+					if (arc4random_uniform((uint32_t)2) == 0) {
+						[history recordChanges];
+					}
+				}
+				
+				[history endGrouping];
+				
+				// If anything was recorded, it's a new step (even if the changes cancelled each other out),
+				// and the redo stack was cleared.
+				
+				if (history.undoCount > current)
+				{
+					[states removeObjectsInRange:NSMakeRange(current + 1, states.count - current - 1)];
+					[states addObject:[dict immutableCopy]];
+					current++;
+				}
+			}
+			
+			XCTAssert(history.undoCount == current);
+			XCTAssert([dict isEqualToDictionary:states[current]]);
+		}
+	}}
+}
+
+@end
@@ -0,0 +1,113 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <XCTest/XCTest.h>
+
+#import "ZDCWorkloadTrace.h"
+#import "ZDCArray.h"
+
+@interface test_ZDCWorkloadTrace : XCTestCase
+@end
+
+@implementation test_ZDCWorkloadTrace {
+	
+	NSURL *url;
+}
+
+- (void)setUp
+{
+	[super setUp];
+	
+	NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:
+	  [NSString stringWithFormat:@"test_ZDCWorkloadTrace-%@.trace", [[NSUUID UUID] UUIDString]]];
+	
+	url = [NSURL fileURLWithPath:path];
+}
+
+- (void)tearDown
+{
+	[[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+	
+	[super tearDown];
+}
+
+- (void)test_recordAndReplay
+{
+	NSError *error = nil;
+	
+	ZDCArray *original = [[ZDCArray alloc] init];
+	[original addObject:@"alice"];
+	[original addObject:@"bob"];
+	[original addObject:@"carol"];
+	[original clearChangeTracking];
+	
+	ZDCArray *cloud = [original copy];
+	
+	ZDCWorkloadRecorder *recorder = [[ZDCWorkloadRecorder alloc] initWithURL:url error:&error];
+	XCTAssert(recorder != nil);
+	
+	ZDCArray *array = [recorder startRecording:original];
+	
+	// Mutations, changeset & undo
+	
+	[array moveObjectAtIndex:0 toIndex:2];
+	[array removeObjectAtIndex:1];
+	[array addObject:@"dave"];
+	
+	NSDictionary *changeset = [array changeset];
+	XCTAssert(changeset != nil);
+	
+	[array undo:changeset error:nil];
+	XCTAssert(array.count == 3);
+	
+	[array insertObject:@"eve" atIndex:1];
+	NSMutableArray *changesets = [NSMutableArray arrayWithObject:[array changeset]];
+	
+	// Merge
+	
+	[cloud addObject:@"frank"];
+	[cloud makeImmutable];
+	
+	[array mergeCloudVersion:cloud withPendingChangesets:changesets error:nil];
+	
+	// Not recordable (block argument), but still forwarded
+	
+	__block NSUInteger enumerated = 0;
+	[array enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop) {
+		enumerated++;
+	}];
+	XCTAssert(enumerated == original.count);
+	
+	XCTAssert([recorder stopRecording:&error]);
+	XCTAssert(recorder.recordedCount > 0);
+	XCTAssert(recorder.skippedCount == 1);
+	
+	// Replay
+	
+	ZDCWorkloadReplayer *replayer = [[ZDCWorkloadReplayer alloc] initWithURL:url];
+	ZDCWorkloadReplayResult *result = [replayer replay:&error];
+	
+	XCTAssert(result != nil);
+	XCTAssert(result.succeeded, @"%@", result.report);
+	XCTAssert(result.finalStateMatches);
+	XCTAssert(result.operationCount == recorder.recordedCount);
+	
+	ZDCLatencyHistogram *histogram = result.latencies[@"changeset"];
+	XCTAssert(histogram.count == 2);
+	XCTAssert([histogram nanosecondsAtPercentile:50] <= histogram.maxNanoseconds);
+}
+
+- (void)test_invalidFile
+{
+	[[NSData dataWithBytes:"garbage" length:7] writeToURL:url atomically:YES];
+	
+	NSError *error = nil;
+	ZDCWorkloadReplayer *replayer = [[ZDCWorkloadReplayer alloc] initWithURL:url];
+	
+	XCTAssert([replayer replay:&error] == nil);
+	XCTAssert(error != nil);
+}
+
+@end
@@ -0,0 +1,135 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+#import "ZDCChangeNotification.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Implemented by keyed containers (ZDCOrderedDictionary), which report value updates via `updatedKey:`.
+ */
+@protocol ZDCChangeCoalescerKeyedObject <NSObject>
+
+/** The current order of keys (not copied). */
+- (NSArray<id> *)changeCoalescerKeyOrder;
+
+@end
+
+/**
+ * ZDCChangeCoalescer is used by the ordered containers (ZDCArray & ZDCOrderedDictionary)
+ * to deliver change notifications (see `addChangeObserver:`).
+ *
+ * Where it's used:
+ *   A container only creates a coalescer once an observer is registered,
+ *   and drops it when the last observer is removed. So the cost of the feature, when unused,
+ *   is a nil check within each mutating method.
+ *
+ * How it works:
+ *   The container reports every structural change (insert, remove, move, update) as it happens.
+ *   The coalescer maintains a list of "slots" that mirrors the current order of the container.
+ *   Each slot remembers where the item was located when the previous notification was delivered
+ *   (or that it's been inserted since then). When the notification is delivered, the slots are scanned once
+ *   to calculate the inserted/moved/updated indexes. Removed indexes are recorded as they happen.
+ *
+ *   The slots are only materialized upon the first change after a notification.
+ *   Until then they're implicitly the identity mapping.
+ *
+ * Delivery:
+ *   The notification is delivered on the next turn of the run loop of the thread that made the first change
+ *   (via CFRunLoopPerformBlock), or when the outermost batch ends, or when `flush` is invoked.
+ */
+@interface ZDCChangeCoalescer : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * @param object
+ *   The container (held weakly).
+ *
+ * @param count
+ *   The current number of items in the container.
+ */
+- (instancetype)initWithObject:(id)object count:(NSUInteger)count;
+
+#pragma mark Observers
+
+- (id)addObserver:(ZDCChangeObserverBlock)block;
+- (void)removeObserver:(id)observer;
+
+@property (nonatomic, readonly) BOOL hasObservers;
+
+#pragma mark Changes
+
+/** An item was inserted at the given index. */
+- (void)insertedIndex:(NSUInteger)idx;
+
+/** The item at the given index was removed. */
+- (void)removedIndex:(NSUInteger)idx;
+
+/** The item at the given index was moved (i.e. removed, and then inserted at newIdx). */
+- (void)movedIndex:(NSUInteger)oldIdx toIndex:(NSUInteger)newIdx;
+
+/** The value at the given index was replaced. The key should be nil for non-keyed containers. */
+- (void)updatedIndex:(NSUInteger)idx key:(nullable id)key;
+
+/**
+ * The value for the given key was replaced, and the caller doesn't know its index.
+ *
+ * Looking up the index is a linear scan of the order. So rather than doing this per update,
+ * the keys are collected, and resolved with a single pass over the order when the notification is delivered.
+ * The object must conform to ZDCChangeCoalescerKeyedObject.
+ */
+- (void)updatedKey:(id)key;
+
+/**
+ * For bulk moves: the items at the given indexes are removed, to be reinserted via `reattachIndex:atIndex:`.
+ * Any detached items that aren't reattached (before the next `detachIndexes:`) are treated as removed.
+ */
+- (void)detachIndexes:(NSIndexSet *)indexes;
+
+/**
+ * Reinserts a detached item.
+ *
+ * @param detachedIdx
+ *   The index of the item before it was detached (i.e. an index within the set passed to `detachIndexes:`).
+ *
+ * @param idx
+ *   The index at which the item is being reinserted.
+ */
+- (void)reattachIndex:(NSUInteger)detachedIdx atIndex:(NSUInteger)idx;
+
+/** The contents were replaced wholesale. */
+- (void)reloadWithCount:(NSUInteger)count;
+
+#pragma mark Delivery
+
+- (void)beginBatch;
+- (void)endBatch;
+
+/**
+ * Delivers the pending notification (if any) immediately.
+ */
+- (void)flush;
+
+@end
+
+/**
+ * Used by ZDCChangeCoalescer to create notifications.
+ */
+@interface ZDCChangeNotification ()
+
+- (instancetype)initWithObject:(nullable id)object
+               insertedIndexes:(NSIndexSet *)insertedIndexes
+                removedIndexes:(NSIndexSet *)removedIndexes
+                  movedIndexes:(NSDictionary<NSNumber*, NSNumber*> *)movedIndexes
+                updatedIndexes:(NSIndexSet *)updatedIndexes
+                   updatedKeys:(NSSet<id> *)updatedKeys
+                requiresReload:(BOOL)requiresReload;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,505 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCChangeCoalescer.h"
+
+/**
+ * Mirrors a single item within the container.
+ */
+typedef struct ZDCChangeSlot {
+	
+	NSInteger origin; // index at the previous notification, or kInsertedOrigin
+	BOOL moved;       // explicitly moved since the previous notification
+	BOOL updated;     // value replaced since the previous notification
+	
+} ZDCChangeSlot;
+
+static NSInteger const kInsertedOrigin = -1;
+static NSInteger const kReattachedOrigin = -2; // marks a detached slot that has been reattached
+
+/**
+ * Registered via `addObserver:`, and returned as the (opaque) token.
+ */
+@interface ZDCChangeObserver : NSObject {
+@public
+
+	ZDCChangeObserverBlock block;
+}
+@end
+
+@implementation ZDCChangeObserver
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCChangeCoalescer {
+@private
+
+	__weak id object;
+	NSMutableArray<ZDCChangeObserver*> *observers;
+	
+	NSUInteger count;                                   // current number of items in the container
+	ZDCChangeSlot *slots;                               // NULL until materialized (implicitly the identity mapping)
+	NSUInteger slotCapacity;
+	
+	NSMutableIndexSet *removedIndexes;                  // [{ origin }]
+	NSMutableDictionary<NSNumber*, id> *updatedKeys;    // key={origin}, value={key}
+	NSMutableSet<id> *pendingUpdatedKeys;               // see `updatedKey:`, resolved upon flush
+	
+	ZDCChangeSlot *detached;                            // see `detachIndexes:`
+	NSUInteger detachedCount;
+	NSIndexSet *detachedIndexes;
+	
+	BOOL hasPendingChanges;
+	BOOL requiresReload;
+	BOOL flushScheduled;
+	NSUInteger batchDepth;
+}
+
+- (instancetype)initWithObject:(id)inObject count:(NSUInteger)inCount
+{
+	if ((self = [super init]))
+	{
+		object = inObject;
+		observers = [[NSMutableArray alloc] init];
+		
+		count = inCount;
+		removedIndexes = [[NSMutableIndexSet alloc] init];
+		updatedKeys = [[NSMutableDictionary alloc] init];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(slots);
+	free(detached);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Observers
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (id)addObserver:(ZDCChangeObserverBlock)block
+{
+	NSParameterAssert(block != nil);
+	
+	ZDCChangeObserver *observer = [[ZDCChangeObserver alloc] init];
+	observer->block = [block copy];
+	
+	[observers addObject:observer];
+	return observer;
+}
+
+- (void)removeObserver:(id)observer
+{
+	if (observer) {
+		[observers removeObjectIdenticalTo:observer];
+	}
+}
+
+- (BOOL)hasObservers
+{
+	return (observers.count > 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Slots
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)materializeSlots
+{
+	if (slots) return;
+	
+	slotCapacity = MAX(count + (count >> 2), (NSUInteger)16);
+	slots = malloc(slotCapacity * sizeof(ZDCChangeSlot));
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		slots[i] = (ZDCChangeSlot){ .origin = (NSInteger)i, .moved = NO, .updated = NO };
+	}
+}
+
+- (void)insertSlot:(ZDCChangeSlot)slot atIndex:(NSUInteger)idx
+{
+	if (count == slotCapacity)
+	{
+		slotCapacity *= 2;
+		slots = realloc(slots, slotCapacity * sizeof(ZDCChangeSlot));
+	}
+	
+	memmove(slots + idx + 1, slots + idx, (count - idx) * sizeof(ZDCChangeSlot));
+	slots[idx] = slot;
+	count++;
+}
+
+- (ZDCChangeSlot)takeSlotAtIndex:(NSUInteger)idx
+{
+	ZDCChangeSlot slot = slots[idx];
+	
+	memmove(slots + idx, slots + idx + 1, (count - idx - 1) * sizeof(ZDCChangeSlot));
+	count--;
+	
+	return slot;
+}
+
+/**
+ * Invoked when an item is removed from the container for good.
+ */
+- (void)discardSlot:(ZDCChangeSlot)slot
+{
+	if (slot.origin >= 0)
+	{
+		[removedIndexes addIndex:(NSUInteger)slot.origin];
+		updatedKeys[@(slot.origin)] = nil;
+	}
+	// else: inserted since the previous notification, so it simply disappears
+}
+
+/**
+ * Detached items that were never reattached have been removed.
+ */
+- (void)settleDetachedSlots
+{
+	for (NSUInteger i = 0; i < detachedCount; i++)
+	{
+		if (detached[i].origin != kReattachedOrigin) {
+			[self discardSlot:detached[i]];
+		}
+	}
+	
+	detachedCount = 0;
+	detachedIndexes = nil;
+}
+
+/**
+ * Invoked if the container reports a change that doesn't match our bookkeeping.
+ * Rather than delivering bogus indexes, we fall back to a reload.
+ */
+- (void)mismatch
+{
+	NSAssert(NO, @"ZDCChangeCoalescer: reported change doesn't match the container");
+	
+	[self reloadWithCount:count];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Changes
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)insertedIndex:(NSUInteger)idx
+{
+	if (idx > count) {
+		[self mismatch];
+		return;
+	}
+	
+	[self materializeSlots];
+	[self insertSlot:(ZDCChangeSlot){ .origin = kInsertedOrigin, .moved = NO, .updated = NO } atIndex:idx];
+	
+	[self didChange];
+}
+
+- (void)removedIndex:(NSUInteger)idx
+{
+	if (idx >= count) {
+		[self mismatch];
+		return;
+	}
+	
+	[self materializeSlots];
+	[self discardSlot:[self takeSlotAtIndex:idx]];
+	
+	[self didChange];
+}
+
+- (void)movedIndex:(NSUInteger)oldIdx toIndex:(NSUInteger)newIdx
+{
+	if ((oldIdx >= count) || (newIdx >= count)) {
+		[self mismatch];
+		return;
+	}
+	if (oldIdx == newIdx) {
+		return;
+	}
+	
+	[self materializeSlots];
+	
+	ZDCChangeSlot slot = [self takeSlotAtIndex:oldIdx];
+	slot.moved = YES;
+	[self insertSlot:slot atIndex:newIdx];
+	
+	[self didChange];
+}
+
+- (void)updatedIndex:(NSUInteger)idx key:(nullable id)key
+{
+	if (idx >= count) {
+		[self mismatch];
+		return;
+	}
+	
+	[self materializeSlots];
+	[self markSlotUpdatedAtIndex:idx key:key];
+	
+	[self didChange];
+}
+
+- (void)updatedKey:(id)key
+{
+	if (pendingUpdatedKeys == nil) {
+		pendingUpdatedKeys = [[NSMutableSet alloc] init];
+	}
+	[pendingUpdatedKeys addObject:key];
+	
+	[self didChange];
+}
+
+- (void)markSlotUpdatedAtIndex:(NSUInteger)idx key:(nullable id)key
+{
+	ZDCChangeSlot *slot = &slots[idx];
+	if (slot->origin >= 0)
+	{
+		slot->updated = YES;
+		if (key) {
+			updatedKeys[@(slot->origin)] = key;
+		}
+	}
+	// else: inserted since the previous notification, so it's still just an insert
+}
+
+/**
+ * Resolves the keys reported via `updatedKey:` with a single pass over the order.
+ *
+ * Each slot follows its item through any later moves, so resolving the key against the current order
+ * finds the same slot that an immediate lookup would have.
+ * Keys that have since been removed are skipped (the removal has already been recorded).
+ */
+- (void)resolvePendingUpdatedKeys
+{
+	if (pendingUpdatedKeys.count == 0) return;
+	
+	id<ZDCChangeCoalescerKeyedObject> container = object;
+	NSArray<id> *order = [container changeCoalescerKeyOrder];
+	
+	if (order.count != count)
+	{
+		[pendingUpdatedKeys removeAllObjects];
+		if (container) {
+			[self mismatch];
+		}
+		return;
+	}
+	
+	[self materializeSlots];
+	
+	NSUInteger remaining = pendingUpdatedKeys.count;
+	for (NSUInteger idx = 0; (idx < count) && (remaining > 0); idx++)
+	{
+		id key = order[idx];
+		if ([pendingUpdatedKeys containsObject:key])
+		{
+			[self markSlotUpdatedAtIndex:idx key:key];
+			remaining--;
+		}
+	}
+	
+	[pendingUpdatedKeys removeAllObjects];
+}
+
+- (void)detachIndexes:(NSIndexSet *)indexes
+{
+	[self settleDetachedSlots];
+	
+	if (indexes.count == 0) return;
+	if (indexes.lastIndex >= count) {
+		[self mismatch];
+		return;
+	}
+	
+	[self materializeSlots];
+	
+	detached = realloc(detached, indexes.count * sizeof(ZDCChangeSlot));
+	detachedIndexes = [indexes copy];
+	
+	// Single pass: move the detached slots aside, and compact the rest.
+	
+	NSUInteger dst = 0;
+	for (NSUInteger src = 0; src < count; src++)
+	{
+		if ([indexes containsIndex:src]) {
+			detached[detachedCount++] = slots[src];
+		}
+		else {
+			slots[dst++] = slots[src];
+		}
+	}
+	count = dst;
+	
+	[self didChange];
+}
+
+- (void)reattachIndex:(NSUInteger)detachedIdx atIndex:(NSUInteger)idx
+{
+	if (![detachedIndexes containsIndex:detachedIdx] || (idx > count)) {
+		[self mismatch];
+		return;
+	}
+	
+	NSUInteger const ordinal = [detachedIndexes countOfIndexesInRange:NSMakeRange(0, detachedIdx)];
+	
+	ZDCChangeSlot slot = detached[ordinal];
+	if (slot.origin == kReattachedOrigin) {
+		[self mismatch];
+		return;
+	}
+	detached[ordinal].origin = kReattachedOrigin;
+	
+	slot.moved = YES;
+	[self insertSlot:slot atIndex:idx];
+	
+	[self didChange];
+}
+
+- (void)reloadWithCount:(NSUInteger)newCount
+{
+	free(slots);
+	slots = NULL;
+	slotCapacity = 0;
+	count = newCount;
+	
+	detachedCount = 0;
+	detachedIndexes = nil;
+	
+	[removedIndexes removeAllIndexes];
+	[updatedKeys removeAllObjects];
+	[pendingUpdatedKeys removeAllObjects];
+	
+	requiresReload = YES;
+	[self didChange];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Delivery
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)didChange
+{
+	hasPendingChanges = YES;
+	
+	if (flushScheduled || (batchDepth > 0)) {
+		return;
+	}
+	flushScheduled = YES;
+	
+	// Deliver on the next turn of the current thread's run loop.
+	// All the changes made until then are coalesced into a single notification.
+	
+	__weak ZDCChangeCoalescer *weakSelf = self;
+	CFRunLoopRef runLoop = CFRunLoopGetCurrent();
+	
+	CFRunLoopPerformBlock(runLoop, kCFRunLoopCommonModes, ^{
+		
+		ZDCChangeCoalescer *strongSelf = weakSelf;
+		if (strongSelf)
+		{
+			strongSelf->flushScheduled = NO;
+			if (strongSelf->batchDepth == 0) {
+				[strongSelf flush];
+			}
+		}
+	});
+	CFRunLoopWakeUp(runLoop);
+}
+
+- (void)beginBatch
+{
+	batchDepth++;
+}
+
+- (void)endBatch
+{
+	NSAssert(batchDepth > 0, @"Unbalanced call to endBatch");
+	
+	if (batchDepth > 0) {
+		batchDepth--;
+	}
+	if (batchDepth == 0) {
+		[self flush];
+	}
+}
+
+- (void)flush
+{
+	if (!hasPendingChanges) return;
+	
+	[self settleDetachedSlots];
+	
+	if (!requiresReload) {
+		[self resolvePendingUpdatedKeys];
+	}
+	[pendingUpdatedKeys removeAllObjects];
+	
+	NSMutableIndexSet *insertedIndexes = [NSMutableIndexSet indexSet];
+	NSMutableIndexSet *updatedIndexes = [NSMutableIndexSet indexSet];
+	NSMutableDictionary<NSNumber*, NSNumber*> *movedIndexes = [NSMutableDictionary dictionary];
+	
+	if (slots && !requiresReload)
+	{
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			ZDCChangeSlot const slot = slots[i];
+			
+			if (slot.origin == kInsertedOrigin)
+			{
+				[insertedIndexes addIndex:i];
+			}
+			else
+			{
+				if (slot.moved) {
+					movedIndexes[@(i)] = @(slot.origin);
+				}
+				if (slot.updated) {
+					[updatedIndexes addIndex:(NSUInteger)slot.origin];
+				}
+			}
+		}
+	}
+	
+	ZDCChangeNotification *notification =
+	  [[ZDCChangeNotification alloc] initWithObject: object
+	                                insertedIndexes: insertedIndexes
+	                                 removedIndexes: (requiresReload ? [NSIndexSet indexSet] : removedIndexes)
+	                                   movedIndexes: movedIndexes
+	                                 updatedIndexes: updatedIndexes
+	                                    updatedKeys: [NSSet setWithArray:[updatedKeys allValues]]
+	                                 requiresReload: requiresReload];
+	
+	// Reset: the current state becomes the baseline for the next notification.
+	
+	free(slots);
+	slots = NULL;
+	slotCapacity = 0;
+	
+	[removedIndexes removeAllIndexes];
+	[updatedKeys removeAllObjects];
+	
+	requiresReload = NO;
+	hasPendingChanges = NO;
+	
+	if (notification.isEmpty) {
+		return; // e.g. an item was inserted & then removed
+	}
+	
+	// Observers may remove themselves (or others) during delivery.
+	for (ZDCChangeObserver *observer in [observers copy])
+	{
+		observer->block(notification);
+	}
+}
+
+@end
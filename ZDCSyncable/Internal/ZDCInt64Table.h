@@ -0,0 +1,71 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * An open-addressed hash table, mapping int64 keys to NSUInteger values.
+ *
+ * Where it's used:
+ *   The unboxed containers (ZDCInt64Array & ZDCInt64OrderedSet) use it for membership tests,
+ *   and for matching values when calculating a changeset.
+ *   This avoids boxing each value in an NSNumber, and sending `hash` & `isEqual:` for every lookup.
+ *
+ * Notes:
+ *   The table uses linear probing, and is kept at most half full.
+ *   Removal uses backward-shift deletion, so there are no tombstones.
+ *   The value NSUIntegerMax is reserved (it marks an empty slot).
+ */
+typedef struct ZDCInt64Table {
+	
+	int64_t *_Nullable keys;
+	NSUInteger *_Nullable values;
+	
+	NSUInteger capacity; // number of slots (zero, or a power of two)
+	NSUInteger count;    // number of entries
+	
+} ZDCInt64Table;
+
+/**
+ * Initializes the table, with room for (at least) the given number of entries.
+ */
+FOUNDATION_EXPORT void ZDCInt64TableInit(ZDCInt64Table *table, NSUInteger count);
+
+/**
+ * Frees the memory used by the table. (The table can be re-initialized afterwards.)
+ */
+FOUNDATION_EXPORT void ZDCInt64TableFree(ZDCInt64Table *table);
+
+/**
+ * Removes every entry (without releasing the memory).
+ */
+FOUNDATION_EXPORT void ZDCInt64TableRemoveAll(ZDCInt64Table *table);
+
+/**
+ * Returns the value for the given key, or NSNotFound if the key isn't in the table.
+ */
+FOUNDATION_EXPORT NSUInteger ZDCInt64TableGet(const ZDCInt64Table *table, int64_t key);
+
+/**
+ * Adds the key, or updates its value if it's already in the table.
+ */
+FOUNDATION_EXPORT void ZDCInt64TableSet(ZDCInt64Table *table, int64_t key, NSUInteger value);
+
+/**
+ * Removes the key (if it's in the table).
+ */
+FOUNDATION_EXPORT void ZDCInt64TableRemove(ZDCInt64Table *table, int64_t key);
+
+/**
+ * Returns YES if the key is in the table.
+ */
+static inline BOOL ZDCInt64TableContains(const ZDCInt64Table *table, int64_t key)
+{
+	return (ZDCInt64TableGet(table, key) != NSNotFound);
+}
+
+NS_ASSUME_NONNULL_END
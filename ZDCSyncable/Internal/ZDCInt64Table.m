@@ -0,0 +1,168 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCInt64Table.h"
+
+static NSUInteger const kEmptySlot = NSUIntegerMax;
+static NSUInteger const kMinimumCapacity = 8;
+
+static inline NSUInteger ZDCInt64Hash(int64_t key)
+{
+	// Finalizer from MurmurHash3.
+	// Sequential IDs are common, so the bits need to be mixed well before masking.
+	
+	uint64_t x = (uint64_t)key;
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+	
+	return (NSUInteger)x;
+}
+
+static void ZDCInt64TableAllocate(ZDCInt64Table *table, NSUInteger capacity)
+{
+	table->keys = malloc(capacity * sizeof(int64_t));
+	table->values = malloc(capacity * sizeof(NSUInteger));
+	table->capacity = capacity;
+	table->count = 0;
+	
+	memset(table->values, 0xFF, capacity * sizeof(NSUInteger)); // kEmptySlot
+}
+
+void ZDCInt64TableInit(ZDCInt64Table *table, NSUInteger count)
+{
+	NSUInteger capacity = kMinimumCapacity;
+	while (capacity < (count * 2)) {
+		capacity *= 2;
+	}
+	
+	ZDCInt64TableAllocate(table, capacity);
+}
+
+void ZDCInt64TableFree(ZDCInt64Table *table)
+{
+	free(table->keys);
+	free(table->values);
+	
+	table->keys = NULL;
+	table->values = NULL;
+	table->capacity = 0;
+	table->count = 0;
+}
+
+void ZDCInt64TableRemoveAll(ZDCInt64Table *table)
+{
+	if (table->capacity > 0) {
+		memset(table->values, 0xFF, table->capacity * sizeof(NSUInteger)); // kEmptySlot
+	}
+	table->count = 0;
+}
+
+NSUInteger ZDCInt64TableGet(const ZDCInt64Table *table, int64_t key)
+{
+	if (table->count == 0) return NSNotFound;
+	
+	NSUInteger const mask = table->capacity - 1;
+	NSUInteger i = ZDCInt64Hash(key) & mask;
+	
+	while (table->values[i] != kEmptySlot)
+	{
+		if (table->keys[i] == key) {
+			return table->values[i];
+		}
+		i = (i + 1) & mask;
+	}
+	
+	return NSNotFound;
+}
+
+static void ZDCInt64TableGrow(ZDCInt64Table *table)
+{
+	ZDCInt64Table old = *table;
+	ZDCInt64TableAllocate(table, MAX(old.capacity * 2, kMinimumCapacity));
+	
+	for (NSUInteger i = 0; i < old.capacity; i++)
+	{
+		if (old.values[i] != kEmptySlot) {
+			ZDCInt64TableSet(table, old.keys[i], old.values[i]);
+		}
+	}
+	
+	ZDCInt64TableFree(&old);
+}
+
+void ZDCInt64TableSet(ZDCInt64Table *table, int64_t key, NSUInteger value)
+{
+	NSCParameterAssert(value != kEmptySlot);
+	
+	if (((table->count + 1) * 2) > table->capacity) {
+		ZDCInt64TableGrow(table);
+	}
+	
+	NSUInteger const mask = table->capacity - 1;
+	NSUInteger i = ZDCInt64Hash(key) & mask;
+	
+	while (table->values[i] != kEmptySlot)
+	{
+		if (table->keys[i] == key)
+		{
+			table->values[i] = value;
+			return;
+		}
+		i = (i + 1) & mask;
+	}
+	
+	table->keys[i] = key;
+	table->values[i] = value;
+	table->count++;
+}
+
+void ZDCInt64TableRemove(ZDCInt64Table *table, int64_t key)
+{
+	if (table->count == 0) return;
+	
+	NSUInteger const mask = table->capacity - 1;
+	NSUInteger i = ZDCInt64Hash(key) & mask;
+	
+	while (table->values[i] != kEmptySlot)
+	{
+		if (table->keys[i] == key) break;
+		i = (i + 1) & mask;
+	}
+	
+	if (table->values[i] == kEmptySlot) {
+		return; // not found
+	}
+	
+	table->values[i] = kEmptySlot;
+	table->count--;
+	
+	// Backward-shift deletion:
+	//
+	// Any entry in the following cluster, whose home slot isn't (cyclically) within (i, j],
+	// was displaced past the slot we just emptied. So it needs to be shifted back into the hole.
+	
+	NSUInteger j = i;
+	for (;;)
+	{
+		j = (j + 1) & mask;
+		if (table->values[j] == kEmptySlot) break;
+		
+		NSUInteger const home = ZDCInt64Hash(table->keys[j]) & mask;
+		
+		BOOL const inRange = (i <= j) ? ((i < home) && (home <= j))
+		                              : ((i < home) || (home <= j));
+		if (!inRange)
+		{
+			table->keys[i] = table->keys[j];
+			table->values[i] = table->values[j];
+			table->values[j] = kEmptySlot;
+			
+			i = j;
+		}
+	}
+}
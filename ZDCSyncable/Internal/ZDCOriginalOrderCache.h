@@ -0,0 +1,67 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Replays the given changesets (in reverse) against the given order, and returns the order prior to the changesets.
+ * Returns nil if the changesets don't match the order (mismatched changeset).
+ *
+ * If `events` is non-nil, the replay may append container-specific bookkeeping to it,
+ * in the order the changesets were processed (i.e. newest changeset first).
+ */
+typedef NSArray<id> *_Nullable (^ZDCOriginalOrderReplay)(NSArray<id> *order,
+                                                         NSArray<NSDictionary*> *changesets,
+                                                         NSMutableArray *_Nullable events);
+
+/**
+ * ZDCOriginalOrderCache is used by the ordered containers (ZDCArray, ZDCOrderedSet & ZDCOrderedDictionary).
+ *
+ * Where it's used:
+ *   During `mergeCloudVersion:withPendingChangesets:error:`, the container first calculates its original order.
+ *   That is, the order prior to all the pending changesets.
+ *   This requires replaying every pending changeset in reverse, which is expensive.
+ *
+ *   However, merges tend to be repeated with the same list of pending changesets,
+ *   or with the same list plus a few newer changesets (such as the changeset returned from the previous merge).
+ *   In both cases the result of the previous calculation can be reused.
+ *
+ * How it works:
+ *   The cache remembers the pending changesets (by pointer), the order they were replayed from, and the result.
+ *
+ *   If the given pending changesets start with the cached changesets,
+ *   then only the newer changesets are replayed. If that brings us back to the cached order,
+ *   the cached result is still valid, and we're done. Otherwise the full calculation is performed.
+ *
+ *   Note that the cache is validated by comparing the order, rather than by tracking a mutation counter.
+ *   So the cache can never be stale, regardless of how the container was modified in-between merges.
+ *
+ * Notes:
+ *   Changesets are treated as immutable values. (Don't mutate a changeset after handing it to a merge.)
+ */
+@interface ZDCOriginalOrderCache : NSObject
+
+/**
+ * Returns the original order, using the cache when possible.
+ * Returns nil if the changesets don't match the order (in which case the cache is cleared).
+ *
+ * If `outEvents` is non-nil, on success it's set to the bookkeeping recorded by the replay block
+ * for the full list of pending changesets.
+ */
+- (nullable NSArray<id> *)originalOrderFrom:(NSArray<id> *)order
+                          pendingChangesets:(NSArray<NSDictionary*> *)pendingChangesets
+                                     events:(NSArray *_Nullable *_Nullable)outEvents
+                                     replay:(ZDCOriginalOrderReplay)replay;
+
+/**
+ * Drops the cached result.
+ */
+- (void)removeAll;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,107 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCOriginalOrderCache.h"
+
+@implementation ZDCOriginalOrderCache {
+	
+	NSArray<NSDictionary*> *changesets; // the pending changesets (compared by pointer)
+	NSArray<id> *currentOrder;          // the order the changesets were replayed from
+	NSArray<id> *originalOrder;         // the result
+	NSArray *events;                    // bookkeeping from the replay (newest changeset first)
+}
+
+- (void)removeAll
+{
+	changesets = nil;
+	currentOrder = nil;
+	originalOrder = nil;
+	events = nil;
+}
+
+/**
+ * Returns YES if the given list starts with the cached changesets (compared by pointer).
+ */
+- (BOOL)isExtensionOf:(NSArray<NSDictionary*> *)pendingChangesets
+{
+	if (changesets == nil) return NO;
+	
+	NSUInteger const count = changesets.count;
+	if (pendingChangesets.count < count) return NO;
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		if (changesets[i] != pendingChangesets[i]) {
+			return NO;
+		}
+	}
+	
+	return YES;
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable NSArray<id> *)originalOrderFrom:(NSArray<id> *)order
+                          pendingChangesets:(NSArray<NSDictionary*> *)pendingChangesets
+                                     events:(NSArray *_Nullable *_Nullable)outEvents
+                                     replay:(ZDCOriginalOrderReplay)replay
+{
+	// Snapshot the inputs.
+	// The order may be a live view of a mutable collection.
+	
+	NSArray<id> *orderCopy = [order copy];
+	NSArray<NSDictionary*> *pendingCopy = [pendingChangesets copy];
+	
+	if ([self isExtensionOf:pendingCopy])
+	{
+		NSUInteger const cachedCount = changesets.count;
+		NSArray<NSDictionary*> *newer =
+		  [pendingCopy subarrayWithRange:NSMakeRange(cachedCount, pendingCopy.count - cachedCount)];
+		
+		NSArray<id> *intermediateOrder = orderCopy;
+		NSMutableArray *newerEvents = outEvents ? [NSMutableArray array] : nil;
+		
+		if (newer.count > 0) {
+			intermediateOrder = replay(orderCopy, newer, newerEvents);
+		}
+		
+		if (intermediateOrder && [intermediateOrder isEqualToArray:currentOrder])
+		{
+			// Replaying the newer changesets brought us back to the cached order.
+			// So the cached result still applies.
+			
+			if (newerEvents.count > 0) {
+				[newerEvents addObjectsFromArray:events];
+				events = [newerEvents copy];
+			}
+			
+			changesets = pendingCopy;
+			currentOrder = orderCopy;
+			
+			if (outEvents) *outEvents = events;
+			return originalOrder;
+		}
+	}
+	
+	NSMutableArray *allEvents = [NSMutableArray array];
+	NSArray<id> *result = replay(orderCopy, pendingCopy, allEvents);
+	
+	if (result == nil)
+	{
+		[self removeAll];
+		return nil;
+	}
+	
+	changesets = pendingCopy;
+	currentOrder = orderCopy;
+	originalOrder = [result copy];
+	events = [allEvents copy];
+	
+	if (outEvents) *outEvents = events;
+	return originalOrder;
+}
+
+@end
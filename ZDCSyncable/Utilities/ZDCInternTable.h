@@ -0,0 +1,88 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Uniques keys, such that equal keys share a single (immutable) instance.
+ *
+ * Ordered containers (ZDCOrderedDictionary & ZDCOrderedSet) spend much of their time scanning arrays of keys.
+ * For example, when calculating original indexes, or when merging the order of a cloud version.
+ * Every comparison within such a scan is a message to `isEqual:`,
+ * which for string keys means a full string comparison.
+ *
+ * When a container opts into key interning, every key entering the container is first uniqued via this table.
+ * The container can then compare keys by pointer, and only fall back to `isEqual:` when that fails.
+ *
+ * @note Interned keys are retained for the lifetime of the table.
+ *       So interning is intended for a bounded vocabulary of keys, such as identifiers or property names.
+ */
+NS_SWIFT_NAME(ZDCInternTable_ObjC)
+@interface ZDCInternTable : NSObject
+
+/**
+ * The table used by the containers.
+ */
++ (ZDCInternTable *)sharedTable;
+
+/**
+ * Returns the unique instance that's equal to the given key.
+ * If there isn't one yet, an immutable copy of the key is added to the table, and returned.
+ *
+ * This method is thread-safe.
+ */
+- (id)internKey:(id)key;
+
+/**
+ * Interns every key within the given array (taking the lock only once).
+ */
+- (NSArray<id> *)internKeys:(NSArray<id> *)keys;
+
+/**
+ * The number of unique keys within the table.
+ */
+@property (atomic, readonly) NSUInteger count;
+
+@end
+
+/**
+ * Compares keys by pointer first, falling back to `isEqual:`.
+ */
+static inline BOOL ZDCKeysEqual(id key1, id key2)
+{
+	return (key1 == key2) || [key1 isEqual:key2];
+}
+
+/**
+ * Searches the array (within the given range) for a key, comparing by pointer only.
+ *
+ * Use this when both the key & the array contain interned keys.
+ * Then a failed scan already means the key isn't within the array, so there's no need to fall back to `isEqual:`.
+ */
+FOUNDATION_EXPORT NSUInteger ZDCIndexOfInternedKeyInRange(NSArray<id> *array, id key, NSRange range);
+
+/**
+ * Searches the array (within the given range) for a key.
+ *
+ * If `identityFirst` is YES, the array is first scanned by pointer (which is very fast),
+ * and only if that fails is it scanned again via `isEqual:`.
+ * This is the optimal strategy when the array contains interned keys, but the key might not be interned,
+ * since the first scan will then succeed whenever it is (assuming the key is in the array).
+ *
+ * If `identityFirst` is NO, this is equivalent to `[array indexOfObject:key inRange:range]`.
+ */
+FOUNDATION_EXPORT NSUInteger ZDCIndexOfKeyInRange(NSArray<id> *array, id key, NSRange range, BOOL identityFirst);
+
+/**
+ * Equivalent to ZDCIndexOfKeyInRange, with the range covering the whole array.
+ */
+static inline NSUInteger ZDCIndexOfKey(NSArray<id> *array, id key, BOOL identityFirst)
+{
+	return ZDCIndexOfKeyInRange(array, key, NSMakeRange(0, array.count), identityFirst);
+}
+
+NS_ASSUME_NONNULL_END
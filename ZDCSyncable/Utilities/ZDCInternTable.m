@@ -0,0 +1,138 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCInternTable.h"
+
+#import <pthread.h>
+
+@implementation ZDCInternTable {
+	
+	pthread_mutex_t mutex;
+	NSMutableSet<id> *keys;
+}
+
++ (ZDCInternTable *)sharedTable
+{
+	static ZDCInternTable *sharedTable = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedTable = [[ZDCInternTable alloc] init];
+	});
+	
+	return sharedTable;
+}
+
+- (instancetype)init
+{
+	if ((self = [super init]))
+	{
+		pthread_mutex_init(&mutex, NULL);
+		keys = [[NSMutableSet alloc] init];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	pthread_mutex_destroy(&mutex);
+}
+
+/**
+ * Must be invoked while holding the mutex.
+ */
+- (id)_internKey:(id)key
+{
+	id existing = [keys member:key];
+	if (existing == nil)
+	{
+		// [key copy] => mutable string protection
+		existing = [key conformsToProtocol:@protocol(NSCopying)] ? [key copy] : key;
+		[keys addObject:existing];
+	}
+	
+	return existing;
+}
+
+/**
+ * See header file for description.
+ */
+- (id)internKey:(id)key
+{
+	NSParameterAssert(key != nil);
+	
+	pthread_mutex_lock(&mutex);
+	id result = [self _internKey:key];
+	pthread_mutex_unlock(&mutex);
+	
+	return result;
+}
+
+/**
+ * See header file for description.
+ */
+- (NSArray<id> *)internKeys:(NSArray<id> *)inKeys
+{
+	NSMutableArray<id> *result = [NSMutableArray arrayWithCapacity:inKeys.count];
+	
+	pthread_mutex_lock(&mutex);
+	for (id key in inKeys)
+	{
+		[result addObject:[self _internKey:key]];
+	}
+	pthread_mutex_unlock(&mutex);
+	
+	return result;
+}
+
+- (NSUInteger)count
+{
+	pthread_mutex_lock(&mutex);
+	NSUInteger const count = keys.count;
+	pthread_mutex_unlock(&mutex);
+	
+	return count;
+}
+
+@end
+
+NSUInteger ZDCIndexOfInternedKeyInRange(NSArray<id> *array, id key, NSRange range)
+{
+	// Scan the array in batches, comparing pointers only.
+	
+	__unsafe_unretained id batch[64];
+	
+	NSUInteger offset = range.location;
+	NSUInteger const end = NSMaxRange(range);
+	
+	while (offset < end)
+	{
+		NSUInteger const batchCount = MIN((NSUInteger)64, end - offset);
+		[array getObjects:batch range:NSMakeRange(offset, batchCount)];
+		
+		for (NSUInteger i = 0; i < batchCount; i++)
+		{
+			if (batch[i] == key) {
+				return offset + i;
+			}
+		}
+		
+		offset += batchCount;
+	}
+	
+	return NSNotFound;
+}
+
+NSUInteger ZDCIndexOfKeyInRange(NSArray<id> *array, id key, NSRange range, BOOL identityFirst)
+{
+	if (identityFirst)
+	{
+		NSUInteger const idx = ZDCIndexOfInternedKeyInRange(array, key, range);
+		if (idx != NSNotFound) {
+			return idx;
+		}
+	}
+	
+	return [array indexOfObject:key inRange:range];
+}
@@ -0,0 +1,135 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Error codes (within the "ZDCJSONSerialization" error domain).
+ */
+typedef NS_ENUM(NSInteger, ZDCJSONSerializationError) {
+	/** The object graph contains a value that can't be encoded (e.g. an arbitrary class, or NaN). */
+	ZDCJSONSerializationError_UnsupportedValue = 1000,
+	/** Writing to the output stream failed. */
+	ZDCJSONSerializationError_StreamFailure    = 1001,
+	/** The input isn't valid JSON, or contains an unknown/invalid tagged value. */
+	ZDCJSONSerializationError_MalformedJSON    = 1002,
+	/** The input is valid JSON, but doesn't describe a changeset. */
+	ZDCJSONSerializationError_NotAChangeset    = 1003,
+};
+
+/**
+ * Encodes changesets (and container contents) as JSON, and decodes them again.
+ *
+ * NSJSONSerialization can't be used for changesets directly, because they contain values that JSON doesn't have:
+ * NSIndexSet, NSSet, dictionaries with non-string keys (e.g. `{ idx: obj }`), and the ZDCNull & ZDCRef sentinels.
+ * This class supports these types natively. The encoder writes straight into an output buffer (or stream),
+ * and the decoder builds the final objects in a single pass over the input.
+ * Neither creates an intermediate (JSON compatible) object graph.
+ *
+ * The following types are supported:
+ * - NSString, NSNumber (including booleans), NSNull, NSArray, NSDictionary
+ * - NSSet, NSIndexSet, NSData, NSDate
+ * - ZDCNull & ZDCRef (as found within changesets)
+ * - ZDCDictionary, ZDCOrderedDictionary, ZDCArray, ZDCSet, ZDCOrderedSet, ZDCInt64Array, ZDCInt64OrderedSet
+ *   & ZDCConcurrentDictionary (the contents are encoded, not the change tracking info)
+ * - Classes registered via `registerClass:name:encoder:decoder:` or `registerRecordClass:name:`
+ *
+ * Types that JSON doesn't have are encoded as an object with a single, reserved key. For example:
+ * ```
+ * NSIndexSet           => {"$indexes":[[location,length],...]}
+ * {@(0): @"a"}         => {"$map":[0,"a"]}
+ * [ZDCNull null]       => {"$null":true}
+ * ZDCArray [@"a",@"b"] => {"$ZDCArray":["a","b"]}
+ * ```
+ * Dictionaries are only encoded as plain JSON objects if every key is a string that doesn't start with '$'.
+ * Others use the "$map" form, so the output is always unambiguous.
+ *
+ * @note Classes are matched exactly. Subclasses of the ZDC containers (and ZDCRecord subclasses)
+ *       must be registered, since the decoder has no other way to re-create them.
+ */
+NS_SWIFT_NAME(ZDCJSONSerialization_ObjC)
+@interface ZDCJSONSerialization : NSObject
+
+#pragma mark Registration
+
+/**
+ * Registers a custom class, so instances can be encoded & decoded.
+ *
+ * Instances are encoded as `{"$class":["name",raw]}`, where raw is the value returned by the encoder
+ * (which must itself be encodable, e.g. a dictionary of property values).
+ * When decoding, the raw value is passed to the decoder, which returns the re-created instance.
+ * If either block returns nil, the encode/decode fails.
+ *
+ * The name is what's written into the JSON, so it must remain stable across app versions & platforms.
+ * Registering a class (or name) again replaces the previous registration.
+ * Only instances of the exact class are matched (not subclasses).
+ *
+ * Registrations are global, and may be made from any thread.
+ * They must be made before any JSON containing the class is decoded.
+ */
++ (void)registerClass:(Class)cls
+                 name:(NSString *)name
+              encoder:(id _Nullable (^)(id object))encoder
+              decoder:(id _Nullable (^)(id raw))decoder;
+
+/**
+ * Registers a ZDCRecord subclass, using a default encoder & decoder.
+ *
+ * The record is encoded as a dictionary of its (non-nil) monitoredProperties.
+ * It's decoded via `init`, followed by setting each property (via KVC) within `performWithoutChangeTracking:`.
+ * So the decoded record has no pending changes.
+ * Input containing a key that isn't a monitored property is rejected.
+ *
+ * Use `registerClass:name:encoder:decoder:` if the record requires something different.
+ */
++ (void)registerRecordClass:(Class)cls name:(NSString *)name;
+
+#pragma mark Encoding
+
+/**
+ * Encodes the given object graph (e.g. a changeset) as UTF-8 JSON.
+ *
+ * @return The encoded data, or nil if the graph contains an unsupported value.
+ */
++ (nullable NSData *)dataWithObject:(id)object error:(NSError *_Nullable *_Nullable)errPtr;
+
+/**
+ * Encodes the given object graph (e.g. a changeset) as UTF-8 JSON, and writes it to the stream.
+ *
+ * The output is written in chunks as it's generated, so the full encoding is never held in memory.
+ * The stream must already be open. It's not closed by this method.
+ *
+ * @return
+ *   YES on success. If NO is returned, the stream may contain a partial encoding.
+ */
++ (BOOL)writeObject:(id)object toStream:(NSOutputStream *)stream error:(NSError *_Nullable *_Nullable)errPtr;
+
+#pragma mark Decoding
+
+/**
+ * Decodes JSON that was written by this class (or any valid JSON).
+ *
+ * Decoded containers (e.g. ZDCArray) are returned without any pending changes.
+ *
+ * @return The decoded object graph, or nil if the data isn't valid.
+ */
++ (nullable id)objectWithData:(NSData *)data error:(NSError *_Nullable *_Nullable)errPtr;
+
+/**
+ * Decodes a changeset, and validates its structure.
+ *
+ * That is, the result is a dictionary whose keys are known changeset keys ("refs", "values", "added", etc),
+ * whose values have the expected types (e.g. "moved" is a dictionary), and whose "refs" are valid changesets.
+ * The individual items are validated by the container when the changeset is applied (e.g. via `undo:error:`).
+ *
+ * @return The decoded changeset, or nil if the data isn't a valid changeset.
+ */
++ (nullable NSDictionary *)changesetWithData:(NSData *)data error:(NSError *_Nullable *_Nullable)errPtr;
+
+@end
+
+NS_ASSUME_NONNULL_END
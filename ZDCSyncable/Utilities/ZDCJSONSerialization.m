@@ -0,0 +1,1635 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCJSONSerialization.h"
+
+#import "ZDCArray.h"
+#import "ZDCConcurrentDictionary.h"
+#import "ZDCDictionary.h"
+#import "ZDCInt64Array.h"
+#import "ZDCInt64OrderedSet.h"
+#import "ZDCNull.h"
+#import "ZDCOrderedDictionary.h"
+#import "ZDCOrderedSet.h"
+#import "ZDCRef.h"
+#import "ZDCRecord.h"
+#import "ZDCSet.h"
+#import "ZDCObjectSubclass.h"
+
+#import <errno.h>
+#import <math.h>
+#import <pthread.h>
+
+static NSString *const kErrorDomain = @"ZDCJSONSerialization";
+
+static NSString *const kChangeset_refs    = @"refs";
+static NSString *const kChangeset_values  = @"values";
+static NSString *const kChangeset_added   = @"added";
+static NSString *const kChangeset_deleted = @"deleted";
+static NSString *const kChangeset_moved   = @"moved";
+static NSString *const kChangeset_indexes = @"indexes";
+
+/**
+ * Guards against stack exhaustion (e.g. hostile input, or a container that contains itself).
+ */
+static NSUInteger const kMaxDepth = 512;
+
+/**
+ * When writing to a stream, the buffer is flushed whenever it reaches this size.
+ */
+static NSUInteger const kStreamChunkSize = 64 * 1024;
+
+static NSError *ZDCJSONError(NSInteger code, NSString *description)
+{
+	return [NSError errorWithDomain:kErrorDomain code:code userInfo:@{ NSLocalizedDescriptionKey: description }];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Registration
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef id _Nullable (^ZDCJSONEncoderBlock)(id object);
+typedef id _Nullable (^ZDCJSONDecoderBlock)(id raw);
+
+@interface ZDCJSONRegistration : NSObject {
+@public
+	
+	Class cls;
+	NSString *name;
+	ZDCJSONEncoderBlock encoder;
+	ZDCJSONDecoderBlock decoder;
+}
+@end
+
+@implementation ZDCJSONRegistration
+@end
+
+static pthread_mutex_t registrationLock = PTHREAD_MUTEX_INITIALIZER;
+static NSMapTable<Class, ZDCJSONRegistration *> *registrationsByClass = nil;
+static NSMutableDictionary<NSString *, ZDCJSONRegistration *> *registrationsByName = nil;
+
+static ZDCJSONRegistration *ZDCJSONRegistrationForClass(Class cls)
+{
+	pthread_mutex_lock(&registrationLock);
+	ZDCJSONRegistration *registration = [registrationsByClass objectForKey:cls];
+	pthread_mutex_unlock(&registrationLock);
+	
+	return registration;
+}
+
+static ZDCJSONRegistration *ZDCJSONRegistrationForName(NSString *name)
+{
+	pthread_mutex_lock(&registrationLock);
+	ZDCJSONRegistration *registration = registrationsByName[name];
+	pthread_mutex_unlock(&registrationLock);
+	
+	return registration;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Writer
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface ZDCJSONWriter : NSObject {
+@public
+	
+	uint8_t *buffer;
+	NSUInteger length;
+	NSUInteger capacity;
+	
+	NSOutputStream *stream; // nil if writing to memory
+	NSUInteger depth;
+	NSError *error;         // sticky: once set, all writes are ignored
+}
+@end
+
+@implementation ZDCJSONWriter
+
+- (void)dealloc
+{
+	free(buffer);
+}
+
+@end
+
+static void ZDCJSONWriterFail(ZDCJSONWriter *w, NSInteger code, NSString *description)
+{
+	if (w->error == nil) {
+		w->error = ZDCJSONError(code, description);
+	}
+}
+
+static BOOL ZDCJSONWriterDrain(ZDCJSONWriter *w)
+{
+	NSUInteger offset = 0;
+	while (offset < w->length)
+	{
+		NSInteger written = [w->stream write:(w->buffer + offset) maxLength:(w->length - offset)];
+		if (written <= 0)
+		{
+			NSString *description = w->stream.streamError.localizedDescription ?: @"Unable to write to stream";
+			ZDCJSONWriterFail(w, ZDCJSONSerializationError_StreamFailure, description);
+			return NO;
+		}
+		
+		offset += (NSUInteger)written;
+	}
+	
+	w->length = 0;
+	return YES;
+}
+
+static inline BOOL ZDCJSONWriterReserve(ZDCJSONWriter *w, NSUInteger extra)
+{
+	if (w->error) return NO;
+	if (w->length + extra <= w->capacity) return YES;
+	
+	if (w->stream)
+	{
+		if (!ZDCJSONWriterDrain(w)) return NO;
+		if (extra <= w->capacity) return YES;
+	}
+	
+	NSUInteger newCapacity = MAX(w->capacity * 2, w->length + extra);
+	w->buffer = reallocf(w->buffer, newCapacity);
+	w->capacity = newCapacity;
+	
+	return YES;
+}
+
+static inline void ZDCJSONWriteBytes(ZDCJSONWriter *w, const void *bytes, NSUInteger len)
+{
+	if (!ZDCJSONWriterReserve(w, len)) return;
+	
+	memcpy(w->buffer + w->length, bytes, len);
+	w->length += len;
+}
+
+static inline void ZDCJSONWriteByte(ZDCJSONWriter *w, uint8_t byte)
+{
+	if (!ZDCJSONWriterReserve(w, 1)) return;
+	
+	w->buffer[w->length++] = byte;
+}
+
+#define ZDCJSONWriteLiteral(w, str) ZDCJSONWriteBytes(w, str, sizeof(str) - 1)
+
+/**
+ * Writes UTF-8 string contents, escaping as required by JSON.
+ * Runs of characters that don't require escaping are copied in bulk.
+ */
+static void ZDCJSONWriteEscapedUTF8(ZDCJSONWriter *w, const uint8_t *bytes, NSUInteger len)
+{
+	NSUInteger runStart = 0;
+	for (NSUInteger i = 0; i < len; i++)
+	{
+		uint8_t const c = bytes[i];
+		if (c >= 0x20 && c != '"' && c != '\\') continue;
+		
+		ZDCJSONWriteBytes(w, bytes + runStart, i - runStart);
+		runStart = i + 1;
+		
+		switch (c)
+		{
+			case '"'  : ZDCJSONWriteLiteral(w, "\\\""); break;
+			case '\\' : ZDCJSONWriteLiteral(w, "\\\\"); break;
+			case '\n' : ZDCJSONWriteLiteral(w, "\\n");  break;
+			case '\r' : ZDCJSONWriteLiteral(w, "\\r");  break;
+			case '\t' : ZDCJSONWriteLiteral(w, "\\t");  break;
+			default:
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)c);
+				ZDCJSONWriteBytes(w, escaped, 6);
+			}
+		}
+	}
+	
+	ZDCJSONWriteBytes(w, bytes + runStart, len - runStart);
+}
+
+static void ZDCJSONWriteString(ZDCJSONWriter *w, NSString *string)
+{
+	CFStringRef str = (__bridge CFStringRef)string;
+	CFIndex const length = CFStringGetLength(str);
+	
+	ZDCJSONWriteByte(w, '"');
+	
+	// Fast path: the string is stored as ASCII, so we can escape it in place.
+	// (The length check excludes non-ASCII UTF-8, and embedded NULs.)
+	
+	const char *cstr = CFStringGetCStringPtr(str, kCFStringEncodingUTF8);
+	if (cstr && (strlen(cstr) == (size_t)length))
+	{
+		ZDCJSONWriteEscapedUTF8(w, (const uint8_t *)cstr, (NSUInteger)length);
+	}
+	else
+	{
+		UInt8 chunk[1024];
+		CFIndex offset = 0;
+		
+		while (offset < length)
+		{
+			CFIndex used = 0;
+			CFIndex converted =
+			  CFStringGetBytes(str, CFRangeMake(offset, length - offset),
+			                   kCFStringEncodingUTF8, 0, false, chunk, sizeof(chunk), &used);
+			
+			if (converted == 0)
+			{
+				ZDCJSONWriterFail(w, ZDCJSONSerializationError_UnsupportedValue,
+				  @"String can't be encoded as UTF-8 (e.g. it contains an unpaired surrogate)");
+				return;
+			}
+			
+			ZDCJSONWriteEscapedUTF8(w, chunk, (NSUInteger)used);
+			offset += converted;
+		}
+	}
+	
+	ZDCJSONWriteByte(w, '"');
+}
+
+static void ZDCJSONWriteInt64(ZDCJSONWriter *w, int64_t value)
+{
+	char buf[32];
+	int len = snprintf(buf, sizeof(buf), "%lld", (long long)value);
+	ZDCJSONWriteBytes(w, buf, (NSUInteger)len);
+}
+
+static void ZDCJSONWriteDouble(ZDCJSONWriter *w, double value)
+{
+	if (!isfinite(value))
+	{
+		ZDCJSONWriterFail(w, ZDCJSONSerializationError_UnsupportedValue, @"JSON can't represent NaN or infinity");
+		return;
+	}
+	
+	// 17 significant digits are enough to round-trip any double
+	char buf[32];
+	int len = snprintf(buf, sizeof(buf), "%.17g", value);
+	ZDCJSONWriteBytes(w, buf, (NSUInteger)len);
+}
+
+static void ZDCJSONWriteNumber(ZDCJSONWriter *w, NSNumber *number)
+{
+	// Booleans are singletons
+	if (number == (__bridge NSNumber *)kCFBooleanTrue)
+	{
+		ZDCJSONWriteLiteral(w, "true");
+		return;
+	}
+	if (number == (__bridge NSNumber *)kCFBooleanFalse)
+	{
+		ZDCJSONWriteLiteral(w, "false");
+		return;
+	}
+	
+	char const type = *number.objCType;
+	
+	if (type == 'f' || type == 'd')
+	{
+		ZDCJSONWriteDouble(w, number.doubleValue);
+	}
+	else if (type == 'Q')
+	{
+		char buf[32];
+		int len = snprintf(buf, sizeof(buf), "%llu", number.unsignedLongLongValue);
+		ZDCJSONWriteBytes(w, buf, (NSUInteger)len);
+	}
+	else
+	{
+		ZDCJSONWriteInt64(w, number.longLongValue);
+	}
+}
+
+static void ZDCJSONWriteValue(ZDCJSONWriter *w, id value);
+
+/**
+ * Returns YES if the dictionary can be written as a plain JSON object.
+ */
+static BOOL ZDCJSONHasPlainKeys(id<NSFastEnumeration> keys)
+{
+	for (id key in keys)
+	{
+		if (![key isKindOfClass:[NSString class]]) return NO;
+		
+		NSString *str = (NSString *)key;
+		if ((str.length > 0) && ([str characterAtIndex:0] == '$')) return NO;
+	}
+	
+	return YES;
+}
+
+/**
+ * Writes the contents of either an NSDictionary or a ZDCDictionary.
+ */
+static void ZDCJSONWriteKeyedContents(ZDCJSONWriter *w, id container)
+{
+	BOOL first = YES;
+	
+	if (ZDCJSONHasPlainKeys(container))
+	{
+		// {"key":value,...}
+		
+		ZDCJSONWriteByte(w, '{');
+		for (NSString *key in container)
+		{
+			if (!first) ZDCJSONWriteByte(w, ',');
+			first = NO;
+			
+			ZDCJSONWriteString(w, key);
+			ZDCJSONWriteByte(w, ':');
+			ZDCJSONWriteValue(w, [container objectForKey:key]);
+			
+			if (w->error) return;
+		}
+		ZDCJSONWriteByte(w, '}');
+	}
+	else
+	{
+		// {"$map":[key,value,...]}
+		
+		ZDCJSONWriteLiteral(w, "{\"$map\":[");
+		for (id key in container)
+		{
+			if (!first) ZDCJSONWriteByte(w, ',');
+			first = NO;
+			
+			ZDCJSONWriteValue(w, key);
+			ZDCJSONWriteByte(w, ',');
+			ZDCJSONWriteValue(w, [container objectForKey:key]);
+			
+			if (w->error) return;
+		}
+		ZDCJSONWriteLiteral(w, "]}");
+	}
+}
+
+/**
+ * Writes the items of any collection that supports fast enumeration (as a JSON array).
+ */
+static void ZDCJSONWriteItems(ZDCJSONWriter *w, id<NSFastEnumeration> collection)
+{
+	BOOL first = YES;
+	
+	ZDCJSONWriteByte(w, '[');
+	for (id item in collection)
+	{
+		if (!first) ZDCJSONWriteByte(w, ',');
+		first = NO;
+		
+		ZDCJSONWriteValue(w, item);
+		if (w->error) return;
+	}
+	ZDCJSONWriteByte(w, ']');
+}
+
+static void ZDCJSONWriteIndexSet(ZDCJSONWriter *w, NSIndexSet *indexSet)
+{
+	// {"$indexes":[[location,length],...]}
+	
+	__block BOOL first = YES;
+	
+	ZDCJSONWriteLiteral(w, "{\"$indexes\":[");
+	[indexSet enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+		
+		if (!first) ZDCJSONWriteByte(w, ',');
+		first = NO;
+		
+		ZDCJSONWriteByte(w, '[');
+		ZDCJSONWriteInt64(w, (int64_t)range.location);
+		ZDCJSONWriteByte(w, ',');
+		ZDCJSONWriteInt64(w, (int64_t)range.length);
+		ZDCJSONWriteByte(w, ']');
+	}];
+	ZDCJSONWriteLiteral(w, "]}");
+}
+
+static void ZDCJSONWriteInt64Values(ZDCJSONWriter *w, id container)
+{
+	// Both ZDCInt64Array & ZDCInt64OrderedSet support this method
+	
+	__block BOOL first = YES;
+	
+	ZDCJSONWriteByte(w, '[');
+	[container enumerateValuesUsingBlock:^(int64_t value, NSUInteger idx, BOOL *stop) {
+		
+		if (!first) ZDCJSONWriteByte(w, ',');
+		first = NO;
+		
+		ZDCJSONWriteInt64(w, value);
+	}];
+	ZDCJSONWriteByte(w, ']');
+}
+
+static void ZDCJSONWriteValue(ZDCJSONWriter *w, id value)
+{
+	if (w->error) return;
+	if (w->depth >= kMaxDepth)
+	{
+		ZDCJSONWriterFail(w, ZDCJSONSerializationError_UnsupportedValue,
+		  @"Object graph is too deep (or contains a cycle)");
+		return;
+	}
+	w->depth++;
+	
+	// Ordered by how common each type is within a changeset
+	
+	if ([value isKindOfClass:[NSString class]])
+	{
+		ZDCJSONWriteString(w, (NSString *)value);
+	}
+	else if ([value isKindOfClass:[NSNumber class]])
+	{
+		ZDCJSONWriteNumber(w, (NSNumber *)value);
+	}
+	else if ([value isKindOfClass:[NSDictionary class]])
+	{
+		ZDCJSONWriteKeyedContents(w, value);
+	}
+	else if ([value isKindOfClass:[NSArray class]])
+	{
+		ZDCJSONWriteItems(w, (NSArray *)value);
+	}
+	else if ([value isKindOfClass:[NSIndexSet class]])
+	{
+		ZDCJSONWriteIndexSet(w, (NSIndexSet *)value);
+	}
+	else if ([value isKindOfClass:[NSSet class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$set\":");
+		ZDCJSONWriteItems(w, (NSSet *)value);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else if ([value isKindOfClass:[ZDCNull class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$null\":true}");
+	}
+	else if ([value isKindOfClass:[ZDCRef class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$ref\":true}");
+	}
+	else if ([value isKindOfClass:[NSNull class]])
+	{
+		ZDCJSONWriteLiteral(w, "null");
+	}
+	else if ([value isKindOfClass:[NSData class]])
+	{
+		// Base64 never requires escaping
+		NSData *base64 = [(NSData *)value base64EncodedDataWithOptions:0];
+		
+		ZDCJSONWriteLiteral(w, "{\"$data\":\"");
+		ZDCJSONWriteBytes(w, base64.bytes, base64.length);
+		ZDCJSONWriteLiteral(w, "\"}");
+	}
+	else if ([value isKindOfClass:[NSDate class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$date\":");
+		ZDCJSONWriteDouble(w, [(NSDate *)value timeIntervalSinceReferenceDate]);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else if ([value isMemberOfClass:[ZDCDictionary class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$ZDCDictionary\":");
+		ZDCJSONWriteKeyedContents(w, value);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else if ([value isMemberOfClass:[ZDCOrderedDictionary class]])
+	{
+		// {"$ZDCOrderedDictionary":[key,value,...]}
+		
+		__block BOOL first = YES;
+		
+		ZDCJSONWriteLiteral(w, "{\"$ZDCOrderedDictionary\":[");
+		[(ZDCOrderedDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id obj, NSUInteger idx, BOOL *stop) {
+			
+			if (!first) ZDCJSONWriteByte(w, ',');
+			first = NO;
+			
+			ZDCJSONWriteValue(w, key);
+			ZDCJSONWriteByte(w, ',');
+			ZDCJSONWriteValue(w, obj);
+			
+			if (w->error) *stop = YES;
+		}];
+		ZDCJSONWriteLiteral(w, "]}");
+	}
+	else if ([value isMemberOfClass:[ZDCArray class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$ZDCArray\":");
+		ZDCJSONWriteItems(w, (ZDCArray *)value);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else if ([value isMemberOfClass:[ZDCSet class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$ZDCSet\":");
+		ZDCJSONWriteItems(w, (ZDCSet *)value);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else if ([value isMemberOfClass:[ZDCOrderedSet class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$ZDCOrderedSet\":");
+		ZDCJSONWriteItems(w, (ZDCOrderedSet *)value);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else if ([value isMemberOfClass:[ZDCInt64Array class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$ZDCInt64Array\":");
+		ZDCJSONWriteInt64Values(w, value);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else if ([value isMemberOfClass:[ZDCInt64OrderedSet class]])
+	{
+		ZDCJSONWriteLiteral(w, "{\"$ZDCInt64OrderedSet\":");
+		ZDCJSONWriteInt64Values(w, value);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else if ([value isMemberOfClass:[ZDCConcurrentDictionary class]])
+	{
+		// Written from a consistent snapshot, since other threads may be modifying the dictionary.
+		
+		ZDCJSONWriteLiteral(w, "{\"$ZDCConcurrentDictionary\":");
+		ZDCJSONWriteKeyedContents(w, [(ZDCConcurrentDictionary *)value rawDictionary]);
+		ZDCJSONWriteByte(w, '}');
+	}
+	else
+	{
+		ZDCJSONRegistration *registration = ZDCJSONRegistrationForClass([value class]);
+		id raw = registration ? registration->encoder(value) : nil;
+		
+		if (raw)
+		{
+			// {"$class":["name",raw]}
+			
+			ZDCJSONWriteLiteral(w, "{\"$class\":[");
+			ZDCJSONWriteString(w, registration->name);
+			ZDCJSONWriteByte(w, ',');
+			ZDCJSONWriteValue(w, raw);
+			ZDCJSONWriteLiteral(w, "]}");
+		}
+		else
+		{
+			NSString *description = registration
+			  ? [NSString stringWithFormat:@"Encoder for class %@ returned nil", NSStringFromClass([value class])]
+			  : [NSString stringWithFormat:@"Unsupported value of class %@", NSStringFromClass([value class])];
+			ZDCJSONWriterFail(w, ZDCJSONSerializationError_UnsupportedValue, description);
+		}
+	}
+	
+	w->depth--;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Reader
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface ZDCJSONReader : NSObject {
+@public
+	
+	const uint8_t *bytes;
+	NSUInteger length;
+	NSUInteger pos;
+	
+	NSUInteger depth;
+	NSError *error;
+	
+	uint8_t *scratch;       // used to unescape strings (created lazily)
+	NSUInteger scratchCapacity;
+}
+@end
+
+@implementation ZDCJSONReader
+
+- (void)dealloc
+{
+	free(scratch);
+}
+
+@end
+
+static id ZDCJSONReaderFail(ZDCJSONReader *r, NSString *reason)
+{
+	if (r->error == nil)
+	{
+		NSString *description =
+		  [NSString stringWithFormat:@"%@ (at offset %lu)", reason, (unsigned long)r->pos];
+		r->error = ZDCJSONError(ZDCJSONSerializationError_MalformedJSON, description);
+	}
+	return nil;
+}
+
+static inline void ZDCJSONSkipWhitespace(ZDCJSONReader *r)
+{
+	while (r->pos < r->length)
+	{
+		uint8_t const c = r->bytes[r->pos];
+		if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+		
+		r->pos++;
+	}
+}
+
+/**
+ * Skips whitespace, and then consumes the given character if it's next.
+ */
+static inline BOOL ZDCJSONConsume(ZDCJSONReader *r, uint8_t c)
+{
+	ZDCJSONSkipWhitespace(r);
+	
+	if ((r->pos < r->length) && (r->bytes[r->pos] == c))
+	{
+		r->pos++;
+		return YES;
+	}
+	return NO;
+}
+
+static BOOL ZDCJSONExpect(ZDCJSONReader *r, uint8_t c)
+{
+	if (ZDCJSONConsume(r, c)) return YES;
+	
+	ZDCJSONReaderFail(r, [NSString stringWithFormat:@"Expected '%c'", (char)c]);
+	return NO;
+}
+
+static BOOL ZDCJSONExpectLiteral(ZDCJSONReader *r, const char *literal)
+{
+	size_t const len = strlen(literal);
+	
+	if ((r->length - r->pos < len) || (memcmp(r->bytes + r->pos, literal, len) != 0))
+	{
+		ZDCJSONReaderFail(r, [NSString stringWithFormat:@"Expected '%s'", literal]);
+		return NO;
+	}
+	
+	r->pos += len;
+	return YES;
+}
+
+static inline void ZDCJSONReserveScratch(ZDCJSONReader *r, NSUInteger needed)
+{
+	if (needed <= r->scratchCapacity) return;
+	
+	r->scratchCapacity = MAX(needed, MAX(r->scratchCapacity * 2, (NSUInteger)256));
+	r->scratch = reallocf(r->scratch, r->scratchCapacity);
+}
+
+static int ZDCJSONParseHex4(const uint8_t *p)
+{
+	int value = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		uint8_t const c = p[i];
+		int digit;
+		
+		if (c >= '0' && c <= '9')      digit = c - '0';
+		else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+		else return -1;
+		
+		value = (value << 4) | digit;
+	}
+	return value;
+}
+
+static NSUInteger ZDCJSONEncodeUTF8(uint32_t codePoint, uint8_t *out)
+{
+	if (codePoint < 0x80)
+	{
+		out[0] = (uint8_t)codePoint;
+		return 1;
+	}
+	if (codePoint < 0x800)
+	{
+		out[0] = (uint8_t)(0xC0 | (codePoint >> 6));
+		out[1] = (uint8_t)(0x80 | (codePoint & 0x3F));
+		return 2;
+	}
+	if (codePoint < 0x10000)
+	{
+		out[0] = (uint8_t)(0xE0 | (codePoint >> 12));
+		out[1] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+		out[2] = (uint8_t)(0x80 | (codePoint & 0x3F));
+		return 3;
+	}
+	
+	out[0] = (uint8_t)(0xF0 | (codePoint >> 18));
+	out[1] = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+	out[2] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+	out[3] = (uint8_t)(0x80 | (codePoint & 0x3F));
+	return 4;
+}
+
+/**
+ * Parses a string. The reader must be positioned at the opening quote.
+ */
+static NSString *ZDCJSONParseString(ZDCJSONReader *r)
+{
+	NSUInteger const start = ++r->pos;
+	NSUInteger i = start;
+	
+	// Fast path: strings without escapes are created directly from the input.
+	
+	while (i < r->length)
+	{
+		uint8_t const c = r->bytes[i];
+		
+		if (c == '"')
+		{
+			NSString *str =
+			  [[NSString alloc] initWithBytes:(r->bytes + start) length:(i - start) encoding:NSUTF8StringEncoding];
+			
+			if (str == nil) return ZDCJSONReaderFail(r, @"Invalid UTF-8 within string");
+			
+			r->pos = i + 1;
+			return str;
+		}
+		if (c == '\\') break;
+		if (c < 0x20) return ZDCJSONReaderFail(r, @"Unescaped control character within string");
+		
+		i++;
+	}
+	
+	// Slow path: unescape into the scratch buffer.
+	
+	NSUInteger outLen = i - start;
+	ZDCJSONReserveScratch(r, outLen + 4);
+	memcpy(r->scratch, r->bytes + start, outLen);
+	
+	while (i < r->length)
+	{
+		uint8_t const c = r->bytes[i];
+		ZDCJSONReserveScratch(r, outLen + 4);
+		
+		if (c == '"')
+		{
+			NSString *str = [[NSString alloc] initWithBytes:r->scratch length:outLen encoding:NSUTF8StringEncoding];
+			if (str == nil) return ZDCJSONReaderFail(r, @"Invalid UTF-8 within string");
+			
+			r->pos = i + 1;
+			return str;
+		}
+		if (c < 0x20)
+		{
+			r->pos = i;
+			return ZDCJSONReaderFail(r, @"Unescaped control character within string");
+		}
+		if (c != '\\')
+		{
+			r->scratch[outLen++] = c;
+			i++;
+			continue;
+		}
+		
+		if (++i >= r->length) break;
+		
+		switch (r->bytes[i])
+		{
+			case '"'  : r->scratch[outLen++] = '"';  break;
+			case '\\' : r->scratch[outLen++] = '\\'; break;
+			case '/'  : r->scratch[outLen++] = '/';  break;
+			case 'b'  : r->scratch[outLen++] = '\b'; break;
+			case 'f'  : r->scratch[outLen++] = '\f'; break;
+			case 'n'  : r->scratch[outLen++] = '\n'; break;
+			case 'r'  : r->scratch[outLen++] = '\r'; break;
+			case 't'  : r->scratch[outLen++] = '\t'; break;
+			case 'u'  :
+			{
+				r->pos = i;
+				
+				int unit = (r->length - i > 4) ? ZDCJSONParseHex4(r->bytes + i + 1) : -1;
+				if (unit < 0) return ZDCJSONReaderFail(r, @"Invalid unicode escape");
+				i += 4;
+				
+				uint32_t codePoint = (uint32_t)unit;
+				if (unit >= 0xD800 && unit <= 0xDBFF)
+				{
+					// High surrogate: must be followed by an escaped low surrogate
+					
+					int low = -1;
+					if ((r->length - i > 6) && (r->bytes[i + 1] == '\\') && (r->bytes[i + 2] == 'u')) {
+						low = ZDCJSONParseHex4(r->bytes + i + 3);
+					}
+					if (low < 0xDC00 || low > 0xDFFF) return ZDCJSONReaderFail(r, @"Unpaired surrogate");
+					i += 6;
+					
+					codePoint = 0x10000 + (((uint32_t)unit - 0xD800) << 10) + ((uint32_t)low - 0xDC00);
+				}
+				else if (unit >= 0xDC00 && unit <= 0xDFFF)
+				{
+					return ZDCJSONReaderFail(r, @"Unpaired surrogate");
+				}
+				
+				outLen += ZDCJSONEncodeUTF8(codePoint, r->scratch + outLen);
+				break;
+			}
+			default:
+			{
+				r->pos = i;
+				return ZDCJSONReaderFail(r, @"Invalid escape sequence");
+			}
+		}
+		
+		i++;
+	}
+	
+	r->pos = i;
+	return ZDCJSONReaderFail(r, @"Unterminated string");
+}
+
+static inline BOOL ZDCJSONIsDigit(uint8_t c)
+{
+	return (c >= '0' && c <= '9');
+}
+
+static NSNumber *ZDCJSONParseNumber(ZDCJSONReader *r)
+{
+	NSUInteger const start = r->pos;
+	NSUInteger i = start;
+	BOOL isInteger = YES;
+	
+	// Validate the grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+	
+	if ((i < r->length) && (r->bytes[i] == '-')) i++;
+	
+	if ((i < r->length) && (r->bytes[i] == '0')) {
+		i++;
+	}
+	else if ((i < r->length) && ZDCJSONIsDigit(r->bytes[i])) {
+		while ((i < r->length) && ZDCJSONIsDigit(r->bytes[i])) i++;
+	}
+	else {
+		return ZDCJSONReaderFail(r, @"Invalid number");
+	}
+	
+	if ((i < r->length) && (r->bytes[i] == '.'))
+	{
+		isInteger = NO;
+		i++;
+		
+		if ((i >= r->length) || !ZDCJSONIsDigit(r->bytes[i])) return ZDCJSONReaderFail(r, @"Invalid number");
+		while ((i < r->length) && ZDCJSONIsDigit(r->bytes[i])) i++;
+	}
+	
+	if ((i < r->length) && (r->bytes[i] == 'e' || r->bytes[i] == 'E'))
+	{
+		isInteger = NO;
+		i++;
+		
+		if ((i < r->length) && (r->bytes[i] == '+' || r->bytes[i] == '-')) i++;
+		
+		if ((i >= r->length) || !ZDCJSONIsDigit(r->bytes[i])) return ZDCJSONReaderFail(r, @"Invalid number");
+		while ((i < r->length) && ZDCJSONIsDigit(r->bytes[i])) i++;
+	}
+	
+	// The strto* functions require a terminated string
+	
+	NSUInteger const tokenLength = i - start;
+	
+	char stackBuffer[64];
+	char *token = (tokenLength < sizeof(stackBuffer)) ? stackBuffer : malloc(tokenLength + 1);
+	
+	memcpy(token, r->bytes + start, tokenLength);
+	token[tokenLength] = '\0';
+	
+	NSNumber *result = nil;
+	if (isInteger)
+	{
+		errno = 0;
+		if (token[0] == '-')
+		{
+			long long value = strtoll(token, NULL, 10);
+			if (errno != ERANGE) result = @(value);
+		}
+		else
+		{
+			unsigned long long value = strtoull(token, NULL, 10);
+			if (errno != ERANGE) {
+				result = (value <= LLONG_MAX) ? @((long long)value) : @(value);
+			}
+		}
+	}
+	if (result == nil)
+	{
+		// Non-integers, and integers that don't fit into 64 bits
+		result = @(strtod(token, NULL));
+	}
+	
+	if (token != stackBuffer) {
+		free(token);
+	}
+	
+	r->pos = i;
+	return result;
+}
+
+/**
+ * Parses an integer directly (without creating an NSNumber).
+ */
+static BOOL ZDCJSONParseInt64(ZDCJSONReader *r, int64_t *outValue)
+{
+	ZDCJSONSkipWhitespace(r);
+	
+	NSUInteger i = r->pos;
+	BOOL negative = NO;
+	
+	if ((i < r->length) && (r->bytes[i] == '-'))
+	{
+		negative = YES;
+		i++;
+	}
+	
+	NSUInteger const digitsStart = i;
+	uint64_t magnitude = 0;
+	
+	while ((i < r->length) && ZDCJSONIsDigit(r->bytes[i]))
+	{
+		uint64_t const digit = (uint64_t)(r->bytes[i] - '0');
+		if (magnitude > (UINT64_MAX - digit) / 10)
+		{
+			ZDCJSONReaderFail(r, @"Integer out of range");
+			return NO;
+		}
+		
+		magnitude = (magnitude * 10) + digit;
+		i++;
+	}
+	
+	BOOL const isInteger =
+	    (i > digitsStart)
+	 && !((r->bytes[digitsStart] == '0') && (i - digitsStart > 1)) // no leading zeros
+	 && !((i < r->length) && (r->bytes[i] == '.' || r->bytes[i] == 'e' || r->bytes[i] == 'E'));
+	
+	if (!isInteger)
+	{
+		ZDCJSONReaderFail(r, @"Expected an integer");
+		return NO;
+	}
+	
+	if (negative)
+	{
+		if (magnitude > (uint64_t)INT64_MAX + 1)
+		{
+			ZDCJSONReaderFail(r, @"Integer out of range");
+			return NO;
+		}
+		*outValue = (magnitude == (uint64_t)INT64_MAX + 1) ? INT64_MIN : -(int64_t)magnitude;
+	}
+	else
+	{
+		if (magnitude > (uint64_t)INT64_MAX)
+		{
+			ZDCJSONReaderFail(r, @"Integer out of range");
+			return NO;
+		}
+		*outValue = (int64_t)magnitude;
+	}
+	
+	r->pos = i;
+	return YES;
+}
+
+static id ZDCJSONParseValue(ZDCJSONReader *r);
+
+/**
+ * Parses a JSON array, adding the items to the given collection (which must support `addObject:`).
+ */
+static id ZDCJSONParseItems(ZDCJSONReader *r, id collection)
+{
+	if (!ZDCJSONExpect(r, '[')) return nil;
+	if (ZDCJSONConsume(r, ']')) return collection;
+	
+	do {
+		id item = ZDCJSONParseValue(r);
+		if (item == nil) return nil;
+		
+		[collection addObject:item];
+		
+	} while (ZDCJSONConsume(r, ','));
+	
+	if (!ZDCJSONExpect(r, ']')) return nil;
+	return collection;
+}
+
+/**
+ * Parses a JSON array of alternating keys & values,
+ * adding them to the given dictionary (which must support `setObject:forKey:`).
+ */
+static id ZDCJSONParsePairs(ZDCJSONReader *r, id dictionary)
+{
+	if (!ZDCJSONExpect(r, '[')) return nil;
+	if (ZDCJSONConsume(r, ']')) return dictionary;
+	
+	do {
+		id key = ZDCJSONParseValue(r);
+		if (key == nil) return nil;
+		
+		if (!ZDCJSONExpect(r, ',')) return nil;
+		
+		id value = ZDCJSONParseValue(r);
+		if (value == nil) return nil;
+		
+		[dictionary setObject:value forKey:key];
+		
+	} while (ZDCJSONConsume(r, ','));
+	
+	if (!ZDCJSONExpect(r, ']')) return nil;
+	return dictionary;
+}
+
+static NSIndexSet *ZDCJSONParseIndexSet(ZDCJSONReader *r)
+{
+	NSMutableIndexSet *indexSet = [[NSMutableIndexSet alloc] init];
+	
+	if (!ZDCJSONExpect(r, '[')) return nil;
+	if (ZDCJSONConsume(r, ']')) return indexSet;
+	
+	do {
+		int64_t location = 0;
+		int64_t length = 0;
+		
+		if (!ZDCJSONExpect(r, '['))               return nil;
+		if (!ZDCJSONParseInt64(r, &location))    return nil;
+		if (!ZDCJSONExpect(r, ','))               return nil;
+		if (!ZDCJSONParseInt64(r, &length))      return nil;
+		if (!ZDCJSONExpect(r, ']'))               return nil;
+		
+		if (location < 0 || length <= 0 || (uint64_t)length > (uint64_t)NSNotFound - (uint64_t)location) {
+			return ZDCJSONReaderFail(r, @"Invalid index range");
+		}
+		
+		[indexSet addIndexesInRange:NSMakeRange((NSUInteger)location, (NSUInteger)length)];
+		
+	} while (ZDCJSONConsume(r, ','));
+	
+	if (!ZDCJSONExpect(r, ']')) return nil;
+	return indexSet;
+}
+
+/**
+ * Parses a JSON array of integers into a malloc'd buffer.
+ * The caller is responsible for freeing the buffer (even on failure).
+ */
+static BOOL ZDCJSONParseInt64Values(ZDCJSONReader *r, int64_t **outValues, NSUInteger *outCount)
+{
+	NSUInteger count = 0;
+	NSUInteger capacity = 16;
+	int64_t *values = malloc(capacity * sizeof(int64_t));
+	
+	*outValues = values;
+	*outCount = 0;
+	
+	if (!ZDCJSONExpect(r, '[')) return NO;
+	if (ZDCJSONConsume(r, ']')) return YES;
+	
+	do {
+		if (count == capacity)
+		{
+			capacity *= 2;
+			values = reallocf(values, capacity * sizeof(int64_t));
+			*outValues = values;
+		}
+		
+		if (!ZDCJSONParseInt64(r, &values[count])) return NO;
+		count++;
+		
+	} while (ZDCJSONConsume(r, ','));
+	
+	*outCount = count;
+	return ZDCJSONExpect(r, ']');
+}
+
+/**
+ * Parses the value of a tagged object (e.g. {"$indexes":[...]}).
+ * The reader must be positioned at the opening quote of the tag.
+ */
+static id ZDCJSONParseTaggedValue(ZDCJSONReader *r)
+{
+	// Tags never contain escapes, so we can match them against the raw bytes.
+	
+	NSUInteger const tagStart = r->pos + 1;
+	NSUInteger tagEnd = tagStart;
+	
+	while ((tagEnd < r->length) && (r->bytes[tagEnd] != '"') && (r->bytes[tagEnd] != '\\')) {
+		tagEnd++;
+	}
+	if ((tagEnd >= r->length) || (r->bytes[tagEnd] != '"')) {
+		return ZDCJSONReaderFail(r, @"Invalid tag");
+	}
+	
+	const void *tag = r->bytes + tagStart;
+	NSUInteger const tagLength = tagEnd - tagStart;
+	
+	r->pos = tagEnd + 1;
+	if (!ZDCJSONExpect(r, ':')) return nil;
+	
+	#define ZDCJSONTagIs(literal) ((tagLength == sizeof(literal) - 1) && (memcmp(tag, literal, tagLength) == 0))
+	
+	id result = nil;
+	
+	if (ZDCJSONTagIs("$indexes"))
+	{
+		result = ZDCJSONParseIndexSet(r);
+	}
+	else if (ZDCJSONTagIs("$map"))
+	{
+		result = ZDCJSONParsePairs(r, [NSMutableDictionary dictionary]);
+	}
+	else if (ZDCJSONTagIs("$set"))
+	{
+		result = ZDCJSONParseItems(r, [NSMutableSet set]);
+	}
+	else if (ZDCJSONTagIs("$null"))
+	{
+		ZDCJSONSkipWhitespace(r);
+		if (ZDCJSONExpectLiteral(r, "true")) {
+			result = [ZDCNull null];
+		}
+	}
+	else if (ZDCJSONTagIs("$ref"))
+	{
+		ZDCJSONSkipWhitespace(r);
+		if (ZDCJSONExpectLiteral(r, "true")) {
+			result = [ZDCRef ref];
+		}
+	}
+	else if (ZDCJSONTagIs("$data"))
+	{
+		id base64 = ZDCJSONParseValue(r);
+		if ([base64 isKindOfClass:[NSString class]])
+		{
+			result = [[NSData alloc] initWithBase64EncodedString:(NSString *)base64 options:0];
+			if (result == nil) {
+				ZDCJSONReaderFail(r, @"Invalid base64 data");
+			}
+		}
+		else if (base64) {
+			ZDCJSONReaderFail(r, @"Expected a base64 string");
+		}
+	}
+	else if (ZDCJSONTagIs("$date"))
+	{
+		id interval = ZDCJSONParseValue(r);
+		if ([interval isKindOfClass:[NSNumber class]]) {
+			result = [NSDate dateWithTimeIntervalSinceReferenceDate:[(NSNumber *)interval doubleValue]];
+		}
+		else if (interval) {
+			ZDCJSONReaderFail(r, @"Expected a number");
+		}
+	}
+	else if (ZDCJSONTagIs("$ZDCDictionary"))
+	{
+		id raw = ZDCJSONParseValue(r);
+		if ([raw isKindOfClass:[NSDictionary class]]) {
+			result = [[ZDCDictionary alloc] initWithDictionary:raw copyItems:NO trackChanges:NO];
+		}
+		else if (raw) {
+			ZDCJSONReaderFail(r, @"Expected a dictionary");
+		}
+	}
+	else if (ZDCJSONTagIs("$ZDCOrderedDictionary"))
+	{
+		ZDCOrderedDictionary *dict = ZDCJSONParsePairs(r, [[ZDCOrderedDictionary alloc] init]);
+		[dict clearChangeTracking];
+		result = dict;
+	}
+	else if (ZDCJSONTagIs("$ZDCArray"))
+	{
+		NSArray *items = ZDCJSONParseItems(r, [NSMutableArray array]);
+		if (items) {
+			result = [[ZDCArray alloc] initWithArray:items copyItems:NO trackChanges:NO];
+		}
+	}
+	else if (ZDCJSONTagIs("$ZDCSet"))
+	{
+		NSArray *items = ZDCJSONParseItems(r, [NSMutableArray array]);
+		if (items) {
+			result = [[ZDCSet alloc] initWithArray:items copyItems:NO trackChanges:NO];
+		}
+	}
+	else if (ZDCJSONTagIs("$ZDCOrderedSet"))
+	{
+		NSArray *items = ZDCJSONParseItems(r, [NSMutableArray array]);
+		if (items) {
+			result = [[ZDCOrderedSet alloc] initWithArray:items copyItems:NO trackChanges:NO];
+		}
+	}
+	else if (ZDCJSONTagIs("$ZDCInt64Array") || ZDCJSONTagIs("$ZDCInt64OrderedSet"))
+	{
+		BOOL const isArray = ZDCJSONTagIs("$ZDCInt64Array");
+		
+		int64_t *values = NULL;
+		NSUInteger count = 0;
+		
+		if (ZDCJSONParseInt64Values(r, &values, &count))
+		{
+			if (isArray)
+				result = [[ZDCInt64Array alloc] initWithValues:values count:count trackChanges:NO];
+			else
+				result = [[ZDCInt64OrderedSet alloc] initWithValues:values count:count trackChanges:NO];
+		}
+		free(values);
+	}
+	else if (ZDCJSONTagIs("$ZDCConcurrentDictionary"))
+	{
+		id raw = ZDCJSONParseValue(r);
+		if ([raw isKindOfClass:[NSDictionary class]])
+		{
+			ZDCConcurrentDictionary *dict = [[ZDCConcurrentDictionary alloc] init];
+			[(NSDictionary *)raw enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+				[dict setObject:obj forKey:key];
+			}];
+			[dict clearChangeTracking];
+			result = dict;
+		}
+		else if (raw) {
+			ZDCJSONReaderFail(r, @"Expected a dictionary");
+		}
+	}
+	else if (ZDCJSONTagIs("$class"))
+	{
+		// ["name",raw]
+		
+		ZDCJSONRegistration *registration = nil;
+		
+		if (ZDCJSONExpect(r, '['))
+		{
+			id name = ZDCJSONParseValue(r);
+			if ([name isKindOfClass:[NSString class]])
+			{
+				registration = ZDCJSONRegistrationForName((NSString *)name);
+				if (registration == nil) {
+					ZDCJSONReaderFail(r, [NSString stringWithFormat:@"Unregistered class name: %@", name]);
+				}
+			}
+			else if (name) {
+				ZDCJSONReaderFail(r, @"Expected a class name");
+			}
+		}
+		
+		if (registration && ZDCJSONExpect(r, ','))
+		{
+			id raw = ZDCJSONParseValue(r);
+			if (raw && ZDCJSONExpect(r, ']'))
+			{
+				result = registration->decoder(raw);
+				if (result == nil) {
+					ZDCJSONReaderFail(r, [NSString stringWithFormat:@"Invalid value for class %@", registration->name]);
+				}
+			}
+		}
+	}
+	else
+	{
+		r->pos = tagStart;
+		ZDCJSONReaderFail(r, @"Unknown tag (keys starting with '$' are reserved)");
+	}
+	
+	#undef ZDCJSONTagIs
+	
+	if (result == nil) return nil;
+	
+	// A tagged object has exactly one key
+	if (!ZDCJSONExpect(r, '}')) return nil;
+	
+	return result;
+}
+
+/**
+ * Parses an object. The reader must be positioned at the opening brace.
+ */
+static id ZDCJSONParseObject(ZDCJSONReader *r)
+{
+	r->pos++;
+	ZDCJSONSkipWhitespace(r);
+	
+	if ((r->pos < r->length) && (r->bytes[r->pos] == '}'))
+	{
+		r->pos++;
+		return [NSMutableDictionary dictionary];
+	}
+	
+	// Tagged values are objects with a single, reserved key
+	
+	if ((r->pos + 1 < r->length) && (r->bytes[r->pos] == '"') && (r->bytes[r->pos + 1] == '$'))
+	{
+		return ZDCJSONParseTaggedValue(r);
+	}
+	
+	NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+	do {
+		ZDCJSONSkipWhitespace(r);
+		
+		if ((r->pos >= r->length) || (r->bytes[r->pos] != '"')) {
+			return ZDCJSONReaderFail(r, @"Expected a string key");
+		}
+		if ((r->pos + 1 < r->length) && (r->bytes[r->pos + 1] == '$')) {
+			return ZDCJSONReaderFail(r, @"Keys starting with '$' are reserved");
+		}
+		
+		NSString *key = ZDCJSONParseString(r);
+		if (key == nil) return nil;
+		
+		if (!ZDCJSONExpect(r, ':')) return nil;
+		
+		id value = ZDCJSONParseValue(r);
+		if (value == nil) return nil;
+		
+		dict[key] = value;
+		
+	} while (ZDCJSONConsume(r, ','));
+	
+	if (!ZDCJSONExpect(r, '}')) return nil;
+	return dict;
+}
+
+static id ZDCJSONParseValue(ZDCJSONReader *r)
+{
+	ZDCJSONSkipWhitespace(r);
+	
+	if (r->pos >= r->length) {
+		return ZDCJSONReaderFail(r, @"Unexpected end of input");
+	}
+	
+	uint8_t const c = r->bytes[r->pos];
+	
+	if (c == '"') {
+		return ZDCJSONParseString(r);
+	}
+	if (c == '-' || ZDCJSONIsDigit(c)) {
+		return ZDCJSONParseNumber(r);
+	}
+	
+	if (c == '{' || c == '[')
+	{
+		if (r->depth >= kMaxDepth) {
+			return ZDCJSONReaderFail(r, @"Nesting is too deep");
+		}
+		
+		r->depth++;
+		id result = (c == '{') ? ZDCJSONParseObject(r) : ZDCJSONParseItems(r, [NSMutableArray array]);
+		r->depth--;
+		
+		return result;
+	}
+	
+	if (c == 't') return ZDCJSONExpectLiteral(r, "true")  ? @YES : nil;
+	if (c == 'f') return ZDCJSONExpectLiteral(r, "false") ? @NO  : nil;
+	if (c == 'n') return ZDCJSONExpectLiteral(r, "null")  ? [NSNull null] : nil;
+	
+	return ZDCJSONReaderFail(r, @"Unexpected character");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Changeset Validation
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Validates the structure of a changeset (see header file for details).
+ * Returns nil if valid, or a description of the problem.
+ */
+static NSString *ZDCJSONChangesetProblem(id changeset, NSUInteger depth)
+{
+	if (![changeset isKindOfClass:[NSDictionary class]]) {
+		return @"Changeset isn't a dictionary";
+	}
+	if (depth >= kMaxDepth) {
+		return @"Changeset is nested too deeply";
+	}
+	
+	for (id key in (NSDictionary *)changeset)
+	{
+		id value = [(NSDictionary *)changeset objectForKey:key];
+		BOOL valid;
+		
+		if ([key isEqual:kChangeset_refs])
+		{
+			// refs: { key: changeset, ... }
+			
+			if (![value isKindOfClass:[NSDictionary class]]) {
+				return @"Changeset 'refs' isn't a dictionary";
+			}
+			for (id refKey in (NSDictionary *)value)
+			{
+				NSString *problem = ZDCJSONChangesetProblem([(NSDictionary *)value objectForKey:refKey], depth + 1);
+				if (problem) return problem;
+			}
+			valid = YES;
+		}
+		else if ([key isEqual:kChangeset_values] || [key isEqual:kChangeset_moved] || [key isEqual:kChangeset_indexes])
+		{
+			valid = [value isKindOfClass:[NSDictionary class]];
+		}
+		else if ([key isEqual:kChangeset_added])
+		{
+			valid = [value isKindOfClass:[NSIndexSet class]] || [value isKindOfClass:[NSSet class]];
+		}
+		else if ([key isEqual:kChangeset_deleted])
+		{
+			valid = [value isKindOfClass:[NSDictionary class]] || [value isKindOfClass:[NSSet class]];
+		}
+		else
+		{
+			return [NSString stringWithFormat:@"Unknown changeset key: %@", key];
+		}
+		
+		if (!valid) {
+			return [NSString stringWithFormat:@"Changeset '%@' has an invalid type", key];
+		}
+	}
+	
+	return nil;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCJSONSerialization
+
+/**
+ * See header file for description.
+ */
++ (void)registerClass:(Class)cls
+                 name:(NSString *)name
+              encoder:(id _Nullable (^)(id object))encoder
+              decoder:(id _Nullable (^)(id raw))decoder
+{
+	ZDCJSONRegistration *registration = [[ZDCJSONRegistration alloc] init];
+	registration->cls = cls;
+	registration->name = [name copy];
+	registration->encoder = [encoder copy];
+	registration->decoder = [decoder copy];
+	
+	pthread_mutex_lock(&registrationLock);
+	{
+		if (registrationsByClass == nil)
+		{
+			registrationsByClass = [NSMapTable strongToStrongObjectsMapTable];
+			registrationsByName = [[NSMutableDictionary alloc] init];
+		}
+		
+		// Replace any previous registration for either the class or the name
+		
+		ZDCJSONRegistration *prevForClass = [registrationsByClass objectForKey:cls];
+		if (prevForClass) {
+			[registrationsByName removeObjectForKey:prevForClass->name];
+		}
+		
+		ZDCJSONRegistration *prevForName = registrationsByName[name];
+		if (prevForName) {
+			[registrationsByClass removeObjectForKey:prevForName->cls];
+		}
+		
+		[registrationsByClass setObject:registration forKey:cls];
+		registrationsByName[registration->name] = registration;
+	}
+	pthread_mutex_unlock(&registrationLock);
+}
+
+/**
+ * See header file for description.
+ */
++ (void)registerRecordClass:(Class)cls name:(NSString *)name
+{
+	NSAssert([cls isSubclassOfClass:[ZDCRecord class]], @"Expected a ZDCRecord subclass");
+	
+	ZDCJSONEncoderBlock encoder = ^id (ZDCRecord *record){
+		
+		NSMutableDictionary<NSString*, id> *properties = [NSMutableDictionary dictionary];
+		for (NSString *key in [record monitoredProperties])
+		{
+			id value = [record valueForKey:key];
+			if (value) {
+				properties[key] = value;
+			}
+		}
+		return properties;
+	};
+	
+	ZDCJSONDecoderBlock decoder = ^id (id raw){
+		
+		if (![raw isKindOfClass:[NSDictionary class]]) return nil;
+		NSDictionary<NSString*, id> *properties = (NSDictionary *)raw;
+		
+		ZDCRecord *record = [[cls alloc] init];
+		
+		// Only monitored properties are ever written, so anything else is invalid input.
+		// (And we don't want to hand arbitrary keys to KVC.)
+		
+		NSSet<NSString*> *monitored = [record monitoredProperties];
+		for (id key in properties)
+		{
+			if (![monitored containsObject:key]) return nil;
+		}
+		
+		[record performWithoutChangeTracking:^{
+			
+			[properties enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stop) {
+				[record setValue:value forKey:key];
+			}];
+		}];
+		
+		return record;
+	};
+	
+	[self registerClass:cls name:name encoder:encoder decoder:decoder];
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable NSData *)dataWithObject:(id)object error:(NSError *_Nullable *_Nullable)errPtr
+{
+	ZDCJSONWriter *w = [[ZDCJSONWriter alloc] init];
+	w->capacity = 4096;
+	w->buffer = malloc(w->capacity);
+	
+	ZDCJSONWriteValue(w, object);
+	
+	if (w->error)
+	{
+		if (errPtr) *errPtr = w->error;
+		return nil;
+	}
+	
+	// Hand the buffer over to the NSData (no copy)
+	
+	NSData *data = [NSData dataWithBytesNoCopy:w->buffer length:w->length freeWhenDone:YES];
+	w->buffer = NULL;
+	
+	if (errPtr) *errPtr = nil;
+	return data;
+}
+
+/**
+ * See header file for description.
+ */
++ (BOOL)writeObject:(id)object toStream:(NSOutputStream *)stream error:(NSError *_Nullable *_Nullable)errPtr
+{
+	ZDCJSONWriter *w = [[ZDCJSONWriter alloc] init];
+	w->capacity = kStreamChunkSize;
+	w->buffer = malloc(w->capacity);
+	w->stream = stream;
+	
+	ZDCJSONWriteValue(w, object);
+	
+	if (w->error == nil) {
+		ZDCJSONWriterDrain(w);
+	}
+	
+	if (errPtr) *errPtr = w->error;
+	return (w->error == nil);
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable id)objectWithData:(NSData *)data error:(NSError *_Nullable *_Nullable)errPtr
+{
+	ZDCJSONReader *r = [[ZDCJSONReader alloc] init];
+	r->bytes = data.bytes;
+	r->length = data.length;
+	
+	id result = ZDCJSONParseValue(r);
+	
+	if (result)
+	{
+		ZDCJSONSkipWhitespace(r);
+		if (r->pos < r->length)
+		{
+			ZDCJSONReaderFail(r, @"Unexpected data after the top-level value");
+			result = nil;
+		}
+	}
+	
+	if (errPtr) *errPtr = r->error;
+	return result;
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetWithData:(NSData *)data error:(NSError *_Nullable *_Nullable)errPtr
+{
+	NSError *error = nil;
+	id changeset = [self objectWithData:data error:&error];
+	
+	if (changeset)
+	{
+		NSString *problem = ZDCJSONChangesetProblem(changeset, 0);
+		if (problem)
+		{
+			error = ZDCJSONError(ZDCJSONSerializationError_NotAChangeset, problem);
+			changeset = nil;
+		}
+	}
+	
+	if (errPtr) *errPtr = error;
+	return changeset;
+}
+
+@end
@@ -57,6 +57,178 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)copyChangeTrackingTo:(id)another;
 
+/**
+ * Used by `restoreCheckpoint:`.
+ *
+ * The given object is a fresh copy (via `copyWithZone:`) of the state captured by `checkpoint`.
+ * Subclasses should override this method, adopt the contents & change tracking information of the copy
+ * (the copy is discarded afterwards, so its storage can be taken as-is), and then invoke super.
+ *
+ * Configuration (such as the retentionPolicy) is not part of the state, and shouldn't be restored.
+ */
+- (void)restoreStateFromCopy:(id)copy;
+
+/**
+ * Used by `publishSnapshot`.
+ *
+ * The receiver is a fresh copy (via `copyWithZone:`), which is about to be made immutable.
+ * Subclasses that store child objects should override this method, and replace each child with the value
+ * returned by the block. This includes children referenced by the change tracking info (e.g. original values),
+ * such that the copy doesn't share any child object with the original.
+ * The block always returns the same replacement for the same child, so identity comparisons remain valid.
+ *
+ * The default implementation does nothing.
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block;
+
+#pragma mark Change Tracking
+
+/**
+ * Returns YES if invoked from within a `performWithoutChangeTracking:` block.
+ *
+ * Subclasses should check this before updating their change tracking information.
+ */
+- (BOOL)isChangeTrackingSuspended;
+
+/**
+ * Invoked by `performWithoutChangeTracking:` before the (outermost) block is executed.
+ *
+ * Mutations made within the block aren't tracked, but the changes tracked prior to the block must be kept.
+ * Subclasses that track changes by key can simply discard the tracking info for each key touched within the block.
+ * But subclasses that track changes by position (e.g. ZDCArray) can't, since the untracked mutations
+ * shift the positions that the tracked changes refer to. Such subclasses should capture whatever they need here,
+ * and return it. The returned value is passed to `_didPerformUntrackedChanges:` after the block returns.
+ *
+ * The default implementation returns nil.
+ */
+- (nullable id)_willPerformUntrackedChanges;
+
+/**
+ * Invoked by `performWithoutChangeTracking:` after the (outermost) block returns,
+ * with the value that was returned from `_willPerformUntrackedChanges`.
+ *
+ * Subclasses should fold the untracked mutations into their original state,
+ * such that the changeset only includes the changes that were tracked outside of the block.
+ *
+ * The default implementation does nothing.
+ */
+- (void)_didPerformUntrackedChanges:(nullable id)context;
+
+/**
+ * Subclasses should pass original values through this method before storing them in their change tracking info.
+ *
+ * Returns either the value itself, or a ZDCRetainedValue, depending on the configured retentionPolicy.
+ * ZDCNull & ZDCObject instances are always returned as-is.
+ */
+- (nullable id)retainedOriginal:(nullable id)value;
+
+/**
+ * Performs the inverse of `retainedOriginal:`.
+ * Subclasses should pass stored originals through this method before exposing them (e.g. in a changeset).
+ *
+ * Returns nil if a ZDCRetainedValue can no longer be resolved (e.g. its spill file is gone).
+ * In this case the changeset being generated is marked as failed (see `resolveChangeset:error:`),
+ * so the caller doesn't need to check for it.
+ */
+- (nullable id)resolvedOriginal:(nullable id)retained;
+
+/**
+ * Generates a changeset via the given block (typically by invoking `_changeset`).
+ *
+ * If any original can't be resolved while the block is running (including within nested objects),
+ * returns nil and sets errPtr to `unresolvedOriginalError`.
+ * Subclasses must then leave their change tracking info untouched, so the changes aren't lost.
+ */
+- (nullable NSDictionary *)resolveChangeset:(NSDictionary *_Nullable (NS_NOESCAPE ^)(void))block
+                                      error:(NSError *_Nullable *_Nullable)errPtr;
+
+/**
+ * Marks the changeset currently being generated on this thread as failed.
+ *
+ * This is invoked automatically by `resolvedOriginal:`.
+ * Subclasses that generate nested changesets on other threads use it to forward a failure.
+ */
+- (void)markChangesetUnresolved;
+
+/**
+ * Subclasses that store original values by key (e.g. ZDCDictionary & ZDCRecord)
+ * should pass them through this method when they're first captured (before `retainedOriginal:`).
+ *
+ * Values conforming to NSCopying are copied, which freezes mutable values (e.g. NSMutableString).
+ * For values that are already immutable (e.g. NSString, NSData) a copy is just a retain.
+ * The original can then be shared by every changeset built from it, without copying it again.
+ *
+ * ZDCSyncable objects (such as ZDCObject instances) are returned as-is.
+ * They're tracked by reference, since their identity is used to detect in-place modifications.
+ */
+- (nullable id)frozenOriginal:(nullable id)value;
+
+/**
+ * Returns the value to place within a changeset, for an original value captured via `frozenOriginal:`.
+ *
+ * Frozen values & immutable ZDCObjects are shared as-is.
+ * Only values that couldn't be frozen when captured (i.e. mutable ZDCSyncable objects) are copied.
+ */
+- (nullable id)changesetValueForOriginal:(nullable id)original;
+
+#pragma mark Statistics
+
+typedef NS_ENUM(NSInteger, ZDCTrackingTimer) {
+	ZDCTrackingTimer_Changeset,
+	ZDCTrackingTimer_Undo,
+	ZDCTrackingTimer_Merge
+};
+
+/**
+ * Subclasses should invoke this method (after checking `isChangeTrackingSuspended`)
+ * every time they update their change tracking information for a mutation.
+ *
+ * @note Changes to monitoredProperties are counted automatically.
+ */
+- (void)incrementMutationCount;
+
+/**
+ * Batched variant of `incrementMutationCount`,
+ * for subclasses that update their change tracking information for multiple mutations at once.
+ */
+- (void)incrementMutationCountBy:(NSUInteger)count;
+
+/**
+ * Adds the time elapsed since `startTime` (a value from `mach_absolute_time()`) to the given timer.
+ */
+- (void)addElapsedTime:(uint64_t)startTime toTimer:(ZDCTrackingTimer)timer;
+
+/**
+ * Returns a rough estimate of the memory used by the given number of entries
+ * within the collections used to store change tracking information.
+ */
+- (NSUInteger)estimatedTrackingBytesForEntryCount:(NSUInteger)count;
+
+/**
+ * Subclasses should override this method to enumerate the ZDCObject instances they directly contain
+ * (e.g. values within a dictionary, or properties of a record).
+ * This is used to walk the object graph, e.g. by `aggregateTrackingStatistics`.
+ *
+ * The default implementation does nothing.
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block;
+
+#pragma mark Concurrency
+
+/**
+ * Invokes the block for every ZDCObject within the given collection.
+ * The collection may be an NSArray, NSSet or NSOrderedSet. For an NSDictionary, the values are enumerated.
+ *
+ * Subclasses use this method for their recursive passes over child objects
+ * (i.e. within `makeImmutable`, `hasChanges` & `clearChangeTracking`).
+ * If the collection contains at least `concurrentChildThreshold` items, the block is invoked concurrently.
+ * Otherwise it's invoked serially on the current thread.
+ *
+ * Setting `*stop = YES` stops the enumeration.
+ * (With concurrent enumeration, blocks that have already started will still run to completion.)
+ */
+- (void)enumerateChildObjectsIn:(id)collection withBlock:(void (^)(ZDCObject *child, BOOL *stop))block;
+
 #pragma mark Hooks
 
 /**
@@ -66,6 +238,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)_willChangeValueForKey:(NSString *)key;
 
+/**
+ * Invoked instead of `_willChangeValueForKey:` when the change is made within `performWithoutChangeTracking:`.
+ *
+ * Subclasses should discard any change tracking info for the key,
+ * such that the new value becomes the original value.
+ *
+ * @note This method is only called for monitoredProperties.
+ */
+- (void)_willChangeUntrackedValueForKey:(NSString *)key;
+
 /**
  * Subclasses can override this method to get notified of changes.
  *
@@ -107,6 +289,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSError *)incorrectObjectClass;
 
+/**
+ * Returned when a changeset can't be generated, because an original value couldn't be resolved.
+ */
+- (NSError *)unresolvedOriginalError;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -38,6 +38,176 @@ NS_SWIFT_NAME(ZDCOrder_ObjC)
                                     to:(NSArray<id> *)dst
                                  hints:(nullable NSSet<id> *)hints;
 
+/**
+ * Same as `estimateChangesetFrom:to:hints:`.
+ *
+ * @param interned
+ *   Pass YES if both lists contain interned keys, which allows keys to be compared by pointer only.
+ *   Otherwise keys are compared via `isEqual:`.
+ */
++ (NSArray<id> *)estimateChangesetFrom:(NSArray<id> *)src
+                                    to:(NSArray<id> *)dst
+                                 hints:(nullable NSSet<id> *)hints
+                              interned:(BOOL)interned;
+
+/**
+ * Returns the positions (within the given list of values) of a longest strictly increasing subsequence.
+ *
+ * This is the building block for calculating a minimal set of moves.
+ * Given the original index of each item (listed in current order),
+ * the items within the longest increasing subsequence are already in their proper relative order.
+ * Thus only the remaining items need to be marked as moved.
+ *
+ * The algorithm runs in O(n log n).
+ *
+ * @param values
+ *   A buffer of `count` values. Duplicate values are allowed, but only one of them will be included.
+ *
+ * @param count
+ *   The number of values within the buffer.
+ */
++ (NSIndexSet *)indexesOfLongestIncreasingSubsequence:(const NSUInteger *)values count:(NSUInteger)count;
+
+/**
+ * Calculates a minimal set of moves that transforms `originalOrder` into `order`.
+ * Both lists must contain the same set of keys.
+ *
+ * The keys within the longest increasing subsequence (of original index, listed in current order)
+ * aren't included. The result is in the format of the 'indexes' component of
+ * ZDCOrderedSet & ZDCOrderedDictionary changesets: `{ key: originalIndex }`
+ */
++ (NSMutableDictionary<id, NSNumber*> *)movedIndexesFromOrder:(NSArray<id> *)originalOrder
+                                                      toOrder:(NSArray<id> *)order;
+
+/**
+ * Returns the items within `order` that are also members of `keys`, in the same order.
+ *
+ * This is a single pass over the array,
+ * as opposed to removing the non-members from a mutable copy one-at-a-time (which is quadratic).
+ */
++ (NSMutableArray<id> *)filterOrder:(NSArray<id> *)order keys:(NSSet<id> *)keys;
+
+/**
+ * Merges a local order with a cloud order, which contain the same set of keys.
+ *
+ * The lists are compared from first to last. At every index where they differ,
+ * remote wins if the cloud key is within `movedRemote`, and local wins otherwise.
+ * Whenever remote wins, the block is invoked so the caller can move the key (within its own storage)
+ * to the position immediately following `prvKey` (or to the front, if `prvKey` is nil).
+ *
+ * The merged prefix is always identical in both lists.
+ * So the remainder of each list is simply its original order, minus the keys that have already been placed.
+ * Thus the algorithm only needs a cursor per list, plus a hashed set of placed keys,
+ * and runs in O(n) (rather than searching & shuffling the arrays on every mismatch).
+ *
+ * @param identityFirst
+ *   Pass YES if both lists contain interned keys, which allows keys to be compared by pointer.
+ */
++ (void)reconcileLocalOrder:(NSArray<id> *)localOrder
+                 cloudOrder:(NSArray<id> *)cloudOrder
+                movedRemote:(NSSet<id> *)movedRemote
+              identityFirst:(BOOL)identityFirst
+                 usingBlock:(void (NS_NOESCAPE ^)(id key, id _Nullable prvKey))block;
+
+/**
+ * Applies the changes that transform `fromOrder` into `toOrder` on top of `baseOrder`, and returns the result.
+ *
+ * This is used by `performWithoutChangeTracking:`. The baseOrder is the original order (at the beginning of the
+ * changeset), and fromOrder & toOrder are the orders before & after the block. The result becomes the new
+ * original order, so the changes made within the block are no longer part of the changeset.
+ *
+ * - Items that were removed (between fromOrder & toOrder) are removed.
+ * - Items that were added or moved are placed immediately after the item that precedes them within `toOrder`.
+ *   (Items that aren't within the result, such as those added prior to fromOrder, are skipped over.)
+ * - Every other item keeps its position within `baseOrder`.
+ *
+ * Duplicates are allowed. The n-th occurrence of an item within one list matches the n-th occurrence in another.
+ * The algorithm runs in O(n log n).
+ *
+ * @param matchIdentical
+ *   Pass YES to match items by pointer (like ZDCArray), or NO to match them via isEqual:.
+ */
++ (NSMutableArray<id> *)rebaseOrder:(NSArray<id> *)baseOrder
+                          fromOrder:(NSArray<id> *)fromOrder
+                            toOrder:(NSArray<id> *)toOrder
+                     matchIdentical:(BOOL)matchIdentical;
+
+#pragma mark Block Moves
+
+/**
+ * The ordered changesets list the previous index of every moved item.
+ * That is, the 'moved' component of ZDCArray changesets, and the 'indexes' component of ZDCOrderedDictionary changesets.
+ * So dragging a block of 500 rows produces 500 entries.
+ *
+ * A contiguous run of moved items may instead be encoded as a single block-move entry,
+ * whose value is an array (rather than a number): `@[ version, previousIndex, length ]`
+ *
+ * - ZDCArray: `moved[@(currentIdx)] = @[ @1, @(previousIdx), @(length) ]`
+ *   The items at currentIdx ..< currentIdx+length came from previousIdx ..< previousIdx+length.
+ *
+ * - ZDCOrderedDictionary: `indexes[firstKey] = @[ @1, @(originalIdx), @(length) ]`
+ *   The firstKey, plus the (length - 1) keys that follow it, came from originalIdx ..< originalIdx+length.
+ *   Where "follow" refers to the order that remains after undoing added keys.
+ *
+ * Writers only produce block-move entries when the container opts in (via its `compressesMoves` property),
+ * and only for long runs. So by default, changesets keep the original format.
+ * Older versions of the framework reject changesets containing block-move entries (via `isMalformedChangeset:`),
+ * since they require every value to be a number. So they report an error rather than misapplying the changeset.
+ * Likewise, block-move entries with an unknown version are rejected.
+ *
+ * Readers expand block-move entries back into per-item entries (`expandMovedIndexes:` & `expandMovedKeys:order:`).
+ * So the rest of the undo & merge logic is unchanged.
+ *
+ * @note This reduces the size of the changeset (e.g. when it's stored or sent over the network).
+ *       It doesn't change the cost of applying it: undo & merge still visit every moved item.
+ */
++ (NSArray<NSNumber*> *)blockMoveWithIndex:(NSUInteger)previousIdx length:(NSUInteger)length;
+
+/**
+ * Returns YES if the given value is a well-formed block-move entry (of a known version),
+ * and extracts its components.
+ */
++ (BOOL)getBlockMove:(id)value index:(nullable NSUInteger *)outPreviousIdx length:(nullable NSUInteger *)outLength;
+
+/**
+ * Encodes contiguous runs within ZDCArray's 'moved' component (`{ currentIdx: previousIdx }`) as block-move entries.
+ */
++ (NSDictionary<NSNumber*, id> *)compressMovedIndexes:(NSDictionary<NSNumber*, NSNumber*> *)moved;
+
+/**
+ * Decodes the block-move entries within ZDCArray's 'moved' component.
+ *
+ * @return The equivalent `{ currentIdx: previousIdx }` dictionary,
+ *         or nil if the entries are invalid or overlap each other.
+ */
++ (nullable NSDictionary<NSNumber*, NSNumber*> *)expandMovedIndexes:(NSDictionary<NSNumber*, id> *)moved;
+
+/**
+ * Encodes contiguous runs within ZDCOrderedDictionary's 'indexes' component (`{ key: originalIdx }`)
+ * as block-move entries.
+ *
+ * @param order
+ *   The current order of keys.
+ *
+ * @param addedKeys
+ *   The keys that were added (and will thus be removed before the moves are undone).
+ *   They're skipped when searching for runs. Pass nil if `order` already excludes them.
+ */
++ (NSDictionary<id, id> *)compressMovedKeys:(NSDictionary<id, NSNumber*> *)indexes
+                                      order:(NSArray<id> *)order
+                                  addedKeys:(nullable NSSet<id> *)addedKeys;
+
+/**
+ * Decodes the block-move entries within ZDCOrderedDictionary's 'indexes' component.
+ *
+ * @param order
+ *   The order of keys after undoing added keys (i.e. when the moves are about to be undone).
+ *
+ * @return The equivalent `{ key: originalIdx }` dictionary (using the key instances from `order`),
+ *         or nil if the entries don't match the order, or overlap each other.
+ */
++ (nullable NSDictionary<id, NSNumber*> *)expandMovedKeys:(NSDictionary<id, id> *)indexes order:(NSArray<id> *)order;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -4,16 +4,111 @@
 **/
 
 #import "ZDCOrder.h"
+#import "ZDCInternTable.h"
+#import "ZDCTrace.h"
+
+// Block-move entries
+//
+static NSInteger const kBlockMoveVersion = 1;
+static NSUInteger const kBlockMoveMinimumLength = 8;
+
+/**
+ * Represents the n-th occurrence of an item within a list.
+ * This allows lists containing duplicates to be joined via hashing.
+ */
+@interface ZDCOrderOccurrence : NSObject <NSCopying> {
+@public
+	id item;
+	NSUInteger number;
+	BOOL matchIdentical;
+}
+@end
+
+@implementation ZDCOrderOccurrence
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	return self; // immutable
+}
+
+- (NSUInteger)hash
+{
+	NSUInteger const itemHash = matchIdentical ? (NSUInteger)(__bridge void *)item : [item hash];
+	return itemHash ^ (number * 31);
+}
+
+- (BOOL)isEqual:(id)another
+{
+	if (![another isKindOfClass:[ZDCOrderOccurrence class]]) return NO;
+	
+	ZDCOrderOccurrence *other = (ZDCOrderOccurrence *)another;
+	if (number != other->number) return NO;
+	
+	return matchIdentical ? (item == other->item) : [item isEqual:other->item];
+}
+
+@end
+
+static NSArray<ZDCOrderOccurrence*> *ZDCOrderOccurrences(NSArray<id> *order, BOOL matchIdentical)
+{
+	NSMapTable<id, NSNumber*> *counts = matchIdentical
+	  ? [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+	                          valueOptions:NSPointerFunctionsStrongMemory]
+	  : [NSMapTable strongToStrongObjectsMapTable];
+	
+	NSMutableArray<ZDCOrderOccurrence*> *result = [NSMutableArray arrayWithCapacity:order.count];
+	
+	for (id item in order)
+	{
+		ZDCOrderOccurrence *occurrence = [[ZDCOrderOccurrence alloc] init];
+		occurrence->item = item;
+		occurrence->number = [[counts objectForKey:item] unsignedIntegerValue];
+		occurrence->matchIdentical = matchIdentical;
+		
+		[counts setObject:@(occurrence->number + 1) forKey:item];
+		[result addObject:occurrence];
+	}
+	
+	return result;
+}
+
+/**
+ * Used by the estimator.
+ * If both lists contain interned keys, then keys are compared by pointer only. Otherwise via `isEqual:`.
+ */
+static inline BOOL ZDCOrderKeysEqual(id key1, id key2, BOOL interned)
+{
+	return interned ? (key1 == key2) : [key1 isEqual:key2];
+}
+
+static inline NSUInteger ZDCOrderIndexOfKey(NSArray<id> *array, id key, NSRange range, BOOL interned)
+{
+	return interned ? ZDCIndexOfInternedKeyInRange(array, key, range) : [array indexOfObject:key inRange:range];
+}
 
 @implementation ZDCOrder
 
+/**
+ * See header file for documentation.
+ */
++ (NSArray<id> *)estimateChangesetFrom:(NSArray<id> *)src
+                                    to:(NSArray<id> *)dst
+                                 hints:(NSSet<id> *)hints
+{
+	return [self estimateChangesetFrom:src to:dst hints:hints interned:NO];
+}
+
 /**
  * See header file for documentation.
  */
 + (NSArray<id> *)estimateChangesetFrom:(NSArray<id> *)inSrc
                                     to:(NSArray<id> *)dst
                                  hints:(NSSet<id> *)hints
+                              interned:(BOOL)interned
 {
+	ZDC_TRACE_SCOPE(trace, "ZDCOrder", "estimateChangeset");
+	ZDC_TRACE_COUNTER("ZDCOrder", "estimateChangeset: count", inSrc.count);
+	
 	// Sanity checks
 	
 	NSUInteger const count = inSrc.count;
@@ -32,7 +127,7 @@
 		
 		for (id obj in inSrc)
 		{
-			NSUInteger idx = [dstCopy indexOfObject:obj];
+			NSUInteger idx = ZDCOrderIndexOfKey(dstCopy, obj, NSMakeRange(0, dstCopy.count), interned);
 			if (idx == NSNotFound)
 			{
 				mismatch = YES;
@@ -73,15 +168,18 @@
 		NSMutableDictionary *hints_idx = [NSMutableDictionary dictionaryWithCapacity:hints.count];
 		NSMutableArray *hints_order = [NSMutableArray arrayWithCapacity:hints.count];
 		
-		for (id key in hints)
+		for (id hint in hints)
 		{
-			NSUInteger idx = [dst indexOfObject:key];
+			NSUInteger idx = [dst indexOfObject:hint];
 			if (idx != NSNotFound)
 			{
+				// The hints may not be interned, so we use the instance from the list.
+				id key = dst[idx];
+				
 				hints_idx[key] = @(idx);
 				[hints_order addObject:key];
 				
-				idx = [loopSrc indexOfObject:key];
+				idx = ZDCOrderIndexOfKey(loopSrc, key, NSMakeRange(0, loopSrc.count), interned);
 				[loopSrc removeObjectAtIndex:idx];
 			}
 		}
@@ -145,9 +243,9 @@
 				id key_src = src[i];
 				id key_dst = dst[i];
 				
-				if (![key_src isEqual:key_dst])
+				if (!ZDCOrderKeysEqual(key_src, key_dst, interned))
 				{
-					NSUInteger idx = [src indexOfObject:key_dst inRange:NSMakeRange(i+1, count-i-1)];
+					NSUInteger idx = ZDCOrderIndexOfKey(src, key_dst, NSMakeRange(i+1, count-i-1), interned);
 					
 					[src removeObjectAtIndex:idx];
 					[src insertObject:key_dst atIndex:i];
@@ -175,9 +273,9 @@
 				id key_src = src[i];
 				id key_dst = dst[i];
 				
-				if (![key_src isEqual:key_dst])
+				if (!ZDCOrderKeysEqual(key_src, key_dst, interned))
 				{
-					NSUInteger idx = [src indexOfObject:key_dst inRange:NSMakeRange(0, i)];
+					NSUInteger idx = ZDCOrderIndexOfKey(src, key_dst, NSMakeRange(0, i), interned);
 					
 					[src removeObjectAtIndex:idx];
 					[src insertObject:key_dst atIndex:i];
@@ -224,6 +322,606 @@
 	return result;
 }
 
+/**
+ * See header file for documentation.
+ */
++ (NSIndexSet *)indexesOfLongestIncreasingSubsequence:(const NSUInteger *)values count:(NSUInteger)count
+{
+	ZDC_TRACE_SCOPE(trace, "ZDCOrder", "longestIncreasingSubsequence");
+	ZDC_TRACE_COUNTER("ZDCOrder", "longestIncreasingSubsequence: count", count);
+	
+	NSMutableIndexSet *result = [[NSMutableIndexSet alloc] init];
+	if (count == 0) {
+		return result;
+	}
+	
+	// Standard patience sorting technique:
+	//
+	// tails[k] : position of the smallest tail value, of all increasing subsequences of length (k+1)
+	// prev[i]  : position of the item that precedes values[i] within its subsequence
+	
+	NSUInteger *tails = malloc(count * sizeof(NSUInteger));
+	NSUInteger *prev = malloc(count * sizeof(NSUInteger));
+	NSUInteger length = 0;
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		NSUInteger const value = values[i];
+		
+		// Binary search for the first subsequence whose tail is >= value
+		
+		NSUInteger lo = 0;
+		NSUInteger hi = length;
+		while (lo < hi)
+		{
+			NSUInteger mid = lo + ((hi - lo) / 2);
+			if (values[tails[mid]] < value)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		
+		prev[i] = (lo > 0) ? tails[lo - 1] : NSNotFound;
+		tails[lo] = i;
+		
+		if (lo == length) {
+			length++;
+		}
+	}
+	
+	NSUInteger i = tails[length - 1];
+	while (i != NSNotFound)
+	{
+		[result addIndex:i];
+		i = prev[i];
+	}
+	
+	free(tails);
+	free(prev);
+	
+	return result;
+}
+
+/**
+ * See header file for documentation.
+ */
++ (NSMutableDictionary<id, NSNumber*> *)movedIndexesFromOrder:(NSArray<id> *)originalOrder
+                                                      toOrder:(NSArray<id> *)order
+{
+	NSUInteger const count = order.count;
+	NSAssert(originalOrder.count == count, @"The orders must contain the same set of keys");
+	
+	NSMutableDictionary<id, NSNumber*> *result = [NSMutableDictionary dictionary];
+	if (count == 0) {
+		return result;
+	}
+	
+	NSMutableDictionary<id, NSNumber*> *originalIdxs = [NSMutableDictionary dictionaryWithCapacity:count];
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		originalIdxs[originalOrder[idx]] = @(idx);
+	}
+	
+	NSUInteger *previousIdxs = malloc(count * sizeof(NSUInteger));
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		previousIdxs[idx] = [originalIdxs[order[idx]] unsignedIntegerValue];
+	}
+	
+	NSIndexSet *inOrder = [self indexesOfLongestIncreasingSubsequence:previousIdxs count:count];
+	
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		if (![inOrder containsIndex:idx])
+		{
+			result[order[idx]] = @(previousIdxs[idx]);
+		}
+	}
+	
+	free(previousIdxs);
+	return result;
+}
+
+/**
+ * See header file for documentation.
+ */
++ (NSMutableArray<id> *)filterOrder:(NSArray<id> *)order keys:(NSSet<id> *)keys
+{
+	NSMutableArray<id> *result = [NSMutableArray arrayWithCapacity:MIN(order.count, keys.count)];
+	
+	for (id key in order)
+	{
+		if ([keys containsObject:key]) {
+			[result addObject:key];
+		}
+	}
+	
+	return result;
+}
+
+/**
+ * See header file for documentation.
+ */
++ (void)reconcileLocalOrder:(NSArray<id> *)localOrder
+                 cloudOrder:(NSArray<id> *)cloudOrder
+                movedRemote:(NSSet<id> *)movedRemote
+              identityFirst:(BOOL)identityFirst
+                 usingBlock:(void (NS_NOESCAPE ^)(id key, id _Nullable prvKey))block
+{
+	ZDC_TRACE_SCOPE(trace, "ZDCOrder", "reconcileOrder");
+	ZDC_TRACE_COUNTER("ZDCOrder", "reconcileOrder: count", cloudOrder.count);
+	
+	NSUInteger const localCount = localOrder.count;
+	NSUInteger const cloudCount = cloudOrder.count;
+	
+	// Invariant:
+	//
+	// Both lists share the merged prefix.
+	// The remainder of each list is its original order, minus the keys within the merged prefix.
+	// So each cursor points to the first key (within its list) that hasn't been placed yet.
+	//
+	// A key that's placed from the front of both lists can never be seen again.
+	// So `placed` only needs to contain the keys that were pulled forward from one of the lists.
+	
+	NSMutableSet<id> *placed = [NSMutableSet set];
+	
+	NSUInteger localIdx = 0;
+	NSUInteger cloudIdx = 0;
+	id prvKey = nil;
+	
+	while (YES)
+	{
+		while (localIdx < localCount && [placed containsObject:localOrder[localIdx]]) {
+			localIdx++;
+		}
+		while (cloudIdx < cloudCount && [placed containsObject:cloudOrder[cloudIdx]]) {
+			cloudIdx++;
+		}
+		
+		if (localIdx >= localCount || cloudIdx >= cloudCount) {
+			break;
+		}
+		
+		id key_local = localOrder[localIdx];
+		id key_remote = cloudOrder[cloudIdx];
+		
+		BOOL const keysDiffer = identityFirst ? (key_remote != key_local) : ![key_remote isEqual:key_local];
+		if (!keysDiffer)
+		{
+			localIdx++;
+			cloudIdx++;
+			prvKey = key_local;
+		}
+		else if ([movedRemote containsObject:key_remote])
+		{
+			// Remote wins.
+			// The remote key gets pulled forward within the local list (and within the caller's storage).
+			
+			block(key_remote, prvKey);
+			
+			[placed addObject:key_remote];
+			cloudIdx++;
+			prvKey = key_remote;
+		}
+		else
+		{
+			// Local wins.
+			// The local key gets pulled forward within the cloud list (which is only a working copy).
+			
+			[placed addObject:key_local];
+			localIdx++;
+			prvKey = key_local;
+		}
+	}
+}
+
+/**
+ * See header file for documentation.
+ */
++ (NSMutableArray<id> *)rebaseOrder:(NSArray<id> *)inBaseOrder
+                          fromOrder:(NSArray<id> *)inFromOrder
+                            toOrder:(NSArray<id> *)inToOrder
+                     matchIdentical:(BOOL)matchIdentical
+{
+	ZDC_TRACE_SCOPE(trace, "ZDCOrder", "rebaseOrder");
+	ZDC_TRACE_COUNTER("ZDCOrder", "rebaseOrder: count", inToOrder.count);
+	
+	NSArray<ZDCOrderOccurrence*> *baseOrder = ZDCOrderOccurrences(inBaseOrder, matchIdentical);
+	NSArray<ZDCOrderOccurrence*> *fromOrder = ZDCOrderOccurrences(inFromOrder, matchIdentical);
+	NSArray<ZDCOrderOccurrence*> *toOrder   = ZDCOrderOccurrences(inToOrder,   matchIdentical);
+	
+	NSSet<ZDCOrderOccurrence*> *baseKeys = [NSSet setWithArray:baseOrder];
+	NSSet<ZDCOrderOccurrence*> *fromKeys = [NSSet setWithArray:fromOrder];
+	NSSet<ZDCOrderOccurrence*> *toKeys   = [NSSet setWithArray:toOrder];
+	
+	// Step 1 of 3:
+	//
+	// Find the items that were added or moved (between fromOrder & toOrder).
+	// These are the items that need to be placed.
+	//
+	// Moved items that aren't within the base order (i.e. they were added prior to fromOrder) are skipped,
+	// since they're still added items.
+	
+	NSMutableSet<ZDCOrderOccurrence*> *placedKeys = [NSMutableSet set];
+	for (ZDCOrderOccurrence *key in toOrder)
+	{
+		if (![fromKeys containsObject:key]) {
+			[placedKeys addObject:key];
+		}
+	}
+	
+	NSArray<ZDCOrderOccurrence*> *keptFrom = [self filterOrder:fromOrder keys:toKeys];
+	NSArray<ZDCOrderOccurrence*> *keptTo = [self filterOrder:toOrder keys:fromKeys];
+	
+	for (ZDCOrderOccurrence *key in [self movedIndexesFromOrder:keptFrom toOrder:keptTo])
+	{
+		if ([baseKeys containsObject:key]) {
+			[placedKeys addObject:key];
+		}
+	}
+	
+	// Step 2 of 3:
+	//
+	// Start with the base order, minus the items that were removed, and minus the items that will be placed.
+	// Items that aren't within fromOrder (i.e. they were removed prior to fromOrder) stay where they are.
+	
+	NSMutableArray<ZDCOrderOccurrence*> *anchors = [NSMutableArray arrayWithCapacity:baseOrder.count];
+	NSMutableSet<ZDCOrderOccurrence*> *anchorKeys = [NSMutableSet setWithCapacity:baseOrder.count];
+	
+	for (ZDCOrderOccurrence *key in baseOrder)
+	{
+		BOOL const wasRemoved = [fromKeys containsObject:key] && ![toKeys containsObject:key];
+		
+		if (!wasRemoved && ![placedKeys containsObject:key])
+		{
+			[anchors addObject:key];
+			[anchorKeys addObject:key];
+		}
+	}
+	
+	// Step 3 of 3:
+	//
+	// Place each item immediately after the item that precedes it within toOrder.
+	//
+	// Rather than inserting into the result one-at-a-time (which is quadratic),
+	// we group the placed items by the anchor they follow, and then build the result in a single pass.
+	// Since toOrder is walked from first to last, each group is already in the proper order.
+	
+	NSMutableArray<ZDCOrderOccurrence*> *frontKeys = [NSMutableArray array];
+	NSMutableDictionary<ZDCOrderOccurrence*, NSMutableArray<ZDCOrderOccurrence*>*> *groups =
+	  [NSMutableDictionary dictionaryWithCapacity:placedKeys.count];
+	NSMutableDictionary<ZDCOrderOccurrence*, id> *anchorOf =
+	  [NSMutableDictionary dictionaryWithCapacity:placedKeys.count];
+	
+	ZDCOrderOccurrence *prvKey = nil;
+	for (ZDCOrderOccurrence *key in toOrder)
+	{
+		if ([placedKeys containsObject:key])
+		{
+			id anchor = [NSNull null];
+			if (prvKey) {
+				anchor = [anchorKeys containsObject:prvKey] ? prvKey : anchorOf[prvKey];
+			}
+			
+			anchorOf[key] = anchor;
+			
+			if (anchor == [NSNull null])
+			{
+				[frontKeys addObject:key];
+			}
+			else
+			{
+				NSMutableArray<ZDCOrderOccurrence*> *group = groups[anchor];
+				if (group == nil) {
+					group = [NSMutableArray array];
+					groups[anchor] = group;
+				}
+				[group addObject:key];
+			}
+			
+			prvKey = key;
+		}
+		else if ([anchorKeys containsObject:key])
+		{
+			prvKey = key;
+		}
+	}
+	
+	NSMutableArray<id> *result = [NSMutableArray arrayWithCapacity:(anchors.count + placedKeys.count)];
+	
+	for (ZDCOrderOccurrence *key in frontKeys)
+	{
+		[result addObject:key->item];
+	}
+	for (ZDCOrderOccurrence *anchor in anchors)
+	{
+		[result addObject:anchor->item];
+		
+		for (ZDCOrderOccurrence *key in groups[anchor])
+		{
+			[result addObject:key->item];
+		}
+	}
+	
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Block Moves
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for documentation.
+ */
++ (NSArray<NSNumber*> *)blockMoveWithIndex:(NSUInteger)previousIdx length:(NSUInteger)length
+{
+	return @[ @(kBlockMoveVersion), @(previousIdx), @(length) ];
+}
+
+/**
+ * See header file for documentation.
+ */
++ (BOOL)getBlockMove:(id)value index:(NSUInteger *)outPreviousIdx length:(NSUInteger *)outLength
+{
+	if (![value isKindOfClass:[NSArray class]]) return NO;
+	
+	NSArray *entry = (NSArray *)value;
+	if (entry.count != 3) return NO;
+	
+	for (id component in entry)
+	{
+		if (![component isKindOfClass:[NSNumber class]]) return NO;
+	}
+	
+	if ([entry[0] integerValue] != kBlockMoveVersion) {
+		return NO; // unknown version
+	}
+	
+	NSUInteger const previousIdx = [entry[1] unsignedIntegerValue];
+	NSUInteger const length = [entry[2] unsignedIntegerValue];
+	
+	if ((length == 0) || (previousIdx > (NSUInteger)NSIntegerMax) || (length > (NSUInteger)NSIntegerMax - previousIdx)) {
+		return NO;
+	}
+	
+	if (outPreviousIdx) *outPreviousIdx = previousIdx;
+	if (outLength) *outLength = length;
+	return YES;
+}
+
+/**
+ * Returns YES if the dictionary contains any block-move entries.
+ */
++ (BOOL)containsBlockMoves:(NSDictionary *)moves
+{
+	__block BOOL result = NO;
+	[moves enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+		
+		if (![value isKindOfClass:[NSNumber class]]) {
+			result = YES;
+			*stop = YES;
+		}
+	}];
+	
+	return result;
+}
+
+/**
+ * See header file for documentation.
+ */
++ (NSDictionary<NSNumber*, id> *)compressMovedIndexes:(NSDictionary<NSNumber*, NSNumber*> *)moved
+{
+	if (moved.count < kBlockMoveMinimumLength) {
+		return [moved copy];
+	}
+	
+	NSArray<NSNumber*> *sortedKeys = [[moved allKeys] sortedArrayUsingSelector:@selector(compare:)];
+	NSUInteger const count = sortedKeys.count;
+	
+	NSMutableDictionary<NSNumber*, id> *result = [NSMutableDictionary dictionaryWithCapacity:count];
+	
+	NSUInteger i = 0;
+	while (i < count)
+	{
+		NSUInteger const currentIdx = [sortedKeys[i] unsignedIntegerValue];
+		NSUInteger const previousIdx = [moved[sortedKeys[i]] unsignedIntegerValue];
+		
+		NSUInteger length = 1;
+		while ((i + length < count)
+		    && ([sortedKeys[i + length] unsignedIntegerValue] == currentIdx + length)
+		    && ([moved[sortedKeys[i + length]] unsignedIntegerValue] == previousIdx + length))
+		{
+			length++;
+		}
+		
+		if (length >= kBlockMoveMinimumLength)
+		{
+			result[sortedKeys[i]] = [self blockMoveWithIndex:previousIdx length:length];
+		}
+		else
+		{
+			for (NSUInteger j = i; j < i + length; j++)
+			{
+				result[sortedKeys[j]] = moved[sortedKeys[j]];
+			}
+		}
+		
+		i += length;
+	}
+	
+	return [result copy];
+}
+
+/**
+ * See header file for documentation.
+ */
++ (nullable NSDictionary<NSNumber*, NSNumber*> *)expandMovedIndexes:(NSDictionary<NSNumber*, id> *)moved
+{
+	if (![self containsBlockMoves:moved]) {
+		return moved;
+	}
+	
+	NSMutableDictionary<NSNumber*, NSNumber*> *result = [NSMutableDictionary dictionaryWithCapacity:moved.count];
+	
+	for (NSNumber *num in moved)
+	{
+		id value = moved[num];
+		
+		if ([value isKindOfClass:[NSNumber class]])
+		{
+			if (result[num]) return nil; // overlaps a block
+			result[num] = value;
+			continue;
+		}
+		
+		NSUInteger previousIdx = 0;
+		NSUInteger length = 0;
+		if (![self getBlockMove:value index:&previousIdx length:&length]) {
+			return nil;
+		}
+		
+		NSUInteger const currentIdx = num.unsignedIntegerValue;
+		if ((currentIdx > (NSUInteger)NSIntegerMax) || (length > (NSUInteger)NSIntegerMax - currentIdx)) {
+			return nil;
+		}
+		
+		for (NSUInteger j = 0; j < length; j++)
+		{
+			NSNumber *key = @(currentIdx + j);
+			
+			if (result[key]) return nil; // overlapping entries
+			result[key] = @(previousIdx + j);
+		}
+	}
+	
+	return result;
+}
+
+/**
+ * Moves the given run into the result, as either a block-move entry or individual entries.
+ * Returns the number of keys within the run.
+ */
+static NSUInteger ZDCFlushRun(NSMutableArray<id> *run,
+                              NSUInteger originalIdx,
+                              NSDictionary<id, NSNumber*> *indexes,
+                              NSMutableDictionary<id, id> *result)
+{
+	NSUInteger const length = run.count;
+	if (length == 0) return 0;
+	
+	if (length >= kBlockMoveMinimumLength)
+	{
+		result[run[0]] = [ZDCOrder blockMoveWithIndex:originalIdx length:length];
+	}
+	else
+	{
+		for (id key in run)
+		{
+			result[key] = indexes[key];
+		}
+	}
+	
+	[run removeAllObjects];
+	return length;
+}
+
+/**
+ * See header file for documentation.
+ */
++ (NSDictionary<id, id> *)compressMovedKeys:(NSDictionary<id, NSNumber*> *)indexes
+                                      order:(NSArray<id> *)order
+                                  addedKeys:(nullable NSSet<id> *)addedKeys
+{
+	if (indexes.count < kBlockMoveMinimumLength) {
+		return [indexes copy];
+	}
+	
+	NSMutableDictionary<id, id> *result = [NSMutableDictionary dictionaryWithCapacity:indexes.count];
+	
+	NSMutableArray<id> *run = [NSMutableArray array];
+	NSUInteger runOriginalIdx = 0;
+	NSUInteger covered = 0;
+	
+	for (id key in order)
+	{
+		if ([addedKeys containsObject:key]) {
+			continue; // not part of the order when the moves are undone
+		}
+		
+		NSNumber *num = indexes[key];
+		
+		if (num && (run.count > 0) && (num.unsignedIntegerValue == runOriginalIdx + run.count))
+		{
+			[run addObject:key];
+			continue;
+		}
+		
+		covered += ZDCFlushRun(run, runOriginalIdx, indexes, result);
+		
+		if (num)
+		{
+			[run addObject:key];
+			runOriginalIdx = num.unsignedIntegerValue;
+		}
+	}
+	
+	covered += ZDCFlushRun(run, runOriginalIdx, indexes, result);
+	
+	if (covered != indexes.count)
+	{
+		// Some keys aren't within the order (shouldn't happen).
+		// The per-key format is always valid, so fall back to it.
+		return [indexes copy];
+	}
+	
+	return [result copy];
+}
+
+/**
+ * See header file for documentation.
+ */
++ (nullable NSDictionary<id, NSNumber*> *)expandMovedKeys:(NSDictionary<id, id> *)indexes order:(NSArray<id> *)order
+{
+	if (![self containsBlockMoves:indexes]) {
+		return indexes;
+	}
+	
+	NSMutableDictionary<id, NSNumber*> *result = [NSMutableDictionary dictionaryWithCapacity:indexes.count];
+	
+	for (id key in indexes)
+	{
+		id value = indexes[key];
+		
+		if ([value isKindOfClass:[NSNumber class]])
+		{
+			if (result[key]) return nil; // overlaps a block
+			result[key] = value;
+			continue;
+		}
+		
+		NSUInteger originalIdx = 0;
+		NSUInteger length = 0;
+		if (![self getBlockMove:value index:&originalIdx length:&length]) {
+			return nil;
+		}
+		
+		NSUInteger const firstIdx = [order indexOfObject:key];
+		if ((firstIdx == NSNotFound) || (length > order.count - firstIdx)) {
+			return nil;
+		}
+		
+		for (NSUInteger j = 0; j < length; j++)
+		{
+			id runKey = order[firstIdx + j];
+			
+			if (result[runKey]) return nil; // overlapping entries
+			result[runKey] = @(originalIdx + j);
+		}
+	}
+	
+	return result;
+}
+
 + (NSException *)invalidArraysException:(NSString *)details
 {
 	NSDictionary *userInfo = @{
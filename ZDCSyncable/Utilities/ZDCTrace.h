@@ -0,0 +1,180 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Lightweight tracing of the expensive phases within ZDCSyncable.
+ *
+ * The library emits begin/end spans around operations such as `_undo:`, the individual steps of
+ * `mergeCloudVersion:withPendingChangesets:error:`, original-order reconstruction & ZDCOrder estimation.
+ * Along with counters for the number of elements involved.
+ *
+ * Events are delivered to a sink, which you register via `ZDCTraceSetSink()`.
+ * When no sink is registered (the default), each trace point costs a single load & branch.
+ *
+ * Tracing can also be removed entirely at compile time,
+ * by building the library with the preprocessor flag: ZDC_TRACE_ENABLED=0
+ *
+ * A default sink is included, which writes Chrome trace-event JSON to a file.
+ * The resulting file can be inspected with any trace viewer that supports the format
+ * (e.g. chrome://tracing or https://ui.perfetto.dev), on any platform.
+ */
+
+#ifndef ZDC_TRACE_ENABLED
+#define ZDC_TRACE_ENABLED 1
+#endif
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(uint8_t, ZDCTraceEventType) {
+	ZDCTraceEventType_Begin,
+	ZDCTraceEventType_End,
+	ZDCTraceEventType_Counter
+} NS_SWIFT_NAME(ZDCTraceEventType_ObjC);
+
+typedef struct ZDCTraceEvent {
+	
+	/** Begin/End of a span, or a counter. */
+	ZDCTraceEventType type;
+	
+	/** The emitting component (e.g. "ZDCArray"). Always a static string. */
+	const char *category;
+	
+	/** The name of the span or counter (e.g. "mergeCloudVersion: step 2 of 4"). Always a static string. */
+	const char *name;
+	
+	/** Monotonic timestamp, in nanoseconds. */
+	uint64_t timestamp;
+	
+	/** The emitting thread. */
+	uint64_t threadID;
+	
+	/** The value of the counter (zero for spans). */
+	int64_t value;
+	
+} ZDCTraceEvent NS_SWIFT_NAME(ZDCTraceEvent_ObjC);
+
+/**
+ * A sink receives every trace event.
+ * It may be invoked concurrently from multiple threads, and should be fast.
+ */
+typedef void (*ZDCTraceSink)(const ZDCTraceEvent *event, void *_Nullable context);
+
+/**
+ * Registers the sink that receives trace events. Pass NULL to disable tracing.
+ *
+ * The sink may be changed at any time.
+ * The sink & context are always delivered together, so a sink is never invoked with another sink's context.
+ * However, threads which are in the middle of emitting an event may still deliver it to the previous sink.
+ * So the previous context must not be freed until you know that no emit is still running
+ * (e.g. once the threads that may emit events have finished their work).
+ */
+FOUNDATION_EXPORT void ZDCTraceSetSink(ZDCTraceSink _Nullable sink, void *_Nullable context);
+
+/**
+ * Delivers an event to the registered sink (if any).
+ * You don't normally invoke this directly. Use the ZDC_TRACE_X macros instead.
+ */
+FOUNDATION_EXPORT void ZDCTraceEmit(ZDCTraceEventType type, const char *category, const char *name, int64_t value);
+
+/**
+ * Starts writing trace events (in Chrome trace-event JSON format) to the given file,
+ * and registers the corresponding sink.
+ *
+ * @return YES if the file was opened, NO otherwise.
+ */
+FOUNDATION_EXPORT BOOL ZDCTraceStartChromeTrace(const char *path);
+
+/**
+ * Unregisters the Chrome trace sink (if it's the registered sink), and closes the file.
+ */
+FOUNDATION_EXPORT void ZDCTraceStopChromeTrace(void);
+
+#pragma mark Internal
+
+/** Internal - an immutable {sink, context} pair, published by ZDCTraceSetSink(). */
+typedef struct ZDCTraceRegistration {
+	ZDCTraceSink sink;
+	void *_Nullable context;
+} ZDCTraceRegistration;
+
+/** Internal - use ZDCTraceSetSink(). */
+FOUNDATION_EXPORT const ZDCTraceRegistration *_Nullable ZDCTraceActiveRegistration;
+
+static inline BOOL ZDCTraceIsActive(void)
+{
+	return (__atomic_load_n(&ZDCTraceActiveRegistration, __ATOMIC_RELAXED) != NULL);
+}
+
+typedef struct ZDCTraceScope {
+	const char *category;
+	const char *name;
+	BOOL active;
+} ZDCTraceScope;
+
+static inline ZDCTraceScope ZDCTraceScopeBegin(const char *category, const char *name)
+{
+	ZDCTraceScope scope = { category, name, NO };
+	if (__builtin_expect(ZDCTraceIsActive(), 0))
+	{
+		ZDCTraceEmit(ZDCTraceEventType_Begin, category, name, 0);
+		scope.active = YES;
+	}
+	return scope;
+}
+
+static inline void ZDCTraceScopeEnd(ZDCTraceScope *scope)
+{
+	if (scope->active)
+	{
+		ZDCTraceEmit(ZDCTraceEventType_End, scope->category, scope->name, 0);
+		scope->active = NO;
+	}
+}
+
+static inline void ZDCTraceScopeNext(ZDCTraceScope *scope, const char *name)
+{
+	ZDCTraceScopeEnd(scope);
+	*scope = ZDCTraceScopeBegin(scope->category, name);
+}
+
+#pragma mark Macros
+
+#if ZDC_TRACE_ENABLED
+
+/**
+ * Begins a span, which ends automatically when the enclosing scope exits (including early returns).
+ * The `var` is the name of the local variable that holds the span.
+ */
+#define ZDC_TRACE_SCOPE(var, category, name) \
+  __attribute__((cleanup(ZDCTraceScopeEnd), unused)) ZDCTraceScope var = ZDCTraceScopeBegin(category, name)
+
+/**
+ * Ends the span held by `var`, and begins a new span (with the same category) in its place.
+ * This is useful for multi-step pipelines.
+ */
+#define ZDC_TRACE_NEXT(var, name) \
+  ZDCTraceScopeNext(&var, name)
+
+/**
+ * Emits a counter value.
+ */
+#define ZDC_TRACE_COUNTER(category, name, value) \
+  do { \
+    if (__builtin_expect(ZDCTraceIsActive(), 0)) { \
+      ZDCTraceEmit(ZDCTraceEventType_Counter, category, name, (int64_t)(value)); \
+    } \
+  } while (0)
+
+#else
+
+#define ZDC_TRACE_SCOPE(var, category, name)
+#define ZDC_TRACE_NEXT(var, name)
+#define ZDC_TRACE_COUNTER(category, name, value) do {} while (0)
+
+#endif
+
+NS_ASSUME_NONNULL_END
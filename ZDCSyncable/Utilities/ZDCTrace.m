@@ -0,0 +1,189 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
+#import <pthread.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <unistd.h>
+
+const ZDCTraceRegistration *ZDCTraceActiveRegistration = NULL;
+
+void ZDCTraceSetSink(ZDCTraceSink sink, void *context)
+{
+	// The sink & context are published together, as a single immutable pair,
+	// so an emitting thread always sees a matching sink & context.
+	//
+	// A previous pair is never freed, since an emitting thread may still be reading it.
+	// (The sink is rarely changed, and each pair is only a couple of pointers.)
+	
+	ZDCTraceRegistration *registration = NULL;
+	if (sink)
+	{
+		registration = malloc(sizeof(ZDCTraceRegistration));
+		registration->sink = sink;
+		registration->context = context;
+	}
+	
+	__atomic_store_n(&ZDCTraceActiveRegistration, registration, __ATOMIC_RELEASE);
+}
+
+static uint64_t ZDCTraceTimestamp(void)
+{
+	static mach_timebase_info_data_t timebase;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		mach_timebase_info(&timebase);
+	});
+	
+	return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
+void ZDCTraceEmit(ZDCTraceEventType type, const char *category, const char *name, int64_t value)
+{
+	const ZDCTraceRegistration *registration = __atomic_load_n(&ZDCTraceActiveRegistration, __ATOMIC_ACQUIRE);
+	if (registration == NULL) return;
+	
+	ZDCTraceEvent event;
+	event.type = type;
+	event.category = category;
+	event.name = name;
+	event.timestamp = ZDCTraceTimestamp();
+	event.value = value;
+	
+	uint64_t threadID = 0;
+	pthread_threadid_np(NULL, &threadID);
+	event.threadID = threadID;
+	
+	registration->sink(&event, registration->context);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Chrome Trace Sink
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static pthread_mutex_t chromeTraceLock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *chromeTraceFile = NULL;
+static BOOL chromeTraceHasEvents = NO;
+
+/**
+ * Writes a string literal, escaping as required by JSON.
+ * (The names we're given are static strings, so this is just a safety net.)
+ */
+static void ZDCChromeTraceWriteString(FILE *file, const char *str)
+{
+	fputc('"', file);
+	for (const char *c = str; *c; c++)
+	{
+		if (*c == '"' || *c == '\\') {
+			fputc('\\', file);
+			fputc(*c, file);
+		}
+		else if ((unsigned char)*c < 0x20) {
+			fprintf(file, "\\u%04x", (unsigned int)*c);
+		}
+		else {
+			fputc(*c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+static void ZDCChromeTraceSink(const ZDCTraceEvent *event, void *context)
+{
+	pthread_mutex_lock(&chromeTraceLock);
+	
+	FILE *file = chromeTraceFile;
+	if (file)
+	{
+		const char *phase;
+		switch (event->type)
+		{
+			case ZDCTraceEventType_Begin : phase = "B"; break;
+			case ZDCTraceEventType_End   : phase = "E"; break;
+			default                      : phase = "C"; break;
+		}
+		
+		fputs(chromeTraceHasEvents ? ",\n" : "\n", file);
+		chromeTraceHasEvents = YES;
+		
+		fputs("{\"name\":", file);
+		ZDCChromeTraceWriteString(file, event->name);
+		fputs(",\"cat\":", file);
+		ZDCChromeTraceWriteString(file, event->category);
+		
+		// The format uses microseconds
+		fprintf(file, ",\"ph\":\"%s\",\"ts\":%llu.%03llu,\"pid\":%d,\"tid\":%llu",
+		        phase,
+		        (unsigned long long)(event->timestamp / 1000),
+		        (unsigned long long)(event->timestamp % 1000),
+		        (int)getpid(),
+		        (unsigned long long)event->threadID);
+		
+		if (event->type == ZDCTraceEventType_Counter)
+		{
+			fputs(",\"args\":{", file);
+			ZDCChromeTraceWriteString(file, event->name);
+			fprintf(file, ":%lld}", (long long)event->value);
+		}
+		
+		fputc('}', file);
+	}
+	
+	pthread_mutex_unlock(&chromeTraceLock);
+}
+
+BOOL ZDCTraceStartChromeTrace(const char *path)
+{
+	FILE *file = fopen(path, "w");
+	if (file == NULL) return NO;
+	
+	fputs("{\"traceEvents\":[", file);
+	
+	FILE *prevFile = NULL;
+	
+	pthread_mutex_lock(&chromeTraceLock);
+	{
+		prevFile = chromeTraceFile;
+		
+		chromeTraceFile = file;
+		chromeTraceHasEvents = NO;
+	}
+	pthread_mutex_unlock(&chromeTraceLock);
+	
+	if (prevFile)
+	{
+		fputs("\n]}\n", prevFile);
+		fclose(prevFile);
+	}
+	
+	ZDCTraceSetSink(ZDCChromeTraceSink, NULL);
+	return YES;
+}
+
+void ZDCTraceStopChromeTrace(void)
+{
+	const ZDCTraceRegistration *registration = __atomic_load_n(&ZDCTraceActiveRegistration, __ATOMIC_ACQUIRE);
+	if (registration && registration->sink == ZDCChromeTraceSink) {
+		ZDCTraceSetSink(NULL, NULL);
+	}
+	
+	FILE *file = NULL;
+	
+	pthread_mutex_lock(&chromeTraceLock);
+	{
+		file = chromeTraceFile;
+		chromeTraceFile = NULL;
+	}
+	pthread_mutex_unlock(&chromeTraceLock);
+	
+	if (file)
+	{
+		fputs("\n]}\n", file);
+		fclose(file);
+	}
+}
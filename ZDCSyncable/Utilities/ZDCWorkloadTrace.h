@@ -0,0 +1,148 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+@class ZDCObject;
+@class ZDCWorkloadReplayResult;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Records the calls made on a ZDCObject (e.g. a container) into a compact trace file.
+ * The trace can later be re-executed by ZDCWorkloadReplayer (or the `zdc-replay` command-line tool),
+ * which turns a real-world editing session into a regression benchmark.
+ *
+ * Recording works via a proxy. You start recording an object, and then use the returned proxy in its place:
+ * ```
+ * ZDCWorkloadRecorder *recorder = [[ZDCWorkloadRecorder alloc] initWithURL:url error:&error];
+ * ZDCArray *array = [recorder startRecording:realArray];
+ *
+ * [array addObject:@"foo"];           // recorded
+ * NSDictionary *cs = [array changeset]; // recorded (along with the result)
+ *
+ * [recorder stopRecording:&error];
+ * ```
+ *
+ * Every call made through the proxy is recorded, along with its arguments & result.
+ * Calls the object makes internally (e.g. `undo:error:` invoking `changeset`) are not recorded,
+ * since they'll happen again naturally during replay.
+ *
+ * Some calls cannot be recorded, such as calls with block arguments (e.g. enumeration).
+ * These are still forwarded to the object, and are counted via `skippedCount`.
+ *
+ * @note Arguments & results are stored via NSKeyedArchiver, so they must support NSCoding.
+ *       Arguments are copied (if they support NSCopying) at the time of the call.
+ *
+ * @note For the replay to match, recording should start on an object without pending changes.
+ *       The change tracking info is not part of the recorded initial state.
+ */
+NS_SWIFT_NAME(ZDCWorkloadRecorder_ObjC)
+@interface ZDCWorkloadRecorder : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Creates a recorder that writes to the given file. An existing file is overwritten.
+ */
+- (nullable instancetype)initWithURL:(NSURL *)url error:(NSError *_Nullable *_Nullable)errPtr;
+
+/**
+ * Records the initial state of the given object (if it supports NSCoding),
+ * and returns a proxy that records every call before forwarding it to the object.
+ *
+ * A recorder can only record a single object.
+ */
+- (id)startRecording:(ZDCObject *)object;
+
+/**
+ * Records the final state of the object, and closes the file.
+ * Calls made through the proxy afterwards are still forwarded, but are no longer recorded.
+ */
+- (BOOL)stopRecording:(NSError *_Nullable *_Nullable)errPtr;
+
+/** The number of calls that have been recorded. */
+@property (nonatomic, readonly) NSUInteger recordedCount;
+
+/** The number of calls that were forwarded, but couldn't be recorded. */
+@property (nonatomic, readonly) NSUInteger skippedCount;
+
+@end
+
+/**
+ * Re-executes a trace (written by ZDCWorkloadRecorder) against a fresh object.
+ *
+ * Each call is timed, and its result is compared against the recorded result.
+ * Finally the end state of the object is compared against the recorded end state.
+ */
+NS_SWIFT_NAME(ZDCWorkloadReplayer_ObjC)
+@interface ZDCWorkloadReplayer : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithURL:(NSURL *)url;
+
+/**
+ * Replays the trace.
+ *
+ * @return
+ *   The result, or nil if the trace file couldn't be read.
+ *   Note that mismatches are reported via the result (they're not considered errors).
+ */
+- (nullable ZDCWorkloadReplayResult *)replay:(NSError *_Nullable *_Nullable)errPtr;
+
+@end
+
+/**
+ * Latency samples for a single operation, bucketed by powers of 2 (in nanoseconds).
+ */
+NS_SWIFT_NAME(ZDCLatencyHistogram_ObjC)
+@interface ZDCLatencyHistogram : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) uint64_t totalNanoseconds;
+@property (nonatomic, readonly) uint64_t minNanoseconds;
+@property (nonatomic, readonly) uint64_t maxNanoseconds;
+
+/**
+ * Returns an (upper bound) estimate of the given percentile, where percentile is in the range [0, 100].
+ */
+- (uint64_t)nanosecondsAtPercentile:(double)percentile;
+
+/**
+ * The number of samples within each bucket.
+ * Bucket N contains samples in the range [2^(N-1), 2^N) nanoseconds (and bucket 0 contains zero).
+ */
+@property (nonatomic, readonly) NSArray<NSNumber*> *buckets;
+
+@end
+
+NS_SWIFT_NAME(ZDCWorkloadReplayResult_ObjC)
+@interface ZDCWorkloadReplayResult : NSObject
+
+/** The class of the replayed object. */
+@property (nonatomic, readonly) NSString *className;
+
+/** The number of calls that were replayed. */
+@property (nonatomic, readonly) NSUInteger operationCount;
+
+/** Latency histograms, keyed by selector name. */
+@property (nonatomic, readonly) NSDictionary<NSString*, ZDCLatencyHistogram*> *latencies;
+
+/** Describes each call whose result didn't match the recording (e.g. a different changeset). */
+@property (nonatomic, readonly) NSArray<NSString*> *mismatches;
+
+/** Whether the end state matches the recording. (YES if the end state wasn't recorded.) */
+@property (nonatomic, readonly) BOOL finalStateMatches;
+
+/** Returns YES if there were no mismatches, and the final state matches. */
+@property (nonatomic, readonly) BOOL succeeded;
+
+/** A human readable report, including the histograms. */
+- (NSString *)report;
+
+@end
+
+NS_ASSUME_NONNULL_END
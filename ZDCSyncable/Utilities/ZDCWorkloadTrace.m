@@ -0,0 +1,936 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCWorkloadTrace.h"
+
+#import "ZDCObject.h"
+
+#import <mach/mach_time.h>
+
+/**
+ * File format:
+ *
+ * - magic (8 bytes)
+ * - followed by any number of chunks, where each chunk is:
+ *   - length (uint32, big endian)
+ *   - keyed archive of an array of entries
+ *
+ * Entries are dictionaries, using the keys below.
+ */
+static const char kTraceMagic[8] = { 'Z', 'D', 'C', 'W', 'T', 'R', 'C', '1' };
+
+static NSUInteger const kEntriesPerChunk = 256;
+
+static NSString *const kEntry_type      = @"t";
+static NSString *const kEntry_class     = @"c";
+static NSString *const kEntry_object    = @"o";
+static NSString *const kEntry_selector  = @"s";
+static NSString *const kEntry_arguments = @"a";
+static NSString *const kEntry_result    = @"r";
+
+static NSString *const kEntryType_begin = @"begin";
+static NSString *const kEntryType_call  = @"call";
+static NSString *const kEntryType_end   = @"end";
+
+static NSString *const kErrorDomain = @"ZDCWorkloadTrace";
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Utilities
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static NSError *ZDCWorkloadTraceError(NSInteger code, NSString *description)
+{
+	return [NSError errorWithDomain:kErrorDomain code:code userInfo:@{ NSLocalizedDescriptionKey: description }];
+}
+
+static uint64_t ZDCNanosecondsFromMachTicks(uint64_t ticks)
+{
+	static mach_timebase_info_data_t timebase;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		mach_timebase_info(&timebase);
+	});
+	
+	return ticks * timebase.numer / timebase.denom;
+}
+
+/**
+ * Skips method type qualifiers (const, in, out, oneway, etc).
+ */
+static const char *ZDCSkipTypeQualifiers(const char *type)
+{
+	while (*type != '\0' && strchr("rnNoORV", *type) != NULL) {
+		type++;
+	}
+	return type;
+}
+
+static NSNumber *ZDCNumberFromBuffer(const char *type, const void *buffer)
+{
+	switch (*type)
+	{
+		case 'c' : return @(*(const char *)buffer);
+		case 'C' : return @(*(const unsigned char *)buffer);
+		case 's' : return @(*(const short *)buffer);
+		case 'S' : return @(*(const unsigned short *)buffer);
+		case 'i' : return @(*(const int *)buffer);
+		case 'I' : return @(*(const unsigned int *)buffer);
+		case 'l' : return @(*(const long *)buffer);
+		case 'L' : return @(*(const unsigned long *)buffer);
+		case 'q' : return @(*(const long long *)buffer);
+		case 'Q' : return @(*(const unsigned long long *)buffer);
+		case 'B' : return @(*(const bool *)buffer);
+		case 'f' : return @(*(const float *)buffer);
+		case 'd' : return @(*(const double *)buffer);
+		default  : return nil;
+	}
+}
+
+static BOOL ZDCNumberToBuffer(NSNumber *number, const char *type, void *buffer)
+{
+	switch (*type)
+	{
+		case 'c' : *(char *)buffer               = number.charValue;             return YES;
+		case 'C' : *(unsigned char *)buffer      = number.unsignedCharValue;     return YES;
+		case 's' : *(short *)buffer              = number.shortValue;            return YES;
+		case 'S' : *(unsigned short *)buffer     = number.unsignedShortValue;    return YES;
+		case 'i' : *(int *)buffer                = number.intValue;              return YES;
+		case 'I' : *(unsigned int *)buffer       = number.unsignedIntValue;      return YES;
+		case 'l' : *(long *)buffer               = number.longValue;             return YES;
+		case 'L' : *(unsigned long *)buffer      = number.unsignedLongValue;     return YES;
+		case 'q' : *(long long *)buffer          = number.longLongValue;         return YES;
+		case 'Q' : *(unsigned long long *)buffer = number.unsignedLongLongValue; return YES;
+		case 'B' : *(bool *)buffer               = number.boolValue;             return YES;
+		case 'f' : *(float *)buffer              = number.floatValue;            return YES;
+		case 'd' : *(double *)buffer             = number.doubleValue;           return YES;
+		default  : return NO;
+	}
+}
+
+static BOOL ZDCIsObjectType(const char *type)
+{
+	// Note: blocks are encoded as "@?"
+	return (type[0] == '@' && type[1] != '?');
+}
+
+static BOOL ZDCIsOutObjectType(const char *type)
+{
+	// E.g. (NSError **)
+	return (type[0] == '^' && type[1] == '@');
+}
+
+static NSString *ZDCFormatNanoseconds(uint64_t ns)
+{
+	if (ns < 1000)       return [NSString stringWithFormat:@"%llu ns", (unsigned long long)ns];
+	if (ns < 1000000)    return [NSString stringWithFormat:@"%.1f us", (double)ns / 1000.0];
+	if (ns < 1000000000) return [NSString stringWithFormat:@"%.2f ms", (double)ns / 1000000.0];
+	
+	return [NSString stringWithFormat:@"%.2f s", (double)ns / 1000000000.0];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface ZDCWorkloadRecorder ()
+- (void)forwardInvocation:(NSInvocation *)invocation toTarget:(ZDCObject *)target;
+@end
+
+/**
+ * Stands in for the recorded object, and routes every call through the recorder.
+ */
+@interface ZDCRecordingProxy : NSProxy {
+@public
+
+	ZDCObject *target;
+	ZDCWorkloadRecorder *recorder;
+}
+@end
+
+@implementation ZDCRecordingProxy
+
+- (NSMethodSignature *)methodSignatureForSelector:(SEL)selector
+{
+	return [target methodSignatureForSelector:selector];
+}
+
+- (void)forwardInvocation:(NSInvocation *)invocation
+{
+	[recorder forwardInvocation:invocation toTarget:target];
+}
+
+// NSProxy implements these itself, so they must be explicitly forwarded.
+
+- (BOOL)isEqual:(id)another
+{
+	if ([another isKindOfClass:[ZDCRecordingProxy class]]) {
+		another = ((ZDCRecordingProxy *)another)->target;
+	}
+	return [target isEqual:another];
+}
+
+- (NSUInteger)hash
+{
+	return [target hash];
+}
+
+- (NSString *)description
+{
+	return [target description];
+}
+
+- (NSString *)debugDescription
+{
+	return [target debugDescription];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCWorkloadRecorder {
+	
+	NSFileHandle *fileHandle;
+	NSError *writeError;
+	
+	__weak ZDCObject *target;
+	BOOL isRecording;
+	
+	NSMutableArray<NSDictionary*> *pendingEntries;
+}
+
+@synthesize recordedCount = recordedCount;
+@synthesize skippedCount = skippedCount;
+
+- (nullable instancetype)initWithURL:(NSURL *)url error:(NSError **)errPtr
+{
+	NSParameterAssert(url != nil);
+	
+	if (![[NSFileManager defaultManager] createFileAtPath:url.path contents:nil attributes:nil])
+	{
+		if (errPtr) *errPtr = ZDCWorkloadTraceError(100, @"Unable to create trace file.");
+		return nil;
+	}
+	
+	NSError *error = nil;
+	NSFileHandle *handle = [NSFileHandle fileHandleForWritingToURL:url error:&error];
+	if (handle == nil)
+	{
+		if (errPtr) *errPtr = error;
+		return nil;
+	}
+	
+	if ((self = [super init]))
+	{
+		fileHandle = handle;
+		pendingEntries = [[NSMutableArray alloc] initWithCapacity:kEntriesPerChunk];
+		
+		[self writeData:[NSData dataWithBytes:kTraceMagic length:sizeof(kTraceMagic)]];
+	}
+	return self;
+}
+
+/**
+ * See header file for description.
+ */
+- (id)startRecording:(ZDCObject *)object
+{
+	NSParameterAssert(object != nil);
+	NSAssert(target == nil && fileHandle != nil, @"A recorder can only record a single object");
+	
+	target = object;
+	isRecording = YES;
+	
+	NSMutableDictionary *entry = [NSMutableDictionary dictionaryWithCapacity:3];
+	entry[kEntry_type] = kEntryType_begin;
+	entry[kEntry_class] = NSStringFromClass([object class]);
+	
+	if ([object conformsToProtocol:@protocol(NSCoding)]) {
+		entry[kEntry_object] = [object copy];
+	}
+	
+	[self appendEntry:entry];
+	
+	ZDCRecordingProxy *proxy = [ZDCRecordingProxy alloc];
+	proxy->target = object;
+	proxy->recorder = self;
+	
+	return proxy;
+}
+
+/**
+ * See header file for description.
+ */
+- (BOOL)stopRecording:(NSError **)errPtr
+{
+	if (isRecording)
+	{
+		isRecording = NO;
+		
+		NSMutableDictionary *entry = [NSMutableDictionary dictionaryWithCapacity:2];
+		entry[kEntry_type] = kEntryType_end;
+		
+		ZDCObject *object = target;
+		if ([object conformsToProtocol:@protocol(NSCoding)]) {
+			entry[kEntry_object] = [object copy];
+		}
+		
+		[self appendEntry:entry];
+	}
+	
+	[self flush];
+	
+	@try {
+		[fileHandle closeFile];
+	}
+	@catch (NSException *exception) {}
+	fileHandle = nil;
+	
+	if (errPtr) *errPtr = writeError;
+	return (writeError == nil);
+}
+
+- (void)forwardInvocation:(NSInvocation *)invocation toTarget:(ZDCObject *)object
+{
+	// We only record calls to the object's own API.
+	// Calls such as `isKindOfClass:` or `copy` are simply forwarded.
+	
+	if (!isRecording || [NSObject instancesRespondToSelector:invocation.selector])
+	{
+		[invocation invokeWithTarget:object];
+		return;
+	}
+	
+	// Capture the arguments before invoking, since the call may mutate them.
+	
+	NSArray *arguments = [self recordableArgumentsForInvocation:invocation];
+	
+	[invocation invokeWithTarget:object];
+	
+	if (arguments == nil)
+	{
+		skippedCount++;
+		return;
+	}
+	
+	NSMutableDictionary *entry = [NSMutableDictionary dictionaryWithCapacity:4];
+	entry[kEntry_type] = kEntryType_call;
+	entry[kEntry_selector] = NSStringFromSelector(invocation.selector);
+	entry[kEntry_arguments] = arguments;
+	
+	BOOL hasResult = NO;
+	id result = [self recordableResultForInvocation:invocation hasResult:&hasResult];
+	if (hasResult) {
+		entry[kEntry_result] = result ?: [NSNull null];
+	}
+	
+	[self appendEntry:entry];
+	recordedCount++;
+}
+
+/**
+ * Returns nil if any of the arguments cannot be recorded.
+ * Nil arguments (and out-parameters) are recorded as NSNull.
+ */
+- (nullable NSArray *)recordableArgumentsForInvocation:(NSInvocation *)invocation
+{
+	NSMethodSignature *signature = invocation.methodSignature;
+	NSUInteger const count = signature.numberOfArguments;
+	
+	NSMutableArray *arguments = [NSMutableArray arrayWithCapacity:(count - 2)];
+	
+	for (NSUInteger i = 2; i < count; i++) // skip self & _cmd
+	{
+		const char *type = ZDCSkipTypeQualifiers([signature getArgumentTypeAtIndex:i]);
+		
+		if (ZDCIsObjectType(type))
+		{
+			__unsafe_unretained id value = nil;
+			[invocation getArgument:&value atIndex:i];
+			
+			if (value == nil) {
+				[arguments addObject:[NSNull null]];
+			}
+			else if ([value conformsToProtocol:@protocol(NSCoding)]) {
+				[arguments addObject:([value conformsToProtocol:@protocol(NSCopying)] ? [value copy] : value)];
+			}
+			else {
+				return nil;
+			}
+		}
+		else if (ZDCIsOutObjectType(type))
+		{
+			[arguments addObject:[NSNull null]];
+		}
+		else
+		{
+			NSUInteger size = 0;
+			NSGetSizeAndAlignment(type, &size, NULL);
+			
+			uint64_t buffer[2] = { 0, 0 };
+			if (size > sizeof(buffer)) {
+				return nil;
+			}
+			[invocation getArgument:buffer atIndex:i];
+			
+			NSNumber *number = ZDCNumberFromBuffer(type, buffer);
+			if (number == nil) {
+				return nil;
+			}
+			[arguments addObject:number];
+		}
+	}
+	
+	return arguments;
+}
+
+- (nullable id)recordableResultForInvocation:(NSInvocation *)invocation hasResult:(BOOL *)hasResultPtr
+{
+	const char *type = ZDCSkipTypeQualifiers(invocation.methodSignature.methodReturnType);
+	
+	if (ZDCIsObjectType(type))
+	{
+		__unsafe_unretained id value = nil;
+		[invocation getReturnValue:&value];
+		
+		if (value == nil)
+		{
+			*hasResultPtr = YES;
+			return nil;
+		}
+		if ([value conformsToProtocol:@protocol(NSCoding)])
+		{
+			*hasResultPtr = YES;
+			return [value conformsToProtocol:@protocol(NSCopying)] ? [value copy] : value;
+		}
+		
+		*hasResultPtr = NO;
+		return nil;
+	}
+	
+	if (invocation.methodSignature.methodReturnLength > 0 &&
+	    invocation.methodSignature.methodReturnLength <= sizeof(uint64_t) * 2)
+	{
+		uint64_t buffer[2] = { 0, 0 };
+		[invocation getReturnValue:buffer];
+		
+		NSNumber *number = ZDCNumberFromBuffer(type, buffer);
+		*hasResultPtr = (number != nil);
+		return number;
+	}
+	
+	*hasResultPtr = NO;
+	return nil;
+}
+
+- (void)appendEntry:(NSDictionary *)entry
+{
+	[pendingEntries addObject:entry];
+	
+	if (pendingEntries.count >= kEntriesPerChunk) {
+		[self flush];
+	}
+}
+
+- (void)flush
+{
+	if (pendingEntries.count == 0) return;
+	
+	NSData *chunk = nil;
+	@try
+	{
+		if (@available(macOS 10.13, iOS 11, tvOS 11, *)) {
+			chunk = [NSKeyedArchiver archivedDataWithRootObject:pendingEntries requiringSecureCoding:NO error:NULL];
+		}
+		else
+		{
+		#pragma clang diagnostic push
+		#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+			chunk = [NSKeyedArchiver archivedDataWithRootObject:pendingEntries];
+		#pragma clang diagnostic pop
+		}
+	}
+	@catch (NSException *exception) {}
+	
+	[pendingEntries removeAllObjects];
+	
+	if (chunk == nil || chunk.length > UINT32_MAX)
+	{
+		if (writeError == nil) {
+			writeError = ZDCWorkloadTraceError(101, @"Unable to archive trace entries.");
+		}
+		return;
+	}
+	
+	uint32_t const length = CFSwapInt32HostToBig((uint32_t)chunk.length);
+	
+	[self writeData:[NSData dataWithBytes:&length length:sizeof(length)]];
+	[self writeData:chunk];
+}
+
+- (void)writeData:(NSData *)data
+{
+	if (fileHandle == nil || writeError) return;
+	
+	@try {
+		[fileHandle writeData:data];
+	}
+	@catch (NSException *exception) {
+		writeError = ZDCWorkloadTraceError(102, exception.reason ?: @"Unable to write to trace file.");
+	}
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define ZDC_HISTOGRAM_BUCKET_COUNT 65
+
+@implementation ZDCLatencyHistogram {
+	
+	NSUInteger buckets[ZDC_HISTOGRAM_BUCKET_COUNT];
+}
+
+@synthesize count = count;
+@synthesize totalNanoseconds = totalNanoseconds;
+@synthesize minNanoseconds = minNanoseconds;
+@synthesize maxNanoseconds = maxNanoseconds;
+
+- (void)addSample:(uint64_t)ns
+{
+	if (count == 0 || ns < minNanoseconds) {
+		minNanoseconds = ns;
+	}
+	if (ns > maxNanoseconds) {
+		maxNanoseconds = ns;
+	}
+	
+	count++;
+	totalNanoseconds += ns;
+	
+	NSUInteger const bucket = (ns == 0) ? 0 : (NSUInteger)(64 - __builtin_clzll(ns));
+	buckets[bucket]++;
+}
+
+/**
+ * See header file for description.
+ */
+- (uint64_t)nanosecondsAtPercentile:(double)percentile
+{
+	if (count == 0) return 0;
+	
+	double const target = MAX(1.0, ceil((MIN(MAX(percentile, 0.0), 100.0) / 100.0) * count));
+	
+	NSUInteger total = 0;
+	for (NSUInteger bucket = 0; bucket < ZDC_HISTOGRAM_BUCKET_COUNT; bucket++)
+	{
+		total += buckets[bucket];
+		if (total >= target)
+		{
+			uint64_t const upperBound = (bucket == 0) ? 0 : ((bucket >= 64) ? UINT64_MAX : ((1ULL << bucket) - 1));
+			return MIN(upperBound, maxNanoseconds);
+		}
+	}
+	
+	return maxNanoseconds;
+}
+
+/**
+ * See header file for description.
+ */
+- (NSArray<NSNumber*> *)buckets
+{
+	NSMutableArray<NSNumber*> *result = [NSMutableArray arrayWithCapacity:ZDC_HISTOGRAM_BUCKET_COUNT];
+	for (NSUInteger bucket = 0; bucket < ZDC_HISTOGRAM_BUCKET_COUNT; bucket++)
+	{
+		[result addObject:@(buckets[bucket])];
+	}
+	
+	return result;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCWorkloadReplayResult {
+@public
+
+	NSString *className;
+	NSUInteger operationCount;
+	NSMutableDictionary<NSString*, ZDCLatencyHistogram*> *latencies;
+	NSMutableArray<NSString*> *mismatches;
+	BOOL finalStateMatches;
+}
+
+@synthesize className = className;
+@synthesize operationCount = operationCount;
+@synthesize latencies = latencies;
+@synthesize mismatches = mismatches;
+@synthesize finalStateMatches = finalStateMatches;
+
+- (BOOL)succeeded
+{
+	return (mismatches.count == 0) && finalStateMatches;
+}
+
+/**
+ * See header file for description.
+ */
+- (NSString *)report
+{
+	NSMutableString *report = [NSMutableString string];
+	
+	[report appendFormat:@"%@: %lu operations - %@\n",
+	  className, (unsigned long)operationCount, (self.succeeded ? @"OK" : @"FAILED")];
+	
+	for (NSString *mismatch in mismatches)
+	{
+		[report appendFormat:@"  mismatch: %@\n", mismatch];
+	}
+	if (!finalStateMatches)
+	{
+		[report appendString:@"  mismatch: final state\n"];
+	}
+	
+	// Most expensive operations first
+	
+	NSArray<NSString*> *selectors = [latencies keysSortedByValueUsingComparator:
+		^NSComparisonResult(ZDCLatencyHistogram *h1, ZDCLatencyHistogram *h2)
+	{
+		if (h1.totalNanoseconds > h2.totalNanoseconds) return NSOrderedAscending;
+		if (h1.totalNanoseconds < h2.totalNanoseconds) return NSOrderedDescending;
+		return NSOrderedSame;
+	}];
+	
+	[report appendFormat:@"\n%-48s %8s %10s %10s %10s %10s %10s %10s\n",
+	  "operation", "count", "total", "min", "p50", "p90", "p99", "max"];
+	
+	for (NSString *selector in selectors)
+	{
+		ZDCLatencyHistogram *h = latencies[selector];
+		
+		[report appendFormat:@"%-48s %8lu %10s %10s %10s %10s %10s %10s\n",
+		  selector.UTF8String,
+		  (unsigned long)h.count,
+		  ZDCFormatNanoseconds(h.totalNanoseconds).UTF8String,
+		  ZDCFormatNanoseconds(h.minNanoseconds).UTF8String,
+		  ZDCFormatNanoseconds([h nanosecondsAtPercentile:50]).UTF8String,
+		  ZDCFormatNanoseconds([h nanosecondsAtPercentile:90]).UTF8String,
+		  ZDCFormatNanoseconds([h nanosecondsAtPercentile:99]).UTF8String,
+		  ZDCFormatNanoseconds(h.maxNanoseconds).UTF8String];
+	}
+	
+	for (NSString *selector in selectors)
+	{
+		ZDCLatencyHistogram *h = latencies[selector];
+		NSArray<NSNumber*> *buckets = h.buckets;
+		
+		NSUInteger maxBucketCount = 0;
+		for (NSNumber *num in buckets) {
+			maxBucketCount = MAX(maxBucketCount, num.unsignedIntegerValue);
+		}
+		
+		[report appendFormat:@"\n%@\n", selector];
+		
+		[buckets enumerateObjectsUsingBlock:^(NSNumber *num, NSUInteger bucket, BOOL *stop) {
+			
+			NSUInteger const bucketCount = num.unsignedIntegerValue;
+			if (bucketCount == 0) return; // from block
+			
+			uint64_t const lowerBound = (bucket == 0) ? 0 : (1ULL << (bucket - 1));
+			NSUInteger const barLength = MAX((NSUInteger)1, (bucketCount * 40) / maxBucketCount);
+			
+			NSString *bar = [@"" stringByPaddingToLength:barLength withString:@"#" startingAtIndex:0];
+			
+			[report appendFormat:@"  >= %10s | %-40s %lu\n",
+			  ZDCFormatNanoseconds(lowerBound).UTF8String, bar.UTF8String, (unsigned long)bucketCount];
+		}];
+	}
+	
+	return report;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCWorkloadReplayer {
+	
+	NSURL *url;
+}
+
+- (instancetype)initWithURL:(NSURL *)inURL
+{
+	NSParameterAssert(inURL != nil);
+	
+	if ((self = [super init]))
+	{
+		url = [inURL copy];
+	}
+	return self;
+}
+
+- (nullable NSArray<NSDictionary*> *)readEntries:(NSError **)errPtr
+{
+	NSError *error = nil;
+	NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:&error];
+	if (data == nil)
+	{
+		if (errPtr) *errPtr = error;
+		return nil;
+	}
+	
+	const uint8_t *bytes = data.bytes;
+	NSUInteger const length = data.length;
+	
+	if (length < sizeof(kTraceMagic) || memcmp(bytes, kTraceMagic, sizeof(kTraceMagic)) != 0)
+	{
+		if (errPtr) *errPtr = ZDCWorkloadTraceError(200, @"Not a workload trace file.");
+		return nil;
+	}
+	
+	NSMutableArray<NSDictionary*> *entries = [NSMutableArray array];
+	NSUInteger offset = sizeof(kTraceMagic);
+	
+	while (offset < length)
+	{
+		uint32_t chunkLength = 0;
+		if (length - offset < sizeof(chunkLength)) break;
+		
+		memcpy(&chunkLength, bytes + offset, sizeof(chunkLength));
+		chunkLength = CFSwapInt32BigToHost(chunkLength);
+		offset += sizeof(chunkLength);
+		
+		if (length - offset < chunkLength)
+		{
+			if (errPtr) *errPtr = ZDCWorkloadTraceError(201, @"Trace file is truncated.");
+			return nil;
+		}
+		
+		NSData *chunk = [data subdataWithRange:NSMakeRange(offset, chunkLength)];
+		offset += chunkLength;
+		
+		id chunkEntries = nil;
+		@try
+		{
+			if (@available(macOS 10.13, iOS 11, tvOS 11, *))
+			{
+				NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingFromData:chunk error:NULL];
+				unarchiver.requiresSecureCoding = NO;
+				
+				chunkEntries = [unarchiver decodeObjectForKey:NSKeyedArchiveRootObjectKey];
+				[unarchiver finishDecoding];
+			}
+			else
+			{
+			#pragma clang diagnostic push
+			#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+				chunkEntries = [NSKeyedUnarchiver unarchiveObjectWithData:chunk];
+			#pragma clang diagnostic pop
+			}
+		}
+		@catch (NSException *exception) {}
+		
+		if (![chunkEntries isKindOfClass:[NSArray class]])
+		{
+			if (errPtr) *errPtr = ZDCWorkloadTraceError(202, @"Trace file is corrupt.");
+			return nil;
+		}
+		
+		[entries addObjectsFromArray:chunkEntries];
+	}
+	
+	return entries;
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable ZDCWorkloadReplayResult *)replay:(NSError **)errPtr
+{
+	NSArray<NSDictionary*> *entries = [self readEntries:errPtr];
+	if (entries == nil) {
+		return nil;
+	}
+	
+	NSDictionary *beginEntry = entries.firstObject;
+	if (![beginEntry[kEntry_type] isEqual:kEntryType_begin])
+	{
+		if (errPtr) *errPtr = ZDCWorkloadTraceError(203, @"Trace file is missing its initial state.");
+		return nil;
+	}
+	
+	NSString *className = beginEntry[kEntry_class];
+	
+	ZDCObject *target = beginEntry[kEntry_object];
+	if (target == nil)
+	{
+		Class cls = NSClassFromString(className);
+		if (cls == Nil || ![cls isSubclassOfClass:[ZDCObject class]])
+		{
+			if (errPtr) *errPtr = ZDCWorkloadTraceError(204, @"Unknown class within trace file.");
+			return nil;
+		}
+		
+		target = [[cls alloc] init];
+	}
+	
+	ZDCWorkloadReplayResult *result = [[ZDCWorkloadReplayResult alloc] init];
+	result->className = className ?: NSStringFromClass([target class]);
+	result->latencies = [NSMutableDictionary dictionary];
+	result->mismatches = [NSMutableArray array];
+	result->finalStateMatches = YES;
+	
+	for (NSUInteger entryIdx = 1; entryIdx < entries.count; entryIdx++)
+	{
+		NSDictionary *entry = entries[entryIdx];
+		NSString *type = entry[kEntry_type];
+		
+		if ([type isEqual:kEntryType_end])
+		{
+			id finalState = entry[kEntry_object];
+			if (finalState) {
+				result->finalStateMatches = [target isEqual:finalState];
+			}
+			break;
+		}
+		
+		if (![type isEqual:kEntryType_call]) {
+			continue;
+		}
+		
+		NSString *selectorName = entry[kEntry_selector];
+		NSString *mismatch = [self replayEntry:entry onTarget:target result:result];
+		
+		if (mismatch) {
+			[result->mismatches addObject:
+			  [NSString stringWithFormat:@"#%lu %@: %@", (unsigned long)entryIdx, selectorName, mismatch]];
+		}
+	}
+	
+	return result;
+}
+
+/**
+ * Replays a single call.
+ * Returns a description of the mismatch (if any).
+ */
+- (nullable NSString *)replayEntry:(NSDictionary *)entry onTarget:(ZDCObject *)target result:(ZDCWorkloadReplayResult *)result
+{
+	NSString *selectorName = entry[kEntry_selector];
+	NSArray *arguments = entry[kEntry_arguments];
+	
+	SEL selector = NSSelectorFromString(selectorName);
+	NSMethodSignature *signature = [target methodSignatureForSelector:selector];
+	
+	if (signature == nil || (signature.numberOfArguments - 2) != arguments.count) {
+		return @"unknown selector";
+	}
+	
+	NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:signature];
+	invocation.selector = selector;
+	invocation.target = target;
+	
+	// Storage for out-parameters (e.g. NSError **).
+	// The callee writes autoreleased values into these, which we simply ignore.
+	NSUInteger const argCount = signature.numberOfArguments;
+	void **outStorage = calloc(argCount, sizeof(void *));
+	
+	NSString *mismatch = nil;
+	
+	for (NSUInteger i = 2; i < argCount && !mismatch; i++)
+	{
+		const char *argType = ZDCSkipTypeQualifiers([signature getArgumentTypeAtIndex:i]);
+		id value = arguments[i - 2];
+		
+		if (ZDCIsObjectType(argType))
+		{
+			__unsafe_unretained id obj = (value == [NSNull null]) ? nil : value;
+			[invocation setArgument:&obj atIndex:i];
+		}
+		else if (ZDCIsOutObjectType(argType))
+		{
+			void *ptr = &outStorage[i];
+			[invocation setArgument:&ptr atIndex:i];
+		}
+		else
+		{
+			uint64_t buffer[2] = { 0, 0 };
+			if (![value isKindOfClass:[NSNumber class]] || !ZDCNumberToBuffer(value, argType, buffer)) {
+				mismatch = @"unsupported argument";
+			}
+			else {
+				[invocation setArgument:buffer atIndex:i];
+			}
+		}
+	}
+	
+	if (mismatch == nil)
+	{
+		uint64_t const startTime = mach_absolute_time();
+		@try
+		{
+			[invocation invoke];
+		}
+		@catch (NSException *exception)
+		{
+			mismatch = [NSString stringWithFormat:@"threw %@", exception.name];
+		}
+		uint64_t const elapsed = ZDCNanosecondsFromMachTicks(mach_absolute_time() - startTime);
+		
+		ZDCLatencyHistogram *histogram = result->latencies[selectorName];
+		if (histogram == nil)
+		{
+			histogram = [[ZDCLatencyHistogram alloc] init];
+			result->latencies[selectorName] = histogram;
+		}
+		[histogram addSample:elapsed];
+		result->operationCount++;
+	}
+	
+	free(outStorage);
+	
+	id expected = entry[kEntry_result];
+	if (mismatch == nil && expected != nil)
+	{
+		if (expected == [NSNull null]) {
+			expected = nil;
+		}
+		
+		id actual = nil;
+		const char *returnType = ZDCSkipTypeQualifiers(signature.methodReturnType);
+		
+		if (ZDCIsObjectType(returnType))
+		{
+			__unsafe_unretained id value = nil;
+			[invocation getReturnValue:&value];
+			actual = value;
+		}
+		else if (signature.methodReturnLength <= sizeof(uint64_t) * 2)
+		{
+			uint64_t buffer[2] = { 0, 0 };
+			[invocation getReturnValue:buffer];
+			actual = ZDCNumberFromBuffer(returnType, buffer);
+		}
+		
+		BOOL const matches = (actual == nil) ? (expected == nil) : [actual isEqual:expected];
+		if (!matches) {
+			mismatch = @"result differs from recording";
+		}
+	}
+	
+	return mismatch;
+}
+
+@end
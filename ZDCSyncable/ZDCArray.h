@@ -5,6 +5,7 @@
 
 #import "ZDCObject.h"
 #import "ZDCSyncable.h"
+#import "ZDCChangeNotification.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -19,6 +20,10 @@ NS_ASSUME_NONNULL_BEGIN
  * - it tracks all changes made to the dictionary, and can provide a changeset (which encodes the change info)
  * - it supports undo & redo
  * - it supports merge operations
+ *
+ * Within the changeset, a contiguous run of moved items (e.g. a block of rows that was dragged elsewhere)
+ * is encoded as a single block-move entry, rather than one entry per item.
+ * See `+[ZDCOrder blockMoveWithIndex:length:]` for the format & compatibility notes.
  */
 NS_SWIFT_NAME(ZDCArray_ObjC)
 @interface ZDCArray<ObjectType> : ZDCObject <NSCoding, NSCopying, NSFastEnumeration, ZDCSyncable>
@@ -51,6 +56,44 @@ NS_SWIFT_NAME(ZDCArray_ObjC)
  */
 - (instancetype)initWithArray:(nullable NSArray<ObjectType> *)array copyItems:(BOOL)copyItems;
 
+/**
+ * Same as `initWithArray:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithArray:(nullable NSArray<ObjectType> *)array
+                    copyItems:(BOOL)copyItems
+                 trackChanges:(BOOL)trackChanges;
+
+#pragma mark Change Tracking
+
+/**
+ * Controls when the array switches from operation-by-operation change tracking to snapshot-and-diff.
+ *
+ * Operation-by-operation tracking is cheap for a few edits, but degrades for wholesale rewrites
+ * (such as shuffles, sorts or full replacements), since the tracking info grows to the size of the array.
+ * So when the tracking info exceeds this fraction of the element count,
+ * the array instead holds onto a snapshot of its original contents,
+ * and calculates the changeset (by diffing the snapshot against the current state) when it's requested.
+ *
+ * The changeset format & undo semantics are the same in either mode.
+ *
+ * The default value is 0.25. Set to zero to disable snapshot-and-diff.
+ */
+@property (nonatomic, assign, readwrite) double snapshotThreshold;
+
+/**
+ * Whether generated changesets encode long runs of moved items as block-move entries.
+ * (See `+[ZDCOrder blockMoveWithIndex:length:]` for the format.)
+ *
+ * This shrinks the changeset when a block of items is dragged elsewhere.
+ * But older versions of the framework reject changesets containing block-move entries.
+ * So only enable it once every reader of your changesets understands the format.
+ *
+ * Block-move entries are accepted by undo, import & merge regardless of this setting.
+ *
+ * The default value is NO.
+ */
+@property (nonatomic, assign, readwrite) BOOL compressesMoves;
+
 #pragma mark Raw
 
 /**
@@ -179,6 +222,16 @@ NS_SWIFT_NAME(ZDCArray_ObjC)
  */
 - (void)enumerateObjectsUsingBlock:(void (^)(ObjectType obj, NSUInteger idx, BOOL *stop))block;
 
+/**
+ * Enumerates all objects in the array, with the given options.
+ *
+ * Pass NSEnumerationConcurrent to spread the enumeration across the available cores
+ * (the block must then be thread-safe), or NSEnumerationReverse to enumerate from the largest index down.
+ * The array must not be mutated during the enumeration.
+ */
+- (void)enumerateObjectsWithOptions:(NSEnumerationOptions)opts
+                         usingBlock:(void (^)(ObjectType obj, NSUInteger idx, BOOL *stop))block;
+
 /**
  * An enumerator object that lets you access each object in the array,
  * in order, from the element at the lowest index upwards.
@@ -192,6 +245,62 @@ NS_SWIFT_NAME(ZDCArray_ObjC)
  */
 - (NSEnumerator<ObjectType> *)reverseObjectEnumerator;
 
+#pragma mark Change Notifications
+
+/**
+ * Registers a block to be notified of changes to the array, such as inserted, removed & moved indexes.
+ * This is designed for updating a table or collection view, without calculating changesets or diffing.
+ *
+ * All the changes made during a single turn of the run loop (of the thread making the changes)
+ * are coalesced, and delivered as a single notification on that thread.
+ * Changes made within `performChangeBatch:` are delivered when the (outermost) batch ends.
+ * Threads that don't run a run loop should use `performChangeBatch:` or `flushChangeNotifications`.
+ *
+ * Notifications cover every mutation, including those performed by undo, import & merge operations,
+ * and those performed within `performWithoutChangeTracking:`.
+ * Restoring a checkpoint is delivered as a reload (see `-[ZDCChangeNotification requiresReload]`).
+ *
+ * When no observers are registered, there's no overhead (aside from a nil check within each mutation).
+ *
+ * @return An opaque token, to be passed to `removeChangeObserver:`.
+ */
+- (id)addChangeObserver:(ZDCChangeObserverBlock)block;
+
+/**
+ * Unregisters an observer that was added via `addChangeObserver:`.
+ * Pending changes aren't delivered if the last observer is removed.
+ */
+- (void)removeChangeObserver:(id)observer;
+
+/**
+ * Executes the block, and then delivers a single notification covering the changes made within it.
+ * Batches may be nested.
+ */
+- (void)performChangeBatch:(void (NS_NOESCAPE ^)(void))block;
+
+/**
+ * Delivers the pending notification (if any) immediately.
+ */
+- (void)flushChangeNotifications;
+
+#pragma mark Diff
+
+/**
+ * Calculates the changeset between two versions of an array,
+ * without replaying the individual operations that led from one to the other.
+ *
+ * The result is a standard (undo) changeset.
+ * That is, invoking `undo:error:` on an array equal to `dst` will produce an array equal to `src`.
+ *
+ * Items are matched via hashing (i.e. `isEqual:` & `hash`),
+ * and the moved items are chosen via a longest increasing subsequence, which keeps the set of moves minimal.
+ * The algorithm runs in O(n log n).
+ * Block-move entries are used if `dst.compressesMoves` is YES.
+ *
+ * @return The changeset, or nil if the arrays are equal.
+ */
++ (nullable NSDictionary<NSString*, id> *)changesetFrom:(ZDCArray *)src to:(ZDCArray *)dst;
+
 #pragma mark Equality
 
 /**
@@ -6,7 +6,12 @@
 #import "ZDCArray.h"
 
 #import "ZDCObjectSubclass.h"
+#import "ZDCChangeCoalescer.h"
 #import "ZDCOrder.h"
+#import "ZDCOriginalOrderCache.h"
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
 
 // Encoding/Decoding Keys
 //
@@ -22,6 +27,11 @@ static NSString *const kChangeset_added   = @"added";
 static NSString *const kChangeset_moved   = @"moved";
 static NSString *const kChangeset_deleted = @"deleted";
 
+// Snapshot-and-diff
+//
+static double const kDefaultSnapshotThreshold = 0.25;
+static NSUInteger const kSnapshotMinimumTrackedCount = 64;
+
 @implementation ZDCArray {
 @private
 
@@ -30,8 +40,20 @@ static NSString *const kChangeset_deleted = @"deleted";
 	NSMutableIndexSet *added;                         // [{ currentIndex }]
 	NSMutableDictionary<NSNumber*, NSNumber*> *moved; // key={currentIndex}, value={previousIndex}
 	NSMutableDictionary<NSNumber*, id> *deleted;      // key={previousIndex}, value={object}
+	
+	NSArray *snapshot;                                // original array (when using snapshot-and-diff)
+	double snapshotThreshold;
+	BOOL compressesMoves;                             // encode runs as block-move entries (opt-in)
+	
+	ZDCOriginalOrderCache *originalOrderCache;        // memoized by mergeCloudVersion (created lazily)
+	
+	BOOL storageIsShared;                             // shared with a copy or checkpoint (see `unshareStorage`)
+	
+	ZDCChangeCoalescer *changeObservers;              // nil unless observers are registered
 }
 
+@synthesize snapshotThreshold = snapshotThreshold;
+@synthesize compressesMoves = compressesMoves;
 @dynamic rawArray;
 @dynamic count;
 
@@ -46,6 +68,11 @@ static NSString *const kChangeset_deleted = @"deleted";
 }
 
 - (instancetype)initWithArray:(NSArray *)inArray copyItems:(BOOL)copyItems
+{
+	return [self initWithArray:inArray copyItems:copyItems trackChanges:YES];
+}
+
+- (instancetype)initWithArray:(NSArray *)inArray copyItems:(BOOL)copyItems trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -54,13 +81,15 @@ static NSString *const kChangeset_deleted = @"deleted";
 		array = [[NSMutableArray alloc] initWithCapacity:capacity];
 		added = [[NSMutableIndexSet alloc] init];
 		
-		NSUInteger idx = 0;
+		snapshotThreshold = kDefaultSnapshotThreshold;
+		
 		for (id obj in inArray)
 		{
 			[array addObject:(copyItems ? [obj copy] : obj)];
-			[added addIndex:idx];
-			 
-			idx++;
+		}
+		
+		if (trackChanges && (array.count > 0)) {
+			[added addIndexesInRange:NSMakeRange(0, array.count)];
 		}
 	}
 	return self;
@@ -80,6 +109,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 			array = [[NSMutableArray alloc] init];
 		}
 		
+		snapshotThreshold = kDefaultSnapshotThreshold;
+		
 		// Note: ephemeral properties (i.e. for change tracking) are not serialized
 	}
 	return self;
@@ -102,11 +133,23 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	ZDCArray *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
 	
-	copy->array = [self->array mutableCopy];
+	// The storage is shared between both objects, and copied upon the next mutation (copy-on-write).
+	// An immutable object is never mutated, so there's no need to mark it (it may be shared across threads).
 	
-	copy->added = [self->added mutableCopy];
-	copy->moved = [self->moved mutableCopy];
-	copy->deleted = [self->deleted mutableCopy];
+	copy->array = self->array;
+	
+	copy->added = self->added;
+	copy->moved = self->moved;
+	copy->deleted = self->deleted;
+	
+	copy->storageIsShared = YES;
+	if (!self.isImmutable) {
+		self->storageIsShared = YES;
+	}
+	
+	copy->snapshot = self->snapshot;
+	copy->snapshotThreshold = self->snapshotThreshold;
+	copy->compressesMoves = self->compressesMoves;
 	
 	return copy;
 }
@@ -125,12 +168,105 @@ static NSString *const kChangeset_deleted = @"deleted";
 			copy->added = [self->added mutableCopy];
 			copy->moved = [self->moved mutableCopy];
 			copy->deleted = [self->deleted mutableCopy];
+			copy->snapshot = self->snapshot;
 			
 			[super copyChangeTrackingTo:another];
 		}
 	}
 }
 
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCArray *copy = (ZDCArray *)another;
+	
+	// The copy shares its storage with the checkpoint, so we adopt it as-is (still marked as shared).
+	
+	array = copy->array;
+	
+	added = copy->added;
+	moved = copy->moved;
+	deleted = copy->deleted;
+	
+	snapshot = copy->snapshot;
+	storageIsShared = copy->storageIsShared;
+	
+	[changeObservers reloadWithCount:array.count];
+	
+	[super restoreStateFromCopy:another];
+}
+
+/**
+ * Used by `publishSnapshot`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block
+{
+	NSUInteger const arrayCount = array.count;
+	for (NSUInteger idx = 0; idx < arrayCount; idx++)
+	{
+		id obj = array[idx];
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			array[idx] = block((ZDCObject *)obj);
+		}
+	}
+	
+	for (NSNumber *prevIdx in [deleted allKeys])
+	{
+		id obj = deleted[prevIdx];
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			deleted[prevIdx] = block((ZDCObject *)obj);
+		}
+	}
+	
+	if (snapshot)
+	{
+		NSMutableArray *newSnapshot = nil;
+		
+		NSUInteger const snapshotCount = snapshot.count;
+		for (NSUInteger idx = 0; idx < snapshotCount; idx++)
+		{
+			id obj = snapshot[idx];
+			if ([obj isKindOfClass:[ZDCObject class]])
+			{
+				if (newSnapshot == nil) {
+					newSnapshot = [snapshot mutableCopy];
+				}
+				newSnapshot[idx] = block((ZDCObject *)obj);
+			}
+		}
+		
+		if (newSnapshot) {
+			snapshot = [newSnapshot copy];
+		}
+	}
+}
+
+/**
+ * The storage (and change tracking info) may be shared with copies & checkpoints.
+ * This method must be invoked before modifying any of it.
+ */
+- (void)unshareStorage
+{
+	if (storageIsShared)
+	{
+		array = [array mutableCopy];
+		
+		added = [added mutableCopy];
+		moved = [moved mutableCopy];
+		deleted = [deleted mutableCopy];
+		
+		storageIsShared = NO;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Raw
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -181,6 +317,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (object == nil) {
 		@throw [NSException exceptionWithName:NSInvalidArgumentException reason:nil userInfo:nil];
 		return;
@@ -188,6 +325,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	
 	[self _willInsertObjectAtIndex:array.count];
 	[array addObject:object];
+	[changeObservers insertedIndex:(array.count - 1)];
 }
 
 - (void)insertObject:(id)object atIndex:(NSUInteger)idx
@@ -195,6 +333,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (object == nil) {
 		@throw [NSException exceptionWithName:NSInvalidArgumentException reason:nil userInfo:nil];
 		return;
@@ -206,6 +345,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	
 	[self _willInsertObjectAtIndex:idx];
 	[array insertObject:object atIndex:idx];
+	[changeObservers insertedIndex:idx];
 }
 
 - (void)setObject:(id)object atIndexedSubscript:(NSUInteger)idx
@@ -213,6 +353,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (object == nil) {
 		@throw [NSException exceptionWithName:NSInvalidArgumentException reason:nil userInfo:nil];
 		return;
@@ -226,6 +367,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	{
 		[self _willInsertObjectAtIndex:idx];
 		array[idx] = object;
+		[changeObservers insertedIndex:idx];
 	}
 	else
 	{
@@ -234,6 +376,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		
 		[self _willInsertObjectAtIndex:idx];
 		[array insertObject:object atIndex:idx];
+		[changeObservers updatedIndex:idx key:nil];
 	}
 }
 
@@ -245,6 +388,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (oldIndex >= array.count) {
 		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
@@ -262,6 +406,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	
 	[array removeObjectAtIndex:oldIndex];
 	[array insertObject:obj atIndex:newIndex];
+	[changeObservers movedIndex:oldIndex toIndex:newIndex];
 }
 
 - (void)removeObject:(id)object
@@ -269,6 +414,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (object == nil) return;
 	
 	NSUInteger idx = [array indexOfObject:object];
@@ -276,6 +422,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	{
 		[self _willRemoveObjectAtIndex:idx];
 		[array removeObjectAtIndex:idx];
+		[changeObservers removedIndex:idx];
 		
 		idx = [array indexOfObject:object];
 	}
@@ -286,6 +433,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (idx >= array.count) {
 		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
 		return;
@@ -293,6 +441,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	
 	[self _willRemoveObjectAtIndex:idx];
 	[array removeObjectAtIndex:idx];
+	[changeObservers removedIndex:idx];
 }
 
 - (void)removeAllObjects
@@ -300,11 +449,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	while (array.count > 0)
 	{
 		[self _willRemoveObjectAtIndex:0];
 		[array removeObjectAtIndex:0];
+		[changeObservers removedIndex:0];
 	}
 }
 
@@ -314,8 +465,18 @@ static NSString *const kChangeset_deleted = @"deleted";
 
 - (void)_willInsertObjectAtIndex:(NSUInteger const)insertionIdx
 {
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(insertionIdx <= array.count);
 	
+	if ([self isTrackingViaSnapshot]) {
+		return; // changeset will be calculated via diff
+	}
+	
 	if (added == nil) {
 		added = [[NSMutableIndexSet alloc] init];
 	}
@@ -339,8 +500,18 @@ static NSString *const kChangeset_deleted = @"deleted";
 
 - (void)_willRemoveObjectAtIndex:(NSUInteger const)deletionIdx
 {
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(deletionIdx < array.count);
 	
+	if ([self isTrackingViaSnapshot]) {
+		return; // changeset will be calculated via diff
+	}
+	
 	if (deleted == nil) {
 		deleted = [[NSMutableDictionary alloc] init];
 	}
@@ -385,6 +556,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 		
 		{ // scoping
 			
+			ZDC_TRACE_SCOPE(trace, "ZDCArray", "_willRemoveObjectAtIndex: reconstruct original order");
+			ZDC_TRACE_COUNTER("ZDCArray", "_willRemoveObjectAtIndex: count", array.count);
+			
 			NSMutableArray<id> *originalArray = [NSMutableArray arrayWithCapacity:array.count];
 			
 			for (NSUInteger idx = 0; idx < array.count; idx++)
@@ -433,7 +607,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	#ifndef NS_BLOCK_ASSERTIONS
 		[self checkDeleted:originalIdx];
 	#endif
-		deleted[@(originalIdx)] = deletedObj;
+		deleted[@(originalIdx)] = [self retainedOriginal:deletedObj];
 		
 		// REMOVE: Step 3 of 4:
 		//
@@ -491,10 +665,20 @@ static NSString *const kChangeset_deleted = @"deleted";
 
 - (void)_willMoveObjectFromIndex:(NSUInteger const)oldIdx toIndex:(NSUInteger const)newIdx
 {
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(oldIdx < array.count);
 	NSParameterAssert(newIdx <= array.count);
 	NSParameterAssert(oldIdx != newIdx);
 	
+	if ([self isTrackingViaSnapshot]) {
+		return; // changeset will be calculated via diff
+	}
+	
 	// Note: we don't have to concern ourselves with deletes here.
 	// This is because of the order in which the undo operation operates:
 	//
@@ -530,6 +714,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 		else
 		{
+			ZDC_TRACE_SCOPE(trace, "ZDCArray", "_willMoveObjectFromIndex: reconstruct original order");
+			ZDC_TRACE_COUNTER("ZDCArray", "_willMoveObjectFromIndex: count", array.count);
+			
 			NSMutableArray<id> *originalArray = [NSMutableArray arrayWithCapacity:array.count];
 	
 			for (NSUInteger idx = 0; idx < array.count; idx++)
@@ -662,6 +849,297 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Snapshot-and-Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns YES if changes are currently being tracked via a snapshot of the original array.
+ *
+ * If we're still tracking changes operation-by-operation, but the tracking info has grown too large,
+ * then this method performs the switch (and returns YES).
+ */
+- (BOOL)isTrackingViaSnapshot
+{
+	if (snapshot) return YES;
+	if (snapshotThreshold <= 0.0) return NO;
+	
+	// The snapshot would retain every original item in memory,
+	// which defeats the purpose of a configured retention policy.
+	if (self.retentionPolicy) return NO;
+	
+	NSUInteger const trackedCount = added.count + moved.count + deleted.count;
+	
+	if (trackedCount < kSnapshotMinimumTrackedCount) return NO;
+	if (trackedCount <= (NSUInteger)(snapshotThreshold * array.count)) return NO;
+	
+	snapshot = [self originalArray];
+	
+	[added removeAllIndexes];
+	[moved removeAllObjects];
+	[deleted removeAllObjects];
+	
+	return YES;
+}
+
+/**
+ * Reconstructs the original array (at the beginning of the changeset) from the tracking info.
+ */
+- (NSArray *)originalArray
+{
+	//                       direction    <=       this      <=     in      <=      read
+	// [previous state] <= (undo deletes) <= (reverse moves) <= (undo adds) <= [current state]
+	
+	NSMutableArray<id> *originalArray = [NSMutableArray arrayWithCapacity:(array.count + deleted.count)];
+	
+	for (NSUInteger idx = 0; idx < array.count; idx++)
+	{
+		if (![added containsIndex:idx] && (moved[@(idx)] == nil))
+		{
+			[originalArray addObject:array[idx]];
+		}
+	}
+	
+	NSArray<NSNumber*> *moved_sortedKeys_byPreviousIdx =
+		[moved keysSortedByValueUsingComparator:^NSComparisonResult(NSNumber *num1, NSNumber *num2)
+	{
+		return [num1 compare:num2];
+	}];
+	
+	for (NSNumber *num in moved_sortedKeys_byPreviousIdx)
+	{
+		NSUInteger currentIdx = num.unsignedIntegerValue;
+		NSUInteger previousIdx = [moved[num] unsignedIntegerValue];
+		
+		[originalArray insertObject:array[currentIdx] atIndex:previousIdx];
+	}
+	
+	NSArray<NSNumber*> *deleted_sortedKeys = [[deleted allKeys] sortedArrayUsingComparator:
+		^NSComparisonResult(NSNumber *num1, NSNumber *num2)
+	{
+		return [num1 compare:num2];
+	}];
+	
+	for (NSNumber *num in deleted_sortedKeys)
+	{
+		[originalArray insertObject:deleted[num] atIndex:num.unsignedIntegerValue];
+	}
+	
+	return [originalArray copy];
+}
+
+/**
+ * Returns YES if both arrays contain the exact same objects (compared by pointer), in the same order.
+ */
+static BOOL ZDCArrayIsIdentical(NSArray *a, NSArray *b)
+{
+	NSUInteger const count = a.count;
+	if (b.count != count) return NO;
+	
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		if (a[idx] != b[idx]) return NO;
+	}
+	
+	return YES;
+}
+
+/**
+ * Returns YES if the array still contains the exact same objects as the snapshot.
+ */
+- (BOOL)isIdenticalToSnapshot
+{
+	return ZDCArrayIsIdentical(snapshot, array);
+}
+
+/**
+ * Calculates the changeset by diffing the snapshot against the current state.
+ */
+- (NSDictionary *)snapshotChangeset
+{
+	// Just like operation-by-operation tracking, we match items based on identity (not isEqual:).
+	
+	NSDictionary *changeset =
+	  [[self class] changesetFromArray:snapshot toArray:array matchIdentical:YES compressMoves:compressesMoves];
+	
+	// The snapshot may contain retained originals (if the retentionPolicy was removed after they were captured).
+	
+	NSDictionary *changeset_deleted = changeset[kChangeset_deleted];
+	if (changeset_deleted.count > 0)
+	{
+		NSMutableDictionary *resolved = [NSMutableDictionary dictionaryWithCapacity:changeset_deleted.count];
+		[changeset_deleted enumerateKeysAndObjectsUsingBlock:^(NSNumber *idx, id obj, BOOL *stop) {
+			
+			resolved[idx] = [self resolvedOriginal:obj];
+		}];
+		
+		NSMutableDictionary *result = [changeset mutableCopy];
+		result[kChangeset_deleted] = [resolved copy];
+		changeset = [result copy];
+	}
+	
+	return changeset;
+}
+
+/**
+ * Calculates the changeset that transforms `original` into `current`.
+ *
+ * The result uses the exact same format as operation-by-operation tracking:
+ * - added   : indexes (within the current array) of items that aren't in the original
+ * - deleted : {previousIndex: obj} for items in the original that aren't in the current array
+ * - moved   : {currentIndex: previousIndex} for the minimum set of items that need to be moved
+ *
+ * If compressMoves is YES, long runs within 'moved' are encoded as block-move entries.
+ */
++ (NSDictionary *)changesetFromArray:(NSArray *)original
+                             toArray:(NSArray *)current
+                      matchIdentical:(BOOL)matchIdentical
+                       compressMoves:(BOOL)compressMoves
+{
+	NSUInteger const originalCount = original.count;
+	NSUInteger const currentCount = current.count;
+	
+	// Step 1 of 4:
+	//
+	// Match each item in the current array to its position within the original array.
+	
+	NSPointerFunctionsOptions keyOptions = NSPointerFunctionsStrongMemory;
+	if (matchIdentical)
+		keyOptions |= NSPointerFunctionsObjectPointerPersonality;
+	else
+		keyOptions |= NSPointerFunctionsObjectPersonality;
+	
+	NSMapTable<id, NSMutableIndexSet*> *originalPositions =
+	  [[NSMapTable alloc] initWithKeyOptions:keyOptions
+	                            valueOptions:NSPointerFunctionsStrongMemory
+	                                capacity:originalCount];
+	
+	for (NSUInteger idx = 0; idx < originalCount; idx++)
+	{
+		id obj = original[idx];
+		
+		NSMutableIndexSet *positions = [originalPositions objectForKey:obj];
+		if (positions == nil)
+		{
+			positions = [[NSMutableIndexSet alloc] init];
+			[originalPositions setObject:positions forKey:obj];
+		}
+		
+		[positions addIndex:idx];
+	}
+	
+	NSMutableIndexSet *changeset_added = [[NSMutableIndexSet alloc] init];
+	
+	NSUInteger *currentToOriginal = malloc(MAX(currentCount, 1) * sizeof(NSUInteger));
+	BOOL *isKept = calloc(MAX(originalCount, 1), sizeof(BOOL));
+	
+	for (NSUInteger idx = 0; idx < currentCount; idx++)
+	{
+		NSMutableIndexSet *positions = [originalPositions objectForKey:current[idx]];
+		NSUInteger originalIdx = NSNotFound;
+		
+		if (positions.count > 0)
+		{
+			originalIdx = positions.firstIndex;
+			[positions removeIndex:originalIdx];
+			
+			isKept[originalIdx] = YES;
+		}
+		else
+		{
+			[changeset_added addIndex:idx];
+		}
+		
+		currentToOriginal[idx] = originalIdx;
+	}
+	
+	// Step 2 of 4:
+	//
+	// Everything in the original array that wasn't matched was deleted.
+	//
+	// Recall that deletes are undone last:
+	//
+	//                       direction    <=       this      <=     in      <=      read
+	// [previous state] <= (undo deletes) <= (reverse moves) <= (undo adds) <= [current state]
+	//
+	// So the previousIndex of kept items (as used by 'moved') doesn't count deleted items.
+	
+	NSMutableDictionary<NSNumber*, id> *changeset_deleted = [NSMutableDictionary dictionary];
+	
+	NSUInteger *keptRank = malloc(MAX(originalCount, 1) * sizeof(NSUInteger));
+	NSUInteger keptCount = 0;
+	
+	for (NSUInteger idx = 0; idx < originalCount; idx++)
+	{
+		if (isKept[idx]) {
+			keptRank[idx] = keptCount++;
+		}
+		else {
+			keptRank[idx] = NSNotFound;
+			changeset_deleted[@(idx)] = original[idx];
+		}
+	}
+	
+	// Step 3 of 4:
+	//
+	// Calculate the minimum set of moves.
+	//
+	// Items within the longest increasing subsequence (of previousIndex, in current order)
+	// are already in their proper relative order. Everything else gets moved.
+	
+	NSMutableDictionary<NSNumber*, NSNumber*> *changeset_moved = [NSMutableDictionary dictionary];
+	
+	NSUInteger *previousIdxs = malloc(MAX(keptCount, 1) * sizeof(NSUInteger));
+	NSUInteger *currentIdxs = malloc(MAX(keptCount, 1) * sizeof(NSUInteger));
+	NSUInteger k = 0;
+	
+	for (NSUInteger idx = 0; idx < currentCount; idx++)
+	{
+		NSUInteger originalIdx = currentToOriginal[idx];
+		if (originalIdx != NSNotFound)
+		{
+			previousIdxs[k] = keptRank[originalIdx];
+			currentIdxs[k] = idx;
+			k++;
+		}
+	}
+	
+	NSIndexSet *inOrder = [ZDCOrder indexesOfLongestIncreasingSubsequence:previousIdxs count:keptCount];
+	
+	for (k = 0; k < keptCount; k++)
+	{
+		if (![inOrder containsIndex:k])
+		{
+			changeset_moved[@(currentIdxs[k])] = @(previousIdxs[k]);
+		}
+	}
+	
+	free(currentToOriginal);
+	free(isKept);
+	free(keptRank);
+	free(previousIdxs);
+	free(currentIdxs);
+	
+	// Step 4 of 4:
+	//
+	// Package it all up.
+	
+	NSMutableDictionary<NSString*, id> *changeset = [NSMutableDictionary dictionaryWithCapacity:3];
+	
+	if (changeset_added.count > 0) {
+		changeset[kChangeset_added] = [changeset_added copy];
+	}
+	if (changeset_deleted.count > 0) {
+		changeset[kChangeset_deleted] = [changeset_deleted copy];
+	}
+	if (changeset_moved.count > 0) {
+		changeset[kChangeset_moved] =
+		  compressMoves ? [ZDCOrder compressMovedIndexes:changeset_moved] : [changeset_moved copy];
+	}
+	
+	return changeset;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Utilities
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -796,6 +1274,12 @@ static NSString *const kChangeset_deleted = @"deleted";
 	[array enumerateObjectsUsingBlock:block];
 }
 
+- (void)enumerateObjectsWithOptions:(NSEnumerationOptions)opts
+                         usingBlock:(void (^)(id obj, NSUInteger idx, BOOL *stop))block
+{
+	[array enumerateObjectsWithOptions:opts usingBlock:block];
+}
+
 - (NSEnumerator<id> *)objectEnumerator
 {
 	return [array objectEnumerator];
@@ -813,6 +1297,63 @@ static NSString *const kChangeset_deleted = @"deleted";
 	return [array countByEnumeratingWithState:state objects:buffer count:len];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Notifications
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (id)addChangeObserver:(ZDCChangeObserverBlock)block
+{
+	if (changeObservers == nil) {
+		changeObservers = [[ZDCChangeCoalescer alloc] initWithObject:self count:array.count];
+	}
+	
+	return [changeObservers addObserver:block];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)removeChangeObserver:(id)observer
+{
+	[changeObservers removeObserver:observer];
+	
+	if (!changeObservers.hasObservers) {
+		changeObservers = nil;
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)performChangeBatch:(void (NS_NOESCAPE ^)(void))block
+{
+	if (block == nil) return;
+	
+	// The block may add or remove observers, so we hold onto the coalescer the batch was started on.
+	ZDCChangeCoalescer *coalescer = changeObservers;
+	
+	[coalescer beginBatch];
+	@try
+	{
+		block();
+	}
+	@finally
+	{
+		[coalescer endBatch];
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)flushChangeNotifications
+{
+	[changeObservers flush];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Equality
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -840,17 +1381,25 @@ static NSString *const kChangeset_deleted = @"deleted";
 #pragma mark ZDCObject Overrides
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
++ (NSMutableSet<NSString*> *)monitoredProperties
+{
+	NSMutableSet<NSString*> *monitoredProperties = [super monitoredProperties];
+	
+	// Configuration only - doesn't mutate the array
+	[monitoredProperties removeObject:NSStringFromSelector(@selector(snapshotThreshold))];
+	[monitoredProperties removeObject:NSStringFromSelector(@selector(compressesMoves))];
+	
+	return monitoredProperties;
+}
+
 - (void)makeImmutable
 {
 	[super makeImmutable];
 	
-	for (id obj in array)
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
-		{
-			[(ZDCObject *)obj makeImmutable];
-		}
-	}
+	[self enumerateChildObjectsIn:array withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child makeImmutable];
+	}];
 }
 
 - (BOOL)hasChanges
@@ -861,30 +1410,147 @@ static NSString *const kChangeset_deleted = @"deleted";
 	    deleted.count > 0 ||
 	    moved.count   > 0  ) return YES;
 	
-	for (id obj in array)
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
+	if (snapshot && ![self isIdenticalToSnapshot]) return YES;
+	
+	__block BOOL childHasChanges = NO;
+	[self enumerateChildObjectsIn:array withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		if ([child hasChanges])
 		{
-			if ([(ZDCObject *)obj hasChanges]) return YES;
+			__atomic_store_n(&childHasChanges, YES, __ATOMIC_RELAXED); // may be invoked concurrently
+			*stop = YES;
 		}
-	}
+	}];
 	
-	return NO;
+	return childHasChanges;
 }
 
 - (void)clearChangeTracking
 {
 	[super clearChangeTracking];
 	
-	[added removeAllIndexes];
-	[deleted removeAllObjects];
-	[moved removeAllObjects];
+	[self removeTrackedOperations];
+	snapshot = nil;
+	
+	[self enumerateChildObjectsIn:array withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child clearChangeTracking];
+	}];
+}
+
+/**
+ * Removes the operation-by-operation tracking info (added, moved & deleted).
+ */
+- (void)removeTrackedOperations
+{
+	if (storageIsShared)
+	{
+		// The tracking info is shared with a copy or checkpoint, so we can't modify it.
+		// But there's no need to copy the array either (the tracking info is created lazily).
+		
+		added = nil;
+		deleted = nil;
+		moved = nil;
+	}
+	else
+	{
+		[added removeAllIndexes];
+		[deleted removeAllObjects];
+		[moved removeAllObjects];
+	}
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)_willPerformUntrackedChanges
+{
+	if (added.count == 0 && moved.count == 0 && deleted.count == 0 && snapshot == nil) {
+		return nil; // nothing is being tracked
+	}
+	
+	NSArray *originalArray = snapshot ?: [self originalArray];
+	
+	if (ZDCArrayIsIdentical(originalArray, array))
+	{
+		// Nothing has changed, so there's nothing for the untracked mutations to shift.
+		
+		[self removeTrackedOperations];
+		snapshot = nil;
+		return nil;
+	}
+	
+	return @[ originalArray, [array copy] ];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_didPerformUntrackedChanges:(nullable id)context
+{
+	if (context == nil) return;
+	
+	NSArray *originalArray = context[0];
+	NSArray *previousArray = context[1];
 	
+	if (ZDCArrayIsIdentical(previousArray, array)) {
+		return; // the block didn't modify the array
+	}
+	
+	// The untracked mutations shifted the indexes that the tracked operations refer to.
+	// So we apply the untracked changes to the original array, and switch to snapshot-and-diff.
+	
+	snapshot = [[ZDCOrder rebaseOrder: originalArray
+	                        fromOrder: previousArray
+	                          toOrder: array
+	                   matchIdentical: YES] copy];
+	
+	[self removeTrackedOperations];
+}
+
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	stats.elementCount = array.count;
+	
+	if (snapshot)
+	{
+		// When using snapshot-and-diff, individual changes aren't tracked (they're calculated via diff).
+		// Instead the snapshot holds onto every original item.
+		
+		stats.originalCount = snapshot.count;
+		stats.trackingBytes = snapshot.count * sizeof(id);
+	}
+	else
+	{
+		stats.addedCount    = added.count;
+		stats.movedCount    = moved.count;
+		stats.deletedCount  = deleted.count;
+		stats.originalCount = deleted.count;
+		
+		// The indexSet stores ranges, so this is the worst case.
+		stats.trackingBytes = (added.count * sizeof(NSRange))
+		                    + [self estimatedTrackingBytesForEntryCount:(moved.count + deleted.count)];
+	}
+	
+	return stats;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block
+{
+	BOOL stop = NO;
 	for (id obj in array)
 	{
 		if ([obj isKindOfClass:[ZDCObject class]])
 		{
-			[(ZDCObject *)obj clearChangeTracking];
+			block((ZDCObject *)obj, &stop);
+			if (stop) break;
 		}
 	}
 }
@@ -897,6 +1563,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	if (![self hasChanges]) return nil;
 	
+	if (snapshot) {
+		return [self snapshotChangeset];
+	}
+	
 	// Reminder: ivars look like this:
 	//
 	// NSMutableIndexSet *added;
@@ -926,32 +1596,64 @@ static NSString *const kChangeset_deleted = @"deleted";
 		//   ...
 		// }
 		
-		changeset[kChangeset_deleted] = [deleted copy];
+		NSMutableDictionary *changeset_deleted = [NSMutableDictionary dictionaryWithCapacity:deleted.count];
+		[deleted enumerateKeysAndObjectsUsingBlock:^(NSNumber *idx, id retainedObj, BOOL *stop) {
+			
+			changeset_deleted[idx] = [self resolvedOriginal:retainedObj];
+		}];
+		
+		changeset[kChangeset_deleted] = [changeset_deleted copy];
 	}
 	
 	if (moved.count > 0)
 	{
 		// changeset: {
 		//   moved: {
-		//     idx: idx, ...
+		//     idx: idx, ...          // single item
+		//     idx: [1, idx, length]  // contiguous run, if compressesMoves (see `+[ZDCOrder blockMoveWithIndex:length:]`)
 		//   },
 		//   ...
 		// }
 		
-		changeset[kChangeset_moved] = [moved copy];
+		changeset[kChangeset_moved] = compressesMoves ? [ZDCOrder compressMovedIndexes:moved] : [moved copy];
 	}
 	
 	return changeset;
 }
 
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetFrom:(ZDCArray *)src to:(ZDCArray *)dst
+{
+	NSParameterAssert(src != nil);
+	NSParameterAssert(dst != nil);
+	
+	NSDictionary *changeset =
+	  [self changesetFromArray:src->array toArray:dst->array matchIdentical:NO compressMoves:dst->compressesMoves];
+	
+	return (changeset.count > 0) ? changeset : nil;
+}
+
 /**
  * See ZDCSyncable.h for method description.
  */
 - (nullable NSDictionary *)changeset
 {
-	NSDictionary *changeset = [self _changeset];
-	[self clearChangeTracking];
+	uint64_t const startTime = mach_absolute_time();
 	
+	NSError *error = nil;
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:&error];
+	
+	if (error == nil) {
+		[self clearChangeTracking]; // on failure, keep the changes (see changesetWithError:)
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
 	return changeset;
 }
 
@@ -960,7 +1662,16 @@ static NSString *const kChangeset_deleted = @"deleted";
  */
 - (nullable NSDictionary *)peakChangeset
 {
-	return [self _changeset];
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:NULL];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
 }
 
 - (BOOL)isMalformedChangeset:(NSDictionary *)changeset
@@ -1013,6 +1724,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		// changeset: {
 		//   moved: {
 		//     idx: idx, ...
+		//     idx: [version, idx, length], ...
 		//   },
 		//   ...
 		// }
@@ -1032,7 +1744,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 				
 				id value = changeset_moved[key];
 				
-				if (![value isKindOfClass:[NSNumber class]]) {
+				if (![value isKindOfClass:[NSNumber class]] && ![ZDCOrder getBlockMove:value index:NULL length:NULL]) {
 					return YES;
 				}
 			}
@@ -1047,6 +1759,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	// Important: `isMalformedChangeset:` must be called before invoking this method.
 	
+	ZDC_TRACE_SCOPE(trace, "ZDCArray", "_undo");
+	ZDC_TRACE_COUNTER("ZDCArray", "_undo: count", array.count);
+	
 	// This method is called from both `undo::` & `importChangesets::`.
 	//
 	// When called from `undo::`, there aren't any existing changes,
@@ -1057,6 +1772,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 	
 	BOOL const isSimpleUndo = ![self hasChanges];
 	
+	[self unshareStorage];
+	
 	// Change tracking algorithm:
 	//
 	// We have 3 sources of information to apply:
@@ -1102,6 +1819,14 @@ static NSString *const kChangeset_deleted = @"deleted";
 	NSDictionary *changeset_moved = changeset[kChangeset_moved];
 	if (changeset_moved.count > 0)
 	{
+		// Block-move entries are expanded into their individual items.
+		// The run is re-discovered when the redo changeset is generated (if compressesMoves is enabled).
+		
+		changeset_moved = [ZDCOrder expandMovedIndexes:changeset_moved];
+		if (changeset_moved == nil) {
+			return [self mismatchedChangeset];
+		}
+		
 		// We need to fix the `changeset_moved` dictionary.
 		//
 		// Here's the deal:
@@ -1154,6 +1879,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 			moved = [[NSMutableDictionary alloc] init];
 		}
 		
+		// If we're tracking via snapshot, the changeset gets calculated via diff.
+		// So we skip the manual bookkeeping of the `moved` dictionary.
+		BOOL const isTrackingViaSnapshot = (snapshot != nil);
+		
 		NSMutableIndexSet *indexesToRemove = [[NSMutableIndexSet alloc] init];
 		NSMutableArray *tuplesToReAdd = [NSMutableArray array];
 		
@@ -1162,7 +1891,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 			NSUInteger currentIdx = num.unsignedIntegerValue;
 			NSUInteger previousIdx = [changeset_moved[num] unsignedIntegerValue];
 			
-			if (isSimpleUndo)
+			if (isSimpleUndo && !isTrackingViaSnapshot)
 			{
 				moved[@(previousIdx)] = @(currentIdx); // just flip-flopping the values
 			}
@@ -1174,7 +1903,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 			}
 			
 			id obj = array[currentIdx];
-			[tuplesToReAdd addObject:@[ @(previousIdx), obj ]];
+			[tuplesToReAdd addObject:@[ @(previousIdx), obj, @(currentIdx) ]];
 		}
 		
 		[tuplesToReAdd sortUsingComparator:
@@ -1186,7 +1915,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 			return [idx1 compare:idx2];
 		}];
 		
-		if (!isSimpleUndo)
+		if (!isSimpleUndo && !isTrackingViaSnapshot)
 		{
 			// We're importing changesets - aka merging multiple changesets into one changeset
 			
@@ -1310,18 +2039,52 @@ static NSString *const kChangeset_deleted = @"deleted";
 		// Import: 5 of 5
 		//
 		// Perform the actual move (within the underlying array).
+		//
+		// The tuples are sorted by target index.
+		// So a run of consecutive target indexes (e.g. a block of rows that was dragged elsewhere)
+		// is re-inserted with a single bulk insert, rather than shifting the tail of the array once per item.
 		
 		[array removeObjectsAtIndexes:indexesToRemove];
+		[changeObservers detachIndexes:indexesToRemove];
+		
+		NSUInteger const tupleCount = tuplesToReAdd.count;
+		NSUInteger t = 0;
 		
-		for (NSArray *tuple in tuplesToReAdd)
+		while (t < tupleCount)
 		{
-			NSUInteger idx = [tuple[0] unsignedIntegerValue];
-			id obj = tuple[1];
+			NSUInteger const idx = [tuplesToReAdd[t][0] unsignedIntegerValue];
+			
+			NSUInteger length = 1;
+			while ((t + length < tupleCount) && ([tuplesToReAdd[t + length][0] unsignedIntegerValue] == idx + length))
+			{
+				length++;
+			}
 			
 			if (idx > array.count) {
 				return [self mismatchedChangeset];
 			}
-			[array insertObject:obj atIndex:idx];
+			
+			if (length == 1)
+			{
+				[array insertObject:tuplesToReAdd[t][1] atIndex:idx];
+			}
+			else
+			{
+				NSMutableArray *objs = [NSMutableArray arrayWithCapacity:length];
+				for (NSUInteger j = t; j < t + length; j++)
+				{
+					[objs addObject:tuplesToReAdd[j][1]];
+				}
+				
+				[array insertObjects:objs atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(idx, length)]];
+			}
+			
+			for (NSUInteger j = 0; j < length; j++)
+			{
+				[changeObservers reattachIndex:[tuplesToReAdd[t + j][2] unsignedIntegerValue] atIndex:(idx + j)];
+			}
+			
+			t += length;
 		}
 	}
 	
@@ -1365,9 +2128,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 	else
 	{
 		// Undo successful - generate redo changeset
-		NSDictionary *reverseChangeset = [self changeset];
+		NSDictionary *reverseChangeset = [self changesetWithError:&error];
+		
+		if (errPtr) *errPtr = error;
+		if (error) {
+			return nil;
+		}
 		
-		if (errPtr) *errPtr = nil;
 		return (reverseChangeset ?: @{}); // don't return nil without error
 	}
 }
@@ -1395,6 +2162,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		return [self malformedChangesetError];
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *error = [self _undo:changeset];
 	if (error)
 	{
@@ -1402,6 +2171,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		[self rollback];
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
 	return error;
 }
 
@@ -1431,9 +2201,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 	else
 	{
-		NSDictionary *mergedChangeset = [self changeset];
+		NSDictionary *mergedChangeset = [self changesetWithError:&error];
+		
+		if (errPtr) *errPtr = error;
+		if (error) {
+			return nil;
+		}
 		
-		if (errPtr) *errPtr = nil;
 		return (mergedChangeset ?: @{}); // don't return nil without error
 	}
 }
@@ -1468,6 +2242,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		return nil;
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *result_error = nil;
 	NSMutableArray<NSDictionary*> *changesets_redo = [NSMutableArray arrayWithCapacity:orderedChangesets.count];
 	
@@ -1484,7 +2260,14 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 		else
 		{
-			NSDictionary *redo = [self changeset];
+			NSDictionary *redo = [self changesetWithError:&result_error];
+			if (result_error)
+			{
+				// Unable to generate the redo changeset (an original couldn't be resolved).
+				// So this `_undo:` can't be reverted - we're in a bad state.
+				break;
+			}
+			
 			if (redo) {
 				[changesets_redo addObject:redo];
 			}
@@ -1505,23 +2288,25 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 	return result_error;
 }
 
 /**
  * Calculates the original order from the changesets.
+ * Returns nil if the changesets don't match the given order.
+ *
+ * Every object un-added or un-deleted along the way is recorded in `events` (if non-nil),
+ * in the order it was processed. That is, as a tuple of `@[ kChangeset_added, obj ]` or `@[ kChangeset_deleted, obj ]`.
+ * See `getAdded:deleted:fromEvents:`.
  */
-+ (BOOL)getOriginalOrder:(NSArray<id> **)outOriginalOrder
-                   added:(NSArray<id> **)outAdded
-                 deleted:(NSArray<id> **)outDeleted
-                    from:(NSArray<id> *)inOrder
-       pendingChangesets:(NSArray<NSDictionary*> *)pendingChangesets
++ (nullable NSArray<id> *)originalOrderFrom:(NSArray<id> *)inOrder
+                          pendingChangesets:(NSArray<NSDictionary*> *)pendingChangesets
+                                     events:(nullable NSMutableArray<NSArray*> *)events
 {
 	// Important: `isMalformedChangeset:` must be called before invoking this method.
 	
 	NSMutableArray<id> *order = [inOrder mutableCopy];
-	NSMutableArray<id> *added = [NSMutableArray array];
-	NSMutableArray<id> *deleted = [NSMutableArray array];
 	
 	for (NSDictionary *changeset in [pendingChangesets reverseObjectEnumerator])
 	{
@@ -1551,22 +2336,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 				}
 				
 				id obj = order[idx];
-				if ([deleted containsObject:obj])
-				{
-					// This item is deleted in a later changeset.
-					// So the two actions cancel each other out.
-					[deleted removeObject:obj];
-				}
-				else
-				{
-					[added addObject:obj];
-				}
+				[events addObject:@[ kChangeset_added, obj ]];
 				
 				[order removeObjectAtIndex:idx];
 			}];
 			
 			if (mismatch) {
-				return NO;
+				return nil;
 			}
 		}
 		
@@ -1577,6 +2353,11 @@ static NSString *const kChangeset_deleted = @"deleted";
 		NSDictionary *changeset_moved = changeset[kChangeset_moved];
 		if (changeset_moved.count > 0)
 		{
+			changeset_moved = [ZDCOrder expandMovedIndexes:changeset_moved];
+			if (changeset_moved == nil) {
+				return nil; // mismatchedChangeset
+			}
+			
 			if (changeset_added)
 			{
 				NSMutableDictionary *fixup = [NSMutableDictionary dictionaryWithCapacity:changeset_moved.count];
@@ -1610,7 +2391,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 				[indexesToRemove addIndex:currentIdx];
 				
 				if (currentIdx >= order.count) {
-					return NO; // mismatchedChangeset
+					return nil; // mismatchedChangeset
 				}
 				
 				id obj = order[currentIdx];
@@ -1634,7 +2415,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 				id obj = tuple[1];
 				
 				if (idx > order.count) {
-					return NO; // mismatchedChangeset
+					return nil; // mismatchedChangeset
 				}
 				
 				[order insertObject:obj atIndex:idx];
@@ -1661,36 +2442,72 @@ static NSString *const kChangeset_deleted = @"deleted";
 				NSUInteger index = num.unsignedIntegerValue;
 				
 				if (index > order.count) {
-					return NO; // mismatchedChangeset
+					return nil; // mismatchedChangeset
 				}
 				
-				if ([added containsObject:obj])
-				{
-					// This object gets re-added in a later changeset.
-					// So the two actions cancel each other out.
-					[added removeObject:obj];
-				}
-				else
-				{
-					[deleted addObject:obj];
-				}
+				[events addObject:@[ kChangeset_deleted, obj ]];
 	
 				[order insertObject:obj atIndex:index];
 			}
 		}
 	}
 	
-	*outOriginalOrder = order;
+	return order;
+}
+
+/**
+ * Calculates the list of added & deleted objects from the events recorded by `originalOrderFrom:::`.
+ */
++ (void)getAdded:(NSArray<id> **)outAdded
+         deleted:(NSArray<id> **)outDeleted
+      fromEvents:(NSArray<NSArray*> *)events
+{
+	NSMutableArray<id> *added = [NSMutableArray array];
+	NSMutableArray<id> *deleted = [NSMutableArray array];
+	
+	for (NSArray *event in events)
+	{
+		id obj = event[1];
+		
+		if (event[0] == kChangeset_added)
+		{
+			if ([deleted containsObject:obj])
+			{
+				// This item is deleted in a later changeset.
+				// So the two actions cancel each other out.
+				[deleted removeObject:obj];
+			}
+			else
+			{
+				[added addObject:obj];
+			}
+		}
+		else
+		{
+			if ([added containsObject:obj])
+			{
+				// This object gets re-added in a later changeset.
+				// So the two actions cancel each other out.
+				[added removeObject:obj];
+			}
+			else
+			{
+				[deleted addObject:obj];
+			}
+		}
+	}
+	
 	*outAdded = added;
 	*outDeleted = deleted;
-	
-	return YES;
 }
 
 - (nullable NSDictionary *)mergeCloudVersion:(id)inCloudVersion
                        withPendingChangesets:(nullable NSArray<NSDictionary*> *)pendingChangesets
                                        error:(NSError *_Nullable *_Nullable)errPtr
 {
+	ZDC_TRACE_SCOPE(trace, "ZDCArray", "mergeCloudVersion");
+	ZDC_TRACE_COUNTER("ZDCArray", "mergeCloudVersion: pendingChangesets", pendingChangesets.count);
+	
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
@@ -1724,6 +2541,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 	ZDCArray *cloudVersion = (ZDCArray *)inCloudVersion;
 	
+	uint64_t const startTime = mach_absolute_time();
+	
+	ZDC_TRACE_SCOPE(step, "ZDCArray", "mergeCloudVersion: step 1 of 6");
+	
 	// Step 1 of 6:
 	//
 	// If there are pending changes, calculate the original order.
@@ -1731,6 +2552,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 	//
 	// We also get the list of added & removed objects while we're at it.
 	//
+	// The calculation is memoized, since merges are often repeated with the same pending changesets
+	// (or the same pending changesets plus the changeset returned from the previous merge).
+	//
 	// Important:
 	//   We need to do this in the beginning, because we need an unmodified `array`.
 	
@@ -1740,18 +2564,37 @@ static NSString *const kChangeset_deleted = @"deleted";
 	
 	if (pendingChangesets.count > 0)
 	{
-		BOOL success = [[self class] getOriginalOrder: &originalOrder
-		                                        added: &local_added
-		                                      deleted: &local_deleted
-		                                         from: array
-		                            pendingChangesets: pendingChangesets];
-		if (!success)
+		if (originalOrderCache == nil) {
+			originalOrderCache = [[ZDCOriginalOrderCache alloc] init];
+		}
+		
+		Class cls = [self class];
+		NSArray<NSArray*> *events = nil;
+		
+		originalOrder =
+		  [originalOrderCache originalOrderFrom: array
+		                      pendingChangesets: pendingChangesets
+		                                 events: &events
+		                                 replay:
+		    ^NSArray *(NSArray *order, NSArray<NSDictionary*> *changesets, NSMutableArray *replayEvents)
+		{
+			return [cls originalOrderFrom:order pendingChangesets:changesets events:replayEvents];
+		}];
+		
+		if (originalOrder)
+		{
+			[cls getAdded:&local_added deleted:&local_deleted fromEvents:events];
+		}
+		else
 		{
+			[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 			if (errPtr) *errPtr = [self mismatchedChangeset];
 			return nil;
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 2 of 6");
+	
 	// Step 2 of 6:
 	//
 	// Add objects that were added by remote devices.
@@ -1782,6 +2625,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 3 of 6");
+	
 	// Step 3 of 6:
 	//
 	// Delete objects that were deleted by remote devices.
@@ -1816,6 +2661,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 4 of 6");
+	
 	// Step 4 of 6:
 	//
 	// Prepare to merge the order.
@@ -1860,6 +2707,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 	
 	NSAssert(order_localVersion.count == order_cloudVersion.count, @"Logic error");
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 5 of 6");
+	
 	// Step 5 of 6:
 	//
 	// So now we have a 2 lists of items that we can compare: local vs cloud.
@@ -1921,6 +2770,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		movedObjs_remote = [estimate mutableCopy];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 6 of 6");
+	
 	// Step 6 of 6:
 	//
 	// We have all the information we need to merge the order now.
@@ -1989,8 +2840,17 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
-	if (errPtr) *errPtr = nil;
-	return ([self changeset] ?: @{});
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	
+	NSError *error = nil;
+	NSDictionary *changeset = [self changesetWithError:&error];
+	
+	if (errPtr) *errPtr = error;
+	if (error) {
+		return nil;
+	}
+	
+	return (changeset ?: @{});
 }
 
 @end
@@ -0,0 +1,83 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ZDCChangeNotification;
+
+typedef void (^ZDCChangeObserverBlock)(ZDCChangeNotification *notification);
+
+/**
+ * Describes the changes made to an ordered container (ZDCArray or ZDCOrderedDictionary)
+ * since the previous notification was delivered.
+ *
+ * The index sets are designed to be handed directly to a table or collection view's batch updates:
+ * - removedIndexes & updatedIndexes refer to the state before the changes (i.e. at the previous notification)
+ * - insertedIndexes & the destination of moves refer to the state after the changes
+ *
+ * Intermediate states are coalesced. So an item that was inserted & then removed doesn't appear at all,
+ * and an item that was moved multiple times appears as a single move.
+ *
+ * See `-[ZDCArray addChangeObserver:]` & `-[ZDCOrderedDictionary addChangeObserver:]`.
+ */
+NS_SWIFT_NAME(ZDCChangeNotification_ObjC)
+@interface ZDCChangeNotification : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * The container that was changed.
+ */
+@property (nonatomic, weak, readonly, nullable) id object;
+
+/**
+ * Indexes of the items that were inserted (in the current state).
+ */
+@property (nonatomic, copy, readonly) NSIndexSet *insertedIndexes;
+
+/**
+ * Indexes of the items that were removed (in the previous state).
+ */
+@property (nonatomic, copy, readonly) NSIndexSet *removedIndexes;
+
+/**
+ * Items that were explicitly moved.
+ *
+ * key={currentIndex}, value={previousIndex}
+ *
+ * Items that merely shifted (because of inserts/removals before them) aren't included.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSNumber*, NSNumber*> *movedIndexes;
+
+/**
+ * Indexes of the items whose value was replaced (in the previous state).
+ *
+ * For a ZDCArray, replacing an item via `array[idx] = obj` is reported here.
+ * For a ZDCOrderedDictionary, setting a new value for an existing key is reported here.
+ */
+@property (nonatomic, copy, readonly) NSIndexSet *updatedIndexes;
+
+/**
+ * For a ZDCOrderedDictionary, the keys whose value was replaced (corresponds to updatedIndexes).
+ * For a ZDCArray this is always empty.
+ */
+@property (nonatomic, copy, readonly) NSSet<id> *updatedKeys;
+
+/**
+ * If YES, the container's contents were replaced wholesale (e.g. via `restoreCheckpoint:`),
+ * and the other properties don't describe the changes. The observer should reload everything.
+ */
+@property (nonatomic, readonly) BOOL requiresReload;
+
+/**
+ * Returns YES if the notification doesn't describe any changes.
+ */
+@property (nonatomic, readonly) BOOL isEmpty;
+
+@end
+
+NS_ASSUME_NONNULL_END
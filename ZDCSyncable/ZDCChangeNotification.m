@@ -0,0 +1,58 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCChangeNotification.h"
+#import "ZDCChangeCoalescer.h"
+
+
+@implementation ZDCChangeNotification
+
+@synthesize object = object;
+@synthesize insertedIndexes = insertedIndexes;
+@synthesize removedIndexes = removedIndexes;
+@synthesize movedIndexes = movedIndexes;
+@synthesize updatedIndexes = updatedIndexes;
+@synthesize updatedKeys = updatedKeys;
+@synthesize requiresReload = requiresReload;
+@dynamic isEmpty;
+
+- (instancetype)initWithObject:(nullable id)inObject
+               insertedIndexes:(NSIndexSet *)inInsertedIndexes
+                removedIndexes:(NSIndexSet *)inRemovedIndexes
+                  movedIndexes:(NSDictionary<NSNumber*, NSNumber*> *)inMovedIndexes
+                updatedIndexes:(NSIndexSet *)inUpdatedIndexes
+                   updatedKeys:(NSSet<id> *)inUpdatedKeys
+                requiresReload:(BOOL)inRequiresReload
+{
+	if ((self = [super init]))
+	{
+		object = inObject;
+		insertedIndexes = [inInsertedIndexes copy];
+		removedIndexes = [inRemovedIndexes copy];
+		movedIndexes = [inMovedIndexes copy];
+		updatedIndexes = [inUpdatedIndexes copy];
+		updatedKeys = [inUpdatedKeys copy];
+		requiresReload = inRequiresReload;
+	}
+	return self;
+}
+
+- (BOOL)isEmpty
+{
+	return !requiresReload
+	    && (insertedIndexes.count == 0)
+	    && (removedIndexes.count == 0)
+	    && (movedIndexes.count == 0)
+	    && (updatedIndexes.count == 0);
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:
+	  @"<ZDCChangeNotification %p: inserted=%@ removed=%@ moved=%@ updated=%@ reload=%@>",
+	  self, insertedIndexes, removedIndexes, movedIndexes, updatedIndexes, (requiresReload ? @"YES" : @"NO")];
+}
+
+@end
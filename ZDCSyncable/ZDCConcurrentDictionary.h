@@ -0,0 +1,165 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCObject.h"
+#import "ZDCSyncable.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * ZDCConcurrentDictionary is a thread-safe variant of ZDCDictionary.
+ *
+ * Keys are partitioned (by hash) across a number of stripes.
+ * Each stripe is a ZDCDictionary (with its own change tracking), protected by its own lock.
+ * So reads & writes of keys in different stripes can proceed concurrently on different threads.
+ *
+ * Operations that span the entire dictionary (such as `changeset`, `clearChangeTracking`, `allKeys`,
+ * undo & merge operations) acquire every stripe's lock (in order), and thus operate on a consistent cut.
+ *
+ * Each stripe also remembers whether it has been modified since its change tracking was last cleared.
+ * So the change tracking operations (`hasChanges`, `changeset`, `clearChangeTracking`, etc) only visit
+ * the stripes that may have changes, which keeps them proportional to the number of modified stripes,
+ * rather than the size of the dictionary. (Stripes containing child objects, e.g. a nested ZDCDictionary,
+ * are always visited, since a child may be modified directly.) If the visited stripes contain at least
+ * `concurrentChildThreshold` items in total, they're processed concurrently, and the results are combined.
+ *
+ * The changesets are in exactly the same format as ZDCDictionary changesets.
+ * So a changeset from one can be applied to the other (e.g. for undo), and stored/synced the same way.
+ *
+ * @note `count` sums the stripes one at a time. If the dictionary is being mutated concurrently,
+ *       the result may not correspond to any single point in time. Use `rawDictionary` for a consistent cut.
+ */
+NS_SWIFT_NAME(ZDCConcurrentDictionary_ObjC)
+@interface ZDCConcurrentDictionary<KeyType, ObjectType> : ZDCObject <NSCopying, ZDCSyncable>
+
+/**
+ * Creates an empty dictionary, with the default number of stripes (16).
+ */
+- (instancetype)init;
+
+/**
+ * Creates an empty dictionary, with the given number of stripes.
+ *
+ * More stripes means less contention between threads, and finer grained change tracking
+ * (e.g. a changeset only visits the stripes that were modified).
+ * But it makes operations that read the entire dictionary (e.g. `allKeys`) more expensive.
+ * For very large dictionaries (hundreds of thousands of keys), a few hundred stripes is reasonable.
+ *
+ * @param stripeCount
+ *   The number of independently locked partitions. This is rounded up to the next power of 2.
+ */
+- (instancetype)initWithStripeCount:(NSUInteger)stripeCount;
+
+/**
+ * The number of independently locked partitions.
+ */
+@property (nonatomic, readonly) NSUInteger stripeCount;
+
+#pragma mark Raw
+
+/**
+ * Returns a copy of the {key, value} tuples stored in the dictionary (as a consistent cut).
+ */
+@property (nonatomic, copy, readonly) NSDictionary<KeyType, ObjectType> *rawDictionary;
+
+#pragma mark Reading
+
+/**
+ * The number of items stored in the dictionary.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ * Returns the array of keys stored in the dictionary (as a consistent cut).
+ */
+- (NSArray<KeyType> *)allKeys;
+
+/**
+ * Returns YES if there's a value stored in the dictionary for the given key.
+ */
+- (BOOL)containsKey:(KeyType)key;
+
+/**
+ * Returns the stored object for the given key.
+ */
+- (nullable ObjectType)objectForKey:(KeyType)key;
+
+/**
+ * Returns the stored object for the given key.
+ *
+ * Allows you to use syntax:
+ * ```
+ * value = zdcDict[key]
+ * ```
+ */
+- (nullable ObjectType)objectForKeyedSubscript:(KeyType)key;
+
+#pragma mark Writing
+
+/**
+ * Stores the {key, value} tuple in the dictionary.
+ * If there's already a value stored for the given key, the old value is replaced with the new value.
+ */
+- (void)setObject:(nullable ObjectType)object forKey:(KeyType)key;
+
+/**
+ * Stores the {key, value} tuple in the dictionary.
+ * If there's already a value stored for the given key, the old value is replaced with the new value.
+ *
+ * Allows you to use syntax:
+ * ```
+ * zdcDict[key] = value
+ * ```
+ */
+- (void)setObject:(nullable ObjectType)object forKeyedSubscript:(KeyType)key;
+
+/**
+ * Removes the {key, value} tuple from the dictionary if the key exists.
+ * If the key doesn't exist, no changes are made.
+ */
+- (void)removeObjectForKey:(KeyType)key;
+
+/**
+ * Removes all items from the dictionary matching the given list of keys.
+ *
+ * @note Each key is removed under its stripe's lock. So the removal isn't atomic as a whole.
+ */
+- (void)removeObjectsForKeys:(NSArray<KeyType> *)keys;
+
+/**
+ * Removes all {key, value} tuples from the dictionary (atomically).
+ */
+- (void)removeAllObjects;
+
+#pragma mark Enumeration
+
+/**
+ * Enumerates all {key, value} tuples in the dictionary (as a consistent cut) with the given block.
+ *
+ * @note Every stripe is locked during the enumeration.
+ *       So the block must not access the dictionary (doing so would deadlock).
+ */
+- (void)enumerateKeysAndObjectsUsingBlock:(void (NS_NOESCAPE ^)(KeyType key, ObjectType obj, BOOL *stop))block;
+
+#pragma mark Equality
+
+/**
+ * Returns YES if `another` is of class ZDCConcurrentDictionary,
+ * and the receiver & another contain the same set of {key, value} tuples.
+ *
+ * @note It does NOT take into account the changeset of either instance.
+ */
+- (BOOL)isEqual:(nullable id)another;
+
+/**
+ * Returns YES if the receiver and `another` contain the same set of {key, value} tuples.
+ *
+ * @note It does NOT take into account the changeset of either instance.
+ */
+- (BOOL)isEqualToDictionary:(nullable ZDCConcurrentDictionary *)another;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1269 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCConcurrentDictionary.h"
+
+#import "ZDCDictionary.h"
+#import "ZDCObjectSubclass.h"
+
+#import <mach/mach_time.h>
+#import <pthread.h>
+
+// Changeset Keys (same format as ZDCDictionary)
+//
+static NSString *const kChangeset_refs   = @"refs";
+static NSString *const kChangeset_values = @"values";
+
+static NSUInteger const kDefaultStripeCount = 16;
+
+/**
+ * Per-stripe bookkeeping, which allows the dictionary-wide operations to skip untouched stripes.
+ */
+enum {
+	ZDCStripeFlag_Dirty    = 1 << 0, // modified since the stripe's change tracking was last cleared
+	ZDCStripeFlag_Children = 1 << 1, // may contain child objects (which can be modified without our knowledge)
+};
+
+/**
+ * Maps a key to its stripe.
+ *
+ * The hash is mixed first, since many hash functions (e.g. for NSNumber)
+ * don't distribute their low bits well, and we only use the low bits.
+ */
+static inline NSUInteger ZDCStripeIndex(id key, NSUInteger stripeMask)
+{
+	uint64_t h = (uint64_t)[key hash];
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	
+	return (NSUInteger)(h & stripeMask);
+}
+
+
+@implementation ZDCConcurrentDictionary {
+@private
+	
+	NSUInteger stripeMask;         // stripeCount - 1 (stripeCount is a power of 2)
+	NSArray<ZDCDictionary*> *stripes;
+	pthread_mutex_t *locks;        // locks[i] protects stripes[i]
+	uint8_t *stripeFlags;          // ZDCStripeFlag_X bitmask for stripes[i], protected by locks[i]
+}
+
+@synthesize stripeCount = stripeCount;
+@dynamic rawDictionary;
+@dynamic count;
+
+- (instancetype)init
+{
+	return [self initWithStripeCount:kDefaultStripeCount];
+}
+
+- (instancetype)initWithStripeCount:(NSUInteger)inStripeCount
+{
+	if ((self = [super init]))
+	{
+		[self allocateStripes:inStripeCount];
+	}
+	return self;
+}
+
+/**
+ * Used by `copyWithZone:`, which already has the stripes (copies of its own).
+ * The flags array is copied.
+ */
+- (instancetype)initWithStripes:(NSArray<ZDCDictionary*> *)inStripes flags:(const uint8_t *)inStripeFlags
+{
+	if ((self = [super init]))
+	{
+		stripeCount = inStripes.count; // always a power of 2
+		stripeMask = stripeCount - 1;
+		
+		stripes = inStripes;
+		[self allocateLocksAndFlags];
+		
+		memcpy(stripeFlags, inStripeFlags, stripeCount * sizeof(uint8_t));
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[self freeStripeStorage];
+}
+
+- (void)allocateStripes:(NSUInteger)inStripeCount
+{
+	[self freeStripeStorage];
+	
+	stripeCount = 1;
+	while (stripeCount < inStripeCount) {
+		stripeCount <<= 1;
+	}
+	stripeMask = stripeCount - 1;
+	
+	NSMutableArray<ZDCDictionary*> *newStripes = [NSMutableArray arrayWithCapacity:stripeCount];
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		ZDCDictionary *stripe = [[ZDCDictionary alloc] init];
+		stripe.retentionPolicy = self.retentionPolicy;
+		
+		[newStripes addObject:stripe];
+	}
+	stripes = [newStripes copy];
+	
+	[self allocateLocksAndFlags];
+}
+
+- (void)allocateLocksAndFlags
+{
+	locks = malloc(stripeCount * sizeof(pthread_mutex_t));
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		pthread_mutex_init(&locks[i], NULL);
+	}
+	
+	stripeFlags = calloc(stripeCount, sizeof(uint8_t));
+}
+
+- (void)freeStripeStorage
+{
+	if (locks)
+	{
+		for (NSUInteger i = 0; i < stripeCount; i++)
+		{
+			pthread_mutex_destroy(&locks[i]);
+		}
+		free(locks);
+		locks = NULL;
+	}
+	
+	free(stripeFlags);
+	stripeFlags = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Locking
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The locks are always acquired in index order, so multiple threads doing so can't deadlock.
+ * (A thread holding a single stripe's lock never attempts to acquire another.)
+ */
+- (void)lockAllStripes
+{
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		pthread_mutex_lock(&locks[i]);
+	}
+}
+
+- (void)unlockAllStripes
+{
+	for (NSUInteger i = stripeCount; i > 0; i--)
+	{
+		pthread_mutex_unlock(&locks[i-1]);
+	}
+}
+
+/**
+ * Invokes the block for every stripe that the change tracking methods need to visit.
+ * That is, stripes that have been modified since they were last cleared,
+ * and stripes that may contain child objects (since those can be modified directly).
+ *
+ * The stripes have disjoint keys, so they can be processed independently.
+ * If the visited stripes contain at least `concurrentChildThreshold` items in total,
+ * the block is invoked concurrently (one stripe per invocation).
+ *
+ * Important: This method must be invoked while holding every stripe's lock.
+ */
+- (void)enumerateTrackedStripesWithBlock:(void (^)(NSUInteger stripeIdx))block
+{
+	NSUInteger *indexes = malloc(stripeCount * sizeof(NSUInteger));
+	NSUInteger indexCount = 0;
+	NSUInteger elementCount = 0;
+	
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		if (stripeFlags[i] != 0)
+		{
+			indexes[indexCount++] = i;
+			elementCount += stripes[i].count;
+		}
+	}
+	
+	if ((indexCount > 1) && (elementCount >= [ZDCObject concurrentChildThreshold]))
+	{
+		// The calling thread holds the locks for the duration,
+		// so the worker threads have exclusive access to their stripes.
+		
+		dispatch_apply(indexCount, dispatch_get_global_queue(qos_class_self(), 0), ^(size_t i) {
+			
+			block(indexes[i]);
+		});
+	}
+	else
+	{
+		for (NSUInteger i = 0; i < indexCount; i++)
+		{
+			block(indexes[i]);
+		}
+	}
+	
+	free(indexes);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark NSCopying
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	// We don't invoke [super copyWithZone:], as it goes through `init`,
+	// which would allocate a full set of stripes (and locks) that we'd immediately throw away.
+	//
+	// Each stripe is copied via ZDCDictionary's copy-on-write, so this is O(stripeCount).
+	
+	NSMutableArray<ZDCDictionary*> *copiedStripes = [NSMutableArray arrayWithCapacity:stripeCount];
+	uint8_t *copiedFlags = malloc(stripeCount * sizeof(uint8_t));
+	
+	[self lockAllStripes];
+	{
+		for (ZDCDictionary *stripe in stripes)
+		{
+			[copiedStripes addObject:[stripe copy]];
+		}
+		memcpy(copiedFlags, stripeFlags, stripeCount * sizeof(uint8_t));
+	}
+	[self unlockAllStripes];
+	
+	ZDCConcurrentDictionary *copy =
+	  [[[self class] alloc] initWithStripes:[copiedStripes copy] flags:copiedFlags];
+	
+	free(copiedFlags);
+	
+	// The rest of [ZDCObject copyWithZone:]
+	// (The copied stripes already have the retentionPolicy.)
+	
+	[super copyChangeTrackingTo:copy];
+	if (self.retentionPolicy) {
+		copy.retentionPolicy = self.retentionPolicy;
+	}
+	
+	return copy;
+}
+
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCConcurrentDictionary *copy = (ZDCConcurrentDictionary *)another;
+	
+	// The stripes themselves are never swapped out (other threads may be waiting on their locks).
+	// Instead each stripe adopts the state of its counterpart.
+	
+	[self lockAllStripes];
+	{
+		for (NSUInteger i = 0; i < stripeCount; i++)
+		{
+			[stripes[i] restoreStateFromCopy:copy->stripes[i]];
+			stripeFlags[i] = copy->stripeFlags[i];
+		}
+	}
+	[self unlockAllStripes];
+	
+	[super restoreStateFromCopy:another];
+}
+
+/**
+ * Used by `publishSnapshot`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block
+{
+	// The receiver is a fresh copy, so there's no need to lock the stripes.
+	// Each stripe is a copy too (see `copyWithZone:`), so it can replace its children directly.
+	
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		if (stripeFlags[i] & ZDCStripeFlag_Children)
+		{
+			[stripes[i] _replaceChildObjectsUsingBlock:block];
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Raw
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (NSDictionary *)rawDictionary
+{
+	NSMutableDictionary *raw = [NSMutableDictionary dictionary];
+	
+	[self lockAllStripes];
+	{
+		for (ZDCDictionary *stripe in stripes)
+		{
+			[raw addEntriesFromDictionary:stripe.rawDictionary];
+		}
+	}
+	[self unlockAllStripes];
+	
+	return [raw copy];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Reading
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (NSUInteger)count
+{
+	NSUInteger count = 0;
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		pthread_mutex_lock(&locks[i]);
+		count += stripes[i].count;
+		pthread_mutex_unlock(&locks[i]);
+	}
+	
+	return count;
+}
+
+- (NSArray *)allKeys
+{
+	NSMutableArray *keys = [NSMutableArray array];
+	
+	[self lockAllStripes];
+	{
+		for (ZDCDictionary *stripe in stripes)
+		{
+			[keys addObjectsFromArray:[stripe allKeys]];
+		}
+	}
+	[self unlockAllStripes];
+	
+	return keys;
+}
+
+- (BOOL)containsKey:(id)key
+{
+	if (key == nil) return NO;
+	
+	NSUInteger const idx = ZDCStripeIndex(key, stripeMask);
+	
+	pthread_mutex_lock(&locks[idx]);
+	BOOL const result = [stripes[idx] containsKey:key];
+	pthread_mutex_unlock(&locks[idx]);
+	
+	return result;
+}
+
+- (id)objectForKey:(id)key
+{
+	if (key == nil) return nil;
+	
+	NSUInteger const idx = ZDCStripeIndex(key, stripeMask);
+	
+	pthread_mutex_lock(&locks[idx]);
+	id result = [stripes[idx] objectForKey:key];
+	pthread_mutex_unlock(&locks[idx]);
+	
+	return result;
+}
+
+- (id)objectForKeyedSubscript:(id)key
+{
+	return [self objectForKey:key];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Writing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)setObject:(nullable id)object forKey:(id)key
+{
+	// Checked before acquiring the lock, so the exception doesn't leave the stripe locked.
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	if (key == nil) {
+		return;
+	}
+	
+	NSUInteger const idx = ZDCStripeIndex(key, stripeMask);
+	
+	uint8_t flags = ZDCStripeFlag_Dirty;
+	if ([object isKindOfClass:[ZDCObject class]]) {
+		flags |= ZDCStripeFlag_Children;
+	}
+	
+	pthread_mutex_lock(&locks[idx]);
+	[stripes[idx] setObject:object forKey:key];
+	stripeFlags[idx] |= flags;
+	pthread_mutex_unlock(&locks[idx]);
+}
+
+- (void)setObject:(nullable id)object forKeyedSubscript:(id)key
+{
+	[self setObject:object forKey:key];
+}
+
+- (void)removeObjectForKey:(id)key
+{
+	[self setObject:nil forKey:key];
+}
+
+- (void)removeObjectsForKeys:(NSArray<id> *)keys
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	for (id key in keys)
+	{
+		[self setObject:nil forKey:key];
+	}
+}
+
+- (void)removeAllObjects
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	[self lockAllStripes];
+	{
+		for (NSUInteger i = 0; i < stripeCount; i++)
+		{
+			if (stripes[i].count > 0)
+			{
+				[stripes[i] removeAllObjects];
+				stripeFlags[i] |= ZDCStripeFlag_Dirty;
+			}
+		}
+	}
+	[self unlockAllStripes];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Enumeration
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)enumerateKeysAndObjectsUsingBlock:(void (NS_NOESCAPE ^)(id key, id obj, BOOL *stop))block
+{
+	__block BOOL stop = NO;
+	
+	[self lockAllStripes];
+	{
+		for (ZDCDictionary *stripe in stripes)
+		{
+			[stripe enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *innerStop) {
+				
+				block(key, obj, &stop);
+				if (stop) {
+					*innerStop = YES;
+				}
+			}];
+			
+			if (stop) {
+				break;
+			}
+		}
+	}
+	[self unlockAllStripes];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Equality
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (BOOL)isEqual:(nullable id)another
+{
+	if ([another isKindOfClass:[ZDCConcurrentDictionary class]]) {
+		return [self isEqualToDictionary:(ZDCConcurrentDictionary *)another];
+	} else {
+		return NO;
+	}
+}
+
+- (BOOL)isEqualToDictionary:(nullable ZDCConcurrentDictionary *)another
+{
+	if (another == nil) return NO; // null dereference crash ahead
+	if (another == self) return YES;
+	
+	return [self.rawDictionary isEqualToDictionary:another.rawDictionary];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark ZDCObject Overrides
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)setRetentionPolicy:(nullable id<ZDCRetentionPolicy>)retentionPolicy
+{
+	[super setRetentionPolicy:retentionPolicy];
+	
+	// The stripes track the original values, so they need the policy.
+	
+	[self lockAllStripes];
+	{
+		for (ZDCDictionary *stripe in stripes)
+		{
+			stripe.retentionPolicy = retentionPolicy;
+		}
+	}
+	[self unlockAllStripes];
+}
+
+- (void)makeImmutable
+{
+	[super makeImmutable];
+	
+	[self lockAllStripes];
+	{
+		for (ZDCDictionary *stripe in stripes)
+		{
+			[stripe makeImmutable];
+		}
+	}
+	[self unlockAllStripes];
+}
+
+- (BOOL)hasChanges
+{
+	[self lockAllStripes];
+	BOOL const result = [self _hasChanges];
+	[self unlockAllStripes];
+	
+	return result;
+}
+
+- (void)clearChangeTracking
+{
+	[self lockAllStripes];
+	[self _clearChangeTracking];
+	[self unlockAllStripes];
+}
+
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	
+	[self lockAllStripes];
+	{
+		for (ZDCDictionary *stripe in stripes)
+		{
+			ZDCTrackingStatistics const stripeStats = [stripe trackingStatistics];
+			
+			stats.elementCount  += stripeStats.elementCount;
+			stats.addedCount    += stripeStats.addedCount;
+			stats.deletedCount  += stripeStats.deletedCount;
+			stats.originalCount += stripeStats.originalCount;
+			stats.trackingBytes += stripeStats.trackingBytes;
+			stats.mutationCount += stripeStats.mutationCount;
+		}
+	}
+	[self unlockAllStripes];
+	
+	return stats;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block
+{
+	// The stripes are an implementation detail, so we enumerate their children directly.
+	// Stripes that have never contained a child object are skipped.
+	
+	__block BOOL stop = NO;
+	
+	[self lockAllStripes];
+	{
+		for (NSUInteger i = 0; i < stripeCount; i++)
+		{
+			if ((stripeFlags[i] & ZDCStripeFlag_Children) == 0) {
+				continue;
+			}
+			
+			[stripes[i] enumerateChildObjectsWithBlock:^(ZDCObject *child, BOOL *innerStop) {
+				
+				block(child, &stop);
+				if (stop) {
+					*innerStop = YES;
+				}
+			}];
+			
+			if (stop) {
+				break;
+			}
+		}
+	}
+	[self unlockAllStripes];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Tracking Internals
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Important: The methods in this section must be invoked while holding every stripe's lock.
+
+- (BOOL)_hasChanges
+{
+	if ([super hasChanges]) return YES;
+	
+	__block BOOL result = NO;
+	[self enumerateTrackedStripesWithBlock:^(NSUInteger i) {
+		
+		if (__atomic_load_n(&result, __ATOMIC_RELAXED)) {
+			return; // already found one (may be invoked concurrently)
+		}
+		if (self->stripes[i].hasChanges) {
+			__atomic_store_n(&result, YES, __ATOMIC_RELAXED);
+		}
+	}];
+	
+	return result;
+}
+
+- (void)_clearChangeTracking
+{
+	[super clearChangeTracking];
+	
+	[self enumerateTrackedStripesWithBlock:^(NSUInteger i) {
+		
+		[self->stripes[i] clearChangeTracking];
+		self->stripeFlags[i] &= ~ZDCStripeFlag_Dirty;
+	}];
+}
+
+/**
+ * Combines the given stripe changesets (which have disjoint keys) into a single changeset.
+ */
+- (NSDictionary *)combineChangesets:(NSArray<NSDictionary*> *)stripeChangesets
+{
+	// changeset: {
+	//   refs: {
+	//     key: changeset, ...
+	//   },
+	//   values: {
+	//     key: oldValue, ...
+	//   }
+	// }
+	
+	NSMutableDictionary *changeset = [NSMutableDictionary dictionaryWithCapacity:2];
+	NSMutableDictionary *refs = nil;
+	NSMutableDictionary *values = nil;
+	
+	for (NSDictionary *stripeChangeset in stripeChangesets)
+	{
+		NSDictionary *stripe_refs = stripeChangeset[kChangeset_refs];
+		if (stripe_refs)
+		{
+			if (refs == nil) {
+				refs = [[NSMutableDictionary alloc] init];
+				changeset[kChangeset_refs] = refs;
+			}
+			[refs addEntriesFromDictionary:stripe_refs];
+		}
+		
+		NSDictionary *stripe_values = stripeChangeset[kChangeset_values];
+		if (stripe_values)
+		{
+			if (values == nil) {
+				values = [[NSMutableDictionary alloc] init];
+				changeset[kChangeset_values] = values;
+			}
+			[values addEntriesFromDictionary:stripe_values];
+		}
+	}
+	
+	return changeset;
+}
+
+/**
+ * Performs the inverse of `combineChangesets:`.
+ * That is, partitions the given changeset by stripe.
+ *
+ * Important: `isMalformedChangeset:` must be called before invoking this method.
+ *
+ * @return
+ *   An array with stripeCount items.
+ *   Stripes that aren't affected by the changeset are assigned an empty changeset.
+ */
+- (NSArray<NSDictionary*> *)splitChangeset:(NSDictionary *)changeset
+{
+	NSMutableArray<NSMutableDictionary*> *result = [NSMutableArray arrayWithCapacity:stripeCount];
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		[result addObject:[NSMutableDictionary dictionary]];
+	}
+	
+	for (NSString *changesetKey in @[ kChangeset_refs, kChangeset_values ])
+	{
+		NSDictionary *entries = changeset[changesetKey];
+		
+		[entries enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+			
+			NSMutableDictionary *stripeChangeset = result[ZDCStripeIndex(key, self->stripeMask)];
+			
+			NSMutableDictionary *stripeEntries = stripeChangeset[changesetKey];
+			if (stripeEntries == nil) {
+				stripeEntries = [NSMutableDictionary dictionary];
+				stripeChangeset[changesetKey] = stripeEntries;
+			}
+			stripeEntries[key] = obj;
+		}];
+	}
+	
+	return result;
+}
+
+- (nullable NSDictionary *)_changeset
+{
+	// Each stripe builds its own changeset (concurrently, for large dictionaries).
+	// The results are then combined on this thread.
+	
+	__strong NSDictionary **results = (__strong NSDictionary **)calloc(stripeCount, sizeof(NSDictionary *));
+	__block BOOL unresolved = NO;
+	
+	[self enumerateTrackedStripesWithBlock:^(NSUInteger i) {
+		
+		NSError *error = nil;
+		results[i] = [self->stripes[i] peakChangesetWithError:&error]; // nil if the stripe doesn't have changes
+		
+		if (error) {
+			__atomic_store_n(&unresolved, YES, __ATOMIC_RELAXED);
+		}
+	}];
+	
+	if (unresolved)
+	{
+		// The stripes may have been processed on other threads,
+		// so forward the failure to the changeset being generated on this thread.
+		[self markChangesetUnresolved];
+	}
+	
+	NSMutableArray<NSDictionary*> *stripeChangesets = [NSMutableArray array];
+	
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		if (results[i])
+		{
+			[stripeChangesets addObject:results[i]];
+			results[i] = nil; // release before free
+		}
+	}
+	free(results);
+	
+	if ((stripeChangesets.count == 0) && ![super hasChanges]) {
+		return nil;
+	}
+	
+	return [self combineChangesets:stripeChangesets];
+}
+
+- (void)_rollback
+{
+	[self enumerateTrackedStripesWithBlock:^(NSUInteger i) {
+		
+		[self->stripes[i] rollback];
+		self->stripeFlags[i] &= ~ZDCStripeFlag_Dirty;
+	}];
+	[super clearChangeTracking];
+}
+
+/**
+ * Returns the flags for a stripe that's about to apply the given (stripe) changeset.
+ * Undo & import may restore old values, which can include child objects.
+ */
+- (uint8_t)stripeFlagsForChangeset:(NSDictionary *)stripeChangeset
+{
+	uint8_t flags = ZDCStripeFlag_Dirty;
+	
+	if ([stripeChangeset[kChangeset_refs] count] > 0)
+	{
+		flags |= ZDCStripeFlag_Children;
+	}
+	else
+	{
+		for (id value in [stripeChangeset[kChangeset_values] objectEnumerator])
+		{
+			if ([value isKindOfClass:[ZDCObject class]])
+			{
+				flags |= ZDCStripeFlag_Children;
+				break;
+			}
+		}
+	}
+	
+	return flags;
+}
+
+- (nullable NSError *)_performUndo:(NSDictionary *)changeset
+{
+	if ([self _hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		return [self hasChangesError];
+	}
+	
+	if ([self isMalformedChangeset:changeset])
+	{
+		return [self malformedChangesetError];
+	}
+	
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSArray<NSDictionary*> *stripeChangesets = [self splitChangeset:changeset];
+	NSError *error = nil;
+	
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		if (stripeChangesets[i].count > 0)
+		{
+			stripeFlags[i] |= [self stripeFlagsForChangeset:stripeChangesets[i]];
+			
+			error = [stripes[i] performUndo:stripeChangesets[i]];
+			if (error) break;
+		}
+	}
+	
+	if (error)
+	{
+		// Abandon botched undo attempt - revert to original state
+		[self _rollback];
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
+	return error;
+}
+
+- (nullable NSError *)_importChangesets:(NSArray<NSDictionary*> *)orderedChangesets
+{
+	if ([self _hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		return [self hasChangesError];
+	}
+	
+	// Check for malformed changesets.
+	// It's better to detect this early on, before we start modifying the object.
+	//
+	for (NSDictionary *changeset in orderedChangesets)
+	{
+		if ([self isMalformedChangeset:changeset])
+		{
+			return [self malformedChangesetError];
+		}
+	}
+	
+	if (orderedChangesets.count == 0) {
+		return nil;
+	}
+	
+	uint64_t const startTime = mach_absolute_time();
+	
+	// The stripes have disjoint keys, so each stripe can import its own portion of the changesets independently.
+	
+	NSMutableArray<NSMutableArray<NSDictionary*>*> *stripeChangesets = [NSMutableArray arrayWithCapacity:stripeCount];
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		[stripeChangesets addObject:[NSMutableArray arrayWithCapacity:orderedChangesets.count]];
+	}
+	
+	for (NSDictionary *changeset in orderedChangesets)
+	{
+		NSArray<NSDictionary*> *split = [self splitChangeset:changeset];
+		for (NSUInteger i = 0; i < stripeCount; i++)
+		{
+			if (split[i].count > 0) {
+				[stripeChangesets[i] addObject:split[i]];
+				stripeFlags[i] |= [self stripeFlagsForChangeset:split[i]];
+			}
+		}
+	}
+	
+	NSError *error = nil;
+	
+	for (NSUInteger i = 0; i < stripeCount; i++)
+	{
+		if (stripeChangesets[i].count > 0)
+		{
+			error = [stripes[i] importChangesets:stripeChangesets[i]];
+			if (error) break;
+		}
+	}
+	
+	if (error)
+	{
+		// Abort botched attempt - Revert every stripe to its original state
+		[self _rollback];
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	return error;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark ZDCSyncable
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)changeset
+{
+	uint64_t const startTime = mach_absolute_time();
+	
+	[self lockAllStripes];
+	
+	NSError *error = nil;
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:&error];
+	
+	if (error == nil) {
+		[self _clearChangeTracking]; // on failure, keep the changes (see changesetWithError:)
+	}
+	
+	[self unlockAllStripes];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)peakChangeset
+{
+	uint64_t const startTime = mach_absolute_time();
+	
+	[self lockAllStripes];
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:NULL];
+	[self unlockAllStripes];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
+}
+
+- (BOOL)isMalformedChangeset:(NSDictionary *)changeset
+{
+	if (changeset.count == 0) {
+		return NO;
+	}
+	
+	// changeset: {
+	//   refs: {
+	//     <key: Any> : <changeset: NSDictionary>, ...
+	//   },
+	//   values: {
+	//     <key: Any> : <oldValue: ZDCNull|ZDCRef|Any>, ...
+	//   }
+	// }
+	
+	for (NSString *changesetKey in @[ kChangeset_refs, kChangeset_values ])
+	{
+		id entries = changeset[changesetKey];
+		if (entries && ![entries isKindOfClass:[NSDictionary class]]) {
+			return YES;
+		}
+	}
+	
+	// The stripes check the entries themselves
+	return NO;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)undo:(NSDictionary *)changeset error:(NSError **)errPtr
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	NSDictionary *reverseChangeset = nil;
+	
+	[self lockAllStripes];
+	
+	NSError *error = [self _performUndo:changeset];
+	if (!error)
+	{
+		// Undo successful - generate redo changeset
+		reverseChangeset = [self resolveChangeset:^NSDictionary *{
+			
+			return [self _changeset];
+			
+		} error:&error];
+		
+		if (error == nil) {
+			[self _clearChangeTracking];
+		}
+	}
+	
+	[self unlockAllStripes];
+	
+	if (errPtr) *errPtr = error;
+	if (error) {
+		return nil;
+	}
+	else {
+		return (reverseChangeset ?: @{}); // don't return nil without error
+	}
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSError *)performUndo:(NSDictionary *)changeset
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	[self lockAllStripes];
+	NSError *error = [self _performUndo:changeset];
+	[self unlockAllStripes];
+	
+	return error;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (void)rollback
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	[self lockAllStripes];
+	[self _rollback];
+	[self unlockAllStripes];
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)mergeChangesets:(NSArray<NSDictionary*> *)orderedChangesets
+                                     error:(NSError *_Nullable *_Nullable)errPtr
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	NSDictionary *mergedChangeset = nil;
+	
+	[self lockAllStripes];
+	
+	NSError *error = [self _importChangesets:orderedChangesets];
+	if (!error)
+	{
+		mergedChangeset = [self resolveChangeset:^NSDictionary *{
+			
+			return [self _changeset];
+			
+		} error:&error];
+		
+		if (error == nil) {
+			[self _clearChangeTracking];
+		}
+	}
+	
+	[self unlockAllStripes];
+	
+	if (errPtr) *errPtr = error;
+	if (error) {
+		return nil;
+	}
+	else {
+		return (mergedChangeset ?: @{}); // don't return nil without error
+	}
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSError *)importChangesets:(NSArray<NSDictionary*> *)orderedChangesets
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	[self lockAllStripes];
+	NSError *error = [self _importChangesets:orderedChangesets];
+	[self unlockAllStripes];
+	
+	return error;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)mergeCloudVersion:(id)inCloudVersion
+                       withPendingChangesets:(nullable NSArray<NSDictionary*> *)pendingChangesets
+                                       error:(NSError *_Nullable *_Nullable)errPtr
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if (![inCloudVersion isKindOfClass:[self class]] || (inCloudVersion == self))
+	{
+		if (errPtr) *errPtr = [self incorrectObjectClass];
+		return nil;
+	}
+	ZDCConcurrentDictionary *cloudVersion = (ZDCConcurrentDictionary *)inCloudVersion;
+	
+	// Read the cloudVersion before locking ourself, so we never hold both sets of locks at once.
+	NSDictionary *cloudRaw = cloudVersion.rawDictionary;
+	
+	[self lockAllStripes];
+	
+	NSError *error = nil;
+	NSDictionary *mergedChangeset = nil;
+	
+	if ([self _hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		error = [self hasChangesError];
+	}
+	
+	// Check for malformed changesets.
+	// It's better to detect this early on, before we start modifying the object.
+	//
+	for (NSDictionary *changeset in pendingChangesets)
+	{
+		if (!error && [self isMalformedChangeset:changeset])
+		{
+			error = [self malformedChangesetError];
+		}
+	}
+	
+	if (!error)
+	{
+		uint64_t const startTime = mach_absolute_time();
+		
+		// Step 1 of 2:
+		//
+		// Partition the cloudVersion & pendingChangesets by stripe.
+		// The stripes have disjoint keys, so each one can then be merged independently.
+		
+		NSMutableArray<NSMutableDictionary*> *cloudStripes = [NSMutableArray arrayWithCapacity:stripeCount];
+		NSMutableArray<NSMutableArray<NSDictionary*>*> *pendingStripes = [NSMutableArray arrayWithCapacity:stripeCount];
+		
+		for (NSUInteger i = 0; i < stripeCount; i++)
+		{
+			[cloudStripes addObject:[NSMutableDictionary dictionary]];
+			[pendingStripes addObject:[NSMutableArray arrayWithCapacity:pendingChangesets.count]];
+		}
+		
+		[cloudRaw enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+			
+			NSUInteger const idx = ZDCStripeIndex(key, self->stripeMask);
+			
+			cloudStripes[idx][key] = obj;
+			if ([obj isKindOfClass:[ZDCObject class]]) {
+				self->stripeFlags[idx] |= ZDCStripeFlag_Children;
+			}
+		}];
+		
+		for (NSDictionary *changeset in pendingChangesets)
+		{
+			NSArray<NSDictionary*> *split = [self splitChangeset:changeset];
+			for (NSUInteger i = 0; i < stripeCount; i++)
+			{
+				// Empty changesets are kept (they're harmless), so every stripe sees the same number of changesets.
+				[pendingStripes[i] addObject:split[i]];
+			}
+		}
+		
+		// Step 2 of 2:
+		//
+		// Merge each stripe, and combine the results.
+		//
+		// If a stripe fails, we stop there, and undo the stripes that were already merged.
+		// So the caller isn't left with a partially merged object (and no changeset to undo it).
+		
+		NSMutableArray<NSDictionary*> *stripeChangesets = [NSMutableArray arrayWithCapacity:stripeCount];
+		
+		for (NSUInteger i = 0; i < stripeCount; i++)
+		{
+			ZDCDictionary *cloudStripe =
+			  [[ZDCDictionary alloc] initWithDictionary:cloudStripes[i] copyItems:NO trackChanges:NO];
+			
+			NSError *stripeError = nil;
+			NSDictionary *stripeChangeset =
+			  [stripes[i] mergeCloudVersion: cloudStripe
+			          withPendingChangesets: pendingStripes[i]
+			                          error: &stripeError];
+			
+			if (stripeError)
+			{
+				// Just like a ZDCDictionary, the failed stripe keeps its changes (so they aren't lost).
+				stripeFlags[i] |= ZDCStripeFlag_Dirty;
+				error = stripeError;
+				
+				for (NSUInteger j = i; j > 0; j--)
+				{
+					NSDictionary *mergedStripeChangeset = stripeChangesets[j-1];
+					if (mergedStripeChangeset.count == 0) continue;
+					
+					NSError *undoError = nil;
+					[stripes[j-1] undo:mergedStripeChangeset error:&undoError];
+					
+					if (undoError) {
+						stripeFlags[j-1] |= ZDCStripeFlag_Dirty;
+					}
+				}
+				break;
+			}
+			
+			[stripeChangesets addObject:(stripeChangeset ?: @{})];
+		}
+		
+		if (!error)
+		{
+			[super clearChangeTracking];
+			mergedChangeset = [self combineChangesets:stripeChangesets];
+		}
+		
+		[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	}
+	
+	[self unlockAllStripes];
+	
+	if (errPtr) *errPtr = error;
+	if (error) {
+		return nil;
+	}
+	else {
+		return mergedChangeset;
+	}
+}
+
+@end
@@ -54,6 +54,13 @@ NS_SWIFT_NAME(ZDCDictionary_ObjC)
  */
 - (instancetype)initWithDictionary:(nullable NSDictionary<KeyType, ObjectType> *)raw copyItems:(BOOL)copyItems;
 
+/**
+ * Same as `initWithDictionary:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithDictionary:(nullable NSDictionary<KeyType, ObjectType> *)raw
+                         copyItems:(BOOL)copyItems
+                      trackChanges:(BOOL)trackChanges;
+
 #pragma mark Raw
 
 /**
@@ -144,6 +151,31 @@ NS_SWIFT_NAME(ZDCDictionary_ObjC)
  */
 - (void)enumerateKeysAndObjectsUsingBlock:(void (^)(KeyType key, ObjectType obj, BOOL *stop))block;
 
+/**
+ * Enumerates all {key, value} tuples in the dictionary, with the given options.
+ *
+ * Pass NSEnumerationConcurrent to spread the enumeration across the available cores
+ * (the block must then be thread-safe). The dictionary must not be mutated during the enumeration.
+ */
+- (void)enumerateKeysAndObjectsWithOptions:(NSEnumerationOptions)opts
+                                usingBlock:(void (^)(KeyType key, ObjectType obj, BOOL *stop))block;
+
+#pragma mark Diff
+
+/**
+ * Calculates the changeset between two versions of a dictionary,
+ * without replaying the individual operations that led from one to the other.
+ *
+ * The result is a standard (undo) changeset.
+ * That is, invoking `undo:error:` on a dictionary equal to `dst` will produce a dictionary equal to `src`.
+ *
+ * @note Values are compared using `isEqual:`. Values that differ are recorded as replaced values,
+ *       even if they're syncable objects (i.e. no nested changesets are calculated).
+ *
+ * @return The changeset, or nil if the dictionaries are equal.
+ */
++ (nullable NSDictionary<NSString*, id> *)changesetFrom:(ZDCDictionary *)src to:(ZDCDictionary *)dst;
+
 #pragma mark Equality
 
 /**
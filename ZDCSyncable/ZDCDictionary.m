@@ -8,6 +8,9 @@
 #import "ZDCObjectSubclass.h"
 #import "ZDCNull.h"
 #import "ZDCRef.h"
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
 
 // Encoding/Decoding Keys
 //
@@ -29,6 +32,8 @@ static NSString *const kChangeset_values = @"values";
 	NSMutableDictionary *dict;
 	
 	NSMutableDictionary<id, id> *originalValues;
+	
+	BOOL storageIsShared; // shared with a copy or checkpoint (see `unshareStorage`)
 }
 
 @dynamic rawDictionary;
@@ -45,6 +50,11 @@ static NSString *const kChangeset_values = @"values";
 }
 
 - (instancetype)initWithDictionary:(nullable NSDictionary *)inRaw copyItems:(BOOL)flag
+{
+	return [self initWithDictionary:inRaw copyItems:flag trackChanges:YES];
+}
+
+- (instancetype)initWithDictionary:(nullable NSDictionary *)inRaw copyItems:(BOOL)flag trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -52,7 +62,7 @@ static NSString *const kChangeset_values = @"values";
 		  [[NSMutableDictionary alloc] initWithDictionary:inRaw copyItems:flag] :
 		  [[NSMutableDictionary alloc] init];
 		
-		if (dict.count > 0)
+		if (trackChanges && (dict.count > 0))
 		{
 			originalValues = [[NSMutableDictionary alloc] init];
 			
@@ -103,8 +113,16 @@ static NSString *const kChangeset_values = @"values";
 {
 	ZDCDictionary *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
 	
-	copy->dict = [self->dict mutableCopy];
-	copy->originalValues = [self->originalValues mutableCopy];
+	// The storage is shared between both objects, and copied upon the next mutation (copy-on-write).
+	// An immutable object is never mutated, so there's no need to mark it (it may be shared across threads).
+	
+	copy->dict = self->dict;
+	copy->originalValues = self->originalValues;
+	
+	copy->storageIsShared = YES;
+	if (!self.isImmutable) {
+		self->storageIsShared = YES;
+	}
 	
 	return copy;
 }
@@ -127,6 +145,65 @@ static NSString *const kChangeset_values = @"values";
 	}
 }
 
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCDictionary *copy = (ZDCDictionary *)another;
+	
+	// The copy shares its storage with the checkpoint, so we adopt it as-is (still marked as shared).
+	
+	dict = copy->dict;
+	originalValues = copy->originalValues;
+	storageIsShared = copy->storageIsShared;
+	
+	[super restoreStateFromCopy:another];
+}
+
+/**
+ * Used by `publishSnapshot`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block
+{
+	for (id key in [dict allKeys])
+	{
+		id obj = dict[key];
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			dict[key] = block((ZDCObject *)obj);
+		}
+	}
+	
+	for (id key in [originalValues allKeys])
+	{
+		id obj = originalValues[key];
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			originalValues[key] = block((ZDCObject *)obj);
+		}
+	}
+}
+
+/**
+ * The storage (and change tracking info) may be shared with copies & checkpoints.
+ * This method must be invoked before modifying any of it.
+ */
+- (void)unshareStorage
+{
+	if (storageIsShared)
+	{
+		dict = [dict mutableCopy];
+		originalValues = [originalValues mutableCopy];
+		
+		storageIsShared = NO;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Raw
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -181,6 +258,7 @@ static NSString *const kChangeset_values = @"values";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (key == nil) {
 		return;
 	}
@@ -207,6 +285,7 @@ static NSString *const kChangeset_values = @"values";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if ([self containsKey:key])
 	{
@@ -220,6 +299,7 @@ static NSString *const kChangeset_values = @"values";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (keys.count == 0) return;
 	
@@ -238,6 +318,7 @@ static NSString *const kChangeset_values = @"values";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	for (id key in [dict allKeys])
 	{
@@ -252,6 +333,19 @@ static NSString *const kChangeset_values = @"values";
 
 - (void)_willUpdateObjectForKey:(NSString *const)key
 {
+	if ([self isChangeTrackingSuspended])
+	{
+		// The new value becomes the original value.
+		// Unless the key was added (within the changeset), in which case it's still an added key.
+		
+		if (originalValues[key] != [ZDCNull null]) {
+			originalValues[key] = nil;
+		}
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(key != nil);
 	
 	if (originalValues == nil) {
@@ -259,12 +353,23 @@ static NSString *const kChangeset_values = @"values";
 	}
 	
 	if (originalValues[key] == nil) {
-		originalValues[key] = dict[key];
+		originalValues[key] = [self retainedOriginal:[self frozenOriginal:dict[key]]];
 	}
 }
 
 - (void)_willInsertObjectForKey:(NSString *const)key
 {
+	if ([self isChangeTrackingSuspended])
+	{
+		// The key becomes part of the original state.
+		// (If it was removed within the changeset, then the removal is discarded.)
+		
+		originalValues[key] = nil;
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(key != nil);
 	
 	if (originalValues == nil) {
@@ -278,6 +383,17 @@ static NSString *const kChangeset_values = @"values";
 
 - (void)_willRemoveObjectForKey:(NSString *const)key
 {
+	if ([self isChangeTrackingSuspended])
+	{
+		// The key is removed from the original state.
+		// (If it was added or modified within the changeset, then that change is discarded.)
+		
+		originalValues[key] = nil;
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(key != nil);
 	
 	if (originalValues == nil) {
@@ -287,7 +403,7 @@ static NSString *const kChangeset_values = @"values";
 	id originalValue = originalValues[key];
 	if (originalValue == nil)
 	{
-		originalValues[key] = dict[key];
+		originalValues[key] = [self retainedOriginal:[self frozenOriginal:dict[key]]];
 	}
 	else if (originalValue == [ZDCNull null])
 	{
@@ -319,6 +435,12 @@ static NSString *const kChangeset_values = @"values";
 	[dict enumerateKeysAndObjectsUsingBlock:block];
 }
 
+- (void)enumerateKeysAndObjectsWithOptions:(NSEnumerationOptions)opts
+                                usingBlock:(void (^)(id key, id obj, BOOL *stop))block
+{
+	[dict enumerateKeysAndObjectsWithOptions:opts usingBlock:block];
+}
+
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
                                   objects:(id __unsafe_unretained _Nullable [_Nonnull])buffer
                                     count:(NSUInteger)len
@@ -354,13 +476,10 @@ static NSString *const kChangeset_values = @"values";
 {
 	[super makeImmutable];
 	
-	for (id obj in [dict objectEnumerator])
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
-		{
-			[(ZDCObject *)obj makeImmutable];
-		}
-	}
+	[self enumerateChildObjectsIn:dict withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child makeImmutable];
+	}];
 }
 
 - (BOOL)hasChanges
@@ -369,28 +488,81 @@ static NSString *const kChangeset_values = @"values";
 	
 	if (originalValues.count  > 0) return YES;
 	
-	for (id obj in [dict objectEnumerator])
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
+	__block BOOL childHasChanges = NO;
+	[self enumerateChildObjectsIn:dict withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		if ([child hasChanges])
 		{
-			if ([(ZDCObject *)obj hasChanges]) return YES;
+			__atomic_store_n(&childHasChanges, YES, __ATOMIC_RELAXED); // may be invoked concurrently
+			*stop = YES;
 		}
-	}
+	}];
 	
-	return NO;
+	return childHasChanges;
 }
 
 - (void)clearChangeTracking
 {
 	[super clearChangeTracking];
 	
-	[originalValues removeAllObjects];
+	if (storageIsShared) {
+		originalValues = nil; // shared with a copy or checkpoint (created lazily)
+	}
+	else {
+		[originalValues removeAllObjects];
+	}
+	
+	[self enumerateChildObjectsIn:dict withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child clearChangeTracking];
+	}];
+}
+
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	stats.elementCount = dict.count;
+	
+	for (id key in originalValues)
+	{
+		id originalValue = originalValues[key];
+		BOOL const exists = (dict[key] != nil);
+		
+		if (originalValue == [ZDCNull null])
+		{
+			if (exists) {
+				stats.addedCount++;
+			}
+		}
+		else
+		{
+			stats.originalCount++;
+			if (!exists) {
+				stats.deletedCount++;
+			}
+		}
+	}
+	
+	stats.trackingBytes = [self estimatedTrackingBytesForEntryCount:originalValues.count];
 	
+	return stats;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block
+{
+	BOOL stop = NO;
 	for (id obj in [dict objectEnumerator])
 	{
 		if ([obj isKindOfClass:[ZDCObject class]])
 		{
-			[(ZDCObject *)obj clearChangeTracking];
+			block((ZDCObject *)obj, &stop);
+			if (stop) break;
 		}
 	}
 }
@@ -473,16 +645,15 @@ static NSString *const kChangeset_values = @"values";
 		
 		NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:originalValues.count];
 		
-		[originalValues enumerateKeysAndObjectsUsingBlock:^(id key, id originalValue, BOOL *stop) {
+		[originalValues enumerateKeysAndObjectsUsingBlock:^(id key, id retainedValue, BOOL *stop) {
+			
+			id originalValue = [self resolvedOriginal:retainedValue];
 			
 			if (refs[key]) {
 				values[key] = [ZDCRef ref];
 			}
-			else if ([originalValue conformsToProtocol:@protocol(NSCopying)]) {
-				values[key] = [originalValue copy];
-			}
 			else {
-				values[key] = originalValue;
+				values[key] = [self changesetValueForOriginal:originalValue]; // frozen when captured
 			}
 		}];
 		
@@ -492,14 +663,62 @@ static NSString *const kChangeset_values = @"values";
 	return changeset;
 }
 
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetFrom:(ZDCDictionary *)src to:(ZDCDictionary *)dst
+{
+	NSParameterAssert(src != nil);
+	NSParameterAssert(dst != nil);
+	
+	// changeset: {
+	//   values: {
+	//     key: oldValue, ...
+	//   }
+	// }
+	
+	NSMutableDictionary *values = [NSMutableDictionary dictionary];
+	
+	[src->dict enumerateKeysAndObjectsUsingBlock:^(id key, id srcValue, BOOL *stop) {
+		
+		id dstValue = dst->dict[key];
+		if (dstValue == nil || ![srcValue isEqual:dstValue])
+		{
+			values[key] = [src changesetValueForOriginal:[src frozenOriginal:srcValue]];
+		}
+	}];
+	
+	[dst->dict enumerateKeysAndObjectsUsingBlock:^(id key, id dstValue, BOOL *stop) {
+		
+		if (src->dict[key] == nil) {
+			values[key] = [ZDCNull null]; // added
+		}
+	}];
+	
+	if (values.count == 0) return nil;
+	
+	return @{ kChangeset_values: values };
+}
+
 /**
  * See ZDCSyncable.h for method description.
  */
 - (nullable NSDictionary *)changeset
 {
-	NSDictionary *changeset = [self _changeset];
-	[self clearChangeTracking];
+	uint64_t const startTime = mach_absolute_time();
 	
+	NSError *error = nil;
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:&error];
+	
+	if (error == nil) {
+		[self clearChangeTracking]; // on failure, keep the changes (see changesetWithError:)
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
 	return changeset;
 }
 
@@ -508,7 +727,16 @@ static NSString *const kChangeset_values = @"values";
  */
 - (nullable NSDictionary *)peakChangeset
 {
-	return [self _changeset];
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:NULL];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
 }
 
 - (BOOL)isMalformedChangeset:(NSDictionary *)changeset
@@ -562,6 +790,9 @@ static NSString *const kChangeset_values = @"values";
 {
 	// Important: `isMalformedChangeset:` must be called before invoking this method.
 	
+	ZDC_TRACE_SCOPE(trace, "ZDCDictionary", "_undo");
+	ZDC_TRACE_COUNTER("ZDCDictionary", "_undo: count", dict.count);
+	
 	NSDictionary *changeset_refs = changeset[kChangeset_refs];
 	if (changeset_refs.count > 0)
 	{
@@ -619,9 +850,13 @@ static NSString *const kChangeset_values = @"values";
 	else
 	{
 		// Undo successful - generate redo changeset
-		NSDictionary *reverseChangeset = [self changeset];
+		NSDictionary *reverseChangeset = [self changesetWithError:&error];
+		
+		if (errPtr) *errPtr = error;
+		if (error) {
+			return nil;
+		}
 		
-		if (errPtr) *errPtr = nil;
 		return (reverseChangeset ?: @{}); // don't return nil without error
 	}
 }
@@ -649,6 +884,8 @@ static NSString *const kChangeset_values = @"values";
 		return [self malformedChangesetError];
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *error = [self _undo:changeset];
 	if (error)
 	{
@@ -656,6 +893,7 @@ static NSString *const kChangeset_values = @"values";
 		[self rollback];
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
 	return error;
 }
 
@@ -685,9 +923,13 @@ static NSString *const kChangeset_values = @"values";
 	}
 	else
 	{
-		NSDictionary *mergedChangeset = [self changeset];
+		NSDictionary *mergedChangeset = [self changesetWithError:&error];
+		
+		if (errPtr) *errPtr = error;
+		if (error) {
+			return nil;
+		}
 		
-		if (errPtr) *errPtr = nil;
 		return (mergedChangeset ?: @{}); // don't return nil without error
 	}
 }
@@ -725,6 +967,8 @@ static NSString *const kChangeset_values = @"values";
 		return nil;
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *result_error = nil;
 	NSMutableArray<NSDictionary*> *changesets_redo = [NSMutableArray arrayWithCapacity:orderedChangesets.count];
 	
@@ -741,7 +985,14 @@ static NSString *const kChangeset_values = @"values";
 		}
 		else
 		{
-			NSDictionary *redo = [self changeset];
+			NSDictionary *redo = [self changesetWithError:&result_error];
+			if (result_error)
+			{
+				// Unable to generate the redo changeset (an original couldn't be resolved).
+				// So this `_undo:` can't be reverted - we're in a bad state.
+				break;
+			}
+			
 			if (redo) {
 				[changesets_redo addObject:redo];
 			}
@@ -762,6 +1013,7 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 	return result_error;
 }
 
@@ -772,6 +1024,9 @@ static NSString *const kChangeset_values = @"values";
                        withPendingChangesets:(nullable NSArray<NSDictionary*> *)pendingChangesets
                                        error:(NSError *_Nullable *_Nullable)errPtr
 {
+	ZDC_TRACE_SCOPE(trace, "ZDCDictionary", "mergeCloudVersion");
+	ZDC_TRACE_COUNTER("ZDCDictionary", "mergeCloudVersion: pendingChangesets", pendingChangesets.count);
+	
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
@@ -805,6 +1060,10 @@ static NSString *const kChangeset_values = @"values";
 	}
 	ZDCDictionary *cloudVersion = (ZDCDictionary *)inCloudVersion;
 	
+	uint64_t const startTime = mach_absolute_time();
+	
+	ZDC_TRACE_SCOPE(step, "ZDCDictionary", "mergeCloudVersion: step 1 of 4");
+	
 	// Step 1 of 4:
 	//
 	// We need to determine which keys have been changed locally, and what the original versions were.
@@ -826,6 +1085,8 @@ static NSString *const kChangeset_values = @"values";
 		}];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 2 of 4");
+	
 	// Step 2 of 4:
 	//
 	// Next, we're going to enumerate what values are in the cloud.
@@ -882,6 +1143,8 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}];
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 3 of 4");
+	
 	// Step 3 of 4:
 	//
 	// Next we need to determine if any values were deleted by remote devices.
@@ -908,6 +1171,8 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 4 of 4");
+	
 	// Step 4 of 4:
 	//
 	// Merge the ZDCSyncable properties
@@ -962,8 +1227,17 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}
 	
-	if (errPtr) *errPtr = nil;
-	return ([self changeset] ?: @{});
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	
+	NSError *error = nil;
+	NSDictionary *changeset = [self changesetWithError:&error];
+	
+	if (errPtr) *errPtr = error;
+	if (error) {
+		return nil;
+	}
+	
+	return (changeset ?: @{});
 }
 
 @end
@@ -0,0 +1,189 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCObject.h"
+#import "ZDCSyncable.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * ZDCInt64Array tracks changes to an array of 64-bit integers.
+ *
+ * It's the unboxed counterpart of a ZDCArray containing NSNumbers.
+ * The values are stored in a contiguous C buffer, so there's no object per element,
+ * and lookups compare integers (rather than sending `isEqual:` to every NSNumber).
+ *
+ * It implements the ZDCSyncable protocol, and its changesets use the exact same format as ZDCArray.
+ * So a changeset from one can be applied to the other (assuming the ZDCArray contains NSNumbers),
+ * and the values within changesets are NSNumbers.
+ *
+ * Change tracking:
+ *   Changes are tracked via snapshot-and-diff.
+ *   That is, the first tracked change copies the original values (which is a single memcpy),
+ *   and the changeset is calculated (by diffing the copy against the current values) when it's requested.
+ *
+ * @note Merges (`mergeCloudVersion:withPendingChangesets:error:`) run the ZDCArray algorithm on boxed values.
+ *       Merges are rare compared to reads & writes, and this guarantees identical merge results.
+ */
+NS_SWIFT_NAME(ZDCInt64Array_ObjC)
+@interface ZDCInt64Array : ZDCObject <NSCoding, NSCopying, ZDCSyncable>
+
+/**
+ * Creates an empty array.
+ */
+- (instancetype)init;
+
+/**
+ * Creates a ZDCInt64Array initialized by copying the given values.
+ */
+- (instancetype)initWithValues:(nullable const int64_t *)values count:(NSUInteger)count;
+
+/**
+ * Same as `initWithValues:count:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithValues:(nullable const int64_t *)values
+                         count:(NSUInteger)count
+                  trackChanges:(BOOL)trackChanges;
+
+/**
+ * Creates a ZDCInt64Array initialized with the `longLongValue` of each number in the given array.
+ */
+- (instancetype)initWithArray:(nullable NSArray<NSNumber*> *)array;
+
+#pragma mark Raw
+
+/**
+ * Returns the values as an array of NSNumbers.
+ *
+ * @note The returned value is a (boxed) copy.
+ *       Thus changes to the ZDCInt64Array will not be reflected in the returned value.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSNumber*> *rawArray;
+
+#pragma mark Reading
+
+/**
+ * The number of values stored in the array.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ * Returns the value stored at the given index.
+ *
+ * @important Raises an NSRangeException if index is out-of-bounds.
+ */
+- (int64_t)valueAtIndex:(NSUInteger)idx;
+
+/**
+ * Copies the values within the given range into the buffer.
+ *
+ * @important Raises an NSRangeException if the range is out-of-bounds.
+ */
+- (void)getValues:(int64_t *)buffer range:(NSRange)range;
+
+/**
+ * Returns YES if the value is contained in the array.
+ *
+ * Membership is answered via a hash table of the values,
+ * which is built on first use, and then maintained as the array changes.
+ */
+- (BOOL)containsValue:(int64_t)value;
+
+/**
+ * Returns the lowest index of the value within the array.
+ * If not found in the array, returns NSNotFound.
+ */
+- (NSUInteger)indexOfValue:(int64_t)value;
+
+#pragma mark Writing
+
+/**
+ * Adds the value to the end of the array.
+ */
+- (void)addValue:(int64_t)value;
+
+/**
+ * Inserts the value within the array at the given index.
+ *
+ * @important Raises an NSRangeException if index is greater than the number of elements in the array.
+ */
+- (void)insertValue:(int64_t)value atIndex:(NSUInteger)idx;
+
+/**
+ * Replaces the value at the given index.
+ *
+ * @important Raises an NSRangeException if index is out-of-bounds.
+ */
+- (void)replaceValueAtIndex:(NSUInteger)idx withValue:(int64_t)value;
+
+/**
+ * Use this method when you only need to change a value's index.
+ *
+ * @param oldIndex
+ *   The current index of the value.
+ *
+ * @param newIndex
+ *   The index to use AFTER the value has been removed (same as `-[ZDCArray moveObjectAtIndex:toIndex:]`).
+ */
+- (void)moveValueAtIndex:(NSUInteger)oldIndex toIndex:(NSUInteger)newIndex;
+
+/**
+ * Removes all occurrences of the value.
+ */
+- (void)removeValue:(int64_t)value;
+
+/**
+ * Removes the value currently at the given index.
+ *
+ * @important Raises an NSRangeException if index is out-of-bounds.
+ */
+- (void)removeValueAtIndex:(NSUInteger)idx;
+
+/**
+ * Removes all values from the array.
+ * Afterwards the array will be empty.
+ */
+- (void)removeAllValues;
+
+#pragma mark Enumeration
+
+/**
+ * Enumerates all values in the array,
+ * starting from index 0 and ending with the largest index in the array.
+ */
+- (void)enumerateValuesUsingBlock:(void (^)(int64_t value, NSUInteger idx, BOOL *stop))block;
+
+#pragma mark Diff
+
+/**
+ * Calculates the changeset between two versions of an array,
+ * without replaying the individual operations that led from one to the other.
+ *
+ * This is the same algorithm as `+[ZDCArray changesetFrom:to:]`, with values matched via an integer hash table.
+ *
+ * @return The changeset, or nil if the arrays are equal.
+ */
++ (nullable NSDictionary<NSString*, id> *)changesetFrom:(ZDCInt64Array *)src to:(ZDCInt64Array *)dst;
+
+#pragma mark Equality
+
+/**
+ * Returns YES if `another` is of class ZDCInt64Array,
+ * and the receiver & another contain the same values in the same order.
+ *
+ * @note It does NOT take into account the changeset of either instance.
+ */
+- (BOOL)isEqual:(nullable id)another;
+
+/**
+ * Returns YES if the receiver and `another` contain the same values in the same order.
+ *
+ * @note It does NOT take into account the changeset of either instance.
+ */
+- (BOOL)isEqualToInt64Array:(nullable ZDCInt64Array *)another;
+
+@end
+
+NS_ASSUME_NONNULL_END
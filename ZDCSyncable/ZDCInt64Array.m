@@ -0,0 +1,1415 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCInt64Array.h"
+
+#import "ZDCArray.h"
+#import "ZDCInt64Table.h"
+#import "ZDCObjectSubclass.h"
+#import "ZDCOrder.h"
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
+
+// Encoding/Decoding Keys
+//
+static int const kCurrentVersion = 0;
+#pragma unused(kCurrentVersion)
+
+static NSString *const kCoding_version = @"version";
+static NSString *const kCoding_values  = @"values";
+
+// Changeset Keys
+//
+// Important: These must match the keys used by ZDCArray.
+//
+static NSString *const kChangeset_added   = @"added";
+static NSString *const kChangeset_moved   = @"moved";
+static NSString *const kChangeset_deleted = @"deleted";
+
+
+@implementation ZDCInt64Array {
+@private
+
+	int64_t *values;
+	NSUInteger count;
+	NSUInteger capacity;
+	
+	ZDCInt64Table valueCounts; // value => number of occurrences (built lazily, see `containsValue:`)
+	BOOL hasValueCounts;
+	
+	int64_t *snapshot;         // original values (taken on the first tracked change)
+	NSUInteger snapshotCount;
+	BOOL hasSnapshot;
+}
+
+@dynamic rawArray;
+@synthesize count = count;
+
+- (instancetype)init
+{
+	return [self initWithValues:NULL count:0 trackChanges:YES];
+}
+
+- (instancetype)initWithValues:(const int64_t *)inValues count:(NSUInteger)inCount
+{
+	return [self initWithValues:inValues count:inCount trackChanges:YES];
+}
+
+- (instancetype)initWithValues:(const int64_t *)inValues count:(NSUInteger)inCount trackChanges:(BOOL)trackChanges
+{
+	if ((self = [super init]))
+	{
+		if (inValues && inCount > 0)
+		{
+			[self ensureCapacity:inCount];
+			memcpy(values, inValues, inCount * sizeof(int64_t));
+			count = inCount;
+			
+			if (trackChanges)
+			{
+				// The original state is the empty array
+				hasSnapshot = YES;
+				snapshotCount = 0;
+			}
+		}
+	}
+	return self;
+}
+
+- (instancetype)initWithArray:(NSArray<NSNumber*> *)array
+{
+	NSUInteger const inCount = array.count;
+	int64_t *inValues = malloc(MAX(inCount, (NSUInteger)1) * sizeof(int64_t));
+	
+	NSUInteger i = 0;
+	for (NSNumber *num in array)
+	{
+		inValues[i++] = num.longLongValue;
+	}
+	
+	self = [self initWithValues:inValues count:inCount trackChanges:YES];
+	
+	free(inValues);
+	return self;
+}
+
+- (void)dealloc
+{
+	free(values);
+	free(snapshot);
+	ZDCInt64TableFree(&valueCounts);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark NSCoding
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (id)initWithCoder:(NSCoder *)decoder
+{
+	if ((self = [super init]))
+	{
+		// The values are stored in little-endian byte order
+		
+		NSData *data = [decoder decodeObjectForKey:kCoding_values];
+		NSUInteger const inCount = data.length / sizeof(int64_t);
+		
+		if (inCount > 0)
+		{
+			[self ensureCapacity:inCount];
+			[data getBytes:values length:(inCount * sizeof(int64_t))];
+			
+			for (NSUInteger i = 0; i < inCount; i++)
+			{
+				values[i] = (int64_t)OSSwapLittleToHostInt64((uint64_t)values[i]);
+			}
+			
+			count = inCount;
+		}
+		
+		// Note: ephemeral properties (i.e. for change tracking) are not serialized
+	}
+	return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+	if (kCurrentVersion != 0) {
+		[coder encodeInt:kCurrentVersion forKey:kCoding_version];
+	}
+	
+	NSMutableData *data = [NSMutableData dataWithLength:(count * sizeof(int64_t))];
+	int64_t *buffer = (int64_t *)data.mutableBytes;
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		buffer[i] = (int64_t)OSSwapHostToLittleInt64((uint64_t)values[i]);
+	}
+	
+	[coder encodeObject:data forKey:kCoding_values];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark NSCopying
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	ZDCInt64Array *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
+	
+	[copy ensureCapacity:self->count];
+	if (self->count > 0) {
+		memcpy(copy->values, self->values, self->count * sizeof(int64_t));
+	}
+	copy->count = self->count;
+	
+	[self copySnapshotTo:copy];
+	
+	return copy;
+}
+
+/**
+ * For complicated copying scenarios, such as nested deep copies.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)copyChangeTrackingTo:(id)another
+{
+	if ([another isKindOfClass:[ZDCInt64Array class]])
+	{
+		__unsafe_unretained ZDCInt64Array *copy = (ZDCInt64Array *)another;
+		if (!copy.isImmutable)
+		{
+			[self copySnapshotTo:copy];
+			
+			[super copyChangeTrackingTo:another];
+		}
+	}
+}
+
+- (void)copySnapshotTo:(ZDCInt64Array *)copy
+{
+	free(copy->snapshot);
+	copy->snapshot = NULL;
+	copy->snapshotCount = 0;
+	copy->hasSnapshot = self->hasSnapshot;
+	
+	if (self->snapshotCount > 0)
+	{
+		copy->snapshot = malloc(self->snapshotCount * sizeof(int64_t));
+		memcpy(copy->snapshot, self->snapshot, self->snapshotCount * sizeof(int64_t));
+		copy->snapshotCount = self->snapshotCount;
+	}
+}
+
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCInt64Array *copy = (ZDCInt64Array *)another;
+	
+	// We swap buffers with the copy, so our current buffers are freed along with it.
+	
+	int64_t *const oldValues = values;
+	NSUInteger const oldCapacity = capacity;
+	values = copy->values;
+	capacity = copy->capacity;
+	count = copy->count;
+	copy->values = oldValues;
+	copy->capacity = oldCapacity;
+	
+	ZDCInt64Table const oldValueCounts = valueCounts;
+	valueCounts = copy->valueCounts;
+	hasValueCounts = copy->hasValueCounts;
+	copy->valueCounts = oldValueCounts;
+	
+	int64_t *const oldSnapshot = snapshot;
+	snapshot = copy->snapshot;
+	snapshotCount = copy->snapshotCount;
+	hasSnapshot = copy->hasSnapshot;
+	copy->snapshot = oldSnapshot;
+	
+	[super restoreStateFromCopy:another];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Storage
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)ensureCapacity:(NSUInteger)needed
+{
+	if (needed <= capacity) return;
+	
+	NSUInteger newCapacity = MAX(capacity * 2, (NSUInteger)8);
+	while (newCapacity < needed) {
+		newCapacity *= 2;
+	}
+	
+	values = reallocf(values, newCapacity * sizeof(int64_t));
+	capacity = newCapacity;
+}
+
+- (void)countValue:(int64_t)value
+{
+	if (!hasValueCounts) return;
+	
+	NSUInteger const occurrences = ZDCInt64TableGet(&valueCounts, value);
+	ZDCInt64TableSet(&valueCounts, value, (occurrences == NSNotFound) ? 1 : (occurrences + 1));
+}
+
+- (void)uncountValue:(int64_t)value
+{
+	if (!hasValueCounts) return;
+	
+	NSUInteger const occurrences = ZDCInt64TableGet(&valueCounts, value);
+	if (occurrences <= 1) {
+		ZDCInt64TableRemove(&valueCounts, value);
+	}
+	else if (occurrences != NSNotFound) {
+		ZDCInt64TableSet(&valueCounts, value, (occurrences - 1));
+	}
+}
+
+- (void)_insertValue:(int64_t)value atIndex:(NSUInteger)idx
+{
+	[self ensureCapacity:(count + 1)];
+	
+	if (idx < count) {
+		memmove(values + idx + 1, values + idx, (count - idx) * sizeof(int64_t));
+	}
+	values[idx] = value;
+	count++;
+	
+	[self countValue:value];
+}
+
+- (void)_removeValueAtIndex:(NSUInteger)idx
+{
+	[self uncountValue:values[idx]];
+	
+	if (idx + 1 < count) {
+		memmove(values + idx, values + idx + 1, (count - idx - 1) * sizeof(int64_t));
+	}
+	count--;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Raw
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (NSArray<NSNumber*> *)rawArray
+{
+	NSMutableArray<NSNumber*> *array = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		[array addObject:@(values[i])];
+	}
+	
+	return [array copy];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Reading
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (int64_t)valueAtIndex:(NSUInteger)idx
+{
+	if (idx >= count) {
+		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
+	}
+	
+	return values[idx];
+}
+
+- (void)getValues:(int64_t *)buffer range:(NSRange)range
+{
+	if (NSMaxRange(range) > count) {
+		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
+	}
+	
+	if (range.length > 0) {
+		memcpy(buffer, values + range.location, range.length * sizeof(int64_t));
+	}
+}
+
+- (BOOL)containsValue:(int64_t)value
+{
+	if (!hasValueCounts && self.isImmutable)
+	{
+		// Immutable instances may be read from multiple threads (e.g. a published snapshot),
+		// so we don't build the lookup table lazily here.
+		return ([self indexOfValue:value] != NSNotFound);
+	}
+	
+	if (!hasValueCounts)
+	{
+		ZDCInt64TableInit(&valueCounts, count);
+		hasValueCounts = YES;
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			[self countValue:values[i]];
+		}
+	}
+	
+	return ZDCInt64TableContains(&valueCounts, value);
+}
+
+- (NSUInteger)indexOfValue:(int64_t)value
+{
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		if (values[i] == value) {
+			return i;
+		}
+	}
+	
+	return NSNotFound;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Writing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)addValue:(int64_t)value
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	[self _willMutate];
+	[self _insertValue:value atIndex:count];
+}
+
+- (void)insertValue:(int64_t)value atIndex:(NSUInteger)idx
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	if (idx > count) {
+		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
+		return;
+	}
+	
+	[self _willMutate];
+	[self _insertValue:value atIndex:idx];
+}
+
+- (void)replaceValueAtIndex:(NSUInteger)idx withValue:(int64_t)value
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	if (idx >= count) {
+		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
+		return;
+	}
+	
+	[self _willMutate];
+	
+	[self uncountValue:values[idx]];
+	values[idx] = value;
+	[self countValue:value];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)moveValueAtIndex:(NSUInteger)oldIndex toIndex:(NSUInteger)newIndex
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if (oldIndex >= count) {
+		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
+		return;
+	}
+	if (newIndex >= count) {
+		newIndex = count - 1;
+	}
+	if (oldIndex == newIndex) {
+		return;
+	}
+	
+	[self _willMutate];
+	
+	int64_t const value = values[oldIndex];
+	
+	if (oldIndex < newIndex) {
+		memmove(values + oldIndex, values + oldIndex + 1, (newIndex - oldIndex) * sizeof(int64_t));
+	}
+	else {
+		memmove(values + newIndex + 1, values + newIndex, (oldIndex - newIndex) * sizeof(int64_t));
+	}
+	values[newIndex] = value;
+}
+
+- (void)removeValue:(int64_t)value
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if (hasValueCounts && !ZDCInt64TableContains(&valueCounts, value)) {
+		return;
+	}
+	
+	NSUInteger kept = 0;
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		if (values[i] != value)
+		{
+			values[kept++] = values[i];
+		}
+		else if (kept == i)
+		{
+			// First match - take the snapshot before anything changes
+			[self _willMutate];
+		}
+	}
+	
+	if (kept < count)
+	{
+		count = kept;
+		
+		if (hasValueCounts) {
+			ZDCInt64TableRemove(&valueCounts, value);
+		}
+	}
+}
+
+- (void)removeValueAtIndex:(NSUInteger)idx
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	if (idx >= count) {
+		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
+		return;
+	}
+	
+	[self _willMutate];
+	[self _removeValueAtIndex:idx];
+}
+
+- (void)removeAllValues
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	if (count == 0) {
+		return;
+	}
+	
+	[self _willMutate];
+	
+	count = 0;
+	if (hasValueCounts) {
+		ZDCInt64TableRemoveAll(&valueCounts);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Tracking Internals
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Must be invoked before every change to the values.
+ *
+ * The first tracked change takes a snapshot of the original values.
+ * Afterwards individual changes don't need any bookkeeping,
+ * since the changeset gets calculated by diffing the snapshot against the current values.
+ */
+- (void)_willMutate
+{
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
+	if (!hasSnapshot)
+	{
+		if (count > 0)
+		{
+			snapshot = malloc(count * sizeof(int64_t));
+			memcpy(snapshot, values, count * sizeof(int64_t));
+		}
+		snapshotCount = count;
+		hasSnapshot = YES;
+	}
+}
+
+/**
+ * Returns YES if the array still contains the exact same values as the snapshot.
+ */
+- (BOOL)isIdenticalToSnapshot
+{
+	if (snapshotCount != count) return NO;
+	if (count == 0) return YES;
+	
+	return (memcmp(snapshot, values, count * sizeof(int64_t)) == 0);
+}
+
+/**
+ * Calculates the changeset that transforms `original` into `current`.
+ *
+ * This is a port of `+[ZDCArray changesetFromArray:toArray:matchIdentical:compressMoves:]`,
+ * and the result uses the exact same format. Values are boxed only when they're placed in the changeset.
+ */
+static NSDictionary *ZDCInt64ArrayChangeset(const int64_t *original, NSUInteger originalCount,
+                                            const int64_t *current, NSUInteger currentCount)
+{
+	// Step 1 of 4:
+	//
+	// Match each value in the current array to its position within the original array.
+	//
+	// The table maps each value to its first unmatched position within the original array,
+	// and `nextPosition` chains together the positions of duplicate values (in ascending order).
+	
+	ZDCInt64Table firstPosition;
+	ZDCInt64TableInit(&firstPosition, originalCount);
+	
+	NSUInteger *nextPosition = malloc(MAX(originalCount, (NSUInteger)1) * sizeof(NSUInteger));
+	
+	for (NSUInteger idx = originalCount; idx > 0; idx--)
+	{
+		int64_t const value = original[idx-1];
+		
+		nextPosition[idx-1] = ZDCInt64TableGet(&firstPosition, value);
+		ZDCInt64TableSet(&firstPosition, value, idx-1);
+	}
+	
+	NSMutableIndexSet *changeset_added = [[NSMutableIndexSet alloc] init];
+	
+	NSUInteger *currentToOriginal = malloc(MAX(currentCount, (NSUInteger)1) * sizeof(NSUInteger));
+	BOOL *isKept = calloc(MAX(originalCount, (NSUInteger)1), sizeof(BOOL));
+	
+	for (NSUInteger idx = 0; idx < currentCount; idx++)
+	{
+		int64_t const value = current[idx];
+		NSUInteger const originalIdx = ZDCInt64TableGet(&firstPosition, value);
+		
+		if (originalIdx != NSNotFound)
+		{
+			NSUInteger const next = nextPosition[originalIdx];
+			if (next == NSNotFound)
+				ZDCInt64TableRemove(&firstPosition, value);
+			else
+				ZDCInt64TableSet(&firstPosition, value, next);
+			
+			isKept[originalIdx] = YES;
+		}
+		else
+		{
+			[changeset_added addIndex:idx];
+		}
+		
+		currentToOriginal[idx] = originalIdx;
+	}
+	
+	ZDCInt64TableFree(&firstPosition);
+	free(nextPosition);
+	
+	// Step 2 of 4:
+	//
+	// Everything in the original array that wasn't matched was deleted.
+	// And the previousIndex of kept items (as used by 'moved') doesn't count deleted items.
+	
+	NSMutableDictionary<NSNumber*, NSNumber*> *changeset_deleted = [NSMutableDictionary dictionary];
+	
+	NSUInteger *keptRank = malloc(MAX(originalCount, (NSUInteger)1) * sizeof(NSUInteger));
+	NSUInteger keptCount = 0;
+	
+	for (NSUInteger idx = 0; idx < originalCount; idx++)
+	{
+		if (isKept[idx]) {
+			keptRank[idx] = keptCount++;
+		}
+		else {
+			keptRank[idx] = NSNotFound;
+			changeset_deleted[@(idx)] = @(original[idx]);
+		}
+	}
+	
+	// Step 3 of 4:
+	//
+	// Calculate the minimum set of moves.
+	
+	NSMutableDictionary<NSNumber*, NSNumber*> *changeset_moved = [NSMutableDictionary dictionary];
+	
+	NSUInteger *previousIdxs = malloc(MAX(keptCount, (NSUInteger)1) * sizeof(NSUInteger));
+	NSUInteger *currentIdxs = malloc(MAX(keptCount, (NSUInteger)1) * sizeof(NSUInteger));
+	NSUInteger k = 0;
+	
+	for (NSUInteger idx = 0; idx < currentCount; idx++)
+	{
+		NSUInteger const originalIdx = currentToOriginal[idx];
+		if (originalIdx != NSNotFound)
+		{
+			previousIdxs[k] = keptRank[originalIdx];
+			currentIdxs[k] = idx;
+			k++;
+		}
+	}
+	
+	NSIndexSet *inOrder = [ZDCOrder indexesOfLongestIncreasingSubsequence:previousIdxs count:keptCount];
+	
+	for (k = 0; k < keptCount; k++)
+	{
+		if (![inOrder containsIndex:k])
+		{
+			changeset_moved[@(currentIdxs[k])] = @(previousIdxs[k]);
+		}
+	}
+	
+	free(currentToOriginal);
+	free(isKept);
+	free(keptRank);
+	free(previousIdxs);
+	free(currentIdxs);
+	
+	// Step 4 of 4:
+	//
+	// Package it all up.
+	
+	NSMutableDictionary<NSString*, id> *changeset = [NSMutableDictionary dictionaryWithCapacity:3];
+	
+	if (changeset_added.count > 0) {
+		changeset[kChangeset_added] = [changeset_added copy];
+	}
+	if (changeset_deleted.count > 0) {
+		changeset[kChangeset_deleted] = [changeset_deleted copy];
+	}
+	if (changeset_moved.count > 0) {
+		changeset[kChangeset_moved] = [changeset_moved copy];
+	}
+	
+	return changeset;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Enumeration
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)enumerateValuesUsingBlock:(void (^)(int64_t value, NSUInteger idx, BOOL *stop))block
+{
+	BOOL stop = NO;
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		block(values[i], i, &stop);
+		if (stop) break;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Equality
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (BOOL)isEqual:(nullable id)another
+{
+	if ([another isKindOfClass:[ZDCInt64Array class]]) {
+		return [self isEqualToInt64Array:(ZDCInt64Array *)another];
+	}
+	else {
+		return NO;
+	}
+}
+
+- (BOOL)isEqualToInt64Array:(nullable ZDCInt64Array *)another
+{
+	if (another == nil) return NO; // null dereference crash ahead
+	
+	if (count != another->count) return NO;
+	if (count == 0) return YES;
+	
+	return (memcmp(values, another->values, count * sizeof(int64_t)) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark ZDCObject Overrides
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (BOOL)hasChanges
+{
+	if ([super hasChanges]) return YES;
+	
+	return (hasSnapshot && ![self isIdenticalToSnapshot]);
+}
+
+- (void)clearChangeTracking
+{
+	[super clearChangeTracking];
+	
+	free(snapshot);
+	snapshot = NULL;
+	snapshotCount = 0;
+	hasSnapshot = NO;
+}
+
+static NSArray<NSNumber*> *ZDCInt64ArrayNumbers(const int64_t *buffer, NSUInteger bufferCount)
+{
+	NSMutableArray<NSNumber*> *result = [NSMutableArray arrayWithCapacity:bufferCount];
+	for (NSUInteger idx = 0; idx < bufferCount; idx++)
+	{
+		[result addObject:@(buffer[idx])];
+	}
+	
+	return result;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)_willPerformUntrackedChanges
+{
+	if (!hasSnapshot) {
+		return nil; // nothing is being tracked
+	}
+	
+	if ([self isIdenticalToSnapshot])
+	{
+		// Nothing has changed, so we can simply discard the snapshot.
+		// Otherwise the untracked mutations would show up in the diff.
+		
+		free(snapshot);
+		snapshot = NULL;
+		snapshotCount = 0;
+		hasSnapshot = NO;
+		return nil;
+	}
+	
+	return @[ ZDCInt64ArrayNumbers(snapshot, snapshotCount), ZDCInt64ArrayNumbers(values, count) ];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_didPerformUntrackedChanges:(nullable id)context
+{
+	if (context == nil) return;
+	
+	NSArray<NSNumber*> *originalValues = context[0];
+	NSArray<NSNumber*> *previousValues = context[1];
+	NSArray<NSNumber*> *currentValues = ZDCInt64ArrayNumbers(values, count);
+	
+	if ([previousValues isEqualToArray:currentValues]) {
+		return; // the block didn't modify the array
+	}
+	
+	// The changeset is calculated by diffing the snapshot against the current values.
+	// So we apply the untracked changes to the snapshot, which excludes them from the diff.
+	
+	NSArray<NSNumber*> *rebasedValues = [ZDCOrder rebaseOrder: originalValues
+	                                                fromOrder: previousValues
+	                                                  toOrder: currentValues
+	                                           matchIdentical: NO];
+	
+	free(snapshot);
+	snapshot = NULL;
+	snapshotCount = rebasedValues.count;
+	
+	if (snapshotCount > 0)
+	{
+		snapshot = malloc(snapshotCount * sizeof(int64_t));
+		for (NSUInteger idx = 0; idx < snapshotCount; idx++)
+		{
+			snapshot[idx] = [rebasedValues[idx] longLongValue];
+		}
+	}
+}
+
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	stats.elementCount = count;
+	
+	if (hasSnapshot)
+	{
+		// Individual changes aren't tracked (they're calculated via diff).
+		// Instead the snapshot holds onto every original value.
+		
+		stats.originalCount = snapshotCount;
+		stats.trackingBytes = snapshotCount * sizeof(int64_t);
+	}
+	
+	return stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark ZDCSyncable
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (nullable NSDictionary *)_changeset
+{
+	if (![self hasChanges]) return nil;
+	
+	return ZDCInt64ArrayChangeset(snapshot, snapshotCount, values, count);
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetFrom:(ZDCInt64Array *)src to:(ZDCInt64Array *)dst
+{
+	NSParameterAssert(src != nil);
+	NSParameterAssert(dst != nil);
+	
+	NSDictionary *changeset = ZDCInt64ArrayChangeset(src->values, src->count, dst->values, dst->count);
+	
+	return (changeset.count > 0) ? changeset : nil;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)changeset
+{
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self _changeset];
+	[self clearChangeTracking];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)peakChangeset
+{
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self _changeset];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
+}
+
+- (BOOL)isMalformedChangeset:(NSDictionary *)changeset
+{
+	if (changeset.count == 0) {
+		return NO;
+	}
+	
+	{ // Scoping
+		
+		// changeset: {
+		//   added: NSIndexSet
+		//   ...
+		// }
+		
+		NSIndexSet *changeset_added = changeset[kChangeset_added];
+		if (changeset_added)
+		{
+			if (![changeset_added isKindOfClass:[NSIndexSet class]]) {
+				return YES;
+			}
+		}
+	}
+	{ // Scoping
+		
+		// changeset: {
+		//   deleted: {
+		//     idx: value, ...
+		//   },
+		//   ...
+		// }
+		//
+		// Unlike ZDCArray, the deleted values must be numbers too.
+		
+		NSDictionary *changeset_deleted = changeset[kChangeset_deleted];
+		if (changeset_deleted)
+		{
+			if (![changeset_deleted isKindOfClass:[NSDictionary class]]) {
+				return YES;
+			}
+			
+			for (id key in changeset_deleted)
+			{
+				if (![key isKindOfClass:[NSNumber class]]) {
+					return YES;
+				}
+				
+				id value = changeset_deleted[key];
+				
+				if (![value isKindOfClass:[NSNumber class]]) {
+					return YES;
+				}
+			}
+		}
+	}
+	{ // Scoping
+		
+		// changeset: {
+		//   moved: {
+		//     idx: idx, ...
+		//     idx: [version, idx, length], ...
+		//   },
+		//   ...
+		// }
+		
+		NSDictionary *changeset_moved = changeset[kChangeset_moved];
+		if (changeset_moved)
+		{
+			if (![changeset_moved isKindOfClass:[NSDictionary class]]) {
+				return YES;
+			}
+			
+			for (id key in changeset_moved)
+			{
+				if (![key isKindOfClass:[NSNumber class]]) {
+					return YES;
+				}
+				
+				id value = changeset_moved[key];
+				
+				if (![value isKindOfClass:[NSNumber class]] && ![ZDCOrder getBlockMove:value index:NULL length:NULL]) {
+					return YES;
+				}
+			}
+		}
+	}
+	
+	// Looks good (not malformed)
+	return NO;
+}
+
+- (NSError *)_undo:(NSDictionary *)changeset
+{
+	// Important: `isMalformedChangeset:` must be called before invoking this method.
+	
+	ZDC_TRACE_SCOPE(trace, "ZDCInt64Array", "_undo");
+	ZDC_TRACE_COUNTER("ZDCInt64Array", "_undo: count", count);
+	
+	// This is the same algorithm as `-[ZDCArray _undo:]`.
+	// But since changes are tracked via snapshot-and-diff,
+	// there's no bookkeeping to maintain while the values are being shuffled around.
+	//
+	//                       direction    <=       this      <=     in      <=      read
+	// [previous state] <= (undo deletes) <= (reverse moves) <= (undo adds) <= [current state]
+	
+	NSIndexSet *changeset_added = changeset[kChangeset_added];
+	NSDictionary<NSNumber*, NSNumber*> *changeset_moved = changeset[kChangeset_moved];
+	NSDictionary<NSNumber*, NSNumber*> *changeset_deleted = changeset[kChangeset_deleted];
+	
+	if (changeset_added.count == 0 && changeset_moved.count == 0 && changeset_deleted.count == 0) {
+		return nil;
+	}
+	
+	if (changeset_moved.count > 0)
+	{
+		// Block-move entries (e.g. from a ZDCArray with `compressesMoves` enabled) are expanded into their items.
+		
+		changeset_moved = [ZDCOrder expandMovedIndexes:changeset_moved];
+		if (changeset_moved == nil) {
+			return [self mismatchedChangeset];
+		}
+	}
+	
+	[self _willMutate];
+	
+	// Step 1 of 3:
+	//
+	// Undo added values.
+	
+	if (changeset_added.count > 0)
+	{
+		if (changeset_added.lastIndex >= count) {
+			return [self mismatchedChangeset];
+		}
+		
+		[changeset_added enumerateIndexesWithOptions: NSEnumerationReverse
+		                                  usingBlock:^(NSUInteger idx, BOOL *stop)
+		{
+			[self _removeValueAtIndex:idx];
+		}];
+	}
+	
+	// Step 2 of 3:
+	//
+	// Undo move operations.
+	//
+	// The currentIndexes within `changeset_moved` count the added values.
+	// So they need to be adjusted (just like `-[ZDCArray _undo:]` does).
+	
+	if (changeset_moved.count > 0)
+	{
+		NSUInteger const movedCount = changeset_moved.count;
+		
+		NSUInteger *currentIdxs = malloc(movedCount * sizeof(NSUInteger));
+		NSUInteger *previousIdxs = malloc(movedCount * sizeof(NSUInteger));
+		int64_t *movedValues = malloc(movedCount * sizeof(int64_t));
+		BOOL *isMoved = calloc(MAX(count, (NSUInteger)1), sizeof(BOOL));
+		
+		__block NSError *error = nil;
+		__block NSUInteger m = 0;
+		
+		[changeset_moved enumerateKeysAndObjectsUsingBlock:^(NSNumber *num, NSNumber *prv, BOOL *stop) {
+			
+			__block NSUInteger currentIdx = num.unsignedIntegerValue;
+			
+			[changeset_added enumerateIndexesWithOptions: NSEnumerationReverse
+			                                  usingBlock:^(NSUInteger addedIdx, BOOL *innerStop)
+			{
+				if (currentIdx > addedIdx) {
+					currentIdx--;
+				}
+			}];
+			
+			if (currentIdx >= self->count || isMoved[currentIdx])
+			{
+				error = [self mismatchedChangeset];
+				*stop = YES;
+				return;
+			}
+			
+			isMoved[currentIdx] = YES;
+			
+			currentIdxs[m] = currentIdx;
+			previousIdxs[m] = prv.unsignedIntegerValue;
+			movedValues[m] = self->values[currentIdx];
+			m++;
+		}];
+		
+		if (error == nil)
+		{
+			// Remove the moved values (in a single pass)
+			
+			NSUInteger kept = 0;
+			for (NSUInteger i = 0; i < count; i++)
+			{
+				if (!isMoved[i]) {
+					values[kept++] = values[i];
+				}
+			}
+			count = kept;
+			
+			// And re-insert them at their previous indexes, from lowest to highest
+			
+			NSUInteger *order = malloc(movedCount * sizeof(NSUInteger));
+			for (NSUInteger i = 0; i < movedCount; i++) {
+				order[i] = i;
+			}
+			
+			qsort_b(order, movedCount, sizeof(NSUInteger), ^int(const void *a, const void *b) {
+				
+				NSUInteger const prv1 = previousIdxs[*(const NSUInteger *)a];
+				NSUInteger const prv2 = previousIdxs[*(const NSUInteger *)b];
+				
+				return (prv1 < prv2) ? -1 : ((prv1 > prv2) ? 1 : 0);
+			});
+			
+			for (NSUInteger i = 0; i < movedCount; i++)
+			{
+				NSUInteger const idx = previousIdxs[order[i]];
+				if (idx > count)
+				{
+					error = [self mismatchedChangeset];
+					break;
+				}
+				
+				[self ensureCapacity:(count + 1)];
+				if (idx < count) {
+					memmove(values + idx + 1, values + idx, (count - idx) * sizeof(int64_t));
+				}
+				values[idx] = movedValues[order[i]];
+				count++;
+			}
+			
+			free(order);
+		}
+		
+		free(currentIdxs);
+		free(previousIdxs);
+		free(movedValues);
+		free(isMoved);
+		
+		if (error) {
+			return error;
+		}
+	}
+	
+	// Step 3 of 3:
+	//
+	// Undo deleted values.
+	
+	if (changeset_deleted.count > 0)
+	{
+		NSArray<NSNumber*> *sorted = [[changeset_deleted allKeys] sortedArrayUsingSelector:@selector(compare:)];
+		
+		for (NSNumber *num in sorted)
+		{
+			NSUInteger const idx = num.unsignedIntegerValue;
+			if (idx > count) {
+				return [self mismatchedChangeset];
+			}
+			
+			[self _insertValue:changeset_deleted[num].longLongValue atIndex:idx];
+		}
+	}
+	
+	return nil;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)undo:(NSDictionary *)changeset error:(NSError **)errPtr
+{
+	NSError *error = [self performUndo:changeset];
+	if (error)
+	{
+		if (errPtr) *errPtr = error;
+		return nil;
+	}
+	else
+	{
+		// Undo successful - generate redo changeset
+		NSDictionary *reverseChangeset = [self changeset];
+		
+		if (errPtr) *errPtr = nil;
+		return (reverseChangeset ?: @{}); // don't return nil without error
+	}
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSError *)performUndo:(NSDictionary *)changeset
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if ([self hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		return [self hasChangesError];
+	}
+	
+	if ([self isMalformedChangeset:changeset])
+	{
+		return [self malformedChangesetError];
+	}
+	
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSError *error = [self _undo:changeset];
+	if (error)
+	{
+		// Abandon botched undo attempt - revert to original state
+		[self rollback];
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
+	return error;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (void)rollback
+{
+	// With snapshot-and-diff, the original values are right there.
+	
+	if (hasSnapshot && ![self isIdenticalToSnapshot])
+	{
+		if (self.isImmutable) {
+			@throw [self immutableException];
+		}
+		
+		[self ensureCapacity:snapshotCount];
+		if (snapshotCount > 0) {
+			memcpy(values, snapshot, snapshotCount * sizeof(int64_t));
+		}
+		count = snapshotCount;
+		
+		if (hasValueCounts)
+		{
+			ZDCInt64TableFree(&valueCounts);
+			hasValueCounts = NO;
+		}
+	}
+	
+	[self clearChangeTracking];
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)mergeChangesets:(NSArray<NSDictionary*> *)orderedChangesets
+                                     error:(NSError *_Nullable *_Nullable)errPtr
+{
+	NSError *error = [self importChangesets:orderedChangesets];
+	if (error)
+	{
+		if (errPtr) *errPtr = error;
+		return nil;
+	}
+	else
+	{
+		NSDictionary *mergedChangeset = [self changeset];
+		
+		if (errPtr) *errPtr = nil;
+		return (mergedChangeset ?: @{}); // don't return nil without error
+	}
+}
+
+- (nullable NSError *)importChangesets:(NSArray<NSDictionary*> *)orderedChangesets
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if ([self hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		return [self hasChangesError];
+	}
+	
+	// Check for malformed changesets.
+	// It's better to detect this early on, before we start modifying the object.
+	//
+	for (NSDictionary *changeset in orderedChangesets)
+	{
+		if ([self isMalformedChangeset:changeset])
+		{
+			return [self malformedChangesetError];
+		}
+	}
+	
+	if (orderedChangesets.count == 0) {
+		return nil;
+	}
+	
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSError *result_error = nil;
+	NSMutableArray<NSDictionary*> *changesets_redo = [NSMutableArray arrayWithCapacity:orderedChangesets.count];
+	
+	for (NSDictionary *changeset in [orderedChangesets reverseObjectEnumerator])
+	{
+		result_error = [self _undo:changeset];
+		if (result_error)
+		{
+			// Abort botched attempt - Revert to original state (before current `_undo:`)
+			[self rollback];
+			
+			// We still need to revert previous `_undo:` calls
+			break;
+		}
+		else
+		{
+			NSDictionary *redo = [self changeset];
+			if (redo) {
+				[changesets_redo addObject:redo];
+			}
+		}
+	}
+	
+	// Re-applying the redo changesets (from the oldest state) leaves a snapshot of the oldest state.
+	// So the changeset is then the consolidated version of the list.
+	
+	for (NSDictionary *redo in [changesets_redo reverseObjectEnumerator])
+	{
+		NSError *error = [self _undo:redo];
+		if (error)
+		{
+			// Not much we can do here - we're in a bad state
+			if (result_error == nil) {
+				result_error = error;
+			}
+			
+			break;
+		}
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	return result_error;
+}
+
+- (nullable NSDictionary *)mergeCloudVersion:(id)inCloudVersion
+                       withPendingChangesets:(nullable NSArray<NSDictionary*> *)pendingChangesets
+                                       error:(NSError *_Nullable *_Nullable)errPtr
+{
+	ZDC_TRACE_SCOPE(trace, "ZDCInt64Array", "mergeCloudVersion");
+	
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if ([self hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		if (errPtr) *errPtr = [self hasChangesError];
+		return nil;
+	}
+	
+	// Check for malformed changesets.
+	// It's better to detect this early on, before we start modifying the object.
+	//
+	for (NSDictionary *changeset in pendingChangesets)
+	{
+		if ([self isMalformedChangeset:changeset])
+		{
+			if (errPtr) *errPtr = [self malformedChangesetError];
+			return nil;
+		}
+	}
+	
+	if (![inCloudVersion isKindOfClass:[ZDCInt64Array class]])
+	{
+		if (errPtr) *errPtr = [self incorrectObjectClass];
+		return nil;
+	}
+	ZDCInt64Array *cloudVersion = (ZDCInt64Array *)inCloudVersion;
+	
+	// The merge runs the ZDCArray algorithm on boxed values.
+	// Since the changeset formats are identical, the result is exactly what a ZDCArray of NSNumbers would produce.
+	
+	ZDCArray<NSNumber*> *local = [[ZDCArray alloc] initWithArray:self.rawArray copyItems:NO trackChanges:NO];
+	ZDCArray<NSNumber*> *cloud = [[ZDCArray alloc] initWithArray:cloudVersion.rawArray copyItems:NO trackChanges:NO];
+	
+	NSDictionary *changeset = [local mergeCloudVersion:cloud withPendingChangesets:pendingChangesets error:errPtr];
+	if (changeset == nil) {
+		return nil;
+	}
+	
+	NSArray<NSNumber*> *merged = local.rawArray;
+	
+	count = 0;
+	[self ensureCapacity:merged.count];
+	for (NSNumber *num in merged)
+	{
+		values[count++] = num.longLongValue;
+	}
+	
+	if (hasValueCounts)
+	{
+		ZDCInt64TableFree(&valueCounts);
+		hasValueCounts = NO;
+	}
+	
+	[self clearChangeTracking];
+	return changeset;
+}
+
+@end
@@ -0,0 +1,182 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCObject.h"
+#import "ZDCSyncable.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * ZDCInt64OrderedSet tracks changes to an ordered set of 64-bit integers.
+ *
+ * It's the unboxed counterpart of a ZDCOrderedSet containing NSNumbers.
+ * The values are stored in a contiguous C buffer, and membership is answered via an integer hash table.
+ * So there's no object per element, and lookups never send `hash` or `isEqual:`.
+ *
+ * It implements the ZDCSyncable protocol, and its changesets use the exact same format as ZDCOrderedSet.
+ * So a changeset from one can be applied to the other (assuming the ZDCOrderedSet contains NSNumbers),
+ * and the values within changesets are NSNumbers.
+ *
+ * Change tracking:
+ *   Changes are tracked via snapshot-and-diff.
+ *   That is, the first tracked change copies the original values (which is a single memcpy),
+ *   and the changeset is calculated (by diffing the copy against the current values) when it's requested.
+ *
+ * @note Merges (`mergeCloudVersion:withPendingChangesets:error:`) run the ZDCOrderedSet algorithm on boxed values.
+ *       Merges are rare compared to reads & writes, and this guarantees identical merge results.
+ */
+NS_SWIFT_NAME(ZDCInt64OrderedSet_ObjC)
+@interface ZDCInt64OrderedSet : ZDCObject <NSCoding, NSCopying, ZDCSyncable>
+
+/**
+ * Creates an empty ordered set.
+ */
+- (instancetype)init;
+
+/**
+ * Creates a ZDCInt64OrderedSet initialized by copying the given values.
+ * If a value appears more than once, only the first occurrence is kept.
+ */
+- (instancetype)initWithValues:(nullable const int64_t *)values count:(NSUInteger)count;
+
+/**
+ * Same as `initWithValues:count:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithValues:(nullable const int64_t *)values
+                         count:(NSUInteger)count
+                  trackChanges:(BOOL)trackChanges;
+
+/**
+ * Creates a ZDCInt64OrderedSet initialized with the `longLongValue` of each number in the given array.
+ */
+- (instancetype)initWithArray:(nullable NSArray<NSNumber*> *)array;
+
+#pragma mark Raw
+
+/**
+ * Returns the values as an ordered set of NSNumbers.
+ *
+ * @note The returned value is a (boxed) copy.
+ *       Thus changes to the ZDCInt64OrderedSet will not be reflected in the returned value.
+ */
+@property (nonatomic, copy, readonly) NSOrderedSet<NSNumber*> *rawOrderedSet;
+
+#pragma mark Reading
+
+/**
+ * The number of values stored in the ordered set.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ * Returns the value stored at the given index.
+ *
+ * @important Raises an NSRangeException if index is out-of-bounds.
+ */
+- (int64_t)valueAtIndex:(NSUInteger)idx;
+
+/**
+ * Copies the values within the given range into the buffer.
+ *
+ * @important Raises an NSRangeException if the range is out-of-bounds.
+ */
+- (void)getValues:(int64_t *)buffer range:(NSRange)range;
+
+/**
+ * Returns YES if the value is contained in the ordered set.
+ */
+- (BOOL)containsValue:(int64_t)value;
+
+/**
+ * Returns the index of the value within the ordered set.
+ * If not found, returns NSNotFound.
+ *
+ * The hash table also caches the index of each value.
+ * Appending (or removing the last value) keeps the cached indexes valid.
+ * Other changes invalidate them, and they're then recalculated (in a single pass) on the next lookup.
+ */
+- (NSUInteger)indexOfValue:(int64_t)value;
+
+#pragma mark Writing
+
+/**
+ * Adds the value to the end of the ordered set (if it's not already in the set).
+ */
+- (void)addValue:(int64_t)value;
+
+/**
+ * Inserts the value at the given index (if it's not already in the set).
+ * If the index is beyond the end of the set, the value is added to the end.
+ */
+- (void)insertValue:(int64_t)value atIndex:(NSUInteger)idx;
+
+/**
+ * Use this method when you only need to change a value's index.
+ *
+ * @param oldIndex
+ *   The current index of the value.
+ *
+ * @param newIndex
+ *   The index to use AFTER the value has been removed (same as `-[ZDCOrderedSet moveObjectAtIndex:toIndex:]`).
+ */
+- (void)moveValueAtIndex:(NSUInteger)oldIndex toIndex:(NSUInteger)newIndex;
+
+/**
+ * Removes the value (if it's in the set).
+ */
+- (void)removeValue:(int64_t)value;
+
+/**
+ * Removes the value currently at the given index.
+ * If the index is out-of-bounds, this method does nothing.
+ */
+- (void)removeValueAtIndex:(NSUInteger)idx;
+
+/**
+ * Removes all values from the ordered set.
+ * Afterwards the set will be empty.
+ */
+- (void)removeAllValues;
+
+#pragma mark Enumeration
+
+/**
+ * Enumerates all values in the ordered set,
+ * starting from index 0 and ending with the largest index.
+ */
+- (void)enumerateValuesUsingBlock:(void (^)(int64_t value, NSUInteger idx, BOOL *stop))block;
+
+#pragma mark Diff
+
+/**
+ * Calculates the changeset between two versions of an ordered set,
+ * without replaying the individual operations that led from one to the other.
+ *
+ * This is the same algorithm as `+[ZDCOrderedSet changesetFrom:to:]`, with values matched via an integer hash table.
+ *
+ * @return The changeset, or nil if the ordered sets are equal.
+ */
++ (nullable NSDictionary<NSString*, id> *)changesetFrom:(ZDCInt64OrderedSet *)src to:(ZDCInt64OrderedSet *)dst;
+
+#pragma mark Equality
+
+/**
+ * Returns YES if `another` is of class ZDCInt64OrderedSet,
+ * and the receiver & another contain the same values in the same order.
+ *
+ * @note It does NOT take into account the changeset of either instance.
+ */
+- (BOOL)isEqual:(nullable id)another;
+
+/**
+ * Returns YES if the receiver and `another` contain the same values in the same order.
+ *
+ * @note It does NOT take into account the changeset of either instance.
+ */
+- (BOOL)isEqualToInt64OrderedSet:(nullable ZDCInt64OrderedSet *)another;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1319 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCInt64OrderedSet.h"
+
+#import "ZDCInt64Table.h"
+#import "ZDCObjectSubclass.h"
+#import "ZDCOrder.h"
+#import "ZDCOrderedSet.h"
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
+
+// Encoding/Decoding Keys
+//
+static int const kCurrentVersion = 0;
+#pragma unused(kCurrentVersion)
+
+static NSString *const kCoding_version = @"version";
+static NSString *const kCoding_values  = @"values";
+
+// Changeset Keys
+//
+// Important: These must match the keys used by ZDCOrderedSet.
+//
+static NSString *const kChangeset_added   = @"added";
+static NSString *const kChangeset_indexes = @"indexes";
+static NSString *const kChangeset_deleted = @"deleted";
+
+
+@implementation ZDCInt64OrderedSet {
+@private
+
+	int64_t *values;
+	NSUInteger count;
+	NSUInteger capacity;
+	
+	ZDCInt64Table members;     // value => index (the index is only valid if !indexesStale)
+	BOOL indexesStale;
+	
+	int64_t *snapshot;         // original values (taken on the first tracked change)
+	NSUInteger snapshotCount;
+	BOOL hasSnapshot;
+}
+
+@dynamic rawOrderedSet;
+@synthesize count = count;
+
+- (instancetype)init
+{
+	return [self initWithValues:NULL count:0 trackChanges:YES];
+}
+
+- (instancetype)initWithValues:(const int64_t *)inValues count:(NSUInteger)inCount
+{
+	return [self initWithValues:inValues count:inCount trackChanges:YES];
+}
+
+- (instancetype)initWithValues:(const int64_t *)inValues count:(NSUInteger)inCount trackChanges:(BOOL)trackChanges
+{
+	if ((self = [super init]))
+	{
+		if (inValues && inCount > 0)
+		{
+			[self ensureCapacity:inCount];
+			ZDCInt64TableInit(&members, inCount);
+			
+			for (NSUInteger i = 0; i < inCount; i++)
+			{
+				if (!ZDCInt64TableContains(&members, inValues[i]))
+				{
+					ZDCInt64TableSet(&members, inValues[i], count);
+					values[count++] = inValues[i];
+				}
+			}
+			
+			if (trackChanges)
+			{
+				// The original state is the empty set
+				hasSnapshot = YES;
+				snapshotCount = 0;
+			}
+		}
+	}
+	return self;
+}
+
+- (instancetype)initWithArray:(NSArray<NSNumber*> *)array
+{
+	NSUInteger const inCount = array.count;
+	int64_t *inValues = malloc(MAX(inCount, (NSUInteger)1) * sizeof(int64_t));
+	
+	NSUInteger i = 0;
+	for (NSNumber *num in array)
+	{
+		inValues[i++] = num.longLongValue;
+	}
+	
+	self = [self initWithValues:inValues count:inCount trackChanges:YES];
+	
+	free(inValues);
+	return self;
+}
+
+- (void)dealloc
+{
+	free(values);
+	free(snapshot);
+	ZDCInt64TableFree(&members);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark NSCoding
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (id)initWithCoder:(NSCoder *)decoder
+{
+	if ((self = [super init]))
+	{
+		// The values are stored in little-endian byte order
+		
+		NSData *data = [decoder decodeObjectForKey:kCoding_values];
+		NSUInteger const inCount = data.length / sizeof(int64_t);
+		
+		if (inCount > 0)
+		{
+			const int64_t *buffer = (const int64_t *)data.bytes;
+			
+			[self ensureCapacity:inCount];
+			ZDCInt64TableInit(&members, inCount);
+			
+			for (NSUInteger i = 0; i < inCount; i++)
+			{
+				int64_t const value = (int64_t)OSSwapLittleToHostInt64((uint64_t)buffer[i]);
+				
+				if (!ZDCInt64TableContains(&members, value))
+				{
+					ZDCInt64TableSet(&members, value, count);
+					values[count++] = value;
+				}
+			}
+		}
+		
+		// Note: ephemeral properties (i.e. for change tracking) are not serialized
+	}
+	return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+	if (kCurrentVersion != 0) {
+		[coder encodeInt:kCurrentVersion forKey:kCoding_version];
+	}
+	
+	NSMutableData *data = [NSMutableData dataWithLength:(count * sizeof(int64_t))];
+	int64_t *buffer = (int64_t *)data.mutableBytes;
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		buffer[i] = (int64_t)OSSwapHostToLittleInt64((uint64_t)values[i]);
+	}
+	
+	[coder encodeObject:data forKey:kCoding_values];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark NSCopying
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	ZDCInt64OrderedSet *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
+	
+	[copy setValues:self->values count:self->count];
+	[self copySnapshotTo:copy];
+	
+	return copy;
+}
+
+/**
+ * For complicated copying scenarios, such as nested deep copies.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)copyChangeTrackingTo:(id)another
+{
+	if ([another isKindOfClass:[ZDCInt64OrderedSet class]])
+	{
+		__unsafe_unretained ZDCInt64OrderedSet *copy = (ZDCInt64OrderedSet *)another;
+		if (!copy.isImmutable)
+		{
+			[self copySnapshotTo:copy];
+			
+			[super copyChangeTrackingTo:another];
+		}
+	}
+}
+
+- (void)copySnapshotTo:(ZDCInt64OrderedSet *)copy
+{
+	free(copy->snapshot);
+	copy->snapshot = NULL;
+	copy->snapshotCount = 0;
+	copy->hasSnapshot = self->hasSnapshot;
+	
+	if (self->snapshotCount > 0)
+	{
+		copy->snapshot = malloc(self->snapshotCount * sizeof(int64_t));
+		memcpy(copy->snapshot, self->snapshot, self->snapshotCount * sizeof(int64_t));
+		copy->snapshotCount = self->snapshotCount;
+	}
+}
+
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCInt64OrderedSet *copy = (ZDCInt64OrderedSet *)another;
+	
+	// We swap buffers with the copy, so our current buffers are freed along with it.
+	
+	int64_t *const oldValues = values;
+	NSUInteger const oldCapacity = capacity;
+	values = copy->values;
+	capacity = copy->capacity;
+	count = copy->count;
+	copy->values = oldValues;
+	copy->capacity = oldCapacity;
+	
+	ZDCInt64Table const oldMembers = members;
+	members = copy->members;
+	indexesStale = copy->indexesStale;
+	copy->members = oldMembers;
+	
+	int64_t *const oldSnapshot = snapshot;
+	snapshot = copy->snapshot;
+	snapshotCount = copy->snapshotCount;
+	hasSnapshot = copy->hasSnapshot;
+	copy->snapshot = oldSnapshot;
+	
+	[super restoreStateFromCopy:another];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Storage
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)ensureCapacity:(NSUInteger)needed
+{
+	if (needed <= capacity) return;
+	
+	NSUInteger newCapacity = MAX(capacity * 2, (NSUInteger)8);
+	while (newCapacity < needed) {
+		newCapacity *= 2;
+	}
+	
+	values = reallocf(values, newCapacity * sizeof(int64_t));
+	capacity = newCapacity;
+}
+
+/**
+ * Replaces the contents with the given (already unique) values, and rebuilds the hash table.
+ */
+- (void)setValues:(const int64_t *)inValues count:(NSUInteger)inCount
+{
+	[self ensureCapacity:inCount];
+	if (inCount > 0) {
+		memcpy(values, inValues, inCount * sizeof(int64_t));
+	}
+	count = inCount;
+	
+	[self rebuildMembers];
+}
+
+/**
+ * Rebuilds the hash table from the current values.
+ */
+- (void)rebuildMembers
+{
+	ZDCInt64TableFree(&members);
+	ZDCInt64TableInit(&members, count);
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		ZDCInt64TableSet(&members, values[i], i);
+	}
+	indexesStale = NO;
+}
+
+- (void)_insertValue:(int64_t)value atIndex:(NSUInteger)idx
+{
+	[self ensureCapacity:(count + 1)];
+	
+	if (idx < count)
+	{
+		memmove(values + idx + 1, values + idx, (count - idx) * sizeof(int64_t));
+		indexesStale = YES; // the values after idx have shifted
+	}
+	values[idx] = value;
+	count++;
+	
+	ZDCInt64TableSet(&members, value, idx);
+}
+
+- (void)_removeValueAtIndex:(NSUInteger)idx
+{
+	ZDCInt64TableRemove(&members, values[idx]);
+	
+	if (idx + 1 < count)
+	{
+		memmove(values + idx, values + idx + 1, (count - idx - 1) * sizeof(int64_t));
+		indexesStale = YES; // the values after idx have shifted
+	}
+	count--;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Raw
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (NSOrderedSet<NSNumber*> *)rawOrderedSet
+{
+	NSMutableOrderedSet<NSNumber*> *orderedSet = [NSMutableOrderedSet orderedSetWithCapacity:count];
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		[orderedSet addObject:@(values[i])];
+	}
+	
+	return [orderedSet copy];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Reading
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (int64_t)valueAtIndex:(NSUInteger)idx
+{
+	if (idx >= count) {
+		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
+	}
+	
+	return values[idx];
+}
+
+- (void)getValues:(int64_t *)buffer range:(NSRange)range
+{
+	if (NSMaxRange(range) > count) {
+		@throw [NSException exceptionWithName:NSRangeException reason:nil userInfo:nil];
+	}
+	
+	if (range.length > 0) {
+		memcpy(buffer, values + range.location, range.length * sizeof(int64_t));
+	}
+}
+
+- (BOOL)containsValue:(int64_t)value
+{
+	return ZDCInt64TableContains(&members, value);
+}
+
+/**
+ * See header file for description.
+ */
+- (NSUInteger)indexOfValue:(int64_t)value
+{
+	if (!ZDCInt64TableContains(&members, value)) {
+		return NSNotFound;
+	}
+	
+	[self refreshStaleIndexes];
+	return ZDCInt64TableGet(&members, value);
+}
+
+- (void)refreshStaleIndexes
+{
+	if (indexesStale)
+	{
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			ZDCInt64TableSet(&members, values[i], i);
+		}
+		indexesStale = NO;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Writing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)addValue:(int64_t)value
+{
+	[self insertValue:value atIndex:count];
+}
+
+- (void)insertValue:(int64_t)value atIndex:(NSUInteger)requestedIdx
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if (!ZDCInt64TableContains(&members, value))
+	{
+		NSUInteger const idx = MIN(requestedIdx, count);
+		
+		[self _willMutate];
+		[self _insertValue:value atIndex:idx];
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)moveValueAtIndex:(NSUInteger)oldIndex toIndex:(NSUInteger)newIndex
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if (oldIndex >= count) {
+		return;
+	}
+	if (newIndex >= count) {
+		newIndex = count - 1;
+	}
+	if (oldIndex == newIndex) {
+		return;
+	}
+	
+	[self _willMutate];
+	
+	int64_t const value = values[oldIndex];
+	
+	if (oldIndex < newIndex) {
+		memmove(values + oldIndex, values + oldIndex + 1, (newIndex - oldIndex) * sizeof(int64_t));
+	}
+	else {
+		memmove(values + newIndex + 1, values + newIndex, (oldIndex - newIndex) * sizeof(int64_t));
+	}
+	values[newIndex] = value;
+	
+	indexesStale = YES;
+}
+
+- (void)removeValue:(int64_t)value
+{
+	NSUInteger const idx = [self indexOfValue:value];
+	if (idx != NSNotFound)
+	{
+		[self removeValueAtIndex:idx];
+	}
+}
+
+- (void)removeValueAtIndex:(NSUInteger)idx
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if (idx < count)
+	{
+		[self _willMutate];
+		[self _removeValueAtIndex:idx];
+	}
+}
+
+- (void)removeAllValues
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	if (count == 0) {
+		return;
+	}
+	
+	[self _willMutate];
+	
+	count = 0;
+	ZDCInt64TableRemoveAll(&members);
+	indexesStale = NO;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Tracking Internals
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Must be invoked before every change to the values.
+ *
+ * The first tracked change takes a snapshot of the original values.
+ * Afterwards individual changes don't need any bookkeeping,
+ * since the changeset gets calculated by diffing the snapshot against the current values.
+ */
+- (void)_willMutate
+{
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
+	if (!hasSnapshot)
+	{
+		if (count > 0)
+		{
+			snapshot = malloc(count * sizeof(int64_t));
+			memcpy(snapshot, values, count * sizeof(int64_t));
+		}
+		snapshotCount = count;
+		hasSnapshot = YES;
+	}
+}
+
+/**
+ * Returns YES if the set still contains the exact same values (in the same order) as the snapshot.
+ */
+- (BOOL)isIdenticalToSnapshot
+{
+	if (snapshotCount != count) return NO;
+	if (count == 0) return YES;
+	
+	return (memcmp(snapshot, values, count * sizeof(int64_t)) == 0);
+}
+
+/**
+ * Calculates the changeset that transforms `original` into `current`.
+ *
+ * This is a port of `+[ZDCOrderedSet changesetFrom:to:]`, and the result uses the exact same format.
+ * The `currentMembers` table must contain every value within `current`.
+ */
+static NSDictionary *ZDCInt64OrderedSetChangeset(const int64_t *original, NSUInteger originalCount,
+                                                 const int64_t *current, NSUInteger currentCount,
+                                                 const ZDCInt64Table *currentMembers)
+{
+	NSMutableDictionary<NSString*, id> *changeset = [NSMutableDictionary dictionaryWithCapacity:3];
+	
+	// Step 1 of 3:
+	//
+	// Find the deleted values, and calculate the rank of each kept value amongst the other kept values.
+	// (This is what the `indexes` component of the changeset refers to.)
+	
+	NSMutableDictionary<NSNumber*, NSNumber*> *changeset_deleted = [NSMutableDictionary dictionary];
+	
+	ZDCInt64Table keptRanks;
+	ZDCInt64TableInit(&keptRanks, MIN(originalCount, currentCount));
+	
+	NSUInteger keptCount = 0;
+	for (NSUInteger idx = 0; idx < originalCount; idx++)
+	{
+		int64_t const value = original[idx];
+		
+		if (ZDCInt64TableContains(currentMembers, value)) {
+			ZDCInt64TableSet(&keptRanks, value, keptCount++);
+		}
+		else {
+			changeset_deleted[@(value)] = @(idx);
+		}
+	}
+	
+	// Step 2 of 3:
+	//
+	// Find the added values, and the previous ranks of the kept values (in current order).
+	
+	NSMutableSet<NSNumber*> *changeset_added = [NSMutableSet set];
+	
+	int64_t *keptValues = malloc(MAX(keptCount, (NSUInteger)1) * sizeof(int64_t));
+	NSUInteger *ranks = malloc(MAX(keptCount, (NSUInteger)1) * sizeof(NSUInteger));
+	NSUInteger k = 0;
+	
+	for (NSUInteger idx = 0; idx < currentCount; idx++)
+	{
+		int64_t const value = current[idx];
+		NSUInteger const rank = ZDCInt64TableGet(&keptRanks, value);
+		
+		if (rank == NSNotFound)
+		{
+			[changeset_added addObject:@(value)];
+		}
+		else
+		{
+			keptValues[k] = value;
+			ranks[k] = rank;
+			k++;
+		}
+	}
+	
+	// Step 3 of 3:
+	//
+	// Values within the longest increasing subsequence (of previous ranks) don't need to be moved.
+	// Everything else is marked as moved, which keeps the set of moves minimal.
+	
+	NSIndexSet *stationary = [ZDCOrder indexesOfLongestIncreasingSubsequence:ranks count:k];
+	
+	NSMutableDictionary<NSNumber*, NSNumber*> *changeset_indexes = [NSMutableDictionary dictionary];
+	
+	for (NSUInteger i = 0; i < k; i++)
+	{
+		if (![stationary containsIndex:i])
+		{
+			changeset_indexes[@(keptValues[i])] = @(ranks[i]);
+		}
+	}
+	
+	free(keptValues);
+	free(ranks);
+	ZDCInt64TableFree(&keptRanks);
+	
+	if (changeset_added.count > 0) {
+		changeset[kChangeset_added] = [changeset_added copy];
+	}
+	if (changeset_indexes.count > 0) {
+		changeset[kChangeset_indexes] = [changeset_indexes copy];
+	}
+	if (changeset_deleted.count > 0) {
+		changeset[kChangeset_deleted] = [changeset_deleted copy];
+	}
+	
+	return changeset;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Enumeration
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)enumerateValuesUsingBlock:(void (^)(int64_t value, NSUInteger idx, BOOL *stop))block
+{
+	BOOL stop = NO;
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		block(values[i], i, &stop);
+		if (stop) break;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Equality
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (BOOL)isEqual:(nullable id)another
+{
+	if ([another isKindOfClass:[ZDCInt64OrderedSet class]]) {
+		return [self isEqualToInt64OrderedSet:(ZDCInt64OrderedSet *)another];
+	}
+	else {
+		return NO;
+	}
+}
+
+- (BOOL)isEqualToInt64OrderedSet:(nullable ZDCInt64OrderedSet *)another
+{
+	if (another == nil) return NO; // null dereference crash ahead
+	
+	if (count != another->count) return NO;
+	if (count == 0) return YES;
+	
+	return (memcmp(values, another->values, count * sizeof(int64_t)) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark ZDCObject Overrides
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)makeImmutable
+{
+	// Immutable instances may be read from multiple threads (e.g. a published snapshot),
+	// so the lazily refreshed indexes must be up-to-date before then.
+	[self refreshStaleIndexes];
+	[super makeImmutable];
+}
+
+- (BOOL)hasChanges
+{
+	if ([super hasChanges]) return YES;
+	
+	return (hasSnapshot && ![self isIdenticalToSnapshot]);
+}
+
+- (void)clearChangeTracking
+{
+	[super clearChangeTracking];
+	
+	free(snapshot);
+	snapshot = NULL;
+	snapshotCount = 0;
+	hasSnapshot = NO;
+}
+
+static NSArray<NSNumber*> *ZDCInt64OrderedSetNumbers(const int64_t *buffer, NSUInteger bufferCount)
+{
+	NSMutableArray<NSNumber*> *result = [NSMutableArray arrayWithCapacity:bufferCount];
+	for (NSUInteger idx = 0; idx < bufferCount; idx++)
+	{
+		[result addObject:@(buffer[idx])];
+	}
+	
+	return result;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)_willPerformUntrackedChanges
+{
+	if (!hasSnapshot) {
+		return nil; // nothing is being tracked
+	}
+	
+	if ([self isIdenticalToSnapshot])
+	{
+		// Nothing has changed, so we can simply discard the snapshot.
+		// Otherwise the untracked mutations would show up in the diff.
+		
+		free(snapshot);
+		snapshot = NULL;
+		snapshotCount = 0;
+		hasSnapshot = NO;
+		return nil;
+	}
+	
+	return @[ ZDCInt64OrderedSetNumbers(snapshot, snapshotCount), ZDCInt64OrderedSetNumbers(values, count) ];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_didPerformUntrackedChanges:(nullable id)context
+{
+	if (context == nil) return;
+	
+	NSArray<NSNumber*> *originalValues = context[0];
+	NSArray<NSNumber*> *previousValues = context[1];
+	NSArray<NSNumber*> *currentValues = ZDCInt64OrderedSetNumbers(values, count);
+	
+	if ([previousValues isEqualToArray:currentValues]) {
+		return; // the block didn't modify the set
+	}
+	
+	// The changeset is calculated by diffing the snapshot against the current values.
+	// So we apply the untracked changes to the snapshot, which excludes them from the diff.
+	
+	NSArray<NSNumber*> *rebasedValues = [ZDCOrder rebaseOrder: originalValues
+	                                                fromOrder: previousValues
+	                                                  toOrder: currentValues
+	                                           matchIdentical: NO];
+	
+	free(snapshot);
+	snapshot = NULL;
+	snapshotCount = rebasedValues.count;
+	
+	if (snapshotCount > 0)
+	{
+		snapshot = malloc(snapshotCount * sizeof(int64_t));
+		for (NSUInteger idx = 0; idx < snapshotCount; idx++)
+		{
+			snapshot[idx] = [rebasedValues[idx] longLongValue];
+		}
+	}
+}
+
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	stats.elementCount = count;
+	
+	if (hasSnapshot)
+	{
+		// Individual changes aren't tracked (they're calculated via diff).
+		// Instead the snapshot holds onto every original value.
+		
+		stats.originalCount = snapshotCount;
+		stats.trackingBytes = snapshotCount * sizeof(int64_t);
+	}
+	
+	return stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark ZDCSyncable
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (nullable NSDictionary *)_changeset
+{
+	if (![self hasChanges]) return nil;
+	
+	return ZDCInt64OrderedSetChangeset(snapshot, snapshotCount, values, count, &members);
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetFrom:(ZDCInt64OrderedSet *)src to:(ZDCInt64OrderedSet *)dst
+{
+	NSParameterAssert(src != nil);
+	NSParameterAssert(dst != nil);
+	
+	NSDictionary *changeset =
+	  ZDCInt64OrderedSetChangeset(src->values, src->count, dst->values, dst->count, &dst->members);
+	
+	return (changeset.count > 0) ? changeset : nil;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)changeset
+{
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self _changeset];
+	[self clearChangeTracking];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)peakChangeset
+{
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self _changeset];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
+}
+
+- (BOOL)isMalformedChangeset:(NSDictionary *)changeset
+{
+	if (changeset.count == 0) {
+		return NO;
+	}
+	
+	// Unlike ZDCOrderedSet, the objects (set members & dictionary keys) must be numbers too.
+	
+	{ // Scoping
+		
+		NSSet *changeset_added = changeset[kChangeset_added];
+		if (changeset_added)
+		{
+			if (![changeset_added isKindOfClass:[NSSet class]]) {
+				return YES;
+			}
+			
+			for (id obj in changeset_added)
+			{
+				if (![obj isKindOfClass:[NSNumber class]]) {
+					return YES;
+				}
+			}
+		}
+	}
+	{ // Scoping
+		
+		NSDictionary *changeset_indexes = changeset[kChangeset_indexes];
+		if (changeset_indexes)
+		{
+			if (![changeset_indexes isKindOfClass:[NSDictionary class]]) {
+				return YES;
+			}
+			
+			// All keys & values must be numbers.
+			// All indexes must not be NSNotFound.
+			
+			for (id key in changeset_indexes)
+			{
+				if (![key isKindOfClass:[NSNumber class]]) {
+					return YES;
+				}
+				
+				id value = changeset_indexes[key];
+				if (![value isKindOfClass:[NSNumber class]]) {
+					return YES;
+				}
+				
+				NSUInteger idx = [value unsignedIntegerValue];
+				if (idx == NSNotFound) {
+					return YES;
+				}
+			}
+		}
+	}
+	{ // Scoping
+		
+		NSDictionary *changeset_deleted = changeset[kChangeset_deleted];
+		if (changeset_deleted)
+		{
+			if (![changeset_deleted isKindOfClass:[NSDictionary class]]) {
+				return YES;
+			}
+			
+			// All keys & values must be numbers.
+			// All indexes must not be NSNotFound.
+			
+			for (id key in changeset_deleted)
+			{
+				if (![key isKindOfClass:[NSNumber class]]) {
+					return YES;
+				}
+				
+				id value = changeset_deleted[key];
+				if (![value isKindOfClass:[NSNumber class]]) {
+					return YES;
+				}
+				
+				NSUInteger idx = [value unsignedIntegerValue];
+				if (idx == NSNotFound) {
+					return YES;
+				}
+			}
+		}
+	}
+	
+	// Looks good (not malformed)
+	return NO;
+}
+
+- (NSError *)_undo:(NSDictionary *)changeset
+{
+	// Important: `isMalformedChangeset:` must be called before invoking this method.
+	
+	ZDC_TRACE_SCOPE(trace, "ZDCInt64OrderedSet", "_undo");
+	ZDC_TRACE_COUNTER("ZDCInt64OrderedSet", "_undo: count", count);
+	
+	// This is the same algorithm as `-[ZDCOrderedSet _undo:]`.
+	// But since changes are tracked via snapshot-and-diff,
+	// there's no bookkeeping to maintain while the values are being shuffled around.
+	//
+	//                       direction    <=       this      <=     in      <=      read
+	// [previous state] <= (undo deletes) <= (reverse moves) <= (undo adds) <= [current state]
+	
+	NSSet<NSNumber*> *changeset_added = changeset[kChangeset_added];
+	NSDictionary<NSNumber*, NSNumber*> *changeset_moves = changeset[kChangeset_indexes];
+	NSDictionary<NSNumber*, NSNumber*> *changeset_deleted = changeset[kChangeset_deleted];
+	
+	if (changeset_added.count == 0 && changeset_moves.count == 0 && changeset_deleted.count == 0) {
+		return nil;
+	}
+	
+	[self _willMutate];
+	
+	// Step 1 of 3:
+	//
+	// Undo added values.
+	
+	for (NSNumber *num in changeset_added)
+	{
+		NSUInteger const idx = [self indexOfValue:num.longLongValue];
+		if (idx != NSNotFound)
+		{
+			[self _removeValueAtIndex:idx];
+		}
+	}
+	
+	// Step 2 of 3:
+	//
+	// Undo move operations.
+	//
+	// We have a list of values, and their originalIndexes.
+	// So for each value, we need to:
+	// - remove it from it's currentIndex
+	// - add it back in it's originalIndex
+	
+	if (changeset_moves.count > 0)
+	{
+		NSUInteger const movesCount = changeset_moves.count;
+		
+		int64_t *movedValues = malloc(movesCount * sizeof(int64_t));
+		NSUInteger *targetIdxs = malloc(movesCount * sizeof(NSUInteger));
+		BOOL *isMoved = calloc(MAX(count, (NSUInteger)1), sizeof(BOOL));
+		NSUInteger m = 0;
+		
+		for (NSNumber *num in changeset_moves)
+		{
+			NSUInteger const idx = [self indexOfValue:num.longLongValue];
+			if (idx != NSNotFound) // shouldn't happen; sanity check
+			{
+				isMoved[idx] = YES;
+				
+				movedValues[m] = values[idx];
+				targetIdxs[m] = changeset_moves[num].unsignedIntegerValue;
+				m++;
+			}
+		}
+		
+		// Remove the moved values (in a single pass).
+		// They remain in the hash table, since they're about to be re-inserted.
+		
+		NSUInteger kept = 0;
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			if (!isMoved[i]) {
+				values[kept++] = values[i];
+			}
+		}
+		count = kept;
+		indexesStale = YES;
+		
+		// Sort by targetIdx (originalIdx).
+		// We want to add them from lowest idx to highest idx.
+		
+		NSUInteger *order = malloc(MAX(m, (NSUInteger)1) * sizeof(NSUInteger));
+		for (NSUInteger i = 0; i < m; i++) {
+			order[i] = i;
+		}
+		
+		qsort_b(order, m, sizeof(NSUInteger), ^int(const void *a, const void *b) {
+			
+			NSUInteger const idx1 = targetIdxs[*(const NSUInteger *)a];
+			NSUInteger const idx2 = targetIdxs[*(const NSUInteger *)b];
+			
+			return (idx1 < idx2) ? -1 : ((idx1 > idx2) ? 1 : 0);
+		});
+		
+		NSError *error = nil;
+		for (NSUInteger i = 0; i < m; i++)
+		{
+			NSUInteger const idx = targetIdxs[order[i]];
+			if (idx > count)
+			{
+				error = [self mismatchedChangeset];
+				break;
+			}
+			
+			if (idx < count) {
+				memmove(values + idx + 1, values + idx, (count - idx) * sizeof(int64_t));
+			}
+			values[idx] = movedValues[order[i]];
+			count++;
+		}
+		
+		free(movedValues);
+		free(targetIdxs);
+		free(isMoved);
+		free(order);
+		
+		if (error)
+		{
+			// Some of the moved values were never re-inserted. Rebuild the table to match the values.
+			[self rebuildMembers];
+			return error;
+		}
+	}
+	
+	// Step 3 of 3:
+	//
+	// Undo deleted values.
+	
+	if (changeset_deleted.count > 0)
+	{
+		NSArray<NSNumber*> *sorted = [[changeset_deleted allKeys] sortedArrayUsingComparator:
+			^NSComparisonResult(NSNumber *num1, NSNumber *num2)
+		{
+			return [changeset_deleted[num1] compare:changeset_deleted[num2]];
+		}];
+		
+		for (NSNumber *num in sorted)
+		{
+			int64_t const value = num.longLongValue;
+			if (!ZDCInt64TableContains(&members, value))
+			{
+				NSUInteger const idx = MIN(changeset_deleted[num].unsignedIntegerValue, count);
+				[self _insertValue:value atIndex:idx];
+			}
+		}
+	}
+	
+	return nil;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)undo:(NSDictionary *)changeset error:(NSError **)errPtr
+{
+	NSError *error = [self performUndo:changeset];
+	if (error)
+	{
+		if (errPtr) *errPtr = error;
+		return nil;
+	}
+	else
+	{
+		// Undo successful - generate redo changeset
+		NSDictionary *reverseChangeset = [self changeset];
+		
+		if (errPtr) *errPtr = nil;
+		return (reverseChangeset ?: @{}); // don't return nil without error
+	}
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSError *)performUndo:(NSDictionary *)changeset
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if ([self hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		return [self hasChangesError];
+	}
+	
+	if ([self isMalformedChangeset:changeset])
+	{
+		return [self malformedChangesetError];
+	}
+	
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSError *error = [self _undo:changeset];
+	if (error)
+	{
+		// Abandon botched undo attempt - revert to original state
+		[self rollback];
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
+	return error;
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (void)rollback
+{
+	// With snapshot-and-diff, the original values are right there.
+	
+	if (hasSnapshot && ![self isIdenticalToSnapshot])
+	{
+		if (self.isImmutable) {
+			@throw [self immutableException];
+		}
+		
+		[self setValues:snapshot count:snapshotCount];
+	}
+	
+	[self clearChangeTracking];
+}
+
+/**
+ * See ZDCSyncable.h for method description.
+ */
+- (nullable NSDictionary *)mergeChangesets:(NSArray<NSDictionary*> *)orderedChangesets
+                                     error:(NSError *_Nullable *_Nullable)errPtr
+{
+	NSError *error = [self importChangesets:orderedChangesets];
+	if (error)
+	{
+		if (errPtr) *errPtr = error;
+		return nil;
+	}
+	else
+	{
+		NSDictionary *mergedChangeset = [self changeset];
+		
+		if (errPtr) *errPtr = nil;
+		return (mergedChangeset ?: @{}); // don't return nil without error
+	}
+}
+
+- (nullable NSError *)importChangesets:(NSArray<NSDictionary*> *)orderedChangesets
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if ([self hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		return [self hasChangesError];
+	}
+	
+	// Check for malformed changesets.
+	// It's better to detect this early on, before we start modifying the object.
+	//
+	for (NSDictionary *changeset in orderedChangesets)
+	{
+		if ([self isMalformedChangeset:changeset])
+		{
+			return [self malformedChangesetError];
+		}
+	}
+	
+	if (orderedChangesets.count == 0) {
+		return nil;
+	}
+	
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSError *result_error = nil;
+	NSMutableArray<NSDictionary*> *changesets_redo = [NSMutableArray arrayWithCapacity:orderedChangesets.count];
+	
+	for (NSDictionary *changeset in [orderedChangesets reverseObjectEnumerator])
+	{
+		result_error = [self _undo:changeset];
+		if (result_error)
+		{
+			// Abort botched attempt - Revert to original state (before current `_undo:`)
+			[self rollback];
+			
+			// We still need to revert previous `_undo:` calls
+			break;
+		}
+		else
+		{
+			NSDictionary *redo = [self changeset];
+			if (redo) {
+				[changesets_redo addObject:redo];
+			}
+		}
+	}
+	
+	// Re-applying the redo changesets (from the oldest state) leaves a snapshot of the oldest state.
+	// So the changeset is then the consolidated version of the list.
+	
+	for (NSDictionary *redo in [changesets_redo reverseObjectEnumerator])
+	{
+		NSError *error = [self _undo:redo];
+		if (error)
+		{
+			// Not much we can do here - we're in a bad state
+			if (result_error == nil) {
+				result_error = error;
+			}
+			
+			break;
+		}
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	return result_error;
+}
+
+- (nullable NSDictionary *)mergeCloudVersion:(id)inCloudVersion
+                       withPendingChangesets:(nullable NSArray<NSDictionary*> *)pendingChangesets
+                                       error:(NSError *_Nullable *_Nullable)errPtr
+{
+	ZDC_TRACE_SCOPE(trace, "ZDCInt64OrderedSet", "mergeCloudVersion");
+	
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if ([self hasChanges])
+	{
+		// You cannot invoke this method if the object currently has changes.
+		// The code doesn't know what you want to happen.
+		// Are you asking us to throw away the current changes ?
+		// Are you expecting us to magically merge everything ?
+		if (errPtr) *errPtr = [self hasChangesError];
+		return nil;
+	}
+	
+	// Check for malformed changesets.
+	// It's better to detect this early on, before we start modifying the object.
+	//
+	for (NSDictionary *changeset in pendingChangesets)
+	{
+		if ([self isMalformedChangeset:changeset])
+		{
+			if (errPtr) *errPtr = [self malformedChangesetError];
+			return nil;
+		}
+	}
+	
+	if (![inCloudVersion isKindOfClass:[ZDCInt64OrderedSet class]])
+	{
+		if (errPtr) *errPtr = [self incorrectObjectClass];
+		return nil;
+	}
+	ZDCInt64OrderedSet *cloudVersion = (ZDCInt64OrderedSet *)inCloudVersion;
+	
+	// The merge runs the ZDCOrderedSet algorithm on boxed values.
+	// Since the changeset formats are identical,
+	// the result is exactly what a ZDCOrderedSet of NSNumbers would produce.
+	
+	ZDCOrderedSet<NSNumber*> *local =
+	  [[ZDCOrderedSet alloc] initWithOrderedSet:self.rawOrderedSet copyItems:NO trackChanges:NO];
+	ZDCOrderedSet<NSNumber*> *cloud =
+	  [[ZDCOrderedSet alloc] initWithOrderedSet:cloudVersion.rawOrderedSet copyItems:NO trackChanges:NO];
+	
+	NSDictionary *changeset = [local mergeCloudVersion:cloud withPendingChangesets:pendingChangesets error:errPtr];
+	if (changeset == nil) {
+		return nil;
+	}
+	
+	NSOrderedSet<NSNumber*> *merged = local.rawOrderedSet;
+	
+	int64_t *mergedValues = malloc(MAX(merged.count, (NSUInteger)1) * sizeof(int64_t));
+	NSUInteger i = 0;
+	for (NSNumber *num in merged)
+	{
+		mergedValues[i++] = num.longLongValue;
+	}
+	
+	[self setValues:mergedValues count:i];
+	free(mergedValues);
+	
+	[self clearChangeTracking];
+	return changeset;
+}
+
+@end
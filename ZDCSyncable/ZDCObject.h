@@ -7,6 +7,49 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@protocol ZDCRetentionPolicy;
+
+/**
+ * A snapshot of the change tracking state of an object.
+ * See `-[ZDCObject trackingStatistics]`.
+ */
+typedef struct ZDCTrackingStatistics {
+	
+	/** Number of items in the container (or number of monitored properties in a record). */
+	NSUInteger elementCount;
+	
+	/** Number of items (or keys) that were added since change tracking was last cleared. */
+	NSUInteger addedCount;
+	
+	/** Number of items (or keys) whose index is being tracked because they were moved. */
+	NSUInteger movedCount;
+	
+	/** Number of items (or keys) that were removed since change tracking was last cleared. */
+	NSUInteger deletedCount;
+	
+	/** Number of original values being held by change tracking (replaced or deleted values). */
+	NSUInteger originalCount;
+	
+	/**
+	 * Approximate number of bytes used by the change tracking bookkeeping.
+	 * This doesn't include the original values themselves, which are often shared with other objects.
+	 */
+	NSUInteger trackingBytes;
+	
+	/** Number of tracked mutations since change tracking was last cleared. */
+	NSUInteger mutationCount;
+	
+	/** Cumulative time (in seconds) spent generating changesets. */
+	NSTimeInterval changesetTime;
+	
+	/** Cumulative time (in seconds) spent performing undo operations. */
+	NSTimeInterval undoTime;
+	
+	/** Cumulative time (in seconds) spent merging (via `importChangesets:` & `mergeCloudVersion:`). */
+	NSTimeInterval mergeTime;
+	
+} ZDCTrackingStatistics NS_SWIFT_NAME(ZDCTrackingStatistics_ObjC);
+
 /**
  * ZDCObject is a simple base class with a small, but very useful, set of functionality:
  *
@@ -72,6 +115,180 @@ NS_SWIFT_NAME(ZDCObject_ObjC)
  */
 - (void)clearChangeTracking;
 
+/**
+ * Executes the given block with change tracking suspended.
+ *
+ * This is designed for bulk loads, such as hydrating an object from a local store.
+ * Mutations performed within the block are applied directly to the underlying storage,
+ * and skip all change tracking bookkeeping (including the `_willChangeValueForKey:` hook).
+ *
+ * The mutations made within the block become part of the baseline (as if they had been made before tracking began).
+ * Changes that were being tracked prior to invoking this method are kept,
+ * so the changeset continues to include (and undo continues to revert) those changes only.
+ * If the block modifies a key (or property) that already had a tracked change,
+ * then the value set within the block becomes its original value.
+ *
+ * Immutability is still enforced within the block.
+ *
+ * The containers also have initializers with a `trackChanges` parameter (e.g. `initWithArray:copyItems:trackChanges:`).
+ * If set to NO, the initial contents are not tracked as additions. That is, the result has no changes,
+ * which is equivalent to (but faster than) invoking `clearChangeTracking` immediately after initialization.
+ *
+ * @note Change tracking is suspended for the receiver only.
+ *       Nested objects (e.g. a ZDCDictionary stored within a ZDCRecord) are tracked independently.
+ */
+- (void)performWithoutChangeTracking:(void (NS_NOESCAPE ^)(void))block;
+
+/**
+ * Captures the current state of the object, including its change tracking information.
+ *
+ * The returned value is opaque. Pass it to `restoreCheckpoint:` to return the object to the captured state.
+ * This is designed for edit sessions that may be aborted, and is much cheaper than `rollback`,
+ * which calculates a changeset and then undoes it item by item.
+ *
+ * Any number of checkpoints may be taken (e.g. for nested edit sessions),
+ * and each can be restored any number of times, in any order.
+ *
+ * ZDCArray, ZDCDictionary, ZDCOrderedDictionary, ZDCOrderedSet & ZDCSet share their storage with the checkpoint,
+ * and only copy it upon the next mutation (copy-on-write). So taking a checkpoint costs O(1).
+ * ZDCInt64Array & ZDCInt64OrderedSet copy their values (a single memcpy), which costs O(n).
+ * A ZDCRecord copies its properties, which costs O(number of properties).
+ *
+ * @note The containers capture nested objects (e.g. a ZDCDictionary stored within a ZDCArray) by reference,
+ *       so changes made within them aren't reverted. Take a checkpoint of the nested object if needed.
+ *       A ZDCRecord captures its properties the same way its `copyWithZone:` copies them.
+ */
+- (id)checkpoint;
+
+/**
+ * Restores the object to the state captured by the given checkpoint.
+ *
+ * The change tracking information is restored too.
+ * So `hasChanges` & `changeset` report exactly what they would have reported when the checkpoint was taken.
+ *
+ * For ZDCArray, ZDCDictionary, ZDCOrderedDictionary, ZDCOrderedSet & ZDCSet
+ * this simply swaps in the captured storage, which costs O(1).
+ * ZDCInt64Array & ZDCInt64OrderedSet copy the captured values, which costs O(n).
+ * A ZDCRecord assigns its properties directly, so restoring doesn't trigger change tracking or KVO.
+ *
+ * @param checkpoint
+ *   A value previously returned from the receiver's `checkpoint` method.
+ *   Passing a checkpoint taken from a different object throws an exception.
+ */
+- (void)restoreCheckpoint:(id)checkpoint;
+
+/**
+ * Controls how change tracking retains "original" values.
+ * That is, items that have been deleted, and values that have been replaced.
+ *
+ * If nil (the default), originals are retained in memory until change tracking is cleared.
+ * See ZDCRetentionPolicy.h for the available options.
+ *
+ * The policy is copied along with the object (via `copy` & `immutableCopy`),
+ * but it's not considered part of the object's state. So it may be set on an immutable object,
+ * and it's not taken into account by `isEqual:`.
+ */
+@property (nonatomic, strong, readwrite, nullable) id<ZDCRetentionPolicy> retentionPolicy;
+
+/**
+ * Equivalent to `changeset`, but reports why a changeset couldn't be generated.
+ *
+ * With a retentionPolicy, an original value may no longer be resolvable (e.g. a spilled file was deleted).
+ * If this happens (for the receiver, or for any nested object), `changeset` returns nil,
+ * and leaves the change tracking info untouched, so no changes are lost.
+ * This method does the same, and also sets errPtr. (`undo:error:` & `mergeChangesets:error:` report it too.)
+ *
+ * @return
+ *   A changeset dictionary, or nil if there are no changes (errPtr is nil) or on failure (errPtr is set).
+ */
+- (nullable NSDictionary *)changesetWithError:(NSError *_Nullable *_Nullable)errPtr;
+
+/**
+ * Equivalent to `peakChangeset`, but reports why a changeset couldn't be generated.
+ * See `changesetWithError:` for details.
+ */
+- (nullable NSDictionary *)peakChangesetWithError:(NSError *_Nullable *_Nullable)errPtr;
+
+#pragma mark Statistics
+
+/**
+ * Returns statistics about the current change tracking state of the object.
+ *
+ * This is designed to be cheap enough to call frequently.
+ * The cost is proportional to the number of tracked changes (not the number of items in the object).
+ * So you can use it to decide when to trigger a sync,
+ * or to find objects that have become expensive to track.
+ *
+ * The counts only describe the receiver. Nested objects are not included.
+ * Use `aggregateTrackingStatistics` to include nested objects.
+ *
+ * The cumulative times cover the lifetime of the object (they're not reset by `clearChangeTracking`),
+ * and they're not carried over to copies.
+ */
+- (ZDCTrackingStatistics)trackingStatistics;
+
+/**
+ * Walks the graph of nested ZDCObject instances (e.g. a ZDCArray stored within a ZDCRecord),
+ * and returns the sum of the `trackingStatistics` of every object within the graph (including the receiver).
+ *
+ * Each object is only counted once, even if it appears multiple times within the graph.
+ *
+ * @note Merge operations recurse into nested objects, so the aggregate mergeTime may count the same time
+ *       at multiple levels of the graph. It's best thought of as a relative measure of cost.
+ */
+- (ZDCTrackingStatistics)aggregateTrackingStatistics;
+
+#pragma mark Concurrency
+
+/**
+ * Containers holding at least this many items process their child objects concurrently
+ * within `makeImmutable`, `hasChanges` & `clearChangeTracking`.
+ * That is, the recursive pass over nested ZDCObject instances is spread across the available cores.
+ * (ZDCConcurrentDictionary also uses it to decide whether to process its stripes concurrently.)
+ *
+ * The default value is 4096. Set it to NSUIntegerMax to disable concurrent processing.
+ *
+ * @note Concurrent processing assumes the object graph is a tree.
+ *       That is, a nested object isn't shared between multiple children of a large container.
+ *       (Otherwise the shared object could be cleared or made immutable from multiple threads at once.)
+ *       If your graph shares nested objects, disable concurrent processing.
+ */
+@property (class, atomic, assign, readwrite) NSUInteger concurrentChildThreshold;
+
+/**
+ * Publishes an immutable snapshot of the object's current state, for concurrent readers.
+ * The snapshot can then be fetched from any thread via `latestSnapshot`.
+ *
+ * This is designed for a single writer with many readers.
+ * The writer (i.e. the thread that mutates the object) invokes this method whenever it wants readers to see
+ * its changes (e.g. at the end of a transaction). It can then continue to mutate (and track changes)
+ * without waiting for readers.
+ *
+ * The snapshot is an immutable copy.
+ * For ZDCArray, ZDCDictionary, ZDCOrderedDictionary, ZDCOrderedSet & ZDCSet the storage is shared
+ * until the writer's next mutation (copy-on-write).
+ * Unlike `immutableCopy`, nested objects aren't made immutable. Instead the snapshot gets its own copy
+ * of each (mutable) nested object, recursively. So the writer can continue to mutate its nested objects,
+ * without affecting the snapshot. (Containers that have nested objects thus copy their storage.)
+ *
+ * The previously published snapshot is released once no reader can be in the middle of fetching it.
+ * (Readers that already fetched it keep it alive for as long as they hold onto it.)
+ *
+ * @note Only one thread may invoke this method at a time (i.e. the writer).
+ *
+ * @return The published snapshot.
+ */
+- (instancetype)publishSnapshot;
+
+/**
+ * Returns the most recently published snapshot (see `publishSnapshot`), or nil if none has been published.
+ *
+ * This method may be invoked from any thread, even while the writer is mutating the object.
+ * It's O(1), and never blocks: it doesn't take a lock, or wait for the writer.
+ * The returned snapshot is immutable, so it can be read without any further synchronization.
+ */
+- (nullable instancetype)latestSnapshot;
+
 #pragma mark NSCoding Utilities
 
 /**
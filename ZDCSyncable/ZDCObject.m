@@ -5,8 +5,48 @@
 
 #import "ZDCObject.h"
 #import "ZDCObjectSubclass.h"
+#import "ZDCRetentionPolicy.h"
+#import "ZDCSyncable.h"
+#import "ZDCNull.h"
 
+#import <mach/mach_time.h>
 #import <objc/runtime.h>
+#import <sched.h>
+
+/**
+ * The value returned from `-[ZDCObject checkpoint]`.
+ */
+@interface ZDCCheckpoint : NSObject {
+@public
+
+	ZDCObject *state;        // a private copy, which is never modified
+	__weak ZDCObject *owner; // the object the checkpoint was taken from
+}
+@end
+
+@implementation ZDCCheckpoint
+@end
+
+/**
+ * Publication slot for `publishSnapshot` & `latestSnapshot` (allocated upon the first publish).
+ *
+ * Readers announce themselves (in one of two reader counts) before loading the snapshot pointer,
+ * and withdraw once they've retained it. So after swapping in a new snapshot, the writer only has to wait
+ * for the readers that were already in-flight before it can release the old one. The writer flips the epoch
+ * (which selects the reader count new readers use) before waiting on each count. Thus new readers can't
+ * prevent a count from draining, and readers never wait on anything.
+ */
+typedef struct ZDCSnapshotSlot {
+	
+	void *snapshot;        // +1 retained (via CFBridgingRetain)
+	uint64_t epoch;
+	uintptr_t readers[2];  // indexed by (epoch & 1)
+	
+} ZDCSnapshotSlot;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
 @implementation ZDCObject {
@@ -15,6 +55,15 @@
 	void *observerContext;
 	BOOL isImmutable;
 	BOOL hasChanges;
+	NSUInteger changeTrackingSuspensionCount;
+	id<ZDCRetentionPolicy> retentionPolicy;
+	
+	NSUInteger mutationCount;
+	uint64_t changesetTicks; // in mach_absolute_time units
+	uint64_t undoTicks;      // in mach_absolute_time units
+	uint64_t mergeTicks;     // in mach_absolute_time units
+	
+	ZDCSnapshotSlot *snapshotSlot; // see `publishSnapshot` (allocated lazily)
 }
 
 /**
@@ -46,6 +95,16 @@
 	if (observerContext) {
 		[self removeObserver:self forKeyPath:@"isImmutable" context:observerContext];
 	}
+	
+	if (snapshotSlot)
+	{
+		// Readers must hold a reference to this object to fetch its snapshot, so none can be in-flight.
+		
+		if (snapshotSlot->snapshot) {
+			CFRelease(snapshotSlot->snapshot);
+		}
+		free(snapshotSlot);
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,6 +139,8 @@
 	ZDCObject *copy = [[[self class] alloc] init];
 	copy->isImmutable = NO;
 	copy->hasChanges = self->hasChanges;
+	copy->mutationCount = self->mutationCount;
+	copy->retentionPolicy = self->retentionPolicy;
 	
 	return copy;
 }
@@ -96,6 +157,7 @@
 		if (!copy->isImmutable)
 		{
 			copy->hasChanges = self->hasChanges;
+			copy->mutationCount = self->mutationCount;
 		}
 	}
 }
@@ -155,6 +217,7 @@
 - (void)clearChangeTracking
 {
 	hasChanges = NO;
+	mutationCount = 0;
 	
 	// Implementation Thoughts:
 	//
@@ -172,6 +235,594 @@
 //	}
 }
 
+/**
+ * See header file for description.
+ */
+- (void)performWithoutChangeTracking:(void (NS_NOESCAPE ^)(void))block
+{
+	if (block == nil) return;
+	
+	// Only the mutations made within the block are excluded from change tracking.
+	// Changes that were already being tracked are kept (and so are any changes to nested objects).
+	
+	BOOL const isOutermost = (changeTrackingSuspensionCount == 0);
+	
+	id context = nil;
+	if (isOutermost) {
+		context = [self _willPerformUntrackedChanges];
+	}
+	
+	changeTrackingSuspensionCount++;
+	@try
+	{
+		block();
+	}
+	@finally
+	{
+		changeTrackingSuspensionCount--;
+		
+		if (isOutermost) {
+			[self _didPerformUntrackedChanges:context];
+		}
+	}
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)_willPerformUntrackedChanges
+{
+	return nil;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_didPerformUntrackedChanges:(nullable id)context
+{
+	// Nothing to do (subclass hook)
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (BOOL)isChangeTrackingSuspended
+{
+	return (changeTrackingSuspensionCount > 0);
+}
+
+@synthesize retentionPolicy = retentionPolicy;
+
+// Set when a retained original can't be resolved while generating a changeset on this thread.
+// See `resolveChangeset:error:`.
+static __thread NSUInteger ZDCChangesetDepth = 0;
+static __thread BOOL ZDCChangesetUnresolved = NO;
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)retainedOriginal:(nullable id)value
+{
+	if (retentionPolicy == nil) return value;
+	
+	if (value == nil || value == [ZDCNull null] || [value isKindOfClass:[ZDCObject class]]) {
+		return value;
+	}
+	
+	return [retentionPolicy retainOriginalValue:value];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)resolvedOriginal:(nullable id)retained
+{
+	if ([retained isKindOfClass:[ZDCRetainedValue class]])
+	{
+		id value = [(ZDCRetainedValue *)retained resolvedValue];
+		if (value == nil) {
+			[self markChangesetUnresolved];
+		}
+		
+		return value;
+	}
+	
+	return retained;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)markChangesetUnresolved
+{
+	ZDCChangesetUnresolved = YES;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable NSDictionary *)resolveChangeset:(NSDictionary *_Nullable (NS_NOESCAPE ^)(void))block
+                                      error:(NSError *_Nullable *_Nullable)errPtr
+{
+	// Nested objects generate their changesets on the same thread as their parent (via `peakChangeset`).
+	// So only the outermost call resets the flag,
+	// and a failure anywhere within the graph fails the changeset of the root object too.
+	
+	BOOL const isOutermost = (ZDCChangesetDepth == 0);
+	if (isOutermost) {
+		ZDCChangesetUnresolved = NO;
+	}
+	
+	NSDictionary *changeset = nil;
+	
+	ZDCChangesetDepth++;
+	@try
+	{
+		changeset = block();
+	}
+	@finally
+	{
+		ZDCChangesetDepth--;
+	}
+	
+	BOOL const unresolved = ZDCChangesetUnresolved;
+	if (isOutermost) {
+		ZDCChangesetUnresolved = NO;
+	}
+	
+	if (unresolved)
+	{
+		if (errPtr) *errPtr = [self unresolvedOriginalError];
+		return nil;
+	}
+	
+	if (errPtr) *errPtr = nil;
+	return changeset;
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable NSDictionary *)changesetWithError:(NSError *_Nullable *_Nullable)errPtr
+{
+	if (![self conformsToProtocol:@protocol(ZDCSyncable)])
+	{
+		if (errPtr) *errPtr = nil;
+		return nil;
+	}
+	
+	return [self resolveChangeset:^NSDictionary *{
+		
+		return [(id<ZDCSyncable>)self changeset];
+		
+	} error:errPtr];
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable NSDictionary *)peakChangesetWithError:(NSError *_Nullable *_Nullable)errPtr
+{
+	if (![self conformsToProtocol:@protocol(ZDCSyncable)])
+	{
+		if (errPtr) *errPtr = nil;
+		return nil;
+	}
+	
+	return [self resolveChangeset:^NSDictionary *{
+		
+		return [(id<ZDCSyncable>)self peakChangeset];
+		
+	} error:errPtr];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)frozenOriginal:(nullable id)value
+{
+	if (value == nil || value == [ZDCNull null] || [value conformsToProtocol:@protocol(ZDCSyncable)]) {
+		return value;
+	}
+	
+	if ([value conformsToProtocol:@protocol(NSCopying)]) {
+		return [value copy];
+	}
+	
+	return value;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)changesetValueForOriginal:(nullable id)original
+{
+	if ([original isKindOfClass:[ZDCObject class]] && [(ZDCObject *)original isImmutable]) {
+		return original;
+	}
+	
+	if ([original conformsToProtocol:@protocol(ZDCSyncable)] &&
+	    [original conformsToProtocol:@protocol(NSCopying)])
+	{
+		return [original copy];
+	}
+	
+	return original;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Checkpoints
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (id)checkpoint
+{
+	// Subclasses make copyWithZone: as cheap as possible.
+	// The containers share their storage with the copy (copy-on-write), so this is O(1) for them.
+	
+	ZDCCheckpoint *checkpoint = [[ZDCCheckpoint alloc] init];
+	checkpoint->state = [self copy];
+	checkpoint->owner = self;
+	
+	return checkpoint;
+}
+
+/**
+ * See header file for description.
+ */
+- (void)restoreCheckpoint:(id)inCheckpoint
+{
+	if (isImmutable) {
+		@throw [self immutableException];
+	}
+	
+	if (![inCheckpoint isKindOfClass:[ZDCCheckpoint class]] ||
+	    ((ZDCCheckpoint *)inCheckpoint)->owner != self)
+	{
+		@throw [NSException exceptionWithName: NSInvalidArgumentException
+		                               reason: @"The checkpoint wasn't taken from this object."
+		                             userInfo: nil];
+	}
+	ZDCCheckpoint *checkpoint = (ZDCCheckpoint *)inCheckpoint;
+	
+	// The checkpoint may be restored again later, so its state must never be modified.
+	// Thus we restore from a copy of it (which, for the containers, shares the storage).
+	
+	[self restoreStateFromCopy:[checkpoint->state copy]];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCObject *copy = (ZDCObject *)another;
+	
+	hasChanges = copy->hasChanges;
+	mutationCount = copy->mutationCount;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block
+{
+	// Override me (if needed)
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Statistics
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static NSTimeInterval ZDCSecondsFromMachTicks(uint64_t ticks)
+{
+	static mach_timebase_info_data_t timebase;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		mach_timebase_info(&timebase);
+	});
+	
+	return ((double)ticks * (double)timebase.numer / (double)timebase.denom) / (double)NSEC_PER_SEC;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)incrementMutationCount
+{
+	mutationCount++;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)incrementMutationCountBy:(NSUInteger)count
+{
+	mutationCount += count;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)addElapsedTime:(uint64_t)startTime toTimer:(ZDCTrackingTimer)timer
+{
+	uint64_t const elapsed = mach_absolute_time() - startTime;
+	
+	switch (timer)
+	{
+		case ZDCTrackingTimer_Changeset : changesetTicks += elapsed; break;
+		case ZDCTrackingTimer_Undo      : undoTicks      += elapsed; break;
+		case ZDCTrackingTimer_Merge     : mergeTicks     += elapsed; break;
+	}
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (NSUInteger)estimatedTrackingBytesForEntryCount:(NSUInteger)count
+{
+	// Each entry within a Foundation hash table needs a key slot & a value slot,
+	// and the table is generally kept less than ~2/3 full.
+	// Keys & values are often boxed (e.g. NSNumber), but small numbers are tagged pointers.
+	
+	return count * (sizeof(void *) * 3);
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block
+{
+	// Override me
+}
+
+/**
+ * See header file for description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	// Subclasses override this method, and fill in the remaining fields.
+	
+	ZDCTrackingStatistics stats = {0};
+	stats.mutationCount = mutationCount;
+	stats.changesetTime = ZDCSecondsFromMachTicks(changesetTicks);
+	stats.undoTime      = ZDCSecondsFromMachTicks(undoTicks);
+	stats.mergeTime     = ZDCSecondsFromMachTicks(mergeTicks);
+	
+	return stats;
+}
+
+/**
+ * See header file for description.
+ */
+- (ZDCTrackingStatistics)aggregateTrackingStatistics
+{
+	ZDCTrackingStatistics total = {0};
+	
+	NSHashTable<ZDCObject*> *visited =
+	  [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality];
+	
+	NSMutableArray<ZDCObject*> *pending = [NSMutableArray arrayWithObject:self];
+	[visited addObject:self];
+	
+	// We use an explicit stack (rather than recursion), since object graphs can be deep.
+	
+	while (pending.count > 0)
+	{
+		ZDCObject *obj = [pending lastObject];
+		[pending removeLastObject];
+		
+		ZDCTrackingStatistics const stats = [obj trackingStatistics];
+		
+		total.elementCount  += stats.elementCount;
+		total.addedCount    += stats.addedCount;
+		total.movedCount    += stats.movedCount;
+		total.deletedCount  += stats.deletedCount;
+		total.originalCount += stats.originalCount;
+		total.trackingBytes += stats.trackingBytes;
+		total.mutationCount += stats.mutationCount;
+		total.changesetTime += stats.changesetTime;
+		total.undoTime      += stats.undoTime;
+		total.mergeTime     += stats.mergeTime;
+		
+		[obj enumerateChildObjectsWithBlock:^(ZDCObject *child, BOOL *stop) {
+			
+			if (![visited containsObject:child])
+			{
+				[visited addObject:child];
+				[pending addObject:child];
+			}
+		}];
+	}
+	
+	return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Concurrency
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static NSUInteger ZDCConcurrentChildThreshold = 4096;
+
+/**
+ * See header file for description.
+ */
++ (NSUInteger)concurrentChildThreshold
+{
+	return __atomic_load_n(&ZDCConcurrentChildThreshold, __ATOMIC_RELAXED);
+}
+
+/**
+ * See header file for description.
+ */
++ (void)setConcurrentChildThreshold:(NSUInteger)threshold
+{
+	__atomic_store_n(&ZDCConcurrentChildThreshold, threshold, __ATOMIC_RELAXED);
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsIn:(id)collection withBlock:(void (^)(ZDCObject *child, BOOL *stop))block
+{
+	BOOL const isDictionary = [collection isKindOfClass:[NSDictionary class]];
+	
+	if ([collection count] < [ZDCObject concurrentChildThreshold])
+	{
+		id<NSFastEnumeration> items = isDictionary ? [(NSDictionary *)collection objectEnumerator] : collection;
+		
+		BOOL stop = NO;
+		for (id obj in items)
+		{
+			if ([obj isKindOfClass:[ZDCObject class]])
+			{
+				block((ZDCObject *)obj, &stop);
+				if (stop) break;
+			}
+		}
+		
+		return;
+	}
+	
+	// Foundation's concurrent enumeration splits the collection into chunks,
+	// and processes the chunks on the global concurrent queue (via dispatch_apply).
+	// The method doesn't return until every chunk has been processed.
+	
+	NSEnumerationOptions const opts = NSEnumerationConcurrent;
+	
+	if (isDictionary)
+	{
+		[(NSDictionary *)collection enumerateKeysAndObjectsWithOptions:opts usingBlock:^(id key, id obj, BOOL *stop) {
+			
+			if ([obj isKindOfClass:[ZDCObject class]]) {
+				block((ZDCObject *)obj, stop);
+			}
+		}];
+	}
+	else if ([collection isKindOfClass:[NSSet class]])
+	{
+		[(NSSet *)collection enumerateObjectsWithOptions:opts usingBlock:^(id obj, BOOL *stop) {
+			
+			if ([obj isKindOfClass:[ZDCObject class]]) {
+				block((ZDCObject *)obj, stop);
+			}
+		}];
+	}
+	else
+	{
+		// NSArray & NSOrderedSet
+		
+		[collection enumerateObjectsWithOptions:opts usingBlock:^(id obj, NSUInteger idx, BOOL *stop) {
+			
+			if ([obj isKindOfClass:[ZDCObject class]]) {
+				block((ZDCObject *)obj, stop);
+			}
+		}];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Snapshots
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (instancetype)publishSnapshot
+{
+	ZDCObject *snapshot = [self snapshotCopy];
+	
+	ZDCSnapshotSlot *slot = snapshotSlot; // only the writer modifies the ivar
+	if (slot == NULL)
+	{
+		slot = calloc(1, sizeof(ZDCSnapshotSlot));
+		__atomic_store_n(&snapshotSlot, slot, __ATOMIC_RELEASE);
+	}
+	
+	void *const oldSnapshot =
+	  __atomic_exchange_n(&slot->snapshot, (void *)CFBridgingRetain(snapshot), __ATOMIC_SEQ_CST);
+	
+	if (oldSnapshot)
+	{
+		// Wait for the readers that may have loaded the old pointer (but not yet retained it).
+		//
+		// A reader may have read a stale epoch, and thus be counted in either reader count.
+		// So both counts are drained, one after the other.
+		
+		for (NSUInteger i = 0; i < 2; i++)
+		{
+			uint64_t const epoch = __atomic_fetch_add(&slot->epoch, 1, __ATOMIC_SEQ_CST);
+			
+			while (__atomic_load_n(&slot->readers[epoch & 1], __ATOMIC_SEQ_CST) > 0)
+			{
+				sched_yield();
+			}
+		}
+		
+		CFRelease(oldSnapshot);
+	}
+	
+	return snapshot;
+}
+
+/**
+ * Returns an immutable copy of the receiver, which doesn't share any child object with the receiver.
+ *
+ * Unlike `immutableCopy`, the receiver's children aren't made immutable.
+ * Instead, each child is replaced (within the copy) by its own snapshotCopy.
+ * Immutable children can't be modified by the writer, so they're shared as-is.
+ */
+- (instancetype)snapshotCopy
+{
+	ZDCObject *copy = [self copy];
+	
+	NSMapTable<ZDCObject*, ZDCObject*> *childCopies =
+	  [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+	                        valueOptions:NSPointerFunctionsStrongMemory];
+	
+	[copy _replaceChildObjectsUsingBlock:^ZDCObject *(ZDCObject *child) {
+		
+		if (child.isImmutable) {
+			return child;
+		}
+		
+		ZDCObject *childCopy = [childCopies objectForKey:child];
+		if (childCopy == nil)
+		{
+			childCopy = [child snapshotCopy];
+			[childCopies setObject:childCopy forKey:child];
+		}
+		
+		return childCopy;
+	}];
+	
+	[copy makeImmutable];
+	return copy;
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable instancetype)latestSnapshot
+{
+	ZDCSnapshotSlot *const slot = __atomic_load_n(&snapshotSlot, __ATOMIC_ACQUIRE);
+	if (slot == NULL) return nil;
+	
+	uint64_t const epoch = __atomic_load_n(&slot->epoch, __ATOMIC_SEQ_CST);
+	uintptr_t *const readers = &slot->readers[epoch & 1];
+	
+	__atomic_add_fetch(readers, 1, __ATOMIC_SEQ_CST);
+	
+	void *const snapshot = __atomic_load_n(&slot->snapshot, __ATOMIC_SEQ_CST);
+	CFTypeRef const retained = snapshot ? CFRetain(snapshot) : NULL;
+	
+	__atomic_sub_fetch(readers, 1, __ATOMIC_RELEASE);
+	
+	return CFBridgingRelease(retained);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark NSCoding Utilities
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -428,7 +1079,7 @@ static NSString *const kPlistKey_PathComponents = @"pathComponents";
 	// But again, objc confuses us, and will list them in other classes.
 	
 	NSArray *fixup_ZDCObject = @[
-		@"isImmutable", @"hasChanges"
+		@"isImmutable", @"hasChanges", @"retentionPolicy"
 	];
 	
 	for (NSString *property in fixup_ZDCObject)
@@ -530,7 +1181,12 @@ static NSString *const kPlistKey_PathComponents = @"pathComponents";
 			@throw [self immutableExceptionForKey:key];
 		}
 		
-		[self _willChangeValueForKey:key];
+		if (changeTrackingSuspensionCount == 0) {
+			[self _willChangeValueForKey:key];
+		}
+		else {
+			[self _willChangeUntrackedValueForKey:key];
+		}
 	}
 	
 	[super willChangeValueForKey:key];
@@ -541,13 +1197,19 @@ static NSString *const kPlistKey_PathComponents = @"pathComponents";
 	// Subclass hook
 }
 
+- (void)_willChangeUntrackedValueForKey:(NSString *)key
+{
+	// Subclass hook
+}
+
 - (void)didChangeValueForKey:(NSString *)key
 {
-	if ([self isMonitoredProperty:key])
+	if ([self isMonitoredProperty:key] && (changeTrackingSuspensionCount == 0))
 	{
 		if (!hasChanges) {
 			hasChanges = YES;
 		}
+		mutationCount++;
 		
 		[self _didChangeValueForKey:key];
 	}
@@ -634,4 +1296,15 @@ static NSString *const kPlistKey_PathComponents = @"pathComponents";
 	return [NSError errorWithDomain:NSStringFromClass([self class]) code:103 userInfo:userInfo];
 }
 
+- (NSError *)unresolvedOriginalError
+{
+	NSDictionary *userInfo = @{
+		NSLocalizedDescriptionKey:
+			@"Unable to generate the changeset. One or more original values could not be resolved"
+			@" via the retentionPolicy (e.g. a spilled value could not be read back)."
+	};
+	
+	return [NSError errorWithDomain:NSStringFromClass([self class]) code:104 userInfo:userInfo];
+}
+
 @end
@@ -5,6 +5,7 @@
 
 #import "ZDCObject.h"
 #import "ZDCSyncable.h"
+#import "ZDCChangeNotification.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -20,6 +21,10 @@ NS_ASSUME_NONNULL_BEGIN
  * - it tracks all changes and can provide a changeset (which encodes the change info)
  * - it supports undo & redo
  * - it supports merge operations
+ *
+ * Within the changeset, a contiguous run of moved keys (e.g. a block of rows that was dragged elsewhere)
+ * is encoded as a single block-move entry, rather than one entry per key.
+ * See `+[ZDCOrder blockMoveWithIndex:length:]` for the format & compatibility notes.
  */
 NS_SWIFT_NAME(ZDCOrderedDictionary_ObjC)
 @interface ZDCOrderedDictionary<KeyType, ObjectType> : ZDCObject <NSCoding, NSCopying, NSFastEnumeration, ZDCSyncable>
@@ -51,6 +56,13 @@ NS_SWIFT_NAME(ZDCOrderedDictionary_ObjC)
  */
 - (instancetype)initWithDictionary:(nullable NSDictionary<KeyType, ObjectType> *)raw copyItems:(BOOL)copyItems;
 
+/**
+ * Same as `initWithDictionary:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithDictionary:(nullable NSDictionary<KeyType, ObjectType> *)raw
+                         copyItems:(BOOL)copyItems
+                      trackChanges:(BOOL)trackChanges;
+
 /**
  * Creates a new orderedDictionary by copying to given one.
  *
@@ -72,6 +84,62 @@ NS_SWIFT_NAME(ZDCOrderedDictionary_ObjC)
 - (instancetype)initWithOrderedDictionary:(nullable ZDCOrderedDictionary<KeyType, ObjectType> *)another
                                 copyItems:(BOOL)flag;
 
+/**
+ * Same as `initWithOrderedDictionary:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithOrderedDictionary:(nullable ZDCOrderedDictionary<KeyType, ObjectType> *)another
+                                copyItems:(BOOL)copyItems
+                             trackChanges:(BOOL)trackChanges;
+
+#pragma mark Change Tracking
+
+/**
+ * Controls when the orderedDictionary switches from operation-by-operation tracking of the order,
+ * to snapshot-and-diff.
+ *
+ * Operation-by-operation tracking is cheap for a few edits, but degrades for wholesale rewrites
+ * (such as shuffles, sorts or full replacements), since the tracked indexes grow to the size of the container.
+ * So when the tracked indexes exceed this fraction of the element count,
+ * the orderedDictionary instead holds onto a snapshot of its original order,
+ * and calculates the moved & deleted indexes (by diffing the snapshot against the current order)
+ * when the changeset is requested.
+ *
+ * The changeset format & undo semantics are the same in either mode.
+ *
+ * The default value is 0.25. Set to zero to disable snapshot-and-diff.
+ */
+@property (nonatomic, assign, readwrite) double snapshotThreshold;
+
+/**
+ * Whether generated changesets encode long runs of moved keys as block-move entries.
+ * (See `+[ZDCOrder blockMoveWithIndex:length:]` for the format.)
+ *
+ * This shrinks the changeset when a block of keys is dragged elsewhere.
+ * But older versions of the framework reject changesets containing block-move entries.
+ * So only enable it once every reader of your changesets understands the format.
+ *
+ * Block-move entries are accepted by undo, import & merge regardless of this setting.
+ *
+ * The default value is NO.
+ */
+@property (nonatomic, assign, readwrite) BOOL compressesMoves;
+
+#pragma mark Key Interning
+
+/**
+ * When enabled, every key entering the orderedDictionary is uniqued via `[ZDCInternTable sharedTable]`.
+ *
+ * This allows the orderedDictionary to compare keys by pointer when scanning the order
+ * (e.g. within `indexForKey:`, when tracking moves & deletes, and when merging),
+ * and only fall back to `isEqual:` when that fails.
+ * Enabling this option interns the keys that are already in the orderedDictionary.
+ *
+ * The option is not serialized, but is preserved by copies.
+ *
+ * The default value is NO.
+ */
+@property (nonatomic, assign, readwrite) BOOL internsKeys;
+
 #pragma mark Raw
 
 /**
@@ -225,6 +293,37 @@ NS_SWIFT_NAME(ZDCOrderedDictionary_ObjC)
  */
 - (void)moveObjectAtIndex:(NSUInteger)oldIndex toIndex:(NSUInteger)newIndex;
 
+/**
+ * Moves the items at the given indexes, as a contiguous block, to the given index.
+ *
+ * @param indexes
+ *   The current indexes of the items to move. Out-of-bounds indexes are ignored.
+ *
+ * @param toIndex
+ *   The index to use AFTER the items have been removed (same as NSMutableOrderedSet):
+ *   - Step 1: `[array removeObjectsAtIndexes:indexes]`
+ *   - Step 2: `[array insertObjects:objs atIndexes:<toIndex ..< toIndex+objs.count>]`
+ *
+ * The storage is rearranged in a single pass.
+ * And the changeset only lists a minimal set of moved keys, just as if the items had been moved individually.
+ */
+- (void)moveObjectsAtIndexes:(NSIndexSet *)indexes toIndex:(NSUInteger)toIndex;
+
+/**
+ * Sorts the items by value (stable), using the given comparator.
+ *
+ * Unlike a loop of `moveObjectAtIndex:toIndex:` calls, the storage is rearranged in a single pass,
+ * and the changeset only lists a minimal set of moved keys.
+ * That is, the keys forming the longest run that's already in sorted (relative) order aren't marked as moved.
+ */
+- (void)sortUsingComparator:(NSComparator NS_NOESCAPE)cmptr;
+
+/**
+ * Sorts the items by key (stable), using the given comparator.
+ * See `sortUsingComparator:` for a discussion of change tracking.
+ */
+- (void)sortKeysUsingComparator:(NSComparator NS_NOESCAPE)cmptr;
+
 /**
  * Removes the {key, value} tuple from the orderedDictionary if the key exists.
  * If the key doesn't exist, no changes are made.
@@ -256,6 +355,87 @@ NS_SWIFT_NAME(ZDCOrderedDictionary_ObjC)
  */
 - (void)enumerateKeysAndObjectsUsingBlock:(void (^)(KeyType key, ObjectType obj, NSUInteger idx, BOOL *stop))block;
 
+/**
+ * Enumerates the keys in the ordered dictionary, with the given options.
+ *
+ * Pass NSEnumerationConcurrent to spread the enumeration across the available cores
+ * (the block must then be thread-safe), or NSEnumerationReverse to enumerate from last to first.
+ * The ordered dictionary must not be mutated during the enumeration.
+ */
+- (void)enumerateKeysWithOptions:(NSEnumerationOptions)opts
+                      usingBlock:(void (^)(KeyType key, NSUInteger idx, BOOL *stop))block;
+
+/**
+ * Enumerates the {key, value} tuples in the ordered dictionary, with the given options.
+ *
+ * Pass NSEnumerationConcurrent to spread the enumeration across the available cores
+ * (the block must then be thread-safe), or NSEnumerationReverse to enumerate from last to first.
+ * The ordered dictionary must not be mutated during the enumeration.
+ */
+- (void)enumerateKeysAndObjectsWithOptions:(NSEnumerationOptions)opts
+                                usingBlock:(void (^)(KeyType key, ObjectType obj, NSUInteger idx, BOOL *stop))block;
+
+#pragma mark Change Notifications
+
+/**
+ * Registers a block to be notified of changes to the dictionary, such as inserted, removed & moved indexes,
+ * and the keys whose values were replaced.
+ * This is designed for updating a table or collection view, without calculating changesets or diffing.
+ *
+ * All the changes made during a single turn of the run loop (of the thread making the changes)
+ * are coalesced, and delivered as a single notification on that thread.
+ * Changes made within `performChangeBatch:` are delivered when the (outermost) batch ends.
+ * Threads that don't run a run loop should use `performChangeBatch:` or `flushChangeNotifications`.
+ *
+ * Notifications cover every mutation, including those performed by undo, import & merge operations,
+ * and those performed within `performWithoutChangeTracking:`.
+ * Restoring a checkpoint is delivered as a reload (see `-[ZDCChangeNotification requiresReload]`).
+ *
+ * When no observers are registered, there's no overhead (aside from a nil check within each mutation).
+ *
+ * @return An opaque token, to be passed to `removeChangeObserver:`.
+ */
+- (id)addChangeObserver:(ZDCChangeObserverBlock)block;
+
+/**
+ * Unregisters an observer that was added via `addChangeObserver:`.
+ * Pending changes aren't delivered if the last observer is removed.
+ */
+- (void)removeChangeObserver:(id)observer;
+
+/**
+ * Executes the block, and then delivers a single notification covering the changes made within it.
+ * Batches may be nested.
+ */
+- (void)performChangeBatch:(void (NS_NOESCAPE ^)(void))block;
+
+/**
+ * Delivers the pending notification (if any) immediately.
+ */
+- (void)flushChangeNotifications;
+
+#pragma mark Diff
+
+/**
+ * Calculates the changeset between two versions of an orderedDictionary,
+ * without replaying the individual operations that led from one to the other.
+ *
+ * The result is a standard (undo) changeset.
+ * That is, invoking `undo:error:` on an orderedDictionary equal to `dst`
+ * will produce an orderedDictionary equal to `src`.
+ *
+ * Keys are joined via hashing, and the moved keys are chosen via a longest increasing subsequence,
+ * which keeps the set of moves minimal. The algorithm runs in O(n log n).
+ * Block-move entries are used if `dst.compressesMoves` is YES.
+ *
+ * @note Values are compared using `isEqual:`. Values that differ are recorded as replaced values,
+ *       even if they're syncable objects (i.e. no nested changesets are calculated).
+ *
+ * @return The changeset, or nil if the orderedDictionaries are equal.
+ */
++ (nullable NSDictionary<NSString*, id> *)changesetFrom:(ZDCOrderedDictionary *)src
+                                                     to:(ZDCOrderedDictionary *)dst;
+
 #pragma mark Equality
 
 /**
@@ -6,9 +6,15 @@
 #import "ZDCOrderedDictionary.h"
 
 #import "ZDCObjectSubclass.h"
+#import "ZDCChangeCoalescer.h"
+#import "ZDCInternTable.h"
 #import "ZDCNull.h"
 #import "ZDCOrder.h"
+#import "ZDCOriginalOrderCache.h"
 #import "ZDCRef.h"
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
 
 // Encoding/Decoding Keys
 //
@@ -26,6 +32,11 @@ static NSString *const kChangeset_values  = @"values";
 static NSString *const kChangeset_indexes = @"indexes";
 static NSString *const kChangeset_deleted = @"deleted";
 
+// Snapshot-and-diff
+//
+static double const kDefaultSnapshotThreshold = 0.25;
+static NSUInteger const kSnapshotMinimumTrackedCount = 64;
+
 /**
  * Changeset Tracking Architecture:
  *
@@ -62,17 +73,37 @@ static NSString *const kChangeset_deleted = @"deleted";
  * This can be used for undo operations. And when you're ready to save the object to disk,
  * you can merge all the snapshot changesets into a single merged changeset.
 **/
+@interface ZDCOrderedDictionary () <ZDCChangeCoalescerKeyedObject>
+@end
+
 @implementation ZDCOrderedDictionary {
 @private
 	
 	NSMutableDictionary<id, id> *dict;
 	NSMutableArray<id> *order;
 	
+	NSMutableArray<id> *orderedValues;  // index-aligned with order
+	NSMutableSet<id> *staleValueKeys;   // keys whose value (within orderedValues) is outdated
+	
 	NSMutableDictionary<id, id> *originalValues;
 	NSMutableDictionary<id, NSNumber*> *originalIndexes;
 	NSMutableDictionary<id, NSNumber*> *deletedIndexes;
+	
+	NSArray<id> *snapshotOrder; // original order (when using snapshot-and-diff)
+	double snapshotThreshold;
+	BOOL compressesMoves;       // encode runs as block-move entries (opt-in)
+	
+	BOOL internsKeys;
+	BOOL storageIsShared; // shared with a copy or checkpoint (see `unshareStorage`)
+	
+	ZDCOriginalOrderCache *originalOrderCache; // memoized by mergeCloudVersion (created lazily)
+	
+	ZDCChangeCoalescer *changeObservers;       // nil unless observers are registered
 }
 
+@synthesize snapshotThreshold = snapshotThreshold;
+@synthesize compressesMoves = compressesMoves;
+@synthesize internsKeys = internsKeys;
 @dynamic rawDictionary;
 @dynamic rawOrder;
 @dynamic count;
@@ -90,6 +121,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 }
 
 - (instancetype)initWithDictionary:(nullable NSDictionary<id, id> *)inRaw copyItems:(BOOL)flag
+{
+	return [self initWithDictionary:inRaw copyItems:flag trackChanges:YES];
+}
+
+- (instancetype)initWithDictionary:(nullable NSDictionary<id, id> *)inRaw
+                         copyItems:(BOOL)flag
+                      trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -97,15 +135,23 @@ static NSString *const kChangeset_deleted = @"deleted";
 		
 		dict = [[NSMutableDictionary alloc] initWithCapacity:capacity];
 		order = [[NSMutableArray alloc] initWithCapacity:capacity];
+		orderedValues = [[NSMutableArray alloc] initWithCapacity:capacity];
 		
 		originalValues = [[NSMutableDictionary alloc] initWithCapacity:capacity];
 		
+		snapshotThreshold = kDefaultSnapshotThreshold;
+		
 		[inRaw enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
 			
-			self->dict[key] = flag ? [obj copy] : obj;
+			id value = flag ? [obj copy] : obj;
+			
+			self->dict[key] = value;
 			[self->order addObject:key];
+			[self->orderedValues addObject:value];
 			
-			self->originalValues[key] = [ZDCNull null];
+			if (trackChanges) {
+				self->originalValues[key] = [ZDCNull null];
+			}
 		}];
 	}
 	return self;
@@ -117,6 +163,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 }
 
 - (instancetype)initWithOrderedDictionary:(nullable ZDCOrderedDictionary<id, id> *)another copyItems:(BOOL)flag
+{
+	return [self initWithOrderedDictionary:another copyItems:flag trackChanges:YES];
+}
+
+- (instancetype)initWithOrderedDictionary:(nullable ZDCOrderedDictionary<id, id> *)another
+                                copyItems:(BOOL)flag
+                             trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -124,15 +177,23 @@ static NSString *const kChangeset_deleted = @"deleted";
 		
 		dict = [[NSMutableDictionary alloc] initWithCapacity:capacity];
 		order = [[NSMutableArray alloc] initWithCapacity:capacity];
+		orderedValues = [[NSMutableArray alloc] initWithCapacity:capacity];
 		
 		originalValues = [[NSMutableDictionary alloc] initWithCapacity:capacity];
 		
+		snapshotThreshold = kDefaultSnapshotThreshold;
+		
 		[another enumerateKeysAndObjectsUsingBlock:^(id key, id obj, NSUInteger idx, BOOL *stop) {
 			
-			self->dict[key] = flag ? [obj copy] : obj;
+			id value = flag ? [obj copy] : obj;
+			
+			self->dict[key] = value;
 			[self->order addObject:key];
+			[self->orderedValues addObject:value];
 			
-			self->originalValues[key] = [ZDCNull null];
+			if (trackChanges) {
+				self->originalValues[key] = [ZDCNull null];
+			}
 		}];
 	}
 	return self;
@@ -156,6 +217,18 @@ static NSString *const kChangeset_deleted = @"deleted";
 			order = [[NSMutableArray alloc] init];
 		}
 		
+		orderedValues = [[NSMutableArray alloc] initWithCapacity:order.count];
+		for (id key in order)
+		{
+			id value = dict[key];
+			if (value == nil) {
+				return nil; // corrupt archive: order & dict don't match
+			}
+			[orderedValues addObject:value];
+		}
+		
+		snapshotThreshold = kDefaultSnapshotThreshold;
+		
 		// Note: ephemeral properties (i.e. for change tracking) are not serialized
 	}
 	return self;
@@ -179,12 +252,27 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	ZDCOrderedDictionary *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
 	
-	copy->dict = [self->dict mutableCopy];
-	copy->order = [self->order mutableCopy];
+	// The storage is shared between both objects, and copied upon the next mutation (copy-on-write).
+	// An immutable object is never mutated, so there's no need to mark it (it may be shared across threads).
+	
+	copy->dict = self->dict;
+	copy->order = self->order;
+	copy->orderedValues = self->orderedValues;
+	copy->staleValueKeys = self->staleValueKeys;
+	
+	copy->originalValues = self->originalValues;
+	copy->originalIndexes = self->originalIndexes;
+	copy->deletedIndexes = self->deletedIndexes;
 	
-	copy->originalValues = [self->originalValues mutableCopy];
-	copy->originalIndexes = [self->originalIndexes mutableCopy];
-	copy->deletedIndexes = [self->deletedIndexes mutableCopy];
+	copy->snapshotOrder = self->snapshotOrder;
+	copy->snapshotThreshold = self->snapshotThreshold;
+	copy->compressesMoves = self->compressesMoves;
+	copy->internsKeys = self->internsKeys;
+	
+	copy->storageIsShared = YES;
+	if (!self.isImmutable) {
+		self->storageIsShared = YES;
+	}
 	
 	return copy;
 }
@@ -203,12 +291,102 @@ static NSString *const kChangeset_deleted = @"deleted";
 			copy->originalValues = [self->originalValues mutableCopy];
 			copy->originalIndexes = [self->originalIndexes mutableCopy];
 			copy->deletedIndexes = [self->deletedIndexes mutableCopy];
+			copy->snapshotOrder = self->snapshotOrder;
 			
 			[super copyChangeTrackingTo:another];
 		}
 	}
 }
 
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCOrderedDictionary *copy = (ZDCOrderedDictionary *)another;
+	
+	// The copy shares its storage with the checkpoint, so we adopt it as-is (still marked as shared).
+	
+	dict = copy->dict;
+	order = copy->order;
+	orderedValues = copy->orderedValues;
+	staleValueKeys = copy->staleValueKeys;
+	
+	originalValues = copy->originalValues;
+	originalIndexes = copy->originalIndexes;
+	deletedIndexes = copy->deletedIndexes;
+	
+	snapshotOrder = copy->snapshotOrder;
+	
+	storageIsShared = copy->storageIsShared;
+	
+	[changeObservers reloadWithCount:order.count];
+	
+	[super restoreStateFromCopy:another];
+}
+
+/**
+ * Used by `publishSnapshot`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block
+{
+	for (id key in [dict allKeys])
+	{
+		id obj = dict[key];
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			dict[key] = block((ZDCObject *)obj);
+		}
+	}
+	
+	// Stale values are never read (see `staleValueKeys`), so they can simply be replaced too.
+	
+	NSUInteger const count = orderedValues.count;
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		id obj = orderedValues[idx];
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			orderedValues[idx] = block((ZDCObject *)obj);
+		}
+	}
+	
+	for (id key in [originalValues allKeys])
+	{
+		id obj = originalValues[key];
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			originalValues[key] = block((ZDCObject *)obj);
+		}
+	}
+}
+
+/**
+ * The storage (and change tracking info) may be shared with copies & checkpoints.
+ * This method must be invoked before modifying any of it.
+ */
+- (void)unshareStorage
+{
+	if (storageIsShared)
+	{
+		dict = [dict mutableCopy];
+		order = [order mutableCopy];
+		orderedValues = [orderedValues mutableCopy];
+		staleValueKeys = [staleValueKeys mutableCopy];
+		
+		originalValues = [originalValues mutableCopy];
+		originalIndexes = [originalIndexes mutableCopy];
+		deletedIndexes = [deletedIndexes mutableCopy];
+		
+		storageIsShared = NO;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Raw
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -288,6 +466,19 @@ static NSString *const kChangeset_deleted = @"deleted";
  */
 - (NSUInteger)indexForKey:(id)key
 {
+	if (internsKeys)
+	{
+		// The dictionary & order share the same (interned) key instances.
+		// So we can fetch the stored instance, and scan the order by pointer.
+		
+		const void *storedKey = NULL;
+		if (!key || !CFDictionaryGetKeyIfPresent((CFDictionaryRef)dict, (const void *)key, &storedKey)) {
+			return NSNotFound;
+		}
+		
+		return ZDCIndexOfKey(order, (__bridge id)storedKey, YES);
+	}
+	
 	if (![self containsKey:key]) {
 		return NSNotFound;
 	}
@@ -316,8 +507,15 @@ static NSString *const kChangeset_deleted = @"deleted";
  */
 - (id)objectAtIndex:(NSUInteger)idx
 {
-	id key = order[idx];
-	return dict[key];
+	if (staleValueKeys.count > 0)
+	{
+		id key = order[idx];
+		if ([staleValueKeys containsObject:key]) {
+			return dict[key];
+		}
+	}
+	
+	return orderedValues[idx];
 }
 
 /**
@@ -333,8 +531,7 @@ static NSString *const kChangeset_deleted = @"deleted";
  */
 - (nullable id)objectAtIndexedSubscript:(NSUInteger)idx
 {
-	id key = order[idx];
-	return dict[key];
+	return [self objectAtIndex:idx];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -353,6 +550,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (key == nil) {
 		return;
 	}
@@ -362,14 +560,23 @@ static NSString *const kChangeset_deleted = @"deleted";
 		[self _willUpdateValueForKey:key];
 		
 		dict[key] = object;
+		[self markValueStaleForKey:key];
+		
+		[changeObservers updatedKey:key]; // index is resolved lazily (once per notification)
 	}
 	else
 	{
+		if (internsKeys) {
+			key = [[ZDCInternTable sharedTable] internKey:key];
+		}
+		
 		NSUInteger index = order.count;
 		[self _willInsertObjectAtIndex:index withKey:key];
 		
 		dict[key] = object;
 		[order addObject:[key copy]]; // [key copy] => mutable string protection
+		[orderedValues addObject:object];
+		[changeObservers insertedIndex:index];
 	}
 }
 
@@ -415,6 +622,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (object == nil) return NSNotFound;
 	if (key == nil) return NSNotFound;
@@ -422,16 +630,25 @@ static NSString *const kChangeset_deleted = @"deleted";
 	NSUInteger index = [self indexForKey:key];
 	if (index == NSNotFound)
 	{
+		if (internsKeys) {
+			key = [[ZDCInternTable sharedTable] internKey:key];
+		}
+		
 		index = order.count - 1;
 		[self _willInsertObjectAtIndex:index withKey:key];
 		
 		dict[key] = object;
 		[order addObject:[key copy]]; // [key copy] => mutable string protection
+		[orderedValues addObject:object];
+		[changeObservers insertedIndex:(order.count - 1)];
 	}
 	else
 	{
 		[self _willUpdateValueForKey:key];
+		
 		dict[key] = object;
+		orderedValues[index] = object;
+		[changeObservers updatedIndex:index key:key];
 	}
 	
 	return index;
@@ -445,6 +662,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (object == nil) return NSNotFound;
 	if (key == nil) return NSNotFound;
@@ -459,15 +677,24 @@ static NSString *const kChangeset_deleted = @"deleted";
 			index = order.count - 1;
 		}
 		
+		if (internsKeys) {
+			key = [[ZDCInternTable sharedTable] internKey:key];
+		}
+		
 		[self _willInsertObjectAtIndex:index withKey:key];
 		
 		dict[key] = object;
 		[order insertObject:[key copy] atIndex:index]; // [key copy] => mutable string protection
+		[orderedValues insertObject:object atIndex:index];
+		[changeObservers insertedIndex:index];
 	}
 	else
 	{
 		[self _willUpdateValueForKey:key];
+		
 		dict[key] = object;
+		orderedValues[index] = object;
+		[changeObservers updatedIndex:index key:key];
 	}
 	
 	return index;
@@ -481,6 +708,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (oldIndex >= order.count) {
 		return;
@@ -495,8 +723,191 @@ static NSString *const kChangeset_deleted = @"deleted";
 	NSString *key = order[oldIndex];
 	[self _willMoveObjectFromIndex:oldIndex toIndex:newIndex withKey:key];
 	
+	id value = orderedValues[oldIndex];
+	
 	[order removeObjectAtIndex:oldIndex];
 	[order insertObject:key atIndex:newIndex];
+	
+	[orderedValues removeObjectAtIndex:oldIndex];
+	[orderedValues insertObject:value atIndex:newIndex];
+	
+	[changeObservers movedIndex:oldIndex toIndex:newIndex];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)moveObjectsAtIndexes:(NSIndexSet *)inIndexes toIndex:(NSUInteger)toIndex
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSUInteger const count = order.count;
+	
+	NSIndexSet *indexes = inIndexes;
+	if (indexes.lastIndex != NSNotFound && indexes.lastIndex >= count)
+	{
+		NSMutableIndexSet *validIndexes = [inIndexes mutableCopy];
+		[validIndexes removeIndexesInRange:NSMakeRange(count, NSNotFound - count)];
+		indexes = validIndexes;
+	}
+	if (indexes.count == 0) {
+		return;
+	}
+	
+	NSUInteger const remainingCount = count - indexes.count;
+	if (toIndex > remainingCount) {
+		toIndex = remainingCount;
+	}
+	
+	// sources[newIdx] = oldIdx
+	
+	NSUInteger *sources = malloc(count * sizeof(NSUInteger));
+	NSUInteger movedIdx = toIndex;
+	NSUInteger remainingIdx = 0;
+	
+	for (NSUInteger oldIdx = 0; oldIdx < count; oldIdx++)
+	{
+		if ([indexes containsIndex:oldIdx])
+		{
+			sources[movedIdx++] = oldIdx;
+		}
+		else
+		{
+			if (remainingIdx == toIndex) {
+				remainingIdx += indexes.count; // skip over the moved block
+			}
+			sources[remainingIdx++] = oldIdx;
+		}
+	}
+	
+	[self reorderWithSources:sources];
+	free(sources);
+}
+
+/**
+ * See header file for description.
+ */
+- (void)sortUsingComparator:(NSComparator NS_NOESCAPE)cmptr
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	[self refreshStaleValues];
+	
+	NSArray<id> *values = orderedValues;
+	[self sortWithComparator:^NSComparisonResult(NSUInteger idx1, NSUInteger idx2) {
+		
+		return cmptr(values[idx1], values[idx2]);
+	}];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)sortKeysUsingComparator:(NSComparator NS_NOESCAPE)cmptr
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSArray<id> *keys = order;
+	[self sortWithComparator:^NSComparisonResult(NSUInteger idx1, NSUInteger idx2) {
+		
+		return cmptr(keys[idx1], keys[idx2]);
+	}];
+}
+
+/**
+ * Performs a stable sort, where the comparator is passed the (current) indexes of the items to compare.
+ */
+- (void)sortWithComparator:(NSComparisonResult (NS_NOESCAPE ^)(NSUInteger idx1, NSUInteger idx2))cmptr
+{
+	NSUInteger const count = order.count;
+	if (count < 2) return;
+	
+	NSMutableArray<NSNumber*> *sorted = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		[sorted addObject:@(idx)];
+	}
+	
+	[sorted sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSNumber *num1, NSNumber *num2) {
+		
+		return cmptr(num1.unsignedIntegerValue, num2.unsignedIntegerValue);
+	}];
+	
+	NSUInteger *sources = malloc(count * sizeof(NSUInteger));
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		sources[idx] = sorted[idx].unsignedIntegerValue;
+	}
+	
+	[self reorderWithSources:sources];
+	free(sources);
+}
+
+/**
+ * Rearranges the items in a single pass, such that the item at index `sources[i]` is moved to index `i`.
+ * The `sources` buffer must be a permutation of [0, count).
+ */
+- (void)reorderWithSources:(const NSUInteger *)sources
+{
+	NSUInteger const count = order.count;
+	
+	BOOL isIdentity = YES;
+	for (NSUInteger idx = 0; idx < count && isIdentity; idx++)
+	{
+		isIdentity = (sources[idx] == idx);
+	}
+	if (isIdentity) {
+		return;
+	}
+	
+	NSMutableArray<id> *newOrder = [NSMutableArray arrayWithCapacity:count];
+	NSMutableArray<id> *newOrderedValues = [NSMutableArray arrayWithCapacity:count];
+	
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		// Stale values remain stale (they're tracked by key), so the values simply move with their keys.
+		
+		[newOrder addObject:order[sources[idx]]];
+		[newOrderedValues addObject:orderedValues[sources[idx]]];
+	}
+	
+	[self _willReorderToOrder:newOrder];
+	
+	if (changeObservers)
+	{
+		// Report the same minimal set of moves:
+		// Items within the longest increasing subsequence (of old index) stay where they are.
+		
+		NSIndexSet *inOrder = [ZDCOrder indexesOfLongestIncreasingSubsequence:sources count:count];
+		
+		NSMutableIndexSet *detachedIndexes = [NSMutableIndexSet indexSet];
+		for (NSUInteger idx = 0; idx < count; idx++)
+		{
+			if (![inOrder containsIndex:idx]) {
+				[detachedIndexes addIndex:sources[idx]];
+			}
+		}
+		
+		[changeObservers detachIndexes:detachedIndexes];
+		for (NSUInteger idx = 0; idx < count; idx++)
+		{
+			if (![inOrder containsIndex:idx]) {
+				[changeObservers reattachIndex:sources[idx] atIndex:idx];
+			}
+		}
+	}
+	
+	order = newOrder;
+	orderedValues = newOrderedValues;
 }
 
 /**
@@ -507,16 +918,21 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	NSUInteger idx = [self indexForKey:key];
 	if (idx == NSNotFound) {
 		return;
 	}
 	
+	key = order[idx]; // use the stored instance (allows for pointer comparisons)
 	[self _willRemoveObjectAtIndex:idx withKey:key];
 	
 	dict[key] = nil;
 	[order removeObjectAtIndex:idx];
+	[orderedValues removeObjectAtIndex:idx];
+	[staleValueKeys removeObject:key];
+	[changeObservers removedIndex:idx];
 }
 
 /**
@@ -527,20 +943,25 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (keys.count == 0) return;
 	
-	for (NSString *key in keys)
+	for (NSString *inKey in keys)
 	{
-		NSUInteger idx = [self indexForKey:key];
+		NSUInteger idx = [self indexForKey:inKey];
 		if (idx == NSNotFound) {
 			continue;
 		}
 		
+		id key = order[idx]; // use the stored instance (allows for pointer comparisons)
 		[self _willRemoveObjectAtIndex:idx withKey:key];
 		
 		dict[key] = nil;
 		[order removeObjectAtIndex:idx];
+		[orderedValues removeObjectAtIndex:idx];
+		[staleValueKeys removeObject:key];
+		[changeObservers removedIndex:idx];
 	}
 }
 
@@ -552,6 +973,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (idx >= order.count) return;
 	NSString *key = order[idx];
@@ -560,76 +982,207 @@ static NSString *const kChangeset_deleted = @"deleted";
 	
 	dict[key] = nil;
 	[order removeObjectAtIndex:idx];
+	[orderedValues removeObjectAtIndex:idx];
+	[staleValueKeys removeObject:key];
+	[changeObservers removedIndex:idx];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma mark Change Tracking Internals
+#pragma mark Ordered Values
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-- (void)_willUpdateValueForKey:(id)key
+/**
+ * The values are stored twice:
+ * - within `dict`, for lookups by key
+ * - within `orderedValues`, which is index-aligned with `order`, for indexed access & ordered enumeration
+ *
+ * Structural changes (insert, remove, move) are applied to both.
+ * But updating the value of an existing key would require finding its index, which is an O(n) scan.
+ * So instead we simply mark the key as stale, and readers fetch its value from `dict`.
+ * Once enough keys are stale, we refresh `orderedValues` in a single pass.
+ */
+- (void)markValueStaleForKey:(id)key
 {
-	NSParameterAssert(key != nil);
-	
-	if (originalValues == nil) {
-		originalValues = [[NSMutableDictionary alloc] init];
+	if (staleValueKeys == nil) {
+		staleValueKeys = [[NSMutableSet alloc] init];
 	}
+	[staleValueKeys addObject:key];
 	
-	if (originalValues[key] == nil) {
-		originalValues[key] = dict[key];
+	if (staleValueKeys.count > MAX((NSUInteger)16, order.count / 8)) {
+		[self refreshStaleValues];
 	}
 }
 
-- (void)_willInsertObjectAtIndex:(NSUInteger const)idx withKey:(id)key
+- (void)refreshStaleValues
 {
-	NSParameterAssert(idx <= order.count);
-	NSParameterAssert(key != nil);
+	if (staleValueKeys.count == 0) return;
 	
-	if (originalValues == nil) {
-		originalValues = [[NSMutableDictionary alloc] init];
-	}
+	[self unshareStorage];
 	
-	// INSERT: Step 1 of 2:
-	//
-	// Update originalValues as needed.
+	NSUInteger remaining = staleValueKeys.count;
+	NSUInteger const count = order.count;
 	
-	if (originalValues[key] == nil) {
-		originalValues[key] = [ZDCNull null];
+	for (NSUInteger idx = 0; idx < count && remaining > 0; idx++)
+	{
+		id key = order[idx];
+		if ([staleValueKeys containsObject:key])
+		{
+			orderedValues[idx] = dict[key];
+			remaining--;
+		}
 	}
 	
-	// INSERT: Step 2 of 2:
-	//
-	// If we're re-adding an item that was deleted within this changeset,
-	// then we need to remove it from the deleted list.
-	
-	deletedIndexes[key] = nil;
+	[staleValueKeys removeAllObjects];
 }
 
-- (void)_willRemoveObjectAtIndex:(NSUInteger const)idx withKey:(id)key
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Key Interning
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (void)setInternsKeys:(BOOL)flag
 {
-	NSParameterAssert(idx < order.count);
-	NSParameterAssert(key != nil);
+	if (internsKeys == flag) return;
 	
-	if (originalValues == nil) {
-		originalValues = [[NSMutableDictionary alloc] init];
-	}
-	if (originalIndexes == nil) {
-		originalIndexes = [[NSMutableDictionary alloc] init];
-	}
-	if (deletedIndexes == nil) {
-		deletedIndexes = [[NSMutableDictionary alloc] init];
+	if (self.isImmutable) {
+		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
-	// REMOVE: 1 of 3
+	internsKeys = flag;
+	if (!internsKeys) return;
+	
+	// Intern the existing keys.
 	//
-	// Update originalValues as needed.
-	// And check to see if we're deleting a item that was added within changeset.
+	// The dictionary & order must share the same key instances,
+	// so we rebuild the dictionary using the interned keys.
+	//
+	// Note that this doesn't affect change tracking,
+	// since the interned keys are equal to the keys they replace.
+	
+	NSArray<id> *internedOrder = [[ZDCInternTable sharedTable] internKeys:order];
+	NSMutableDictionary<id, id> *internedDict = [[NSMutableDictionary alloc] initWithCapacity:dict.count];
+	
+	for (id key in internedOrder)
+	{
+		internedDict[key] = dict[key];
+	}
+	
+	order = [internedOrder mutableCopy];
+	dict = internedDict;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Tracking Internals
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)_willUpdateValueForKey:(id)key
+{
+	if ([self isChangeTrackingSuspended])
+	{
+		// The new value becomes the original value.
+		// Unless the key was added (within the changeset), in which case it's still an added key.
+		
+		if (originalValues[key] != [ZDCNull null]) {
+			originalValues[key] = nil;
+		}
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
+	NSParameterAssert(key != nil);
+	
+	if (originalValues == nil) {
+		originalValues = [[NSMutableDictionary alloc] init];
+	}
+	
+	if (originalValues[key] == nil) {
+		originalValues[key] = [self retainedOriginal:[self frozenOriginal:dict[key]]];
+	}
+}
+
+- (void)_willInsertObjectAtIndex:(NSUInteger const)idx withKey:(id)key
+{
+	if ([self isChangeTrackingSuspended])
+	{
+		// The key becomes part of the original state.
+		// (If it was removed within the changeset, then the removal is discarded.)
+		// The order is handled by `_didPerformUntrackedChanges:`.
+		
+		originalValues[key] = nil;
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
+	NSParameterAssert(idx <= order.count);
+	NSParameterAssert(key != nil);
+	
+	if (originalValues == nil) {
+		originalValues = [[NSMutableDictionary alloc] init];
+	}
+	
+	// INSERT: Step 1 of 2:
+	//
+	// Update originalValues as needed.
+	
+	if (originalValues[key] == nil) {
+		originalValues[key] = [ZDCNull null];
+	}
+	
+	// INSERT: Step 2 of 2:
+	//
+	// If we're re-adding an item that was deleted within this changeset,
+	// then we need to remove it from the deleted list.
+	
+	deletedIndexes[key] = nil;
+}
+
+- (void)_willRemoveObjectAtIndex:(NSUInteger const)idx withKey:(id)key
+{
+	if ([self isChangeTrackingSuspended])
+	{
+		// The key is removed from the original state.
+		// (If it was added or modified within the changeset, then that change is discarded.)
+		// The order is handled by `_didPerformUntrackedChanges:`.
+		
+		originalValues[key] = nil;
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
+	NSParameterAssert(idx < order.count);
+	NSParameterAssert(key != nil);
+	
+	if (originalValues == nil) {
+		originalValues = [[NSMutableDictionary alloc] init];
+	}
+	if (originalIndexes == nil) {
+		originalIndexes = [[NSMutableDictionary alloc] init];
+	}
+	if (deletedIndexes == nil) {
+		deletedIndexes = [[NSMutableDictionary alloc] init];
+	}
+	
+	// Important: this check must be performed before we modify originalValues,
+	// since originalValues is used to reconstruct the original order.
+	BOOL const isTrackingViaSnapshot = [self isTrackingViaSnapshot];
+	
+	// REMOVE: 1 of 3
+	//
+	// Update originalValues as needed.
+	// And check to see if we're deleting a item that was added within changeset.
 	
 	BOOL wasAddedThenDeleted = NO;
 	
 	id originalValue = originalValues[key];
 	if (originalValue == nil)
 	{
-		originalValues[key] = dict[key];
+		originalValues[key] = [self retainedOriginal:[self frozenOriginal:dict[key]]];
 	}
 	else if (originalValue == [ZDCNull null])
 	{
@@ -642,8 +1195,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 	// then the two actions cancel each other out.
 	//
 	// Otherwise, this is a legitamate delete, and we need to record it.
+	// Unless we're tracking via snapshot, in which case the deletedIndexes will be calculated via diff.
 	
-	if (!wasAddedThenDeleted)
+	if (!wasAddedThenDeleted && !isTrackingViaSnapshot)
 	{
 		// REMOVE: Step 2 of 3:
 		//
@@ -699,7 +1253,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 				[originalOrder insertObject:key atIndex:prvIdx];
 			}
 	
-			originalIdx = [originalOrder indexOfObject:key];
+			originalIdx = ZDCIndexOfKey(originalOrder, key, internsKeys);
 		}
 		
 		originalIdx_addMoveOnly = originalIdx;
@@ -755,11 +1309,21 @@ static NSString *const kChangeset_deleted = @"deleted";
                          toIndex:(NSUInteger const)newIdx
                          withKey:(id)key
 {
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(oldIdx < order.count);
 	NSParameterAssert(newIdx <= order.count);
 	NSParameterAssert(oldIdx != newIdx);
 	NSParameterAssert(key != nil);
 	
+	if ([self isTrackingViaSnapshot]) {
+		return; // originalIndexes will be calculated via diff
+	}
+	
 	if (originalIndexes == nil) {
 		originalIndexes = [[NSMutableDictionary alloc] init];
 	}
@@ -806,7 +1370,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 			[originalOrder insertObject:key atIndex:prvIdx];
 		}
 		
-		originalIdx = [originalOrder indexOfObject:key];
+		originalIdx = ZDCIndexOfKey(originalOrder, key, internsKeys);
 		
 	#ifndef NS_BLOCK_ASSERTIONS
 		[self checkOriginalIndexes:originalIdx];
@@ -815,6 +1379,240 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 }
 
+/**
+ * Batched equivalent of invoking `_willMoveObjectFromIndex:toIndex:withKey:` for a series of moves,
+ * which result in the given order. (The newOrder must contain the same keys as the current order.)
+ *
+ * Rather than tracking each move, we recalculate the minimal set of moves from the original order.
+ */
+- (void)_willReorderToOrder:(NSArray<id> *)newOrder
+{
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
+	NSParameterAssert(newOrder.count == order.count);
+	
+	if ([self isTrackingViaSnapshot]) {
+		return; // originalIndexes will be calculated via diff
+	}
+	
+	// REORDER: Step 1 of 2:
+	//
+	// Reconstruct the original order (ignoring deletes & adds).
+	// This is the order that originalIndexes refers to. Recall the order in which the undo operation operates:
+	//
+	//                       direction    <=       this      <=     in      <=       read
+	// [previous state] <= (undo deletes) <= (reverse moves) <= (undo adds) <= [current state]
+	
+	NSMutableArray<id> *originalOrder = [NSMutableArray arrayWithCapacity:order.count];
+	for (id key in order)
+	{
+		if ((originalIndexes[key] == nil) && (originalValues[key] != [ZDCNull null]))
+		{
+			[originalOrder addObject:key];
+		}
+	}
+	
+	NSArray<id> *sortedKeys = [originalIndexes keysSortedByValueUsingComparator:
+		^NSComparisonResult(NSNumber *num1, NSNumber *num2)
+	{
+		return [num1 compare:num2];
+	}];
+	
+	for (id key in sortedKeys)
+	{
+		[originalOrder insertObject:key atIndex:[originalIndexes[key] unsignedIntegerValue]];
+	}
+	
+	// REORDER: Step 2 of 2:
+	//
+	// Calculate the minimal set of moves between the original order & the new order (again ignoring adds).
+	// This replaces every previously tracked move.
+	
+	NSMutableArray<id> *newOriginalItems = [NSMutableArray arrayWithCapacity:originalOrder.count];
+	for (id key in newOrder)
+	{
+		if (originalValues[key] != [ZDCNull null]) {
+			[newOriginalItems addObject:key];
+		}
+	}
+	
+	originalIndexes = [ZDCOrder movedIndexesFromOrder:originalOrder toOrder:newOriginalItems];
+	
+#ifndef NS_BLOCK_ASSERTIONS
+	[self checkOriginalIndexes];
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Snapshot-and-Diff
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns YES if changes to the order are currently being tracked via a snapshot of the original order.
+ *
+ * If we're still tracking changes operation-by-operation, but the tracked indexes have grown too large,
+ * then this method performs the switch (and returns YES).
+ */
+- (BOOL)isTrackingViaSnapshot
+{
+	if (snapshotOrder) return YES;
+	if (snapshotThreshold <= 0.0) return NO;
+	
+	NSUInteger const trackedCount = originalIndexes.count + deletedIndexes.count;
+	
+	if (trackedCount < kSnapshotMinimumTrackedCount) return NO;
+	if (trackedCount <= (NSUInteger)(snapshotThreshold * order.count)) return NO;
+	
+	snapshotOrder = [self reconstructOriginalOrder];
+	
+	[originalIndexes removeAllObjects];
+	[deletedIndexes removeAllObjects];
+	
+	return YES;
+}
+
+/**
+ * Reconstructs the original order (at the beginning of the changeset) from the tracking info.
+ */
+- (NSArray<id> *)reconstructOriginalOrder
+{
+	ZDC_TRACE_SCOPE(trace, "ZDCOrderedDictionary", "reconstructOriginalOrder");
+	ZDC_TRACE_COUNTER("ZDCOrderedDictionary", "reconstructOriginalOrder: count", order.count);
+	
+	//                       direction    <=       this      <=     in      <=      read
+	// [previous state] <= (undo deletes) <= (reverse moves) <= (undo adds) <= [current state]
+	
+	NSMutableArray<id> *result = [NSMutableArray arrayWithCapacity:(order.count + deletedIndexes.count)];
+	
+	for (id key in order)
+	{
+		if ((originalIndexes[key] == nil) && (originalValues[key] != [ZDCNull null]))
+		{
+			[result addObject:key];
+		}
+	}
+	
+	NSArray<id> *sortedKeys = [originalIndexes keysSortedByValueUsingComparator:
+		^NSComparisonResult(NSNumber *num1, NSNumber *num2)
+	{
+		return [num1 compare:num2];
+	}];
+	
+	for (id key in sortedKeys)
+	{
+		[result insertObject:key atIndex:[originalIndexes[key] unsignedIntegerValue]];
+	}
+	
+	NSArray<id> *deletedKeys = [deletedIndexes keysSortedByValueUsingComparator:
+		^NSComparisonResult(NSNumber *num1, NSNumber *num2)
+	{
+		return [num1 compare:num2];
+	}];
+	
+	for (id key in deletedKeys)
+	{
+		[result insertObject:key atIndex:[deletedIndexes[key] unsignedIntegerValue]];
+	}
+	
+	return [result copy];
+}
+
+/**
+ * Calculates the `indexes` & `deleted` components of the changeset,
+ * by diffing the original order against the current order.
+ *
+ * The results use the exact same format as operation-by-operation tracking
+ * (including block-move entries, if compressMoves is YES).
+ */
++ (void)getIndexes:(NSDictionary<id, id> **)outIndexes
+           deleted:(NSDictionary<id, NSNumber*> **)outDeleted
+         fromOrder:(NSArray<id> *)originalOrder
+           toOrder:(NSArray<id> *)order
+              dict:(NSDictionary<id, id> *)dict
+     compressMoves:(BOOL)compressMoves
+{
+	NSUInteger const originalCount = originalOrder.count;
+	NSUInteger const currentCount = order.count;
+	
+	// Step 1 of 2:
+	//
+	// Everything in the original order that's no longer in the dictionary was deleted.
+	//
+	// Recall that deletes are undone last:
+	//
+	//                       direction    <=       this      <=     in      <=      read
+	// [previous state] <= (undo deletes) <= (reverse moves) <= (undo adds) <= [current state]
+	//
+	// So the originalIndex of kept keys (as used by 'indexes') doesn't count deleted keys.
+	
+	NSMutableDictionary<id, NSNumber*> *changeset_deleted = [NSMutableDictionary dictionary];
+	NSMutableDictionary<id, NSNumber*> *keptRank = [NSMutableDictionary dictionaryWithCapacity:originalCount];
+	
+	NSUInteger keptCount = 0;
+	for (NSUInteger idx = 0; idx < originalCount; idx++)
+	{
+		id key = originalOrder[idx];
+		
+		if (dict[key] == nil) {
+			changeset_deleted[key] = @(idx);
+		}
+		else {
+			keptRank[key] = @(keptCount++);
+		}
+	}
+	
+	// Step 2 of 2:
+	//
+	// Calculate the minimum set of moves.
+	//
+	// Keys within the longest increasing subsequence (of originalIndex, in current order)
+	// are already in their proper relative order. Everything else gets moved.
+	
+	NSUInteger *previousIdxs = malloc(MAX(keptCount, 1) * sizeof(NSUInteger));
+	NSUInteger *currentIdxs = malloc(MAX(keptCount, 1) * sizeof(NSUInteger));
+	NSUInteger k = 0;
+	
+	NSMutableArray<id> *keptOrder = [NSMutableArray arrayWithCapacity:keptCount]; // current order, minus added keys
+	
+	for (NSUInteger idx = 0; idx < currentCount; idx++)
+	{
+		NSNumber *rank = keptRank[order[idx]];
+		if (rank && (k < keptCount))
+		{
+			previousIdxs[k] = rank.unsignedIntegerValue;
+			currentIdxs[k] = idx;
+			k++;
+			
+			[keptOrder addObject:order[idx]];
+		}
+	}
+	NSAssert(k == keptCount, @"Logic error");
+	
+	NSIndexSet *inOrder = [ZDCOrder indexesOfLongestIncreasingSubsequence:previousIdxs count:k];
+	
+	NSMutableDictionary<id, NSNumber*> *changeset_indexes = [NSMutableDictionary dictionary];
+	
+	for (NSUInteger i = 0; i < k; i++)
+	{
+		if (![inOrder containsIndex:i])
+		{
+			changeset_indexes[order[currentIdxs[i]]] = @(previousIdxs[i]);
+		}
+	}
+	
+	free(previousIdxs);
+	free(currentIdxs);
+	
+	*outIndexes = compressMoves
+	  ? [ZDCOrder compressMovedKeys:changeset_indexes order:keptOrder addedKeys:nil]
+	  : [changeset_indexes copy];
+	*outDeleted = changeset_deleted;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Sanity Checks
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -878,9 +1676,48 @@ static NSString *const kChangeset_deleted = @"deleted";
 
 - (void)enumerateKeysAndObjectsUsingBlock:(void (^)(id key, id obj, NSUInteger idx, BOOL *stop))block
 {
-	[order enumerateObjectsUsingBlock:^(id key, NSUInteger idx, BOOL *stop) {
+	if (staleValueKeys.count > 0)
+	{
+		[order enumerateObjectsUsingBlock:^(id key, NSUInteger idx, BOOL *stop) {
+			
+			id value = [self->staleValueKeys containsObject:key] ? self->dict[key] : self->orderedValues[idx];
+			block(key, value, idx, stop);
+		}];
+		return;
+	}
+	
+	// Fast path: a straight walk of the 2 index-aligned arrays
+	
+	[orderedValues enumerateObjectsUsingBlock:^(id value, NSUInteger idx, BOOL *stop) {
 		
-		block(key, self->dict[key], idx, stop);
+		block(self->order[idx], value, idx, stop);
+	}];
+}
+
+- (void)enumerateKeysWithOptions:(NSEnumerationOptions)opts
+                      usingBlock:(void (^)(id key, NSUInteger idx, BOOL *stop))block
+{
+	[order enumerateObjectsWithOptions:opts usingBlock:block];
+}
+
+- (void)enumerateKeysAndObjectsWithOptions:(NSEnumerationOptions)opts
+                                usingBlock:(void (^)(id key, id obj, NSUInteger idx, BOOL *stop))block
+{
+	// Note: The stale path only reads from staleValueKeys & dict, so it's safe for concurrent enumeration.
+	
+	if (staleValueKeys.count > 0)
+	{
+		[order enumerateObjectsWithOptions:opts usingBlock:^(id key, NSUInteger idx, BOOL *stop) {
+			
+			id value = [self->staleValueKeys containsObject:key] ? self->dict[key] : self->orderedValues[idx];
+			block(key, value, idx, stop);
+		}];
+		return;
+	}
+	
+	[orderedValues enumerateObjectsWithOptions:opts usingBlock:^(id value, NSUInteger idx, BOOL *stop) {
+		
+		block(self->order[idx], value, idx, stop);
 	}];
 }
 
@@ -891,6 +1728,71 @@ static NSString *const kChangeset_deleted = @"deleted";
 	return [order countByEnumeratingWithState:state objects:buffer count:len];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Notifications
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (id)addChangeObserver:(ZDCChangeObserverBlock)block
+{
+	if (changeObservers == nil) {
+		changeObservers = [[ZDCChangeCoalescer alloc] initWithObject:self count:order.count];
+	}
+	
+	return [changeObservers addObserver:block];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)removeChangeObserver:(id)observer
+{
+	[changeObservers removeObserver:observer];
+	
+	if (!changeObservers.hasObservers) {
+		changeObservers = nil;
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)performChangeBatch:(void (NS_NOESCAPE ^)(void))block
+{
+	if (block == nil) return;
+	
+	// The block may add or remove observers, so we hold onto the coalescer the batch was started on.
+	ZDCChangeCoalescer *coalescer = changeObservers;
+	
+	[coalescer beginBatch];
+	@try
+	{
+		block();
+	}
+	@finally
+	{
+		[coalescer endBatch];
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)flushChangeNotifications
+{
+	[changeObservers flush];
+}
+
+/**
+ * See ZDCChangeCoalescer.h for description.
+ */
+- (NSArray<id> *)changeCoalescerKeyOrder
+{
+	return order;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Equality
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -907,63 +1809,193 @@ static NSString *const kChangeset_deleted = @"deleted";
 
 - (BOOL)isEqualToOrderedDictionary:(nullable ZDCOrderedDictionary *)another
 {
-	if (another == nil) return NO; // null dereference crash ahead
+	if (another == nil) return NO; // null dereference crash ahead
+	
+	if (![dict isEqualToDictionary:another->dict]) return NO;
+	if (![order isEqualToArray:another->order]) return NO;
+	
+	return YES;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark ZDCObject Overrides
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
++ (NSMutableSet<NSString*> *)monitoredProperties
+{
+	NSMutableSet<NSString*> *monitoredProperties = [super monitoredProperties];
+	
+	// Configuration only - doesn't mutate the orderedDictionary
+	[monitoredProperties removeObject:NSStringFromSelector(@selector(snapshotThreshold))];
+	[monitoredProperties removeObject:NSStringFromSelector(@selector(compressesMoves))];
+	
+	return monitoredProperties;
+}
+
+- (void)makeImmutable
+{
+	[self refreshStaleValues];
+	[super makeImmutable];
+	
+	[self enumerateChildObjectsIn:dict withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child makeImmutable];
+	}];
+}
+
+- (BOOL)hasChanges
+{
+	if ([super hasChanges]) return YES;
+	
+	if (originalValues.count  > 0 ||
+	    originalIndexes.count > 0 ||
+	    deletedIndexes.count  > 0  ) return YES;
+	
+	if (snapshotOrder && ![order isEqualToArray:snapshotOrder]) return YES;
+	
+	__block BOOL childHasChanges = NO;
+	[self enumerateChildObjectsIn:dict withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		if ([child hasChanges])
+		{
+			__atomic_store_n(&childHasChanges, YES, __ATOMIC_RELAXED); // may be invoked concurrently
+			*stop = YES;
+		}
+	}];
+	
+	return childHasChanges;
+}
+
+- (void)clearChangeTracking
+{
+	[super clearChangeTracking];
+	
+	if (storageIsShared)
+	{
+		// The tracking info is shared with a copy or checkpoint (and is created lazily).
+		originalValues = nil;
+		originalIndexes = nil;
+		deletedIndexes = nil;
+	}
+	else
+	{
+		[originalValues removeAllObjects];
+		[originalIndexes removeAllObjects];
+		[deletedIndexes removeAllObjects];
+	}
+	
+	snapshotOrder = nil;
+	
+	[self enumerateChildObjectsIn:dict withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child clearChangeTracking];
+	}];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)_willPerformUntrackedChanges
+{
+	if (originalValues.count == 0 && originalIndexes.count == 0 && deletedIndexes.count == 0 && snapshotOrder == nil) {
+		return nil; // nothing is being tracked
+	}
 	
-	if (![dict isEqualToDictionary:another->dict]) return NO;
-	if (![order isEqualToArray:another->order]) return NO;
+	NSArray<id> *originalOrder = snapshotOrder ?: [self reconstructOriginalOrder];
 	
-	return YES;
+	if ([originalOrder isEqualToArray:order])
+	{
+		// The order hasn't changed, so the untracked mutations don't affect any tracked indexes.
+		
+		[self unshareStorage];
+		[originalIndexes removeAllObjects];
+		snapshotOrder = nil;
+		return nil;
+	}
+	
+	return @[ originalOrder, [order copy] ];
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma mark ZDCObject Overrides
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-- (void)makeImmutable
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_didPerformUntrackedChanges:(nullable id)context
 {
-	[super makeImmutable];
+	if (context == nil) return;
 	
-	for (id obj in [dict objectEnumerator])
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
-		{
-			[(ZDCObject *)obj makeImmutable];
-		}
+	NSArray<id> *originalOrder = context[0];
+	NSArray<id> *previousOrder = context[1];
+	
+	if ([previousOrder isEqualToArray:order]) {
+		return; // the block didn't modify the order
 	}
+	
+	// The untracked mutations shifted the indexes that originalIndexes & deletedIndexes refer to.
+	// So we apply the untracked changes to the original order, and switch to snapshot-and-diff.
+	
+	[self unshareStorage];
+	
+	snapshotOrder = [[ZDCOrder rebaseOrder: originalOrder
+	                             fromOrder: previousOrder
+	                               toOrder: order
+	                        matchIdentical: NO] copy];
+	
+	[originalIndexes removeAllObjects];
+	[deletedIndexes removeAllObjects];
 }
 
-- (BOOL)hasChanges
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
 {
-	if ([super hasChanges]) return YES;
-	
-	if (originalValues.count  > 0 ||
-	    originalIndexes.count > 0 ||
-	    deletedIndexes.count  > 0  ) return YES;
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	stats.elementCount = dict.count;
 	
-	for (id obj in [dict objectEnumerator])
+	for (id key in originalValues)
 	{
-		if ([obj isKindOfClass:[ZDCObject class]])
+		id originalValue = originalValues[key];
+		BOOL const exists = (dict[key] != nil);
+		
+		if (originalValue == [ZDCNull null])
+		{
+			if (exists) {
+				stats.addedCount++;
+			}
+		}
+		else
 		{
-			if ([(ZDCObject *)obj hasChanges]) return YES;
+			stats.originalCount++;
+			if (!exists) {
+				stats.deletedCount++;
+			}
 		}
 	}
 	
-	return NO;
+	// Note: When using snapshot-and-diff, moves aren't tracked (they're calculated via diff).
+	// Instead the snapshot holds onto the original order.
+	
+	stats.movedCount = originalIndexes.count;
+	
+	stats.trackingBytes =
+	  [self estimatedTrackingBytesForEntryCount:(originalValues.count + originalIndexes.count + deletedIndexes.count)];
+	stats.trackingBytes += snapshotOrder.count * sizeof(id);
+	
+	return stats;
 }
 
-- (void)clearChangeTracking
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block
 {
-	[super clearChangeTracking];
-	
-	[originalValues removeAllObjects];
-	[originalIndexes removeAllObjects];
-	[deletedIndexes removeAllObjects];
-	
+	BOOL stop = NO;
 	for (id obj in [dict objectEnumerator])
 	{
 		if ([obj isKindOfClass:[ZDCObject class]])
 		{
-			[(ZDCObject *)obj clearChangeTracking];
+			block((ZDCObject *)obj, &stop);
+			if (stop) break;
 		}
 	}
 }
@@ -1046,27 +2078,50 @@ static NSString *const kChangeset_deleted = @"deleted";
 		
 		NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:originalValues.count];
 		
-		[originalValues enumerateKeysAndObjectsUsingBlock:^(id key, id originalValue, BOOL *stop) {
+		[originalValues enumerateKeysAndObjectsUsingBlock:^(id key, id retainedValue, BOOL *stop) {
+			
+			id originalValue = [self resolvedOriginal:retainedValue];
 			
 			if (refs[key]) {
 				values[key] = [ZDCRef ref];
 			}
-			else if ([originalValue conformsToProtocol:@protocol(NSCopying)]) {
-				values[key] = [originalValue copy];
-			}
 			else {
-				values[key] = originalValue;
+				values[key] = [self changesetValueForOriginal:originalValue]; // frozen when captured
 			}
 		}];
 		
 		changeset[kChangeset_values] = values;
 	}
 	
+	if (snapshotOrder)
+	{
+		// Tracking via snapshot - calculate the indexes & deleted components via diff
+		
+		NSDictionary *changeset_indexes = nil;
+		NSDictionary *changeset_deleted = nil;
+		[[self class] getIndexes: &changeset_indexes
+		                 deleted: &changeset_deleted
+		               fromOrder: snapshotOrder
+		                 toOrder: order
+		                    dict: dict
+		           compressMoves: compressesMoves];
+		
+		if (changeset_indexes.count > 0) {
+			changeset[kChangeset_indexes] = changeset_indexes;
+		}
+		if (changeset_deleted.count > 0) {
+			changeset[kChangeset_deleted] = changeset_deleted;
+		}
+		
+		return changeset;
+	}
+	
 	if (originalIndexes.count > 0)
 	{
 		// changeset: {
 		//   indexes: {
-		//     key: oldIndex, ...
+		//     key: oldIndex, ...                  // single key
+		//     key: [1, oldIndex, length], ...     // contiguous run, if compressesMoves (see `+[ZDCOrder blockMoveWithIndex:length:]`)
 		//   },
 		//   ...
 		// }
@@ -1081,9 +2136,25 @@ static NSString *const kChangeset_deleted = @"deleted";
 			}
 		}];
 		
-		if (changeset_indexes.count > 0) {
+		if (changeset_indexes.count > 0 && !compressesMoves)
+		{
 			changeset[kChangeset_indexes] = [changeset_indexes copy];
 		}
+		else if (changeset_indexes.count > 0)
+		{
+			// Runs are measured within the order that remains after undoing added keys.
+			
+			NSMutableSet<id> *addedKeys = [NSMutableSet set];
+			[originalValues enumerateKeysAndObjectsUsingBlock:^(id key, id originalValue, BOOL *stop) {
+				
+				if (originalValue == [ZDCNull null]) {
+					[addedKeys addObject:key];
+				}
+			}];
+			
+			changeset[kChangeset_indexes] =
+			  [ZDCOrder compressMovedKeys:changeset_indexes order:order addedKeys:addedKeys];
+		}
 	}
 	
 	if (deletedIndexes.count > 0)
@@ -1101,14 +2172,92 @@ static NSString *const kChangeset_deleted = @"deleted";
 	return changeset;
 }
 
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetFrom:(ZDCOrderedDictionary *)src to:(ZDCOrderedDictionary *)dst
+{
+	NSParameterAssert(src != nil);
+	NSParameterAssert(dst != nil);
+	
+	NSMutableDictionary<NSString*, id> *changeset = [NSMutableDictionary dictionaryWithCapacity:3];
+	
+	// changeset: {
+	//   values: {
+	//     key: oldValue, ...
+	//   },
+	//   ...
+	// }
+	
+	NSMutableDictionary *values = [NSMutableDictionary dictionary];
+	
+	[src->dict enumerateKeysAndObjectsUsingBlock:^(id key, id srcValue, BOOL *stop) {
+		
+		id dstValue = dst->dict[key];
+		if (dstValue == nil || ![srcValue isEqual:dstValue])
+		{
+			values[key] = [src changesetValueForOriginal:[src frozenOriginal:srcValue]];
+		}
+	}];
+	
+	for (id key in dst->order)
+	{
+		if (src->dict[key] == nil) {
+			values[key] = [ZDCNull null]; // added
+		}
+	}
+	
+	if (values.count > 0) {
+		changeset[kChangeset_values] = values;
+	}
+	
+	// changeset: {
+	//   indexes: {
+	//     key: oldIndex, ...
+	//   },
+	//   deleted: {
+	//     key: oldIndex, ...
+	//   }
+	// }
+	
+	NSDictionary *changeset_indexes = nil;
+	NSDictionary *changeset_deleted = nil;
+	[self getIndexes: &changeset_indexes
+	         deleted: &changeset_deleted
+	       fromOrder: src->order
+	         toOrder: dst->order
+	            dict: dst->dict
+	   compressMoves: dst->compressesMoves];
+	
+	if (changeset_indexes.count > 0) {
+		changeset[kChangeset_indexes] = changeset_indexes;
+	}
+	if (changeset_deleted.count > 0) {
+		changeset[kChangeset_deleted] = changeset_deleted;
+	}
+	
+	return (changeset.count > 0) ? changeset : nil;
+}
+
 /**
  * See ZDCSyncable.h for method description.
  */
 - (nullable NSDictionary *)changeset
 {
-	NSDictionary *changeset = [self _changeset];
-	[self clearChangeTracking];
+	uint64_t const startTime = mach_absolute_time();
 	
+	NSError *error = nil;
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:&error];
+	
+	if (error == nil) {
+		[self clearChangeTracking]; // on failure, keep the changes (see changesetWithError:)
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
 	return changeset;
 }
 
@@ -1117,7 +2266,16 @@ static NSString *const kChangeset_deleted = @"deleted";
  */
 - (nullable NSDictionary *)peakChangeset
 {
-	return [self _changeset];
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:NULL];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
 }
 
 - (BOOL)isMalformedChangeset:(NSDictionary *)changeset
@@ -1177,12 +2335,16 @@ static NSString *const kChangeset_deleted = @"deleted";
 				return YES;
 			}
 	
-			// All values must be numbers.
+			// All values must be numbers (or block-move entries of a known version).
 	
 			for (id key in changeset_indexes)
 			{
 				id value = changeset_indexes[key];
-				if (![value isKindOfClass:[NSNumber class]]) {
+				if (![value isKindOfClass:[NSNumber class]])
+				{
+					if ([ZDCOrder getBlockMove:value index:NULL length:NULL]) {
+						continue;
+					}
 					return YES;
 				}
 				
@@ -1227,6 +2389,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	// Important: `isMalformedChangeset:` must be called before invoking this method.
 	
+	ZDC_TRACE_SCOPE(trace, "ZDCOrderedDictionary", "_undo");
+	ZDC_TRACE_COUNTER("ZDCOrderedDictionary", "_undo: count", dict.count);
+	
 	// This method is called from both `undo::` & `importChangesets::`.
 	//
 	// When called from `undo::`, there aren't any existing changes,
@@ -1326,6 +2491,14 @@ static NSString *const kChangeset_deleted = @"deleted";
 	NSDictionary *changeset_moves = changeset[kChangeset_indexes];
 	if (changeset_moves.count > 0)
 	{
+		// Block-move entries are expanded into their individual keys.
+		// This must happen after undoing added keys, since a run is defined within that order.
+		
+		changeset_moves = [ZDCOrder expandMovedKeys:changeset_moves order:order];
+		if (changeset_moves == nil) {
+			return [self mismatchedChangeset];
+		}
+		
 		// We have a list of keys, and their originalIndexes.
 		// So for each key, we need to:
 		// - remove it from it's currentIndex
@@ -1337,6 +2510,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 			originalIndexes = [[NSMutableDictionary alloc] init];
 		}
 		
+		// If we're tracking via snapshot, the originalIndexes get calculated via diff.
+		// So we skip the manual bookkeeping.
+		BOOL const isTrackingViaSnapshot = (snapshotOrder != nil);
+		
 		NSMutableArray<id> *keys = [NSMutableArray arrayWithCapacity:changeset_moves.count];
 		NSMutableIndexSet *indexes = [[NSMutableIndexSet alloc] init];
 		
@@ -1345,7 +2522,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 			NSUInteger idx = [self indexForKey:key];
 			if (idx != NSNotFound) // shouldn't happen; sanity check
 			{
-				if (isSimpleUndo)
+				if (isSimpleUndo && !isTrackingViaSnapshot)
 				{
 				#ifndef NS_BLOCK_ASSERTIONS
 					[self checkOriginalIndexes:idx];
@@ -1354,12 +2531,12 @@ static NSString *const kChangeset_deleted = @"deleted";
 					originalIndexes[key] = @(idx);
 				}
 				
-				[keys addObject:key];
+				[keys addObject:order[idx]]; // use the stored instance (allows for pointer comparisons)
 				[indexes addIndex:idx];
 			}
 		}
 		
-		if (!isSimpleUndo)
+		if (!isSimpleUndo && !isTrackingViaSnapshot)
 		{
 			NSMutableArray<id> *originalOrder = [NSMutableArray arrayWithCapacity:order.count];
 			
@@ -1387,7 +2564,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 			{
 				if (originalIndexes[key] == nil)
 				{
-					NSUInteger originalIdx = [originalOrder indexOfObject:key];
+					NSUInteger originalIdx = ZDCIndexOfKey(originalOrder, key, internsKeys);
 					if (originalIdx != NSNotFound)
 					{
 					#ifndef NS_BLOCK_ASSERTIONS
@@ -1404,7 +2581,20 @@ static NSString *const kChangeset_deleted = @"deleted";
 			}
 		}
 		
+		// Change notifications need to know where each key was detached from.
+		NSMutableDictionary<id, NSNumber*> *detachedIndexes = nil;
+		if (changeObservers)
+		{
+			detachedIndexes = [NSMutableDictionary dictionaryWithCapacity:indexes.count];
+			[indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+				
+				detachedIndexes[self->order[idx]] = @(idx);
+			}];
+		}
+		
 		[order removeObjectsAtIndexes:indexes];
+		[orderedValues removeObjectsAtIndexes:indexes];
+		[changeObservers detachIndexes:indexes];
 	
 		// Sort keys by targetIdx (originalIdx).
 		// We want to add them from lowest idx to highest idx.
@@ -1416,13 +2606,51 @@ static NSString *const kChangeset_deleted = @"deleted";
 			return [idx1 compare:idx2];
 		}];
 		
-		for (id key in keys)
+		// A run of consecutive target indexes (e.g. a block of rows that was dragged elsewhere)
+		// is re-inserted with a single bulk insert, rather than shifting the tail of the order once per key.
+		
+		NSUInteger const keyCount = keys.count;
+		NSUInteger k = 0;
+		
+		while (k < keyCount)
 		{
-			NSUInteger idx = [changeset_moves[key] unsignedIntegerValue];
+			NSUInteger const idx = [changeset_moves[keys[k]] unsignedIntegerValue];
+			
+			NSUInteger length = 1;
+			while ((k + length < keyCount) && ([changeset_moves[keys[k + length]] unsignedIntegerValue] == idx + length))
+			{
+				length++;
+			}
+			
 			if (idx > order.count) {
 				return [self mismatchedChangeset];
 			}
-			[order insertObject:key atIndex:idx];
+			
+			if (length == 1)
+			{
+				[order insertObject:keys[k] atIndex:idx];
+				[orderedValues insertObject:dict[keys[k]] atIndex:idx];
+			}
+			else
+			{
+				NSArray<id> *runKeys = [keys subarrayWithRange:NSMakeRange(k, length)];
+				NSMutableArray<id> *runValues = [NSMutableArray arrayWithCapacity:length];
+				for (id key in runKeys)
+				{
+					[runValues addObject:dict[key]];
+				}
+				
+				NSIndexSet *runIndexes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(idx, length)];
+				[order insertObjects:runKeys atIndexes:runIndexes];
+				[orderedValues insertObjects:runValues atIndexes:runIndexes];
+			}
+			
+			for (NSUInteger j = 0; j < length; j++)
+			{
+				[changeObservers reattachIndex:[detachedIndexes[keys[k + j]] unsignedIntegerValue] atIndex:(idx + j)];
+			}
+			
+			k += length;
 		}
 	}
 	
@@ -1471,9 +2699,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 	else
 	{
 		// Undo successful - generate redo changeset
-		NSDictionary *reverseChangeset = [self changeset];
+		NSDictionary *reverseChangeset = [self changesetWithError:&error];
+		
+		if (errPtr) *errPtr = error;
+		if (error) {
+			return nil;
+		}
 		
-		if (errPtr) *errPtr = nil;
 		return (reverseChangeset ?: @{}); // don't return nil without error
 	}
 }
@@ -1486,6 +2718,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if ([self hasChanges])
 	{
@@ -1501,6 +2734,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		return [self malformedChangesetError];
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *error = [self _undo:changeset];
 	if (error)
 	{
@@ -1508,6 +2743,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		[self rollback];
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
 	return error;
 }
 
@@ -1537,9 +2773,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 	else
 	{
-		NSDictionary *mergedChangeset = [self changeset];
+		NSDictionary *mergedChangeset = [self changesetWithError:&error];
+		
+		if (errPtr) *errPtr = error;
+		if (error) {
+			return nil;
+		}
 		
-		if (errPtr) *errPtr = nil;
 		return (mergedChangeset ?: @{}); // don't return nil without error
 	}
 }
@@ -1552,6 +2792,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if ([self hasChanges])
 	{
@@ -1577,6 +2818,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		return nil;
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *result_error = nil;
 	NSMutableArray<NSDictionary*> *changesets_redo = [NSMutableArray arrayWithCapacity:orderedChangesets.count];
 	
@@ -1593,7 +2836,14 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 		else
 		{
-			NSDictionary *redo = [self changeset];
+			NSDictionary *redo = [self changesetWithError:&result_error];
+			if (result_error)
+			{
+				// Unable to generate the redo changeset (an original couldn't be resolved).
+				// So this `_undo:` can't be reverted - we're in a bad state.
+				break;
+			}
+			
 			if (redo) {
 				[changesets_redo addObject:redo];
 			}
@@ -1614,6 +2864,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 	return result_error;
 }
 
@@ -1660,6 +2911,12 @@ static NSString *const kChangeset_deleted = @"deleted";
 		NSDictionary *changeset_moves = changeset[kChangeset_indexes];
 		if (changeset_moves.count > 0)
 		{
+			changeset_moves = [ZDCOrder expandMovedKeys:changeset_moves order:order];
+			if (changeset_moves == nil)
+			{
+				return nil;
+			}
+			
 			// We have a list of keys, and their originalIndexes.
 			// So for each key, we need to:
 			// - remove it from it's currentIndex
@@ -1744,9 +3001,13 @@ static NSString *const kChangeset_deleted = @"deleted";
                        withPendingChangesets:(nullable NSArray<NSDictionary*> *)pendingChangesets
                                        error:(NSError *_Nullable *_Nullable)errPtr
 {
+	ZDC_TRACE_SCOPE(trace, "ZDCOrderedDictionary", "mergeCloudVersion");
+	ZDC_TRACE_COUNTER("ZDCOrderedDictionary", "mergeCloudVersion: pendingChangesets", pendingChangesets.count);
+	
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if ([self hasChanges])
 	{
@@ -1777,6 +3038,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 	ZDCOrderedDictionary *cloudVersion = (ZDCOrderedDictionary *)inCloudVersion;
 	
+	uint64_t const startTime = mach_absolute_time();
+	
+	ZDC_TRACE_SCOPE(step, "ZDCOrderedDictionary", "mergeCloudVersion: step 1 of 8");
+	
 	// Step 1 of 8:
 	//
 	// If there are pending changes, calculate the original order.
@@ -1786,20 +3051,40 @@ static NSString *const kChangeset_deleted = @"deleted";
 	//   We don't care about the original values here.
 	//   Just the original order.
 	//
+	// The calculation is memoized, since merges are often repeated with the same pending changesets
+	// (or the same pending changesets plus the changeset returned from the previous merge).
+	//
 	// Important:
 	//   We need to do this in the beginning, because we need an unmodified `order`.
 	
 	NSArray<id> *originalOrder = nil;
 	if (pendingChangesets.count > 0)
 	{
-		originalOrder = [[self class] _originalOrderFrom:order pendingChangesets:pendingChangesets];
+		if (originalOrderCache == nil) {
+			originalOrderCache = [[ZDCOriginalOrderCache alloc] init];
+		}
+		
+		Class cls = [self class];
+		originalOrder =
+		  [originalOrderCache originalOrderFrom: order
+		                      pendingChangesets: pendingChangesets
+		                                 events: NULL
+		                                 replay:
+		    ^NSArray *(NSArray *inOrder, NSArray<NSDictionary*> *changesets, NSMutableArray *events)
+		{
+			return [cls _originalOrderFrom:inOrder pendingChangesets:changesets];
+		}];
+		
 		if (originalOrder == nil)
 		{
+			[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 			if (errPtr) *errPtr = [self mismatchedChangeset];
 			return nil;
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 2 of 8");
+	
 	// Step 2 of 8:
 	//
 	// We need to determine which keys have been changed locally, and what the original versions were.
@@ -1821,6 +3106,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 3 of 8");
+	
 	// Step 3 of 8:
 	//
 	// Next, we're going to enumerate what values are in the cloud.
@@ -1881,6 +3168,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}];
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 4 of 8");
+	
 	// Step 4 of 8:
 	//
 	// Next we need to determine if any values were deleted by remote devices.
@@ -1907,6 +3196,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 5 of 8");
+	
 	// Step 5 of 8:
 	//
 	// Merge the ZDCSyncable properties
@@ -1960,6 +3251,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 6 of 8");
+	
 	// Step 6 of 8:
 	//
 	// Prepare to merge the order.
@@ -1971,39 +3264,36 @@ static NSString *const kChangeset_deleted = @"deleted";
 	//
 	// Our aim here is to derive 2 arrays, one from cloudVersion->order, and another from self->order.
 	// Both of these arrays will have the same count, and contain the same keys, but possibly in a different order.
+	//
+	// If we're interning keys, then we also unique the keys within both arrays.
+	// This allows us to compare keys by pointer within step 8.
 	
-	NSMutableArray *order_localVersion = [self->order mutableCopy];
-	NSMutableArray *order_cloudVersion = [cloudVersion->order mutableCopy];
+	NSArray *order_localVersion = nil;
+	NSArray *order_cloudVersion = nil;
+	
+	if (internsKeys)
+	{
+		ZDCInternTable *internTable = [ZDCInternTable sharedTable];
+		
+		order_localVersion = [internTable internKeys:self->order];
+		order_cloudVersion = [internTable internKeys:cloudVersion->order];
+	}
+	else
+	{
+		order_localVersion = self->order;
+		order_cloudVersion = cloudVersion->order;
+	}
 	
 	{
 		NSMutableSet *merged_keys = [NSMutableSet setWithArray:self->order];
 		[merged_keys intersectSet:[NSSet setWithArray:cloudVersion->order]];
 		
-		NSUInteger i = 0;
-		while (i < order_localVersion.count)
-		{
-			id key = order_localVersion[i];
-			if ([merged_keys containsObject:key]) {
-				i++;
-			}
-			else {
-				[order_localVersion removeObjectAtIndex:i];
-			}
-		}
-		
-		i = 0;
-		while (i < order_cloudVersion.count)
-		{
-			id key = order_cloudVersion[i];
-			if ([merged_keys containsObject:key]) {
-				i++;
-			}
-			else {
-				[order_cloudVersion removeObjectAtIndex:i];
-			}
-		}
+		order_localVersion = [ZDCOrder filterOrder:order_localVersion keys:merged_keys];
+		order_cloudVersion = [ZDCOrder filterOrder:order_cloudVersion keys:merged_keys];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 7 of 8");
+	
 	// Step 7 of 8:
 	//
 	// So now we have a 2 lists of items that we can compare: local vs cloud.
@@ -2026,103 +3316,89 @@ static NSString *const kChangeset_deleted = @"deleted";
 		NSMutableSet *merged_keys = [NSMutableSet setWithArray:originalOrder];
 		[merged_keys intersectSet:[NSSet setWithArray:cloudVersion->order]];
 		
-		NSMutableArray *order_originalVersion = [originalOrder mutableCopy];
-		NSMutableArray *order_cloudVersion = [cloudVersion->order mutableCopy];
-		
-		NSUInteger i = 0;
-		while (i < order_originalVersion.count)
-		{
-			id key = order_originalVersion[i];
-			if ([merged_keys containsObject:key]) {
-				i++;
-			}
-			else {
-				[order_originalVersion removeObjectAtIndex:i];
-			}
-		}
+		NSArray *order_originalVersion = [ZDCOrder filterOrder:originalOrder keys:merged_keys];
+		NSArray *order_cloudVersion = [ZDCOrder filterOrder:cloudVersion->order keys:merged_keys];
 		
-		i = 0;
-		while (i < order_cloudVersion.count)
+		if (internsKeys)
 		{
-			id key = order_cloudVersion[i];
-			if ([merged_keys containsObject:key]) {
-				i++;
-			}
-			else {
-				[order_cloudVersion removeObjectAtIndex:i];
-			}
+			// Allows the estimator to compare keys by pointer only
+			ZDCInternTable *internTable = [ZDCInternTable sharedTable];
+			
+			order_originalVersion = [internTable internKeys:order_originalVersion];
+			order_cloudVersion = [internTable internKeys:order_cloudVersion];
 		}
 		
 		NSArray *estimate =
 			[ZDCOrder estimateChangesetFrom: order_originalVersion
 			                            to: order_cloudVersion
-			                         hints: movedKeys_remote];
+			                         hints: movedKeys_remote
+			                      interned: internsKeys];
 		
 		[movedKeys_remote addObjectsFromArray:estimate];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 8 of 8");
+	
 	// Step 8 of 8:
 	//
 	// We have all the information we need to merge the order now.
-	
-	for (NSUInteger i = 0; i < order_cloudVersion.count; i++)
+	//
+	// Whenever remote wins, the key needs to be moved into its proper position (within order).
+	// That is, immediately after the key that precedes it within the merged order.
+	//
+	// Within self->order, the keys of the merged order appear in increasing positions.
+	// So rather than searching the entire order for every move,
+	// we keep a cursor at the position of the previous move, and only search forward from there.
+	// (The key being moved always comes after prvKey.)
+	
+	__block NSUInteger cursor = 0;
+	
+	[ZDCOrder reconcileLocalOrder: order_localVersion
+	                   cloudOrder: order_cloudVersion
+	                  movedRemote: movedKeys_remote
+	                identityFirst: internsKeys
+	                   usingBlock:^(id key, id prvKey)
 	{
-		id key_remote = order_cloudVersion[i];
-		id key_local = order_localVersion[i];
+		// Note:
+		//   We already added all the keys that were added by remote devices.
+		//   And we already deleted all the key that were deleted by remote devices.
+		
+		NSUInteger const count = self->order.count;
+		NSUInteger newIdx = 0;
 		
-		if (![key_remote isEqual:key_local])
+		if (prvKey)
 		{
-			BOOL changed_remote = [movedKeys_remote containsObject:key_remote];
-			
-			if (changed_remote)
-			{
-				// Remote wins.
-				
-				id key = key_remote;
-				
-				// Move key into proper position (with changed_local)
-				
-				NSRange searchRange = NSMakeRange(i+1, order_localVersion.count-i-1);
-				NSUInteger idx = [order_localVersion indexOfObject:key inRange:searchRange];
-				
-				[order_localVersion removeObjectAtIndex:idx];
-				[order_localVersion insertObject:key atIndex:i];
-				
-				// Move key into proper position (within order)
-				//
-				// Note:
-				//   We already added all the keys that were added by remote devices.
-				//   And we already deleted all the key that were deleted by remote devices.
-				
-				NSUInteger oldIdx = [self indexForKey:key];
-				NSUInteger newIdx = 0;
-				if (i > 0)
-				{
-					NSString *prvKey_local = order_localVersion[i-1];
-					newIdx = [self indexForKey:prvKey_local] + 1;
-				}
-				
-				[self moveObjectAtIndex:oldIdx toIndex:newIdx];
-			}
-			else
-			{
-				// Local wins.
-				
-				id key = key_local;
-				
-				// Move remote into proper position (with changed_remote)
-				
-				NSRange searchRange = NSMakeRange(i+1, order_cloudVersion.count-i-1);
-				NSUInteger idx = [order_cloudVersion indexOfObject:key inRange:searchRange];
-				
-				[order_cloudVersion removeObjectAtIndex:idx];
-				[order_cloudVersion insertObject:key atIndex:i];
+			NSUInteger prvIdx = ZDCIndexOfKeyInRange(self->order, prvKey, NSMakeRange(cursor, count - cursor), self->internsKeys);
+			if (prvIdx == NSNotFound) { // shouldn't happen; sanity check
+				prvIdx = [self indexForKey:prvKey];
 			}
+			
+			newIdx = prvIdx + 1;
+		}
+		
+		NSUInteger oldIdx = NSNotFound;
+		if (newIdx < count) {
+			oldIdx = ZDCIndexOfKeyInRange(self->order, key, NSMakeRange(newIdx, count - newIdx), self->internsKeys);
+		}
+		if (oldIdx == NSNotFound) { // shouldn't happen; sanity check
+			oldIdx = [self indexForKey:key];
 		}
+		
+		[self moveObjectAtIndex:oldIdx toIndex:newIdx];
+		cursor = MIN(newIdx, self->order.count);
+	}];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	
+	NSError *error = nil;
+	NSDictionary *changeset = [self changesetWithError:&error];
+	
+	if (errPtr) *errPtr = error;
+	if (error) {
+		return nil;
 	}
 	
-	if (errPtr) *errPtr = nil;
-	return ([self changeset] ?: @{});
+	return (changeset ?: @{});
 }
 
 @end
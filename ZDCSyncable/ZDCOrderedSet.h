@@ -45,6 +45,13 @@ NS_SWIFT_NAME(ZDCOrderedSet_ObjC)
  */
 - (instancetype)initWithArray:(nullable NSArray<ObjectType> *)array copyItems:(BOOL)copyItems;
 
+/**
+ * Same as `initWithArray:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithArray:(nullable NSArray<ObjectType> *)array
+                    copyItems:(BOOL)copyItems
+                 trackChanges:(BOOL)trackChanges;
+
 /**
  * Creates an ordered set initialized from the given set.
  * The order is indeterminate.
@@ -64,6 +71,13 @@ NS_SWIFT_NAME(ZDCOrderedSet_ObjC)
  */
 - (instancetype)initWithSet:(nullable NSSet<ObjectType> *)set copyItems:(BOOL)copyItems;
 
+/**
+ * Same as `initWithSet:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithSet:(nullable NSSet<ObjectType> *)set
+                  copyItems:(BOOL)copyItems
+               trackChanges:(BOOL)trackChanges;
+
 /**
  * Creates a ZDCOrderedSet instance initialized by copying the given NSOrderedSet.
  */
@@ -81,6 +95,31 @@ NS_SWIFT_NAME(ZDCOrderedSet_ObjC)
  */
 - (instancetype)initWithOrderedSet:(nullable NSOrderedSet<ObjectType> *)orderedSet copyItems:(BOOL)copyItems;
 
+/**
+ * Same as `initWithOrderedSet:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithOrderedSet:(nullable NSOrderedSet<ObjectType> *)orderedSet
+                         copyItems:(BOOL)copyItems
+                      trackChanges:(BOOL)trackChanges;
+
+#pragma mark Interning
+
+/**
+ * When enabled, every object entering the orderedSet is uniqued via `[ZDCInternTable sharedTable]`.
+ *
+ * This allows the orderedSet to compare objects by pointer when scanning the order
+ * (e.g. when tracking moves & deletes, and when merging),
+ * and only fall back to `isEqual:` when that fails.
+ * Enabling this option interns the objects that are already in the orderedSet.
+ *
+ * This is designed for sets of small immutable values, such as string identifiers.
+ *
+ * The option is not serialized, but is preserved by copies.
+ *
+ * The default value is NO.
+ */
+@property (nonatomic, assign, readwrite) BOOL internsObjects;
+
 #pragma mark Raw
 
 /**
@@ -178,6 +217,31 @@ NS_SWIFT_NAME(ZDCOrderedSet_ObjC)
  */
 - (void)moveObjectAtIndex:(NSUInteger)oldIndex toIndex:(NSUInteger)newIndex;
 
+/**
+ * Moves the objects at the given indexes, as a contiguous block, to the given index.
+ *
+ * @param indexes
+ *   The current indexes of the objects to move. Out-of-bounds indexes are ignored.
+ *
+ * @param toIndex
+ *   The index to use AFTER the objects have been removed (same as NSMutableOrderedSet):
+ *   - Step 1: `[orderedSet removeObjectsAtIndexes:indexes]`
+ *   - Step 2: `[orderedSet insertObjects:objs atIndexes:<toIndex ..< toIndex+objs.count>]`
+ *
+ * The storage is rearranged in a single pass.
+ * And the changeset only lists a minimal set of moved objects, just as if they had been moved individually.
+ */
+- (void)moveObjectsAtIndexes:(NSIndexSet *)indexes toIndex:(NSUInteger)toIndex;
+
+/**
+ * Sorts the objects (stable), using the given comparator.
+ *
+ * Unlike a loop of `moveObjectAtIndex:toIndex:` calls, the storage is rearranged in a single pass,
+ * and the changeset only lists a minimal set of moved objects.
+ * That is, the objects forming the longest run that's already in sorted (relative) order aren't marked as moved.
+ */
+- (void)sortUsingComparator:(NSComparator NS_NOESCAPE)cmptr;
+
 /**
  * Removes a given object from the mutable ordered set (if it exists).
  */
@@ -194,6 +258,30 @@ NS_SWIFT_NAME(ZDCOrderedSet_ObjC)
  */
 - (void)removeAllObjects;
 
+#pragma mark Set Algebra
+
+// The methods below compute the membership delta in a single hashed pass,
+// and then update the change tracking information for the entire delta at once.
+// The resulting changeset is identical to the one produced by
+// the equivalent sequence of `addObject:` & `removeObject:` invocations.
+
+/**
+ * Appends each object in the given ordered set that isn't already a member (in the given order).
+ */
+- (void)unionOrderedSet:(NSOrderedSet<ObjectType> *)otherOrderedSet;
+
+/**
+ * Removes each object in the given set that's a member.
+ * The order of the remaining members is unchanged.
+ */
+- (void)minusSet:(NSSet<ObjectType> *)otherSet;
+
+/**
+ * Removes each member that isn't in the given set.
+ * The order of the remaining members is unchanged.
+ */
+- (void)intersectSet:(NSSet<ObjectType> *)otherSet;
+
 #pragma mark Enumeration
 
 /**
@@ -202,6 +290,16 @@ NS_SWIFT_NAME(ZDCOrderedSet_ObjC)
  */
 - (void)enumerateObjectsUsingBlock:(void (^)(ObjectType obj, NSUInteger idx, BOOL *stop))block;
 
+/**
+ * Enumerates all objects in the ordered set, with the given options.
+ *
+ * Pass NSEnumerationConcurrent to spread the enumeration across the available cores
+ * (the block must then be thread-safe), or NSEnumerationReverse to enumerate from the largest index down.
+ * The ordered set must not be mutated during the enumeration.
+ */
+- (void)enumerateObjectsWithOptions:(NSEnumerationOptions)opts
+                         usingBlock:(void (^)(ObjectType obj, NSUInteger idx, BOOL *stop))block;
+
 /**
  * An enumerator object that lets you access each object in the ordered set,
  * in order, from the element at the lowest index upwards.
@@ -215,6 +313,22 @@ NS_SWIFT_NAME(ZDCOrderedSet_ObjC)
  */
 - (NSEnumerator<ObjectType> *)reverseObjectEnumerator;
 
+#pragma mark Diff
+
+/**
+ * Calculates the changeset between two versions of an orderedSet,
+ * without replaying the individual operations that led from one to the other.
+ *
+ * The result is a standard (undo) changeset.
+ * That is, invoking `undo:error:` on an orderedSet equal to `dst` will produce an orderedSet equal to `src`.
+ *
+ * Items are joined via hashing, and the moved items are chosen via a longest increasing subsequence,
+ * which keeps the set of moves minimal. The algorithm runs in O(n log n).
+ *
+ * @return The changeset, or nil if the orderedSets are equal.
+ */
++ (nullable NSDictionary<NSString*, id> *)changesetFrom:(ZDCOrderedSet *)src to:(ZDCOrderedSet *)dst;
+
 #pragma mark Equality
 
 /**
@@ -6,7 +6,12 @@
 #import "ZDCOrderedSet.h"
 
 #import "ZDCObjectSubclass.h"
+#import "ZDCInternTable.h"
 #import "ZDCOrder.h"
+#import "ZDCOriginalOrderCache.h"
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
 
 // Encoding/Decoding Keys
 //
@@ -31,8 +36,14 @@ static NSString *const kChangeset_deleted = @"deleted";
 	NSMutableSet<id> *added;
 	NSMutableDictionary<id, NSNumber*> *originalIndexes;
 	NSMutableDictionary<id, NSNumber*> *deletedIndexes;
+	
+	BOOL internsObjects;
+	BOOL storageIsShared; // shared with a copy or checkpoint (see `unshareStorage`)
+	
+	ZDCOriginalOrderCache *originalOrderCache; // memoized by mergeCloudVersion (created lazily)
 }
 
+@synthesize internsObjects = internsObjects;
 @dynamic rawOrderedSet;
 @dynamic count;
 @dynamic firstObject;
@@ -53,6 +64,11 @@ static NSString *const kChangeset_deleted = @"deleted";
 }
 
 - (instancetype)initWithArray:(nullable NSArray<id> *)inArray copyItems:(BOOL)flag
+{
+	return [self initWithArray:inArray copyItems:flag trackChanges:YES];
+}
+
+- (instancetype)initWithArray:(nullable NSArray<id> *)inArray copyItems:(BOOL)flag trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -60,7 +76,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		  [[NSMutableOrderedSet alloc] initWithArray:inArray copyItems:flag] :
 		  [[NSMutableOrderedSet alloc] init];
 		
-		if (orderedSet.count > 0)
+		if (trackChanges && (orderedSet.count > 0))
 		{
 			added = [[NSMutableSet alloc] initWithCapacity:orderedSet.count];
 			
@@ -79,6 +95,11 @@ static NSString *const kChangeset_deleted = @"deleted";
 }
 
 - (instancetype)initWithSet:(nullable NSSet<id> *)inSet copyItems:(BOOL)flag
+{
+	return [self initWithSet:inSet copyItems:flag trackChanges:YES];
+}
+
+- (instancetype)initWithSet:(nullable NSSet<id> *)inSet copyItems:(BOOL)flag trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -86,7 +107,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		  [[NSMutableOrderedSet alloc] initWithSet:inSet copyItems:flag] :
 		  [[NSMutableOrderedSet alloc] init];
 		
-		if (orderedSet.count > 0)
+		if (trackChanges && (orderedSet.count > 0))
 		{
 			added = [[NSMutableSet alloc] initWithCapacity:orderedSet.count];
 			
@@ -105,6 +126,11 @@ static NSString *const kChangeset_deleted = @"deleted";
 }
 
 - (instancetype)initWithOrderedSet:(nullable NSOrderedSet<id> *)inOrderedSet copyItems:(BOOL)flag
+{
+	return [self initWithOrderedSet:inOrderedSet copyItems:flag trackChanges:YES];
+}
+
+- (instancetype)initWithOrderedSet:(nullable NSOrderedSet<id> *)inOrderedSet copyItems:(BOOL)flag trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -112,7 +138,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		  [[NSMutableOrderedSet alloc] initWithOrderedSet:inOrderedSet copyItems:flag] :
 		  [[NSMutableOrderedSet alloc] init];
 		
-		if (orderedSet.count > 0)
+		if (trackChanges && (orderedSet.count > 0))
 		{
 			added = [[NSMutableSet alloc] initWithCapacity:orderedSet.count];
 			
@@ -161,11 +187,21 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	ZDCOrderedSet *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
 	
-	copy->orderedSet = [self->orderedSet mutableCopy];
+	// The storage is shared between both objects, and copied upon the next mutation (copy-on-write).
+	// An immutable object is never mutated, so there's no need to mark it (it may be shared across threads).
 	
-	copy->added           = [self->added mutableCopy];
-	copy->originalIndexes = [self->originalIndexes mutableCopy];
-	copy->deletedIndexes  = [self->deletedIndexes mutableCopy];
+	copy->orderedSet = self->orderedSet;
+	
+	copy->added           = self->added;
+	copy->originalIndexes = self->originalIndexes;
+	copy->deletedIndexes  = self->deletedIndexes;
+	
+	copy->internsObjects = self->internsObjects;
+	
+	copy->storageIsShared = YES;
+	if (!self.isImmutable) {
+		self->storageIsShared = YES;
+	}
 	
 	return copy;
 }
@@ -190,6 +226,79 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 }
 
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCOrderedSet *copy = (ZDCOrderedSet *)another;
+	
+	// The copy shares its storage with the checkpoint, so we adopt it as-is (still marked as shared).
+	
+	orderedSet = copy->orderedSet;
+	
+	added           = copy->added;
+	originalIndexes = copy->originalIndexes;
+	deletedIndexes  = copy->deletedIndexes;
+	
+	storageIsShared = copy->storageIsShared;
+	
+	[super restoreStateFromCopy:another];
+}
+
+/**
+ * Used by `publishSnapshot`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block
+{
+	// Note: The keys of originalIndexes & deletedIndexes are copied by the dictionaries,
+	// so they're never shared with the receiver's children.
+	
+	NSUInteger const count = orderedSet.count;
+	for (NSUInteger idx = 0; idx < count; idx++)
+	{
+		id obj = orderedSet[idx];
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			
+			// The replacement is equal to the original, so we can't use `replaceObjectAtIndex:withObject:`.
+			[orderedSet removeObjectAtIndex:idx];
+			[orderedSet insertObject:block((ZDCObject *)obj) atIndex:idx];
+		}
+	}
+	
+	for (id obj in [added allObjects])
+	{
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			[added removeObject:obj];
+			[added addObject:block((ZDCObject *)obj)];
+		}
+	}
+}
+
+/**
+ * The storage (and change tracking info) may be shared with copies & checkpoints.
+ * This method must be invoked before modifying any of it.
+ */
+- (void)unshareStorage
+{
+	if (storageIsShared)
+	{
+		orderedSet = [orderedSet mutableCopy];
+		
+		added           = [added mutableCopy];
+		originalIndexes = [originalIndexes mutableCopy];
+		deletedIndexes  = [deletedIndexes mutableCopy];
+		
+		storageIsShared = NO;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Raw
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -247,10 +356,15 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (obj == nil) return;
 	
 	if (![orderedSet containsObject:obj])
 	{
+		if (internsObjects) {
+			obj = [[ZDCInternTable sharedTable] internKey:obj];
+		}
+		
 		[self _willInsertObject:obj atIndex:orderedSet.count];
 		[orderedSet addObject:obj];
 	}
@@ -261,6 +375,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (obj == nil) return;
 	
 	if (![orderedSet containsObject:obj])
@@ -273,6 +388,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 			idx = orderedSet.count;
 		}
 		
+		if (internsObjects) {
+			obj = [[ZDCInternTable sharedTable] internKey:obj];
+		}
+		
 		[self _willInsertObject:obj atIndex:idx];
 		[orderedSet insertObject:obj atIndex:idx];
 	}
@@ -288,6 +407,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (oldIndex >= orderedSet.count) {
 		return;
@@ -306,16 +426,81 @@ static NSString *const kChangeset_deleted = @"deleted";
 	[orderedSet insertObject:obj atIndex:newIndex];
 }
 
+- (void)moveObjectsAtIndexes:(NSIndexSet *)inIndexes toIndex:(NSUInteger)toIndex
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSUInteger const count = orderedSet.count;
+	
+	NSIndexSet *indexes = inIndexes;
+	if (indexes.lastIndex != NSNotFound && indexes.lastIndex >= count)
+	{
+		NSMutableIndexSet *validIndexes = [inIndexes mutableCopy];
+		[validIndexes removeIndexesInRange:NSMakeRange(count, NSNotFound - count)];
+		indexes = validIndexes;
+	}
+	if (indexes.count == 0) {
+		return;
+	}
+	
+	NSUInteger const remainingCount = count - indexes.count;
+	if (toIndex > remainingCount) {
+		toIndex = remainingCount;
+	}
+	
+	NSMutableArray<id> *newOrder = [[orderedSet array] mutableCopy];
+	NSArray<id> *moved = [newOrder objectsAtIndexes:indexes];
+	
+	[newOrder removeObjectsAtIndexes:indexes];
+	[newOrder insertObjects:moved atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(toIndex, moved.count)]];
+	
+	[self reorderToOrder:newOrder];
+}
+
+- (void)sortUsingComparator:(NSComparator NS_NOESCAPE)cmptr
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSArray<id> *newOrder = [[orderedSet array] sortedArrayWithOptions:NSSortStable usingComparator:cmptr];
+	
+	[self reorderToOrder:newOrder];
+}
+
+/**
+ * Replaces the order of the objects in a single pass.
+ * The newOrder must contain the same objects as the orderedSet.
+ */
+- (void)reorderToOrder:(NSArray<id> *)newOrder
+{
+	if ([newOrder isEqualToArray:[orderedSet array]]) {
+		return;
+	}
+	
+	[self _willReorderToOrder:newOrder];
+	
+	[orderedSet removeAllObjects];
+	[orderedSet addObjectsFromArray:newOrder];
+}
+
 - (void)removeObject:(id)obj
 {
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (obj == nil) return;
 	
 	NSUInteger idx = [orderedSet indexOfObject:obj];
 	if (idx != NSNotFound)
 	{
+		obj = orderedSet[idx]; // use the stored instance (allows for pointer comparisons)
+		
 		[self _willRemoveObject:obj atIndex:idx];
 		[orderedSet removeObjectAtIndex:idx];
 	}
@@ -326,6 +511,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if (idx < orderedSet.count)
 	{
@@ -341,6 +527,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	while (orderedSet.count > 0)
 	{
@@ -351,12 +538,127 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Set Algebra
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (void)unionOrderedSet:(NSOrderedSet<id> *)otherOrderedSet
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSMutableArray<id> *toAdd = [NSMutableArray arrayWithCapacity:otherOrderedSet.count];
+	for (id obj in otherOrderedSet)
+	{
+		if (![orderedSet containsObject:obj]) {
+			[toAdd addObject:obj];
+		}
+	}
+	
+	if (toAdd.count == 0) return;
+	
+	NSArray<id> *toAppend = internsObjects ? [[ZDCInternTable sharedTable] internKeys:toAdd] : toAdd;
+	
+	[self _willAppendObjects:toAppend];
+	[orderedSet addObjectsFromArray:toAppend];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)minusSet:(NSSet<id> *)otherSet
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	// Collect the stored instances (allows for pointer comparisons), in order.
+	
+	NSMutableArray<id> *toRemove = [NSMutableArray arrayWithCapacity:MIN(otherSet.count, orderedSet.count)];
+	for (id obj in orderedSet)
+	{
+		if ([otherSet containsObject:obj]) {
+			[toRemove addObject:obj];
+		}
+	}
+	
+	if (toRemove.count > 0)
+	{
+		[self _willRemoveObjects:toRemove];
+		[orderedSet removeObjectsInArray:toRemove];
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)intersectSet:(NSSet<id> *)otherSet
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSMutableArray<id> *toRemove = [NSMutableArray array];
+	for (id obj in orderedSet)
+	{
+		if (![otherSet containsObject:obj]) {
+			[toRemove addObject:obj];
+		}
+	}
+	
+	if (toRemove.count > 0)
+	{
+		[self _willRemoveObjects:toRemove];
+		[orderedSet removeObjectsInArray:toRemove];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Interning
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (void)setInternsObjects:(BOOL)flag
+{
+	if (internsObjects == flag) return;
+	
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	internsObjects = flag;
+	if (internsObjects)
+	{
+		// Intern the existing objects.
+		// This doesn't affect change tracking, since the interned objects are equal to the objects they replace.
+		
+		NSArray<id> *interned = [[ZDCInternTable sharedTable] internKeys:[orderedSet array]];
+		orderedSet = [[NSMutableOrderedSet alloc] initWithArray:interned];
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Change Tracking Internals
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 - (void)_willInsertObject:(id)obj atIndex:(NSUInteger const)idx
 {
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(obj != nil);
 	NSParameterAssert(idx <= orderedSet.count);
 	
@@ -380,6 +682,12 @@ static NSString *const kChangeset_deleted = @"deleted";
 
 - (void)_willRemoveObject:(id)obj atIndex:(NSUInteger const)idx
 {
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(obj != nil);
 	NSParameterAssert(idx < orderedSet.count);
 	
@@ -468,7 +776,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 				[originalOrder insertObject:key atIndex:prvIdx];
 			}
 	
-			originalIdx = [originalOrder indexOfObject:obj];
+			originalIdx = ZDCIndexOfKey(originalOrder, obj, internsObjects);
 		}
 		
 		originalIdx_addMoveOnly = originalIdx;
@@ -524,6 +832,12 @@ static NSString *const kChangeset_deleted = @"deleted";
               fromIndex:(NSUInteger const)oldIdx
                 toIndex:(NSUInteger const)newIdx
 {
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(obj != nil);
 	NSParameterAssert(oldIdx < orderedSet.count);
 	NSParameterAssert(newIdx <= orderedSet.count);
@@ -575,7 +889,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 			[originalOrder insertObject:key atIndex:prvIdx];
 		}
 		
-		originalIdx = [originalOrder indexOfObject:obj];
+		originalIdx = ZDCIndexOfKey(originalOrder, obj, internsObjects);
 		
 	#ifndef NS_BLOCK_ASSERTIONS
 		[self checkOriginalIndexes:originalIdx];
@@ -584,6 +898,255 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 }
 
+/**
+ * Batched equivalent of invoking `_willMoveObject:fromIndex:toIndex:` for a series of moves,
+ * which result in the given order. (The newOrder must contain the same objects as the orderedSet.)
+ *
+ * Rather than tracking each move, we recalculate the minimal set of moves from the original order.
+ */
+- (void)_willReorderToOrder:(NSArray<id> *)newOrder
+{
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
+	NSParameterAssert(newOrder.count == orderedSet.count);
+	
+	// REORDER: Step 1 of 2:
+	//
+	// Reconstruct the original order (ignoring deletes & adds).
+	// This is the order that originalIndexes refers to. Recall the order in which the undo operation operates:
+	//
+	//                       direction    <=       this      <=     in      <=       read
+	// [previous state] <= (undo deletes) <= (reverse moves) <= (undo adds) <= [current state]
+	
+	NSMutableArray<id> *originalOrder = [NSMutableArray arrayWithCapacity:orderedSet.count];
+	for (id obj in orderedSet)
+	{
+		if ((originalIndexes[obj] == nil) && (![added containsObject:obj]))
+		{
+			[originalOrder addObject:obj];
+		}
+	}
+	
+	NSArray<id> *sortedKeys = [originalIndexes keysSortedByValueUsingComparator:
+		^NSComparisonResult(NSNumber *num1, NSNumber *num2)
+	{
+		return [num1 compare:num2];
+	}];
+	
+	for (id key in sortedKeys)
+	{
+		[originalOrder insertObject:key atIndex:[originalIndexes[key] unsignedIntegerValue]];
+	}
+	
+	// REORDER: Step 2 of 2:
+	//
+	// Calculate the minimal set of moves between the original order & the new order (again ignoring adds).
+	// This replaces every previously tracked move.
+	
+	NSMutableArray<id> *newOriginalItems = [NSMutableArray arrayWithCapacity:originalOrder.count];
+	for (id obj in newOrder)
+	{
+		if (![added containsObject:obj]) {
+			[newOriginalItems addObject:obj];
+		}
+	}
+	
+	originalIndexes = [ZDCOrder movedIndexesFromOrder:originalOrder toOrder:newOriginalItems];
+	
+#ifndef NS_BLOCK_ASSERTIONS
+	[self checkOriginalIndexes];
+#endif
+}
+
+/**
+ * Batched equivalent of invoking `_willInsertObject:atIndex:` for each of the given objects,
+ * where the objects are being appended to the end of the orderedSet.
+ */
+- (void)_willAppendObjects:(NSArray<id> *)objs
+{
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCountBy:objs.count];
+	
+	if (added == nil) {
+		added = [[NSMutableSet alloc] init];
+	}
+	
+	[added addObjectsFromArray:objs];
+	[deletedIndexes removeObjectsForKeys:objs];
+}
+
+/**
+ * Batched equivalent of invoking `_willRemoveObject:atIndex:` for each of the given objects.
+ * The objects must all be members of the orderedSet.
+ *
+ * The per-object variant reconstructs the original order for every removal.
+ * Here we reconstruct it once, and derive every original index from that single pass.
+ */
+- (void)_willRemoveObjects:(NSArray<id> *)objs
+{
+	if ([self isChangeTrackingSuspended]) {
+		return;
+	}
+	
+	[self incrementMutationCountBy:objs.count];
+	
+	if (originalIndexes == nil) {
+		originalIndexes = [[NSMutableDictionary alloc] init];
+	}
+	if (deletedIndexes == nil) {
+		deletedIndexes = [[NSMutableDictionary alloc] init];
+	}
+	
+	// REMOVE (batch): Step 1 of 4
+	//
+	// If we're deleting an item that was also added within this changeset,
+	// then the two actions cancel each other out.
+	//
+	// Note: We don't update `added` until after we've reconstructed the original order (below).
+	// Those items are still in the orderedSet, and must not be mistaken for original items.
+	
+	NSMutableArray<id> *cancelled = [NSMutableArray array];
+	NSMutableSet<id> *tracked = [NSMutableSet setWithCapacity:objs.count];
+	
+	for (id obj in objs)
+	{
+		if ([added containsObject:obj]) {
+			[cancelled addObject:obj];
+		}
+		else {
+			[tracked addObject:obj];
+		}
+	}
+	
+	if (tracked.count == 0)
+	{
+		for (id obj in cancelled) {
+			[added removeObject:obj];
+		}
+		return;
+	}
+	
+	// REMOVE (batch): Step 2 of 4
+	//
+	// Reconstruct the original order (minus items deleted earlier within this changeset),
+	// and find the position of each item being deleted within it.
+	// See `_willRemoveObject:atIndex:` for a discussion of why this is the correct starting point.
+	
+	NSMutableArray<id> *originalOrder = [NSMutableArray arrayWithCapacity:orderedSet.count];
+	for (id obj in orderedSet)
+	{
+		if ((originalIndexes[obj] == nil) && (![added containsObject:obj]))
+		{
+			[originalOrder addObject:obj];
+		}
+	}
+	
+	for (id obj in cancelled) {
+		[added removeObject:obj];
+	}
+	
+	NSArray<id> *sortedKeys = [originalIndexes keysSortedByValueUsingComparator:
+		^NSComparisonResult(NSNumber *num1, NSNumber *num2)
+	{
+		return [num1 compare:num2];
+	}];
+	
+	for (id key in sortedKeys)
+	{
+		NSUInteger prvIdx = [originalIndexes[key] unsignedIntegerValue];
+		
+		[originalOrder insertObject:key atIndex:prvIdx];
+	}
+	
+	NSUInteger const removedCount = tracked.count;
+	NSUInteger *positions = malloc(sizeof(NSUInteger) * removedCount);
+	
+	NSMutableArray<id> *removed = [NSMutableArray arrayWithCapacity:removedCount];
+	NSUInteger p = 0;
+	
+	for (NSUInteger idx = 0; idx < originalOrder.count; idx++)
+	{
+		id obj = originalOrder[idx];
+		if ([tracked containsObject:obj])
+		{
+			positions[p++] = idx; // ascending
+			[removed addObject:obj];
+		}
+	}
+	
+	NSAssert(p == removedCount, @"Batch contains objects that aren't members of the orderedSet");
+	
+	// REMOVE (batch): Step 3 of 4
+	//
+	// Convert each position into an original index,
+	// by skipping over the items that were deleted earlier within this changeset.
+	//
+	// Both the positions & the previously deleted indexes are sorted,
+	// so this is a single sweep over each list.
+	
+	NSArray<NSNumber*> *priorDeleted = [[deletedIndexes allValues] sortedArrayUsingSelector:@selector(compare:)];
+	NSUInteger const priorDeletedCount = priorDeleted.count;
+	NSUInteger d = 0;
+	
+	for (NSUInteger i = 0; i < p; i++)
+	{
+		NSUInteger originalIdx = positions[i] + d;
+		while ((d < priorDeletedCount) && ([priorDeleted[d] unsignedIntegerValue] <= originalIdx))
+		{
+			// An item was deleted in front of us within this changeset. (front=lower_index)
+			originalIdx++;
+			d++;
+		}
+		
+	#ifndef NS_BLOCK_ASSERTIONS
+		[self checkDeletedIndexes:originalIdx];
+	#endif
+		deletedIndexes[removed[i]] = @(originalIdx);
+	}
+	
+	// REMOVE (batch): Step 4 of 4
+	//
+	// Remove deleted items from originalIndexes,
+	// and shift the remaining entries down by the number of deleted items in front of them.
+	
+	[originalIndexes removeObjectsForKeys:removed];
+	
+	for (id altKey in [originalIndexes allKeys])
+	{
+		NSUInteger const altIdx = [originalIndexes[altKey] unsignedIntegerValue];
+		
+		// Binary search: number of positions less than altIdx
+		NSUInteger lo = 0;
+		NSUInteger hi = p;
+		while (lo < hi)
+		{
+			NSUInteger const mid = lo + ((hi - lo) / 2);
+			if (positions[mid] < altIdx) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		
+		if (lo > 0) {
+			originalIndexes[altKey] = @(altIdx - lo);
+		}
+	}
+	
+	free(positions);
+	
+#ifndef NS_BLOCK_ASSERTIONS
+	[self checkOriginalIndexes];
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Sanity Checks
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -645,6 +1208,12 @@ static NSString *const kChangeset_deleted = @"deleted";
 	[orderedSet enumerateObjectsUsingBlock:block];
 }
 
+- (void)enumerateObjectsWithOptions:(NSEnumerationOptions)opts
+                         usingBlock:(void (^)(id obj, NSUInteger idx, BOOL *stop))block
+{
+	[orderedSet enumerateObjectsWithOptions:opts usingBlock:block];
+}
+
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
                                   objects:(id __unsafe_unretained _Nullable [_Nonnull])buffer
                                     count:(NSUInteger)len
@@ -691,13 +1260,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	[super makeImmutable];
 	
-	for (id obj in orderedSet)
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
-		{
-			[(ZDCObject *)obj makeImmutable];
-		}
-	}
+	[self enumerateChildObjectsIn:orderedSet withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child makeImmutable];
+	}];
 }
 
 - (BOOL)hasChanges
@@ -708,30 +1274,129 @@ static NSString *const kChangeset_deleted = @"deleted";
 	    originalIndexes.count > 0 ||
 	    deletedIndexes.count  > 0  ) return YES;
 	
-	for (id obj in orderedSet)
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
+	__block BOOL childHasChanges = NO;
+	[self enumerateChildObjectsIn:orderedSet withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		if ([child hasChanges])
 		{
-			if ([(ZDCObject *)obj hasChanges]) return YES;
+			__atomic_store_n(&childHasChanges, YES, __ATOMIC_RELAXED); // may be invoked concurrently
+			*stop = YES;
 		}
-	}
+	}];
 	
-	return NO;
+	return childHasChanges;
 }
 
 - (void)clearChangeTracking
 {
 	[super clearChangeTracking];
 	
-	[added removeAllObjects];
-	[originalIndexes removeAllObjects];
-	[deletedIndexes removeAllObjects];
+	if (storageIsShared)
+	{
+		// The tracking info is shared with a copy or checkpoint (and is created lazily).
+		added = nil;
+		originalIndexes = nil;
+		deletedIndexes = nil;
+	}
+	else
+	{
+		[added removeAllObjects];
+		[originalIndexes removeAllObjects];
+		[deletedIndexes removeAllObjects];
+	}
+	
+	[self enumerateChildObjectsIn:orderedSet withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child clearChangeTracking];
+	}];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (nullable id)_willPerformUntrackedChanges
+{
+	if (added.count == 0 && originalIndexes.count == 0 && deletedIndexes.count == 0) {
+		return nil; // nothing is being tracked
+	}
+	
+	NSArray<id> *currentOrder = [orderedSet array];
+	NSArray<id> *originalOrder =
+	  [[self class] _originalOrderFrom:currentOrder pendingChangesets:@[ [self _changeset] ]];
+	
+	if (originalOrder == nil) { // shouldn't happen; sanity check
+		return nil;
+	}
+	
+	return @[ originalOrder, currentOrder ];
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_didPerformUntrackedChanges:(nullable id)context
+{
+	if (context == nil) return;
+	
+	NSArray<id> *originalOrder = context[0];
+	NSArray<id> *previousOrder = context[1];
+	NSArray<id> *currentOrder = [orderedSet array];
 	
+	if ([previousOrder isEqualToArray:currentOrder]) {
+		return; // the block didn't modify the orderedSet
+	}
+	
+	// The untracked mutations shifted the indexes that originalIndexes & deletedIndexes refer to.
+	// So we apply the untracked changes to the original order, and recalculate the tracking info via diff.
+	
+	NSArray<id> *rebasedOrder = [ZDCOrder rebaseOrder: originalOrder
+	                                        fromOrder: previousOrder
+	                                          toOrder: currentOrder
+	                                   matchIdentical: NO];
+	
+	NSMutableSet<id> *rebasedAdded = nil;
+	NSMutableDictionary<id, NSNumber*> *rebasedIndexes = nil;
+	NSMutableDictionary<id, NSNumber*> *rebasedDeleted = nil;
+	[[self class] getAdded: &rebasedAdded
+	               indexes: &rebasedIndexes
+	               deleted: &rebasedDeleted
+	                  from: [NSOrderedSet orderedSetWithArray:rebasedOrder]
+	                    to: orderedSet];
+	
+	added = rebasedAdded;
+	originalIndexes = rebasedIndexes;
+	deletedIndexes = rebasedDeleted;
+}
+
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	stats.elementCount  = orderedSet.count;
+	stats.addedCount    = added.count;
+	stats.movedCount    = originalIndexes.count;
+	stats.deletedCount  = deletedIndexes.count;
+	stats.originalCount = deletedIndexes.count;
+	stats.trackingBytes =
+	  [self estimatedTrackingBytesForEntryCount:(added.count + originalIndexes.count + deletedIndexes.count)];
+	
+	return stats;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block
+{
+	BOOL stop = NO;
 	for (id obj in orderedSet)
 	{
 		if ([obj isKindOfClass:[ZDCObject class]])
 		{
-			[(ZDCObject *)obj clearChangeTracking];
+			block((ZDCObject *)obj, &stop);
+			if (stop) break;
 		}
 	}
 }
@@ -811,14 +1476,140 @@ static NSString *const kChangeset_deleted = @"deleted";
 	return changeset;
 }
 
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetFrom:(ZDCOrderedSet *)src to:(ZDCOrderedSet *)dst
+{
+	NSParameterAssert(src != nil);
+	NSParameterAssert(dst != nil);
+	
+	NSMutableSet<id> *added = nil;
+	NSMutableDictionary<id, NSNumber*> *changeset_indexes = nil;
+	NSMutableDictionary<id, NSNumber*> *changeset_deleted = nil;
+	[self getAdded: &added
+	       indexes: &changeset_indexes
+	       deleted: &changeset_deleted
+	          from: src->orderedSet
+	            to: dst->orderedSet];
+	
+	NSMutableDictionary<NSString*, id> *changeset = [NSMutableDictionary dictionaryWithCapacity:3];
+	
+	if (added.count > 0)
+	{
+		NSMutableSet *changeset_added = [NSMutableSet setWithCapacity:added.count];
+		
+		for (id obj in added)
+		{
+			if ([obj conformsToProtocol:@protocol(NSCopying)]) {
+				[changeset_added addObject:[obj copy]];
+			}
+			else {
+				[changeset_added addObject:obj];
+			}
+		}
+		
+		changeset[kChangeset_added] = [changeset_added copy];
+	}
+	if (changeset_indexes.count > 0) {
+		changeset[kChangeset_indexes] = [changeset_indexes copy];
+	}
+	if (changeset_deleted.count > 0) {
+		changeset[kChangeset_deleted] = [changeset_deleted copy];
+	}
+	
+	return (changeset.count > 0) ? changeset : nil;
+}
+
+/**
+ * Calculates the `added`, `indexes` & `deleted` components of a changeset, by diffing the two orders.
+ * The results use the exact same format as operation-by-operation tracking.
+ */
++ (void)getAdded:(NSMutableSet<id> **)outAdded
+         indexes:(NSMutableDictionary<id, NSNumber*> **)outIndexes
+         deleted:(NSMutableDictionary<id, NSNumber*> **)outDeleted
+            from:(NSOrderedSet<id> *)original
+              to:(NSOrderedSet<id> *)current
+{
+	// Step 1 of 3:
+	//
+	// Find the deleted items, and calculate the rank of each kept item amongst the other kept items.
+	// (This is what the `indexes` component of the changeset refers to.)
+	
+	NSMutableDictionary<id, NSNumber*> *changeset_deleted = [NSMutableDictionary dictionary];
+	NSMutableDictionary<id, NSNumber*> *keptRanks = [NSMutableDictionary dictionaryWithCapacity:original.count];
+	
+	NSUInteger keptCount = 0;
+	for (NSUInteger idx = 0; idx < original.count; idx++)
+	{
+		id obj = original[idx];
+		
+		if ([current containsObject:obj]) {
+			keptRanks[obj] = @(keptCount++);
+		}
+		else {
+			changeset_deleted[obj] = @(idx);
+		}
+	}
+	
+	// Step 2 of 3:
+	//
+	// Find the added items, and the previous ranks of the kept items (in current order).
+	
+	NSMutableSet *changeset_added = [NSMutableSet set];
+	
+	NSMutableArray<id> *keptItems = [NSMutableArray arrayWithCapacity:keptCount];
+	NSUInteger *ranks = (NSUInteger *)malloc(sizeof(NSUInteger) * MAX(keptCount, (NSUInteger)1));
+	
+	for (id obj in current)
+	{
+		NSNumber *rank = keptRanks[obj];
+		if (rank == nil)
+		{
+			[changeset_added addObject:obj];
+		}
+		else
+		{
+			ranks[keptItems.count] = rank.unsignedIntegerValue;
+			[keptItems addObject:obj];
+		}
+	}
+	
+	// Step 3 of 3:
+	//
+	// Items within the longest increasing subsequence (of previous ranks) don't need to be moved.
+	// Everything else is marked as moved, which keeps the set of moves minimal.
+	
+	NSIndexSet *stationary = [ZDCOrder indexesOfLongestIncreasingSubsequence:ranks count:keptItems.count];
+	free(ranks);
+	
+	NSMutableDictionary<id, NSNumber*> *changeset_indexes = [NSMutableDictionary dictionary];
+	
+	for (NSUInteger idx = 0; idx < keptItems.count; idx++)
+	{
+		if (![stationary containsIndex:idx])
+		{
+			id obj = keptItems[idx];
+			changeset_indexes[obj] = keptRanks[obj];
+		}
+	}
+	
+	if (outAdded) *outAdded = changeset_added;
+	if (outIndexes) *outIndexes = changeset_indexes;
+	if (outDeleted) *outDeleted = changeset_deleted;
+}
+
 /**
  * See ZDCSyncable.h for method description.
  */
 - (nullable NSDictionary *)changeset
 {
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSDictionary *changeset = [self _changeset];
 	[self clearChangeTracking];
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
 	return changeset;
 }
 
@@ -827,7 +1618,12 @@ static NSString *const kChangeset_deleted = @"deleted";
  */
 - (nullable NSDictionary *)peakChangeset
 {
-	return [self _changeset];
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self _changeset];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
 }
 
 - (BOOL)isMalformedChangeset:(NSDictionary *)changeset
@@ -907,6 +1703,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	// Important: `isMalformedChangeset:` must be called before invoking this method.
 	
+	ZDC_TRACE_SCOPE(trace, "ZDCOrderedSet", "_undo");
+	ZDC_TRACE_COUNTER("ZDCOrderedSet", "_undo: count", orderedSet.count);
+	
 	// This method is called from both `undo::` & `importChangesets::`.
 	//
 	// When called from `undo::`, there aren't any existing changes,
@@ -992,7 +1791,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 					originalIndexes[obj] = @(idx);
 				}
 				
-				[moved_objs addObject:obj];
+				[moved_objs addObject:orderedSet[idx]]; // use the stored instance (allows for pointer comparisons)
 				[moved_indexes addIndex:idx];
 			}
 		}
@@ -1025,7 +1824,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 			{
 				if (originalIndexes[moved_obj] == nil)
 				{
-					NSUInteger originalIdx = [originalOrder indexOfObject:moved_obj];
+					NSUInteger originalIdx = ZDCIndexOfKey(originalOrder, moved_obj, internsObjects);
 					if (originalIdx != NSNotFound)
 					{
 					#ifndef NS_BLOCK_ASSERTIONS
@@ -1121,6 +1920,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if ([self hasChanges])
 	{
@@ -1136,6 +1936,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		return [self malformedChangesetError];
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *error = [self _undo:changeset];
 	if (error)
 	{
@@ -1143,6 +1945,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		[self rollback];
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
 	return error;
 }
 
@@ -1187,6 +1990,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if ([self hasChanges])
 	{
@@ -1212,6 +2016,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		return nil;
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *result_error = nil;
 	NSMutableArray<NSDictionary*> *changesets_redo = [NSMutableArray arrayWithCapacity:orderedChangesets.count];
 	
@@ -1249,6 +2055,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 	return result_error;
 }
 
@@ -1376,9 +2183,13 @@ static NSString *const kChangeset_deleted = @"deleted";
                        withPendingChangesets:(nullable NSArray<NSDictionary *> *)pendingChangesets
                                        error:(NSError *__autoreleasing  _Nullable * _Nullable)errPtr
 {
+	ZDC_TRACE_SCOPE(trace, "ZDCOrderedSet", "mergeCloudVersion");
+	ZDC_TRACE_COUNTER("ZDCOrderedSet", "mergeCloudVersion: pendingChangesets", pendingChangesets.count);
+	
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	if ([self hasChanges])
 	{
@@ -1409,25 +2220,49 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 	ZDCOrderedSet *cloudVersion = (ZDCOrderedSet *)inCloudVersion;
 	
+	uint64_t const startTime = mach_absolute_time();
+	
+	ZDC_TRACE_SCOPE(step, "ZDCOrderedSet", "mergeCloudVersion: step 1 of 7");
+	
 	// Step 1 of 7:
 	//
 	// If there are pending changes, calculate the original order.
 	// This will be used later on during the merge process.
 	//
+	// The calculation is memoized, since merges are often repeated with the same pending changesets
+	// (or the same pending changesets plus the changeset returned from the previous merge).
+	//
 	// Important:
 	//   We need to do this in the beginning, because we need an unmodified `orderedSet`.
 	
 	NSArray<id> *originalOrder = nil;
 	if (pendingChangesets.count > 0)
 	{
-		originalOrder = [[self class] _originalOrderFrom:[orderedSet array] pendingChangesets:pendingChangesets];
+		if (originalOrderCache == nil) {
+			originalOrderCache = [[ZDCOriginalOrderCache alloc] init];
+		}
+		
+		Class cls = [self class];
+		originalOrder =
+		  [originalOrderCache originalOrderFrom: [orderedSet array]
+		                      pendingChangesets: pendingChangesets
+		                                 events: NULL
+		                                 replay:
+		    ^NSArray *(NSArray *order, NSArray<NSDictionary*> *changesets, NSMutableArray *events)
+		{
+			return [cls _originalOrderFrom:order pendingChangesets:changesets];
+		}];
+		
 		if (originalOrder == nil)
 		{
+			[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 			if (errPtr) *errPtr = [self mismatchedChangeset];
 			return nil;
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 2 of 7");
+	
 	// Step 2 of 7:
 	//
 	// Determine which objects have been added & deleted (locally, based on pendingChangesets)
@@ -1466,6 +2301,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 3 of 7");
+	
 	// Step 3 of 7:
 	//
 	// Add objects that were added by remote devices.
@@ -1486,6 +2323,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 4 of 7");
+	
 	// Step 4 of 7:
 	//
 	// Delete objects that were deleted by remote devices.
@@ -1517,6 +2356,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		[self removeObject:obj];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 5 of 7");
+	
 	// Step 5 of 7:
 	//
 	// Prepare to merge the order.
@@ -1528,39 +2369,36 @@ static NSString *const kChangeset_deleted = @"deleted";
 	//
 	// Our aim here is to derive 2 arrays, one from cloudVersion->order, and another from self->order.
 	// Both of these arrays will have the same count, and contain the same objs, but possibly in a different order.
+	//
+	// If we're interning objects, then we also unique the objects within both arrays.
+	// This allows us to compare objects by pointer within step 8.
+	
+	NSArray *order_localVersion = nil;
+	NSArray *order_cloudVersion = nil;
 	
-	NSMutableArray *order_localVersion = [[self->orderedSet array] mutableCopy];
-	NSMutableArray *order_cloudVersion = [[cloudVersion->orderedSet array] mutableCopy];
+	if (internsObjects)
+	{
+		ZDCInternTable *internTable = [ZDCInternTable sharedTable];
+		
+		order_localVersion = [internTable internKeys:[self->orderedSet array]];
+		order_cloudVersion = [internTable internKeys:[cloudVersion->orderedSet array]];
+	}
+	else
+	{
+		order_localVersion = [self->orderedSet array];
+		order_cloudVersion = [cloudVersion->orderedSet array];
+	}
 	
 	{
 		NSMutableSet *merged = [[self->orderedSet set] mutableCopy];
 		[merged intersectSet:[cloudVersion->orderedSet set]];
 		
-		NSUInteger i = 0;
-		while (i < order_localVersion.count)
-		{
-			id obj = order_localVersion[i];
-			if ([merged containsObject:obj]) {
-				i++;
-			}
-			else {
-				[order_localVersion removeObjectAtIndex:i];
-			}
-		}
-		
-		i = 0;
-		while (i < order_cloudVersion.count)
-		{
-			id obj = order_cloudVersion[i];
-			if ([merged containsObject:obj]) {
-				i++;
-			}
-			else {
-				[order_cloudVersion removeObjectAtIndex:i];
-			}
-		}
+		order_localVersion = [ZDCOrder filterOrder:order_localVersion keys:merged];
+		order_cloudVersion = [ZDCOrder filterOrder:order_cloudVersion keys:merged];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 6 of 7");
+	
 	// Step 6 of 7:
 	//
 	// So now we have a 2 lists of items that we can compare: local vs cloud.
@@ -1585,100 +2423,57 @@ static NSString *const kChangeset_deleted = @"deleted";
 		NSMutableSet *merged = [NSMutableSet setWithArray:originalOrder];
 		[merged intersectSet:[cloudVersion->orderedSet set]];
 		
-		NSMutableArray *order_originalVersion = [originalOrder mutableCopy];
-		NSMutableArray *order_cloudVersion = [[cloudVersion->orderedSet array] mutableCopy];
+		NSArray *order_originalVersion = [ZDCOrder filterOrder:originalOrder keys:merged];
+		NSArray *order_cloudVersion = [ZDCOrder filterOrder:[cloudVersion->orderedSet array] keys:merged];
 		
-		NSUInteger i = 0;
-		while (i < order_originalVersion.count)
+		if (internsObjects)
 		{
-			id obj = order_originalVersion[i];
-			if ([merged containsObject:obj]) {
-				i++;
-			}
-			else {
-				[order_originalVersion removeObjectAtIndex:i];
-			}
-		}
-		
-		i = 0;
-		while (i < order_cloudVersion.count)
-		{
-			id obj = order_cloudVersion[i];
-			if ([merged containsObject:obj]) {
-				i++;
-			}
-			else {
-				[order_cloudVersion removeObjectAtIndex:i];
-			}
+			// Allows the estimator to compare objects by pointer only
+			ZDCInternTable *internTable = [ZDCInternTable sharedTable];
+			
+			order_originalVersion = [internTable internKeys:order_originalVersion];
+			order_cloudVersion = [internTable internKeys:order_cloudVersion];
 		}
 		
 		NSArray *estimate =
 			[ZDCOrder estimateChangesetFrom: order_originalVersion
 			                            to: order_cloudVersion
-			                         hints: nil];
+			                         hints: nil
+			                      interned: internsObjects];
 		
 		[movedObjs_remote addObjectsFromArray:estimate];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 7 of 7");
+	
 	// Step 7 of 7:
 	//
 	// We have all the information we need to merge the order now.
-	
-	for (NSUInteger i = 0; i < order_cloudVersion.count; i++)
+	//
+	// Whenever remote wins, the obj needs to be moved into its proper position (within orderedSet).
+	// That is, immediately after the obj that precedes it within the merged order.
+	// (NSOrderedSet maintains its own hashed index, so these lookups don't scan the array.)
+	
+	[ZDCOrder reconcileLocalOrder: order_localVersion
+	                   cloudOrder: order_cloudVersion
+	                  movedRemote: movedObjs_remote
+	                identityFirst: internsObjects
+	                   usingBlock:^(id obj, id prvObj)
 	{
-		id obj_remote = order_cloudVersion[i];
-		id obj_local  = order_localVersion[i];
+		// Note:
+		//   We already added all the objects that were added by remote devices.
+		//   And we already deleted all the objects that were deleted by remote devices.
 		
-		if (![obj_remote isEqual:obj_local])
-		{
-			BOOL changed_remote = [movedObjs_remote containsObject:obj_remote];
-			
-			if (changed_remote)
-			{
-				// Remote wins.
-				
-				id obj = obj_remote;
-				
-				// Move key into proper position (within changed_local)
-				
-				NSRange searchRange = NSMakeRange(i+1, order_localVersion.count-i-1);
-				NSUInteger idx = [order_localVersion indexOfObject:obj inRange:searchRange];
-				
-				[order_localVersion removeObjectAtIndex:idx];
-				[order_localVersion insertObject:obj atIndex:i];
-				
-				// Move key into proper position (within orderedSet)
-				//
-				// Note:
-				//   We already added all the objects that were added by remote devices.
-				//   And we already deleted all the objects that were deleted by remote devices.
-				
-				NSUInteger oldIdx = [self indexOfObject:obj];
-				NSUInteger newIdx = 0;
-				if (i > 0)
-				{
-					id prvObj_local = order_localVersion[i-1];
-					newIdx = [self indexOfObject:prvObj_local] + 1;
-				}
-				
-				[self moveObjectAtIndex:oldIdx toIndex:newIdx];
-			}
-			else
-			{
-				// Local wins.
-				
-				id obj = obj_local;
-				
-				// Move remote into proper position (within changed_remote)
-				
-				NSRange searchRange = NSMakeRange(i+1, order_cloudVersion.count-i-1);
-				NSUInteger idx = [order_cloudVersion indexOfObject:obj inRange:searchRange];
-				
-				[order_cloudVersion removeObjectAtIndex:idx];
-				[order_cloudVersion insertObject:obj atIndex:i];
-			}
+		NSUInteger oldIdx = [self indexOfObject:obj];
+		NSUInteger newIdx = 0;
+		if (prvObj) {
+			newIdx = [self indexOfObject:prvObj] + 1;
 		}
-	}
+		
+		[self moveObjectAtIndex:oldIdx toIndex:newIdx];
+	}];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 	
 	if (errPtr) *errPtr = nil;
 	return ([self changeset] ?: @{});
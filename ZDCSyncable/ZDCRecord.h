@@ -21,6 +21,20 @@ NS_ASSUME_NONNULL_BEGIN
 NS_SWIFT_NAME(ZDCRecord_ObjC)
 @interface ZDCRecord : ZDCObject <ZDCSyncable>
 
+/**
+ * Calculates the changeset between two versions of a record,
+ * without replaying the individual operations that led from one to the other.
+ *
+ * The result is a standard (undo) changeset.
+ * That is, invoking `undo:error:` on a record equal to `dst` will produce a record equal to `src`.
+ *
+ * Both records must be of the same class.
+ * Only the monitored properties are compared, using `isEqual:`.
+ *
+ * @return The changeset, or nil if the records are equal.
+ */
++ (nullable NSDictionary<NSString*, id> *)changesetFrom:(ZDCRecord *)src to:(ZDCRecord *)dst;
+
 //
 // SUBCLASS ME !
 //
@@ -7,23 +7,243 @@
 #import "ZDCObjectSubclass.h"
 #import "ZDCNull.h"
 #import "ZDCRef.h"
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
+#import <objc/runtime.h>
+#import <pthread.h>
 
 // Changeset Keys
 //
 static NSString *const kChangeset_refs   = @"refs";
 static NSString *const kChangeset_values = @"values";
 
+/**
+ * Maps each monitored property of a ZDCRecord subclass to a fixed slot index.
+ * There's a single (immutable) table per class, which lives for the lifetime of the process.
+ */
+@interface ZDCRecordSlotTable : NSObject
+
+- (instancetype)initWithClass:(Class)cls properties:(NSSet<NSString*> *)properties;
+
+@property (nonatomic, readonly) NSArray<NSString*> *names;
+@property (nonatomic, readonly) NSDictionary<NSString*, NSNumber*> *slots;
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSUInteger wordCount; // number of uint64_t words in a dirty bitmask
+
+/**
+ * Returns the slot for the given key, or NSNotFound if the key doesn't have a slot (e.g. a dynamic property).
+ *
+ * Callers (such as the KVO setters) tend to pass the same NSString instance for a given key every time.
+ * So the table remembers the pointer of every key it resolves, and afterwards resolves it without hashing the string.
+ * This is thread-safe (the table is shared by every instance of the class).
+ */
+- (NSUInteger)slotForKey:(NSString *)key;
+
+/**
+ * Returns the ivar that backs the property in the given slot,
+ * or NULL if the property doesn't have one (e.g. a dynamic property).
+ */
+- (Ivar)ivarForSlot:(NSUInteger)slot;
+
+@end
+
+// The pointer cache is an open-addressing hash table, keyed by pointer.
+// Buckets are claimed via compare-and-swap (they're never removed or replaced),
+// so lookups don't need a lock.
+//
+static void *const kSlotCacheReserved = (void *)(uintptr_t)1; // bucket claimed, but not yet published
+static NSUInteger const kSlotCacheMinimumCapacity = 16;
+
+static inline NSUInteger ZDCSlotCacheHash(const void *ptr)
+{
+	uintptr_t h = (uintptr_t)ptr >> 4; // objects are 16-byte aligned
+	h ^= (h >> 17);
+	return (NSUInteger)h;
+}
+
+@implementation ZDCRecordSlotTable {
+@private
+	
+	void **cachedKeys;        // retained key pointers (or NULL / kSlotCacheReserved)
+	NSUInteger *cachedSlots;  // index-aligned with cachedKeys
+	NSUInteger cacheMask;     // capacity - 1 (the capacity is a power of 2)
+	
+	Ivar *ivars;              // index-aligned with names (NULL for properties without an ivar)
+}
+
+- (instancetype)initWithClass:(Class)cls properties:(NSSet<NSString*> *)properties
+{
+	if ((self = [super init]))
+	{
+		// Sorted, so slot assignments are deterministic
+		_names = [[properties allObjects] sortedArrayUsingSelector:@selector(compare:)];
+		
+		NSMutableDictionary<NSString*, NSNumber*> *slots = [NSMutableDictionary dictionaryWithCapacity:_names.count];
+		[_names enumerateObjectsUsingBlock:^(NSString *name, NSUInteger idx, BOOL *stop) {
+			slots[name] = @(idx);
+		}];
+		
+		_slots = [slots copy];
+		_count = _names.count;
+		_wordCount = MAX((NSUInteger)1, (_count + 63) / 64);
+		
+		ivars = (Ivar *)calloc(MAX((NSUInteger)1, _count), sizeof(Ivar));
+		for (NSUInteger slot = 0; slot < _count; slot++)
+		{
+			objc_property_t property = class_getProperty(cls, [_names[slot] UTF8String]);
+			char *ivarName = property ? property_copyAttributeValue(property, "V") : NULL;
+			
+			if (ivarName)
+			{
+				ivars[slot] = class_getInstanceVariable(cls, ivarName);
+				free(ivarName);
+			}
+		}
+		
+		// Room for a few different pointers per key (plus a handful of dynamic properties).
+		// Once the cache is full, lookups simply fall back to hashing.
+		
+		NSUInteger capacity = kSlotCacheMinimumCapacity;
+		while (capacity < (_count * 4)) {
+			capacity *= 2;
+		}
+		
+		cachedKeys = (void **)calloc(capacity, sizeof(void *));
+		cachedSlots = (NSUInteger *)calloc(capacity, sizeof(NSUInteger));
+		cacheMask = capacity - 1;
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	for (NSUInteger idx = 0; idx <= cacheMask; idx++)
+	{
+		void *cached = cachedKeys[idx];
+		if (cached != NULL && cached != kSlotCacheReserved) {
+			CFRelease((CFTypeRef)cached);
+		}
+	}
+	
+	free(cachedKeys);
+	free(cachedSlots);
+	free(ivars);
+}
+
+- (Ivar)ivarForSlot:(NSUInteger)slot
+{
+	return (slot < _count) ? ivars[slot] : NULL;
+}
+
+- (NSUInteger)slotForKey:(NSString *)key
+{
+	void *const ptr = (__bridge void *)key;
+	NSUInteger const startIdx = ZDCSlotCacheHash(ptr) & cacheMask;
+	
+	// Step 1 of 2:
+	//
+	// Check the pointer cache.
+	
+	NSUInteger idx = startIdx;
+	for (NSUInteger probe = 0; probe <= cacheMask; probe++)
+	{
+		void *cached = __atomic_load_n(&cachedKeys[idx], __ATOMIC_ACQUIRE);
+		if (cached == ptr) {
+			return cachedSlots[idx];
+		}
+		if (cached == NULL) {
+			break;
+		}
+		
+		idx = (idx + 1) & cacheMask;
+	}
+	
+	// Step 2 of 2:
+	//
+	// Cache miss - hash the string, and remember the pointer.
+	
+	NSNumber *slotNum = _slots[key];
+	NSUInteger const slot = slotNum ? slotNum.unsignedIntegerValue : NSNotFound;
+	
+	if ([key copy] != key) {
+		return slot; // mutable string (its contents could change), so don't cache the pointer
+	}
+	
+	idx = startIdx;
+	for (NSUInteger probe = 0; probe <= cacheMask; probe++)
+	{
+		void *expected = NULL;
+		if (__atomic_compare_exchange_n(&cachedKeys[idx], &expected, kSlotCacheReserved,
+		                                NO, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		{
+			// The bucket is ours. The slot must be stored before the key is published.
+			
+			cachedSlots[idx] = slot;
+			__atomic_store_n(&cachedKeys[idx], (void *)CFBridgingRetain(key), __ATOMIC_RELEASE);
+			break;
+		}
+		if (expected == ptr) {
+			break; // cached by another thread
+		}
+		
+		idx = (idx + 1) & cacheMask;
+	}
+	
+	return slot;
+}
+
+@end
+
+
+/**
+ * Copies the value of the given ivar from src to dst,
+ * honoring the ivar's memory management (strong, weak or unretained) for object types.
+ */
+static void ZDCCopyIvar(id dst, id src, Ivar ivar)
+{
+	const char *type = ivar_getTypeEncoding(ivar);
+	if (type == NULL) return;
+	
+	if (type[0] == _C_ID)
+	{
+		object_setIvarWithStrongDefault(dst, ivar, object_getIvar(src, ivar));
+	}
+	else
+	{
+		NSUInteger size = 0;
+		NSGetSizeAndAlignment(type, &size, NULL);
+		
+		ptrdiff_t const offset = ivar_getOffset(ivar);
+		memcpy((uint8_t *)(__bridge void *)dst + offset, (const uint8_t *)(__bridge void *)src + offset, size);
+	}
+}
 
 @implementation ZDCRecord {
 	
-	NSMutableDictionary *originalValues;
+	// Original values are stored by slot (the index of the property within the class's slot table).
+	// A set bit within dirtySlots means the corresponding slot holds an original value.
+	// Both arrays are allocated upon the first tracked change.
+	//
+	// Monitored keys without a slot (i.e. dynamic properties, see `isMonitoredProperty:`)
+	// are stored in overflowOriginals instead.
+	
+	__unsafe_unretained ZDCRecordSlotTable *slotTable;
+	__strong id *originalSlots;
+	uint64_t *dirtySlots;
+	NSMutableDictionary<NSString*, id> *overflowOriginals;
+}
+
+- (void)dealloc
+{
+	[self freeSlots];
 }
 
 - (nonnull id)copyWithZone:(nullable NSZone *)zone
 {
 	ZDCRecord *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
 	
-	copy->originalValues = [self->originalValues mutableCopy];
+	[self copyOriginalsTo:copy];
 	
 	return copy;
 }
@@ -39,13 +259,144 @@ static NSString *const kChangeset_values = @"values";
 		__unsafe_unretained ZDCRecord *copy = (ZDCRecord *)another;
 		if (!copy.isImmutable)
 		{
-			copy->originalValues = [self->originalValues mutableCopy];
+			[self copyOriginalsTo:copy];
 			
 			[super copyChangeTrackingTo:another];
 		}
 	}
 }
 
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCRecord *copy = (ZDCRecord *)another;
+	
+	// Restoring isn't a change. So the properties are assigned directly (via their ivars),
+	// which bypasses change tracking, KVO & change observers.
+	// Then the tracked originals are replaced with those of the copy.
+	
+	ZDCRecordSlotTable *table = [self slotTable];
+	NSUInteger const count = table.count;
+	
+	NSMutableArray<NSString*> *ivarlessProperties = nil;
+	
+	for (NSUInteger slot = 0; slot < count; slot++)
+	{
+		Ivar ivar = [table ivarForSlot:slot];
+		if (ivar)
+		{
+			ZDCCopyIvar(self, copy, ivar);
+		}
+		else
+		{
+			if (ivarlessProperties == nil) {
+				ivarlessProperties = [NSMutableArray array];
+			}
+			[ivarlessProperties addObject:table.names[slot]];
+		}
+	}
+	
+	if (ivarlessProperties)
+	{
+		// Properties without an ivar (e.g. dynamic properties) can only be set via KVC.
+		
+		[self performWithoutChangeTracking:^{
+			
+			for (NSString *propertyName in ivarlessProperties)
+			{
+				id value = [copy valueForKey:propertyName];
+				if ([self valueForKey:propertyName] != value)
+				{
+					[self setValue:value forKey:propertyName];
+				}
+			}
+		}];
+	}
+	
+	[copy copyOriginalsTo:self];
+	
+	[super restoreStateFromCopy:another];
+}
+
+/**
+ * Used by `publishSnapshot`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block
+{
+	// Replacing a child isn't a change. So the properties are assigned directly (via their ivars),
+	// which bypasses change tracking & KVO.
+	
+	ZDCRecordSlotTable *table = [self slotTable];
+	
+	NSMutableDictionary<NSString*, ZDCObject*> *ivarlessChildren = nil;
+	
+	for (NSString *propertyName in self.monitoredProperties)
+	{
+		id value = [self valueForKey:propertyName];
+		if (![value isKindOfClass:[ZDCObject class]]) continue;
+		
+		NSUInteger const slot = [table slotForKey:propertyName];
+		Ivar ivar = (slot == NSNotFound) ? NULL : [table ivarForSlot:slot];
+		
+		const char *type = ivar ? ivar_getTypeEncoding(ivar) : NULL;
+		if (type && type[0] == _C_ID && object_getIvar(self, ivar) == value)
+		{
+			object_setIvarWithStrongDefault(self, ivar, block((ZDCObject *)value));
+		}
+		else
+		{
+			if (ivarlessChildren == nil) {
+				ivarlessChildren = [NSMutableDictionary dictionary];
+			}
+			ivarlessChildren[propertyName] = block((ZDCObject *)value);
+		}
+	}
+	
+	if (ivarlessChildren)
+	{
+		// Properties without an ivar (e.g. dynamic properties) can only be set via KVC.
+		// An untracked change discards the original value, so we put it back afterwards.
+		
+		NSMutableDictionary<NSString*, id> *originals = [NSMutableDictionary dictionary];
+		for (NSString *propertyName in ivarlessChildren)
+		{
+			originals[propertyName] = [self originalValueForKey:propertyName];
+		}
+		
+		[self performWithoutChangeTracking:^{
+			
+			[ivarlessChildren enumerateKeysAndObjectsUsingBlock:^(NSString *propertyName, ZDCObject *child, BOOL *stop) {
+				[self setValue:child forKey:propertyName];
+			}];
+		}];
+		
+		[originals enumerateKeysAndObjectsUsingBlock:^(NSString *propertyName, id retainedValue, BOOL *stop) {
+			[self setOriginalValue:retainedValue forKey:propertyName];
+		}];
+	}
+	
+	__block NSMutableDictionary<NSString*, ZDCObject*> *originalChildren = nil;
+	
+	[self enumerateOriginalValuesWithBlock:^(NSString *key, id retainedValue) {
+		
+		if ([retainedValue isKindOfClass:[ZDCObject class]])
+		{
+			if (originalChildren == nil) {
+				originalChildren = [NSMutableDictionary dictionary];
+			}
+			originalChildren[key] = block((ZDCObject *)retainedValue);
+		}
+	}];
+	
+	[originalChildren enumerateKeysAndObjectsUsingBlock:^(NSString *key, ZDCObject *child, BOOL *stop) {
+		[self setOriginalValue:child forKey:key];
+	}];
+}
+
 - (void)enumeratePropertiesWithBlock:(void (^)(NSString *propertyName, id _Nullable obj, BOOL *stop))block
 {
 	for (NSString *propertyName in self.monitoredProperties)
@@ -59,6 +410,266 @@ static NSString *const kChangeset_values = @"values";
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Original Values
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (ZDCRecordSlotTable *)slotTable
+{
+	if (slotTable) return slotTable;
+	
+	// Instances of the same class may be created on multiple threads concurrently.
+	// So the table is created under a lock, which guarantees every instance uses the same table
+	// (and thus the same slot layout, which `copyOriginalsTo:` depends on).
+	
+	static pthread_mutex_t slotTableLock = PTHREAD_MUTEX_INITIALIZER;
+	
+	Class cls = [self class];
+	
+	pthread_mutex_lock(&slotTableLock);
+	
+	ZDCRecordSlotTable *table = objc_getAssociatedObject(cls, _cmd);
+	if (table == nil)
+	{
+		table = [[ZDCRecordSlotTable alloc] initWithClass:cls properties:self.monitoredProperties];
+		objc_setAssociatedObject(cls, _cmd, table, OBJC_ASSOCIATION_RETAIN);
+	}
+	
+	pthread_mutex_unlock(&slotTableLock);
+	
+	slotTable = table; // retained by the class
+	return slotTable;
+}
+
+- (void)allocateSlots
+{
+	ZDCRecordSlotTable *table = [self slotTable];
+	
+	originalSlots = (__strong id *)calloc(MAX((NSUInteger)1, table.count), sizeof(id));
+	dirtySlots = (uint64_t *)calloc(table.wordCount, sizeof(uint64_t));
+}
+
+- (void)freeSlots
+{
+	if (originalSlots)
+	{
+		NSUInteger const count = slotTable.count;
+		for (NSUInteger i = 0; i < count; i++) {
+			originalSlots[i] = nil; // release (ARC)
+		}
+		
+		free(originalSlots);
+		originalSlots = NULL;
+	}
+	
+	if (dirtySlots)
+	{
+		free(dirtySlots);
+		dirtySlots = NULL;
+	}
+}
+
+static inline BOOL ZDCSlotIsDirty(const uint64_t *dirtySlots, NSUInteger slot)
+{
+	return (dirtySlots[slot / 64] & (1ULL << (slot % 64))) != 0;
+}
+
+- (void)copyOriginalsTo:(ZDCRecord *)copy
+{
+	[copy freeSlots];
+	copy->overflowOriginals = nil;
+	
+	if ([copy slotTable] != [self slotTable])
+	{
+		// Different class, with a different slot layout (e.g. copyChangeTrackingTo: a subclass).
+		
+		[self enumerateOriginalValuesWithBlock:^(NSString *key, id retainedValue) {
+			[copy setOriginalValue:retainedValue forKey:key];
+		}];
+		return;
+	}
+	
+	copy->overflowOriginals = [self->overflowOriginals mutableCopy];
+	
+	if (originalSlots == NULL) return;
+	
+	[copy allocateSlots];
+	
+	NSUInteger const count = slotTable.count;
+	for (NSUInteger i = 0; i < count; i++) {
+		copy->originalSlots[i] = self->originalSlots[i];
+	}
+	
+	memcpy(copy->dirtySlots, self->dirtySlots, slotTable.wordCount * sizeof(uint64_t));
+}
+
+/**
+ * Returns YES if there are any original values.
+ * This is a simple bitmask test.
+ */
+- (BOOL)hasOriginalValues
+{
+	if (overflowOriginals.count > 0) return YES;
+	
+	if (dirtySlots)
+	{
+		NSUInteger const wordCount = slotTable.wordCount;
+		for (NSUInteger w = 0; w < wordCount; w++)
+		{
+			if (dirtySlots[w] != 0) return YES;
+		}
+	}
+	
+	return NO;
+}
+
+- (NSUInteger)originalValuesCount
+{
+	NSUInteger count = overflowOriginals.count;
+	
+	if (dirtySlots)
+	{
+		NSUInteger const wordCount = slotTable.wordCount;
+		for (NSUInteger w = 0; w < wordCount; w++)
+		{
+			count += (NSUInteger)__builtin_popcountll(dirtySlots[w]);
+		}
+	}
+	
+	return count;
+}
+
+/**
+ * Clears the dirty slots (keeping the storage around for reuse).
+ */
+- (void)removeAllOriginalValues
+{
+	if (dirtySlots)
+	{
+		NSUInteger const wordCount = slotTable.wordCount;
+		for (NSUInteger w = 0; w < wordCount; w++)
+		{
+			uint64_t bits = dirtySlots[w];
+			while (bits != 0)
+			{
+				NSUInteger const idx = (w * 64) + (NSUInteger)__builtin_ctzll(bits);
+				bits &= (bits - 1); // clear lowest set bit
+				
+				originalSlots[idx] = nil;
+			}
+			
+			dirtySlots[w] = 0;
+		}
+	}
+	
+	[overflowOriginals removeAllObjects];
+}
+
+/**
+ * Returns the stored original for the given key (possibly a ZDCRetainedValue), or nil if there isn't one.
+ */
+- (nullable id)originalValueForKey:(NSString *)key
+{
+	return [self originalValueForKey:key slot:[[self slotTable] slotForKey:key]];
+}
+
+/**
+ * Same as `originalValueForKey:`, for callers that have already resolved the slot (via `slotForKey:`).
+ */
+- (nullable id)originalValueForKey:(NSString *)key slot:(NSUInteger)slot
+{
+	if (slot == NSNotFound) {
+		return overflowOriginals[key];
+	}
+	
+	if (dirtySlots && ZDCSlotIsDirty(dirtySlots, slot)) {
+		return originalSlots[slot];
+	}
+	
+	return nil;
+}
+
+/**
+ * Stores the original for the given key, in its slot (if it has one) or in the overflow dictionary.
+ */
+- (void)setOriginalValue:(id)retainedValue forKey:(NSString *)key
+{
+	[self setOriginalValue:retainedValue forKey:key slot:[[self slotTable] slotForKey:key]];
+}
+
+/**
+ * Same as `setOriginalValue:forKey:`, for callers that have already resolved the slot (via `slotForKey:`).
+ */
+- (void)setOriginalValue:(id)retainedValue forKey:(NSString *)key slot:(NSUInteger)slot
+{
+	if (slot == NSNotFound)
+	{
+		// Dynamic property (not in the class's slot table)
+		
+		if (overflowOriginals == nil) {
+			overflowOriginals = [[NSMutableDictionary alloc] init];
+		}
+		
+		overflowOriginals[key] = retainedValue;
+		return;
+	}
+	
+	if (originalSlots == NULL) {
+		[self allocateSlots];
+	}
+	
+	originalSlots[slot] = retainedValue;
+	dirtySlots[slot / 64] |= (1ULL << (slot % 64));
+}
+
+/**
+ * Removes the stored original for the given key (if any).
+ */
+- (void)removeOriginalValueForKey:(NSString *)key
+{
+	NSUInteger const slot = [[self slotTable] slotForKey:key];
+	if (slot == NSNotFound)
+	{
+		overflowOriginals[key] = nil;
+		return;
+	}
+	
+	if (dirtySlots)
+	{
+		originalSlots[slot] = nil;
+		dirtySlots[slot / 64] &= ~(1ULL << (slot % 64));
+	}
+}
+
+/**
+ * Enumerates the stored originals (possibly ZDCRetainedValue instances).
+ * Only the dirty slots are visited.
+ */
+- (void)enumerateOriginalValuesWithBlock:(void (NS_NOESCAPE ^)(NSString *key, id retainedValue))block
+{
+	if (dirtySlots)
+	{
+		NSArray<NSString*> *names = slotTable.names;
+		NSUInteger const wordCount = slotTable.wordCount;
+		
+		for (NSUInteger w = 0; w < wordCount; w++)
+		{
+			uint64_t bits = dirtySlots[w];
+			while (bits != 0)
+			{
+				NSUInteger const idx = (w * 64) + (NSUInteger)__builtin_ctzll(bits);
+				bits &= (bits - 1); // clear lowest set bit
+				
+				block(names[idx], originalSlots[idx]);
+			}
+		}
+	}
+	
+	[overflowOriginals enumerateKeysAndObjectsUsingBlock:^(NSString *key, id retainedValue, BOOL *stop) {
+		block(key, retainedValue);
+	}];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark ZDCObject Overrides
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,7 +691,7 @@ static NSString *const kChangeset_values = @"values";
 {
 	if ([super hasChanges]) return YES;
 	
-	if (originalValues.count > 0) return YES;
+	if ([self hasOriginalValues]) return YES;
 	
 	__block BOOL hasChanges = NO;
 	[self enumeratePropertiesWithBlock:^(NSString *propertyName, id _Nullable obj, BOOL *stop) {
@@ -100,22 +711,28 @@ static NSString *const kChangeset_values = @"values";
 
 - (void)_willChangeValueForKey:(NSString *)key
 {
-	if (originalValues == nil) {
-		originalValues = [[NSMutableDictionary alloc] init];
-	}
+	// The slot is resolved once, and used for both the lookup & the store.
+	NSUInteger const slot = [[self slotTable] slotForKey:key];
 	
-	if (originalValues[key] == nil)
+	if ([self originalValueForKey:key slot:slot] == nil)
 	{
 		id originalValue = [self valueForKey:key];
 		if (originalValue) {
-			originalValues[key] = originalValue;
+			[self setOriginalValue:[self retainedOriginal:[self frozenOriginal:originalValue]] forKey:key slot:slot];
 		}
 		else {
-			originalValues[key] = [ZDCNull null];
+			[self setOriginalValue:[ZDCNull null] forKey:key slot:slot];
 		}
 	}
 }
 
+- (void)_willChangeUntrackedValueForKey:(NSString *)key
+{
+	// The value set within `performWithoutChangeTracking:` becomes the original value.
+	
+	[self removeOriginalValueForKey:key];
+}
+
 - (void)clearChangeTracking
 {
 	[super clearChangeTracking];
@@ -128,11 +745,14 @@ static NSString *const kChangeset_values = @"values";
 	//
 	// If the object has been made immutable, then changedProperties shouldn't be needed anymore.
 	//
-	if (self.isImmutable) {
-		originalValues = nil;
+	if (self.isImmutable)
+	{
+		[self freeSlots];
+		overflowOriginals = nil;
 	}
-	else {
-		[originalValues removeAllObjects];
+	else
+	{
+		[self removeAllOriginalValues];
 	}
 	
 	[self enumeratePropertiesWithBlock:^(NSString *propertyName, id _Nullable obj, BOOL *stop) {
@@ -144,6 +764,68 @@ static NSString *const kChangeset_values = @"values";
 	}];
 }
 
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	stats.elementCount = self.monitoredProperties.count;
+	
+	__block NSUInteger addedCount = 0;
+	__block NSUInteger originalCount = 0;
+	__block NSUInteger deletedCount = 0;
+	
+	[self enumerateOriginalValuesWithBlock:^(NSString *key, id originalValue) {
+		
+		BOOL const exists = ([self valueForKey:key] != nil);
+		
+		if (originalValue == [ZDCNull null])
+		{
+			if (exists) {
+				addedCount++;
+			}
+		}
+		else
+		{
+			originalCount++;
+			if (!exists) {
+				deletedCount++;
+			}
+		}
+	}];
+	
+	stats.addedCount = addedCount;
+	stats.originalCount = originalCount;
+	stats.deletedCount = deletedCount;
+	
+	// The slot arrays are a fixed cost (per instance), so they're only counted while there are changes.
+	
+	if ([self hasOriginalValues])
+	{
+		stats.trackingBytes = [self estimatedTrackingBytesForEntryCount:overflowOriginals.count];
+		if (originalSlots) {
+			stats.trackingBytes += (slotTable.count * sizeof(id)) + (slotTable.wordCount * sizeof(uint64_t));
+		}
+	}
+	
+	return stats;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block
+{
+	[self enumeratePropertiesWithBlock:^(NSString *propertyName, id _Nullable obj, BOOL *stop) {
+		
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			block((ZDCObject *)obj, stop);
+		}
+	}];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark ZDCSyncable
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -177,7 +859,7 @@ static NSString *const kChangeset_values = @"values";
 		
 		if ([obj conformsToProtocol:@protocol(ZDCSyncable)])
 		{
-			id originalValue = self->originalValues[key];
+			id originalValue = [self originalValueForKey:key];
 			
 			// Several possibilities:
 			//
@@ -211,7 +893,7 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}];
 	
-	if (originalValues.count > 0)
+	if ([self hasOriginalValues])
 	{
 		// changeset: {
 		//   values: {
@@ -219,19 +901,20 @@ static NSString *const kChangeset_values = @"values";
 		//   },
 		//   ...
 		// }
+		//
+		// This is the only place the originals are materialized into a dictionary.
 		
-		NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:originalValues.count];
+		NSMutableDictionary *values = [NSMutableDictionary dictionaryWithCapacity:[self originalValuesCount]];
 		
-		[originalValues enumerateKeysAndObjectsUsingBlock:^(id key, id originalValue, BOOL *stop) {
+		[self enumerateOriginalValuesWithBlock:^(NSString *key, id retainedValue) {
+			
+			id originalValue = [self resolvedOriginal:retainedValue];
 			
 			if (refs[key]) {
 				values[key] = [ZDCRef ref];
 			}
-			else if ([originalValue conformsToProtocol:@protocol(NSCopying)]) {
-				values[key] = [originalValue copy];
-			}
 			else {
-				values[key] = originalValue;
+				values[key] = [self changesetValueForOriginal:originalValue]; // frozen when captured
 			}
 		}];
 		
@@ -241,14 +924,62 @@ static NSString *const kChangeset_values = @"values";
 	return changeset;
 }
 
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetFrom:(ZDCRecord *)src to:(ZDCRecord *)dst
+{
+	NSParameterAssert(src != nil);
+	NSParameterAssert(dst != nil);
+	NSParameterAssert([src class] == [dst class]);
+	
+	// changeset: {
+	//   values: {
+	//     key: oldValue, ...
+	//   }
+	// }
+	
+	NSMutableDictionary *values = [NSMutableDictionary dictionary];
+	
+	[src enumeratePropertiesWithBlock:^(NSString *key, id _Nullable srcValue, BOOL *stop) {
+		
+		id dstValue = [dst valueForKey:key];
+		
+		if (srcValue == dstValue) return; // continue;
+		if (srcValue && dstValue && [srcValue isEqual:dstValue]) return; // continue;
+		
+		if (srcValue == nil) {
+			values[key] = [ZDCNull null]; // added
+		}
+		else {
+			values[key] = [src changesetValueForOriginal:[src frozenOriginal:srcValue]];
+		}
+	}];
+	
+	if (values.count == 0) return nil;
+	
+	return @{ kChangeset_values: values };
+}
+
 /**
  * See ZDCSyncable.h for method description.
  */
 - (nullable NSDictionary *)changeset
 {
-	NSDictionary *changeset = [self _changeset];
-	[self clearChangeTracking];
+	uint64_t const startTime = mach_absolute_time();
 	
+	NSError *error = nil;
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:&error];
+	
+	if (error == nil) {
+		[self clearChangeTracking]; // on failure, keep the changes (see changesetWithError:)
+	}
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
 	return changeset;
 }
 
@@ -257,7 +988,16 @@ static NSString *const kChangeset_values = @"values";
  */
 - (nullable NSDictionary *)peakChangeset
 {
-	return [self _changeset];
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self resolveChangeset:^NSDictionary *{
+		
+		return [self _changeset];
+		
+	} error:NULL];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
 }
 
 - (BOOL)isMalformedChangeset:(NSDictionary *)changeset
@@ -318,6 +1058,8 @@ static NSString *const kChangeset_values = @"values";
 {
 	// Important: `isMalformedChangeset:` must be called before invoking this method.
 	
+	ZDC_TRACE_SCOPE(trace, "ZDCRecord", "_undo");
+	
 	NSDictionary *changeset_refs = changeset[kChangeset_refs];
 	if (changeset_refs.count > 0)
 	{
@@ -375,9 +1117,13 @@ static NSString *const kChangeset_values = @"values";
 	else
 	{
 		// Undo successful - generate redo changeset
-		NSDictionary *reverseChangeset = [self changeset];
+		NSDictionary *reverseChangeset = [self changesetWithError:&error];
+		
+		if (errPtr) *errPtr = error;
+		if (error) {
+			return nil;
+		}
 		
-		if (errPtr) *errPtr = nil;
 		return (reverseChangeset ?: @{}); // don't return nil without error
 	}
 }
@@ -405,6 +1151,8 @@ static NSString *const kChangeset_values = @"values";
 		return [self malformedChangesetError];
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *error = [self _undo:changeset];
 	if (error)
 	{
@@ -412,6 +1160,7 @@ static NSString *const kChangeset_values = @"values";
 		[self rollback];
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
 	return error;
 }
 
@@ -441,9 +1190,13 @@ static NSString *const kChangeset_values = @"values";
 	}
 	else
 	{
-		NSDictionary *mergedChangeset = [self changeset];
+		NSDictionary *mergedChangeset = [self changesetWithError:&error];
+		
+		if (errPtr) *errPtr = error;
+		if (error) {
+			return nil;
+		}
 		
-		if (errPtr) *errPtr = nil;
 		return (mergedChangeset ?: @{}); // don't return nil without error
 	}
 }
@@ -481,6 +1234,8 @@ static NSString *const kChangeset_values = @"values";
 		return nil;
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *result_error = nil;
 	NSMutableArray<NSDictionary*> *changesets_redo = [NSMutableArray arrayWithCapacity:orderedChangesets.count];
 	
@@ -497,7 +1252,14 @@ static NSString *const kChangeset_values = @"values";
 		}
 		else
 		{
-			NSDictionary *redo = [self changeset];
+			NSDictionary *redo = [self changesetWithError:&result_error];
+			if (result_error)
+			{
+				// Unable to generate the redo changeset (an original couldn't be resolved).
+				// So this `_undo:` can't be reverted - we're in a bad state.
+				break;
+			}
+			
 			if (redo) {
 				[changesets_redo addObject:redo];
 			}
@@ -517,6 +1279,7 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 	return result_error;
 }
 
@@ -527,6 +1290,9 @@ static NSString *const kChangeset_values = @"values";
                        withPendingChangesets:(NSArray<NSDictionary *> *)pendingChangesets
                                        error:(NSError **)errPtr
 {
+	ZDC_TRACE_SCOPE(trace, "ZDCRecord", "mergeCloudVersion");
+	ZDC_TRACE_COUNTER("ZDCRecord", "mergeCloudVersion: pendingChangesets", pendingChangesets.count);
+	
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
@@ -560,6 +1326,10 @@ static NSString *const kChangeset_values = @"values";
 	}
 	ZDCRecord *cloudVersion = (ZDCRecord *)inCloudVersion;
 	
+	uint64_t const startTime = mach_absolute_time();
+	
+	ZDC_TRACE_SCOPE(step, "ZDCRecord", "mergeCloudVersion: step 1 of 4");
+	
 	// Step 1 of 4:
 	//
 	// We need to determine which keys have been changed locally, and what the original versions were.
@@ -581,6 +1351,8 @@ static NSString *const kChangeset_values = @"values";
 		}];
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 2 of 4");
+	
 	// Step 2 of 4:
 	//
 	// Next, we're going to enumerate what values are in the cloud.
@@ -653,6 +1425,8 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}];
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 3 of 4");
+	
 	// Step 3 of 4:
 	//
 	// Next we need to determine if any values were deleted by remote devices.
@@ -679,6 +1453,8 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 4 of 4");
+	
 	// Step 4 of 4:
 	//
 	// Merge the ZDCSyncable properties
@@ -732,12 +1508,19 @@ static NSString *const kChangeset_values = @"values";
 		}
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	
+	NSDictionary *changeset = nil;
+	if (err == nil) {
+		changeset = [self changesetWithError:&err];
+	}
+	
 	if (errPtr) *errPtr = err;
 	if (err) {
 		return nil;
 	}
 	else {
-		return ([self changeset] ?: @{});
+		return (changeset ?: @{});
 	}
 }
 
@@ -0,0 +1,146 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Change tracking needs to hold onto "original" values.
+ * That is, items that have been deleted, and values that have been replaced.
+ * These are needed in order to generate changesets (and thus to support undo & merge).
+ *
+ * By default, these originals are retained in memory until change tracking is cleared.
+ * Which is usually fine, unless the originals are large (e.g. image data),
+ * and a large number of them are deleted/replaced between syncs.
+ *
+ * A retention policy allows you to change this behavior.
+ * When change tracking captures an original value, it asks the policy how it should be retained.
+ * The policy may return the value itself (i.e. retain in memory), or a ZDCRetainedValue,
+ * which change tracking stores in its place, and resolves on demand.
+ *
+ * Changesets always contain the resolved values.
+ * So code that consumes changesets (undo, merge, serialization) doesn't need to know about the policy.
+ * If a value can't be resolved, the changeset isn't generated (rather than silently omitting the value),
+ * and the change tracking info is kept. See `-[ZDCObject changesetWithError:]`.
+ *
+ * @note Originals that are themselves ZDCObject instances (e.g. nested syncable collections)
+ *       are always retained in memory, since change tracking relies on their identity.
+ */
+NS_SWIFT_NAME(ZDCRetentionPolicy_ObjC)
+@protocol ZDCRetentionPolicy <NSObject>
+@required
+
+/**
+ * Invoked when change tracking captures an original value.
+ *
+ * @return
+ *   Either the value itself (to retain it in memory),
+ *   or an instance of ZDCRetainedValue, which will be resolved on demand.
+ */
+- (id)retainOriginalValue:(id)value;
+
+@end
+
+/**
+ * Abstract base class for the values returned by a retention policy.
+ */
+NS_SWIFT_NAME(ZDCRetainedValue_ObjC)
+@interface ZDCRetainedValue : NSObject
+
+/**
+ * Returns the original value.
+ * Subclasses must override this method.
+ *
+ * @return The original value, or nil if it can no longer be resolved.
+ */
+- (nullable id)resolvedValue;
+
+@end
+
+/**
+ * Keeps originals in memory up to a byte budget.
+ *
+ * Once the budget is exceeded, the oldest originals are spilled to files within the given directory,
+ * and are read back (on demand) when resolved.
+ * A spilled file is deleted once its original is no longer referenced by any change tracking info.
+ *
+ * Only values that support NSCoding can be spilled. Other values always remain in memory,
+ * and aren't counted against the budget (or included in `memoryUsage`).
+ *
+ * If a spilled value can't be read back (e.g. its file was deleted), changesets can't be generated.
+ * See `-[ZDCObject changesetWithError:]`.
+ *
+ * A single policy may be shared amongst many objects, and may be used from multiple threads.
+ */
+NS_SWIFT_NAME(ZDCSpillingRetentionPolicy_ObjC)
+@interface ZDCSpillingRetentionPolicy : NSObject <ZDCRetentionPolicy>
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Creates a policy that keeps up to `byteBudget` bytes of originals in memory,
+ * and spills the remainder into the given directory.
+ *
+ * @param byteBudget
+ *   The (estimated) number of bytes that may be retained in memory.
+ *
+ * @param directoryURL
+ *   A local directory in which spilled values are stored.
+ *   The directory is created if needed.
+ */
+- (instancetype)initWithByteBudget:(NSUInteger)byteBudget directory:(NSURL *)directoryURL;
+
+/** The value passed to the init method. */
+@property (nonatomic, readonly) NSUInteger byteBudget;
+
+/** The value passed to the init method. */
+@property (nonatomic, readonly) NSURL *directoryURL;
+
+/**
+ * Allows you to customize how the size of a value is estimated.
+ *
+ * If nil (the default), NSData & NSString report their byte length,
+ * and all other values report their instance size.
+ */
+@property (atomic, copy, readwrite, nullable) NSUInteger (^sizeEstimator)(id value);
+
+/**
+ * The (estimated) number of bytes currently retained in memory by this policy.
+ */
+@property (atomic, readonly) NSUInteger memoryUsage;
+
+@end
+
+/**
+ * Replaces originals with a token provided by the caller.
+ *
+ * This is useful when the originals are already persisted elsewhere (e.g. in a local database),
+ * and can be fetched again via some identifier.
+ */
+NS_SWIFT_NAME(ZDCResolverRetentionPolicy_ObjC)
+@interface ZDCResolverRetentionPolicy : NSObject <ZDCRetentionPolicy>
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Creates a policy with the given blocks.
+ *
+ * @param tokenizer
+ *   Invoked when change tracking captures an original value.
+ *   Return a token that can later be used to fetch the value,
+ *   or nil to retain the value in memory.
+ *
+ * @param resolver
+ *   Invoked when an original value is needed (e.g. while generating a changeset).
+ *   Return the value that corresponds to the given token, or nil if it's no longer available
+ *   (which fails the changeset).
+ */
+- (instancetype)initWithTokenizer:(id _Nullable (^)(id value))tokenizer
+                         resolver:(id _Nullable (^)(id token))resolver;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,343 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCRetentionPolicy.h"
+
+#import <objc/runtime.h>
+#import <pthread.h>
+
+@interface ZDCSpillingRetentionPolicy ()
+- (void)releaseMemoryUsage:(NSUInteger)byteCount;
+@end
+
+
+@implementation ZDCRetainedValue
+
+- (nullable id)resolvedValue
+{
+	NSAssert(NO, @"Subclasses must override this method: %@", NSStringFromSelector(_cmd));
+	return nil;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Holds a value on behalf of ZDCSpillingRetentionPolicy.
+ * The value is either held in memory, or has been spilled to a file.
+ */
+@interface ZDCSpillableValue : ZDCRetainedValue {
+@public
+
+	id value;         // nil once spilled
+	NSURL *fileURL;   // non-nil once spilled
+	
+	NSUInteger byteCount;
+	__weak ZDCSpillingRetentionPolicy *policy;
+}
+@end
+
+@implementation ZDCSpillableValue
+
+- (nullable id)resolvedValue
+{
+	NSURL *url = nil;
+	@synchronized (self)
+	{
+		if (value) return value;
+		url = fileURL;
+	}
+	
+	NSData *data = url ? [NSData dataWithContentsOfURL:url] : nil;
+	if (data == nil) return nil;
+	
+	id result = nil;
+	@try
+	{
+		if (@available(macOS 10.13, iOS 11, tvOS 11, *))
+		{
+			NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingFromData:data error:NULL];
+			unarchiver.requiresSecureCoding = NO;
+			
+			result = [unarchiver decodeObjectForKey:NSKeyedArchiveRootObjectKey];
+			[unarchiver finishDecoding];
+		}
+		else
+		{
+		#pragma clang diagnostic push
+		#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+			result = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+		#pragma clang diagnostic pop
+		}
+	}
+	@catch (NSException *exception) {}
+	
+	return result;
+}
+
+/**
+ * Moves the value from memory to a file within the given directory.
+ * If this fails for any reason, the value remains in memory.
+ */
+- (BOOL)spillToDirectory:(NSURL *)directoryURL
+{
+	id obj = nil;
+	@synchronized (self)
+	{
+		obj = value;
+	}
+	if (obj == nil) return NO;
+	
+	NSData *data = nil;
+	@try
+	{
+		if (@available(macOS 10.13, iOS 11, tvOS 11, *)) {
+			data = [NSKeyedArchiver archivedDataWithRootObject:obj requiringSecureCoding:NO error:NULL];
+		}
+		else
+		{
+		#pragma clang diagnostic push
+		#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+			data = [NSKeyedArchiver archivedDataWithRootObject:obj];
+		#pragma clang diagnostic pop
+		}
+	}
+	@catch (NSException *exception) {}
+	
+	if (data == nil) return NO;
+	
+	NSURL *url = [directoryURL URLByAppendingPathComponent:[[NSUUID UUID] UUIDString] isDirectory:NO];
+	if (![data writeToURL:url options:0 error:NULL]) {
+		return NO;
+	}
+	
+	@synchronized (self)
+	{
+		fileURL = url;
+		value = nil;
+	}
+	return YES;
+}
+
+- (void)dealloc
+{
+	if (fileURL)
+	{
+		[[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+	}
+	else
+	{
+		[policy releaseMemoryUsage:byteCount];
+	}
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCSpillingRetentionPolicy {
+	
+	pthread_mutex_t lock;
+	
+	NSUInteger memoryUsage;
+	NSPointerArray *spillQueue; // weak refs to ZDCSpillableValue's, oldest first
+}
+
+@synthesize byteBudget = byteBudget;
+@synthesize directoryURL = directoryURL;
+@synthesize sizeEstimator = sizeEstimator;
+
+- (instancetype)initWithByteBudget:(NSUInteger)inByteBudget directory:(NSURL *)inDirectoryURL
+{
+	NSParameterAssert(inDirectoryURL != nil);
+	
+	if ((self = [super init]))
+	{
+		byteBudget = inByteBudget;
+		directoryURL = [inDirectoryURL copy];
+		
+		pthread_mutex_init(&lock, NULL);
+		spillQueue = [NSPointerArray weakObjectsPointerArray];
+		
+		[[NSFileManager defaultManager] createDirectoryAtURL: directoryURL
+		                         withIntermediateDirectories: YES
+		                                          attributes: nil
+		                                               error: NULL];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	pthread_mutex_destroy(&lock);
+}
+
+- (NSUInteger)memoryUsage
+{
+	pthread_mutex_lock(&lock);
+	NSUInteger result = memoryUsage;
+	pthread_mutex_unlock(&lock);
+	
+	return result;
+}
+
+- (NSUInteger)sizeOfValue:(id)value
+{
+	NSUInteger (^estimator)(id) = self.sizeEstimator;
+	if (estimator) {
+		return estimator(value);
+	}
+	
+	if ([value isKindOfClass:[NSData class]]) {
+		return [(NSData *)value length];
+	}
+	if ([value isKindOfClass:[NSString class]]) {
+		return [(NSString *)value lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	}
+	
+	return class_getInstanceSize(object_getClass(value));
+}
+
+/**
+ * See ZDCRetentionPolicy.h for method description.
+ */
+- (id)retainOriginalValue:(id)value
+{
+	// Values that can't be spilled always remain in memory.
+	// So there's no point in wrapping them, or counting them against the budget
+	// (which would only cause other values to be spilled prematurely).
+	
+	if (![value conformsToProtocol:@protocol(NSCoding)]) {
+		return value;
+	}
+	
+	ZDCSpillableValue *retained = [[ZDCSpillableValue alloc] init];
+	retained->value = value;
+	retained->byteCount = [self sizeOfValue:value];
+	retained->policy = self;
+	
+	NSMutableArray<ZDCSpillableValue *> *spillMe = nil;
+	
+	pthread_mutex_lock(&lock);
+	{
+		memoryUsage += retained->byteCount;
+		[spillQueue addPointer:(__bridge void *)retained];
+		
+		// Evict the oldest values until we're back under budget.
+		// Entries that have been deallocated show up as NULL, and are simply skipped.
+		
+		NSUInteger idx = 0;
+		while ((memoryUsage > byteBudget) && (idx < spillQueue.count))
+		{
+			ZDCSpillableValue *candidate = (__bridge ZDCSpillableValue *)[spillQueue pointerAtIndex:idx];
+			if (candidate)
+			{
+				if (spillMe == nil) {
+					spillMe = [NSMutableArray array];
+				}
+				[spillMe addObject:candidate];
+				
+				memoryUsage -= MIN(memoryUsage, candidate->byteCount);
+			}
+			idx++;
+		}
+		
+		for (NSUInteger i = 0; i < idx; i++) {
+			[spillQueue removePointerAtIndex:0];
+		}
+	}
+	pthread_mutex_unlock(&lock);
+	
+	for (ZDCSpillableValue *candidate in spillMe)
+	{
+		if (![candidate spillToDirectory:directoryURL])
+		{
+			// Unable to spill (e.g. encoding failed), so it stays in memory.
+			
+			pthread_mutex_lock(&lock);
+			memoryUsage += candidate->byteCount;
+			pthread_mutex_unlock(&lock);
+		}
+	}
+	
+	return retained;
+}
+
+- (void)releaseMemoryUsage:(NSUInteger)byteCount
+{
+	pthread_mutex_lock(&lock);
+	memoryUsage -= MIN(memoryUsage, byteCount);
+	pthread_mutex_unlock(&lock);
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Holds a token on behalf of ZDCResolverRetentionPolicy.
+ */
+@interface ZDCResolvableValue : ZDCRetainedValue {
+@public
+
+	id token;
+	id _Nullable (^resolver)(id token);
+}
+@end
+
+@implementation ZDCResolvableValue
+
+- (nullable id)resolvedValue
+{
+	return resolver(token);
+}
+
+@end
+
+@implementation ZDCResolverRetentionPolicy {
+	
+	id _Nullable (^tokenizer)(id value);
+	id _Nullable (^resolver)(id token);
+}
+
+- (instancetype)initWithTokenizer:(id _Nullable (^)(id value))inTokenizer
+                         resolver:(id _Nullable (^)(id token))inResolver
+{
+	NSParameterAssert(inTokenizer != nil);
+	NSParameterAssert(inResolver != nil);
+	
+	if ((self = [super init]))
+	{
+		tokenizer = [inTokenizer copy];
+		resolver = [inResolver copy];
+	}
+	return self;
+}
+
+/**
+ * See ZDCRetentionPolicy.h for method description.
+ */
+- (id)retainOriginalValue:(id)value
+{
+	id token = tokenizer(value);
+	if (token == nil) {
+		return value;
+	}
+	
+	ZDCResolvableValue *retained = [[ZDCResolvableValue alloc] init];
+	retained->token = token;
+	retained->resolver = resolver;
+	
+	return retained;
+}
+
+@end
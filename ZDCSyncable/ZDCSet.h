@@ -45,6 +45,13 @@ NS_SWIFT_NAME(ZDCSet_ObjC)
  */
 - (instancetype)initWithArray:(nullable NSArray<ObjectType> *)array copyItems:(BOOL)copyItems;
 
+/**
+ * Same as `initWithArray:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithArray:(nullable NSArray<ObjectType> *)array
+                    copyItems:(BOOL)copyItems
+                 trackChanges:(BOOL)trackChanges;
+
 /**
  * Creates a new set by copying the given set.
  *
@@ -68,6 +75,13 @@ NS_SWIFT_NAME(ZDCSet_ObjC)
  */
 - (instancetype)initWithSet:(nullable NSSet<ObjectType> *)set copyItems:(BOOL)copyItems;
 
+/**
+ * Same as `initWithSet:copyItems:`; pass NO for trackChanges to skip tracking the initial contents (see `performWithoutChangeTracking:`).
+ */
+- (instancetype)initWithSet:(nullable NSSet<ObjectType> *)set
+                  copyItems:(BOOL)copyItems
+               trackChanges:(BOOL)trackChanges;
+
 #pragma mark Raw
 
 /**
@@ -108,6 +122,34 @@ NS_SWIFT_NAME(ZDCSet_ObjC)
  */
 - (void)removeAllObjects;
 
+#pragma mark Set Algebra
+
+// The methods below compute the membership delta in a single hashed pass,
+// and then update the change tracking information for the entire delta at once.
+// The resulting changeset is identical to the one produced by
+// the equivalent sequence of `addObject:` & `removeObject:` invocations.
+
+/**
+ * Adds each object in the given set that isn't already a member.
+ */
+- (void)unionSet:(NSSet<ObjectType> *)otherSet;
+
+/**
+ * Removes each object in the given set that's a member.
+ */
+- (void)minusSet:(NSSet<ObjectType> *)otherSet;
+
+/**
+ * Removes each member that isn't in the given set.
+ */
+- (void)intersectSet:(NSSet<ObjectType> *)otherSet;
+
+/**
+ * Updates the members to match the given set.
+ * That is, members not in the given set are removed, and objects not yet members are added.
+ */
+- (void)setSet:(NSSet<ObjectType> *)otherSet;
+
 #pragma mark Enumeration
 
 /**
@@ -116,6 +158,28 @@ NS_SWIFT_NAME(ZDCSet_ObjC)
  */
 - (void)enumerateObjectsUsingBlock:(void (^)(ObjectType obj, BOOL *stop))block;
 
+/**
+ * Enumerates the objects within the set, with the given options.
+ *
+ * Pass NSEnumerationConcurrent to spread the enumeration across the available cores
+ * (the block must then be thread-safe). The set must not be mutated during the enumeration.
+ */
+- (void)enumerateObjectsWithOptions:(NSEnumerationOptions)opts
+                         usingBlock:(void (^)(ObjectType obj, BOOL *stop))block;
+
+#pragma mark Diff
+
+/**
+ * Calculates the changeset between two versions of a set,
+ * without replaying the individual operations that led from one to the other.
+ *
+ * The result is a standard (undo) changeset.
+ * That is, invoking `undo:error:` on a set equal to `dst` will produce a set equal to `src`.
+ *
+ * @return The changeset, or nil if the sets are equal.
+ */
++ (nullable NSDictionary<NSString*, id> *)changesetFrom:(ZDCSet *)src to:(ZDCSet *)dst;
+
 #pragma mark Equality
 
 /**
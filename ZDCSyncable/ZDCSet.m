@@ -6,6 +6,9 @@
 #import "ZDCSet.h"
 
 #import "ZDCObjectSubclass.h"
+#import "ZDCTrace.h"
+
+#import <mach/mach_time.h>
 
 // Encoding/Decoding Keys
 //
@@ -28,6 +31,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 
 	NSMutableSet<id> *added;
 	NSMutableSet<id> *deleted;
+	
+	BOOL storageIsShared; // shared with a copy or checkpoint (see `unshareStorage`)
 }
 
 @dynamic rawSet;
@@ -47,6 +52,11 @@ static NSString *const kChangeset_deleted = @"deleted";
 }
 
 - (instancetype)initWithArray:(nullable NSArray<id> *)inArray copyItems:(BOOL)flag
+{
+	return [self initWithArray:inArray copyItems:flag trackChanges:YES];
+}
+
+- (instancetype)initWithArray:(nullable NSArray<id> *)inArray copyItems:(BOOL)flag trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -58,7 +68,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 			[set addObject:(flag ? [obj copy] : obj)];
 		}
 		
-		added = [set mutableCopy];
+		if (trackChanges) {
+			added = [set mutableCopy];
+		}
 	}
 	return self;
 }
@@ -69,6 +81,11 @@ static NSString *const kChangeset_deleted = @"deleted";
 }
 
 - (instancetype)initWithSet:(NSSet<id> *)inSet copyItems:(BOOL)flag
+{
+	return [self initWithSet:inSet copyItems:flag trackChanges:YES];
+}
+
+- (instancetype)initWithSet:(NSSet<id> *)inSet copyItems:(BOOL)flag trackChanges:(BOOL)trackChanges
 {
 	if ((self = [super init]))
 	{
@@ -76,7 +93,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 		  [[NSMutableSet alloc] initWithSet:inSet copyItems:flag] :
 		  [[NSMutableSet alloc] init];
 		
-		added = [set mutableCopy];
+		if (trackChanges) {
+			added = [set mutableCopy];
+		}
 	}
 	return self;
 }
@@ -117,10 +136,18 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	ZDCSet *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
 	
-	copy->set = [self->set mutableCopy];
+	// The storage is shared between both objects, and copied upon the next mutation (copy-on-write).
+	// An immutable object is never mutated, so there's no need to mark it (it may be shared across threads).
+	
+	copy->set = self->set;
 	
-	copy->added = [self->added mutableCopy];
-	copy->deleted = [self->deleted mutableCopy];
+	copy->added = self->added;
+	copy->deleted = self->deleted;
+	
+	copy->storageIsShared = YES;
+	if (!self.isImmutable) {
+		self->storageIsShared = YES;
+	}
 	
 	return copy;
 }
@@ -144,6 +171,80 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 }
 
+/**
+ * Used by `restoreCheckpoint:`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)restoreStateFromCopy:(id)another
+{
+	__unsafe_unretained ZDCSet *copy = (ZDCSet *)another;
+	
+	// The copy shares its storage with the checkpoint, so we adopt it as-is (still marked as shared).
+	
+	set = copy->set;
+	
+	added = copy->added;
+	deleted = copy->deleted;
+	
+	storageIsShared = copy->storageIsShared;
+	
+	[super restoreStateFromCopy:another];
+}
+
+/**
+ * Used by `publishSnapshot`.
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)_replaceChildObjectsUsingBlock:(ZDCObject* (NS_NOESCAPE ^)(ZDCObject *child))block
+{
+	for (id obj in [set allObjects])
+	{
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			[set removeObject:obj];
+			[set addObject:block((ZDCObject *)obj)];
+		}
+	}
+	
+	for (id obj in [added allObjects])
+	{
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			[added removeObject:obj];
+			[added addObject:block((ZDCObject *)obj)];
+		}
+	}
+	
+	for (id obj in [deleted allObjects])
+	{
+		if ([obj isKindOfClass:[ZDCObject class]])
+		{
+			[self unshareStorage];
+			[deleted removeObject:obj];
+			[deleted addObject:block((ZDCObject *)obj)];
+		}
+	}
+}
+
+/**
+ * The storage (and change tracking info) may be shared with copies & checkpoints.
+ * This method must be invoked before modifying any of it.
+ */
+- (void)unshareStorage
+{
+	if (storageIsShared)
+	{
+		set = [set mutableCopy];
+		
+		added = [added mutableCopy];
+		deleted = [deleted mutableCopy];
+		
+		storageIsShared = NO;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Properties
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -176,6 +277,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (object == nil) return;
 	
 	if (![self containsObject:object])
@@ -190,6 +292,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	if (object == nil) return;
 	
 	if ([self containsObject:object])
@@ -203,6 +306,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
+	[self unshareStorage];
 	
 	for (id object in set)
 	{
@@ -212,12 +316,120 @@ static NSString *const kChangeset_deleted = @"deleted";
 	[set removeAllObjects];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Set Algebra
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (void)unionSet:(NSSet<id> *)otherSet
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSMutableSet<id> *toAdd = [otherSet mutableCopy];
+	[toAdd minusSet:set];
+	
+	if (toAdd.count > 0)
+	{
+		[self _willAddObjects:toAdd];
+		[set unionSet:toAdd];
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)minusSet:(NSSet<id> *)otherSet
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSMutableSet<id> *toRemove = [NSMutableSet setWithCapacity:MIN(otherSet.count, set.count)];
+	for (id obj in otherSet)
+	{
+		if ([set containsObject:obj]) {
+			[toRemove addObject:obj];
+		}
+	}
+	
+	if (toRemove.count > 0)
+	{
+		[self _willRemoveObjects:toRemove];
+		[set minusSet:toRemove];
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)intersectSet:(NSSet<id> *)otherSet
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSMutableSet<id> *toRemove = [set mutableCopy];
+	[toRemove minusSet:otherSet];
+	
+	if (toRemove.count > 0)
+	{
+		[self _willRemoveObjects:toRemove];
+		[set minusSet:toRemove];
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (void)setSet:(NSSet<id> *)otherSet
+{
+	if (self.isImmutable) {
+		@throw [self immutableException];
+	}
+	[self unshareStorage];
+	
+	NSMutableSet<id> *toRemove = [set mutableCopy];
+	[toRemove minusSet:otherSet];
+	
+	NSMutableSet<id> *toAdd = [otherSet mutableCopy];
+	[toAdd minusSet:set];
+	
+	if (toRemove.count > 0)
+	{
+		[self _willRemoveObjects:toRemove];
+		[set minusSet:toRemove];
+	}
+	if (toAdd.count > 0)
+	{
+		[self _willAddObjects:toAdd];
+		[set unionSet:toAdd];
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Change Tracking Internals
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 - (void)_willAddObject:(id)obj
 {
+	if ([self isChangeTrackingSuspended])
+	{
+		// The object becomes part of the original state.
+		// (If it was removed within the changeset, then the removal is discarded.)
+		
+		[deleted removeObject:obj];
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(obj != nil);
 	
 	if (added == nil) {
@@ -239,6 +451,17 @@ static NSString *const kChangeset_deleted = @"deleted";
 
 - (void)_willRemoveObject:(id)obj
 {
+	if ([self isChangeTrackingSuspended])
+	{
+		// The object is removed from the original state.
+		// (If it was added within the changeset, then the addition is discarded.)
+		
+		[added removeObject:obj];
+		return;
+	}
+	
+	[self incrementMutationCount];
+	
 	NSParameterAssert(obj != nil);
 	
 	if (deleted == nil) {
@@ -258,6 +481,84 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 }
 
+/**
+ * Batched equivalent of invoking `_willAddObject:` for each of the given objects.
+ */
+- (void)_willAddObjects:(NSSet<id> *)objs
+{
+	if ([self isChangeTrackingSuspended])
+	{
+		[deleted minusSet:objs]; // see `_willAddObject:`
+		return;
+	}
+	
+	[self incrementMutationCountBy:objs.count];
+	
+	if (added == nil) {
+		added = [[NSMutableSet alloc] init];
+	}
+	
+	if (deleted.count == 0)
+	{
+		[added unionSet:objs];
+		return;
+	}
+	
+	for (id obj in objs)
+	{
+		if ([deleted containsObject:obj])
+		{
+			// Deleted & then later re-added within same changeset.
+			// The two actions cancel each other out.
+			
+			[deleted removeObject:obj];
+		}
+		else
+		{
+			[added addObject:obj];
+		}
+	}
+}
+
+/**
+ * Batched equivalent of invoking `_willRemoveObject:` for each of the given objects.
+ */
+- (void)_willRemoveObjects:(NSSet<id> *)objs
+{
+	if ([self isChangeTrackingSuspended])
+	{
+		[added minusSet:objs]; // see `_willRemoveObject:`
+		return;
+	}
+	
+	[self incrementMutationCountBy:objs.count];
+	
+	if (deleted == nil) {
+		deleted = [[NSMutableSet alloc] init];
+	}
+	
+	if (added.count == 0)
+	{
+		[deleted unionSet:objs];
+		return;
+	}
+	
+	for (id obj in objs)
+	{
+		if ([added containsObject:obj])
+		{
+			// Added & then later removed within same changeset.
+			// The two actions cancel each other out.
+			
+			[added removeObject:obj];
+		}
+		else
+		{
+			[deleted addObject:obj];
+		}
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Enumeration
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -269,6 +570,13 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}];
 }
 
+- (void)enumerateObjectsWithOptions:(NSEnumerationOptions)opts usingBlock:(void (^)(id obj, BOOL *stop))block
+{
+	[set enumerateObjectsWithOptions:opts usingBlock:^(id obj, BOOL *stop) {
+		block(obj, stop);
+	}];
+}
+
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
                                   objects:(id __unsafe_unretained _Nullable [_Nonnull])buffer
                                     count:(NSUInteger)len
@@ -305,13 +613,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	[super makeImmutable];
 	
-	for (id obj in set)
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
-		{
-			[(ZDCObject *)obj makeImmutable];
-		}
-	}
+	[self enumerateChildObjectsIn:set withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child makeImmutable];
+	}];
 }
 
 - (BOOL)hasChanges
@@ -321,29 +626,68 @@ static NSString *const kChangeset_deleted = @"deleted";
 	if (added.count   > 0 ||
 	    deleted.count > 0  ) return YES;
 	
-	for (id obj in set)
-	{
-		if ([obj isKindOfClass:[ZDCObject class]])
+	__block BOOL childHasChanges = NO;
+	[self enumerateChildObjectsIn:set withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		if ([child hasChanges])
 		{
-			if ([(ZDCObject *)obj hasChanges]) return YES;
+			__atomic_store_n(&childHasChanges, YES, __ATOMIC_RELAXED); // may be invoked concurrently
+			*stop = YES;
 		}
-	}
+	}];
 	
-	return NO;
+	return childHasChanges;
 }
 
 - (void)clearChangeTracking
 {
 	[super clearChangeTracking];
 	
-	[added removeAllObjects];
-	[deleted removeAllObjects];
+	if (storageIsShared)
+	{
+		// The tracking info is shared with a copy or checkpoint (and is created lazily).
+		added = nil;
+		deleted = nil;
+	}
+	else
+	{
+		[added removeAllObjects];
+		[deleted removeAllObjects];
+	}
+	
+	[self enumerateChildObjectsIn:set withBlock:^(ZDCObject *child, BOOL *stop) {
+		
+		[child clearChangeTracking];
+	}];
+}
+
+/**
+ * See ZDCObject.h for method description.
+ */
+- (ZDCTrackingStatistics)trackingStatistics
+{
+	ZDCTrackingStatistics stats = [super trackingStatistics];
+	stats.elementCount  = set.count;
+	stats.addedCount    = added.count;
+	stats.deletedCount  = deleted.count;
+	stats.originalCount = deleted.count;
+	stats.trackingBytes = [self estimatedTrackingBytesForEntryCount:(added.count + deleted.count)];
 	
+	return stats;
+}
+
+/**
+ * This method is declared in: ZDCObjectSubclass.h
+ */
+- (void)enumerateChildObjectsWithBlock:(void (^)(ZDCObject *child, BOOL *stop))block
+{
+	BOOL stop = NO;
 	for (id obj in set)
 	{
 		if ([obj isKindOfClass:[ZDCObject class]])
 		{
-			[(ZDCObject *)obj clearChangeTracking];
+			block((ZDCObject *)obj, &stop);
+			if (stop) break;
 		}
 	}
 }
@@ -409,14 +753,73 @@ static NSString *const kChangeset_deleted = @"deleted";
 	return changeset;
 }
 
+/**
+ * See header file for description.
+ */
++ (nullable NSDictionary *)changesetFrom:(ZDCSet *)src to:(ZDCSet *)dst
+{
+	NSParameterAssert(src != nil);
+	NSParameterAssert(dst != nil);
+	
+	NSMutableDictionary<NSString*, id> *changeset = [NSMutableDictionary dictionaryWithCapacity:2];
+	
+	NSSet* (^CopyItems)(NSSet*) = ^NSSet* (NSSet *items){
+		
+		NSMutableSet *result = [NSMutableSet setWithCapacity:items.count];
+		for (id obj in items)
+		{
+			if ([obj conformsToProtocol:@protocol(NSCopying)]) {
+				[result addObject:[obj copy]];
+			}
+			else {
+				[result addObject:obj];
+			}
+		}
+		return [result copy];
+	};
+	
+	// changeset: {
+	//   added: [{
+	//     obj, ...
+	//   }],
+	//   ...
+	// }
+	
+	NSMutableSet *changeset_added = [dst->set mutableCopy];
+	[changeset_added minusSet:src->set];
+	
+	if (changeset_added.count > 0) {
+		changeset[kChangeset_added] = CopyItems(changeset_added);
+	}
+	
+	// changeset: {
+	//   deleted: [{
+	//     obj, ...
+	//   }],
+	//   ...
+	// }
+	
+	NSMutableSet *changeset_deleted = [src->set mutableCopy];
+	[changeset_deleted minusSet:dst->set];
+	
+	if (changeset_deleted.count > 0) {
+		changeset[kChangeset_deleted] = CopyItems(changeset_deleted);
+	}
+	
+	return (changeset.count > 0) ? changeset : nil;
+}
+
 /**
  * See ZDCSyncable.h for method description.
  */
 - (nullable NSDictionary *)changeset
 {
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSDictionary *changeset = [self _changeset];
 	[self clearChangeTracking];
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
 	return changeset;
 }
 
@@ -425,7 +828,12 @@ static NSString *const kChangeset_deleted = @"deleted";
  */
 - (nullable NSDictionary *)peakChangeset
 {
-	return [self _changeset];
+	uint64_t const startTime = mach_absolute_time();
+	
+	NSDictionary *changeset = [self _changeset];
+	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Changeset];
+	return changeset;
 }
 
 - (BOOL)isMalformedChangeset:(NSDictionary *)changeset
@@ -481,6 +889,9 @@ static NSString *const kChangeset_deleted = @"deleted";
 {
 	// Important: `isMalformedChangeset:` must be called before invoking this method.
 	
+	ZDC_TRACE_SCOPE(trace, "ZDCSet", "_undo");
+	ZDC_TRACE_COUNTER("ZDCSet", "_undo: count", set.count);
+	
 	// Step 1 of 2:
 	//
 	// Undo added objects.
@@ -554,6 +965,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		return [self malformedChangesetError];
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *error = [self _undo:changeset];
 	if (error)
 	{
@@ -561,6 +974,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		[self rollback];
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Undo];
 	return error;
 }
 
@@ -630,6 +1044,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		return nil;
 	}
 	
+	uint64_t const startTime = mach_absolute_time();
+	
 	NSError *result_error = nil;
 	NSMutableArray<NSDictionary*> *changesets_redo = [NSMutableArray arrayWithCapacity:orderedChangesets.count];
 	
@@ -667,6 +1083,7 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
 	return result_error;
 }
 
@@ -677,6 +1094,9 @@ static NSString *const kChangeset_deleted = @"deleted";
                        withPendingChangesets:(nullable NSArray<NSDictionary *> *)pendingChangesets
                                        error:(NSError *__autoreleasing  _Nullable * _Nullable)errPtr
 {
+	ZDC_TRACE_SCOPE(trace, "ZDCSet", "mergeCloudVersion");
+	ZDC_TRACE_COUNTER("ZDCSet", "mergeCloudVersion: pendingChangesets", pendingChangesets.count);
+	
 	if (self.isImmutable) {
 		@throw [self immutableException];
 	}
@@ -710,6 +1130,10 @@ static NSString *const kChangeset_deleted = @"deleted";
 	}
 	ZDCSet *cloudVersion = (ZDCSet *)inCloudVersion;
 	
+	uint64_t const startTime = mach_absolute_time();
+	
+	ZDC_TRACE_SCOPE(step, "ZDCSet", "mergeCloudVersion: step 1 of 3");
+	
 	// Step 1 of 3:
 	//
 	// Determine which objects have been added & deleted (locally, based on pendingChangesets)
@@ -748,6 +1172,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 2 of 3");
+	
 	// Step 2 of 3:
 	//
 	// Add objects that were added by remote devices.
@@ -768,6 +1194,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		}
 	}
 	
+	ZDC_TRACE_NEXT(step, "mergeCloudVersion: step 3 of 3");
+	
 	// Step 3 of 3:
 	//
 	// Delete objects that were deleted by remote devices.
@@ -799,6 +1227,8 @@ static NSString *const kChangeset_deleted = @"deleted";
 		[self removeObject:obj];
 	}
 	
+	[self addElapsedTime:startTime toTimer:ZDCTrackingTimer_Merge];
+	
 	if (errPtr) *errPtr = nil;
 	return ([self changeset] ?: @{});
 }
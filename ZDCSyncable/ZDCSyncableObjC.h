@@ -19,10 +19,20 @@ FOUNDATION_EXPORT const unsigned char ZDCSyncableObjCVersionString[];
 #import "ZDCObject.h"
 #import "ZDCRecord.h"
 #import "ZDCDictionary.h"
+#import "ZDCConcurrentDictionary.h"
 #import "ZDCOrderedDictionary.h"
 #import "ZDCSet.h"
 #import "ZDCOrderedSet.h"
 #import "ZDCArray.h"
+#import "ZDCInt64Array.h"
+#import "ZDCInt64OrderedSet.h"
+#import "ZDCRetentionPolicy.h"
+#import "ZDCUndoHistory.h"
+#import "ZDCChangeNotification.h"
 
 #import "ZDCObjectSubclass.h"
+#import "ZDCInternTable.h"
 #import "ZDCOrder.h"
+#import "ZDCTrace.h"
+#import "ZDCWorkloadTrace.h"
+#import "ZDCJSONSerialization.h"
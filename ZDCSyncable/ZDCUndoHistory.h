@@ -0,0 +1,193 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCObject.h"
+#import "ZDCSyncable.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * ZDCUndoHistory manages an undo/redo stack for a syncable object (the root).
+ *
+ * Applications can build an undo stack by holding onto the changesets returned from `changeset` & `undo:error:`.
+ * But such a stack grows without bound, and retains every original value.
+ * This class adds what's typically needed on top of that:
+ *
+ * - Coalescing:
+ *   Rapid edits (e.g. keystroke-level property changes) can be grouped into a single undo step,
+ *   either via the `coalescingInterval`, or explicitly via `beginGrouping` & `endGrouping`.
+ *   Each recorded changeset is merged into the open step (via `mergeChangesets:error:` on the root).
+ *   So a step always holds a single changeset, and 200 keystrokes cost about as much as one.
+ *
+ * - Budget:
+ *   The number of steps (`stepLimit`) and their total cost (`costLimit`) can be bounded.
+ *   When a limit is exceeded, the oldest steps are squashed together (merged into a single step).
+ *   So the oldest state can still be reached via undo; only the intermediate states are lost.
+ *   Squashing merges on a copy of the root, which is walked back through the newer steps.
+ *   So it costs about as much as undoing those steps, and the root's `copyWithZone:` must copy nested syncable objects.
+ *
+ * - Performance:
+ *   Undo & redo apply the changeset of a single step, so their cost is proportional to the size of the step,
+ *   and not to the size of the root object (or the number of steps within the history).
+ *
+ * The history takes ownership of the root's change tracking.
+ * That is, `recordChanges` fetches (and thus clears) the root's changeset.
+ * To support syncing, every method that changes the root returns the changesets it produced,
+ * which can be appended to the list of pending changesets (for `mergeCloudVersion:withPendingChangesets:error:`).
+ *
+ * @note This class is NOT thread-safe, just like the root object.
+ */
+NS_SWIFT_NAME(ZDCUndoHistory_ObjC)
+@interface ZDCUndoHistory : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Creates a history for the given root object.
+ *
+ * The current state of the root is the baseline.
+ * If the root already has changes, they'll be picked up (as an undo step) by the next `recordChanges`.
+ */
+- (instancetype)initWithRoot:(ZDCObject<ZDCSyncable> *)root;
+
+/** The object passed to the init method. */
+@property (nonatomic, strong, readonly) ZDCObject<ZDCSyncable> *root;
+
+#pragma mark Configuration
+
+/**
+ * If a call to `recordChanges` occurs within this interval of the previous call,
+ * the changes are coalesced into the same undo step.
+ *
+ * The default value is zero, which disables time-based coalescing.
+ */
+@property (nonatomic, assign, readwrite) NSTimeInterval coalescingInterval;
+
+/**
+ * The maximum number of undo steps.
+ * When exceeded, the oldest steps are squashed together.
+ *
+ * The default value is 100. Set it to zero for no limit.
+ */
+@property (nonatomic, assign, readwrite) NSUInteger stepLimit;
+
+/**
+ * The maximum total cost of all undo & redo steps.
+ * When exceeded, the two oldest undo steps are squashed together, which shrinks the cost if they overlap.
+ * If that's not enough, the squashed step is discarded (i.e. the baseline moves forward), and so on.
+ * If that's still not enough, the redo steps are discarded (starting with the one furthest from the current state).
+ *
+ * The cost of each changeset is calculated via the `costEstimator`.
+ * The step nearest to the current state is always kept, even if it exceeds the limit on its own.
+ *
+ * The default value is zero, which means no limit.
+ */
+@property (nonatomic, assign, readwrite) NSUInteger costLimit;
+
+/**
+ * Allows you to customize how the cost of a changeset is calculated.
+ *
+ * If nil (the default), the cost is the number of entries within the changeset (counted recursively).
+ * That is, every key/value pair within a dictionary, every member of a set, and every index within an index set.
+ * This is roughly proportional to the amount of memory retained by the changeset.
+ */
+@property (nonatomic, copy, readwrite, nullable) NSUInteger (^costEstimator)(NSDictionary *changeset);
+
+#pragma mark Recording
+
+/**
+ * Call this method after making changes to the root.
+ *
+ * It fetches the root's changeset, and merges it into the current undo step
+ * (if the changes are being coalesced), or pushes a new undo step.
+ * Recording changes clears the redo stack.
+ *
+ * @return
+ *   The changeset that was fetched from the root, or nil if the root didn't have any changes.
+ *   For syncing, you can append it to your list of pending changesets.
+ */
+- (nullable NSDictionary *)recordChanges;
+
+/**
+ * Every change recorded between `beginGrouping` & `endGrouping` is coalesced into a single undo step.
+ * Groups may be nested, in which case the step ends with the outermost `endGrouping`.
+ *
+ * Any pending changes (within the root) are recorded before the group is opened,
+ * so they don't become part of the group.
+ *
+ * @return The changeset that was recorded (see `recordChanges`), or nil if there weren't any pending changes.
+ */
+- (nullable NSDictionary *)beginGrouping;
+
+/**
+ * Ends the group started by `beginGrouping`.
+ * Any pending changes (within the root) are recorded before the group is closed.
+ *
+ * @return The changeset that was recorded (see `recordChanges`), or nil if there weren't any pending changes.
+ */
+- (nullable NSDictionary *)endGrouping;
+
+/**
+ * Ensures the next call to `recordChanges` starts a new undo step,
+ * even if it's within the `coalescingInterval`.
+ */
+- (void)closeCurrentStep;
+
+#pragma mark Undo & Redo
+
+/** The number of steps that can be undone. */
+@property (nonatomic, readonly) NSUInteger undoCount;
+
+/** The number of steps that can be redone. */
+@property (nonatomic, readonly) NSUInteger redoCount;
+
+/** Returns YES if undoCount > 0. */
+@property (nonatomic, readonly) BOOL canUndo;
+
+/** Returns YES if redoCount > 0. */
+@property (nonatomic, readonly) BOOL canRedo;
+
+/**
+ * The total cost of all undo & redo steps (see `costEstimator`).
+ */
+@property (nonatomic, readonly) NSUInteger totalCost;
+
+/**
+ * Reverts the most recent undo step.
+ *
+ * If the root has pending changes, they're recorded first (as usual), and are then undone.
+ * Any open group is closed.
+ *
+ * @return
+ *   On success, returns the changesets that were produced by changing the root (in order),
+ *   starting with the recorded changeset (if there were pending changes).
+ *   For syncing, you can append these to your list of pending changesets.
+ *   (If you need the recorded changeset even when the undo fails, invoke `recordChanges` beforehand.)
+ *   If there's nothing to undo, returns an empty array.
+ *   On failure, the root is restored to its previous state, and nil is returned (with an error).
+ */
+- (nullable NSArray<NSDictionary*> *)undo:(NSError *_Nullable *_Nullable)errPtr;
+
+/**
+ * Re-applies the most recently undone step.
+ *
+ * If the root has pending changes, they're recorded first (as usual), which clears the redo stack.
+ * Any open group is closed.
+ *
+ * @return See `undo:`.
+ */
+- (nullable NSArray<NSDictionary*> *)redo:(NSError *_Nullable *_Nullable)errPtr;
+
+/**
+ * Discards all undo & redo steps.
+ * The current state of the root becomes the baseline.
+ *
+ * Changes within the root that haven't been recorded yet are not affected.
+ */
+- (void)removeAllSteps;
+
+@end
+
+NS_ASSUME_NONNULL_END
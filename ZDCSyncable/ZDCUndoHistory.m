@@ -0,0 +1,502 @@
+/**
+ * ZDCSyncable
+ * https://github.com/4th-ATechnologies/ZDCSyncable
+**/
+
+#import "ZDCUndoHistory.h"
+
+#import "ZDCTrace.h"
+
+/**
+ * A single undo (or redo) step.
+ *
+ * Coalesced (and squashed) changes are merged, so a step always holds a single changeset.
+ * It may be empty (if the coalesced changes cancelled each other out).
+ */
+@interface ZDCUndoStep : NSObject {
+@public
+
+	NSDictionary *changeset;
+	NSUInteger cost;
+}
+@end
+
+@implementation ZDCUndoStep
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCUndoHistory {
+@private
+
+	NSMutableArray<ZDCUndoStep*> *undoSteps; // oldest first (lastObject is the next step to undo)
+	NSMutableArray<ZDCUndoStep*> *redoSteps; // furthest first (lastObject is the next step to redo)
+	NSUInteger totalCost;
+	
+	NSUInteger groupingLevel;
+	BOOL stepIsOpen;                         // if YES, the last undo step may be extended
+	NSTimeInterval lastRecordTime;
+}
+
+@synthesize root = root;
+@synthesize coalescingInterval = coalescingInterval;
+@synthesize stepLimit = stepLimit;
+@synthesize costLimit = costLimit;
+@synthesize costEstimator = costEstimator;
+@synthesize totalCost = totalCost;
+
+- (instancetype)initWithRoot:(ZDCObject<ZDCSyncable> *)inRoot
+{
+	NSParameterAssert(inRoot != nil);
+	
+	if ((self = [super init]))
+	{
+		root = inRoot;
+		
+		undoSteps = [[NSMutableArray alloc] init];
+		redoSteps = [[NSMutableArray alloc] init];
+		
+		stepLimit = 100;
+	}
+	return self;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Configuration
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)setStepLimit:(NSUInteger)newStepLimit
+{
+	stepLimit = newStepLimit;
+	[self enforceLimits];
+}
+
+- (void)setCostLimit:(NSUInteger)newCostLimit
+{
+	costLimit = newCostLimit;
+	[self enforceLimits];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Cost
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The default cost: the number of entries within the changeset (counted recursively).
+ */
+static NSUInteger ZDCChangesetEntryCount(id obj)
+{
+	NSUInteger count = 0;
+	
+	if ([obj isKindOfClass:[NSDictionary class]])
+	{
+		NSDictionary *dict = (NSDictionary *)obj;
+		count += dict.count;
+		
+		for (id key in dict)
+		{
+			count += ZDCChangesetEntryCount(dict[key]);
+		}
+	}
+	else if ([obj isKindOfClass:[NSSet class]] || [obj isKindOfClass:[NSArray class]])
+	{
+		count += [obj count];
+		
+		for (id member in obj)
+		{
+			count += ZDCChangesetEntryCount(member);
+		}
+	}
+	else if ([obj isKindOfClass:[NSIndexSet class]])
+	{
+		count += [(NSIndexSet *)obj count];
+	}
+	
+	return count;
+}
+
+- (NSUInteger)costOfChangeset:(NSDictionary *)changeset
+{
+	if (costEstimator) {
+		return costEstimator(changeset);
+	}
+	else {
+		return ZDCChangesetEntryCount(changeset);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Budget
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)removeOldestUndoStep
+{
+	ZDCUndoStep *step = undoSteps[0];
+	[undoSteps removeObjectAtIndex:0];
+	
+	totalCost -= step->cost;
+}
+
+- (void)removeFurthestRedoStep
+{
+	ZDCUndoStep *step = redoSteps[0];
+	[redoSteps removeObjectAtIndex:0];
+	
+	totalCost -= step->cost;
+}
+
+/**
+ * Merges the oldest `count` undo steps into a single step.
+ *
+ * Merging (via `mergeChangesets:error:`) requires an object in the state that follows the newest of these steps.
+ * So a copy of the root is walked back to that state, by undoing the newer steps.
+ *
+ * @return NO if the steps couldn't be merged, in which case the history is unchanged.
+ */
+- (BOOL)squashOldestUndoSteps:(NSUInteger)count
+{
+	NSParameterAssert(count >= 2 && count <= undoSteps.count);
+	
+	ZDC_TRACE_SCOPE(trace, "ZDCUndoHistory", "squashOldestUndoSteps");
+	ZDC_TRACE_COUNTER("ZDCUndoHistory", "squashOldestUndoSteps: walked", undoSteps.count - count);
+	
+	ZDCObject<ZDCSyncable> *copy = [root copy];
+	if ([copy hasChanges])
+	{
+		// Changes that haven't been recorded yet aren't part of any step
+		[copy rollback];
+	}
+	
+	for (NSUInteger i = undoSteps.count; i > count; i--)
+	{
+		NSDictionary *changeset = undoSteps[i-1]->changeset;
+		
+		if (changeset.count > 0 && [copy undo:changeset error:NULL] == nil) {
+			return NO;
+		}
+	}
+	
+	NSMutableArray<NSDictionary*> *changesets = [NSMutableArray arrayWithCapacity:count];
+	NSUInteger oldCost = 0;
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		ZDCUndoStep *step = undoSteps[i];
+		
+		if (step->changeset.count > 0) {
+			[changesets addObject:step->changeset];
+		}
+		oldCost += step->cost;
+	}
+	
+	NSDictionary *merged = [copy mergeChangesets:changesets error:NULL];
+	if (merged == nil) {
+		return NO;
+	}
+	
+	ZDCUndoStep *squashed = [[ZDCUndoStep alloc] init];
+	squashed->changeset = merged;
+	squashed->cost = [self costOfChangeset:merged];
+	
+	[undoSteps replaceObjectsInRange:NSMakeRange(0, count) withObjectsFromArray:@[ squashed ]];
+	totalCost = totalCost - oldCost + squashed->cost;
+	
+	return YES;
+}
+
+/**
+ * Squashes the oldest steps together until the history is within its limits.
+ * If that's not enough to satisfy the costLimit, the oldest steps are discarded.
+ */
+- (void)enforceLimits
+{
+	if (stepLimit > 0 && undoSteps.count > stepLimit)
+	{
+		// A single squash (i.e. a single walk of the history) handles any excess.
+		
+		if (![self squashOldestUndoSteps:(undoSteps.count - stepLimit + 1)])
+		{
+			while (undoSteps.count > stepLimit)
+			{
+				[self removeOldestUndoStep];
+			}
+		}
+	}
+	
+	if (costLimit > 0)
+	{
+		// The nearest undo step & nearest redo step are always kept (and never squashed).
+		//
+		// Squashing may reduce the cost (e.g. repeated edits to the same value collapse into a single entry).
+		// If it doesn't bring the history within its limit, the squashed step is discarded.
+		
+		while (totalCost > costLimit && undoSteps.count > 1)
+		{
+			if (undoSteps.count > 2 && [self squashOldestUndoSteps:2] && totalCost <= costLimit) {
+				break;
+			}
+			
+			[self removeOldestUndoStep];
+		}
+		while (totalCost > costLimit && redoSteps.count > 1)
+		{
+			[self removeFurthestRedoStep];
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Recording
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (nullable NSDictionary *)recordChanges
+{
+	NSDictionary *changeset = [root changeset];
+	if (changeset.count == 0) {
+		return nil;
+	}
+	
+	NSTimeInterval const now = [[NSProcessInfo processInfo] systemUptime];
+	
+	BOOL coalesce = NO;
+	if (stepIsOpen && undoSteps.count > 0)
+	{
+		if (groupingLevel > 0) {
+			coalesce = YES;
+		}
+		else if (coalescingInterval > 0) {
+			coalesce = ((now - lastRecordTime) <= coalescingInterval);
+		}
+	}
+	
+	// New changes invalidate the redo stack
+	
+	for (ZDCUndoStep *step in redoSteps)
+	{
+		totalCost -= step->cost;
+	}
+	[redoSteps removeAllObjects];
+	
+	if (coalesce)
+	{
+		// Merge the changeset into the open step, so the step holds a single changeset,
+		// no matter how many times changes were recorded within it.
+		// The root doesn't have any changes at this point (we just fetched them), which the merge requires.
+		
+		ZDCUndoStep *step = [undoSteps lastObject];
+		
+		NSArray<NSDictionary*> *changesets =
+		  (step->changeset.count > 0) ? @[ step->changeset, changeset ] : @[ changeset ];
+		
+		NSDictionary *merged = [root mergeChangesets:changesets error:NULL];
+		if (merged)
+		{
+			NSUInteger const cost = [self costOfChangeset:merged];
+			
+			totalCost = totalCost - step->cost + cost;
+			step->changeset = merged;
+			step->cost = cost;
+		}
+		else
+		{
+			// Shouldn't happen, but a separate step is better than losing the changes
+			coalesce = NO;
+		}
+	}
+	
+	if (!coalesce)
+	{
+		ZDCUndoStep *step = [[ZDCUndoStep alloc] init];
+		step->changeset = changeset;
+		step->cost = [self costOfChangeset:changeset];
+		
+		[undoSteps addObject:step];
+		totalCost += step->cost;
+	}
+	
+	stepIsOpen = YES;
+	lastRecordTime = now;
+	
+	[self enforceLimits];
+	return changeset;
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable NSDictionary *)beginGrouping
+{
+	NSDictionary *changeset = nil;
+	if (groupingLevel == 0)
+	{
+		// Changes made before the group don't belong to it
+		changeset = [self recordChanges];
+		stepIsOpen = NO;
+	}
+	
+	groupingLevel++;
+	return changeset;
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable NSDictionary *)endGrouping
+{
+	NSAssert(groupingLevel > 0, @"endGrouping invoked without matching beginGrouping");
+	if (groupingLevel == 0) {
+		return nil;
+	}
+	
+	NSDictionary *changeset = [self recordChanges];
+	
+	groupingLevel--;
+	if (groupingLevel == 0) {
+		stepIsOpen = NO;
+	}
+	
+	return changeset;
+}
+
+/**
+ * See header file for description.
+ */
+- (void)closeCurrentStep
+{
+	if (groupingLevel == 0) {
+		stepIsOpen = NO;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Undo & Redo
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (NSUInteger)undoCount
+{
+	return undoSteps.count;
+}
+
+- (NSUInteger)redoCount
+{
+	return redoSteps.count;
+}
+
+- (BOOL)canUndo
+{
+	return (undoSteps.count > 0);
+}
+
+- (BOOL)canRedo
+{
+	return (redoSteps.count > 0);
+}
+
+/**
+ * Applies the changeset of the given step to the root.
+ *
+ * On success, returns the changeset produced by changing the root, which is also the inverse step.
+ * On failure, the root is restored to its previous state (by `undo:error:`).
+ */
+- (nullable NSDictionary *)applyStep:(ZDCUndoStep *)step error:(NSError **)errPtr
+{
+	ZDC_TRACE_SCOPE(trace, "ZDCUndoHistory", "applyStep");
+	ZDC_TRACE_COUNTER("ZDCUndoHistory", "applyStep: cost", step->cost);
+	
+	if (step->changeset.count == 0)
+	{
+		if (errPtr) *errPtr = nil;
+		return @{};
+	}
+	
+	return [root undo:step->changeset error:errPtr];
+}
+
+/**
+ * Pops a step from the `from` stack, applies it, and pushes the inverse step onto the `to` stack.
+ */
+- (nullable NSArray<NSDictionary*> *)popStepFrom:(NSMutableArray<ZDCUndoStep*> *)fromSteps
+                                          pushTo:(NSMutableArray<ZDCUndoStep*> *)toSteps
+                                           error:(NSError **)errPtr
+{
+	// Pending changes are recorded first (as usual).
+	// And any open group (or coalescing window) is closed.
+	
+	NSDictionary *recorded = [self recordChanges];
+	
+	groupingLevel = 0;
+	stepIsOpen = NO;
+	
+	ZDCUndoStep *step = [fromSteps lastObject];
+	if (step == nil)
+	{
+		if (errPtr) *errPtr = nil;
+		return (recorded ? @[ recorded ] : @[]);
+	}
+	
+	NSError *error = nil;
+	NSDictionary *inverse = [self applyStep:step error:&error];
+	if (inverse == nil)
+	{
+		if (errPtr) *errPtr = error;
+		return nil;
+	}
+	
+	[fromSteps removeLastObject];
+	totalCost -= step->cost;
+	
+	ZDCUndoStep *inverseStep = [[ZDCUndoStep alloc] init];
+	inverseStep->changeset = inverse;
+	inverseStep->cost = [self costOfChangeset:inverse];
+	
+	[toSteps addObject:inverseStep];
+	totalCost += inverseStep->cost;
+	
+	[self enforceLimits];
+	
+	NSMutableArray<NSDictionary*> *produced = [NSMutableArray arrayWithCapacity:2];
+	if (recorded) {
+		[produced addObject:recorded];
+	}
+	if (inverse.count > 0) {
+		[produced addObject:inverse];
+	}
+	
+	if (errPtr) *errPtr = nil;
+	return produced;
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable NSArray<NSDictionary*> *)undo:(NSError *_Nullable *_Nullable)errPtr
+{
+	return [self popStepFrom:undoSteps pushTo:redoSteps error:errPtr];
+}
+
+/**
+ * See header file for description.
+ */
+- (nullable NSArray<NSDictionary*> *)redo:(NSError *_Nullable *_Nullable)errPtr
+{
+	return [self popStepFrom:redoSteps pushTo:undoSteps error:errPtr];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)removeAllSteps
+{
+	[undoSteps removeAllObjects];
+	[redoSteps removeAllObjects];
+	totalCost = 0;
+	
+	stepIsOpen = NO;
+}
+
+@end